@@ -0,0 +1,259 @@
+/**
+ * Shadow OT Client - Benchmark Harness
+ *
+ * A small timing harness for the benchmark suite. Each benchmark is a
+ * function taking a State; work inside the keepRunning() loop is timed,
+ * setup before it is not. The runner grows the iteration count until one
+ * run takes at least the minimum time, repeats it, and reports the median.
+ *
+ *   void benchHasAttr(bench::State& state) {
+ *       auto types = makeTypes();
+ *       while (state.keepRunning()) { ... }
+ *       state.setItemsProcessed(state.iterations() * types.size());
+ *   }
+ *
+ * Results print as a table, and optionally as JSON in Google Benchmark's
+ * layout, so its compare.py can diff two releases.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace shadow {
+namespace bench {
+
+// Keeps the compiler from discarding a result the benchmark never uses
+template<typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+    (void)*sink;
+#endif
+}
+
+class State {
+public:
+    explicit State(uint64_t iterations) : m_remaining(iterations), m_iterations(iterations) {}
+
+    // True while iterations are left; the first call starts the clock
+    bool keepRunning() {
+        if (!m_started) {
+            m_started = true;
+            m_cpuStart = std::clock();
+            m_start = std::chrono::steady_clock::now();
+        }
+        if (m_remaining > 0) {
+            m_remaining--;
+            return true;
+        }
+        if (!m_stopped) {
+            m_wallNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - m_start).count();
+            m_cpuNs = static_cast<double>(std::clock() - m_cpuStart) * 1e9 / CLOCKS_PER_SEC;
+            m_stopped = true;
+        }
+        return false;
+    }
+
+    uint64_t iterations() const { return m_iterations; }
+
+    void setBytesProcessed(uint64_t bytes) { m_bytes = bytes; }
+    void setItemsProcessed(uint64_t items) { m_items = items; }
+    void setLabel(const std::string& label) { m_label = label; }
+
+    // Reports the benchmark as skipped, e.g. when its input is missing
+    void skip(const std::string& reason) { m_skipped = reason; }
+
+    double getWallNs() const { return m_wallNs; }
+    double getCpuNs() const { return m_cpuNs; }
+    uint64_t getBytes() const { return m_bytes; }
+    uint64_t getItems() const { return m_items; }
+    const std::string& getLabel() const { return m_label; }
+    const std::string& getSkipped() const { return m_skipped; }
+    bool isComplete() const { return m_stopped; }
+
+private:
+    uint64_t m_remaining;
+    uint64_t m_iterations;
+    bool m_started{false};
+    bool m_stopped{false};
+    std::chrono::steady_clock::time_point m_start;
+    std::clock_t m_cpuStart{0};
+    double m_wallNs{0.0};
+    double m_cpuNs{0.0};
+    uint64_t m_bytes{0};
+    uint64_t m_items{0};
+    std::string m_label;
+    std::string m_skipped;
+};
+
+struct Benchmark {
+    const char* name;
+    void (*run)(State& state);
+};
+
+struct Options {
+    std::string filter;         // Substring a benchmark name must contain
+    double minTime{0.25};       // Seconds per repetition
+    int repetitions{3};
+};
+
+struct Result {
+    std::string name;
+    std::string label;
+    std::string skipped;
+    uint64_t iterations{0};
+    double wallNs{0.0};         // Per iteration, median of the repetitions
+    double cpuNs{0.0};
+    double minWallNs{0.0};
+    double bytesPerSecond{0.0};
+    double itemsPerSecond{0.0};
+};
+
+inline Result runBenchmark(const Benchmark& benchmark, const Options& options) {
+    constexpr uint64_t MAX_ITERATIONS = 1000000000;
+    const double minNs = options.minTime * 1e9;
+
+    Result result;
+    result.name = benchmark.name;
+
+    // Grow the count until a run is long enough to time
+    uint64_t iterations = 1;
+    while (true) {
+        State state(iterations);
+        benchmark.run(state);
+        if (!state.getSkipped().empty() || !state.isComplete()) {
+            result.skipped = state.getSkipped().empty() ? "never ran its loop" : state.getSkipped();
+            return result;
+        }
+        if (state.getWallNs() >= minNs || iterations >= MAX_ITERATIONS) break;
+
+        double perIteration = std::max(state.getWallNs(), 1.0) / iterations;
+        uint64_t predicted = static_cast<uint64_t>(minNs * 1.2 / perIteration);
+        iterations = std::clamp<uint64_t>(predicted, iterations * 2, std::min(iterations * 100, MAX_ITERATIONS));
+    }
+
+    std::vector<State> runs;
+    for (int i = 0; i < std::max(options.repetitions, 1); ++i) {
+        State state(iterations);
+        benchmark.run(state);
+        runs.push_back(state);
+    }
+    std::sort(runs.begin(), runs.end(), [](const State& a, const State& b) {
+        return a.getWallNs() < b.getWallNs();
+    });
+
+    const State& median = runs[runs.size() / 2];
+    double seconds = median.getWallNs() / 1e9;
+    result.label = median.getLabel();
+    result.iterations = iterations;
+    result.wallNs = median.getWallNs() / iterations;
+    result.cpuNs = median.getCpuNs() / iterations;
+    result.minWallNs = runs.front().getWallNs() / iterations;
+    if (seconds > 0) {
+        result.bytesPerSecond = median.getBytes() / seconds;
+        result.itemsPerSecond = median.getItems() / seconds;
+    }
+    return result;
+}
+
+inline void printResult(const Result& result, std::FILE* out = stdout) {
+    if (!result.skipped.empty()) {
+        std::fprintf(out, "%-36s skipped: %s\n", result.name.c_str(), result.skipped.c_str());
+        return;
+    }
+
+    char rates[96] = "";
+    int used = 0;
+    if (result.bytesPerSecond > 0) {
+        used += std::snprintf(rates + used, sizeof(rates) - used, "  %9.1f MB/s", result.bytesPerSecond / (1024.0 * 1024.0));
+    }
+    if (result.itemsPerSecond > 0) {
+        std::snprintf(rates + used, sizeof(rates) - used, "  %11.0f items/s", result.itemsPerSecond);
+    }
+    std::fprintf(out, "%-36s %12.1f ns %12llu%s%s%s\n", result.name.c_str(), result.wallNs,
+                static_cast<unsigned long long>(result.iterations), rates,
+                result.label.empty() ? "" : "  ", result.label.c_str());
+    std::fflush(out);
+}
+
+inline std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+// Google Benchmark's JSON layout; skipped benchmarks carry an error message
+inline bool writeJson(const std::string& path, const std::string& executable, const std::vector<Result>& results) {
+    std::FILE* file = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::fprintf(file, "{\n  \"context\": {\n");
+    std::fprintf(file, "    \"date\": \"%s\",\n", date);
+    std::fprintf(file, "    \"executable\": \"%s\",\n", jsonEscape(executable).c_str());
+    std::fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#ifdef NDEBUG
+    std::fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+    std::fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+    std::fprintf(file, "  },\n  \"benchmarks\": [");
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::fprintf(file, "%s\n    {\n", i ? "," : "");
+        std::fprintf(file, "      \"name\": \"%s\",\n", jsonEscape(result.name).c_str());
+        std::fprintf(file, "      \"run_name\": \"%s\",\n", jsonEscape(result.name).c_str());
+        std::fprintf(file, "      \"run_type\": \"iteration\",\n");
+        if (!result.skipped.empty()) {
+            std::fprintf(file, "      \"error_occurred\": true,\n");
+            std::fprintf(file, "      \"error_message\": \"%s\"\n    }", jsonEscape(result.skipped).c_str());
+            continue;
+        }
+        std::fprintf(file, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(result.iterations));
+        std::fprintf(file, "      \"real_time\": %.3f,\n", result.wallNs);
+        std::fprintf(file, "      \"cpu_time\": %.3f,\n", result.cpuNs);
+        std::fprintf(file, "      \"min_real_time\": %.3f,\n", result.minWallNs);
+        std::fprintf(file, "      \"time_unit\": \"ns\"");
+        if (result.bytesPerSecond > 0) std::fprintf(file, ",\n      \"bytes_per_second\": %.1f", result.bytesPerSecond);
+        if (result.itemsPerSecond > 0) std::fprintf(file, ",\n      \"items_per_second\": %.1f", result.itemsPerSecond);
+        if (!result.label.empty()) std::fprintf(file, ",\n      \"label\": \"%s\"", jsonEscape(result.label).c_str());
+        std::fprintf(file, "\n    }");
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+
+    bool ok = std::ferror(file) == 0;
+    if (file != stdout) ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+} // namespace bench
+} // namespace shadow
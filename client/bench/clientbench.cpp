@@ -0,0 +1,606 @@
+/**
+ * Shadow OT Client - Benchmark Suite
+ *
+ * The client's hot paths in one binary, for tracking regressions between
+ * releases: message encoding, XTEA, game packet parsing, map queries,
+ * sprite decoding, thing type flags, event dispatch and widget hit-tests.
+ * Nothing here needs a window or a GL context.
+ *
+ *   shadow-client-bench [--filter <text>] [--json <file|->] [--min-time <s>]
+ *       [--repetitions <n>] [--capture <file.sotc>] [--spr <Tibia.spr>]
+ *
+ * Packet parsing replays a capture recorded with the client's packet
+ * recorder, or synthetic frames when none is given; sprite decoding reads
+ * a .spr file the same way. The focused benchmarks next to this file
+ * compare SIMD kernels; this suite tracks the selected ones over time.
+ */
+
+#include "benchmark.h"
+
+#include <client/creature.h>
+#include <client/map.h>
+#include <client/pathfinder.h>
+#include <client/protocolgame.h>
+#include <client/spritedecoder.h>
+#include <client/thingtype.h>
+#include <framework/core/eventdispatcher.h>
+#include <framework/net/packetcapture.h>
+#include <framework/net/protocol.h>
+#include <framework/ui/uiwidget.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using namespace shadow;
+using namespace shadow::client;
+using namespace shadow::framework;
+
+namespace {
+
+std::string g_capturePath;
+std::string g_sprPath;
+
+// Network messages
+
+// Roughly a creature-heavy MapDescription: positions, ids, outfits, names
+void writeSample(NetworkMessage& msg) {
+    for (uint32_t i = 0; i < 256; ++i) {
+        msg.writePosition(static_cast<uint16_t>(1000 + i), 1000, 7);
+        msg.writeU16(static_cast<uint16_t>(100 + i));
+        msg.writeByte(static_cast<uint8_t>(i));
+        msg.writeU32(0x40000000 + i);
+        msg.writeString("Demon Skeleton");
+    }
+}
+
+void benchMessageWrite(bench::State& state) {
+    NetworkMessage msg(NetworkMessage::MAX_SIZE);
+    while (state.keepRunning()) {
+        msg.reset();
+        writeSample(msg);
+        bench::doNotOptimize(msg.getSize());
+    }
+    state.setBytesProcessed(state.iterations() * msg.getBodySize());
+}
+
+void benchMessageRead(bench::State& state) {
+    NetworkMessage msg(NetworkMessage::MAX_SIZE);
+    writeSample(msg);
+
+    uint64_t checksum = 0;
+    while (state.keepRunning()) {
+        msg.setPosition(NetworkMessage::HEADER_SIZE);
+        for (int i = 0; i < 256; ++i) {
+            uint16_t x, y;
+            uint8_t z;
+            msg.readPosition(x, y, z);
+            checksum += x + msg.readU16() + msg.readByte() + msg.readU32();
+            checksum += msg.readString().size();
+        }
+    }
+    bench::doNotOptimize(checksum);
+    state.setBytesProcessed(state.iterations() * msg.getBodySize());
+}
+
+// XTEA over a MapDescription-sized frame, with the kernel the client picks
+
+XTEACipher makeCipher() {
+    XTEACipher cipher;
+    cipher.setKey({0x1234567, 0x89ABCDEF, 0xFEDCBA98, 0x7654321});
+    cipher.setEnabled(true);
+    return cipher;
+}
+
+NetworkMessage makePayload(size_t size) {
+    std::mt19937 rng(1234);
+    NetworkMessage msg(NetworkMessage::HEADER_SIZE + size);
+    for (size_t i = 0; i < size; ++i) {
+        msg.writeByte(static_cast<uint8_t>(rng()));
+    }
+    return msg;
+}
+
+void benchXteaEncrypt(bench::State& state) {
+    XTEACipher cipher = makeCipher();
+    NetworkMessage msg = makePayload(16 * 1024);
+    while (state.keepRunning()) {
+        cipher.encrypt(msg);
+    }
+    state.setBytesProcessed(state.iterations() * msg.getBodySize());
+    state.setLabel(xtea::getKernelName(cipher.getKernel()));
+}
+
+void benchXteaDecrypt(bench::State& state) {
+    XTEACipher cipher = makeCipher();
+    NetworkMessage msg = makePayload(16 * 1024);
+    while (state.keepRunning()) {
+        cipher.decrypt(msg);
+    }
+    state.setBytesProcessed(state.iterations() * msg.getBodySize());
+    state.setLabel(xtea::getKernelName(cipher.getKernel()));
+}
+
+// Map
+//
+// A 121x121 area on three floors with some tiles unknown, and creatures
+// spread around the centre. Built once and shared by the map benchmarks
+// and packet parsing.
+
+constexpr uint16_t MAP_CENTRE = 1000;
+constexpr int MAP_RADIUS = 60;
+constexpr int MAP_CREATURES = 400;
+constexpr uint32_t FIRST_CREATURE_ID = 0x40000000;
+
+void populateMap() {
+    static bool populated = false;
+    if (populated) return;
+    populated = true;
+
+    g_map.init();
+    g_map.setCentralPosition(Position(MAP_CENTRE, MAP_CENTRE, 7));
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> roll(0, 99);
+    for (uint8_t z = 6; z <= 8; ++z) {
+        for (int y = -MAP_RADIUS; y <= MAP_RADIUS; ++y) {
+            for (int x = -MAP_RADIUS; x <= MAP_RADIUS; ++x) {
+                if (roll(rng) < 15) continue;
+                g_map.getOrCreateTile(Position(static_cast<uint16_t>(MAP_CENTRE + x),
+                                               static_cast<uint16_t>(MAP_CENTRE + y), z));
+            }
+        }
+    }
+
+    std::uniform_int_distribution<int> offset(-MAP_RADIUS + 10, MAP_RADIUS - 10);
+    for (int i = 0; i < MAP_CREATURES; ++i) {
+        Position pos(static_cast<uint16_t>(MAP_CENTRE + offset(rng)), static_cast<uint16_t>(MAP_CENTRE + offset(rng)), 7);
+        auto creature = Creature::create(FIRST_CREATURE_ID + i);
+        g_map.getOrCreateTile(pos)->addCreature(creature);
+        g_map.addCreature(creature);
+    }
+}
+
+std::vector<Position> randomPositions(size_t count, int radius, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> offset(-radius, radius);
+    std::uniform_int_distribution<int> floor(6, 8);
+    std::vector<Position> positions(count);
+    for (auto& pos : positions) {
+        pos = Position(static_cast<uint16_t>(MAP_CENTRE + offset(rng)),
+                       static_cast<uint16_t>(MAP_CENTRE + offset(rng)), static_cast<uint8_t>(floor(rng)));
+    }
+    return positions;
+}
+
+void benchMapGetTile(bench::State& state) {
+    populateMap();
+    // Some fall on unknown tiles, some just outside the known area
+    std::vector<Position> positions = randomPositions(4096, MAP_RADIUS + 4, 11);
+
+    size_t found = 0;
+    while (state.keepRunning()) {
+        for (const Position& pos : positions) {
+            found += g_map.getTile(pos) != nullptr;
+        }
+    }
+    bench::doNotOptimize(found);
+    state.setItemsProcessed(state.iterations() * positions.size());
+}
+
+void benchMapCreaturesInRange(bench::State& state) {
+    populateMap();
+    std::vector<Position> positions = randomPositions(256, MAP_RADIUS - 10, 12);
+    for (auto& pos : positions) pos.z = 7;
+
+    std::vector<std::shared_ptr<Creature>> creatures;
+    size_t matches = 0;
+    while (state.keepRunning()) {
+        for (const Position& pos : positions) {
+            matches += g_map.getCreaturesInRange(pos, 8, creatures);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * positions.size());
+    char label[32];
+    std::snprintf(label, sizeof(label), "%.1f creatures/query",
+                  static_cast<double>(matches) / (state.iterations() * positions.size()));
+    state.setLabel(label);
+}
+
+// Map::findPath takes walkability from items' ground and blocking flags,
+// which come from the .dat; the map here has no items, so known tiles are
+// walkable and unknown ones blocked. Otherwise this is Map::findPath: A*
+// with a getTile() per expanded node.
+void benchMapFindPath(bench::State& state) {
+    populateMap();
+    auto costAt = [](const Position& pos) -> uint32_t {
+        return g_map.getTile(pos) ? pathfinding::DEFAULT_STEP_COST : 0;
+    };
+
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> offset(-40, 40);
+    const Position start(MAP_CENTRE, MAP_CENTRE, 7);
+    std::vector<Position> goals;
+    while (goals.size() < 64) {
+        Position goal(static_cast<uint16_t>(MAP_CENTRE + offset(rng)), static_cast<uint16_t>(MAP_CENTRE + offset(rng)), 7);
+        if (costAt(goal) && goal != start) goals.push_back(goal);
+    }
+
+    std::vector<Position::Direction> path;
+    size_t found = 0;
+    while (state.keepRunning()) {
+        for (const Position& goal : goals) {
+            found += pathfinding::findPath(start, goal, 100, costAt, path);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * goals.size());
+    state.setLabel(std::to_string(found * 100 / std::max<uint64_t>(state.iterations() * goals.size(), 1)) + "% found");
+}
+
+// Packet parsing
+
+// Frames a session sends most of once the map is loaded: creature health
+// and turns, light and server messages
+std::vector<NetworkMessage> synthesizeFrames() {
+    std::mt19937 rng(21);
+    std::uniform_int_distribution<uint32_t> creature(0, MAP_CREATURES - 1);
+    std::uniform_int_distribution<int> offset(-8, 8);
+
+    std::vector<NetworkMessage> frames;
+    for (int i = 0; i < 2000; ++i) {
+        NetworkMessage msg;
+        for (int packet = 0; packet < 4; ++packet) {
+            switch ((i + packet) % 4) {
+                case 0:
+                    msg.writeByte(ServerOpcode::CreatureHealth);
+                    msg.writeU32(FIRST_CREATURE_ID + creature(rng));
+                    msg.writeByte(static_cast<uint8_t>(rng() % 101));
+                    break;
+                case 1:
+                    msg.writeByte(ServerOpcode::CreatureTurn);
+                    msg.writePosition(static_cast<uint16_t>(MAP_CENTRE + offset(rng)),
+                                      static_cast<uint16_t>(MAP_CENTRE + offset(rng)), 7);
+                    msg.writeByte(1);
+                    msg.writeByte(static_cast<uint8_t>(rng() % 4));
+                    break;
+                case 2:
+                    msg.writeByte(ServerOpcode::WorldLight);
+                    msg.writeByte(static_cast<uint8_t>(rng()));
+                    msg.writeByte(215);
+                    break;
+                case 3:
+                    msg.writeByte(ServerOpcode::TextMessage);
+                    msg.writeByte(static_cast<uint8_t>(TextMessageType::StatusSmall));
+                    msg.writeString("You lose 12 hitpoints due to an attack by a demon skeleton.");
+                    break;
+            }
+        }
+        msg.setPosition(NetworkMessage::HEADER_SIZE);
+        frames.push_back(std::move(msg));
+    }
+    return frames;
+}
+
+// Frames come back as the replayer hands them to the protocol
+bool loadFrames(const std::string& path, std::vector<NetworkMessage>& frames) {
+    PacketReplayer replayer;
+    if (!replayer.open(path)) return false;
+    replayer.setSpeed(PacketReplayer::Speed::Unthrottled);
+    while (!replayer.isFinished()) {
+        replayer.poll([&frames](NetworkMessage& frame) { frames.push_back(frame); });
+    }
+    return !frames.empty();
+}
+
+void benchProtocolParse(bench::State& state) {
+    populateMap();
+
+    // Replay mode parses plaintext frames, as captured, without a server
+    std::string path = g_capturePath;
+    std::filesystem::path synthetic;
+    if (path.empty()) {
+        synthetic = std::filesystem::temp_directory_path() / "shadow-client-bench.sotc";
+        PacketRecorder recorder;
+        if (!recorder.open(synthetic.string())) {
+            state.skip("cannot write " + synthetic.string());
+            return;
+        }
+        for (const NetworkMessage& frame : synthesizeFrames()) {
+            recorder.record(frame);
+        }
+        recorder.close();
+        path = synthetic.string();
+    }
+
+    std::vector<NetworkMessage> frames;
+    client::ProtocolGame protocol;
+    bool loaded = loadFrames(path, frames) &&
+                  protocol.startReplay(path, PacketReplayer::Speed::Unthrottled);
+    if (!synthetic.empty()) {
+        std::error_code ignored;
+        std::filesystem::remove(synthetic, ignored);
+    }
+    if (!loaded) {
+        state.skip("cannot replay " + path);
+        return;
+    }
+
+    uint64_t bytes = 0;
+    for (const NetworkMessage& frame : frames) bytes += frame.getRemainingSize();
+
+    while (state.keepRunning()) {
+        for (const NetworkMessage& frame : frames) {
+            NetworkMessage msg = frame;
+            protocol.onRecvMessage(msg);
+        }
+    }
+    protocol.stopReplay();
+    state.setBytesProcessed(state.iterations() * bytes);
+    state.setItemsProcessed(state.iterations() * frames.size());
+    state.setLabel(g_capturePath.empty() ? "synthetic" : g_capturePath);
+}
+
+// Sprites
+
+struct SpriteStream {
+    size_t offset;
+    size_t size;
+};
+
+// Same layout rules as ThingTypeManager::loadSpr
+std::vector<SpriteStream> indexSprites(const std::vector<uint8_t>& data) {
+    auto read32 = [&data](size_t pos) {
+        return data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | (static_cast<uint32_t>(data[pos + 3]) << 24);
+    };
+
+    std::vector<SpriteStream> sprites;
+    if (data.size() < 8) return sprites;
+
+    size_t pos = 4;
+    uint32_t count = data[pos] | (data[pos + 1] << 8);
+    if (count < 0xFFFF) {
+        pos += 2;
+    } else {
+        count = read32(pos);
+        pos += 4;
+    }
+
+    for (uint32_t i = 0; i < count && pos + 4 <= data.size(); ++i, pos += 4) {
+        size_t offset = read32(pos);
+        if (offset == 0 || offset + 5 > data.size()) continue;
+        size_t size = data[offset + 3] | (data[offset + 4] << 8);
+        if (offset + 5 + size > data.size()) continue;
+        sprites.push_back({offset + 5, size});
+    }
+    return sprites;
+}
+
+// Pixel streams alone: short transparent gaps between longer colored runs
+std::vector<uint8_t> synthesizeSprites(size_t count, std::vector<SpriteStream>& sprites) {
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data;
+    for (size_t i = 0; i < count; ++i) {
+        size_t start = data.size();
+        size_t written = 0;
+        while (written < spritecodec::PIXEL_COUNT) {
+            size_t transparent = std::min<size_t>(rng() % 12, spritecodec::PIXEL_COUNT - written);
+            written += transparent;
+            size_t colored = std::min<size_t>(rng() % 40, spritecodec::PIXEL_COUNT - written);
+            written += colored;
+
+            data.insert(data.end(), {static_cast<uint8_t>(transparent), 0, static_cast<uint8_t>(colored), 0});
+            for (size_t byte = 0; byte < colored * 3; ++byte) {
+                data.push_back(static_cast<uint8_t>(rng()));
+            }
+        }
+        sprites.push_back({start, data.size() - start});
+    }
+    return data;
+}
+
+void benchSpriteDecode(bench::State& state) {
+    std::vector<uint8_t> data;
+    std::vector<SpriteStream> sprites;
+    if (!g_sprPath.empty()) {
+        std::ifstream file(g_sprPath, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        sprites = indexSprites(data);
+        if (sprites.empty()) {
+            state.skip("no sprites in " + g_sprPath);
+            return;
+        }
+        // A slice, so one iteration stays short on full .spr files
+        sprites.resize(std::min<size_t>(sprites.size(), 2000));
+    } else {
+        data = synthesizeSprites(2000, sprites);
+    }
+
+    spritecodec::Kernel kernel = spritecodec::getBestKernel();
+    std::vector<uint8_t> rgba(spritecodec::RGBA_SIZE);
+    while (state.keepRunning()) {
+        for (const SpriteStream& sprite : sprites) {
+            spritecodec::decode(kernel, data.data() + sprite.offset, sprite.size, rgba.data());
+        }
+        bench::doNotOptimize(rgba[0]);
+    }
+    state.setItemsProcessed(state.iterations() * sprites.size());
+    state.setBytesProcessed(state.iterations() * sprites.size() * spritecodec::RGBA_SIZE);
+    state.setLabel(spritecodec::getKernelName(kernel));
+}
+
+// Thing type flags, checked the way tiles test walkability and stacking
+
+void benchThingTypeHasAttr(bench::State& state) {
+    std::mt19937 rng(31);
+    std::vector<ThingType> types(4096);
+    for (auto& type : types) {
+        std::vector<uint8_t> dat;
+        if (rng() % 4 == 0) dat.insert(dat.end(), {0, 150, 0});     // Ground, speed 150
+        for (uint8_t attr : {static_cast<uint8_t>(ThingAttr::Stackable), static_cast<uint8_t>(ThingAttr::NotWalkable),
+                             static_cast<uint8_t>(ThingAttr::NotPathable), static_cast<uint8_t>(ThingAttr::Pickupable)}) {
+            if (rng() % 3 == 0) dat.push_back(attr);
+        }
+        dat.insert(dat.end(), {0xFF, 1, 1, 1, 1, 1, 1, 1});
+        type.load(dat.data(), dat.size());
+    }
+
+    size_t walkable = 0;
+    while (state.keepRunning()) {
+        for (const ThingType& type : types) {
+            walkable += type.isGround() + (!type.blocksSolid() && !type.blocksPathfind()) +
+                        type.hasAttr(ThingAttr::Stackable);
+        }
+    }
+    bench::doNotOptimize(walkable);
+    state.setItemsProcessed(state.iterations() * types.size());
+}
+
+// Event dispatch
+
+struct BenchEvent {
+    uint32_t creatureId;
+    uint32_t value;
+};
+
+constexpr int EVENT_SUBSCRIBERS = 8;
+constexpr int EVENTS_PER_ITERATION = 1000;
+
+void benchDispatcherEmit(bench::State& state) {
+    uint64_t received = 0;
+    std::vector<EventDispatcher::CallbackId> ids;
+    for (int i = 0; i < EVENT_SUBSCRIBERS; ++i) {
+        ids.push_back(g_dispatcher.subscribe<BenchEvent>([&received](const BenchEvent& e) { received += e.value; }));
+    }
+
+    while (state.keepRunning()) {
+        for (uint32_t i = 0; i < EVENTS_PER_ITERATION; ++i) {
+            g_dispatcher.emit(BenchEvent{i, 1});
+        }
+    }
+    for (auto id : ids) g_dispatcher.unsubscribe(id);
+    bench::doNotOptimize(received);
+    state.setItemsProcessed(state.iterations() * EVENTS_PER_ITERATION);
+}
+
+// Posted from the main thread and delivered by the next poll
+void benchDispatcherPostPoll(bench::State& state) {
+    uint64_t received = 0;
+    std::vector<EventDispatcher::CallbackId> ids;
+    for (int i = 0; i < EVENT_SUBSCRIBERS; ++i) {
+        ids.push_back(g_dispatcher.subscribe<BenchEvent>([&received](const BenchEvent& e) { received += e.value; }));
+    }
+
+    size_t maxPerPoll = g_dispatcher.getMaxEventsPerPoll();
+    g_dispatcher.setMaxEventsPerPoll(EVENTS_PER_ITERATION);
+    while (state.keepRunning()) {
+        for (uint32_t i = 0; i < EVENTS_PER_ITERATION; ++i) {
+            g_dispatcher.post(BenchEvent{i, 1});
+        }
+        g_dispatcher.poll();
+    }
+    g_dispatcher.setMaxEventsPerPoll(maxPerPoll);
+    for (auto id : ids) g_dispatcher.unsubscribe(id);
+    bench::doNotOptimize(received);
+    state.setItemsProcessed(state.iterations() * EVENTS_PER_ITERATION);
+}
+
+// Widget hit-testing: overlapping windows, each a grid of slots with icons,
+// like open containers over the game screen
+
+void benchWidgetHitTest(bench::State& state) {
+    auto root = std::make_shared<UIWidget>();
+    root->setRect(Rect(0, 0, 1920, 1080));
+    for (int w = 0; w < 12; ++w) {
+        auto window = std::make_shared<UIWidget>();
+        root->addChild(window);
+        window->setRect(Rect(40 + (w % 6) * 280, 60 + (w / 6) * 420, 300, 440));
+        for (int slot = 0; slot < 40; ++slot) {
+            auto item = std::make_shared<UIWidget>();
+            window->addChild(item);
+            item->setRect(Rect(8 + (slot % 5) * 56, 30 + (slot / 5) * 50, 48, 44));
+            auto icon = std::make_shared<UIWidget>();
+            item->addChild(icon);
+            icon->setRect(Rect(6, 4, 36, 36));
+        }
+    }
+
+    std::mt19937 rng(41);
+    std::vector<std::pair<int, int>> points(1024);
+    for (auto& point : points) point = {static_cast<int>(rng() % 1920), static_cast<int>(rng() % 1080)};
+
+    size_t hits = 0;
+    while (state.keepRunning()) {
+        for (const auto& [x, y] : points) {
+            hits += root->getChildByPos(x, y) != nullptr;
+        }
+    }
+    bench::doNotOptimize(hits);
+    state.setItemsProcessed(state.iterations() * points.size());
+    root->destroyChildren();
+}
+
+const bench::Benchmark BENCHMARKS[] = {
+    {"net/NetworkMessage/write", benchMessageWrite},
+    {"net/NetworkMessage/read", benchMessageRead},
+    {"net/XTEACipher/encrypt", benchXteaEncrypt},
+    {"net/XTEACipher/decrypt", benchXteaDecrypt},
+    {"net/ProtocolGame/parsePacket", benchProtocolParse},
+    {"map/getTile", benchMapGetTile},
+    {"map/getCreaturesInRange", benchMapCreaturesInRange},
+    {"map/findPath", benchMapFindPath},
+    {"sprite/decode", benchSpriteDecode},
+    {"thing/hasAttr", benchThingTypeHasAttr},
+    {"event/emit", benchDispatcherEmit},
+    {"event/postAndPoll", benchDispatcherPostPoll},
+    {"ui/getChildByPos", benchWidgetHitTest},
+};
+
+int usage() {
+    std::cerr << "usage: shadow-client-bench [--filter <text>] [--json <file|->] [--min-time <s>]\n"
+                 "           [--repetitions <n>] [--capture <file.sotc>] [--spr <Tibia.spr>]" << std::endl;
+    return 2;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    bench::Options options;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) return usage();
+        std::string value = argv[i + 1];
+        if (flag == "--filter") options.filter = value;
+        else if (flag == "--json") jsonPath = value;
+        else if (flag == "--min-time") options.minTime = std::max(0.01, std::stod(value));
+        else if (flag == "--repetitions") options.repetitions = std::max(1, std::stoi(value));
+        else if (flag == "--capture") g_capturePath = value;
+        else if (flag == "--spr") g_sprPath = value;
+        else return usage();
+    }
+
+    // The table goes to stderr when the JSON takes stdout
+    std::FILE* table = jsonPath == "-" ? stderr : stdout;
+
+    std::vector<bench::Result> results;
+    for (const auto& benchmark : BENCHMARKS) {
+        if (!options.filter.empty() && std::string(benchmark.name).find(options.filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(bench::runBenchmark(benchmark, options));
+        bench::printResult(results.back(), table);
+    }
+
+    if (!jsonPath.empty() && !bench::writeJson(jsonPath, argv[0], results)) {
+        std::cerr << "cannot write " << jsonPath << std::endl;
+        return 1;
+    }
+
+    g_map.terminate();
+    return 0;
+}
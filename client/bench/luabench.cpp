@@ -0,0 +1,163 @@
+/**
+ * Shadow OT Client - Lua Binding Microbenchmark
+ *
+ * Calls a getter and a one-argument method from a Lua loop through three
+ * bindings of the same native object: a type-erased getter returning
+ * std::any (the design LuaInterface declared), a hand-written function
+ * checking its userdata by metatable name, and the generated trampolines
+ * of luabinder.h. Reports the time per call and checks the three agree.
+ */
+
+#include <framework/luaengine/luabinder.h>
+
+#include <any>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+#include <lualib.h>
+}
+
+using namespace shadow::framework;
+
+namespace {
+
+constexpr int CALLS = 5000000;
+
+struct Unit {
+    uint32_t level{42};
+    uint32_t getLevel() const { return level; }
+    bool hasFlag(uint8_t flag) const { return (level >> flag) & 1; }
+};
+
+// Type-erased path: every call goes through a std::function and a
+// std::any holding the result
+using BoxedGetter = std::function<std::any(Unit*)>;
+
+int boxedCall(lua_State* L) {
+    auto* getter = static_cast<BoxedGetter*>(lua_touserdata(L, lua_upvalueindex(1)));
+    auto** unit = static_cast<Unit**>(luaL_checkudata(L, 1, "BoxedUnit"));
+    std::any value = (*getter)(*unit);
+    lua_pushinteger(L, std::any_cast<uint32_t>(value));
+    return 1;
+}
+
+int boxedHasFlag(lua_State* L) {
+    auto* method = static_cast<std::function<std::any(Unit*, std::any)>*>(lua_touserdata(L, lua_upvalueindex(1)));
+    auto** unit = static_cast<Unit**>(luaL_checkudata(L, 1, "BoxedUnit"));
+    std::any value = (*method)(*unit, std::any(static_cast<uint8_t>(luaL_checkinteger(L, 2))));
+    lua_pushboolean(L, std::any_cast<bool>(value));
+    return 1;
+}
+
+// Hand-written path, as luabindings.cpp did it
+int namedGetLevel(lua_State* L) {
+    auto** unit = static_cast<Unit**>(luaL_checkudata(L, 1, "NamedUnit"));
+    lua_pushinteger(L, (*unit)->getLevel());
+    return 1;
+}
+
+int namedHasFlag(lua_State* L) {
+    auto** unit = static_cast<Unit**>(luaL_checkudata(L, 1, "NamedUnit"));
+    lua_pushboolean(L, (*unit)->hasFlag(static_cast<uint8_t>(luaL_checkinteger(L, 2))));
+    return 1;
+}
+
+void pushNamed(lua_State* L, Unit* unit, const char* metatable) {
+    auto** box = static_cast<Unit**>(lua_newuserdata(L, sizeof(Unit*)));
+    *box = unit;
+    luaL_getmetatable(L, metatable);
+    lua_setmetatable(L, -2);
+}
+
+double runLoop(lua_State* L, const char* global, const char* body, double& result) {
+    char script[512];
+    std::snprintf(script, sizeof(script),
+                  "local o = %s local s = 0 for i = 1, %d do %s end return s", global, CALLS, body);
+
+    auto begin = std::chrono::steady_clock::now();
+    if (luaL_dostring(L, script) != 0) {
+        std::cout << "lua error: " << lua_tostring(L, -1) << std::endl;
+        lua_pop(L, 1);
+        return -1.0;
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    result = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+    return elapsed / CALLS;
+}
+
+} // anonymous namespace
+
+int main() {
+    lua_State* L = luaL_newstate();
+    luaL_openlibs(L);
+    Unit unit;
+
+    BoxedGetter boxedGetter = [](Unit* u) -> std::any { return u->getLevel(); };
+    std::function<std::any(Unit*, std::any)> boxedMethod = [](Unit* u, std::any flag) -> std::any {
+        return u->hasFlag(std::any_cast<uint8_t>(flag));
+    };
+
+    luaL_newmetatable(L, "BoxedUnit");
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    lua_pushlightuserdata(L, &boxedGetter);
+    lua_pushcclosure(L, boxedCall, 1);
+    lua_setfield(L, -2, "getLevel");
+    lua_pushlightuserdata(L, &boxedMethod);
+    lua_pushcclosure(L, boxedHasFlag, 1);
+    lua_setfield(L, -2, "hasFlag");
+    lua_pop(L, 1);
+    pushNamed(L, &unit, "BoxedUnit");
+    lua_setglobal(L, "boxed");
+
+    luaL_newmetatable(L, "NamedUnit");
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    lua::setMethod(L, "getLevel", namedGetLevel);
+    lua::setMethod(L, "hasFlag", namedHasFlag);
+    lua_pop(L, 1);
+    pushNamed(L, &unit, "NamedUnit");
+    lua_setglobal(L, "named");
+
+    lua::registerClass<Unit>(L, "Unit");
+    lua::setMethod(L, "getLevel", &lua::method<&Unit::getLevel>);
+    lua::setMethod(L, "hasFlag", &lua::method<&Unit::hasFlag>);
+    lua_pop(L, 1);
+    lua::pushObject(L, &unit);
+    lua_setglobal(L, "bound");
+
+    int failures = 0;
+    std::cout << CALLS << " calls per loop\n";
+    for (const char* body : {"s = s + o:getLevel()", "if o:hasFlag(i % 8) then s = s + 1 end"}) {
+        std::cout << "  " << body << "\n";
+
+        double expected = 0.0;
+        bool first = true;
+        for (const char* global : {"boxed", "named", "bound"}) {
+            double result = 0.0;
+            double ns = runLoop(L, global, body, result);
+            if (ns < 0.0) {
+                failures++;
+                continue;
+            }
+            std::cout << "    " << std::setw(6) << global << ": " << std::fixed << std::setprecision(1)
+                      << std::setw(7) << ns << " ns/call\n";
+
+            if (first) {
+                expected = result;
+                first = false;
+            } else if (result != expected) {
+                std::cout << "    MISMATCH " << result << " != " << expected << "\n";
+                failures++;
+            }
+        }
+    }
+
+    lua_close(L);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/**
+ * Shadow OT Client - Path Finder Microbenchmark
+ *
+ * Runs the A* search over a synthetic map with random obstacles and mixed
+ * ground speeds, validates each path and reports the time per search for
+ * short, medium and long routes.
+ */
+
+#include <client/pathfinder.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+using namespace shadow::client;
+
+namespace {
+
+constexpr int GRID = 2400;
+constexpr uint16_t BASE = 1000;
+
+struct SyntheticMap {
+    std::vector<uint16_t> cost;   // 0 = blocked
+
+    explicit SyntheticMap(uint32_t seed) : cost(static_cast<size_t>(GRID) * GRID) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> roll(0, 99);
+        for (auto& c : cost) {
+            int r = roll(rng);
+            c = r < 15 ? 0 : (r < 25 ? 200 : 100);
+        }
+    }
+
+    uint32_t at(const Position& pos) const {
+        int x = pos.x - BASE;
+        int y = pos.y - BASE;
+        if (x < 0 || y < 0 || x >= GRID || y >= GRID) return 0;
+        return cost[static_cast<size_t>(y) * GRID + x];
+    }
+};
+
+// A path is valid if every step lands on a walkable tile and it ends on the goal
+bool validate(const SyntheticMap& map, Position pos, const Position& goal,
+              const std::vector<Position::Direction>& path) {
+    for (size_t i = 0; i < path.size(); ++i) {
+        pos = pos.translated(path[i]);
+        if (map.at(pos) == 0 && !(i + 1 == path.size() && pos == goal)) {
+            return false;
+        }
+    }
+    return pos == goal;
+}
+
+} // anonymous namespace
+
+int main() {
+    SyntheticMap map(1234);
+    auto costAt = [&map](const Position& pos) { return map.at(pos); };
+
+    const Position start(BASE + 100, BASE + 100, 7);
+    std::mt19937 rng(99);
+    int failures = 0;
+
+    for (int distance : {10, 100, 1000}) {
+        const int searches = distance >= 1000 ? 20 : (distance >= 100 ? 200 : 5000);
+        std::uniform_int_distribution<int> offset(distance / 2, distance);
+
+        std::vector<Position::Direction> path;
+        int found = 0;
+        size_t steps = 0;
+        double totalUs = 0;
+
+        for (int i = 0; i < searches; ++i) {
+            Position goal(static_cast<uint16_t>(start.x + offset(rng)),
+                          static_cast<uint16_t>(start.y + offset(rng) / 2), start.z);
+
+            auto begin = std::chrono::steady_clock::now();
+            bool ok = pathfinding::findPath(start, goal, distance, costAt, path);
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+            totalUs += elapsed.count();
+
+            if (!ok) continue;
+            if (!validate(map, start, goal, path)) {
+                failures++;
+                continue;
+            }
+            found++;
+            steps += path.size();
+        }
+
+        std::cout << std::setw(5) << distance << " tiles: "
+                  << std::fixed << std::setprecision(1) << std::setw(10) << totalUs / searches << " us/search"
+                  << "  found " << found << "/" << searches
+                  << "  avg " << (found ? steps / found : 0) << " steps\n";
+    }
+
+    if (failures) {
+        std::cout << failures << " INVALID paths" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/**
+ * Shadow OT Client - Sprite Decoder Microbenchmark
+ *
+ * Decodes every sprite of a .spr file (or a synthetic one when no path is
+ * given) with each supported kernel, checks the output against the scalar
+ * kernel and reports decode throughput.
+ *
+ *   shadow-bench-sprite [Tibia.spr]
+ */
+
+#include <client/spritedecoder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using namespace shadow::client;
+
+namespace {
+
+// Pixel stream of one sprite within the file
+struct SpriteStream {
+    size_t offset;
+    size_t size;
+};
+
+uint32_t read32(const std::vector<uint8_t>& data, size_t pos) {
+    return data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | (static_cast<uint32_t>(data[pos + 3]) << 24);
+}
+
+// Same layout rules as ThingTypeManager::loadSpr
+std::vector<SpriteStream> indexSprites(const std::vector<uint8_t>& data) {
+    std::vector<SpriteStream> sprites;
+    if (data.size() < 8) return sprites;
+
+    size_t pos = 4;
+    uint32_t count = data[pos] | (data[pos + 1] << 8);
+    if (count < 0xFFFF) {
+        pos += 2;
+    } else {
+        count = read32(data, pos);
+        pos += 4;
+    }
+
+    for (uint32_t i = 0; i < count && pos + 4 <= data.size(); ++i, pos += 4) {
+        size_t offset = read32(data, pos);
+        if (offset == 0 || offset + 5 > data.size()) continue;
+        size_t size = data[offset + 3] | (data[offset + 4] << 8);
+        if (offset + 5 + size > data.size()) continue;
+        sprites.push_back({offset + 5, size});
+    }
+    return sprites;
+}
+
+// Short transparent gaps between longer colored runs, like item sprites
+std::vector<uint8_t> synthesizeSpr(uint16_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(4 + 2 + count * 4);
+    data[4] = count & 0xFF;
+    data[5] = count >> 8;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t offset = static_cast<uint32_t>(data.size());
+        std::memcpy(&data[6 + i * 4], &offset, 4);
+
+        std::vector<uint8_t> runs;
+        size_t written = 0;
+        while (written < spritecodec::PIXEL_COUNT) {
+            uint16_t transparent = static_cast<uint16_t>(rng() % 12);
+            uint16_t colored = static_cast<uint16_t>(rng() % 40);
+            transparent = static_cast<uint16_t>(std::min<size_t>(transparent, spritecodec::PIXEL_COUNT - written));
+            written += transparent;
+            colored = static_cast<uint16_t>(std::min<size_t>(colored, spritecodec::PIXEL_COUNT - written));
+            written += colored;
+
+            runs.push_back(transparent & 0xFF);
+            runs.push_back(transparent >> 8);
+            runs.push_back(colored & 0xFF);
+            runs.push_back(colored >> 8);
+            for (int byte = 0; byte < colored * 3; ++byte) {
+                runs.push_back(static_cast<uint8_t>(rng()));
+            }
+        }
+
+        data.insert(data.end(), {255, 0, 255});
+        data.push_back(runs.size() & 0xFF);
+        data.push_back((runs.size() >> 8) & 0xFF);
+        data.insert(data.end(), runs.begin(), runs.end());
+    }
+    return data;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    constexpr int ITERATIONS = 5;
+
+    std::vector<uint8_t> data;
+    if (argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        std::cout << argv[1] << ": " << data.size() / (1024 * 1024) << " MB\n";
+    } else {
+        data = synthesizeSpr(40000, 1234);
+        std::cout << "synthetic: " << data.size() / (1024 * 1024) << " MB\n";
+    }
+
+    std::vector<SpriteStream> sprites = indexSprites(data);
+    if (sprites.empty()) {
+        std::cout << "no sprites" << std::endl;
+        return 1;
+    }
+    std::cout << sprites.size() << " sprites\n";
+
+    std::vector<uint8_t> expected(sprites.size() * spritecodec::RGBA_SIZE);
+    for (size_t i = 0; i < sprites.size(); ++i) {
+        spritecodec::decode(spritecodec::Kernel::Scalar, data.data() + sprites[i].offset, sprites[i].size,
+                            expected.data() + i * spritecodec::RGBA_SIZE);
+    }
+
+    int failures = 0;
+    double scalarRate = 0;
+    std::vector<uint8_t> output(expected.size());
+
+    for (auto kernel : {spritecodec::Kernel::Scalar, spritecodec::Kernel::SSSE3, spritecodec::Kernel::NEON}) {
+        if (!spritecodec::isKernelSupported(kernel)) {
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+            for (size_t i = 0; i < sprites.size(); ++i) {
+                spritecodec::decode(kernel, data.data() + sprites[i].offset, sprites[i].size,
+                                    output.data() + i * spritecodec::RGBA_SIZE);
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        bool ok = output == expected;
+        double rate = sprites.size() * ITERATIONS / elapsed.count();
+        if (kernel == spritecodec::Kernel::Scalar) scalarRate = rate;
+
+        std::cout << std::left << std::setw(8) << spritecodec::getKernelName(kernel) << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(12) << rate << " sprites/s"
+                  << std::setprecision(1) << std::setw(10) << rate * spritecodec::RGBA_SIZE / (1024.0 * 1024.0) << " MB/s out"
+                  << "  x" << std::setprecision(2) << rate / scalarRate
+                  << (ok ? "" : "  MISMATCH") << "\n";
+        if (!ok) failures++;
+    }
+
+    std::cout << "selected: " << spritecodec::getKernelName(spritecodec::getBestKernel()) << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -31,6 +31,31 @@ local MESSAGE_TYPES = {
 local DEFAULT_CHANNEL = 0
 local LOCAL_CHANNEL = 0xFFFF
 
+-- Per-channel history; the oldest message is overwritten past this
+local MAX_MESSAGES = 1000
+local MESSAGE_ROW_HEIGHT = 14
+
+-- Bounded ring of messages: appending never shifts the history, and
+-- index 1 is always the oldest message kept
+local function newHistory()
+    return { items = {}, first = 1, count = 0 }
+end
+
+local function pushMessage(history, msg)
+    if history.count < MAX_MESSAGES then
+        history.count = history.count + 1
+        history.items[(history.first + history.count - 2) % MAX_MESSAGES + 1] = msg
+    else
+        history.items[history.first] = msg
+        history.first = history.first % MAX_MESSAGES + 1
+    end
+end
+
+local function getMessage(history, index)
+    if index < 1 or index > history.count then return nil end
+    return history.items[(history.first + index - 2) % MAX_MESSAGES + 1]
+end
+
 function Console.init()
     connect(g_game, {
         onGameStart = Console.onGameStart,
@@ -90,7 +115,7 @@ function Console.createChannel(channelId, name, isLocal)
     local channel = {
         id = channelId,
         name = name,
-        messages = {},
+        messages = newHistory(),
         isLocal = isLocal or false,
         isPrivate = false
     }
@@ -158,21 +183,39 @@ function Console.closeChannel(channelId)
     end
 end
 
+-- The buffer is a virtual list: only the rows in view exist as widgets,
+-- rebound to other messages as it scrolls
 function Console.refreshBuffer()
-    consoleBuffer:destroyChildren()
-
-    if not activeChannel then return end
-
-    for _, msg in ipairs(activeChannel.messages) do
-        Console.addMessageWidget(msg)
+    if not activeChannel then
+        consoleBuffer:setItemCount(0)
+        return
     end
 
+    local history = activeChannel.messages
+    consoleBuffer:setVirtualList(history.count, MESSAGE_ROW_HEIGHT, 'ConsoleMessage', function(widget, index)
+        local msg = getMessage(history, index)
+        if msg then
+            Console.bindMessageWidget(widget, msg)
+        end
+    end)
     consoleBuffer:scrollToBottom()
 end
 
-function Console.addMessageWidget(msg)
-    local widget = g_ui.createWidget('ConsoleMessage', consoleBuffer)
+-- Show a new message of the active channel, following it when the view
+-- was at the bottom
+function Console.appendMessage(channel)
+    if not activeChannel or activeChannel.id ~= channel.id then return end
+
+    if channel.messages.count < MAX_MESSAGES then
+        consoleBuffer:setItemCount(channel.messages.count)
+    else
+        -- Every index moved down one
+        consoleBuffer:refreshRows()
+    end
+    consoleBuffer:scrollToBottom()
+end
 
+function Console.bindMessageWidget(widget, msg)
     -- Time
     widget:getChildById('time'):setText(msg.time)
 
@@ -187,6 +230,7 @@ function Console.addMessageWidget(msg)
         end
     else
         senderWidget:setText('')
+        senderWidget.onClick = nil
     end
 
     -- Message
@@ -208,18 +252,8 @@ function Console.onTalk(name, level, type, text, channelId, pos)
         position = pos
     }
 
-    table.insert(targetChannel.messages, msg)
-
-    -- Limit message history
-    while #targetChannel.messages > 1000 do
-        table.remove(targetChannel.messages, 1)
-    end
-
-    -- Update display if active
-    if activeChannel and activeChannel.id == targetChannel.id then
-        Console.addMessageWidget(msg)
-        consoleBuffer:scrollToBottom()
-    end
+    pushMessage(targetChannel.messages, msg)
+    Console.appendMessage(targetChannel)
 end
 
 function Console.onChannelList(channelList)
@@ -359,7 +393,7 @@ end
 
 function Console.clear()
     for id, channel in pairs(channels) do
-        channel.messages = {}
+        channel.messages = newHistory()
     end
     Console.refreshBuffer()
 end
@@ -374,11 +408,8 @@ function Console.addMessage(text, type)
 
     local channel = channels[LOCAL_CHANNEL]
     if channel then
-        table.insert(channel.messages, msg)
-        if activeChannel and activeChannel.id == LOCAL_CHANNEL then
-            Console.addMessageWidget(msg)
-            consoleBuffer:scrollToBottom()
-        end
+        pushMessage(channel.messages, msg)
+        Console.appendMessage(channel)
     end
 end
 
@@ -53,9 +53,15 @@ Bot.state = {
     lastAttack = 0,
     lastLoot = 0,
     currentTarget = nil,
-    walkPath = {}
+    walkPath = {},
+    tasks = {}
 }
 
+-- Server opcode carrying health and mana
+local PLAYER_STATS_OPCODE = 0xA0
+-- Heal cooldowns run out without a packet; re-check this often regardless
+local HEAL_RECHECK_MS = 1000
+
 -- Callbacks
 Bot.callbacks = {
     onHealthLow = nil,
@@ -164,8 +170,12 @@ function Bot.start()
     Bot.state.running = true
     Bot.config.enabled = true
 
-    -- Start bot loop
-    scheduleEvent(Bot.loop, 100)
+    -- Healing wakes on stat updates, the rest on a short tick
+    Bot.state.tasks = {
+        spawn(Bot.loop),
+        spawn(Bot.healLoop),
+        spawn(Bot.deathLoop)
+    }
 
     print("[Bot] Bot started in zone: " .. Bot.config.zone.name)
     return true
@@ -178,40 +188,58 @@ function Bot.stop()
     Bot.state.currentTarget = nil
     Bot.state.walkPath = {}
 
+    for _, task in ipairs(Bot.state.tasks) do
+        killTask(task)
+    end
+    Bot.state.tasks = {}
+
     print("[Bot] Bot stopped")
 end
 
 -- Main bot loop
 function Bot.loop()
-    if not Bot.state.running then return end
-    if not Bot.checkZone() then
-        Bot.stop()
-        print("[Bot] Left authorized zone - stopping bot")
-        return
-    end
+    while Bot.state.running do
+        if not Bot.checkZone() then
+            Bot.stop()
+            print("[Bot] Left authorized zone - stopping bot")
+            return
+        end
 
-    local player = g_game.getLocalPlayer()
-    if not player then return end
+        local player = g_game.getLocalPlayer()
+        if player then
+            -- Auto-attack check
+            if Bot.config.autoAttack.enabled then
+                Bot.checkAttack(player)
+            end
 
-    -- Auto-heal check
-    if Bot.config.autoHeal.enabled then
-        Bot.checkHeal(player)
-    end
+            -- Cavebot waypoint check
+            if Bot.config.cavebot.enabled then
+                Bot.checkWaypoint(player)
+            end
+        end
 
-    -- Auto-attack check
-    if Bot.config.autoAttack.enabled then
-        Bot.checkAttack(player)
+        wait(100)
     end
+end
 
-    -- Cavebot waypoint check
-    if Bot.config.cavebot.enabled then
-        Bot.checkWaypoint(player)
+-- Healing only reacts to health and mana changes
+function Bot.healLoop()
+    while Bot.state.running do
+        local player = g_game.getLocalPlayer()
+        if player and Bot.config.autoHeal.enabled then
+            Bot.checkHeal(player)
+        end
+
+        waitPacket(PLAYER_STATS_OPCODE, HEAL_RECHECK_MS)
     end
+end
 
-    -- Schedule next loop iteration
-    if Bot.state.running then
-        scheduleEvent(Bot.loop, 100)
+function Bot.deathLoop()
+    local _, deathType = waitFor("death")
+    if Bot.callbacks.onDeath then
+        Bot.callbacks.onDeath(deathType)
     end
+    Bot.stop()
 end
 
 -- Auto-heal logic
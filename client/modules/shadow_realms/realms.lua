@@ -163,6 +163,9 @@ function Realms.selectRealm(widget)
     widget:setBackgroundColor('#3d5a80')
     connectButton:setEnabled(true)
 
+    -- Connects ahead of the login that usually follows
+    g_realms.selectRealm(widget.realmData.id)
+
     -- Update theme preview
     Realms.updateThemePreview(widget.realmData)
 end
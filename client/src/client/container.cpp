@@ -55,6 +55,93 @@ void Container::updateItem(int slot, ItemPtr item) {
     }
 }
 
+void Container::updateItem(int slot, const ItemDescription& description) {
+    if (slot < 0 || slot >= static_cast<int>(m_items.size())) return;
+
+    const ItemPtr& item = m_items[slot];
+    if (item->matches(description)) return;
+    if (item->getId() != description.id) {
+        updateItem(slot, Item::create(description));
+        return;
+    }
+
+    item->setSubTypeFrom(description);
+    if (m_onItemUpdate) {
+        m_onItemUpdate(slot, item);
+    }
+}
+
+void Container::setItems(const ItemDescription* items, size_t count) {
+    size_t oldCount = m_items.size();
+    size_t prefix = 0;
+    while (prefix < oldCount && prefix < count && m_items[prefix]->matches(items[prefix])) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < oldCount - prefix && suffix < count - prefix &&
+           m_items[oldCount - 1 - suffix]->matches(items[count - 1 - suffix])) {
+        suffix++;
+    }
+
+    size_t oldEnd = oldCount - suffix;
+    size_t newEnd = count - suffix;
+    size_t oldMiddle = oldEnd - prefix;
+    size_t newMiddle = newEnd - prefix;
+
+    // On a full page the rest shifts: loot landing in front pushes the last
+    // item out, and taking the first pulls the next page's in. Matching old
+    // slots against new ones a few places over makes that an insert and a
+    // drop rather than an update of every slot.
+    auto shiftMatches = [&](size_t oldShift, size_t newShift, size_t kept) {
+        for (size_t i = 0; i < kept; ++i) {
+            if (!m_items[prefix + oldShift + i]->matches(items[prefix + newShift + i])) return false;
+        }
+        return true;
+    };
+    auto applyShift = [&](size_t oldShift, size_t newShift, size_t kept) {
+        for (size_t i = 0; i < oldShift; ++i) {
+            removeItem(static_cast<int>(prefix));
+        }
+        for (size_t i = oldShift + kept; i < oldMiddle; ++i) {
+            removeItem(static_cast<int>(prefix + kept));
+        }
+        for (size_t i = 0; i < newShift; ++i) {
+            insertItem(static_cast<int>(prefix + i), Item::create(items[prefix + i]));
+        }
+        for (size_t i = prefix + newShift + kept; i < newEnd; ++i) {
+            insertItem(static_cast<int>(i), Item::create(items[i]));
+        }
+    };
+    for (size_t shift = 1; shift <= MAX_DIFF_SHIFT; ++shift) {
+        if (shift < newMiddle) {
+            size_t kept = std::min(oldMiddle, newMiddle - shift);
+            if (shiftMatches(0, shift, kept)) {
+                applyShift(0, shift, kept);
+                return;
+            }
+        }
+        if (shift < oldMiddle) {
+            size_t kept = std::min(oldMiddle - shift, newMiddle);
+            if (shiftMatches(shift, 0, kept)) {
+                applyShift(shift, 0, kept);
+                return;
+            }
+        }
+    }
+
+    // Otherwise slot by slot, with inserts or drops for the size change
+    size_t overlapEnd = std::min(oldEnd, newEnd);
+    for (size_t i = prefix; i < overlapEnd; ++i) {
+        updateItem(static_cast<int>(i), items[i]);
+    }
+    for (size_t i = newEnd; i < oldEnd; ++i) {
+        removeItem(static_cast<int>(overlapEnd));
+    }
+    for (size_t i = oldEnd; i < newEnd; ++i) {
+        insertItem(static_cast<int>(i), Item::create(items[i]));
+    }
+}
+
 void Container::clear() {
     m_items.clear();
 }
@@ -11,6 +11,7 @@
 #include <memory>
 #include <vector>
 #include <functional>
+#include <map>
 
 namespace shadow {
 namespace client {
@@ -40,8 +41,20 @@ public:
     void insertItem(int slot, ItemPtr item);
     void removeItem(int slot);
     void updateItem(int slot, ItemPtr item);
+    // Same id keeps the slot's object and only changes its count
+    void updateItem(int slot, const ItemDescription& description);
     void clear();
 
+    // Replace the contents with a full listing, as the server re-sends
+    // an open container. Slots equal at the front and back are left
+    // alone. The changed run in between is matched against itself shifted
+    // by up to MAX_DIFF_SHIFT slots, so items pushed along by an insert or
+    // removal at its front cost one insert and one drop; failing that it
+    // becomes updates in place and then removals or insertions. Each goes
+    // through the slot callbacks, so the UI touches only those slots.
+    static constexpr size_t MAX_DIFF_SHIFT = 4;
+    void setItems(const ItemDescription* items, size_t count);
+
     ItemPtr getItem(int slot) const;
     int getItemCount() const { return static_cast<int>(m_items.size()); }
     const std::vector<ItemPtr>& getItems() const { return m_items; }
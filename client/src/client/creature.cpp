@@ -5,8 +5,11 @@
 #include "creature.h"
 #include "thingtype.h"
 #include "tile.h"
+#include "map.h"
+#include <framework/core/objectpool.h>
 #include <framework/graphics/graphics.h>
 #include <algorithm>
+#include <array>
 #include <cmath>
 
 // g_graphics is declared in shadow::framework namespace
@@ -18,7 +21,7 @@ namespace client {
 Creature::Creature() = default;
 
 std::shared_ptr<Creature> Creature::create(uint32_t id) {
-    auto creature = std::make_shared<Creature>();
+    auto creature = framework::makePooled<Creature>();
     creature->setCreatureId(id);
     return creature;
 }
@@ -29,6 +32,18 @@ void Creature::turn(Position::Direction dir) {
     }
 }
 
+void Creature::setPosition(const Position& pos) {
+    Thing::setPosition(pos);
+    g_map.updateCreaturePosition(m_id, pos);
+}
+
+void Creature::setLight(uint8_t intensity, uint8_t color) {
+    if (m_lightIntensity == intensity && m_lightColor == color) return;
+    m_lightIntensity = intensity;
+    m_lightColor = color;
+    g_map.updateCreatureLight(m_id);
+}
+
 void Creature::walk(const Position& newPos, bool preWalk) {
     // Calculate walk duration based on speed and ground speed
     // Base formula: stepDuration = groundSpeed * 1000 / speed
@@ -41,6 +56,9 @@ void Creature::walk(const Position& newPos, bool preWalk) {
     // Calculate direction
     m_direction = m_position.directionTo(newPos);
 
+    // Range queries see the creature at its destination for the whole step
+    g_map.updateCreaturePosition(m_id, newPos);
+
     // Estimate walk duration (will be adjusted by ground speed)
     uint16_t groundSpeed = 150; // Default
     if (auto tile = getTile()) {
@@ -61,6 +79,7 @@ void Creature::cancelWalk() {
     m_walking = false;
     m_walkOffset = 0;
     m_walkTimer = 0;
+    g_map.updateCreaturePosition(m_id, m_position);
 }
 
 void Creature::stopWalk() {
@@ -140,9 +159,57 @@ void Creature::update(float deltaTime) {
     }
 }
 
+// Outfit palette index to color: 19 hues by 7 saturation/intensity steps,
+// the first hue column being grays
+static framework::Color outfitColor(uint8_t index) {
+    constexpr int HUE_STEPS = 19;
+    constexpr int SI_VALUES = 7;
+    int color = index < HUE_STEPS * SI_VALUES ? index : 0;
+
+    float hue = 0.0f, saturation = 0.0f, intensity = 0.0f;
+    if (color % HUE_STEPS != 0) {
+        static const float steps[SI_VALUES][2] = {
+            {0.25f, 1.00f}, {0.25f, 0.75f}, {0.50f, 0.75f}, {0.667f, 0.75f},
+            {1.00f, 1.00f}, {1.00f, 0.75f}, {1.00f, 0.50f}
+        };
+        hue = (color % HUE_STEPS) / 18.0f;
+        saturation = steps[color / HUE_STEPS][0];
+        intensity = steps[color / HUE_STEPS][1];
+    } else {
+        intensity = 1.0f - static_cast<float>(color) / HUE_STEPS / SI_VALUES;
+    }
+
+    if (intensity == 0.0f) return framework::Color::black();
+    if (saturation == 0.0f) {
+        uint8_t gray = static_cast<uint8_t>(intensity * 255);
+        return framework::Color(gray, gray, gray);
+    }
+
+    float low = intensity * (1.0f - saturation);
+    float red, green, blue;
+    if (hue < 1.0f / 6.0f) {
+        red = intensity; blue = low; green = blue + (intensity - blue) * 6 * hue;
+    } else if (hue < 2.0f / 6.0f) {
+        green = intensity; blue = low; red = green - (intensity - blue) * (6 * hue - 1);
+    } else if (hue < 3.0f / 6.0f) {
+        green = intensity; red = low; blue = red + (intensity - red) * (6 * hue - 2);
+    } else if (hue < 4.0f / 6.0f) {
+        blue = intensity; red = low; green = blue - (intensity - red) * (6 * hue - 3);
+    } else if (hue < 5.0f / 6.0f) {
+        blue = intensity; green = low; red = green + (intensity - green) * (6 * hue - 4);
+    } else {
+        red = intensity; green = low; blue = red - (intensity - green) * (6 * hue - 5);
+    }
+    return framework::Color(static_cast<uint8_t>(red * 255), static_cast<uint8_t>(green * 255),
+                            static_cast<uint8_t>(blue * 255));
+}
+
 void Creature::draw(int x, int y, float scale) {
-    // g_graphics is declared in framework/graphics/graphics.h
+    drawOutfit(x, y, scale);
+    drawInformation(x, y, scale);
+}
 
+void Creature::drawOutfit(int x, int y, float scale) {
     // Apply walk offset
     x += getWalkOffsetX();
     y += getWalkOffsetY();
@@ -150,43 +217,53 @@ void Creature::draw(int x, int y, float scale) {
     // Get creature type for sprites
     auto& typeMgr = ThingTypeManager::instance();
 
-    // Draw outfit
     if (m_outfit.lookType != 0) {
-        // Creature outfit
         auto type = typeMgr.getCreatureType(m_outfit.lookType);
-        if (type) {
-            // Direction pattern
-            int dirPattern = 0;
-            switch (m_direction) {
-                case Position::North: dirPattern = 0; break;
-                case Position::East: dirPattern = 1; break;
-                case Position::South: dirPattern = 2; break;
-                case Position::West: dirPattern = 3; break;
-                default: dirPattern = 2; break;
-            }
-
-            // Draw base outfit
-            type->draw(x, y, scale, dirPattern, 0, 0, m_animationPhase);
-
-            // Draw colored layers (head, body, legs, feet)
-            // This would involve colorizing sprites based on outfit colors
-            // Simplified: just draw base
+        if (!type) return;
+
+        // Direction pattern
+        int dirPattern = 0;
+        switch (m_direction) {
+            case Position::North: dirPattern = 0; break;
+            case Position::East: dirPattern = 1; break;
+            case Position::South: dirPattern = 2; break;
+            case Position::West: dirPattern = 3; break;
+            default: dirPattern = 2; break;
+        }
 
-            // Draw mount if any
-            if (m_outfit.mount != 0) {
-                auto mountType = typeMgr.getCreatureType(m_outfit.mount);
-                if (mountType) {
-                    mountType->draw(x, y, scale, dirPattern, 0, 0, m_animationPhase);
-                }
+        // The mount goes under its rider, who switches to the mounted pattern
+        int mountedPattern = 0;
+        if (m_outfit.mount != 0) {
+            if (auto mountType = typeMgr.getCreatureType(m_outfit.mount)) {
+                const std::array<framework::Color, 4> mountColors{
+                    outfitColor(m_outfit.mountHead), outfitColor(m_outfit.mountBody),
+                    outfitColor(m_outfit.mountLegs), outfitColor(m_outfit.mountFeet)};
+                mountType->drawInstanced(x, y, scale, dirPattern, 0, 0, m_animationPhase, &mountColors);
+                mountedPattern = type->getPatternZ() > 1 ? 1 : 0;
             }
         }
+
+        // Colorized in the shader from the outfit's template layer; pattern
+        // y selects the base outfit and then each worn addon
+        const std::array<framework::Color, 4> colors{
+            outfitColor(m_outfit.head), outfitColor(m_outfit.body),
+            outfitColor(m_outfit.legs), outfitColor(m_outfit.feet)};
+        for (int addon = 0; addon < type->getPatternY(); ++addon) {
+            if (addon > 0 && !(m_outfit.addons & (1 << (addon - 1)))) continue;
+            type->drawInstanced(x, y, scale, dirPattern, addon, mountedPattern, m_animationPhase, &colors);
+        }
     } else if (m_outfit.lookTypeEx != 0) {
         // Item look
         auto type = typeMgr.getItemType(m_outfit.lookTypeEx);
         if (type) {
-            type->draw(x, y, scale, 0, 0, 0, m_animationPhase);
+            type->drawInstanced(x, y, scale, 0, 0, 0, m_animationPhase);
         }
     }
+}
+
+void Creature::drawInformation(int x, int y, float scale) {
+    x += getWalkOffsetX();
+    y += getWalkOffsetY();
 
     // Draw health bar
     if (m_healthPercent < 100) {
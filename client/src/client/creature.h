@@ -8,6 +8,7 @@
 
 #include "thing.h"
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <cstdint>
@@ -71,7 +72,7 @@ public:
     void setCreatureId(uint32_t id) { m_id = id; }
 
     const std::string& getName() const { return m_name; }
-    void setName(const std::string& name) { m_name = name; }
+    void setName(std::string_view name) { m_name.assign(name); }
 
     // Health
     int getHealthPercent() const { return m_healthPercent; }
@@ -83,7 +84,9 @@ public:
 
     void turn(Position::Direction dir);
 
-    // Movement
+    // Movement; position changes are mirrored into the map's creature index
+    void setPosition(const Position& pos);
+
     uint16_t getSpeed() const { return m_speed; }
     void setSpeed(uint16_t speed) { m_speed = speed; }
 
@@ -124,15 +127,13 @@ public:
 
     // Light
     uint8_t getLightIntensity() const override { return m_lightIntensity; }
-    void setLightIntensity(uint8_t intensity) { m_lightIntensity = intensity; }
+    void setLightIntensity(uint8_t intensity) { setLight(intensity, m_lightColor); }
 
     uint8_t getLightColor() const override { return m_lightColor; }
-    void setLightColor(uint8_t color) { m_lightColor = color; }
+    void setLightColor(uint8_t color) { setLight(m_lightIntensity, color); }
 
-    void setLight(uint8_t intensity, uint8_t color) {
-        m_lightIntensity = intensity;
-        m_lightColor = color;
-    }
+    // Also moves the creature's emitter in the map's light index
+    void setLight(uint8_t intensity, uint8_t color);
 
     // Combat square
     bool hasSquare() const { return m_hasSquare; }
@@ -150,6 +151,12 @@ public:
     void update(float deltaTime) override;
     void draw(int x, int y, float scale = 1.0f) override;
 
+    // The two halves of draw(): sprites through the instanced path, then
+    // bars, name and speech. The map view draws every creature's sprites
+    // before any information so they share draw calls.
+    void drawOutfit(int x, int y, float scale = 1.0f);
+    void drawInformation(int x, int y, float scale = 1.0f);
+
     // Visibility
     bool isInvisible() const { return m_invisible; }
     void setInvisible(bool invisible) { m_invisible = invisible; }
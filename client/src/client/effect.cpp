@@ -3,8 +3,7 @@
  */
 
 #include "effect.h"
-#include "tile.h"
-#include "map.h"
+#include <algorithm>
 
 namespace shadow {
 namespace client {
@@ -60,7 +59,7 @@ void Effect::draw(int x, int y, float scale) {
     if (!type) return;
 
     // Effects typically don't have patterns, just animation phases
-    type->draw(x, y, scale, 0, 0, 0, m_animPhase);
+    type->drawInstanced(x, y, scale, 0, 0, 0, m_animPhase);
 }
 
 uint8_t Effect::getLightIntensity() const {
@@ -80,73 +79,84 @@ EffectManager& EffectManager::instance() {
     return instance;
 }
 
-EffectPtr EffectManager::createEffect(uint16_t effectId, const Position& pos) {
-    auto effect = Effect::create(effectId);
-    effect->setPosition(pos);
-
-    m_effects[pos].push_back(effect);
-
-    // Also add to tile if it exists
-    auto& map = g_map;
-    auto tile = map.getTile(pos);
-    if (tile) {
-        tile->addEffect(effect);
+bool EffectManager::createEffect(uint16_t effectId, const Position& pos) {
+    ThingType* type = ThingTypeManager::instance().getEffectType(effectId);
+    if (!type) return false;
+    if (m_count == CAPACITY) {
+        m_dropped++;
+        return false;
     }
 
-    return effect;
+    // Single frame effects show for one phase
+    int phases = std::max(type->getAnimationPhases(), 1);
+    size_t i = m_count++;
+    m_types[i] = type;
+    m_starts[i] = m_now;
+    m_durations[i] = phases * ANIM_DURATION;
+    m_phases[i] = 0;
+    m_lastPhases[i] = static_cast<float>(std::min(phases - 1, 255));
+    m_x[i] = pos.x;
+    m_y[i] = pos.y;
+    m_z[i] = pos.z;
+    return true;
 }
 
 void EffectManager::update(float deltaTime) {
-    for (auto& [pos, effects] : m_effects) {
-        for (auto& effect : effects) {
-            effect->update(deltaTime);
-        }
+    // The clock restarts whenever the pool empties, so it stays precise
+    if (m_count == 0) {
+        m_now = 0.0f;
+        return;
+    }
+    m_now += deltaTime * 1000.0f;  // Convert to milliseconds
+
+    // Branch-free over the columns, so the compiler can vectorize it
+    const float inverse = 1.0f / ANIM_DURATION;
+    const float now = m_now;
+    const size_t count = m_count;
+    for (size_t i = 0; i < count; ++i) {
+        float phase = (now - m_starts[i]) * inverse;
+        float last = m_lastPhases[i];
+        m_phases[i] = static_cast<uint8_t>(phase < last ? phase : last);
     }
 
-    // Remove finished effects
-    cleanup();
-}
-
-void EffectManager::drawEffects(const Position& pos, int x, int y, float scale) {
-    auto it = m_effects.find(pos);
-    if (it == m_effects.end()) return;
-
-    for (const auto& effect : it->second) {
-        if (!effect->isFinished()) {
-            effect->draw(x, y, scale);
+    // Finished effects swap with the last one; the moved one is checked
+    // in the same slot
+    for (size_t i = 0; i < m_count;) {
+        if (m_now - m_starts[i] >= m_durations[i]) {
+            swapRemove(i);
+        } else {
+            ++i;
         }
     }
 }
 
-void EffectManager::cleanup() {
-    for (auto it = m_effects.begin(); it != m_effects.end();) {
-        auto& effects = it->second;
+void EffectManager::swapRemove(size_t index) {
+    size_t last = --m_count;
+    m_types[index] = m_types[last];
+    m_starts[index] = m_starts[last];
+    m_durations[index] = m_durations[last];
+    m_phases[index] = m_phases[last];
+    m_lastPhases[index] = m_lastPhases[last];
+    m_x[index] = m_x[last];
+    m_y[index] = m_y[last];
+    m_z[index] = m_z[last];
+}
 
-        // Remove finished effects from vector
-        effects.erase(
-            std::remove_if(effects.begin(), effects.end(),
-                [](const EffectPtr& e) { return e->isFinished(); }),
-            effects.end());
+void EffectManager::draw(int startX, int startY, int endX, int endY, int z, float viewX, float viewY, float scale) {
+    constexpr float TILE_SIZE = 32.0f;
+    for (size_t i = 0; i < m_count; ++i) {
+        if (m_z[i] != z || m_x[i] < startX || m_x[i] > endX || m_y[i] < startY || m_y[i] > endY) continue;
 
-        // Remove empty position entries
-        if (effects.empty()) {
-            it = m_effects.erase(it);
-        } else {
-            ++it;
-        }
+        // Effects typically don't have patterns, just animation phases
+        int screenX = static_cast<int>((m_x[i] * TILE_SIZE - viewX) * scale);
+        int screenY = static_cast<int>((m_y[i] * TILE_SIZE - viewY) * scale);
+        m_types[i]->drawInstanced(screenX, screenY, scale, 0, 0, 0, m_phases[i]);
     }
 }
 
 void EffectManager::clear() {
-    m_effects.clear();
-}
-
-std::vector<EffectPtr> EffectManager::getEffects(const Position& pos) const {
-    auto it = m_effects.find(pos);
-    if (it != m_effects.end()) {
-        return it->second;
-    }
-    return {};
+    m_count = 0;
+    m_now = 0.0f;
 }
 
 } // namespace client
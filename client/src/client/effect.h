@@ -10,8 +10,8 @@
 #include "thingtype.h"
 #include <cstdint>
 #include <memory>
+#include <array>
 #include <vector>
-#include <map>
 
 namespace shadow {
 namespace client {
@@ -58,34 +58,53 @@ private:
 
 using EffectPtr = std::shared_ptr<Effect>;
 
-// Effect Manager - handles active effects on tiles
+// Effect Manager - handles active effects on tiles. Effects live in a
+// fixed-capacity pool stored as columns (type, start time, phase,
+// position), so a frame's update is one linear pass over plain arrays and
+// a finished effect is removed by moving the last one into its slot.
 class EffectManager {
 public:
     static EffectManager& instance();
 
-    // Create and add effect to position
-    EffectPtr createEffect(uint16_t effectId, const Position& pos);
+    static constexpr size_t CAPACITY = 2048;
 
-    // Update all effects
-    void update(float deltaTime);
+    // Start an effect at a position; false, dropping it, when the pool is
+    // full or the type is unknown
+    bool createEffect(uint16_t effectId, const Position& pos);
 
-    // Draw effects at position
-    void drawEffects(const Position& pos, int x, int y, float scale = 1.0f);
+    // Advance every effect and drop the finished ones
+    void update(float deltaTime);
 
-    // Remove finished effects
-    void cleanup();
+    // Effects on floor z inside [startX..endX] x [startY..endY], through
+    // the instanced path. viewX/viewY is the world pixel drawn at the
+    // screen's top-left corner.
+    void draw(int startX, int startY, int endX, int endY, int z, float viewX, float viewY, float scale = 1.0f);
 
     // Clear all effects
     void clear();
 
-    // Get effects at position
-    std::vector<EffectPtr> getEffects(const Position& pos) const;
+    size_t getActiveCount() const { return m_count; }
+    uint64_t getDroppedCount() const { return m_dropped; }
 
 private:
     EffectManager() = default;
 
-    // Effects grouped by position for efficient lookup
-    std::map<Position, std::vector<EffectPtr>> m_effects;
+    void swapRemove(size_t index);
+
+    // Milliseconds per animation phase
+    static constexpr float ANIM_DURATION = 75.0f;
+
+    std::array<ThingType*, CAPACITY> m_types{};
+    std::array<float, CAPACITY> m_starts{};         // Manager clock, ms
+    std::array<float, CAPACITY> m_durations{};
+    std::array<uint8_t, CAPACITY> m_phases{};
+    std::array<float, CAPACITY> m_lastPhases{};
+    std::array<uint16_t, CAPACITY> m_x{};
+    std::array<uint16_t, CAPACITY> m_y{};
+    std::array<uint8_t, CAPACITY> m_z{};
+    size_t m_count{0};
+    float m_now{0.0f};
+    uint64_t m_dropped{0};
 };
 
 } // namespace client
@@ -4,8 +4,16 @@
 
 #include "game.h"
 #include "map.h"
+#include "pathservice.h"
 #include "protocolgame.h"
+#include "thingtype.h"
 #include <framework/net/connection.h>
+#include <framework/net/connectionprewarmer.h>
+#include <framework/core/application.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
 
 namespace shadow {
 namespace client {
@@ -18,11 +26,16 @@ Game& Game::instance() {
 void Game::init() {
     m_gameState = GameState::NotConnected;
     m_localPlayer = nullptr;
+    g_pathService.init();
+    // Before the things stage loads sprites, so they decode off the main thread
+    ThingTypeManager::instance().initDecoder();
 }
 
 void Game::terminate() {
     logout();
     m_localPlayer = nullptr;
+    g_pathService.terminate();
+    ThingTypeManager::instance().terminateDecoder();
 }
 
 void Game::login(const std::string& host, uint16_t port,
@@ -62,22 +75,52 @@ void Game::loginWorld(const std::string& account, const std::string& password,
     if (m_gameState != GameState::CharacterList) return;
 
     m_characterName = characterName;
+    m_worldName = worldName;
     m_accountName = account;
     m_password = password;
     m_gameState = GameState::EnteringWorld;
 
     // Create game protocol and connect
     m_protocol = std::make_shared<ProtocolGame>();
+    if (!m_capturePath.empty()) {
+        m_protocol->startCapture(m_capturePath);
+    }
 
-    // Connect to game world
-    if (m_protocol->connect(worldHost, worldPort, account, password, characterName)) {
-        // Connection initiated, processLogin will be called on success
-    } else {
-        m_gameState = GameState::NotConnected;
-        if (m_onLoginError) {
-            m_onLoginError("Failed to connect to game server");
-        }
+    // Connect to game world; processLogin follows on success and
+    // processConnectError on failure
+    m_protocol->connect(worldHost, worldPort, account, password, characterName);
+}
+
+void Game::processConnectError(const std::string& error) {
+    // Connection errors after entering the world end in processLogout
+    if (m_gameState != GameState::EnteringWorld) return;
+
+    m_gameState = GameState::NotConnected;
+    if (m_onLoginError) {
+        m_onLoginError("Failed to connect to game server: " + error);
+    }
+}
+
+void Game::prewarmWorld(const std::string& worldHost, uint16_t worldPort) {
+    if (m_gameState != GameState::CharacterList && m_gameState != GameState::NotConnected) return;
+    g_prewarmer.warm(worldHost, worldPort);
+}
+
+bool Game::startReplay(const std::string& path, bool unthrottled) {
+    if (m_gameState != GameState::NotConnected) return false;
+
+    auto speed = unthrottled ? framework::PacketReplayer::Speed::Unthrottled
+                             : framework::PacketReplayer::Speed::Realtime;
+
+    m_protocol = std::make_shared<ProtocolGame>();
+    if (!m_protocol->startReplay(path, speed)) {
+        m_protocol.reset();
+        return false;
     }
+
+    // The captured login packets take the state the rest of the way
+    m_gameState = GameState::EnteringWorld;
+    return true;
 }
 
 void Game::logout() {
@@ -100,6 +143,9 @@ void Game::poll() {
     if (m_protocol) {
         m_protocol->poll();
     }
+
+    // Finished path searches, e.g. autoWalkTo routes
+    g_pathService.poll();
 }
 
 void Game::cancelLogin() {
@@ -119,17 +165,47 @@ void Game::cancelLogin() {
     }
 }
 
+void Game::setLocalPlayer(LocalPlayerPtr player) {
+    m_localPlayer = player;
+    if (!m_localPlayer) return;
+
+    // Predicted steps, manual or auto-walk, go out as they are taken
+    m_localPlayer->setPredictedStepLimit(m_predictedWalkSteps);
+    m_localPlayer->setOnWalkStep([this](Position::Direction dir) {
+        if (m_protocol) {
+            m_protocol->sendWalk(dir);
+        }
+    });
+}
+
 void Game::processLogin() {
     m_gameState = GameState::Online;
 
     // Create local player if not exists
     if (!m_localPlayer) {
-        m_localPlayer = LocalPlayer::create(0);
+        setLocalPlayer(LocalPlayer::create(0));
     }
 
     // Initialize map
     g_map.init();
 
+    // One persistent minimap per world; replays stay in memory
+    if (!m_worldName.empty() && !g_map.getMinimapStore().isPersistent()) {
+        std::string name;
+        for (char c : m_worldName) {
+            name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+        std::error_code error;
+        std::filesystem::path directory = std::filesystem::path(g_app.getUserPath()) / "minimap";
+        std::filesystem::create_directories(directory, error);
+        g_map.openMinimap((directory / (name + ".otmm")).string());
+    }
+
+    // Servers that do not know the extended opcode leave it unanswered
+    if (m_compressionThreshold > 0 && m_protocol) {
+        m_protocol->requestCompression(m_compressionThreshold);
+    }
+
     if (m_onLogin) {
         m_onLogin();
     }
@@ -146,8 +222,15 @@ void Game::processLogout() {
 
     m_gameState = GameState::NotConnected;
 
-    // Clear map
+    // Routes computed against the old map are meaningless now
+    g_pathService.cancelAll();
+
+    // Clear map; the minimap is written back but its tiles stay known
     g_map.clear();
+    g_map.closeMinimap();
+
+    // Offers belong to the world just left
+    m_market.clear();
 
     // Clear local player data
     m_localPlayer = nullptr;
@@ -161,11 +244,14 @@ void Game::walk(Position::Direction dir) {
     if (!isOnline() || !m_localPlayer) return;
     if (m_localPlayer->isWalkLocked()) return;
 
-    // Pre-walk for client-side prediction
-    m_localPlayer->preWalk(dir);
+    // Manual steps override any route still being searched
+    g_pathService.cancelGroup(PathService::GROUP_AUTOWALK);
 
-    // Send walk request to server
-    if (m_protocol) {
+    // A predicted step is sent by the player's walk step callback. One
+    // that cannot be predicted still goes out when nothing is in flight,
+    // and the server answers with a move or a cancel; with the pipeline
+    // full the step is dropped
+    if (!m_localPlayer->preWalk(dir) && !m_localPlayer->isPreWalking() && m_protocol) {
         m_protocol->sendWalk(dir);
     }
 }
@@ -186,10 +272,42 @@ void Game::autoWalk(const std::vector<Position> path) {
         current = pos;
     }
 
-    m_localPlayer->setAutoWalkPath(directions);
+    autoWalk(directions);
+}
+
+void Game::autoWalk(const std::vector<Position::Direction>& path) {
+    if (!isOnline() || !m_localPlayer) return;
+    if (path.empty()) return;
+
+    m_localPlayer->setAutoWalkPath(path);
     m_localPlayer->nextAutoWalkStep();
 }
 
+void Game::autoWalkTo(const Position& goal, int maxDistance) {
+    if (!isOnline() || !m_localPlayer) return;
+
+    // Beyond the tile search window, route over the explored minimap. The
+    // region graph keeps this cheap enough to run here.
+    const Position& start = m_localPlayer->getPosition();
+    if (std::max(std::abs(goal.x - start.x), std::abs(goal.y - start.y)) > maxDistance) {
+        g_pathService.cancelGroup(PathService::GROUP_AUTOWALK);
+        autoWalk(g_map.findMinimapPath(start, goal));
+        return;
+    }
+
+    PathService::Options options;
+    options.maxDistance = maxDistance;
+    options.group = PathService::GROUP_AUTOWALK;
+
+    g_pathService.request(m_localPlayer->getPosition(), goal, options, [this](const PathResult& result) {
+        if (result.status != PathStatus::Found || !m_localPlayer) return;
+
+        // The route starts where the player stood at request time
+        if (m_localPlayer->getPosition() != result.start) return;
+        autoWalk(result.path);
+    });
+}
+
 void Game::turn(Position::Direction dir) {
     if (!isOnline() || !m_localPlayer) return;
 
@@ -203,6 +321,8 @@ void Game::turn(Position::Direction dir) {
 void Game::stop() {
     if (!isOnline() || !m_localPlayer) return;
 
+    g_pathService.cancelGroup(PathService::GROUP_AUTOWALK);
+
     m_localPlayer->cancelAutoWalk();
     m_localPlayer->cancelPreWalk();
     m_localPlayer->stopWalk();
@@ -442,24 +562,50 @@ void Game::closeNpcTrade() {
     }
 }
 
-void Game::browseMarket(uint16_t categoryId) {
+void Game::browseMarket(uint16_t categoryId, bool refresh) {
     if (!isOnline()) return;
-    // Note: Market functionality would require sendBrowseMarket method
+
+    if (!refresh && m_market.isFresh(categoryId)) {
+        if (onMarketBrowse) onMarketBrowse(categoryId);
+        return;
+    }
+    if (m_protocol) {
+        m_protocol->sendMarketBrowse(categoryId);
+    }
 }
 
 void Game::createMarketOffer(uint8_t type, uint16_t itemId, uint8_t tier, uint16_t amount, uint64_t price, bool anonymous) {
     if (!isOnline()) return;
-    // Note: Market offer creation would require sendCreateMarketOffer method
+    if (m_protocol) {
+        // The server takes a 32-bit price and has no tier field yet
+        uint32_t wirePrice = static_cast<uint32_t>(std::min<uint64_t>(price, UINT32_MAX));
+        m_protocol->sendMarketCreate(type, itemId, amount, wirePrice, anonymous);
+    }
+    // The new offer's timestamp comes from the server; refetch on next browse
+    m_market.invalidateItem(itemId);
 }
 
 void Game::cancelMarketOffer(uint32_t timestamp, uint16_t counter) {
     if (!isOnline()) return;
-    // Note: Market offer cancellation would require sendCancelMarketOffer method
+    if (m_protocol) {
+        m_protocol->sendMarketCancel(timestamp, counter);
+    }
+    m_market.removeOffer(timestamp, counter);
 }
 
 void Game::acceptMarketOffer(uint32_t timestamp, uint16_t counter, uint16_t amount) {
     if (!isOnline()) return;
-    // Note: Market offer acceptance would require sendAcceptMarketOffer method
+    if (m_protocol) {
+        m_protocol->sendMarketAccept(timestamp, counter, amount);
+    }
+    m_market.reduceOffer(timestamp, counter, amount);
+}
+
+void Game::leaveMarket() {
+    if (!isOnline()) return;
+    if (m_protocol) {
+        m_protocol->sendMarketLeave();
+    }
 }
 
 void Game::inviteToParty(uint32_t creatureId) {
@@ -551,10 +697,15 @@ void Game::reportRuleViolation(const std::string& target, uint8_t reason, uint8_
     // Note: Rule violation reporting would require sendReportRuleViolation method
 }
 
+int Game::getLatency() const {
+    if (!m_protocol || !m_protocol->getConnection()) return 0;
+    return m_protocol->getConnection()->getPing();
+}
+
 void Game::ping() {
     if (!isOnline()) return;
     if (m_protocol) {
-        m_protocol->sendPing();
+        m_protocol->sendPingRequest();
     }
 }
 
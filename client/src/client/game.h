@@ -7,11 +7,13 @@
 #pragma once
 
 #include "localplayer.h"
+#include "marketcache.h"
 #include "position.h"
 #include "creature.h"
 #include "protocolgame.h"
 #include <framework/net/connection.h>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <functional>
 #include <vector>
@@ -42,6 +44,9 @@ public:
     void loginWorld(const std::string& account, const std::string& password,
                     const std::string& worldHost, uint16_t worldPort,
                     const std::string& worldName, const std::string& characterName);
+    // Opens the world connection while a character is highlighted in the
+    // list, so loginWorld() or a character switch finds it connected
+    void prewarmWorld(const std::string& worldHost, uint16_t worldPort);
     void logout();
     void cancelLogin();
 
@@ -55,6 +60,9 @@ public:
     // Movement
     void walk(Position::Direction dir);
     void autoWalk(const std::vector<Position> path);
+    void autoWalk(const std::vector<Position::Direction>& path);
+    // Route to goal on the path service; a newer call supersedes a pending one
+    void autoWalkTo(const Position& goal, int maxDistance = 100);
     void turn(Position::Direction dir);
     void stop();
 
@@ -110,11 +118,15 @@ public:
     void sellItem(uint16_t itemId, uint8_t subType, uint8_t amount, bool ignoreEquipped);
     void closeNpcTrade();
 
-    // Market
-    void browseMarket(uint16_t categoryId);
+    // Market. Browsing a category seen within MarketCache::MAX_AGE is
+    // answered from the cache without a request; refresh forces one.
+    // Offers this client changes are updated in the cache right away.
+    void browseMarket(uint16_t categoryId, bool refresh = false);
     void createMarketOffer(uint8_t type, uint16_t itemId, uint8_t tier, uint16_t amount, uint64_t price, bool anonymous);
     void cancelMarketOffer(uint32_t timestamp, uint16_t counter);
     void acceptMarketOffer(uint32_t timestamp, uint16_t counter, uint16_t amount);
+    void leaveMarket();
+    MarketCache& getMarket() { return m_market; }
 
     // Party
     void inviteToParty(uint32_t creatureId);
@@ -139,29 +151,32 @@ public:
                              const std::string& comment, const std::string& statement,
                              uint16_t channelId, uint32_t translation);
 
-    // Ping
+    // Ping: measures a round trip; getLatency() is the last one, in ms
     void ping();
-    int getLatency() const { return m_latency; }
+    int getLatency() const;
 
     // Protocol version
     void setProtocolVersion(int version) { m_protocolVersion = version; }
     int getProtocolVersion() const { return m_protocolVersion; }
 
-    // Callbacks
+    // Callbacks. Text views point into the packet being parsed and must be
+    // copied to outlive the call; channel, outfit and mount names are
+    // interned and stay valid.
     using LoginCallback = std::function<void()>;
     using LogoutCallback = std::function<void()>;
     using DeathCallback = std::function<void(uint8_t deathType, uint8_t penalty)>;
-    using TextMessageCallback = std::function<void(uint8_t type, const std::string& message)>;
-    using AnimatedTextCallback = std::function<void(const Position& pos, uint8_t color, const std::string& text)>;
-    using TalkCallback = std::function<void(const std::string& name, uint16_t level, uint8_t speakType,
-                                            const Position& pos, uint16_t channelId, const std::string& text)>;
-    using ChannelListCallback = std::function<void(const std::vector<std::pair<uint16_t, std::string>>& channels)>;
-    using OpenChannelCallback = std::function<void(uint16_t channelId, const std::string& name)>;
+    using TextMessageCallback = std::function<void(uint8_t type, std::string_view message)>;
+    using AnimatedTextCallback = std::function<void(const Position& pos, uint8_t color, std::string_view text)>;
+    using TalkCallback = std::function<void(std::string_view name, uint16_t level, uint8_t speakType,
+                                            const Position& pos, uint16_t channelId, std::string_view text)>;
+    using ChannelListCallback = std::function<void(const std::vector<std::pair<uint16_t, std::string_view>>& channels)>;
+    using OpenChannelCallback = std::function<void(uint16_t channelId, std::string_view name)>;
     using CloseChannelCallback = std::function<void(uint16_t channelId)>;
     using VipStateCallback = std::function<void(uint32_t playerId, bool online)>;
+    using MarketBrowseCallback = std::function<void(uint16_t categoryId)>;
     using OutfitDialogCallback = std::function<void(const Outfit& current,
-                                                     const std::vector<std::pair<uint16_t, std::string>>& outfits,
-                                                     const std::vector<std::pair<uint16_t, std::string>>& mounts)>;
+                                                     const std::vector<std::pair<uint16_t, std::string_view>>& outfits,
+                                                     const std::vector<std::pair<uint16_t, std::string_view>>& mounts)>;
 
     void setOnLogin(LoginCallback cb) { m_onLogin = cb; }
     void setOnLogout(LogoutCallback cb) { m_onLogout = cb; }
@@ -179,6 +194,8 @@ public:
     TextMessageCallback onTextMessage;
     VipStateCallback onVipStateChange;
     OutfitDialogCallback onOutfitDialog;
+    // Category offers are in getMarket(), fetched or cached
+    MarketBrowseCallback onMarketBrowse;
 
     // For module connection
     using GameStartCallback = std::function<void()>;
@@ -193,15 +210,25 @@ public:
     void setOnLoginError(LoginErrorCallback cb) { m_onLoginError = cb; }
 
     // Protocol access for session management
-    void setLocalPlayer(LocalPlayerPtr player) { m_localPlayer = player; }
+    void setLocalPlayer(LocalPlayerPtr player);
+    // Steps the local player may walk ahead of server confirmation
+    void setPredictedWalkSteps(size_t steps) { m_predictedWalkSteps = steps; }
     void setProtocol(std::shared_ptr<ProtocolGame> protocol) { m_protocol = protocol; }
     std::shared_ptr<ProtocolGame> getProtocol() const { return m_protocol; }
     void processLogin();
     void processLogout();
+    void processConnectError(const std::string& error);
 
     // Poll network for incoming data
     void poll();
 
+    // Packet capture of the next game session, and offline replay of one
+    void setCapturePath(const std::string& path) { m_capturePath = path; }
+    bool startReplay(const std::string& path, bool unthrottled = false);
+
+    // Frame compression asked of the server on login; 0 leaves it off
+    void setCompressionThreshold(uint16_t threshold) { m_compressionThreshold = threshold; }
+
 private:
     Game() = default;
     Game(const Game&) = delete;
@@ -209,17 +236,22 @@ private:
 
     GameState m_gameState{GameState::NotConnected};
     LocalPlayerPtr m_localPlayer;
+    size_t m_predictedWalkSteps{LocalPlayer::DEFAULT_PREDICTED_STEPS};
     std::shared_ptr<ProtocolGame> m_protocol;
     std::unique_ptr<framework::ProtocolLogin> m_loginProtocol;
 
+    std::string m_capturePath;
+    uint16_t m_compressionThreshold{0};
     std::string m_accountName;
     std::string m_password;
     std::string m_characterName;
+    std::string m_worldName;
     std::string m_loginHost;
     uint16_t m_loginPort{7171};
 
+    MarketCache m_market;
+
     int m_protocolVersion{1098};
-    int m_latency{0};
 
     LoginCallback m_onLogin;
     LogoutCallback m_onLogout;
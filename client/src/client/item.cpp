@@ -4,6 +4,7 @@
 
 #include "item.h"
 #include "thingtype.h"
+#include <framework/core/objectpool.h>
 #include <framework/graphics/graphics.h>
 
 // g_graphics is declared in shadow::framework namespace
@@ -15,18 +16,63 @@ namespace client {
 Item::Item() = default;
 
 std::shared_ptr<Item> Item::create(uint16_t id) {
-    auto item = std::make_shared<Item>();
+    auto item = framework::makePooled<Item>();
     item->setId(id);
     return item;
 }
 
+std::shared_ptr<Item> Item::create(const ItemDescription& description) {
+    auto item = create(description.id);
+    item->setSubTypeFrom(description);
+    return item;
+}
+
+bool Item::matches(const ItemDescription& description) const {
+    if (m_id != description.id) return false;
+    return (isStackable() ? m_count : m_subType) == description.subType;
+}
+
+void Item::setSubTypeFrom(const ItemDescription& description) {
+    if (isStackable()) {
+        m_count = description.subType;
+    } else {
+        m_subType = description.subType;
+    }
+}
+
 void Item::setId(uint16_t id) {
     m_id = id;
     // Reset pattern and animation when ID changes
     m_patternX = 0;
     m_patternY = 0;
     m_patternZ = 0;
-    m_animationPhase = 0;
+    m_animationPhase = -1;
+
+    // Async animations count from here; a random start phase is a random
+    // point into the first cycle
+    auto& things = ThingTypeManager::instance();
+    m_animationStart = things.getAnimationTime();
+    const ThingType* type = things.getItemType(id);
+    if (type && type->isAnimated() && type->getAnimationStartPhase() == ThingType::RANDOM_START_PHASE) {
+        static uint32_t seed = 0x9e3779b9u;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        m_animationStart -= seed % type->getAnimationCycle();
+    }
+}
+
+int Item::getAnimationPhase() const {
+    const ThingType* type = getItemType();
+    return type ? getAnimationPhase(*type) : 0;
+}
+
+int Item::getAnimationPhase(const ThingType& type) const {
+    if (!type.isAnimated()) return 0;
+    if (m_animationPhase >= 0) return m_animationPhase % type.getAnimationPhases();
+
+    uint32_t now = ThingTypeManager::instance().getAnimationTime();
+    return type.getPhaseAt(type.isSyncAnimation() ? now : now - m_animationStart);
 }
 
 ThingType* Item::getItemType() const {
@@ -166,7 +212,7 @@ void Item::draw(int x, int y, float scale) {
     // g_graphics is declared in framework/graphics/graphics.h
 
     // Get sprite from type based on current animation phase and pattern
-    int phase = m_animationPhase % type->getAnimationPhases();
+    int phase = getAnimationPhase(*type);
 
     // Calculate pattern based on item properties
     int patX = m_patternX;
@@ -198,23 +244,5 @@ void Item::draw(int x, int y, float scale) {
     type->draw(x, y, scale, patX, patY, patZ, phase);
 }
 
-void Item::update(float deltaTime) {
-    auto type = getItemType();
-    if (!type) return;
-
-    int phases = type->getAnimationPhases();
-    if (phases <= 1) return;
-
-    // Update animation
-    m_animationTimer += deltaTime;
-
-    // Standard animation at ~200ms per frame
-    float frameDuration = 0.2f;
-    while (m_animationTimer >= frameDuration) {
-        m_animationTimer -= frameDuration;
-        m_animationPhase = (m_animationPhase + 1) % phases;
-    }
-}
-
 } // namespace client
 } // namespace shadow
@@ -14,10 +14,22 @@
 namespace shadow {
 namespace client {
 
+// One item as the server describes it, before an Item exists for it
+struct ItemDescription {
+    uint16_t id{0};
+    uint8_t subType{0};     // Count for stackables
+};
+
 class Item : public Thing {
 public:
     Item();
     static std::shared_ptr<Item> create(uint16_t id);
+    static std::shared_ptr<Item> create(const ItemDescription& description);
+
+    // Same id and count or subtype, so the object can stand for it
+    bool matches(const ItemDescription& description) const;
+    // Take the count or subtype of a description of the same id
+    void setSubTypeFrom(const ItemDescription& description);
 
     bool isItem() const override { return true; }
 
@@ -67,10 +79,11 @@ public:
     // Drawing
     void draw(int x, int y, float scale = 1.0f) override;
 
-    // Animation
-    void update(float deltaTime) override;
+    // Animation: the phase follows the shared clock (see
+    // ThingType::getPhaseAt), so items have no per-frame update. A phase
+    // set here holds until -1 hands it back to the clock.
     void setAnimationPhase(int phase) { m_animationPhase = phase; }
-    int getAnimationPhase() const { return m_animationPhase; }
+    int getAnimationPhase() const;
 
     // Pattern for items with variants
     void setPatternX(int x) { m_patternX = x; }
@@ -88,6 +101,8 @@ public:
     void setUniqueId(uint16_t uid) { m_uniqueId = uid; }
 
 private:
+    int getAnimationPhase(const ThingType& type) const;
+
     uint16_t m_id{0};
     uint8_t m_count{1};
     uint8_t m_subType{0};
@@ -95,8 +110,8 @@ private:
     std::string m_text;
     std::string m_description;
 
-    int m_animationPhase{0};
-    float m_animationTimer{0};
+    int m_animationPhase{-1};
+    uint32_t m_animationStart{0};   // Clock time it appeared, for async types
 
     int m_patternX{0};
     int m_patternY{0};
@@ -4,6 +4,7 @@
 
 #include "localplayer.h"
 #include "map.h"
+#include <framework/core/objectpool.h>
 #include <algorithm>
 
 namespace shadow {
@@ -13,7 +14,7 @@ LocalPlayer::LocalPlayer() : Player() {
 }
 
 std::shared_ptr<LocalPlayer> LocalPlayer::create(uint32_t id) {
-    auto player = std::make_shared<LocalPlayer>();
+    auto player = framework::makePooled<LocalPlayer>();
     player->setCreatureId(id);
     return player;
 }
@@ -34,10 +35,15 @@ void LocalPlayer::nextAutoWalkStep() {
         return;
     }
 
-    Position::Direction dir = m_autoWalkPath[m_autoWalkIndex++];
+    // update() takes the next step once the pipeline has room
+    if (m_predictedSteps.size() >= m_predictedStepLimit) return;
 
-    // Pre-walk for client-side prediction
-    preWalk(dir);
+    // A step that cannot be predicted is blocked or locked; the route
+    // needs to be searched again
+    if (!preWalk(m_autoWalkPath[m_autoWalkIndex++])) {
+        cancelAutoWalk();
+        return;
+    }
 
     // Check if path completed
     if (m_autoWalkIndex >= static_cast<int>(m_autoWalkPath.size())) {
@@ -46,34 +52,75 @@ void LocalPlayer::nextAutoWalkStep() {
     }
 }
 
-void LocalPlayer::preWalk(Position::Direction dir) {
-    if (m_preWalking || isWalking()) return;
+bool LocalPlayer::preWalk(Position::Direction dir) {
+    if (m_walkLocked || m_predictedSteps.size() >= m_predictedStepLimit) return false;
 
-    m_preWalking = true;
-    m_preWalkPosition = m_position;
+    // Steps chain from the last predicted destination
+    Position from = m_predictedSteps.empty() ? (m_walking ? m_walkTarget : m_position) : m_predictedSteps.back().to;
+    Position to = from.translated(dir);
 
-    // Calculate new position
-    Position newPos = m_position.translated(dir);
+    auto tile = g_map.getTile(to);
+    if (!tile || !tile->isWalkable()) return false;
+
+    if (m_predictedSteps.empty()) {
+        m_serverPosition = from;
+    }
+    m_predictedSteps.push_back({from, to});
 
-    // Check if tile is walkable
-    auto& map = g_map;
-    auto tile = map.getTile(newPos);
-    if (tile && tile->isWalkable()) {
-        walk(newPos, true);
+    if (m_walking) {
+        m_stepQueue.push_back(to);
     } else {
-        cancelPreWalk();
+        startStep(to);
     }
+
+    if (m_onWalkStep) {
+        m_onWalkStep(dir);
+    }
+    return true;
 }
 
 void LocalPlayer::cancelPreWalk() {
-    if (!m_preWalking) return;
+    if (m_predictedSteps.empty()) return;
+
+    m_predictedSteps.clear();
+    m_stepQueue.clear();
+
+    // A confirmed step still animating keeps going; anything further
+    // snaps back to where the server has the player
+    if (m_walking && m_walkTarget == m_serverPosition) return;
+    cancelWalk();
+    moveToTile(m_serverPosition);
+}
 
-    m_preWalking = false;
+bool LocalPlayer::confirmStep(const Position& from, const Position& to) {
+    if (m_predictedSteps.empty()) return false;
 
-    // Revert to pre-walk position
-    if (isWalking()) {
-        cancelWalk();
-        m_position = m_preWalkPosition;
+    const PredictedStep& step = m_predictedSteps.front();
+    if (step.from != from || step.to != to) return false;
+
+    m_serverPosition = to;
+    m_predictedSteps.pop_front();
+    return true;
+}
+
+void LocalPlayer::startStep(const Position& to) {
+    // On the destination tile at once, for stack lookups and range
+    // queries; the animation still starts where the player stands
+    Position origin = m_position;
+    moveToTile(to);
+    m_position = origin;
+    walk(to, true);
+}
+
+void LocalPlayer::moveToTile(const Position& pos) {
+    auto self = std::static_pointer_cast<Creature>(shared_from_this());
+    if (auto tile = getTile()) {
+        tile->removeCreature(self);
+    }
+    if (auto tile = g_map.getTile(pos)) {
+        tile->addCreature(self);
+    } else {
+        setPosition(pos);
     }
 }
 
@@ -127,14 +174,16 @@ void LocalPlayer::update(float deltaTime) {
     // Call parent update (handles walking animation, etc.)
     Player::update(deltaTime);
 
-    // Handle pre-walk completion
-    if (m_preWalking && !isWalking()) {
-        m_preWalking = false;
+    // Predicted steps play back to back
+    if (!m_walking && !m_stepQueue.empty()) {
+        Position to = m_stepQueue.front();
+        m_stepQueue.pop_front();
+        startStep(to);
+    }
 
-        // Continue auto-walk if in progress
-        if (isAutoWalking()) {
-            nextAutoWalkStep();
-        }
+    // Keep the pipeline full while auto-walking
+    while (isAutoWalking() && m_predictedSteps.size() < m_predictedStepLimit) {
+        nextAutoWalkStep();
     }
 
     // Notify position change
@@ -7,6 +7,8 @@
 #pragma once
 
 #include "player.h"
+#include <algorithm>
+#include <deque>
 #include <vector>
 #include <functional>
 
@@ -28,10 +30,28 @@ public:
 
     void nextAutoWalkStep();
 
-    // Pre-walking (client-side prediction)
-    void preWalk(Position::Direction dir);
+    // Pre-walking (client-side prediction). Predicted steps move the player
+    // on the map at once and go to the server without waiting for the
+    // previous one to be confirmed, up to the step limit in flight; their
+    // animations play back to back. A server move that matches the oldest
+    // step confirms it, anything else drops the prediction.
+    static constexpr size_t DEFAULT_PREDICTED_STEPS = 2;
+
+    // False if the step was not predicted: the pipeline is full, the walk
+    // is locked or the destination is not known to be walkable
+    bool preWalk(Position::Direction dir);
+    // Roll back to the last server-confirmed position
     void cancelPreWalk();
-    bool isPreWalking() const { return m_preWalking; }
+    bool isPreWalking() const { return !m_predictedSteps.empty(); }
+    size_t getPredictedStepCount() const { return m_predictedSteps.size(); }
+
+    // 1 waits for each confirmation before the next step
+    void setPredictedStepLimit(size_t steps) { m_predictedStepLimit = std::max<size_t>(steps, 1); }
+    size_t getPredictedStepLimit() const { return m_predictedStepLimit; }
+
+    // A server move of this player; true if it confirmed a predicted step,
+    // which is then already on screen
+    bool confirmStep(const Position& from, const Position& to);
 
     // Known spells
     void addKnownSpell(uint16_t spellId);
@@ -75,16 +95,29 @@ public:
     // Callbacks
     using StatsChangeCallback = std::function<void()>;
     using PositionChangeCallback = std::function<void(const Position&, const Position&)>;
+    using WalkStepCallback = std::function<void(Position::Direction)>;
 
     void setOnStatsChange(StatsChangeCallback cb) { m_onStatsChange = cb; }
+    // Every predicted step, manual or auto-walk, to send to the server
+    void setOnWalkStep(WalkStepCallback cb) { m_onWalkStep = cb; }
     void setOnPositionChange(PositionChangeCallback cb) { m_onPositionChange = cb; }
 
 private:
     std::vector<Position::Direction> m_autoWalkPath;
     int m_autoWalkIndex{0};
 
-    bool m_preWalking{false};
-    Position m_preWalkPosition;
+    struct PredictedStep {
+        Position from;
+        Position to;
+    };
+    void startStep(const Position& to);
+    void moveToTile(const Position& pos);
+
+    // Sent and not yet confirmed, oldest first
+    std::deque<PredictedStep> m_predictedSteps;
+    // Destinations waiting for the current step's animation to finish
+    std::deque<Position> m_stepQueue;
+    size_t m_predictedStepLimit{DEFAULT_PREDICTED_STEPS};
 
     std::vector<uint16_t> m_knownSpells;
     std::vector<VIPEntry> m_vipList;
@@ -97,6 +130,7 @@ private:
 
     StatsChangeCallback m_onStatsChange;
     PositionChangeCallback m_onPositionChange;
+    WalkStepCallback m_onWalkStep;
 };
 
 using LocalPlayerPtr = std::shared_ptr<LocalPlayer>;
@@ -3,6 +3,7 @@
  */
 
 #include "luabindings.h"
+#include "luaffi.h"
 #include "position.h"
 #include "item.h"
 #include "creature.h"
@@ -10,12 +11,22 @@
 #include "localplayer.h"
 #include "tile.h"
 #include "map.h"
+#include "pathservice.h"
 #include "container.h"
 #include "game.h"
 #include "effect.h"
 #include "missile.h"
+#include "networktelemetry.h"
+#include "thingtype.h"
+#include "protocolgame.h"
+#include "uiminimap.h"
+#include <framework/core/memorytracker.h>
 #include <framework/ui/uimanager.h>
 #include <framework/ui/uiwidget.h>
+#include <framework/ui/uiscrollarea.h>
+#include <framework/luaengine/luabinder.h>
+#include <framework/luaengine/luainterface.h>
+#include <framework/luaengine/luaprofiler.h>
 
 extern "C" {
 #include <lua.h>
@@ -24,8 +35,26 @@ extern "C" {
 }
 
 namespace shadow {
+namespace framework {
+namespace lua {
+
+// Positions travel by value, as their own userdata
+template<>
+struct Stack<client::Position> {
+    static void push(lua_State* L, const client::Position& value) {
+        new (lua_newuserdata(L, sizeof(client::Position))) client::Position(value);
+        pushMetatable<client::Position>(L);
+        lua_setmetatable(L, -2);
+    }
+};
+
+} // namespace lua
+} // namespace framework
+
 namespace client {
 
+namespace lua = framework::lua;
+
 // Helper macros for binding
 #define LUA_REGISTER_CLASS(L, name) \
     luaL_newmetatable(L, name); \
@@ -36,6 +65,13 @@ namespace client {
     lua_pushcfunction(L, func); \
     lua_setfield(L, -2, name)
 
+// Lua function kept alive in the registry for as long as a handler holds it
+struct LuaFunctionRef {
+    lua_State* L;
+    int ref;
+    ~LuaFunctionRef() { luaL_unref(L, LUA_REGISTRYINDEX, ref); }
+};
+
 // Position bindings
 
 static int l_Position_new(lua_State* L) {
@@ -91,7 +127,7 @@ static int l_Position_translated(lua_State* L) {
 }
 
 void registerPositionLuaBindings(lua_State* L) {
-    LUA_REGISTER_CLASS(L, "Position");
+    lua::registerClass<Position>(L, "Position");
 
     LUA_REGISTER_METHOD(L, "getX", l_Position_getX);
     LUA_REGISTER_METHOD(L, "getY", l_Position_getY);
@@ -108,371 +144,90 @@ void registerPositionLuaBindings(lua_State* L) {
 
 // Item bindings
 
-static Item* l_Item_check(lua_State* L, int index) {
-    auto** item = static_cast<Item**>(luaL_checkudata(L, index, "Item"));
-    return *item;
-}
-
-static int l_Item_getId(lua_State* L) {
-    auto* item = l_Item_check(L, 1);
-    lua_pushinteger(L, item ? item->getId() : 0);
-    return 1;
-}
-
-static int l_Item_getCount(lua_State* L) {
-    auto* item = l_Item_check(L, 1);
-    lua_pushinteger(L, item ? item->getCount() : 0);
-    return 1;
-}
-
-static int l_Item_isStackable(lua_State* L) {
-    auto* item = l_Item_check(L, 1);
-    lua_pushboolean(L, item ? item->isStackable() : false);
-    return 1;
-}
-
-static int l_Item_isContainer(lua_State* L) {
-    auto* item = l_Item_check(L, 1);
-    lua_pushboolean(L, item ? item->isContainer() : false);
-    return 1;
-}
-
-static int l_Item_isPickupable(lua_State* L) {
-    auto* item = l_Item_check(L, 1);
-    lua_pushboolean(L, item ? item->isPickupable() : false);
-    return 1;
-}
-
-static int l_Item_isUseable(lua_State* L) {
-    auto* item = l_Item_check(L, 1);
-    lua_pushboolean(L, item ? item->isUseable() : false);
-    return 1;
-}
-
 void registerItemLuaBindings(lua_State* L) {
-    LUA_REGISTER_CLASS(L, "Item");
+    lua::registerClass<Item>(L, "Item");
 
-    LUA_REGISTER_METHOD(L, "getId", l_Item_getId);
-    LUA_REGISTER_METHOD(L, "getCount", l_Item_getCount);
-    LUA_REGISTER_METHOD(L, "isStackable", l_Item_isStackable);
-    LUA_REGISTER_METHOD(L, "isContainer", l_Item_isContainer);
-    LUA_REGISTER_METHOD(L, "isPickupable", l_Item_isPickupable);
-    LUA_REGISTER_METHOD(L, "isUseable", l_Item_isUseable);
+    lua::setMethod(L, "getId", &lua::method<&Item::getId>);
+    lua::setMethod(L, "getCount", &lua::method<&Item::getCount>);
+    lua::setMethod(L, "isStackable", &lua::method<&Item::isStackable>);
+    lua::setMethod(L, "isContainer", &lua::method<&Item::isContainer>);
+    lua::setMethod(L, "isPickupable", &lua::method<&Item::isPickupable>);
+    lua::setMethod(L, "isUseable", &lua::method<&Item::isUseable>);
 
     lua_pop(L, 1);
 }
 
 // Creature bindings
 
-static Creature* l_Creature_check(lua_State* L, int index) {
-    auto** creature = static_cast<Creature**>(luaL_checkudata(L, index, "Creature"));
-    return *creature;
-}
-
-static int l_Creature_getId(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushinteger(L, creature ? creature->getCreatureId() : 0);
-    return 1;
-}
-
-static int l_Creature_getName(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushstring(L, creature ? creature->getName().c_str() : "");
-    return 1;
-}
-
-static int l_Creature_getHealthPercent(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushinteger(L, creature ? creature->getHealthPercent() : 0);
-    return 1;
-}
-
-static int l_Creature_getSpeed(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushinteger(L, creature ? creature->getSpeed() : 0);
-    return 1;
-}
-
-static int l_Creature_getDirection(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushinteger(L, creature ? static_cast<int>(creature->getDirection()) : 0);
-    return 1;
-}
-
-static int l_Creature_getPosition(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    if (!creature) {
-        lua_pushnil(L);
-        return 1;
-    }
-
-    const auto& pos = creature->getPosition();
-    auto* result = static_cast<Position*>(lua_newuserdata(L, sizeof(Position)));
-    new (result) Position(pos);
-
-    luaL_getmetatable(L, "Position");
-    lua_setmetatable(L, -2);
-    return 1;
-}
-
-static int l_Creature_isWalking(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushboolean(L, creature ? creature->isWalking() : false);
-    return 1;
-}
-
-static int l_Creature_isPlayer(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushboolean(L, creature ? creature->isPlayer() : false);
-    return 1;
-}
-
-static int l_Creature_isMonster(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushboolean(L, creature ? creature->isMonster() : false);
-    return 1;
-}
-
-static int l_Creature_isNPC(lua_State* L) {
-    auto* creature = l_Creature_check(L, 1);
-    lua_pushboolean(L, creature ? creature->isNPC() : false);
-    return 1;
+// Bound on Creature and again on Player, whose userdata carries its own
+// metatable
+template<typename T>
+static void setCreatureMethods(lua_State* L) {
+    lua::setMethod(L, "getId", &lua::method<&Creature::getCreatureId, T>);
+    lua::setMethod(L, "getName", &lua::method<&Creature::getName, T>);
+    lua::setMethod(L, "getHealthPercent", &lua::method<&Creature::getHealthPercent, T>);
+    lua::setMethod(L, "getSpeed", &lua::method<&Creature::getSpeed, T>);
+    lua::setMethod(L, "getDirection", &lua::method<&Creature::getDirection, T>);
+    lua::setMethod(L, "getPosition", &lua::method<&Creature::getPosition, T>);
+    lua::setMethod(L, "isWalking", &lua::method<&Creature::isWalking, T>);
 }
 
 void registerCreatureLuaBindings(lua_State* L) {
-    LUA_REGISTER_CLASS(L, "Creature");
-
-    LUA_REGISTER_METHOD(L, "getId", l_Creature_getId);
-    LUA_REGISTER_METHOD(L, "getName", l_Creature_getName);
-    LUA_REGISTER_METHOD(L, "getHealthPercent", l_Creature_getHealthPercent);
-    LUA_REGISTER_METHOD(L, "getSpeed", l_Creature_getSpeed);
-    LUA_REGISTER_METHOD(L, "getDirection", l_Creature_getDirection);
-    LUA_REGISTER_METHOD(L, "getPosition", l_Creature_getPosition);
-    LUA_REGISTER_METHOD(L, "isWalking", l_Creature_isWalking);
-    LUA_REGISTER_METHOD(L, "isPlayer", l_Creature_isPlayer);
-    LUA_REGISTER_METHOD(L, "isMonster", l_Creature_isMonster);
-    LUA_REGISTER_METHOD(L, "isNPC", l_Creature_isNPC);
+    lua::registerClass<Creature>(L, "Creature");
+
+    setCreatureMethods<Creature>(L);
+    lua::setMethod(L, "isPlayer", &lua::method<&Creature::isPlayer>);
+    lua::setMethod(L, "isMonster", &lua::method<&Creature::isMonster>);
+    lua::setMethod(L, "isNPC", &lua::method<&Creature::isNPC>);
 
     lua_pop(L, 1);
 }
 
 // Player bindings
 
-static Player* l_Player_check(lua_State* L, int index) {
-    auto** player = static_cast<Player**>(luaL_checkudata(L, index, "Player"));
-    return *player;
-}
-
-static int l_Player_getHealth(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getHealth() : 0);
-    return 1;
-}
-
-static int l_Player_getMaxHealth(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getMaxHealth() : 0);
-    return 1;
-}
-
-static int l_Player_getMana(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getMana() : 0);
-    return 1;
-}
-
-static int l_Player_getMaxMana(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getMaxMana() : 0);
-    return 1;
-}
-
-static int l_Player_getLevel(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getLevel() : 0);
-    return 1;
-}
-
-static int l_Player_getMagicLevel(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getMagicLevel() : 0);
-    return 1;
-}
-
-static int l_Player_getSkillLevel(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    int skill = luaL_checkinteger(L, 2);
-    lua_pushinteger(L, player ? player->getSkillLevel(static_cast<Skill>(skill)) : 0);
-    return 1;
-}
-
-static int l_Player_getVocation(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushstring(L, player ? player->getVocationName().c_str() : "");
-    return 1;
-}
-
-static int l_Player_getSoul(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getSoul() : 0);
-    return 1;
-}
-
-static int l_Player_getCapacity(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getCapacity() : 0);
-    return 1;
-}
-
-static int l_Player_getFreeCapacity(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getFreeCapacity() : 0);
-    return 1;
-}
-
-static int l_Player_getStamina(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getStamina() : 0);
-    return 1;
-}
-
-static int l_Player_getExperience(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushnumber(L, player ? static_cast<double>(player->getExperience()) : 0);
-    return 1;
-}
-
-static int l_Player_isPremium(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushboolean(L, player ? player->isPremium() : false);
-    return 1;
-}
-
-static int l_Player_getStoreCoins(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getStoreCoins() : 0);
-    return 1;
-}
-
-static int l_Player_getTransferableCoins(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getTransferableCoins() : 0);
-    return 1;
-}
-
-static int l_Player_getBlessings(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getBlessings() : 0);
-    return 1;
-}
-
-static int l_Player_hasBlessing(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    int blessing = luaL_checkinteger(L, 2);
-    lua_pushboolean(L, player ? player->hasBlessing(blessing) : false);
-    return 1;
-}
-
-static int l_Player_getCharmPoints(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getCharmPoints() : 0);
-    return 1;
-}
-
-static int l_Player_getForgeDust(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushnumber(L, player ? static_cast<double>(player->getForgeDust()) : 0);
-    return 1;
-}
-
-static int l_Player_getForgeDustLevel(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushinteger(L, player ? player->getForgeDustLevel() : 0);
-    return 1;
-}
-
-static int l_Player_getBestiaryKills(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    int monsterId = luaL_checkinteger(L, 2);
-    lua_pushinteger(L, player ? player->getBestiaryKills(monsterId) : 0);
-    return 1;
-}
-
-static int l_Player_isBestiaryUnlocked(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    int monsterId = luaL_checkinteger(L, 2);
-    lua_pushboolean(L, player ? player->isBestiaryUnlocked(monsterId) : false);
-    return 1;
-}
-
-static int l_Player_hasCharm(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    int charmId = luaL_checkinteger(L, 2);
-    lua_pushboolean(L, player ? player->hasCharm(charmId) : false);
-    return 1;
-}
-
-static int l_Player_getGuildName(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushstring(L, player ? player->getGuildName().c_str() : "");
-    return 1;
-}
-
-static int l_Player_getGuildRank(lua_State* L) {
-    auto* player = l_Player_check(L, 1);
-    lua_pushstring(L, player ? player->getGuildRank().c_str() : "");
-    return 1;
-}
-
 void registerPlayerLuaBindings(lua_State* L) {
-    LUA_REGISTER_CLASS(L, "Player");
+    lua::registerClass<Player>(L, "Player");
 
     // Inherit from Creature
-    LUA_REGISTER_METHOD(L, "getId", l_Creature_getId);
-    LUA_REGISTER_METHOD(L, "getName", l_Creature_getName);
-    LUA_REGISTER_METHOD(L, "getHealthPercent", l_Creature_getHealthPercent);
-    LUA_REGISTER_METHOD(L, "getSpeed", l_Creature_getSpeed);
-    LUA_REGISTER_METHOD(L, "getDirection", l_Creature_getDirection);
-    LUA_REGISTER_METHOD(L, "getPosition", l_Creature_getPosition);
-    LUA_REGISTER_METHOD(L, "isWalking", l_Creature_isWalking);
+    setCreatureMethods<Player>(L);
 
     // Player-specific - Stats
-    LUA_REGISTER_METHOD(L, "getHealth", l_Player_getHealth);
-    LUA_REGISTER_METHOD(L, "getMaxHealth", l_Player_getMaxHealth);
-    LUA_REGISTER_METHOD(L, "getMana", l_Player_getMana);
-    LUA_REGISTER_METHOD(L, "getMaxMana", l_Player_getMaxMana);
-    LUA_REGISTER_METHOD(L, "getLevel", l_Player_getLevel);
-    LUA_REGISTER_METHOD(L, "getMagicLevel", l_Player_getMagicLevel);
-    LUA_REGISTER_METHOD(L, "getSkillLevel", l_Player_getSkillLevel);
-    LUA_REGISTER_METHOD(L, "getVocation", l_Player_getVocation);
-    LUA_REGISTER_METHOD(L, "getSoul", l_Player_getSoul);
-    LUA_REGISTER_METHOD(L, "getCapacity", l_Player_getCapacity);
-    LUA_REGISTER_METHOD(L, "getFreeCapacity", l_Player_getFreeCapacity);
-    LUA_REGISTER_METHOD(L, "getStamina", l_Player_getStamina);
-    LUA_REGISTER_METHOD(L, "getExperience", l_Player_getExperience);
-    LUA_REGISTER_METHOD(L, "isPremium", l_Player_isPremium);
+    lua::setMethod(L, "getHealth", &lua::method<&Player::getHealth>);
+    lua::setMethod(L, "getMaxHealth", &lua::method<&Player::getMaxHealth>);
+    lua::setMethod(L, "getMana", &lua::method<&Player::getMana>);
+    lua::setMethod(L, "getMaxMana", &lua::method<&Player::getMaxMana>);
+    lua::setMethod(L, "getLevel", &lua::method<&Player::getLevel>);
+    lua::setMethod(L, "getMagicLevel", &lua::method<&Player::getMagicLevel>);
+    lua::setMethod(L, "getSkillLevel", &lua::method<&Player::getSkillLevel>);
+    lua::setMethod(L, "getVocation", &lua::method<&Player::getVocationName>);
+    lua::setMethod(L, "getSoul", &lua::method<&Player::getSoul>);
+    lua::setMethod(L, "getCapacity", &lua::method<&Player::getCapacity>);
+    lua::setMethod(L, "getFreeCapacity", &lua::method<&Player::getFreeCapacity>);
+    lua::setMethod(L, "getStamina", &lua::method<&Player::getStamina>);
+    lua::setMethod(L, "getExperience", &lua::method<&Player::getExperience>);
+    lua::setMethod(L, "isPremium", &lua::method<&Player::isPremium>);
 
     // Store/Currency
-    LUA_REGISTER_METHOD(L, "getStoreCoins", l_Player_getStoreCoins);
-    LUA_REGISTER_METHOD(L, "getTransferableCoins", l_Player_getTransferableCoins);
+    lua::setMethod(L, "getStoreCoins", &lua::method<&Player::getStoreCoins>);
+    lua::setMethod(L, "getTransferableCoins", &lua::method<&Player::getTransferableCoins>);
 
     // Blessings
-    LUA_REGISTER_METHOD(L, "getBlessings", l_Player_getBlessings);
-    LUA_REGISTER_METHOD(L, "hasBlessing", l_Player_hasBlessing);
+    lua::setMethod(L, "getBlessings", &lua::method<&Player::getBlessings>);
+    lua::setMethod(L, "hasBlessing", &lua::method<&Player::hasBlessing>);
 
     // Bestiary/Charms
-    LUA_REGISTER_METHOD(L, "getBestiaryKills", l_Player_getBestiaryKills);
-    LUA_REGISTER_METHOD(L, "isBestiaryUnlocked", l_Player_isBestiaryUnlocked);
-    LUA_REGISTER_METHOD(L, "getCharmPoints", l_Player_getCharmPoints);
-    LUA_REGISTER_METHOD(L, "hasCharm", l_Player_hasCharm);
+    lua::setMethod(L, "getBestiaryKills", &lua::method<&Player::getBestiaryKills>);
+    lua::setMethod(L, "isBestiaryUnlocked", &lua::method<&Player::isBestiaryUnlocked>);
+    lua::setMethod(L, "getCharmPoints", &lua::method<&Player::getCharmPoints>);
+    lua::setMethod(L, "hasCharm", &lua::method<&Player::hasCharm>);
 
     // Forge
-    LUA_REGISTER_METHOD(L, "getForgeDust", l_Player_getForgeDust);
-    LUA_REGISTER_METHOD(L, "getForgeDustLevel", l_Player_getForgeDustLevel);
+    lua::setMethod(L, "getForgeDust", &lua::method<&Player::getForgeDust>);
+    lua::setMethod(L, "getForgeDustLevel", &lua::method<&Player::getForgeDustLevel>);
 
     // Guild
-    LUA_REGISTER_METHOD(L, "getGuildName", l_Player_getGuildName);
-    LUA_REGISTER_METHOD(L, "getGuildRank", l_Player_getGuildRank);
+    lua::setMethod(L, "getGuildName", &lua::method<&Player::getGuildName>);
+    lua::setMethod(L, "getGuildRank", &lua::method<&Player::getGuildRank>);
 
     lua_pop(L, 1);
 }
@@ -520,11 +275,7 @@ static int l_Tile_getTopCreature(lua_State* L) {
     }
 
     auto creature = tile->getCreature(0);
-    auto** ud = static_cast<Creature**>(lua_newuserdata(L, sizeof(Creature*)));
-    *ud = creature.get();
-
-    luaL_getmetatable(L, "Creature");
-    lua_setmetatable(L, -2);
+    lua::pushObject<Creature>(L, creature.get());
     return 1;
 }
 
@@ -536,11 +287,7 @@ static int l_Tile_getTopItem(lua_State* L) {
     }
 
     auto item = tile->getItem(0);
-    auto** ud = static_cast<Item**>(lua_newuserdata(L, sizeof(Item*)));
-    *ud = item.get();
-
-    luaL_getmetatable(L, "Item");
-    lua_setmetatable(L, -2);
+    lua::pushObject<Item>(L, item.get());
     return 1;
 }
 
@@ -557,11 +304,7 @@ static int l_Tile_getGround(lua_State* L) {
         return 1;
     }
 
-    auto** ud = static_cast<Item**>(lua_newuserdata(L, sizeof(Item*)));
-    *ud = ground.get();
-
-    luaL_getmetatable(L, "Item");
-    lua_setmetatable(L, -2);
+    lua::pushObject<Item>(L, ground.get());
     return 1;
 }
 
@@ -618,24 +361,15 @@ static int l_map_getCreatureById(lua_State* L) {
         return 1;
     }
 
-    auto** ud = static_cast<Creature**>(lua_newuserdata(L, sizeof(Creature*)));
-    *ud = creature.get();
-
-    luaL_getmetatable(L, "Creature");
-    lua_setmetatable(L, -2);
+    lua::pushObject<Creature>(L, creature.get());
     return 1;
 }
 
-static int l_map_findPath(lua_State* L) {
-    auto* start = static_cast<Position*>(luaL_checkudata(L, 1, "Position"));
-    auto* goal = static_cast<Position*>(luaL_checkudata(L, 2, "Position"));
-
-    auto path = g_map.findPath(*start, *goal);
-
-    // findPath returns a list of directions, convert to positions
+// Directions from findPath as a table of the positions walked through
+static void pushPathPositions(lua_State* L, const Position& start, const std::vector<Position::Direction>& path) {
     lua_newtable(L);
     int i = 1;
-    Position current = *start;
+    Position current = start;
     for (const auto& dir : path) {
         current = current.translated(dir);
         auto* p = static_cast<Position*>(lua_newuserdata(L, sizeof(Position)));
@@ -644,7 +378,107 @@ static int l_map_findPath(lua_State* L) {
         lua_setmetatable(L, -2);
         lua_rawseti(L, -2, i++);
     }
+}
+
+static int l_map_findPath(lua_State* L) {
+    auto* start = static_cast<Position*>(luaL_checkudata(L, 1, "Position"));
+    auto* goal = static_cast<Position*>(luaL_checkudata(L, 2, "Position"));
+
+    auto path = g_map.findPath(*start, *goal);
+    pushPathPositions(L, *start, path);
+    return 1;
+}
+
+// Positions (or nil) and one of "found", "nopath", "cancelled"
+static int pushPathResult(lua_State* L, const PathResult& result) {
+    if (result.status == PathStatus::Found) {
+        pushPathPositions(L, result.start, result.path);
+    } else {
+        lua_pushnil(L);
+    }
+    lua_pushstring(L, result.status == PathStatus::Found ? "found" :
+                      result.status == PathStatus::NoPath ? "nopath" : "cancelled");
+    return 2;
+}
+
+// g_map.findPathAsync(start, goal, function(path, status) end [, maxDistance [, group]])
+// Runs on the path service; the callback gets positions (or nil) and one of
+// "found", "nopath", "cancelled". A non-zero group supersedes earlier requests.
+static int l_map_findPathAsync(lua_State* L) {
+    auto* start = static_cast<Position*>(luaL_checkudata(L, 1, "Position"));
+    auto* goal = static_cast<Position*>(luaL_checkudata(L, 2, "Position"));
+    luaL_checktype(L, 3, LUA_TFUNCTION);
+
+    PathService::Options options;
+    options.maxDistance = luaL_optinteger(L, 4, options.maxDistance);
+    options.group = luaL_optinteger(L, 5, PathService::GROUP_NONE);
+
+    lua_pushvalue(L, 3);
+    auto callback = std::make_shared<LuaFunctionRef>(LuaFunctionRef{L, luaL_ref(L, LUA_REGISTRYINDEX)});
+
+    uint64_t id = g_pathService.request(*start, *goal, options, [callback](const PathResult& result) {
+        lua_State* L = callback->L;
+        lua_rawgeti(L, LUA_REGISTRYINDEX, callback->ref);
+        pushPathResult(L, result);
+        framework::g_luaProfiler.enter();
+        if (lua_pcall(L, 2, 0, 0) != LUA_OK) {
+            lua_pop(L, 1);
+        }
+    });
+
+    lua_pushinteger(L, static_cast<lua_Integer>(id));
+    return 1;
+}
+
+// g_map.findPathFuture(start, goal [, maxDistance [, group]]) -> future, request id
+// The same request for a task to waitPath on; cancelPath(id) still applies
+static int l_map_findPathFuture(lua_State* L) {
+    auto* start = static_cast<Position*>(luaL_checkudata(L, 1, "Position"));
+    auto* goal = static_cast<Position*>(luaL_checkudata(L, 2, "Position"));
 
+    PathService::Options options;
+    options.maxDistance = luaL_optinteger(L, 3, options.maxDistance);
+    options.group = luaL_optinteger(L, 4, PathService::GROUP_NONE);
+
+    framework::LuaScheduler::FutureId future = g_lua.getScheduler().createFuture();
+    uint64_t id = g_pathService.request(*start, *goal, options, [future](const PathResult& result) {
+        g_lua.getScheduler().completeFuture(future, [&result](lua_State* L) {
+            return pushPathResult(L, result);
+        });
+    });
+
+    lua_pushinteger(L, static_cast<lua_Integer>(future));
+    lua_pushinteger(L, static_cast<lua_Integer>(id));
+    return 2;
+}
+
+static int l_map_cancelPath(lua_State* L) {
+    g_pathService.cancel(static_cast<uint64_t>(luaL_checkinteger(L, 1)));
+    return 0;
+}
+
+// g_map.setTileBudget(maxBytes [, keepDistance]); 0 bytes keeps every tile
+static int l_map_setTileBudget(lua_State* L) {
+    Map::TileBudget budget = g_map.getTileBudget();
+    budget.maxBytes = static_cast<size_t>(luaL_checkinteger(L, 1));
+    budget.keepDistance = static_cast<int>(luaL_optinteger(L, 2, budget.keepDistance));
+    g_map.setTileBudget(budget);
+    return 0;
+}
+
+static int l_map_getTileStats(lua_State* L) {
+    auto stats = g_map.getTileStats();
+    lua_newtable(L);
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.residentTiles));
+    lua_setfield(L, -2, "residentTiles");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.residentChunks));
+    lua_setfield(L, -2, "residentChunks");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.residentBytes));
+    lua_setfield(L, -2, "residentBytes");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.evictedChunks));
+    lua_setfield(L, -2, "evictedChunks");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.evictedTiles));
+    lua_setfield(L, -2, "evictedTiles");
     return 1;
 }
 
@@ -663,6 +497,21 @@ void registerMapLuaBindings(lua_State* L) {
     lua_pushcfunction(L, l_map_findPath);
     lua_setfield(L, -2, "findPath");
 
+    lua_pushcfunction(L, l_map_findPathAsync);
+    lua_setfield(L, -2, "findPathAsync");
+
+    lua_pushcfunction(L, l_map_findPathFuture);
+    lua_setfield(L, -2, "findPathFuture");
+
+    lua_pushcfunction(L, l_map_cancelPath);
+    lua_setfield(L, -2, "cancelPath");
+
+    lua_pushcfunction(L, l_map_setTileBudget);
+    lua_setfield(L, -2, "setTileBudget");
+
+    lua_pushcfunction(L, l_map_getTileStats);
+    lua_setfield(L, -2, "getTileStats");
+
     lua_setglobal(L, "g_map");
 }
 
@@ -712,11 +561,7 @@ static int l_Container_getItem(lua_State* L) {
         return 1;
     }
 
-    auto** ud = static_cast<Item**>(lua_newuserdata(L, sizeof(Item*)));
-    *ud = item.get();
-
-    luaL_getmetatable(L, "Item");
-    lua_setmetatable(L, -2);
+    lua::pushObject<Item>(L, item.get());
     return 1;
 }
 
@@ -769,11 +614,7 @@ static int l_game_getLocalPlayer(lua_State* L) {
         return 1;
     }
 
-    auto** ud = static_cast<LocalPlayer**>(lua_newuserdata(L, sizeof(LocalPlayer*)));
-    *ud = player.get();
-
-    luaL_getmetatable(L, "Player");
-    lua_setmetatable(L, -2);
+    lua::pushObject<Player>(L, player.get());
     return 1;
 }
 
@@ -789,6 +630,13 @@ static int l_game_turn(lua_State* L) {
     return 0;
 }
 
+static int l_game_autoWalkTo(lua_State* L) {
+    auto* goal = static_cast<Position*>(luaL_checkudata(L, 1, "Position"));
+    int maxDistance = luaL_optinteger(L, 2, 100);
+    g_game.autoWalkTo(*goal, maxDistance);
+    return 0;
+}
+
 static int l_game_stop(lua_State* L) {
     g_game.stop();
     return 0;
@@ -904,6 +752,83 @@ static int l_game_logout(lua_State* L) {
     return 0;
 }
 
+// g_game.registerOpcode(opcode, function(opcode, payload) end)
+// The function receives the rest of the frame as a string and consumes it
+static int l_game_registerOpcode(lua_State* L) {
+    uint8_t opcode = luaL_checkinteger(L, 1);
+    luaL_checktype(L, 2, LUA_TFUNCTION);
+
+    auto protocol = g_game.getProtocol();
+    if (!protocol) {
+        lua_pushboolean(L, false);
+        return 1;
+    }
+
+    lua_pushvalue(L, 2);
+    auto callback = std::make_shared<LuaFunctionRef>(LuaFunctionRef{L, luaL_ref(L, LUA_REGISTRYINDEX)});
+
+    protocol->registerHandler(opcode, [callback, opcode](framework::NetworkMessage& msg) {
+        lua_State* L = callback->L;
+        size_t position = msg.getPosition();
+        size_t length = msg.getSize() - position;
+        msg.setPosition(msg.getSize());
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, callback->ref);
+        lua_pushinteger(L, opcode);
+        lua_pushlstring(L, reinterpret_cast<const char*>(msg.getBuffer() + position), length);
+        framework::g_luaProfiler.enter();
+        if (lua_pcall(L, 2, 0, 0) != LUA_OK) {
+            lua_pop(L, 1);
+        }
+    });
+
+    lua_pushboolean(L, true);
+    return 1;
+}
+
+static int l_game_unregisterOpcode(lua_State* L) {
+    uint8_t opcode = luaL_checkinteger(L, 1);
+    if (auto protocol = g_game.getProtocol()) {
+        protocol->unregisterHandler(opcode);
+    }
+    return 0;
+}
+
+static int l_game_setOpcodeProfiling(lua_State* L) {
+    bool enabled = lua_toboolean(L, 1);
+    if (auto protocol = g_game.getProtocol()) {
+        protocol->setOpcodeProfiling(enabled);
+    }
+    return 0;
+}
+
+// Returns {calls, bytes, totalNs, histogram = {...}} or nil
+static int l_game_getOpcodeStats(lua_State* L) {
+    uint8_t opcode = luaL_checkinteger(L, 1);
+    auto protocol = g_game.getProtocol();
+    if (!protocol) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    const auto& stats = protocol->getOpcodeStats(opcode);
+    lua_newtable(L);
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.calls));
+    lua_setfield(L, -2, "calls");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.bytes));
+    lua_setfield(L, -2, "bytes");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.totalNs));
+    lua_setfield(L, -2, "totalNs");
+
+    lua_newtable(L);
+    for (size_t i = 0; i < stats.histogram.size(); ++i) {
+        lua_pushinteger(L, stats.histogram[i]);
+        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+    }
+    lua_setfield(L, -2, "histogram");
+    return 1;
+}
+
 void registerGameLuaBindings(lua_State* L) {
     lua_newtable(L);
 
@@ -919,6 +844,9 @@ void registerGameLuaBindings(lua_State* L) {
     lua_pushcfunction(L, l_game_turn);
     lua_setfield(L, -2, "turn");
 
+    lua_pushcfunction(L, l_game_autoWalkTo);
+    lua_setfield(L, -2, "autoWalkTo");
+
     lua_pushcfunction(L, l_game_stop);
     lua_setfield(L, -2, "stop");
 
@@ -970,6 +898,18 @@ void registerGameLuaBindings(lua_State* L) {
     lua_pushcfunction(L, l_game_logout);
     lua_setfield(L, -2, "logout");
 
+    lua_pushcfunction(L, l_game_registerOpcode);
+    lua_setfield(L, -2, "registerOpcode");
+
+    lua_pushcfunction(L, l_game_unregisterOpcode);
+    lua_setfield(L, -2, "unregisterOpcode");
+
+    lua_pushcfunction(L, l_game_setOpcodeProfiling);
+    lua_setfield(L, -2, "setOpcodeProfiling");
+
+    lua_pushcfunction(L, l_game_getOpcodeStats);
+    lua_setfield(L, -2, "getOpcodeStats");
+
     // Direction constants
     lua_newtable(L);
     lua_pushinteger(L, static_cast<int>(Position::North));
@@ -1153,6 +1093,99 @@ static int l_UIWidget_destroy(lua_State* L) {
     return 0;
 }
 
+// UIScrollablePanel virtual lists; other widget types ignore them
+
+static void pushWidget(lua_State* L, framework::UIWidget* widget) {
+    auto** ud = static_cast<framework::UIWidget**>(lua_newuserdata(L, sizeof(framework::UIWidget*)));
+    *ud = widget;
+    luaL_getmetatable(L, "UIWidget");
+    lua_setmetatable(L, -2);
+}
+
+// panel:setVirtualList(count, rowHeight, rowStyle, function(row, index)); rows
+// are created from the style and bound with 1-based indices
+static int l_UIWidget_setVirtualList(lua_State* L) {
+    auto* panel = dynamic_cast<framework::UIScrollablePanel*>(l_UIWidget_check(L, 1));
+    size_t count = static_cast<size_t>(std::max<lua_Integer>(luaL_checkinteger(L, 2), 0));
+    int rowHeight = luaL_checkinteger(L, 3);
+    std::string style = luaL_checkstring(L, 4);
+    luaL_checktype(L, 5, LUA_TFUNCTION);
+    if (!panel) return 0;
+
+    lua_pushvalue(L, 5);
+    auto callback = std::make_shared<LuaFunctionRef>(LuaFunctionRef{L, luaL_ref(L, LUA_REGISTRYINDEX)});
+
+    panel->setVirtualList(count, rowHeight,
+        [style] { return framework::UIManager::instance().createWidget(style); },
+        [callback](const framework::UIWidgetPtr& row, size_t index) {
+            lua_State* L = callback->L;
+            lua_rawgeti(L, LUA_REGISTRYINDEX, callback->ref);
+            pushWidget(L, row.get());
+            lua_pushinteger(L, static_cast<lua_Integer>(index + 1));
+            framework::g_luaProfiler.enter();
+            if (lua_pcall(L, 2, 0, 0) != LUA_OK) {
+                lua_pop(L, 1);
+            }
+        });
+    return 0;
+}
+
+static int l_UIWidget_setItemCount(lua_State* L) {
+    auto* panel = dynamic_cast<framework::UIScrollablePanel*>(l_UIWidget_check(L, 1));
+    lua_Integer count = luaL_checkinteger(L, 2);
+    if (panel) panel->setItemCount(static_cast<size_t>(std::max<lua_Integer>(count, 0)));
+    return 0;
+}
+
+static int l_UIWidget_getItemCount(lua_State* L) {
+    auto* panel = dynamic_cast<framework::UIScrollablePanel*>(l_UIWidget_check(L, 1));
+    lua_pushinteger(L, panel ? static_cast<lua_Integer>(panel->getItemCount()) : 0);
+    return 1;
+}
+
+static int l_UIWidget_refreshRows(lua_State* L) {
+    auto* panel = dynamic_cast<framework::UIScrollablePanel*>(l_UIWidget_check(L, 1));
+    if (panel) panel->refreshRows();
+    return 0;
+}
+
+static int l_UIWidget_scrollToIndex(lua_State* L) {
+    auto* panel = dynamic_cast<framework::UIScrollablePanel*>(l_UIWidget_check(L, 1));
+    lua_Integer index = luaL_checkinteger(L, 2);
+    if (panel) panel->scrollToIndex(static_cast<size_t>(std::max<lua_Integer>(index - 1, 0)));
+    return 0;
+}
+
+static int l_UIWidget_scrollToBottom(lua_State* L) {
+    auto* panel = dynamic_cast<framework::UIScrollablePanel*>(l_UIWidget_check(L, 1));
+    if (panel) panel->scrollToBottom();
+    return 0;
+}
+
+// UIMinimap methods; other widget types ignore them
+
+static int l_UIWidget_setCenter(lua_State* L) {
+    auto* minimap = dynamic_cast<UIMinimap*>(l_UIWidget_check(L, 1));
+    float x = static_cast<float>(luaL_checknumber(L, 2));
+    float y = static_cast<float>(luaL_checknumber(L, 3));
+    int z = static_cast<int>(luaL_optinteger(L, 4, minimap ? minimap->getFloor() : 7));
+    if (minimap) minimap->setCenter(x, y, z);
+    return 0;
+}
+
+static int l_UIWidget_setZoom(lua_State* L) {
+    auto* minimap = dynamic_cast<UIMinimap*>(l_UIWidget_check(L, 1));
+    int zoom = luaL_checkinteger(L, 2);
+    if (minimap) minimap->setZoom(zoom);
+    return 0;
+}
+
+static int l_UIWidget_getTileSize(lua_State* L) {
+    auto* minimap = dynamic_cast<UIMinimap*>(l_UIWidget_check(L, 1));
+    lua_pushinteger(L, minimap ? minimap->getTileSize() : 0);
+    return 1;
+}
+
 void registerUILuaBindings(lua_State* L) {
     // UIWidget metatable
     LUA_REGISTER_CLASS(L, "UIWidget");
@@ -1171,6 +1204,15 @@ void registerUILuaBindings(lua_State* L) {
     LUA_REGISTER_METHOD(L, "getText", l_UIWidget_getText);
     LUA_REGISTER_METHOD(L, "focus", l_UIWidget_focus);
     LUA_REGISTER_METHOD(L, "destroy", l_UIWidget_destroy);
+    LUA_REGISTER_METHOD(L, "setVirtualList", l_UIWidget_setVirtualList);
+    LUA_REGISTER_METHOD(L, "setItemCount", l_UIWidget_setItemCount);
+    LUA_REGISTER_METHOD(L, "getItemCount", l_UIWidget_getItemCount);
+    LUA_REGISTER_METHOD(L, "refreshRows", l_UIWidget_refreshRows);
+    LUA_REGISTER_METHOD(L, "scrollToIndex", l_UIWidget_scrollToIndex);
+    LUA_REGISTER_METHOD(L, "scrollToBottom", l_UIWidget_scrollToBottom);
+    LUA_REGISTER_METHOD(L, "setCenter", l_UIWidget_setCenter);
+    LUA_REGISTER_METHOD(L, "setZoom", l_UIWidget_setZoom);
+    LUA_REGISTER_METHOD(L, "getTileSize", l_UIWidget_getTileSize);
 
     lua_pop(L, 1);
 
@@ -1224,6 +1266,227 @@ void registerEffectLuaBindings(lua_State* L) {
     lua_setglobal(L, "g_missiles");
 }
 
+// Thing type bindings
+
+// g_things.setSpriteCacheBudget(bytes)
+static int l_things_setSpriteCacheBudget(lua_State* L) {
+    ThingTypeManager::instance().setSpriteCacheBudget(static_cast<size_t>(luaL_checkinteger(L, 1)));
+    return 0;
+}
+
+static int l_things_getSpriteCacheStats(lua_State* L) {
+    auto& manager = ThingTypeManager::instance();
+    const auto& atlas = manager.getSpriteAtlas();
+    const auto& stats = manager.getSpriteCacheStats();
+    lua_newtable(L);
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.hits));
+    lua_setfield(L, -2, "hits");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.misses));
+    lua_setfield(L, -2, "misses");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.evictedPages));
+    lua_setfield(L, -2, "evictedPages");
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.evictedRegions));
+    lua_setfield(L, -2, "evictedSprites");
+    lua_pushinteger(L, static_cast<lua_Integer>(atlas.getRegionCount()));
+    lua_setfield(L, -2, "residentSprites");
+    lua_pushinteger(L, static_cast<lua_Integer>(atlas.getTextureBytes()));
+    lua_setfield(L, -2, "residentBytes");
+    lua_pushinteger(L, static_cast<lua_Integer>(atlas.getMemoryBudget()));
+    lua_setfield(L, -2, "budgetBytes");
+    return 1;
+}
+
+void registerThingLuaBindings(lua_State* L) {
+    lua_newtable(L);
+
+    lua_pushcfunction(L, l_things_setSpriteCacheBudget);
+    lua_setfield(L, -2, "setSpriteCacheBudget");
+
+    lua_pushcfunction(L, l_things_getSpriteCacheStats);
+    lua_setfield(L, -2, "getSpriteCacheStats");
+
+    lua_setglobal(L, "g_things");
+}
+
+// Memory bindings
+
+// g_memory.getUsage() -> { tiles = { bytes, peakBytes, allocations }, ... }
+static int l_memory_getUsage(lua_State* L) {
+    lua_newtable(L);
+    for (size_t tag = 0; tag < framework::MemoryTracker::TAG_COUNT; ++tag) {
+        auto usage = g_memory.getUsage(static_cast<framework::MemoryTag>(tag));
+        lua_newtable(L);
+        lua_pushinteger(L, static_cast<lua_Integer>(usage.bytes));
+        lua_setfield(L, -2, "bytes");
+        lua_pushinteger(L, static_cast<lua_Integer>(usage.peakBytes));
+        lua_setfield(L, -2, "peakBytes");
+        lua_pushinteger(L, static_cast<lua_Integer>(usage.allocations));
+        lua_setfield(L, -2, "allocations");
+        lua_setfield(L, -2, framework::MemoryTracker::getTagName(static_cast<framework::MemoryTag>(tag)));
+    }
+    return 1;
+}
+
+static int l_memory_getTotal(lua_State* L) {
+    lua_pushinteger(L, static_cast<lua_Integer>(g_memory.getTotalBytes()));
+    return 1;
+}
+
+// g_memory.setDumpFile(path [, intervalSeconds]); "" stops dumping
+static int l_memory_setDumpFile(lua_State* L) {
+    std::string path = luaL_checkstring(L, 1);
+    auto interval = std::chrono::seconds(static_cast<int64_t>(luaL_optinteger(L, 2, 60)));
+    lua_pushboolean(L, g_memory.setDumpFile(path, interval));
+    return 1;
+}
+
+static int l_memory_dump(lua_State* L) {
+    g_memory.dump();
+    return 0;
+}
+
+void registerMemoryLuaBindings(lua_State* L) {
+    lua_newtable(L);
+
+    lua_pushcfunction(L, l_memory_getUsage);
+    lua_setfield(L, -2, "getUsage");
+
+    lua_pushcfunction(L, l_memory_getTotal);
+    lua_setfield(L, -2, "getTotal");
+
+    lua_pushcfunction(L, l_memory_setDumpFile);
+    lua_setfield(L, -2, "setDumpFile");
+
+    lua_pushcfunction(L, l_memory_dump);
+    lua_setfield(L, -2, "dump");
+
+    lua_setglobal(L, "g_memory");
+}
+
+// Network telemetry bindings
+
+// g_net.getStats() -> { connected, bytesSentPerSecond, rttP50Us, ..., tcp = { ... } }
+static int l_net_getStats(lua_State* L) {
+    const NetworkTelemetry::Sample& sample = g_netTelemetry.getSample();
+    auto setNumber = [L](const char* name, double value) {
+        lua_pushnumber(L, value);
+        lua_setfield(L, -2, name);
+    };
+    auto setInteger = [L](const char* name, uint64_t value) {
+        lua_pushinteger(L, static_cast<lua_Integer>(value));
+        lua_setfield(L, -2, name);
+    };
+
+    lua_newtable(L);
+    lua_pushboolean(L, sample.connected);
+    lua_setfield(L, -2, "connected");
+    setNumber("bytesSentPerSecond", sample.bytesSentPerSecond);
+    setNumber("bytesReceivedPerSecond", sample.bytesReceivedPerSecond);
+    setNumber("packetsSentPerSecond", sample.packetsSentPerSecond);
+    setNumber("packetsReceivedPerSecond", sample.packetsReceivedPerSecond);
+    setInteger("rttSamples", sample.rttSamples);
+    setInteger("rttP50Us", sample.rttP50Us);
+    setInteger("rttP95Us", sample.rttP95Us);
+    setInteger("rttP99Us", sample.rttP99Us);
+    setInteger("jitterUs", sample.jitterUs);
+    setInteger("sendQueueDepth", sample.sendQueueDepth);
+    setInteger("sendQueueMaxDepth", sample.sendQueueMaxDepth);
+    setInteger("queueP50Us", sample.queueP50Us);
+    setInteger("queueP99Us", sample.queueP99Us);
+    setInteger("receiveP50Us", sample.receiveP50Us);
+    setInteger("receiveP95Us", sample.receiveP95Us);
+    setInteger("receiveP99Us", sample.receiveP99Us);
+
+    if (sample.tcp.available) {
+        lua_newtable(L);
+        setInteger("rttUs", sample.tcp.rttUs);
+        setInteger("rttVarUs", sample.tcp.rttVarUs);
+        setInteger("retransmits", sample.tcp.retransmits);
+        setInteger("lost", sample.tcp.lost);
+        setInteger("congestionWindow", sample.tcp.congestionWindow);
+        setInteger("unacked", sample.tcp.unacked);
+        lua_setfield(L, -2, "tcp");
+    }
+    return 1;
+}
+
+static int l_net_setOverlayVisible(lua_State* L) {
+    g_netTelemetry.setOverlayVisible(lua_toboolean(L, 1));
+    return 0;
+}
+
+// g_net.setExportFile(path [, intervalSeconds]); "" stops exporting
+static int l_net_setExportFile(lua_State* L) {
+    std::string path = luaL_checkstring(L, 1);
+    auto interval = std::chrono::seconds(static_cast<int64_t>(luaL_optinteger(L, 2, 10)));
+    lua_pushboolean(L, g_netTelemetry.setExportFile(path, interval));
+    return 1;
+}
+
+// g_net.setPingInterval(milliseconds); 0 stops the probes
+static int l_net_setPingInterval(lua_State* L) {
+    g_netTelemetry.setPingInterval(std::chrono::milliseconds(static_cast<int64_t>(luaL_checkinteger(L, 1))));
+    return 0;
+}
+
+void registerNetLuaBindings(lua_State* L) {
+    lua_newtable(L);
+
+    lua_pushcfunction(L, l_net_getStats);
+    lua_setfield(L, -2, "getStats");
+
+    lua_pushcfunction(L, l_net_setOverlayVisible);
+    lua_setfield(L, -2, "setOverlayVisible");
+
+    lua_pushcfunction(L, l_net_setExportFile);
+    lua_setfield(L, -2, "setExportFile");
+
+    lua_pushcfunction(L, l_net_setPingInterval);
+    lua_setfield(L, -2, "setPingInterval");
+
+    lua_setglobal(L, "g_net");
+}
+
+// Game events for waitFor; each names its arguments
+//   "gameStart", "gameEnd"
+//   "death"        deathType, penalty
+//   "textMessage"  type, text
+//   "talk"         name, level, speakType, text, channelId
+// The scheduler's own functions (spawn, wait, waitPacket, waitPath...) are
+// registered with the Lua interface.
+void registerTaskLuaBindings(lua_State* L) {
+    g_game.onGameStart = [] { g_lua.getScheduler().signal("gameStart"); };
+    g_game.onGameEnd = [] { g_lua.getScheduler().signal("gameEnd"); };
+
+    g_game.onDeath = [](uint8_t deathType, uint8_t penalty) {
+        g_lua.getScheduler().signal("death", [=](lua_State* L) {
+            lua_pushinteger(L, deathType);
+            lua_pushinteger(L, penalty);
+            return 2;
+        });
+    };
+
+    g_game.onTextMessage = [](uint8_t type, std::string_view message) {
+        g_lua.getScheduler().signal("textMessage", [=](lua_State* L) {
+            lua_pushinteger(L, type);
+            lua_pushlstring(L, message.data(), message.size());
+            return 2;
+        });
+    };
+
+    g_game.onTalk = [](std::string_view name, uint16_t level, uint8_t speakType,
+                       const Position&, uint16_t channelId, std::string_view text) {
+        g_lua.getScheduler().signal("talk", [=](lua_State* L) {
+            lua_pushlstring(L, name.data(), name.size());
+            lua_pushinteger(L, level);
+            lua_pushinteger(L, speakType);
+            lua_pushlstring(L, text.data(), text.size());
+            lua_pushinteger(L, channelId);
+            return 5;
+        });
+    };
+}
+
 // Main registration function
 
 void registerLuaBindings(lua_State* L) {
@@ -1237,6 +1500,11 @@ void registerLuaBindings(lua_State* L) {
     registerGameLuaBindings(L);
     registerUILuaBindings(L);
     registerEffectLuaBindings(L);
+    registerThingLuaBindings(L);
+    registerMemoryLuaBindings(L);
+    registerNetLuaBindings(L);
+    registerTaskLuaBindings(L);
+    registerFFILuaBindings(L);
 }
 
 } // namespace client
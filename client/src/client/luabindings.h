@@ -25,6 +25,10 @@ void registerContainerLuaBindings(lua_State* L);
 void registerGameLuaBindings(lua_State* L);
 void registerUILuaBindings(lua_State* L);
 void registerEffectLuaBindings(lua_State* L);
+void registerThingLuaBindings(lua_State* L);
+void registerMemoryLuaBindings(lua_State* L);
+void registerNetLuaBindings(lua_State* L);
+void registerTaskLuaBindings(lua_State* L);
 
 } // namespace client
 } // namespace shadow
@@ -0,0 +1,187 @@
+/**
+ * Shadow OT Client - Lua FFI Views Implementation
+ */
+
+#include "luaffi.h"
+#include "map.h"
+#include "creature.h"
+#include "tile.h"
+#include "item.h"
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+namespace shadow {
+namespace client {
+
+#ifdef SHADOW_LUA_FFI_ENABLED
+
+namespace {
+
+static_assert(sizeof(ShadowFFIPosition) == 8, "ShadowFFIPosition layout changed");
+static_assert(sizeof(ShadowFFICreature) == 20 && offsetof(ShadowFFICreature, speed) == 12,
+              "ShadowFFICreature layout changed");
+static_assert(sizeof(ShadowFFITile) == 20 && offsetof(ShadowFFITile, topCreatureId) == 16,
+              "ShadowFFITile layout changed");
+
+// The declarations of luaffi.h, for ffi.cdef
+constexpr const char* FFI_PRELUDE = R"lua(
+local ffi = require("ffi")
+local apiPointer = ...
+
+ffi.cdef[[
+typedef struct {
+    uint16_t x, y;
+    uint8_t z;
+    uint8_t pad[3];
+} ShadowFFIPosition;
+
+typedef struct {
+    uint32_t id;
+    ShadowFFIPosition position;
+    uint16_t speed;
+    uint8_t healthPercent, direction, type, walking, skull, shield;
+} ShadowFFICreature;
+
+typedef struct {
+    ShadowFFIPosition position;
+    uint16_t groundSpeed, topItemId;
+    uint8_t itemCount, creatureCount, walkable, pathable;
+    uint32_t topCreatureId;
+} ShadowFFITile;
+
+typedef struct {
+    int (*creaturesInRange)(const ShadowFFIPosition*, int, ShadowFFICreature*, int);
+    int (*creature)(uint32_t, ShadowFFICreature*);
+    int (*tile)(const ShadowFFIPosition*, ShadowFFITile*);
+} ShadowFFIApi;
+]]
+
+local api = ffi.cast("const ShadowFFIApi*", apiPointer)
+local position = ffi.new("ShadowFFIPosition")
+local capacity = 64
+local creatures = ffi.new("ShadowFFICreature[?]", capacity)
+local creature = ffi.new("ShadowFFICreature")
+local tile = ffi.new("ShadowFFITile")
+local constCreatures = ffi.typeof("const ShadowFFICreature*")
+local constTile = ffi.typeof("const ShadowFFITile*")
+
+local M = { available = true }
+
+function M.creaturesInRange(x, y, z, range)
+    position.x, position.y, position.z = x, y, z
+    local count = api.creaturesInRange(position, range, creatures, capacity)
+    if count > capacity then
+        while capacity < count do capacity = capacity * 2 end
+        creatures = ffi.new("ShadowFFICreature[?]", capacity)
+        count = api.creaturesInRange(position, range, creatures, capacity)
+    end
+    return ffi.cast(constCreatures, creatures), math.min(count, capacity)
+end
+
+function M.creature(id)
+    if api.creature(id, creature) == 0 then return nil end
+    return ffi.cast(constCreatures, creature)
+end
+
+function M.tile(x, y, z)
+    position.x, position.y, position.z = x, y, z
+    if api.tile(position, tile) == 0 then return nil end
+    return ffi.cast(constTile, tile)
+end
+
+return M
+)lua";
+
+void fillCreature(const Creature& creature, ShadowFFICreature& out) {
+    const Position& pos = creature.getPosition();
+    out.id = creature.getCreatureId();
+    out.position = {pos.x, pos.y, pos.z, {}};
+    out.speed = creature.getSpeed();
+    out.healthPercent = static_cast<uint8_t>(creature.getHealthPercent());
+    out.direction = static_cast<uint8_t>(creature.getDirection());
+    out.type = static_cast<uint8_t>(creature.getType());
+    out.walking = creature.isWalking() ? 1 : 0;
+    out.skull = static_cast<uint8_t>(creature.getSkull());
+    out.shield = static_cast<uint8_t>(creature.getShield());
+}
+
+int ffiCreaturesInRange(const ShadowFFIPosition* center, int range, ShadowFFICreature* out, int capacity) {
+    int count = 0;
+    g_map.forEachCreatureInRange(Position(center->x, center->y, center->z), range,
+                                 [&](const std::shared_ptr<Creature>& creature) {
+        if (count < capacity) fillCreature(*creature, out[count]);
+        count++;
+    });
+    return count;
+}
+
+int ffiCreature(uint32_t id, ShadowFFICreature* out) {
+    auto creature = g_map.getCreatureById(id);
+    if (!creature) return 0;
+    fillCreature(*creature, *out);
+    return 1;
+}
+
+int ffiTile(const ShadowFFIPosition* position, ShadowFFITile* out) {
+    auto tile = g_map.getTile(Position(position->x, position->y, position->z));
+    if (!tile) return 0;
+
+    auto topItem = tile->getTopItem();
+    auto topCreature = tile->getTopCreature();
+    *out = ShadowFFITile{};
+    out->position = *position;
+    out->groundSpeed = tile->getGroundSpeed();
+    out->topItemId = topItem ? topItem->getId() : 0;
+    out->itemCount = static_cast<uint8_t>(std::min(tile->getItemCount(), 255));
+    out->creatureCount = static_cast<uint8_t>(std::min(tile->getCreatureCount(), 255));
+    out->walkable = tile->isWalkable() ? 1 : 0;
+    out->pathable = tile->isPathable() ? 1 : 0;
+    out->topCreatureId = topCreature ? topCreature->getCreatureId() : 0;
+    return 1;
+}
+
+const ShadowFFIApi FFI_API = {ffiCreaturesInRange, ffiCreature, ffiTile};
+
+} // anonymous namespace
+
+void registerFFILuaBindings(lua_State* L) {
+    if (luaL_loadstring(L, FFI_PRELUDE) == 0) {
+        lua_pushlightuserdata(L, const_cast<ShadowFFIApi*>(&FFI_API));
+        if (lua_pcall(L, 1, 1, 0) == 0) {
+            lua_setglobal(L, "g_ffi");
+            return;
+        }
+    }
+
+    // No ffi module after all: degrade to the fallback table, keeping the
+    // reason in g_ffi.error for scripts to report
+    const char* reason = lua_tostring(L, -1);
+    std::string error = reason ? reason : "unknown error";
+    lua_pop(L, 1);
+    lua_newtable(L);
+    lua_pushboolean(L, 0);
+    lua_setfield(L, -2, "available");
+    lua_pushstring(L, error.c_str());
+    lua_setfield(L, -2, "error");
+    lua_setglobal(L, "g_ffi");
+}
+
+#else
+
+void registerFFILuaBindings(lua_State* L) {
+    lua_newtable(L);
+    lua_pushboolean(L, 0);
+    lua_setfield(L, -2, "available");
+    lua_setglobal(L, "g_ffi");
+}
+
+#endif
+
+} // namespace client
+} // namespace shadow
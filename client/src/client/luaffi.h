@@ -0,0 +1,79 @@
+/**
+ * Shadow OT Client - Lua FFI Views
+ *
+ * Read-only C struct snapshots of positions, creatures and tiles for
+ * scripts under LuaJIT. One call fills a whole array of creature views;
+ * scripts then read the fields straight from memory, which the JIT
+ * compiles to plain loads instead of a C function call per field:
+ *
+ *   local creatures, count = g_ffi.creaturesInRange(x, y, z, 7)
+ *   for i = 0, count - 1 do
+ *       if creatures[i].healthPercent < 30 then ... end
+ *   end
+ *
+ * Arrays are zero-based and reused by the next call of the same function.
+ * g_ffi.available is false when the client is built against plain Lua or
+ * without SHADOW_ENABLE_LUA_FFI; scripts fall back to the C bindings. If
+ * the ffi module failed to load, g_ffi.error says why.
+ *
+ * The layouts below are also declared to the FFI in luaffi.cpp and must
+ * stay in step with it.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+struct lua_State;
+
+extern "C" {
+
+struct ShadowFFIPosition {
+    uint16_t x;
+    uint16_t y;
+    uint8_t z;
+    uint8_t pad[3];
+};
+
+struct ShadowFFICreature {
+    uint32_t id;
+    ShadowFFIPosition position;
+    uint16_t speed;
+    uint8_t healthPercent;
+    uint8_t direction;
+    uint8_t type;               // CreatureType
+    uint8_t walking;
+    uint8_t skull;
+    uint8_t shield;
+};
+
+struct ShadowFFITile {
+    ShadowFFIPosition position;
+    uint16_t groundSpeed;
+    uint16_t topItemId;         // 0 if there are no items
+    uint8_t itemCount;          // Saturated at 255
+    uint8_t creatureCount;
+    uint8_t walkable;
+    uint8_t pathable;
+    uint32_t topCreatureId;     // 0 if there are no creatures
+};
+
+// Entry points handed to the FFI by address. Each returns the number of
+// entries available; creaturesInRange may return more than capacity, in
+// which case only capacity entries were written.
+struct ShadowFFIApi {
+    int (*creaturesInRange)(const ShadowFFIPosition* center, int range, ShadowFFICreature* out, int capacity);
+    int (*creature)(uint32_t id, ShadowFFICreature* out);
+    int (*tile)(const ShadowFFIPosition* position, ShadowFFITile* out);
+};
+
+} // extern "C"
+
+namespace shadow {
+namespace client {
+
+// Defines g_ffi; under LuaJIT with FFI views enabled, also its functions
+void registerFFILuaBindings(lua_State* L);
+
+} // namespace client
+} // namespace shadow
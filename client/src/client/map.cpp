@@ -4,6 +4,11 @@
 
 #include "map.h"
 #include "creature.h"
+#include "pathfinder.h"
+#include "thingtype.h"
+#include <framework/core/memorytracker.h>
+#include <framework/core/objectpool.h>
+#include <framework/core/profiler.h>
 #include <algorithm>
 #include <queue>
 #include <unordered_set>
@@ -23,39 +28,246 @@ void Map::init() {
 
 void Map::terminate() {
     clear();
+    closeMinimap();
+}
+
+TileChunk::TileChunk(int chunkX, int chunkY, int z) : m_chunkX(chunkX), m_chunkY(chunkY), m_z(z) {
+    g_memory.allocate(framework::MemoryTag::MapTiles, sizeof(TileChunk));
+}
+
+TileChunk::~TileChunk() {
+    g_memory.release(framework::MemoryTag::MapTiles, sizeof(TileChunk));
+}
+
+void TileChunk::set(int lx, int ly, TilePtr tile) {
+    TilePtr& slot = m_tiles[ly * SIZE + lx];
+    if (slot && !tile) m_count--;
+    else if (!slot && tile) m_count++;
+    slot = std::move(tile);
 }
 
 void Map::clear() {
-    m_tiles.clear();
+    m_chunks.clear();
+    m_tileCount = 0;
+    m_lastChunkKey = ~0ull;
+    m_lastChunk = nullptr;
     m_creatures.clear();
-    m_minimapTiles.clear();
+    m_creatureBuckets.clear();
+    m_knownCreatures.clear();
+    m_lightBuckets.clear();
+    m_lightCount = 0;
+    m_groundChanges.clear();
+    m_groundReset = true;
     m_centralPosition = Position();
 }
 
+TileChunk* Map::findChunk(int x, int y, int z) const {
+    uint64_t key = chunkKey(x, y, z);
+    if (key == m_lastChunkKey) {
+        return m_lastChunk;
+    }
+
+    auto it = m_chunks.find(key);
+    TileChunk* chunk = it != m_chunks.end() ? it->second.get() : nullptr;
+    m_lastChunkKey = key;
+    m_lastChunk = chunk;
+    return chunk;
+}
+
+const TileChunk* Map::getChunk(int x, int y, int z) const {
+    return findChunk(x, y, z);
+}
+
+TileChunk* Map::acquireChunk(int x, int y, int z) {
+    TileChunk* chunk = findChunk(x, y, z);
+    if (!chunk) {
+        auto created = std::make_unique<TileChunk>(x >> TileChunk::SHIFT, y >> TileChunk::SHIFT, z);
+        chunk = created.get();
+        m_chunks.emplace(chunkKey(x, y, z), std::move(created));
+        m_lastChunkKey = chunkKey(x, y, z);
+        m_lastChunk = chunk;
+    }
+    chunk->touch(m_tick);
+    return chunk;
+}
+
+void Map::setTile(const Position& pos, TilePtr tile) {
+    if (!tile && !findChunk(pos.x, pos.y, pos.z)) return;
+    TileChunk* chunk = acquireChunk(pos.x, pos.y, pos.z);
+
+    if (chunk->get(pos.x & TileChunk::MASK, pos.y & TileChunk::MASK)) {
+        removeLights(pos, 0);
+    }
+
+    invalidateGround(pos);
+
+    size_t before = chunk->getTileCount();
+    chunk->set(pos.x & TileChunk::MASK, pos.y & TileChunk::MASK, std::move(tile));
+    m_tileCount += chunk->getTileCount();
+    m_tileCount -= before;
+
+    if (chunk->empty()) {
+        m_chunks.erase(chunkKey(pos.x, pos.y, pos.z));
+        m_lastChunkKey = ~0ull;
+        m_lastChunk = nullptr;
+    }
+}
+
 TilePtr Map::getTile(const Position& pos) {
-    auto it = m_tiles.find(pos);
-    if (it != m_tiles.end()) {
-        return it->second;
+    if (const TileChunk* chunk = findChunk(pos.x, pos.y, pos.z)) {
+        return chunk->get(pos.x & TileChunk::MASK, pos.y & TileChunk::MASK);
     }
     return nullptr;
 }
 
 TilePtr Map::getOrCreateTile(const Position& pos) {
-    auto tile = getTile(pos);
-    if (!tile) {
-        tile = std::make_shared<Tile>(pos);
-        m_tiles[pos] = tile;
+    if (TileChunk* chunk = findChunk(pos.x, pos.y, pos.z)) {
+        chunk->touch(m_tick);
+        if (const TilePtr& tile = chunk->get(pos.x & TileChunk::MASK, pos.y & TileChunk::MASK)) {
+            return tile;
+        }
     }
+
+    auto tile = framework::makePooled<Tile>(pos);
+    setTile(pos, tile);
     return tile;
 }
 
+void Map::commitArea(const MapAreaStage& stage, const Position& from, const Position& to) {
+    m_areaStats.commits++;
+
+    // Staged tiles come floor by floor in columns; group them by chunk so
+    // each chunk is resolved and touched once
+    m_commitOrder.clear();
+    for (uint32_t i = 0; i < stage.tiles.size(); ++i) {
+        m_commitOrder.push_back(i);
+    }
+    std::sort(m_commitOrder.begin(), m_commitOrder.end(), [&](uint32_t a, uint32_t b) {
+        const Position& pa = stage.tiles[a].pos;
+        const Position& pb = stage.tiles[b].pos;
+        uint64_t ka = chunkKey(pa.x, pa.y, pa.z);
+        uint64_t kb = chunkKey(pb.x, pb.y, pb.z);
+        return ka != kb ? ka < kb : a < b;
+    });
+
+    bool changed = false;
+    TileChunk* chunk = nullptr;
+    uint64_t currentKey = ~0ull;
+    for (uint32_t index : m_commitOrder) {
+        const MapAreaStage::StagedTile& staged = stage.tiles[index];
+        const Position& pos = staged.pos;
+        uint64_t key = chunkKey(pos.x, pos.y, pos.z);
+        if (key != currentKey) {
+            chunk = acquireChunk(pos.x, pos.y, pos.z);
+            currentKey = key;
+        }
+
+        int lx = pos.x & TileChunk::MASK;
+        int ly = pos.y & TileChunk::MASK;
+        TilePtr tile = chunk->get(lx, ly);
+        bool created = !tile;
+        if (created) {
+            tile = framework::makePooled<Tile>(pos);
+            chunk->set(lx, ly, tile);
+            m_tileCount++;
+            invalidateGround(pos);
+        }
+
+        size_t reused = 0;
+        bool itemsChanged = tile->describe(stage.things.data() + staged.firstThing, staged.thingCount, reused);
+        bool creaturesChanged = tile->setCreatures(stage.creatures.data() + staged.firstCreature, staged.creatureCount);
+
+        if (itemsChanged) {
+            m_areaStats.itemsReused += reused;
+            m_areaStats.itemsCreated += tile->getThings().size() - reused;
+        }
+        if (created) {
+            m_areaStats.tilesCreated++;
+        } else if (itemsChanged || creaturesChanged) {
+            m_areaStats.tilesUpdated++;
+        } else {
+            m_areaStats.tilesUnchanged++;
+        }
+
+        // A tile described again as it was keeps its minimap entry
+        if (created || itemsChanged) {
+            updateMinimapTile(*tile);
+        }
+        changed = changed || created || itemsChanged || creaturesChanged;
+    }
+
+    if (changed && m_onAreaUpdate) {
+        m_onAreaUpdate(from, to);
+    }
+}
+
 void Map::addTile(TilePtr tile) {
     if (!tile) return;
-    m_tiles[tile->getPosition()] = tile;
+    Position pos = tile->getPosition();
+    setTile(pos, std::move(tile));
 }
 
 void Map::removeTile(const Position& pos) {
-    m_tiles.erase(pos);
+    setTile(pos, nullptr);
+}
+
+void Map::setTileBudget(const TileBudget& budget) {
+    m_tileBudget = budget;
+    evictTiles();
+}
+
+Map::TileStats Map::getTileStats() const {
+    TileStats stats;
+    stats.residentTiles = m_tileCount;
+    stats.residentChunks = m_chunks.size();
+    stats.residentBytes = getResidentBytes();
+    stats.evictedChunks = m_evictedChunks;
+    stats.evictedTiles = m_evictedTiles;
+    return stats;
+}
+
+void Map::evictTiles() {
+    if (m_tileBudget.maxBytes == 0 || getResidentBytes() <= m_tileBudget.maxBytes) return;
+
+    // Only chunks entirely outside the keep distance are candidates
+    int keep = m_tileBudget.keepDistance;
+    m_evictionCandidates.clear();
+    for (const auto& [key, chunk] : m_chunks) {
+        int dx = std::max({chunk->getBaseX() - m_centralPosition.x,
+                           m_centralPosition.x - (chunk->getBaseX() + TileChunk::MASK), 0});
+        int dy = std::max({chunk->getBaseY() - m_centralPosition.y,
+                           m_centralPosition.y - (chunk->getBaseY() + TileChunk::MASK), 0});
+        if (std::max(dx, dy) > keep) {
+            m_evictionCandidates.emplace_back(chunk->getLastUsed(), key);
+        }
+    }
+    std::sort(m_evictionCandidates.begin(), m_evictionCandidates.end());
+
+    for (const auto& [lastUsed, key] : m_evictionCandidates) {
+        if (getResidentBytes() <= m_tileBudget.maxBytes) break;
+
+        auto it = m_chunks.find(key);
+        m_tileCount -= it->second->getTileCount();
+        m_evictedTiles += it->second->getTileCount();
+        m_evictedChunks++;
+        m_chunks.erase(it);
+        removeTileLights(key);
+        m_groundReset = true;
+    }
+
+    m_lastChunkKey = ~0ull;
+    m_lastChunk = nullptr;
+}
+
+void Map::invalidateGround(const Position& pos) {
+    if (m_groundReset) return;
+
+    if (m_groundChanges.size() >= GROUND_CHANGES_MAX) {
+        m_groundChanges.clear();
+        m_groundReset = true;
+        return;
+    }
+    m_groundChanges.push_back(pos);
 }
 
 void Map::cleanTile(const Position& pos) {
@@ -67,193 +279,366 @@ void Map::cleanTile(const Position& pos) {
 
 void Map::addCreature(std::shared_ptr<Creature> creature) {
     if (!creature) return;
-    m_creatures[creature->getCreatureId()] = creature;
+
+    uint32_t id = creature->getCreatureId();
+    auto it = m_creatures.find(id);
+    if (it != m_creatures.end()) {
+        unindexCreature(id, it->second.indexed);
+        if (it->second.lit) removeLights(it->second.indexed, id);
+    }
+
+    const Position& pos = creature->getPosition();
+    m_creatures[id] = CreatureRecord{creature, pos};
+    indexCreature(id, creature, pos);
+    updateCreatureLight(id);
+
+    m_knownCreatures[id] = KnownCreature{creature, ++m_knownTick};
+    if (m_knownCreatures.size() > KNOWN_CREATURES_MAX) {
+        evictKnownCreatures();
+    }
 }
 
 void Map::removeCreature(uint32_t creatureId) {
-    m_creatures.erase(creatureId);
+    m_knownCreatures.erase(creatureId);
+
+    auto it = m_creatures.find(creatureId);
+    if (it == m_creatures.end()) return;
+
+    unindexCreature(creatureId, it->second.indexed);
+    if (it->second.lit) removeLights(it->second.indexed, creatureId);
+    m_creatures.erase(it);
 }
 
 std::shared_ptr<Creature> Map::getCreatureById(uint32_t id) {
     auto it = m_creatures.find(id);
     if (it != m_creatures.end()) {
-        return it->second.lock();
+        return it->second.creature.lock();
     }
     return nullptr;
 }
 
+std::shared_ptr<Creature> Map::reviveCreature(uint32_t id) {
+    auto it = m_knownCreatures.find(id);
+    if (it == m_knownCreatures.end()) {
+        m_knownMisses++;
+        return getCreatureById(id);
+    }
+
+    m_knownHits++;
+    it->second.lastSeen = ++m_knownTick;
+    framework::g_profiler.setGauge(framework::Profiler::GaugeCreatureHitRate,
+                                   static_cast<float>(getKnownCreatureStats().getHitRate() * 100.0));
+    return it->second.creature;
+}
+
+Map::KnownCreatureStats Map::getKnownCreatureStats() const {
+    KnownCreatureStats stats;
+    stats.known = m_knownCreatures.size();
+    stats.hits = m_knownHits;
+    stats.misses = m_knownMisses;
+    stats.evicted = m_knownEvicted;
+    return stats;
+}
+
+void Map::evictKnownCreatures() {
+    // Down to 7/8 of the bound so eviction runs once per batch of new
+    // creatures; creatures on a tile are never dropped
+    size_t target = KNOWN_CREATURES_MAX - KNOWN_CREATURES_MAX / 8;
+    m_knownEvictionCandidates.clear();
+    for (const auto& [id, known] : m_knownCreatures) {
+        if (!known.creature->getTile()) {
+            m_knownEvictionCandidates.emplace_back(known.lastSeen, id);
+        }
+    }
+    std::sort(m_knownEvictionCandidates.begin(), m_knownEvictionCandidates.end());
+
+    for (const auto& [lastSeen, id] : m_knownEvictionCandidates) {
+        if (m_knownCreatures.size() <= target) break;
+        m_knownCreatures.erase(id);
+        m_knownEvicted++;
+    }
+}
+
 std::vector<std::shared_ptr<Creature>> Map::getCreaturesInRange(const Position& pos, int range) {
     std::vector<std::shared_ptr<Creature>> result;
+    getCreaturesInRange(pos, range, result);
+    return result;
+}
 
-    for (auto& [id, weakCreature] : m_creatures) {
-        auto creature = weakCreature.lock();
-        if (creature) {
-            int dx = std::abs(static_cast<int>(creature->getPosition().x) - static_cast<int>(pos.x));
-            int dy = std::abs(static_cast<int>(creature->getPosition().y) - static_cast<int>(pos.y));
+size_t Map::getCreaturesInRange(const Position& pos, int range, std::vector<std::shared_ptr<Creature>>& out) {
+    out.clear();
+    forEachCreatureInRange(pos, range, [&out](const std::shared_ptr<Creature>& creature) {
+        out.push_back(creature);
+    });
+    return out.size();
+}
 
-            if (dx <= range && dy <= range && creature->getPosition().z == pos.z) {
-                result.push_back(creature);
+void Map::updateCreaturePosition(uint32_t creatureId, const Position& pos) {
+    auto it = m_creatures.find(creatureId);
+    if (it == m_creatures.end()) return;
+
+    CreatureRecord& record = it->second;
+    if (record.indexed == pos) return;
+
+    uint64_t oldKey = creatureBucketKey(record.indexed.x, record.indexed.y, record.indexed.z);
+    uint64_t newKey = creatureBucketKey(pos.x, pos.y, pos.z);
+    if (oldKey == newKey) {
+        // Moved within its bucket: just refresh the stored position
+        for (auto& entry : m_creatureBuckets[oldKey]) {
+            if (entry.id == creatureId) {
+                entry.pos = pos;
+                break;
             }
         }
+    } else {
+        unindexCreature(creatureId, record.indexed);
+        indexCreature(creatureId, record.creature, pos);
     }
 
-    return result;
+    if (record.lit) {
+        removeLights(record.indexed, creatureId);
+        if (auto creature = record.creature.lock()) {
+            addLight({pos, creatureId, creature->getLightIntensity(), creature->getLightColor()});
+        } else {
+            record.lit = false;
+        }
+    }
+    record.indexed = pos;
 }
 
-void Map::setCentralPosition(const Position& pos) {
-    Position oldPos = m_centralPosition;
-    m_centralPosition = pos;
+void Map::updateCreatureLight(uint32_t creatureId) {
+    auto it = m_creatures.find(creatureId);
+    if (it == m_creatures.end()) return;
 
-    if (m_onPositionChange && oldPos != pos) {
-        m_onPositionChange(oldPos, pos);
+    CreatureRecord& record = it->second;
+    if (record.lit) {
+        removeLights(record.indexed, creatureId);
+        record.lit = false;
     }
-}
 
-Map::MinimapTile Map::getMinimapTile(const Position& pos) const {
-    auto it = m_minimapTiles.find(pos);
-    if (it != m_minimapTiles.end()) {
-        return it->second;
+    auto creature = record.creature.lock();
+    if (creature && creature->getLightIntensity() > 0) {
+        addLight({record.indexed, creatureId, creature->getLightIntensity(), creature->getLightColor()});
+        record.lit = true;
     }
-    return MinimapTile{};
 }
 
-void Map::setMinimapTile(const Position& pos, const MinimapTile& tile) {
-    m_minimapTiles[pos] = tile;
-}
+void Map::updateTileLights(const Tile& tile) {
+    const Position& pos = tile.getPosition();
+    if (getTile(pos).get() != &tile) return;
 
-void Map::setAmbientLight(uint8_t intensity, uint8_t color) {
-    m_ambientLight.intensity = intensity;
-    m_ambientLight.color = color;
+    removeLights(pos, 0);
+    const ThingStack& things = tile.getThings();
+    for (size_t i = 0; i < things.size(); ++i) {
+        const ThingType* type = things.type(i);
+        if (type && type->getLightIntensity() > 0) {
+            addLight({pos, 0, type->getLightIntensity(), type->getLightColor()});
+        }
+    }
 }
 
-std::vector<Position::Direction> Map::findPath(const Position& start, const Position& end, int maxDistance) {
-    std::vector<Position::Direction> path;
+void Map::addLight(const LightEmitter& light) {
+    m_lightBuckets[lightBucketKey(light.pos.x, light.pos.y, light.pos.z)].push_back(light);
+    m_lightCount++;
+}
 
-    if (start == end) return path;
-    if (start.z != end.z) return path;
+void Map::removeLights(const Position& pos, uint32_t creatureId) {
+    auto it = m_lightBuckets.find(lightBucketKey(pos.x, pos.y, pos.z));
+    if (it == m_lightBuckets.end()) return;
 
-    // A* pathfinding
-    struct Node {
-        Position pos;
-        float g, h, f;
-        Position::Direction fromDir;
-        Position parent;
-    };
+    // Creature emitters are matched by id; item emitters by position
+    auto& lights = it->second;
+    size_t before = lights.size();
+    lights.erase(std::remove_if(lights.begin(), lights.end(), [&](const LightEmitter& light) {
+        return light.creatureId == creatureId && (creatureId != 0 || light.pos == pos);
+    }), lights.end());
+    m_lightCount -= before - lights.size();
 
-    auto heuristic = [](const Position& a, const Position& b) {
-        return static_cast<float>(std::abs(static_cast<int>(a.x) - static_cast<int>(b.x)) +
-                                  std::abs(static_cast<int>(a.y) - static_cast<int>(b.y)));
-    };
+    if (lights.empty()) {
+        m_lightBuckets.erase(it);
+    }
+}
 
-    std::map<Position, Node> openSet;
-    std::map<Position, Node> closedSet;
+void Map::removeTileLights(uint64_t bucketKey) {
+    auto it = m_lightBuckets.find(bucketKey);
+    if (it == m_lightBuckets.end()) return;
 
-    Node startNode;
-    startNode.pos = start;
-    startNode.g = 0;
-    startNode.h = heuristic(start, end);
-    startNode.f = startNode.h;
-    startNode.fromDir = Position::InvalidDirection;
-    startNode.parent = Position::invalid();
+    auto& lights = it->second;
+    size_t before = lights.size();
+    lights.erase(std::remove_if(lights.begin(), lights.end(), [](const LightEmitter& light) {
+        return light.creatureId == 0;
+    }), lights.end());
+    m_lightCount -= before - lights.size();
 
-    openSet[start] = startNode;
+    if (lights.empty()) {
+        m_lightBuckets.erase(it);
+    }
+}
 
-    int iterations = 0;
-    int maxIterations = maxDistance * maxDistance * 4;
+void Map::indexCreature(uint32_t id, const std::weak_ptr<Creature>& creature, const Position& pos) {
+    m_creatureBuckets[creatureBucketKey(pos.x, pos.y, pos.z)].push_back({id, pos, creature});
+}
 
-    while (!openSet.empty() && iterations < maxIterations) {
-        iterations++;
+void Map::unindexCreature(uint32_t id, const Position& pos) {
+    auto it = m_creatureBuckets.find(creatureBucketKey(pos.x, pos.y, pos.z));
+    if (it == m_creatureBuckets.end()) return;
 
-        // Find node with lowest f score
-        auto bestIt = openSet.begin();
-        for (auto it = openSet.begin(); it != openSet.end(); ++it) {
-            if (it->second.f < bestIt->second.f) {
-                bestIt = it;
-            }
+    auto& entries = it->second;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].id == id) {
+            entries[i] = std::move(entries.back());
+            entries.pop_back();
+            break;
         }
+    }
+    if (entries.empty()) {
+        m_creatureBuckets.erase(it);
+    }
+}
 
-        Node current = bestIt->second;
-        openSet.erase(bestIt);
-        closedSet[current.pos] = current;
+void Map::setCentralPosition(const Position& pos) {
+    Position oldPos = m_centralPosition;
+    m_centralPosition = pos;
+    m_tick++;
 
-        // Check if reached goal
-        if (current.pos == end) {
-            // Reconstruct path
-            std::vector<Position::Direction> reversePath;
-            Position pos = end;
+    // Check the tile budget whenever the player enters another tile chunk
+    constexpr int tileChunkMask = ~TileChunk::MASK;
+    if ((oldPos.x & tileChunkMask) != (pos.x & tileChunkMask) ||
+        (oldPos.y & tileChunkMask) != (pos.y & tileChunkMask) || oldPos.z != pos.z) {
+        evictTiles();
+    }
 
-            while (pos != start && pos.isValid()) {
-                auto it = closedSet.find(pos);
-                if (it == closedSet.end()) break;
+    // Page in the minimap chunks around the player when crossing into a new one
+    constexpr int chunkMask = ~MinimapStore::CHUNK_MASK;
+    if ((oldPos.x & chunkMask) != (pos.x & chunkMask) || (oldPos.y & chunkMask) != (pos.y & chunkMask) ||
+        oldPos.z != pos.z) {
+        m_minimap.prefetch(pos.x - MinimapStore::CHUNK_SIZE, pos.y - MinimapStore::CHUNK_SIZE,
+                           pos.x + MinimapStore::CHUNK_SIZE, pos.y + MinimapStore::CHUNK_SIZE, pos.z);
+    }
 
-                if (it->second.fromDir != Position::InvalidDirection) {
-                    reversePath.push_back(it->second.fromDir);
-                }
-                pos = it->second.parent;
-            }
+    if (oldPos.z == pos.z && oldPos != pos && std::abs(pos.x - oldPos.x) <= 1 && std::abs(pos.y - oldPos.y) <= 1) {
+        prefetchAhead(oldPos, pos);
+    }
 
-            // Reverse to get path from start to end
-            path.reserve(reversePath.size());
-            for (auto it = reversePath.rbegin(); it != reversePath.rend(); ++it) {
-                path.push_back(*it);
-            }
+    if (m_onPositionChange && oldPos != pos) {
+        m_onPositionChange(oldPos, pos);
+    }
+}
 
-            return path;
+void Map::prefetchAhead(const Position& from, const Position& to) {
+    int dx = to.x - from.x;
+    int dy = to.y - from.y;
+
+    m_prefetchSprites.clear();
+    auto collect = [this](const TilePtr& tile, int, int) {
+        const ThingStack& things = tile->getThings();
+        for (size_t i = 0; i < things.size(); ++i) {
+            if (const ThingType* type = things.type(i)) {
+                const auto& sprites = type->getSpriteIds();
+                m_prefetchSprites.insert(m_prefetchSprites.end(), sprites.begin(), sprites.end());
+            }
         }
+    };
 
-        // Check neighbors
-        Position::Direction directions[] = {
-            Position::North, Position::East, Position::South, Position::West,
-            Position::NorthEast, Position::SouthEast, Position::SouthWest, Position::NorthWest
-        };
+    // The aware area spans -RANGE..RANGE+1 around the center
+    int top = to.y - MAP_AWARE_RANGE_Y - PREFETCH_DEPTH;
+    int bottom = to.y + MAP_AWARE_RANGE_Y + 1 + PREFETCH_DEPTH;
+    if (dx > 0) {
+        forEachTile(to.x + MAP_AWARE_RANGE_X + 2, top, to.x + MAP_AWARE_RANGE_X + 1 + PREFETCH_DEPTH, bottom, to.z, collect);
+    } else if (dx < 0) {
+        forEachTile(to.x - MAP_AWARE_RANGE_X - PREFETCH_DEPTH, top, to.x - MAP_AWARE_RANGE_X - 1, bottom, to.z, collect);
+    }
+    int left = to.x - MAP_AWARE_RANGE_X;
+    int right = to.x + MAP_AWARE_RANGE_X + 1;
+    if (dy > 0) {
+        forEachTile(left, to.y + MAP_AWARE_RANGE_Y + 2, right, to.y + MAP_AWARE_RANGE_Y + 1 + PREFETCH_DEPTH, to.z, collect);
+    } else if (dy < 0) {
+        forEachTile(left, to.y - MAP_AWARE_RANGE_Y - PREFETCH_DEPTH, right, to.y - MAP_AWARE_RANGE_Y - 1, to.z, collect);
+    }
 
-        for (auto dir : directions) {
-            Position neighbor = current.pos.translated(dir);
+    if (m_prefetchSprites.empty()) return;
+    std::sort(m_prefetchSprites.begin(), m_prefetchSprites.end());
+    m_prefetchSprites.erase(std::unique(m_prefetchSprites.begin(), m_prefetchSprites.end()), m_prefetchSprites.end());
+    ThingTypeManager::instance().prefetchSprites(m_prefetchSprites);
+}
 
-            // Skip if out of range
-            if (std::abs(static_cast<int>(neighbor.x) - static_cast<int>(start.x)) > maxDistance ||
-                std::abs(static_cast<int>(neighbor.y) - static_cast<int>(start.y)) > maxDistance) {
-                continue;
-            }
+Map::MinimapTile Map::getMinimapTile(const Position& pos) const {
+    return m_minimap.get(pos);
+}
 
-            // Skip if already in closed set
-            if (closedSet.find(neighbor) != closedSet.end()) {
-                continue;
-            }
+void Map::setMinimapTile(const Position& pos, const MinimapTile& tile) {
+    if (!m_minimap.set(pos, tile)) return;
+
+    m_minimapRouter.invalidate(pos);
+    if (m_minimapReset) return;
+    if (m_minimapChanges.size() >= MINIMAP_CHANGES_MAX) {
+        m_minimapChanges.clear();
+        m_minimapReset = true;
+        return;
+    }
+    m_minimapChanges.push_back(pos);
+}
 
-            // Check if walkable
-            TilePtr tile = getTile(neighbor);
-            if (!tile || !tile->isPathable()) {
-                // Allow destination even if blocked
-                if (neighbor != end) continue;
-            }
+bool Map::openMinimap(const std::string& path) {
+    // Tiles held in memory are merged into the file's, so every chunk may differ
+    m_minimapChanges.clear();
+    m_minimapReset = true;
+    return m_minimap.open(path);
+}
 
-            // Calculate cost
-            float moveCost = (dir >= Position::NorthEast) ? 1.414f : 1.0f; // Diagonal is more expensive
-            float g = current.g + moveCost;
+void Map::closeMinimap() {
+    m_minimap.close();
+    m_minimapRouter.clear();
+    m_minimapChanges.clear();
+    m_minimapReset = true;
+}
 
-            // Check if neighbor is in open set with better cost
-            auto it = openSet.find(neighbor);
-            if (it != openSet.end() && it->second.g <= g) {
-                continue;
-            }
+void Map::updateMinimapTile(const Tile& tile) {
+    MinimapTile minimap;
+    minimap.flags = MinimapTile::FlagSeen;
+    minimap.speed = tile.getGroundSpeed();
+
+    // Creatures are transient, so only ground and items decide passability
+    bool walkable = tile.getGround() != nullptr;
+    bool pathable = true;
+    const ThingStack& things = tile.getThings();
+    for (size_t i = 0; i < things.size(); ++i) {
+        const ThingType* type = things.type(i);
+        if (!type) continue;
+        if (type->getMinimapColor()) minimap.color = type->getMinimapColor();
+        if (type->blocksSolid()) walkable = false;
+        if (type->blocksPathfind()) pathable = false;
+    }
 
-            // Add/update neighbor
-            Node neighborNode;
-            neighborNode.pos = neighbor;
-            neighborNode.g = g;
-            neighborNode.h = heuristic(neighbor, end);
-            neighborNode.f = g + neighborNode.h;
-            neighborNode.fromDir = dir;
-            neighborNode.parent = current.pos;
+    if (!walkable) minimap.flags |= MinimapTile::FlagNotWalkable;
+    if (!pathable) minimap.flags |= MinimapTile::FlagNotPathable;
+    setMinimapTile(tile.getPosition(), minimap);
+}
 
-            openSet[neighbor] = neighborNode;
-        }
-    }
+void Map::setAmbientLight(uint8_t intensity, uint8_t color) {
+    m_ambientLight.intensity = intensity;
+    m_ambientLight.color = color;
+}
+
+std::vector<Position::Direction> Map::findPath(const Position& start, const Position& end, int maxDistance) {
+    std::vector<Position::Direction> path;
+
+    pathfinding::findPath(start, end, maxDistance, [this](const Position& pos) -> uint32_t {
+        TilePtr tile = getTile(pos);
+        if (!tile || !tile->isPathable()) return 0;
+        int speed = tile->getGroundSpeed();
+        return speed > 0 ? static_cast<uint32_t>(speed) : pathfinding::DEFAULT_STEP_COST;
+    }, path);
 
     return path; // Empty if no path found
 }
 
+std::vector<Position::Direction> Map::findMinimapPath(const Position& start, const Position& end) {
+    std::vector<Position::Direction> path;
+    m_minimapRouter.findRoute(start, end, path);
+    return path; // Empty if no route is known
+}
+
 int Map::getFirstAwareFloor() const {
     if (m_centralPosition.z > MAP_SEA_LEVEL) {
         return std::max(0, static_cast<int>(m_centralPosition.z) - MAP_UNDERGROUND_FLOOR_RANGE);
@@ -8,8 +8,13 @@
 
 #include "tile.h"
 #include "position.h"
+#include "minimaprouter.h"
+#include "minimapstore.h"
+#include <algorithm>
+#include <array>
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 
@@ -26,6 +31,67 @@ constexpr int MAP_UNDERGROUND_FLOOR_RANGE = 2;
 constexpr int MAP_AWARE_RANGE_X = 8;
 constexpr int MAP_AWARE_RANGE_Y = 6;
 
+// Dense 8x8 block of tiles on a single floor. Map keeps these in a hash
+// keyed by chunk coordinates, so a lookup is one hash probe plus an index.
+class TileChunk {
+public:
+    static constexpr int SHIFT = 3;
+    static constexpr int SIZE = 1 << SHIFT;
+    static constexpr int MASK = SIZE - 1;
+
+    TileChunk(int chunkX, int chunkY, int z);
+    ~TileChunk();
+    TileChunk(const TileChunk&) = delete;
+    TileChunk& operator=(const TileChunk&) = delete;
+
+    // Local coordinates, 0..SIZE-1
+    const TilePtr& get(int lx, int ly) const { return m_tiles[ly * SIZE + lx]; }
+    void set(int lx, int ly, TilePtr tile);
+    bool empty() const { return m_count == 0; }
+    size_t getTileCount() const { return m_count; }
+
+    // Map tick of the last write or lookup-for-update, for eviction order
+    uint64_t getLastUsed() const { return m_lastUsed; }
+    void touch(uint64_t tick) { m_lastUsed = tick; }
+
+    // World coordinates of the chunk's top-left tile
+    int getBaseX() const { return m_chunkX << SHIFT; }
+    int getBaseY() const { return m_chunkY << SHIFT; }
+    int getZ() const { return m_z; }
+
+    // Row-major access for callers that walk a whole chunk
+    const std::array<TilePtr, SIZE * SIZE>& getTiles() const { return m_tiles; }
+
+private:
+    std::array<TilePtr, SIZE * SIZE> m_tiles;
+    size_t m_count{0};
+    uint64_t m_lastUsed{0};
+    int m_chunkX, m_chunkY, m_z;
+};
+
+// Tiles of a described area in the order the protocol reads them, so the
+// whole area reaches the map in one commit. Tile entries index runs of
+// things and creatures; the buffers keep their capacity between packets.
+struct MapAreaStage {
+    struct StagedTile {
+        Position pos;
+        uint32_t firstThing{0};
+        uint32_t firstCreature{0};
+        uint16_t thingCount{0};
+        uint16_t creatureCount{0};
+    };
+
+    std::vector<StagedTile> tiles;
+    std::vector<ItemDescription> things;
+    std::vector<CreaturePtr> creatures;
+
+    void clear() {
+        tiles.clear();
+        things.clear();
+        creatures.clear();
+    }
+};
+
 class Map {
 public:
     static Map& instance();
@@ -41,25 +107,127 @@ public:
     void removeTile(const Position& pos);
     void cleanTile(const Position& pos);  // Clear all things from tile
 
-    // Creature tracking
+    // Apply a staged area chunk by chunk. Tiles whose contents did not
+    // change are left alone, changed ones keep their matching items, and
+    // the area callback fires once for the box from..to if anything moved.
+    void commitArea(const MapAreaStage& stage, const Position& from, const Position& to);
+
+    struct AreaStats {
+        uint64_t commits{0};
+        uint64_t tilesUnchanged{0};
+        uint64_t tilesUpdated{0};
+        uint64_t tilesCreated{0};
+        uint64_t itemsReused{0};
+        uint64_t itemsCreated{0};
+    };
+    const AreaStats& getAreaStats() const { return m_areaStats; }
+
+    // Chunk access; nullptr when nothing is known there
+    const TileChunk* getChunk(int x, int y, int z) const;
+
+    // Visit every known tile in [startX..endX] x [startY..endY] on floor z,
+    // row by row (y outer, x inner), resolving each chunk once per row run.
+    // fn(const TilePtr& tile, int x, int y)
+    template<typename Fn>
+    void forEachTile(int startX, int startY, int endX, int endY, int z, Fn&& fn) const;
+
+    // Visit every non-empty chunk
+    template<typename Fn>
+    void forEachChunk(Fn&& fn) const {
+        for (const auto& [key, chunk] : m_chunks) fn(*chunk);
+    }
+
+    // Creature tracking. Added creatures are also known creatures: the map
+    // keeps them alive off-screen, as the server keeps their ids in its
+    // known list, until removeCreature() or the cache outgrows its bound,
+    // so a creature the server sends again by id comes back with its name,
+    // outfit and state.
+    static constexpr size_t KNOWN_CREATURES_MAX = 1300;     // The server's known list
     void addCreature(std::shared_ptr<Creature> creature);
     void removeCreature(uint32_t creatureId);
     std::shared_ptr<Creature> getCreatureById(uint32_t id);
+    // getCreatureById() counted as a known-creature hit or miss
+    std::shared_ptr<Creature> reviveCreature(uint32_t id);
+
+    struct KnownCreatureStats {
+        size_t known{0};
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evicted{0};
+        double getHitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    };
+    KnownCreatureStats getKnownCreatureStats() const;
     std::vector<std::shared_ptr<Creature>> getCreaturesInRange(const Position& pos, int range);
 
-    // Central position (where local player is)
-    const Position& getCentralPosition() const { return m_centralPosition; }
-    void setCentralPosition(const Position& pos);
+    // Allocation-free range queries over the creature grid index. The buffer
+    // overload clears `out` and reuses its capacity; returns the match count.
+    size_t getCreaturesInRange(const Position& pos, int range, std::vector<std::shared_ptr<Creature>>& out);
+    template<typename Fn>
+    void forEachCreatureInRange(const Position& pos, int range, Fn&& fn);
 
-    // Minimap colors
-    struct MinimapTile {
+    // Keeps the creature index in step with movement; called by Creature
+    void updateCreaturePosition(uint32_t creatureId, const Position& pos);
+
+    // Light emitters of tiles and creatures, updated as items are placed,
+    // creatures move and lights change, so a frame only culls them
+    struct LightEmitter {
+        Position pos;
+        uint32_t creatureId{0};     // 0 for item lights
+        uint8_t intensity{0};
         uint8_t color{0};
-        uint8_t flags{0};
-        uint16_t speed{100};
     };
+    void updateTileLights(const Tile& tile);
+    void updateCreatureLight(uint32_t creatureId);
+    // fn(const LightEmitter&) for every emitter in the area on floor z
+    template<typename Fn>
+    void forEachLight(int startX, int startY, int endX, int endY, int z, Fn&& fn) const;
+    size_t getLightCount() const { return m_lightCount; }
+
+    // Positions whose ground or bottom items changed, for the map view's
+    // cached ground layer. Past GROUND_CHANGES_MAX the list collapses into
+    // a reset, as it does on clear() and tile eviction.
+    static constexpr size_t GROUND_CHANGES_MAX = 4096;
+    void invalidateGround(const Position& pos);
+    const std::vector<Position>& getGroundChanges() const { return m_groundChanges; }
+    bool isGroundReset() const { return m_groundReset; }
+    void clearGroundChanges() {
+        m_groundChanges.clear();
+        m_groundReset = false;
+    }
+
+    // Central position (where local player is). A one-step move also
+    // queues decodes for the sprites of known tiles in the PREFETCH_DEPTH
+    // columns or rows just past the aware range, so walking back into an
+    // explored area does not wait on sprites evicted from the atlas.
+    static constexpr int PREFETCH_DEPTH = 3;
+    const Position& getCentralPosition() const { return m_centralPosition; }
+    void setCentralPosition(const Position& pos);
+
+    // Minimap colors, kept in a chunked store that can be file-backed
+    using MinimapTile = client::MinimapTile;
     MinimapTile getMinimapTile(const Position& pos) const;
     void setMinimapTile(const Position& pos, const MinimapTile& tile);
 
+    // Refresh the minimap entry from a tile the server just described
+    void updateMinimapTile(const Tile& tile);
+
+    // Persist the minimap in a memory-mapped file; explored tiles outlive
+    // Map::clear() and the session
+    bool openMinimap(const std::string& path);
+    void closeMinimap();
+    const MinimapStore& getMinimapStore() const { return m_minimap; }
+
+    // Positions whose minimap entry changed, for the minimap view's chunk
+    // textures. Past MINIMAP_CHANGES_MAX the list collapses into a reset,
+    // as it does when the store is opened or closed.
+    static constexpr size_t MINIMAP_CHANGES_MAX = 4096;
+    const std::vector<Position>& getMinimapChanges() const { return m_minimapChanges; }
+    bool isMinimapReset() const { return m_minimapReset; }
+    void clearMinimapChanges() {
+        m_minimapChanges.clear();
+        m_minimapReset = false;
+    }
+
     // Light
     struct LightInfo {
         uint8_t intensity{0};
@@ -73,6 +241,11 @@ public:
     std::vector<Position::Direction> findPath(const Position& start, const Position& end,
                                                int maxDistance = 100);
 
+    // Routes of any length over explored minimap tiles, for targets far
+    // outside the aware range
+    std::vector<Position::Direction> findMinimapPath(const Position& start, const Position& end);
+    const MinimapRouter& getMinimapRouter() const { return m_minimapRouter; }
+
     // Floor visibility
     int getFirstAwareFloor() const;
     int getLastAwareFloor() const;
@@ -89,9 +262,35 @@ public:
     // Callbacks
     using PositionChangeCallback = std::function<void(const Position&, const Position&)>;
     void setOnPositionChange(PositionChangeCallback cb) { m_onPositionChange = cb; }
+    // Box corners of a committed area; floors from.z..to.z
+    using AreaUpdateCallback = std::function<void(const Position& from, const Position& to)>;
+    void setOnAreaUpdate(AreaUpdateCallback cb) { m_onAreaUpdate = cb; }
 
     // Known tiles count
-    size_t getTileCount() const { return m_tiles.size(); }
+    size_t getTileCount() const { return m_tileCount; }
+    size_t getChunkCount() const { return m_chunks.size(); }
+
+    // Tile eviction. Once resident tiles outgrow maxBytes, chunks farther
+    // than keepDistance tiles from the central position are dropped, least
+    // recently used first; their minimap data stays.
+    struct TileBudget {
+        size_t maxBytes{32 * 1024 * 1024};  // 0 keeps every tile
+        int keepDistance{32};
+    };
+    void setTileBudget(const TileBudget& budget);
+    const TileBudget& getTileBudget() const { return m_tileBudget; }
+
+    struct TileStats {
+        size_t residentTiles{0};
+        size_t residentChunks{0};
+        size_t residentBytes{0};    // Chunk and tile objects, not their items
+        uint64_t evictedChunks{0};
+        uint64_t evictedTiles{0};
+    };
+    TileStats getTileStats() const;
+    size_t getResidentBytes() const {
+        return m_chunks.size() * sizeof(TileChunk) + m_tileCount * sizeof(Tile);
+    }
 
 private:
     Map() = default;
@@ -105,24 +304,174 @@ private:
         PathNode* parent;
     };
 
-    // Tiles indexed by position
-    std::map<Position, TilePtr> m_tiles;
+    // Tiles in 8x8 single-floor chunks keyed by packed chunk coordinates
+    static uint64_t chunkKey(int x, int y, int z) {
+        return (static_cast<uint64_t>(z) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(x >> TileChunk::SHIFT)) << 16) |
+               static_cast<uint16_t>(y >> TileChunk::SHIFT);
+    }
+    TileChunk* findChunk(int x, int y, int z) const;
+    TileChunk* acquireChunk(int x, int y, int z);
+    void setTile(const Position& pos, TilePtr tile);
+    void evictTiles();
+    void prefetchAhead(const Position& from, const Position& to);
+
+    std::unordered_map<uint64_t, std::unique_ptr<TileChunk>> m_chunks;
+    size_t m_tileCount{0};
+
+    // Advances with every central position change
+    uint64_t m_tick{0};
+    TileBudget m_tileBudget;
+    uint64_t m_evictedChunks{0};
+    uint64_t m_evictedTiles{0};
+    std::vector<std::pair<uint64_t, uint64_t>> m_evictionCandidates;
+
+    // Consecutive lookups mostly land in the same chunk
+    mutable uint64_t m_lastChunkKey{~0ull};
+    mutable TileChunk* m_lastChunk{nullptr};
+
+    // Creatures indexed by ID, plus a grid of 8x8-tile buckets per floor
+    // holding the same creatures by position
+    struct CreatureRecord {
+        std::weak_ptr<Creature> creature;
+        Position indexed;
+        bool lit{false};
+    };
+    struct CreatureBucketEntry {
+        uint32_t id;
+        Position pos;
+        std::weak_ptr<Creature> creature;
+    };
+    static constexpr int CREATURE_BUCKET_SHIFT = 3;
+    static uint64_t creatureBucketKey(int x, int y, int z) {
+        return (static_cast<uint64_t>(z) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(x >> CREATURE_BUCKET_SHIFT)) << 16) |
+               static_cast<uint16_t>(y >> CREATURE_BUCKET_SHIFT);
+    }
+    void indexCreature(uint32_t id, const std::weak_ptr<Creature>& creature, const Position& pos);
+    void unindexCreature(uint32_t id, const Position& pos);
+
+    std::unordered_map<uint32_t, CreatureRecord> m_creatures;
+    std::unordered_map<uint64_t, std::vector<CreatureBucketEntry>> m_creatureBuckets;
+
+    // Strong references behind the weak ones above, stamped when last sent
+    struct KnownCreature {
+        std::shared_ptr<Creature> creature;
+        uint64_t lastSeen{0};
+    };
+    void evictKnownCreatures();
+
+    std::unordered_map<uint32_t, KnownCreature> m_knownCreatures;
+    std::vector<std::pair<uint64_t, uint32_t>> m_knownEvictionCandidates;
+    uint64_t m_knownTick{0};
+    uint64_t m_knownHits{0};
+    uint64_t m_knownMisses{0};
+    uint64_t m_knownEvicted{0};
+
+    // Light emitters in the same 8x8 buckets as tile chunks
+    static uint64_t lightBucketKey(int x, int y, int z) { return chunkKey(x, y, z); }
+    void addLight(const LightEmitter& light);
+    void removeLights(const Position& pos, uint32_t creatureId);
+    void removeTileLights(uint64_t bucketKey);
 
-    // Creatures indexed by ID
-    std::map<uint32_t, std::weak_ptr<Creature>> m_creatures;
+    std::unordered_map<uint64_t, std::vector<LightEmitter>> m_lightBuckets;
+    size_t m_lightCount{0};
 
-    // Minimap data (simple color/flag storage)
-    std::map<Position, MinimapTile> m_minimapTiles;
+    std::vector<Position> m_groundChanges;
+    bool m_groundReset{true};
+
+    // Minimap data
+    MinimapStore m_minimap;
+    MinimapRouter m_minimapRouter{*this};
+    std::vector<Position> m_minimapChanges;
+    bool m_minimapReset{true};
 
     // Central position
     Position m_centralPosition;
+    std::vector<uint32_t> m_prefetchSprites;
 
     // Ambient light
     LightInfo m_ambientLight;
 
     PositionChangeCallback m_onPositionChange;
+    AreaUpdateCallback m_onAreaUpdate;
+
+    AreaStats m_areaStats;
+    std::vector<uint32_t> m_commitOrder;
 };
 
+template<typename Fn>
+void Map::forEachTile(int startX, int startY, int endX, int endY, int z, Fn&& fn) const {
+    startX = std::max(startX, 0);
+    startY = std::max(startY, 0);
+    endX = std::min(endX, 0xFFFE);
+    endY = std::min(endY, 0xFFFE);
+
+    for (int y = startY; y <= endY; ++y) {
+        int ly = y & TileChunk::MASK;
+        for (int x = startX; x <= endX;) {
+            int runEnd = std::min(endX, x | TileChunk::MASK);
+            if (const TileChunk* chunk = findChunk(x, y, z)) {
+                for (; x <= runEnd; ++x) {
+                    const TilePtr& tile = chunk->get(x & TileChunk::MASK, ly);
+                    if (tile) fn(tile, x, y);
+                }
+            }
+            x = runEnd + 1;
+        }
+    }
+}
+
+template<typename Fn>
+void Map::forEachLight(int startX, int startY, int endX, int endY, int z, Fn&& fn) const {
+    startX = std::max(startX, 0);
+    startY = std::max(startY, 0);
+    endX = std::min(endX, 0xFFFE);
+    endY = std::min(endY, 0xFFFE);
+
+    for (int by = startY >> TileChunk::SHIFT; by <= endY >> TileChunk::SHIFT; ++by) {
+        for (int bx = startX >> TileChunk::SHIFT; bx <= endX >> TileChunk::SHIFT; ++bx) {
+            auto it = m_lightBuckets.find(lightBucketKey(bx << TileChunk::SHIFT, by << TileChunk::SHIFT, z));
+            if (it == m_lightBuckets.end()) continue;
+
+            for (const auto& light : it->second) {
+                if (light.pos.x >= startX && light.pos.x <= endX &&
+                    light.pos.y >= startY && light.pos.y <= endY) {
+                    fn(light);
+                }
+            }
+        }
+    }
+}
+
+template<typename Fn>
+void Map::forEachCreatureInRange(const Position& pos, int range, Fn&& fn) {
+    int minX = std::max(static_cast<int>(pos.x) - range, 0);
+    int minY = std::max(static_cast<int>(pos.y) - range, 0);
+    int maxX = std::min(static_cast<int>(pos.x) + range, 0xFFFE);
+    int maxY = std::min(static_cast<int>(pos.y) + range, 0xFFFE);
+
+    for (int by = minY >> CREATURE_BUCKET_SHIFT; by <= maxY >> CREATURE_BUCKET_SHIFT; ++by) {
+        for (int bx = minX >> CREATURE_BUCKET_SHIFT; bx <= maxX >> CREATURE_BUCKET_SHIFT; ++bx) {
+            auto it = m_creatureBuckets.find(creatureBucketKey(bx << CREATURE_BUCKET_SHIFT,
+                                                               by << CREATURE_BUCKET_SHIFT, pos.z));
+            if (it == m_creatureBuckets.end()) continue;
+
+            for (const auto& entry : it->second) {
+                if (entry.pos.x < minX || entry.pos.x > maxX ||
+                    entry.pos.y < minY || entry.pos.y > maxY) {
+                    continue;
+                }
+                // Known creatures off the map stay alive but are not in range
+                auto creature = entry.creature.lock();
+                if (creature && creature->getTile()) {
+                    fn(creature);
+                }
+            }
+        }
+    }
+}
+
 } // namespace client
 } // namespace shadow
 
@@ -4,16 +4,24 @@
 
 #include "mapview.h"
 #include "map.h"
+#include "minimapview.h"
 #include "tile.h"
 #include "creature.h"
 #include "item.h"
 #include "effect.h"
 #include "missile.h"
+#include "thingtype.h"
 #include "localplayer.h"
 #include "game.h"
+#include <framework/core/profiler.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
+using shadow::framework::g_graphics;
+using shadow::framework::Profiler;
+using shadow::framework::ProfileScope;
+
 namespace shadow {
 namespace client {
 
@@ -52,13 +60,31 @@ MapView& MapView::instance() {
 }
 
 void MapView::init() {
-    // Initialize light texture (used for light blending)
-    // In a full implementation, this would create an FBO for the light map
+    // White disc whose alpha falls off linearly from the center; tinted and
+    // scaled per light source
+    std::vector<uint8_t> pixels(LIGHT_SPRITE_SIZE * LIGHT_SPRITE_SIZE * 4);
+    float half = LIGHT_SPRITE_SIZE / 2.0f;
+    for (int y = 0; y < LIGHT_SPRITE_SIZE; ++y) {
+        for (int x = 0; x < LIGHT_SPRITE_SIZE; ++x) {
+            float dx = (x + 0.5f - half) / half;
+            float dy = (y + 0.5f - half) / half;
+            float attenuation = std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy));
+            uint8_t* pixel = &pixels[(y * LIGHT_SPRITE_SIZE + x) * 4];
+            pixel[0] = pixel[1] = pixel[2] = 255;
+            pixel[3] = static_cast<uint8_t>(attenuation * 255.0f);
+        }
+    }
+    m_lightTexture = g_graphics.createSmoothTexture(LIGHT_SPRITE_SIZE, LIGHT_SPRITE_SIZE, pixels.data());
 }
 
 void MapView::terminate() {
     m_lightSources.clear();
     m_lightTexture = nullptr;
+    m_lightMap = nullptr;
+    m_groundCache = nullptr;
+    m_groundCacheValid = false;
+    m_groundRetry.clear();
+    m_creatureDrawList.clear();
 }
 
 void MapView::setViewport(int width, int height) {
@@ -98,14 +124,15 @@ void MapView::setCameraOffset(float x, float y) {
 }
 
 void MapView::update(float deltaTime) {
-    m_animationTime += deltaTime;
-
     // Update effects and missiles
-    // TODO: g_effects.update(deltaTime);
-    // TODO: g_missiles.update(deltaTime);
+    g_effects.update(deltaTime);
+    g_missiles.update(deltaTime);
 }
 
 void MapView::render() {
+    ThingTypeManager::instance().nextFrame();
+    g_minimapView.update();
+
     // Get center position from map
     const Position& centerPos = g_map.getCentralPosition();
 
@@ -118,59 +145,29 @@ void MapView::render() {
     int endX = centerPos.x + halfWidth;
     int endY = centerPos.y + halfHeight;
 
-    // Clear light sources from previous frame
-    clearLightSources();
-
-    // Collect light sources from visible area
-    for (int z = m_currentFloor; z <= std::min(m_currentFloor + 2, 15); ++z) {
-        for (int x = startX; x <= endX; ++x) {
-            for (int y = startY; y <= endY; ++y) {
-                auto tile = g_map.getTile(Position(x, y, z));
-                if (!tile) continue;
-
-                // Add ground light
-                auto ground = tile->getGround();
-                if (ground && ground->getLightIntensity() > 0) {
-                    LightSource light;
-                    light.pos = tile->getPosition();
-                    light.intensity = ground->getLightIntensity();
-                    light.color = ground->getLightColor();
-                    light.radius = light.intensity / 2.0f;
-                    addLightSource(light);
-                }
-
-                // Add creature lights
-                for (size_t i = 0; i < tile->getCreatureCount(); ++i) {
-                    auto creature = tile->getCreature(i);
-                    if (creature && creature->getLightIntensity() > 0) {
-                        LightSource light;
-                        light.pos = creature->getPosition();
-                        light.intensity = creature->getLightIntensity();
-                        light.color = creature->getLightColor();
-                        light.radius = light.intensity / 2.0f;
-                        addLightSource(light);
-                    }
-                }
-
-                // Add item lights
-                for (size_t i = 0; i < tile->getItemCount(); ++i) {
-                    auto item = tile->getItem(i);
-                    if (item && item->getLightIntensity() > 0) {
-                        LightSource light;
-                        light.pos = tile->getPosition();
-                        light.intensity = item->getLightIntensity();
-                        light.color = item->getLightColor();
-                        light.radius = light.intensity / 2.0f;
-                        addLightSource(light);
-                    }
-                }
-            }
-        }
-    }
-
     // Draw ground layer first
     drawGround(startX, startY, endX, endY);
 
+    // Cull the map's light emitters against the visible floors; lights under
+    // full ground of an upper floor are hidden
+    {
+        ProfileScope scope(Profiler::StageLight);
+        clearLightSources();
+        for (int z = m_currentFloor; z <= std::min(m_currentFloor + 2, 15); ++z) {
+            int dz = z - m_currentFloor;
+            g_map.forEachLight(startX, startY, endX, endY, z, [&](const Map::LightEmitter& emitter) {
+                if (isFloorHidden(emitter.pos.x - dz, emitter.pos.y - dz, z)) return;
+
+                LightSource light;
+                light.pos = emitter.pos;
+                light.intensity = emitter.intensity;
+                light.color = emitter.color;
+                light.radius = light.intensity / 2.0f;
+                addLightSource(light);
+            });
+        }
+    }
+
     // Draw items and things on ground
     drawThings(startX, startY, endX, endY);
 
@@ -184,7 +181,7 @@ void MapView::render() {
     drawEffectsAndMissiles();
 
     // Apply lighting
-    drawLightMap();
+    drawLightMap(startX, startY);
 
     // Debug grid
     if (m_drawGrid) {
@@ -192,158 +189,353 @@ void MapView::render() {
     }
 }
 
-void MapView::drawGround(int startX, int startY, int endX, int endY) {
-    const Position& centerPos = g_map.getCentralPosition();
+// Cell of a world coordinate in the ring-addressed ground cache
+static int ringIndex(int value, int size) {
+    int index = value % size;
+    return index < 0 ? index + size : index;
+}
 
-    // Screen center
-    int screenCenterX = m_viewportWidth / 2;
-    int screenCenterY = m_viewportHeight / 2;
+// Ground and bottom items that never animate, drawn from the ground cache.
+// Other tiles of the current floor draw both layers live, in stack order.
+static bool isStaticGround(const Tile& tile) {
+    const ThingStack& things = tile.getThings();
+    for (size_t i = things.begin(ThingStack::BucketGround); i < things.end(ThingStack::BucketBottom); ++i) {
+        const ThingType* type = things.type(i);
+        if (!type || type->getAnimationPhases() > 1) return false;
+    }
+    return true;
+}
+
+void MapView::drawGround(int startX, int startY, int endX, int endY) {
+    ProfileScope scope(Profiler::StageGround, true);
 
     // Draw multiple floors if underground
-    int floorStart = m_currentFloor;
     int floorEnd = m_currentFloor;
-
     if (m_drawFloorFading && m_currentFloor <= 7) {
         floorEnd = std::min(m_currentFloor + 2, 7);
     }
 
-    for (int z = floorEnd; z >= floorStart; --z) {
-        float alpha = 1.0f;
-        if (z != m_currentFloor) {
-            alpha = m_floorFadeAlpha * (1.0f - (z - m_currentFloor) * 0.3f);
-        }
-
-        for (int y = startY; y <= endY; ++y) {
-            for (int x = startX; x <= endX; ++x) {
-                auto tile = g_map.getTile(Position(x, y, z));
-                if (!tile) continue;
+    if (!updateGroundCache(startX, startY, endX, endY, floorEnd)) {
+        drawGroundTiles(startX, startY, endX, endY, floorEnd);
+        return;
+    }
 
-                auto ground = tile->getGround();
-                if (!ground) continue;
+    const Position& centerPos = g_map.getCentralPosition();
+    int screenCenterX = m_viewportWidth / 2;
+    int screenCenterY = m_viewportHeight / 2;
+    auto toScreenX = [&](int x) {
+        return screenCenterX + static_cast<int>((x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
+    };
+    auto toScreenY = [&](int y) {
+        return screenCenterY + static_cast<int>((y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
+    };
 
-                // Calculate screen position
-                int screenX = screenCenterX + static_cast<int>((x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
-                int screenY = screenCenterY + static_cast<int>((y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
+    // Blit the visible tiles, split where the ring wraps
+    for (int y = startY; y <= endY;) {
+        int rowEnd = std::min(endY, y + m_groundCacheHeight - ringIndex(y, m_groundCacheHeight) - 1);
+        for (int x = startX; x <= endX;) {
+            int colEnd = std::min(endX, x + m_groundCacheWidth - ringIndex(x, m_groundCacheWidth) - 1);
+            framework::Rect src(ringIndex(x, m_groundCacheWidth) * TILE_SIZE, ringIndex(y, m_groundCacheHeight) * TILE_SIZE,
+                                (colEnd - x + 1) * TILE_SIZE, (rowEnd - y + 1) * TILE_SIZE);
+            int left = toScreenX(x);
+            int top = toScreenY(y);
+            g_graphics.drawRenderTarget(m_groundCache.get(), src,
+                                        framework::Rect(left, top, toScreenX(colEnd + 1) - left, toScreenY(rowEnd + 1) - top));
+            x = colEnd + 1;
+        }
+        y = rowEnd + 1;
+    }
 
-                // Floor offset for depth effect
-                if (z != m_currentFloor) {
-                    int offset = (z - m_currentFloor) * static_cast<int>(TILE_SIZE * m_scale);
-                    screenX -= offset;
-                    screenY -= offset;
-                }
+    // Animated ground of the current floor goes over the cache every frame
+    g_map.forEachTile(startX, startY, endX, endY, m_currentFloor, [&](const TilePtr& tile, int x, int y) {
+        if (isStaticGround(*tile)) return;
 
-                renderItem(ground, screenX, screenY, m_scale);
-            }
+        const ThingStack& things = tile->getThings();
+        for (size_t i = things.begin(ThingStack::BucketGround); i < things.end(ThingStack::BucketGround); ++i) {
+            renderItem(things.item(i), toScreenX(x), toScreenY(y), m_scale);
         }
-    }
+    });
 }
 
-void MapView::drawThings(int startX, int startY, int endX, int endY) {
+void MapView::drawGroundTiles(int startX, int startY, int endX, int endY, int floorEnd) {
     const Position& centerPos = g_map.getCentralPosition();
+
+    // Screen center
     int screenCenterX = m_viewportWidth / 2;
     int screenCenterY = m_viewportHeight / 2;
 
-    for (int y = startY; y <= endY; ++y) {
-        for (int x = startX; x <= endX; ++x) {
-            auto tile = g_map.getTile(Position(x, y, m_currentFloor));
-            if (!tile) continue;
+    for (int z = floorEnd; z >= m_currentFloor; --z) {
+        int dz = z - m_currentFloor;
+        g_map.forEachTile(startX, startY, endX, endY, z, [&](const TilePtr& tile, int x, int y) {
+            auto ground = tile->getGround();
+            if (!ground) return;
+            if (dz > 0 && findCoveringFloor(x - dz, y - dz, floorEnd) < z) return;
 
+            // Calculate screen position
             int screenX = screenCenterX + static_cast<int>((x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
             int screenY = screenCenterY + static_cast<int>((y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
 
-            // Draw items (excluding ground and top items)
-            for (size_t i = 0; i < tile->getItemCount(); ++i) {
-                auto item = tile->getItem(i);
-                if (!item) continue;
+            // Floor offset for depth effect
+            if (z != m_currentFloor) {
+                int offset = (z - m_currentFloor) * static_cast<int>(TILE_SIZE * m_scale);
+                screenX -= offset;
+                screenY -= offset;
+            }
+
+            renderItem(ground, screenX, screenY, m_scale);
+        });
+    }
+}
+
+bool MapView::updateGroundCache(int startX, int startY, int endX, int endY, int floorEnd) {
+    int width = endX - startX + 1 + GROUND_CACHE_MARGIN * 2;
+    int height = endY - startY + 1 + GROUND_CACHE_MARGIN * 2;
+    if (!m_groundCache || m_groundCacheWidth != width || m_groundCacheHeight != height) {
+        // Nearest filtering keeps the cache pixel-identical to direct drawing
+        m_groundCache = g_graphics.createRenderTarget(width * TILE_SIZE, height * TILE_SIZE, false);
+        m_groundCacheWidth = width;
+        m_groundCacheHeight = height;
+        m_groundCover.assign(static_cast<size_t>(width) * height, 0);
+        m_groundCacheValid = false;
+        if (!m_groundCache) return false;
+    }
 
-                auto* type = item->getThingType();
-                if (!type) continue;
+    uint32_t generation = ThingTypeManager::instance().getGeneration();
+    if (m_groundFloor != m_currentFloor || m_groundFloorEnd != floorEnd ||
+        m_groundGeneration != generation || g_map.isGroundReset()) {
+        m_groundCacheValid = false;
+    }
 
-                // Skip ground and top items
-                if (type->isGround() || type->hasAttr(ThingAttr::TopOrder1) ||
-                    type->hasAttr(ThingAttr::TopOrder2) || type->hasAttr(ThingAttr::TopOrder3)) {
-                    continue;
-                }
+    int originX = startX - GROUND_CACHE_MARGIN;
+    int originY = startY - GROUND_CACHE_MARGIN;
+    int dx = originX - m_groundOriginX;
+    int dy = originY - m_groundOriginY;
+    const auto& changes = g_map.getGroundChanges();
 
-                renderItem(item, screenX, screenY, m_scale);
-            }
+    // Past a quarter of the window, one full pass beats many small ones
+    if (std::abs(dx) >= width || std::abs(dy) >= height ||
+        changes.size() > static_cast<size_t>(width * height / 4)) {
+        m_groundCacheValid = false;
+    }
+
+    m_groundOriginX = originX;
+    m_groundOriginY = originY;
+    int lastX = originX + width - 1;
+    int lastY = originY + height - 1;
+
+    g_graphics.beginRenderTarget(m_groundCache.get());
+    if (!m_groundCacheValid) {
+        m_groundFloor = m_currentFloor;
+        m_groundFloorEnd = floorEnd;
+        m_groundGeneration = generation;
+        m_groundRetry.clear();
+        m_groundCacheValid = true;
+        renderGroundArea(originX, originY, lastX, lastY);
+    } else {
+        // Columns and rows scrolled into the window
+        if (dx > 0) renderGroundArea(lastX - dx + 1, originY, lastX, lastY);
+        if (dx < 0) renderGroundArea(originX, originY, originX - dx - 1, lastY);
+        if (dy > 0) renderGroundArea(originX, lastY - dy + 1, lastX, lastY);
+        if (dy < 0) renderGroundArea(originX, originY, lastX, originY - dy - 1);
+
+        m_groundRetryScratch.swap(m_groundRetry);
+        m_groundRetry.clear();
+        for (const auto& area : m_groundRetryScratch) {
+            renderGroundArea(area.x, area.y, area.x + area.width - 1, area.y + area.height - 1);
+        }
+
+        for (const Position& pos : changes) {
+            int dz = pos.z - m_currentFloor;
+            if (dz < 0 || pos.z > floorEnd) continue;
+
+            // Lower floors sit one tile up-left per floor, and sprites larger
+            // than a tile reach into the tiles left of and above their own
+            int x = pos.x - dz;
+            int y = pos.y - dz;
+            renderGroundArea(x - 1, y - 1, x, y);
         }
     }
+    g_graphics.endRenderTarget();
+
+    g_map.clearGroundChanges();
+    return true;
 }
 
-void MapView::drawTopThings(int startX, int startY, int endX, int endY) {
+void MapView::renderGroundArea(int x0, int y0, int x1, int y1) {
+    x0 = std::max(x0, m_groundOriginX);
+    y0 = std::max(y0, m_groundOriginY);
+    x1 = std::min(x1, m_groundOriginX + m_groundCacheWidth - 1);
+    y1 = std::min(y1, m_groundOriginY + m_groundCacheHeight - 1);
+
+    // Cover first, so regions drawing sprites that reach into their
+    // neighbours see the whole area's occlusion
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            size_t cell = static_cast<size_t>(ringIndex(y, m_groundCacheHeight)) * m_groundCacheWidth +
+                          ringIndex(x, m_groundCacheWidth);
+            m_groundCover[cell] = static_cast<uint8_t>(findCoveringFloor(x, y, m_groundFloorEnd));
+        }
+    }
+
+    // Regions must not straddle the ring's wrap
+    for (int y = y0; y <= y1;) {
+        int rowEnd = std::min(y1, y + m_groundCacheHeight - ringIndex(y, m_groundCacheHeight) - 1);
+        for (int x = x0; x <= x1;) {
+            int colEnd = std::min(x1, x + m_groundCacheWidth - ringIndex(x, m_groundCacheWidth) - 1);
+            renderGroundRegion(x, y, colEnd, rowEnd);
+            x = colEnd + 1;
+        }
+        y = rowEnd + 1;
+    }
+}
+
+void MapView::renderGroundRegion(int x0, int y0, int x1, int y1) {
+    auto& thingTypes = ThingTypeManager::instance();
+    uint64_t deferred = thingTypes.getDeferredSpriteCount();
+
+    int left = ringIndex(x0, m_groundCacheWidth) * TILE_SIZE;
+    int top = ringIndex(y0, m_groundCacheHeight) * TILE_SIZE;
+    g_graphics.pushClipRect(framework::Rect(left, top, (x1 - x0 + 1) * TILE_SIZE, (y1 - y0 + 1) * TILE_SIZE));
+    g_graphics.clear(framework::Color::transparent());
+
+    for (int z = m_groundFloorEnd; z >= m_currentFloor; --z) {
+        int dz = z - m_currentFloor;
+
+        // One tile past the region on each axis, for sprites reaching back into it
+        g_map.forEachTile(x0 + dz, y0 + dz, x1 + dz + 1, y1 + dz + 1, z, [&](const TilePtr& tile, int x, int y) {
+            if (dz == 0 && !isStaticGround(*tile)) return;
+            if (dz > 0 && isFloorHidden(x - dz, y - dz, z)) return;
+
+            // Bottom items are only drawn for the current floor
+            const ThingStack& things = tile->getThings();
+            size_t end = dz == 0 ? things.end(ThingStack::BucketBottom) : things.end(ThingStack::BucketGround);
+            int screenX = left + (x - dz - x0) * TILE_SIZE;
+            int screenY = top + (y - dz - y0) * TILE_SIZE;
+            for (size_t i = things.begin(ThingStack::BucketGround); i < end; ++i) {
+                renderItem(things.item(i), screenX, screenY, 1.0f);
+            }
+        });
+    }
+    g_graphics.popClipRect();
+
+    if (thingTypes.getDeferredSpriteCount() != deferred) {
+        m_groundRetry.emplace_back(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    }
+}
+
+int MapView::findCoveringFloor(int x, int y, int floorEnd) const {
+    // Floor z's tile under cell (x, y) sits one tile down-right per floor
+    for (int z = m_currentFloor; z < floorEnd; ++z) {
+        int dz = z - m_currentFloor;
+        TilePtr tile = g_map.getTile(Position(x + dz, y + dz, z));
+        if (tile && tile->isFullGround()) return z;
+    }
+    return floorEnd;
+}
+
+bool MapView::isFloorHidden(int x, int y, int z) const {
+    // Only cells inside the cache window have a known cover
+    if (!m_groundCacheValid || x < m_groundOriginX || y < m_groundOriginY ||
+        x >= m_groundOriginX + m_groundCacheWidth || y >= m_groundOriginY + m_groundCacheHeight) {
+        return false;
+    }
+    size_t cell = static_cast<size_t>(ringIndex(y, m_groundCacheHeight)) * m_groundCacheWidth +
+                  ringIndex(x, m_groundCacheWidth);
+    return m_groundCover[cell] < z;
+}
+
+void MapView::drawThings(int startX, int startY, int endX, int endY) {
+    ProfileScope scope(Profiler::StageThings, true);
+
     const Position& centerPos = g_map.getCentralPosition();
     int screenCenterX = m_viewportWidth / 2;
     int screenCenterY = m_viewportHeight / 2;
 
-    for (int y = startY; y <= endY; ++y) {
-        for (int x = startX; x <= endX; ++x) {
-            auto tile = g_map.getTile(Position(x, y, m_currentFloor));
-            if (!tile) continue;
+    g_map.forEachTile(startX, startY, endX, endY, m_currentFloor, [&](const TilePtr& tile, int x, int y) {
+        int screenX = screenCenterX + static_cast<int>((x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
+        int screenY = screenCenterY + static_cast<int>((y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
+
+        // Bottom and common layers; ground and top items have their own
+        // passes, and static bottom items come with the ground cache
+        const ThingStack& things = tile->getThings();
+        size_t first = m_groundCache && isStaticGround(*tile) ? things.begin(ThingStack::BucketCommon)
+                                                               : things.begin(ThingStack::BucketBottom);
+        for (size_t i = first; i < things.end(ThingStack::BucketCommon); ++i) {
+            renderItem(things.item(i), screenX, screenY, m_scale);
+        }
+    });
+}
 
-            int screenX = screenCenterX + static_cast<int>((x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
-            int screenY = screenCenterY + static_cast<int>((y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
+void MapView::drawTopThings(int startX, int startY, int endX, int endY) {
+    ProfileScope scope(Profiler::StageTop, true);
 
-            // Draw top items
-            for (size_t i = 0; i < tile->getItemCount(); ++i) {
-                auto item = tile->getItem(i);
-                if (!item) continue;
+    const Position& centerPos = g_map.getCentralPosition();
+    int screenCenterX = m_viewportWidth / 2;
+    int screenCenterY = m_viewportHeight / 2;
 
-                auto* type = item->getThingType();
-                if (!type) continue;
+    g_map.forEachTile(startX, startY, endX, endY, m_currentFloor, [&](const TilePtr& tile, int x, int y) {
+        int screenX = screenCenterX + static_cast<int>((x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
+        int screenY = screenCenterY + static_cast<int>((y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
 
-                // Only draw top items
-                if (type->hasAttr(ThingAttr::TopOrder1) ||
-                    type->hasAttr(ThingAttr::TopOrder2) ||
-                    type->hasAttr(ThingAttr::TopOrder3)) {
-                    renderItem(item, screenX, screenY, m_scale);
-                }
-            }
+        // Draw top items
+        const ThingStack& things = tile->getThings();
+        for (size_t i = things.begin(ThingStack::BucketTop); i < things.end(ThingStack::BucketTop); ++i) {
+            renderItem(things.item(i), screenX, screenY, m_scale);
         }
-    }
+    });
 }
 
 void MapView::drawCreatures(int startX, int startY, int endX, int endY) {
+    ProfileScope scope(Profiler::StageCreatures, true);
+
     const Position& centerPos = g_map.getCentralPosition();
     int screenCenterX = m_viewportWidth / 2;
     int screenCenterY = m_viewportHeight / 2;
 
-    // Collect creatures and sort by y position for proper overlap
-    std::vector<std::pair<int, std::shared_ptr<Creature>>> creatures;
-
-    for (int y = startY; y <= endY; ++y) {
-        for (int x = startX; x <= endX; ++x) {
-            auto tile = g_map.getTile(Position(x, y, m_currentFloor));
-            if (!tile) continue;
-
-            for (size_t i = 0; i < tile->getCreatureCount(); ++i) {
-                auto creature = tile->getCreature(i);
-                if (creature) {
-                    // Sort key: y * 1000 + x to ensure proper drawing order
-                    int sortKey = y * 10000 + x;
-                    creatures.emplace_back(sortKey, creature);
-                }
+    auto orderStart = std::chrono::steady_clock::now();
+
+    // Collect creatures by y position for proper overlap
+    m_creatureDrawList.clear();
+    g_map.forEachTile(startX, startY, endX, endY, m_currentFloor, [&](const TilePtr& tile, int x, int y) {
+        for (const auto& creature : tile->getCreatures()) {
+            if (creature) {
+                // Sort key: y * 10000 + x to ensure proper drawing order
+                m_creatureDrawList.push_back({y * 10000 + x, creature.get()});
             }
         }
+    });
+
+    // Insertion pass: linear on the nearly sorted list, stable for creatures
+    // sharing a tile
+    uint32_t reordered = 0;
+    for (size_t i = 1; i < m_creatureDrawList.size(); ++i) {
+        CreatureDrawEntry entry = m_creatureDrawList[i];
+        size_t j = i;
+        for (; j > 0 && m_creatureDrawList[j - 1].sortKey > entry.sortKey; --j) {
+            m_creatureDrawList[j] = m_creatureDrawList[j - 1];
+        }
+        if (j != i) {
+            m_creatureDrawList[j] = entry;
+            reordered++;
+        }
     }
 
-    // Sort by y position
-    std::sort(creatures.begin(), creatures.end(),
-        [](const auto& a, const auto& b) { return a.first < b.first; });
+    m_creatureDrawStats.creatures = static_cast<uint32_t>(m_creatureDrawList.size());
+    m_creatureDrawStats.reordered = reordered;
+    m_creatureDrawStats.orderMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - orderStart).count();
 
-    // Draw creatures
-    for (const auto& [sortKey, creature] : creatures) {
-        const Position& pos = creature->getPosition();
+    auto screenPosition = [&](const Creature& creature, int& screenX, int& screenY) {
+        const Position& pos = creature.getPosition();
 
         // Calculate base screen position
-        int screenX = screenCenterX + static_cast<int>((pos.x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
-        int screenY = screenCenterY + static_cast<int>((pos.y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
+        screenX = screenCenterX + static_cast<int>((pos.x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
+        screenY = screenCenterY + static_cast<int>((pos.y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
 
         // Add walk offset for smooth movement
-        if (creature->isWalking()) {
-            float walkOffset = creature->getWalkOffset();
+        if (creature.isWalking()) {
+            float walkOffset = creature.getWalkOffset();
             // Apply walk offset based on direction
-            Position::Direction dir = creature->getDirection();
+            Position::Direction dir = creature.getDirection();
             int offsetX = 0, offsetY = 0;
             switch (dir) {
                 case Position::North: offsetY = static_cast<int>(-walkOffset * TILE_SIZE); break;
@@ -355,57 +547,88 @@ void MapView::drawCreatures(int startX, int startY, int endX, int endY) {
             screenX += static_cast<int>(offsetX * m_scale);
             screenY += static_cast<int>(offsetY * m_scale);
         }
+    };
 
-        renderCreature(creature, screenX, screenY, m_scale);
+    // Sprites of every creature first, so they share instanced draw calls,
+    // then bars and names over all of them
+    int screenX = 0, screenY = 0;
+    for (const auto& entry : m_creatureDrawList) {
+        screenPosition(*entry.creature, screenX, screenY);
+        entry.creature->drawOutfit(screenX, screenY, m_scale);
+    }
+    for (const auto& entry : m_creatureDrawList) {
+        screenPosition(*entry.creature, screenX, screenY);
+        entry.creature->drawInformation(screenX, screenY, m_scale);
     }
 }
 
 void MapView::drawEffectsAndMissiles() {
+    ProfileScope scope(Profiler::StageEffects, true);
+
     const Position& centerPos = g_map.getCentralPosition();
     int screenCenterX = m_viewportWidth / 2;
     int screenCenterY = m_viewportHeight / 2;
-
-    // Draw effects
     int halfWidth = m_visibleWidth / 2;
     int halfHeight = m_visibleHeight / 2;
 
-    for (int y = centerPos.y - halfHeight; y <= centerPos.y + halfHeight; ++y) {
-        for (int x = centerPos.x - halfWidth; x <= centerPos.x + halfWidth; ++x) {
-            Position pos(x, y, m_currentFloor);
+    // World pixel at the screen's top-left corner, as the tile passes place
+    // centerPos at the screen center
+    float viewX = centerPos.x * TILE_SIZE - (screenCenterX - m_cameraOffsetX) / m_scale;
+    float viewY = centerPos.y * TILE_SIZE - (screenCenterY - m_cameraOffsetY) / m_scale;
 
-            int screenX = screenCenterX + static_cast<int>((x - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
-            int screenY = screenCenterY + static_cast<int>((y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
+    // One pass over each pool rather than a lookup per visible tile
+    g_effects.draw(centerPos.x - halfWidth, centerPos.y - halfHeight,
+                   centerPos.x + halfWidth, centerPos.y + halfHeight,
+                   m_currentFloor, viewX, viewY, m_scale);
+    g_missiles.draw(viewX, viewY, m_currentFloor, m_scale);
+}
 
-            // TODO: g_effects.drawEffects(pos, screenX, screenY, m_scale);
-            (void)pos; (void)screenX; (void)screenY;
-        }
+void MapView::drawLightMap(int startX, int startY) {
+    ProfileScope scope(Profiler::StageLight, true);
+
+    // Full daylight with nothing lit leaves the scene as it is
+    if (!m_lightTexture || (m_ambientIntensity == 255 && m_lightSources.empty())) return;
+
+    int mapWidth = m_visibleWidth * LIGHT_MAP_TILE_PIXELS;
+    int mapHeight = m_visibleHeight * LIGHT_MAP_TILE_PIXELS;
+    if (!m_lightMap || m_lightMap->getWidth() != mapWidth || m_lightMap->getHeight() != mapHeight) {
+        m_lightMap = g_graphics.createRenderTarget(mapWidth, mapHeight);
+        if (!m_lightMap) return;
     }
 
-    // Draw missiles
-    // TODO: Implement missile drawing
-    // int viewX = static_cast<int>((centerPos.x - halfWidth) * TILE_SIZE + m_cameraOffsetX);
-    // int viewY = static_cast<int>((centerPos.y - halfHeight) * TILE_SIZE + m_cameraOffsetY);
-    // g_missiles.draw(viewX, viewY, m_scale);
-}
+    LightColor ambient = LightColor::fromIndex(m_ambientColor);
+    float ambientFactor = m_ambientIntensity / 255.0f;
 
-void MapView::drawLightMap() {
-    // Apply ambient light and point light sources
-    // In a full implementation, this would:
-    // 1. Create a light map FBO
-    // 2. For each pixel, calculate the combined light from ambient + point sources
-    // 3. Blend the light map with the scene using multiplicative blending
+    g_graphics.beginRenderTarget(m_lightMap.get());
+    g_graphics.clear(framework::Color(static_cast<uint8_t>(ambient.r * ambientFactor),
+                                      static_cast<uint8_t>(ambient.g * ambientFactor),
+                                      static_cast<uint8_t>(ambient.b * ambientFactor), 255));
 
-    // For now, we'll just set a basic ambient light level
-    // The actual blending would be done in the shader
+    // One additive sprite per source, one pixel block per tile
+    g_graphics.setBlendMode(framework::BlendAdditive);
+    for (const auto& light : m_lightSources) {
+        if (light.radius <= 0.0f) continue;
+
+        LightColor color = LightColor::fromIndex(light.color);
+        int centerX = (light.pos.x - startX) * LIGHT_MAP_TILE_PIXELS + LIGHT_MAP_TILE_PIXELS / 2;
+        int centerY = (light.pos.y - startY) * LIGHT_MAP_TILE_PIXELS + LIGHT_MAP_TILE_PIXELS / 2;
+        int radius = static_cast<int>(light.radius * LIGHT_MAP_TILE_PIXELS);
+        g_graphics.drawTextureColored(m_lightTexture.get(),
+                                      framework::Rect(centerX - radius, centerY - radius, radius * 2, radius * 2),
+                                      framework::Color(color.r, color.g, color.b, 255));
+    }
+    g_graphics.endRenderTarget();
 
-    // Example pseudocode for shader-based lighting:
-    // for each fragment:
-    //   finalColor = sceneColor * ambientLight
-    //   for each light source:
-    //     dist = distance(fragment, lightPos)
-    //     attenuation = 1.0 - (dist / lightRadius)
-    //     if attenuation > 0:
-    //       finalColor += sceneColor * lightColor * lightIntensity * attenuation
+    // Multiply the scene by the light map, stretched over the visible tiles
+    const Position& centerPos = g_map.getCentralPosition();
+    int screenX = m_viewportWidth / 2 + static_cast<int>((startX - centerPos.x) * TILE_SIZE * m_scale - m_cameraOffsetX);
+    int screenY = m_viewportHeight / 2 + static_cast<int>((startY - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
+    int tileSize = static_cast<int>(TILE_SIZE * m_scale);
+
+    g_graphics.setBlendMode(framework::BlendMultiply);
+    g_graphics.drawRenderTarget(m_lightMap.get(),
+                                framework::Rect(screenX, screenY, m_visibleWidth * tileSize, m_visibleHeight * tileSize));
+    g_graphics.setBlendMode(framework::BlendNormal);
 }
 
 void MapView::drawDebugGrid() {
@@ -423,18 +646,10 @@ void MapView::drawDebugGrid() {
 void MapView::renderTile(const std::shared_ptr<Tile>& tile, int x, int y, float scale) {
     if (!tile) return;
 
-    // Draw ground
-    auto ground = tile->getGround();
-    if (ground) {
-        renderItem(ground, x, y, scale);
-    }
-
-    // Draw items
-    for (size_t i = 0; i < tile->getItemCount(); ++i) {
-        auto item = tile->getItem(i);
-        if (item) {
-            renderItem(item, x, y, scale);
-        }
+    // Draw ground and items below creatures
+    const ThingStack& things = tile->getThings();
+    for (size_t i = 0; i < things.end(ThingStack::BucketCommon); ++i) {
+        renderItem(things.item(i), x, y, scale);
     }
 
     // Draw creatures
@@ -444,13 +659,18 @@ void MapView::renderTile(const std::shared_ptr<Tile>& tile, int x, int y, float
             renderCreature(creature, x, y, scale);
         }
     }
+
+    // Draw top items
+    for (size_t i = things.begin(ThingStack::BucketTop); i < things.end(ThingStack::BucketTop); ++i) {
+        renderItem(things.item(i), x, y, scale);
+    }
 }
 
 void MapView::renderCreature(const std::shared_ptr<Creature>& creature, int x, int y, float scale) {
     if (!creature) return;
 
     // Draw creature sprite
-    creature->draw(x, y, scale);
+    creature->drawOutfit(x, y, scale);
 
     // Draw health bar if not at full health
     if (creature->getHealthPercent() < 100) {
@@ -486,17 +706,7 @@ void MapView::renderCreature(const std::shared_ptr<Creature>& creature, int x, i
 void MapView::renderItem(const std::shared_ptr<Item>& item, int x, int y, float scale) {
     if (!item) return;
 
-    // Get animation frame if animated
-    int animPhase = 0;
-    auto* type = item->getThingType();
-    if (type && type->isAnimateAlways()) {
-        float frameDuration = 0.5f;  // seconds per frame
-        int phases = type->getAnimationPhases();
-        if (phases > 1) {
-            animPhase = static_cast<int>(m_animationTime / frameDuration) % phases;
-        }
-    }
-
+    // The phase comes from the shared animation clock
     item->draw(x, y, scale);
 }
 
@@ -534,47 +744,6 @@ void MapView::getScreenFromPosition(const Position& pos, int& screenX, int& scre
     screenY = screenCenterY + static_cast<int>((pos.y - centerPos.y) * TILE_SIZE * m_scale - m_cameraOffsetY);
 }
 
-LightColor MapView::calculateLightAt(int x, int y, int z) const {
-    // Start with ambient light
-    LightColor result = LightColor::fromIndex(m_ambientColor);
-    float ambientFactor = m_ambientIntensity / 255.0f;
-    result.r = static_cast<uint8_t>(result.r * ambientFactor);
-    result.g = static_cast<uint8_t>(result.g * ambientFactor);
-    result.b = static_cast<uint8_t>(result.b * ambientFactor);
-
-    // Add contribution from each light source
-    for (const auto& light : m_lightSources) {
-        if (light.pos.z != z) continue;
-
-        float dx = static_cast<float>(x - light.pos.x);
-        float dy = static_cast<float>(y - light.pos.y);
-        float dist = std::sqrt(dx * dx + dy * dy);
-
-        if (dist <= light.radius) {
-            float attenuation = 1.0f - (dist / light.radius);
-            float intensity = (light.intensity / 255.0f) * attenuation;
-
-            LightColor lightColor = LightColor::fromIndex(light.color);
-            result = blendLight(result, {
-                static_cast<uint8_t>(lightColor.r * intensity),
-                static_cast<uint8_t>(lightColor.g * intensity),
-                static_cast<uint8_t>(lightColor.b * intensity)
-            });
-        }
-    }
-
-    return result;
-}
-
-LightColor MapView::blendLight(const LightColor& a, const LightColor& b) const {
-    // Additive blending, clamped to 255
-    return {
-        static_cast<uint8_t>(std::min(255, a.r + b.r)),
-        static_cast<uint8_t>(std::min(255, a.g + b.g)),
-        static_cast<uint8_t>(std::min(255, a.b + b.b))
-    };
-}
-
 } // namespace client
 } // namespace shadow
 
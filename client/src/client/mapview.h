@@ -94,23 +94,31 @@ public:
     // Update (call each frame)
     void update(float deltaTime);
 
+    // Creature draw ordering of the last frame
+    struct CreatureDrawStats {
+        uint32_t creatures{0};
+        uint32_t reordered{0};      // Entries moved by the insertion pass
+        float orderMs{0.0f};        // Collecting and ordering
+    };
+    const CreatureDrawStats& getCreatureDrawStats() const { return m_creatureDrawStats; }
+
 private:
     MapView() = default;
 
     void drawGround(int startX, int startY, int endX, int endY);
+    void drawGroundTiles(int startX, int startY, int endX, int endY, int floorEnd);
+    bool updateGroundCache(int startX, int startY, int endX, int endY, int floorEnd);
+    void renderGroundArea(int x0, int y0, int x1, int y1);
+    void renderGroundRegion(int x0, int y0, int x1, int y1);
+    int findCoveringFloor(int x, int y, int floorEnd) const;
+    bool isFloorHidden(int x, int y, int z) const;
     void drawThings(int startX, int startY, int endX, int endY);
     void drawTopThings(int startX, int startY, int endX, int endY);
     void drawCreatures(int startX, int startY, int endX, int endY);
     void drawEffectsAndMissiles();
-    void drawLightMap();
+    void drawLightMap(int startX, int startY);
     void drawDebugGrid();
 
-    // Calculate light at a specific position
-    LightColor calculateLightAt(int x, int y, int z) const;
-
-    // Blend two light colors
-    LightColor blendLight(const LightColor& a, const LightColor& b) const;
-
     // Viewport dimensions
     int m_viewportWidth{0};
     int m_viewportHeight{0};
@@ -138,15 +146,50 @@ private:
     float m_cameraOffsetX{0.0f};
     float m_cameraOffsetY{0.0f};
 
-    // Lighting
+    // Ground cache: ground and non-animated bottom items of the visible
+    // floors, rendered once at TILE_SIZE per tile into a target a margin
+    // larger than the view. Tiles map to cells modulo its size, so a scroll
+    // renders only the rows and columns that came into the window; changed
+    // tiles are re-rendered from Map's ground changes.
+    static constexpr int GROUND_CACHE_MARGIN = 1;
+    std::shared_ptr<framework::RenderTarget> m_groundCache;
+    int m_groundCacheWidth{0};      // In tiles
+    int m_groundCacheHeight{0};
+    int m_groundOriginX{0};         // World tile of the window's top-left
+    int m_groundOriginY{0};
+    int m_groundFloor{-1};
+    int m_groundFloorEnd{-1};
+    uint32_t m_groundGeneration{0};
+    bool m_groundCacheValid{false};
+    std::vector<framework::Rect> m_groundRetry;     // Regions drawn with sprites still decoding
+    // Per cell, the topmost visible floor with full ground; floors below it
+    // are occluded there and neither drawn nor lit
+    std::vector<uint8_t> m_groundCover;
+    std::vector<framework::Rect> m_groundRetryScratch;
+
+    // Lighting: sources are splatted additively into a low-resolution light
+    // map, which is then multiplied over the scene in one quad
+    static constexpr int LIGHT_MAP_TILE_PIXELS = 8;
+    static constexpr int LIGHT_SPRITE_SIZE = 64;
     std::vector<LightSource> m_lightSources;
     uint8_t m_ambientIntensity{200};
     uint8_t m_ambientColor{215};
-    std::shared_ptr<framework::Texture> m_lightTexture;
+    std::shared_ptr<framework::Texture> m_lightTexture;     // Radial falloff
+    std::shared_ptr<framework::RenderTarget> m_lightMap;
+
+    // Creatures of the frame in draw order. Rebuilt in place every frame;
+    // tiles are visited in draw order already, so the insertion pass only
+    // moves the few entries whose keys disagree. Raw pointers, valid while
+    // the tiles hold the creatures during the frame.
+    struct CreatureDrawEntry {
+        int sortKey;
+        Creature* creature;
+    };
+    std::vector<CreatureDrawEntry> m_creatureDrawList;
+    CreatureDrawStats m_creatureDrawStats;
 
     // Animation
     bool m_animateAlways{true};
-    float m_animationTime{0.0f};
 
     // Debug rendering
     bool m_drawGrid{false};
@@ -0,0 +1,279 @@
+/**
+ * Shadow OT Client - Market Cache Implementation
+ */
+
+#include "marketcache.h"
+#include "thingtype.h"
+#include <cctype>
+#include <unordered_set>
+
+namespace shadow {
+namespace client {
+
+namespace {
+
+uint16_t categoryOf(uint16_t itemId) {
+    const ThingType* type = ThingTypeManager::instance().getItemType(itemId);
+    return type ? type->getMarketCategory() : 0;
+}
+
+std::string toLower(std::string_view text) {
+    std::string lower(text);
+    for (char& c : lower) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lower;
+}
+
+} // anonymous namespace
+
+void MarketCache::setCategoryOffers(uint16_t category, std::vector<MarketOffer> offers) {
+    Group& group = m_categories[category];
+    std::vector<uint64_t> previous = group.keys;
+    for (uint64_t key : previous) {
+        eraseOffer(key);
+    }
+
+    for (MarketOffer& offer : offers) {
+        offer.category = category;
+        insertOffer(std::move(offer));
+    }
+
+    group.fetched = Clock::now();
+    group.fresh = true;
+}
+
+void MarketCache::upsertOffer(const MarketOffer& offer) {
+    MarketOffer copy = offer;
+    if (copy.category == 0) {
+        copy.category = categoryOf(copy.itemId);
+    }
+    insertOffer(std::move(copy));
+}
+
+void MarketCache::removeOffer(uint32_t timestamp, uint16_t counter) {
+    eraseOffer(MarketOffer::makeKey(timestamp, counter));
+}
+
+void MarketCache::reduceOffer(uint32_t timestamp, uint16_t counter, uint16_t amount) {
+    uint64_t key = MarketOffer::makeKey(timestamp, counter);
+    auto it = m_offers.find(key);
+    if (it == m_offers.end()) return;
+
+    MarketOffer& offer = it->second;
+    if (amount >= offer.amount) {
+        eraseOffer(key);
+        return;
+    }
+    offer.amount = static_cast<uint16_t>(offer.amount - amount);
+    // Amount order changed
+    m_categories[offer.category].invalidateSorts();
+    m_items[offer.itemId].invalidateSorts();
+}
+
+void MarketCache::invalidateCategory(uint16_t category) {
+    auto it = m_categories.find(category);
+    if (it != m_categories.end()) {
+        it->second.fresh = false;
+    }
+}
+
+void MarketCache::invalidateItem(uint16_t itemId) {
+    invalidateCategory(categoryOf(itemId));
+
+    // Offers may have come from a category the item no longer lists
+    auto it = m_items.find(itemId);
+    if (it == m_items.end()) return;
+    for (uint64_t key : it->second.keys) {
+        invalidateCategory(m_offers.at(key).category);
+    }
+}
+
+void MarketCache::clear() {
+    m_offers.clear();
+    m_categories.clear();
+    m_items.clear();
+}
+
+bool MarketCache::isFresh(uint16_t category) {
+    auto it = m_categories.find(category);
+    bool fresh = it != m_categories.end() && it->second.fresh &&
+                 Clock::now() - it->second.fetched < MAX_AGE;
+    if (fresh) {
+        m_stats.hits++;
+    } else {
+        m_stats.misses++;
+    }
+    return fresh;
+}
+
+const MarketOffer* MarketCache::findOffer(uint32_t timestamp, uint16_t counter) const {
+    auto it = m_offers.find(MarketOffer::makeKey(timestamp, counter));
+    return it != m_offers.end() ? &it->second : nullptr;
+}
+
+void MarketCache::insertOffer(MarketOffer offer) {
+    uint64_t key = offer.getKey();
+    eraseOffer(key);
+    uint16_t category = offer.category;
+    uint16_t itemId = offer.itemId;
+    m_offers.insert_or_assign(key, std::move(offer));
+
+    Group& categoryGroup = m_categories[category];
+    categoryGroup.keys.push_back(key);
+    categoryGroup.invalidateSorts();
+
+    Group& itemGroup = m_items[itemId];
+    itemGroup.keys.push_back(key);
+    itemGroup.invalidateSorts();
+}
+
+void MarketCache::eraseOffer(uint64_t key) {
+    auto it = m_offers.find(key);
+    if (it == m_offers.end()) return;
+
+    auto category = m_categories.find(it->second.category);
+    if (category != m_categories.end()) {
+        removeKey(category->second, key);
+    }
+    auto item = m_items.find(it->second.itemId);
+    if (item != m_items.end()) {
+        removeKey(item->second, key);
+        if (item->second.keys.empty()) {
+            m_items.erase(item);
+        }
+    }
+    m_offers.erase(it);
+}
+
+void MarketCache::removeKey(Group& group, uint64_t key) {
+    auto it = std::find(group.keys.begin(), group.keys.end(), key);
+    if (it == group.keys.end()) return;
+
+    *it = group.keys.back();
+    group.keys.pop_back();
+    group.invalidateSorts();
+}
+
+const std::vector<const MarketOffer*>& MarketCache::getSorted(Group& group, MarketSide side, MarketSort sort) {
+    size_t index = static_cast<size_t>(side) * static_cast<size_t>(MarketSort::Count) + static_cast<size_t>(sort);
+    std::vector<const MarketOffer*>& sorted = group.sorted[index];
+    if (group.sortedValid[index]) return sorted;
+
+    sorted.clear();
+    for (uint64_t key : group.keys) {
+        const MarketOffer& offer = m_offers.at(key);
+        if (offer.side == side) {
+            sorted.push_back(&offer);
+        }
+    }
+
+    // Ties fall back to price, then age, so equal keys keep a stable order
+    auto order = [sort](const MarketOffer* a, const MarketOffer* b) {
+        switch (sort) {
+            case MarketSort::Amount:
+                if (a->amount != b->amount) return a->amount < b->amount;
+                break;
+            case MarketSort::Tier:
+                if (a->tier != b->tier) return a->tier < b->tier;
+                break;
+            default:
+                break;
+        }
+        if (a->price != b->price) return a->price < b->price;
+        return a->getKey() < b->getKey();
+    };
+    std::sort(sorted.begin(), sorted.end(), order);
+
+    group.sortedValid[index] = true;
+    m_stats.sortsBuilt++;
+    return sorted;
+}
+
+std::vector<const MarketOffer*> MarketCache::query(const MarketQuery& query) {
+    std::vector<const MarketOffer*> result;
+
+    Group* group = nullptr;
+    if (query.itemId != 0) {
+        auto it = m_items.find(query.itemId);
+        if (it != m_items.end()) group = &it->second;
+    } else {
+        auto it = m_categories.find(query.category);
+        if (it != m_categories.end()) group = &it->second;
+    }
+    if (!group || query.limit == 0) return result;
+
+    const std::vector<const MarketOffer*>& sorted = getSorted(*group, query.side, query.sort);
+    size_t skipped = 0;
+    auto visit = [&](const MarketOffer* offer) {
+        if (offer->tier < query.minTier || offer->tier > query.maxTier) return true;
+        if (offer->price < query.minPrice || offer->price > query.maxPrice) return true;
+        if (skipped < query.offset) {
+            skipped++;
+            return true;
+        }
+        result.push_back(offer);
+        return result.size() < query.limit;
+    };
+
+    if (query.descending) {
+        for (auto it = sorted.rbegin(); it != sorted.rend() && visit(*it); ++it) {}
+    } else {
+        for (auto it = sorted.begin(); it != sorted.end() && visit(*it); ++it) {}
+    }
+    return result;
+}
+
+void MarketCache::buildNameIndex() {
+    auto& things = ThingTypeManager::instance();
+    m_names.clear();
+
+    uint16_t count = things.getItemCount();
+    for (uint16_t id = 0; id < count; ++id) {
+        const ThingType* type = things.getItemType(id);
+        if (!type || type->getMarketName().empty()) continue;
+
+        std::string name = toLower(type->getMarketName());
+        for (size_t i = 0; i < name.size(); ++i) {
+            bool wordStart = i == 0 || name[i - 1] == ' ' || name[i - 1] == '-';
+            if (wordStart && name[i] != ' ') {
+                m_names.push_back(NameEntry{name.substr(i), id});
+            }
+        }
+    }
+
+    std::sort(m_names.begin(), m_names.end(), [](const NameEntry& a, const NameEntry& b) {
+        if (a.suffix != b.suffix) return a.suffix < b.suffix;
+        return a.itemId < b.itemId;
+    });
+
+    m_namesGeneration = things.getGeneration();
+    m_namesBuilt = true;
+}
+
+std::vector<uint16_t> MarketCache::searchItems(std::string_view prefix, size_t limit) {
+    if (!m_namesBuilt || m_namesGeneration != ThingTypeManager::instance().getGeneration()) {
+        buildNameIndex();
+    }
+
+    std::vector<uint16_t> result;
+    std::string lower = toLower(prefix);
+    if (lower.empty() || limit == 0) return result;
+
+    // Matches are contiguous: every suffix that starts with the prefix
+    // sorts right after it
+    auto it = std::lower_bound(m_names.begin(), m_names.end(), lower, [](const NameEntry& entry, const std::string& key) {
+        return entry.suffix < key;
+    });
+
+    std::unordered_set<uint16_t> seen;
+    for (; it != m_names.end() && it->suffix.compare(0, lower.size(), lower) == 0; ++it) {
+        if (!seen.insert(it->itemId).second) continue;
+        result.push_back(it->itemId);
+        if (result.size() >= limit) break;
+    }
+    return result;
+}
+
+} // namespace client
+} // namespace shadow
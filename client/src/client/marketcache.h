@@ -0,0 +1,150 @@
+/**
+ * Shadow OT Client - Market Cache
+ *
+ * Market offers seen this session, indexed by category and by item, so
+ * switching categories, re-sorting and filtering never go back to the
+ * server. Each group keeps its offers sorted per side and sort key, built
+ * on first use and dropped when an offer of the group changes. Item names
+ * are searched through a sorted index of every word of every market name.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace shadow {
+namespace client {
+
+enum class MarketSide : uint8_t {
+    Buy = 0,
+    Sell = 1,
+    Count
+};
+
+enum class MarketSort : uint8_t {
+    Price,
+    Amount,
+    Tier,
+    Count
+};
+
+struct MarketOffer {
+    uint32_t timestamp{0};
+    uint16_t counter{0};
+    MarketSide side{MarketSide::Buy};
+    uint16_t itemId{0};
+    uint16_t category{0};
+    uint8_t tier{0};
+    uint16_t amount{0};
+    uint64_t price{0};              // Per piece
+    std::string holder;             // Empty for anonymous offers
+
+    // Timestamp and counter identify an offer on the server
+    static uint64_t makeKey(uint32_t timestamp, uint16_t counter) {
+        return (static_cast<uint64_t>(timestamp) << 16) | counter;
+    }
+    uint64_t getKey() const { return makeKey(timestamp, counter); }
+};
+
+struct MarketQuery {
+    uint16_t category{0};
+    uint16_t itemId{0};             // Set: this item only, whatever the category
+    MarketSide side{MarketSide::Sell};
+    uint8_t minTier{0};
+    uint8_t maxTier{std::numeric_limits<uint8_t>::max()};
+    uint64_t minPrice{0};
+    uint64_t maxPrice{std::numeric_limits<uint64_t>::max()};
+    MarketSort sort{MarketSort::Price};
+    bool descending{false};
+    size_t offset{0};
+    size_t limit{std::numeric_limits<size_t>::max()};
+};
+
+class MarketCache {
+public:
+    // Browsed categories older than this are fetched again
+    static constexpr std::chrono::seconds MAX_AGE{120};
+
+    struct Stats {
+        uint64_t hits{0};           // Browses served from the cache
+        uint64_t misses{0};
+        uint64_t sortsBuilt{0};
+    };
+
+    // A browse result replaces everything known about the category
+    void setCategoryOffers(uint16_t category, std::vector<MarketOffer> offers);
+
+    // Single offers created, changed or taken
+    void upsertOffer(const MarketOffer& offer);
+    void removeOffer(uint32_t timestamp, uint16_t counter);
+    // Partial fill; the offer goes at zero
+    void reduceOffer(uint32_t timestamp, uint16_t counter, uint16_t amount);
+
+    // Offers stay queryable, but the next browse refetches
+    void invalidateCategory(uint16_t category);
+    void invalidateItem(uint16_t itemId);
+    void clear();
+
+    // Browsed within MAX_AGE and not invalidated since; counts a hit or miss
+    bool isFresh(uint16_t category);
+
+    // Offers matching the query, in its order. Pointers stay valid until
+    // the cache next changes.
+    std::vector<const MarketOffer*> query(const MarketQuery& query);
+    const MarketOffer* findOffer(uint32_t timestamp, uint16_t counter) const;
+    size_t getOfferCount() const { return m_offers.size(); }
+
+    // Items with a market name word starting with prefix, ignoring case,
+    // ordered by the matching word. The index is rebuilt when thing types
+    // are reloaded.
+    std::vector<uint16_t> searchItems(std::string_view prefix, size_t limit = 100);
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t SORTED_LISTS = static_cast<size_t>(MarketSide::Count) * static_cast<size_t>(MarketSort::Count);
+
+    // Offers of one category or one item
+    struct Group {
+        std::vector<uint64_t> keys;
+        std::vector<const MarketOffer*> sorted[SORTED_LISTS];
+        bool sortedValid[SORTED_LISTS]{};
+        Clock::time_point fetched;
+        bool fresh{false};
+
+        void invalidateSorts() { std::fill(std::begin(sortedValid), std::end(sortedValid), false); }
+    };
+
+    struct NameEntry {
+        std::string suffix;         // Lowercase name from one word on
+        uint16_t itemId;
+    };
+
+    void insertOffer(MarketOffer offer);
+    void eraseOffer(uint64_t key);
+    static void removeKey(Group& group, uint64_t key);
+    const std::vector<const MarketOffer*>& getSorted(Group& group, MarketSide side, MarketSort sort);
+    void buildNameIndex();
+
+    std::unordered_map<uint64_t, MarketOffer> m_offers;
+    std::unordered_map<uint16_t, Group> m_categories;
+    std::unordered_map<uint16_t, Group> m_items;
+
+    std::vector<NameEntry> m_names;
+    uint32_t m_namesGeneration{0};
+    bool m_namesBuilt{false};
+
+    Stats m_stats;
+};
+
+} // namespace client
+} // namespace shadow
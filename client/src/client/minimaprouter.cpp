@@ -0,0 +1,278 @@
+/**
+ * Shadow OT Client - Minimap Router Implementation
+ */
+
+#include "minimaprouter.h"
+#include "map.h"
+#include "pathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+
+namespace shadow {
+namespace client {
+
+namespace {
+
+int chebyshev(int ax, int ay, int bx, int by) {
+    return std::max(std::abs(ax - bx), std::abs(ay - by));
+}
+
+} // anonymous namespace
+
+uint32_t MinimapRouter::stepCost(const Position& pos) const {
+    Map::MinimapTile tile = m_map.getMinimapTile(pos);
+    if (!(tile.flags & Map::MinimapTile::FlagSeen)) return 0;
+    if (tile.flags & (Map::MinimapTile::FlagNotWalkable | Map::MinimapTile::FlagNotPathable)) return 0;
+    return tile.speed ? tile.speed : pathfinding::DEFAULT_STEP_COST;
+}
+
+void MinimapRouter::clear() {
+    m_regions.clear();
+}
+
+void MinimapRouter::invalidate(const Position& pos) {
+    m_regions.erase(regionKey(pos.x, pos.y, pos.z));
+
+    // Neighbours hold portals into the old component labels
+    for (int dy = -REGION_SIZE; dy <= REGION_SIZE; dy += REGION_SIZE) {
+        for (int dx = -REGION_SIZE; dx <= REGION_SIZE; dx += REGION_SIZE) {
+            if (dx == 0 && dy == 0) continue;
+            auto it = m_regions.find(regionKey(pos.x + dx, pos.y + dy, pos.z));
+            if (it != m_regions.end()) {
+                it->second.portalsValid = false;
+            }
+        }
+    }
+}
+
+MinimapRouter::Region& MinimapRouter::getRegion(int x, int y, int z) {
+    auto [it, inserted] = m_regions.try_emplace(regionKey(x, y, z));
+    if (inserted) {
+        buildRegion(it->second, x & ~REGION_MASK, y & ~REGION_MASK, z);
+    }
+    return it->second;
+}
+
+void MinimapRouter::buildRegion(Region& region, int baseX, int baseY, int z) {
+    std::array<uint32_t, REGION_SIZE * REGION_SIZE> costs;
+    for (int ly = 0; ly < REGION_SIZE; ++ly) {
+        for (int lx = 0; lx < REGION_SIZE; ++lx) {
+            costs[ly * REGION_SIZE + lx] = stepCost(Position(static_cast<uint16_t>(baseX + lx),
+                                                             static_cast<uint16_t>(baseY + ly),
+                                                             static_cast<uint8_t>(z)));
+        }
+    }
+
+    // Flood fill with the same 8-way moves the tile search uses
+    std::array<uint16_t, REGION_SIZE * REGION_SIZE> stack;
+    for (int start = 0; start < REGION_SIZE * REGION_SIZE; ++start) {
+        if (!costs[start] || region.labels[start] || region.components.size() >= 254) continue;
+
+        uint8_t label = static_cast<uint8_t>(region.components.size() + 1);
+        int64_t sumX = 0, sumY = 0, sumCost = 0, count = 0;
+        size_t top = 0;
+        stack[top++] = static_cast<uint16_t>(start);
+        region.labels[start] = label;
+
+        while (top > 0) {
+            int index = stack[--top];
+            int lx = index & REGION_MASK;
+            int ly = index >> REGION_SHIFT;
+            sumX += lx;
+            sumY += ly;
+            sumCost += costs[index];
+            count++;
+
+            for (int dir = 0; dir < 8; ++dir) {
+                int nx = lx + pathfinding::DIRECTION_DX[dir];
+                int ny = ly + pathfinding::DIRECTION_DY[dir];
+                if (nx < 0 || ny < 0 || nx >= REGION_SIZE || ny >= REGION_SIZE) continue;
+                int next = ny * REGION_SIZE + nx;
+                if (!costs[next] || region.labels[next]) continue;
+                region.labels[next] = label;
+                stack[top++] = static_cast<uint16_t>(next);
+            }
+        }
+
+        Component component;
+        component.centerX = baseX + static_cast<int>(sumX / count);
+        component.centerY = baseY + static_cast<int>(sumY / count);
+        component.cost = static_cast<uint32_t>(sumCost / count);
+        region.components.push_back(component);
+    }
+
+    m_stats.regionsBuilt++;
+}
+
+const std::vector<MinimapRouter::Portal>& MinimapRouter::getPortals(uint64_t key, Region& region) {
+    if (region.portalsValid) {
+        return region.portals;
+    }
+
+    region.portals.clear();
+    const int baseX = static_cast<int>((key >> 16) & 0xFFFF) << REGION_SHIFT;
+    const int baseY = static_cast<int>(key & 0xFFFF) << REGION_SHIFT;
+    const int z = static_cast<int>(key >> 32);
+
+    for (int ly = 0; ly < REGION_SIZE; ++ly) {
+        for (int lx = 0; lx < REGION_SIZE; ++lx) {
+            bool border = lx == 0 || ly == 0 || lx == REGION_MASK || ly == REGION_MASK;
+            uint8_t label = region.labels[ly * REGION_SIZE + lx];
+            if (!border || !label) continue;
+
+            const Component& component = region.components[label - 1];
+            for (int dir = 0; dir < 8; ++dir) {
+                int nx = baseX + lx + pathfinding::DIRECTION_DX[dir];
+                int ny = baseY + ly + pathfinding::DIRECTION_DY[dir];
+                if (nx < 0 || ny < 0 || nx > 0xFFFF || ny > 0xFFFF) continue;
+
+                uint64_t neighborKey = regionKey(nx, ny, z);
+                if (neighborKey == key) continue;
+
+                // getRegion may insert, but unordered_map keeps references stable
+                Region& neighbor = getRegion(nx, ny, z);
+                uint8_t neighborLabel = neighbor.labels[(ny & REGION_MASK) * REGION_SIZE + (nx & REGION_MASK)];
+                if (!neighborLabel) continue;
+
+                Portal portal{static_cast<uint8_t>(label - 1), static_cast<uint8_t>(neighborLabel - 1), neighborKey,
+                              Position(static_cast<uint16_t>(baseX + lx), static_cast<uint16_t>(baseY + ly), static_cast<uint8_t>(z)),
+                              Position(static_cast<uint16_t>(nx), static_cast<uint16_t>(ny), static_cast<uint8_t>(z))};
+
+                // One portal per component pair, the crossing nearest the component's centre
+                auto existing = std::find_if(region.portals.begin(), region.portals.end(), [&](const Portal& p) {
+                    return p.from == portal.from && p.to == portal.to && p.toRegion == portal.toRegion;
+                });
+                if (existing == region.portals.end()) {
+                    region.portals.push_back(portal);
+                } else if (chebyshev(portal.fromPos.x, portal.fromPos.y, component.centerX, component.centerY) <
+                           chebyshev(existing->fromPos.x, existing->fromPos.y, component.centerX, component.centerY)) {
+                    *existing = portal;
+                }
+            }
+        }
+    }
+
+    region.portalsValid = true;
+    return region.portals;
+}
+
+uint8_t MinimapRouter::componentAt(const Position& pos) {
+    Region& region = getRegion(pos.x, pos.y, pos.z);
+    return region.labels[(pos.y & REGION_MASK) * REGION_SIZE + (pos.x & REGION_MASK)];
+}
+
+bool MinimapRouter::findRoute(const Position& start, const Position& goal, std::vector<Position::Direction>& path) {
+    path.clear();
+    if (start == goal || start.z != goal.z) return false;
+    m_stats.routes++;
+
+    auto costAt = [this](const Position& pos) { return stepCost(pos); };
+    constexpr int SEGMENT_DISTANCE = REGION_SIZE * 2;
+
+    uint8_t startLabel = componentAt(start);
+    uint8_t goalLabel = componentAt(goal);
+    if (!startLabel || !goalLabel) {
+        m_stats.failures++;
+        return false;
+    }
+
+    // Component graph nodes: region key in the high bits, component index in the low byte
+    auto nodeId = [](uint64_t region, uint8_t component) { return (region << 8) | component; };
+    const uint64_t startRegion = regionKey(start.x, start.y, start.z);
+    const uint64_t goalRegion = regionKey(goal.x, goal.y, goal.z);
+    const uint64_t startNode = nodeId(startRegion, startLabel - 1);
+    const uint64_t goalNode = nodeId(goalRegion, goalLabel - 1);
+
+    struct Visit {
+        uint64_t g;
+        uint64_t parent;
+        Position entry;       // Portal tile this node was entered through
+        bool closed;
+    };
+    std::unordered_map<uint64_t, Visit> visits;
+    using Entry = std::pair<uint64_t, uint64_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    // Same convention as the tile search: distance scaled by the starting cost
+    const uint32_t heuristicScale = m_regions[startRegion].components[startLabel - 1].cost;
+    auto heuristic = [&](int x, int y) {
+        return static_cast<uint64_t>(chebyshev(x, y, goal.x, goal.y)) * heuristicScale;
+    };
+
+    visits[startNode] = Visit{0, startNode, start, false};
+    open.push({heuristic(start.x, start.y), startNode});
+
+    bool found = false;
+    size_t expansions = 0;
+    while (!open.empty() && expansions < MAX_EXPANSIONS) {
+        uint64_t node = open.top().second;
+        open.pop();
+
+        Visit& visit = visits[node];
+        if (visit.closed) continue;
+        visit.closed = true;
+        expansions++;
+
+        if (node == goalNode) {
+            found = true;
+            break;
+        }
+
+        uint64_t region = node >> 8;
+        uint8_t component = static_cast<uint8_t>(node & 0xFF);
+        const uint64_t g = visit.g;
+        const Position entry = visit.entry;
+        Region& current = m_regions[region];
+        uint32_t currentCost = current.components[component].cost;
+
+        for (const Portal& portal : getPortals(region, current)) {
+            if (portal.from != component) continue;
+
+            uint64_t next = nodeId(portal.toRegion, portal.to);
+            const Component& target = m_regions[portal.toRegion].components[portal.to];
+
+            // Entry tile to the crossing at this component's cost, plus the step across
+            uint64_t stepG = g + static_cast<uint64_t>(chebyshev(entry.x, entry.y, portal.fromPos.x, portal.fromPos.y)) * currentCost
+                               + target.cost;
+
+            auto [it, inserted] = visits.try_emplace(next, Visit{stepG, node, portal.toPos, false});
+            if (!inserted) {
+                if (it->second.closed || it->second.g <= stepG) continue;
+                it->second = Visit{stepG, node, portal.toPos, false};
+            }
+            open.push({stepG + heuristic(portal.toPos.x, portal.toPos.y), next});
+        }
+    }
+    m_stats.expansions += expansions;
+
+    if (!found) {
+        m_stats.failures++;
+        return false;
+    }
+
+    // Portal entries from goal back to start, then refine each hop on tiles
+    std::vector<Position> waypoints;
+    waypoints.push_back(goal);
+    for (uint64_t node = goalNode; node != startNode; node = visits[node].parent) {
+        waypoints.push_back(visits[node].entry);
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+
+    Position from = start;
+    std::vector<Position::Direction> segment;
+    for (const Position& to : waypoints) {
+        if (to == from) continue;
+        if (!pathfinding::findPath(from, to, SEGMENT_DISTANCE, costAt, segment)) {
+            path.clear();
+            m_stats.failures++;
+            return false;
+        }
+        path.insert(path.end(), segment.begin(), segment.end());
+        from = to;
+    }
+    return true;
+}
+
+} // namespace client
+} // namespace shadow
@@ -0,0 +1,94 @@
+/**
+ * Shadow OT Client - Minimap Router
+ *
+ * Long-distance routing over minimap data. The world is cut into 16x16
+ * regions per floor; each region is labelled into connected components,
+ * and neighbouring components are linked by portal tiles. Routes are found
+ * on that component graph, then refined into steps one portal at a time.
+ * Regions are cached and rebuilt only when one of their tiles changes.
+ */
+
+#pragma once
+
+#include "position.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace shadow {
+namespace client {
+
+class Map;
+
+class MinimapRouter {
+public:
+    static constexpr int REGION_SHIFT = 4;
+    static constexpr int REGION_SIZE = 1 << REGION_SHIFT;
+    static constexpr int REGION_MASK = REGION_SIZE - 1;
+
+    // Upper bound on component-graph nodes expanded per route
+    static constexpr size_t MAX_EXPANSIONS = 50000;
+
+    explicit MinimapRouter(const Map& map) : m_map(map) {}
+
+    // Steps from start to goal on one floor; false if the explored minimap
+    // does not connect them
+    bool findRoute(const Position& start, const Position& goal, std::vector<Position::Direction>& path);
+
+    // A minimap tile changed: drop its region and the portals that lead into it
+    void invalidate(const Position& pos);
+    void clear();
+
+    // Cost of stepping onto a tile according to the minimap, 0 if blocked or unseen
+    uint32_t stepCost(const Position& pos) const;
+
+    struct Stats {
+        uint64_t regionsBuilt{0};
+        uint64_t routes{0};
+        uint64_t failures{0};
+        uint64_t expansions{0};
+    };
+    const Stats& getStats() const { return m_stats; }
+    size_t getCachedRegionCount() const { return m_regions.size(); }
+
+private:
+    struct Component {
+        int centerX{0};
+        int centerY{0};
+        uint32_t cost{0};     // Mean step cost of its tiles
+    };
+
+    struct Portal {
+        uint8_t from;         // Component in this region
+        uint8_t to;           // Component in the neighbouring region
+        uint64_t toRegion;
+        Position fromPos;
+        Position toPos;
+    };
+
+    struct Region {
+        std::array<uint8_t, REGION_SIZE * REGION_SIZE> labels{};   // 0 = blocked, else component + 1
+        std::vector<Component> components;
+        std::vector<Portal> portals;
+        bool portalsValid{false};
+    };
+
+    static uint64_t regionKey(int x, int y, int z) {
+        return (static_cast<uint64_t>(z) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(x >> REGION_SHIFT)) << 16) |
+               static_cast<uint16_t>(y >> REGION_SHIFT);
+    }
+
+    Region& getRegion(int x, int y, int z);
+    void buildRegion(Region& region, int baseX, int baseY, int z);
+    const std::vector<Portal>& getPortals(uint64_t key, Region& region);
+    uint8_t componentAt(const Position& pos);
+
+    const Map& m_map;
+    std::unordered_map<uint64_t, Region> m_regions;
+    Stats m_stats;
+};
+
+} // namespace client
+} // namespace shadow
@@ -0,0 +1,250 @@
+/**
+ * Shadow OT Client - Minimap Store Implementation
+ */
+
+#include "minimapstore.h"
+#include <framework/core/memorytracker.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace shadow {
+namespace client {
+
+template<typename T>
+static void writeLE(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+template<typename T>
+static T readLE(const uint8_t* in) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(in[i]) << (i * 8);
+    }
+    return value;
+}
+
+MinimapStore::MinimapStore() = default;
+
+MinimapStore::~MinimapStore() {
+    close();
+}
+
+void MinimapStore::reset() {
+    m_file.close();
+    m_memory.clear();
+    m_memory.shrink_to_fit();
+    m_index.clear();
+    m_lastKey = ~0ull;
+    m_lastSlot = -1;
+    m_dirty = false;
+    reportUsage();
+}
+
+void MinimapStore::reportUsage() const {
+    size_t bytes = m_index.empty() ? 0 : DATA_OFFSET + m_index.size() * CHUNK_BYTES;
+    g_memory.setUsage(framework::MemoryTag::Minimap, bytes);
+}
+
+bool MinimapStore::open(const std::string& path) {
+    // Keep what was explored before the file was opened
+    std::vector<uint8_t> memory;
+    std::unordered_map<uint64_t, uint32_t> memoryIndex;
+    if (!m_file.isOpen()) {
+        memory = std::move(m_memory);
+        memoryIndex = std::move(m_index);
+    }
+    close();
+
+    if (!m_file.open(path, framework::MappedFile::Mode::ReadWrite, DATA_OFFSET)) {
+        m_memory = std::move(memory);
+        m_index = std::move(memoryIndex);
+        reportUsage();
+        return false;
+    }
+
+    uint8_t* header = m_file.data();
+    bool valid = readLE<uint32_t>(header) == MAGIC &&
+                 readLE<uint16_t>(header + 4) == VERSION &&
+                 readLE<uint16_t>(header + 6) == CHUNK_SHIFT;
+
+    if (!valid) {
+        // New file, or an incompatible one: start over
+        std::memset(header, 0, DATA_OFFSET);
+        writeHeader();
+    }
+
+    // Only the directory is read; chunk pages fault in as tiles are used
+    size_t count = std::min<size_t>(readLE<uint32_t>(header + 8), MAX_CHUNKS);
+    count = std::min(count, (m_file.size() - DATA_OFFSET) / CHUNK_BYTES);
+    m_index.reserve(count);
+    for (size_t slot = 0; slot < count; ++slot) {
+        uint64_t key = readLE<uint64_t>(header + HEADER_SIZE + slot * sizeof(uint64_t));
+        m_index.emplace(key, static_cast<uint32_t>(slot));
+    }
+    writeLE<uint32_t>(header + 8, static_cast<uint32_t>(count));
+
+    for (const auto& [key, memorySlot] : memoryIndex) {
+        int64_t slot = findSlot(key);
+        if (slot < 0) slot = allocateSlot(key);
+        if (slot < 0) break;
+
+        const uint8_t* source = memory.data() + DATA_OFFSET + memorySlot * CHUNK_BYTES;
+        uint8_t* target = base() + DATA_OFFSET + slot * CHUNK_BYTES;
+        for (size_t offset = 0; offset < CHUNK_BYTES; offset += TILE_BYTES) {
+            if (readLE<uint32_t>(source + offset) != 0) {
+                std::memcpy(target + offset, source + offset, TILE_BYTES);
+            }
+        }
+        m_dirty = true;
+    }
+
+    reportUsage();
+
+    m_flushRunning = true;
+    m_flushThread = std::thread(&MinimapStore::flushLoop, this);
+    return true;
+}
+
+void MinimapStore::close() {
+    if (m_flushThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_flushRunning = false;
+        }
+        m_flushCondition.notify_all();
+        m_flushThread.join();
+    }
+
+    // MappedFile::close syncs what is still dirty
+    reset();
+}
+
+void MinimapStore::writeHeader() {
+    uint8_t* header = m_file.data();
+    writeLE<uint32_t>(header, MAGIC);
+    writeLE<uint16_t>(header + 4, VERSION);
+    writeLE<uint16_t>(header + 6, CHUNK_SHIFT);
+    writeLE<uint32_t>(header + 8, static_cast<uint32_t>(m_index.size()));
+}
+
+bool MinimapStore::reserve(size_t bytes) {
+    if (bytes <= capacity()) return true;
+
+    // Grow by at least half again, in whole chunks, to keep remaps rare
+    size_t chunks = (capacity() > DATA_OFFSET ? capacity() - DATA_OFFSET : 0) / CHUNK_BYTES;
+    size_t needed = (bytes - DATA_OFFSET + CHUNK_BYTES - 1) / CHUNK_BYTES;
+    size_t grown = DATA_OFFSET + std::max({needed, chunks + chunks / 2, size_t(64)}) * CHUNK_BYTES;
+
+    if (!m_file.isOpen()) {
+        m_memory.resize(grown, 0);
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_file.resize(grown);
+}
+
+int64_t MinimapStore::findSlot(uint64_t key) const {
+    if (key == m_lastKey) return m_lastSlot;
+
+    auto it = m_index.find(key);
+    int64_t slot = it != m_index.end() ? static_cast<int64_t>(it->second) : -1;
+    m_lastKey = key;
+    m_lastSlot = slot;
+    return slot;
+}
+
+int64_t MinimapStore::allocateSlot(uint64_t key) {
+    size_t slot = m_index.size();
+    if (slot >= MAX_CHUNKS || !reserve(DATA_OFFSET + (slot + 1) * CHUNK_BYTES)) {
+        return -1;
+    }
+
+    // Fresh slots read as zero: new files are sparse and memory is zero-filled
+    writeLE<uint64_t>(base() + HEADER_SIZE + slot * sizeof(uint64_t), key);
+    writeLE<uint32_t>(base() + 8, static_cast<uint32_t>(slot + 1));
+    m_index.emplace(key, static_cast<uint32_t>(slot));
+    m_lastKey = key;
+    m_lastSlot = static_cast<int64_t>(slot);
+    reportUsage();
+    return m_lastSlot;
+}
+
+MinimapTile MinimapStore::get(const Position& pos) const {
+    int64_t slot = findSlot(chunkKey(pos.x, pos.y, pos.z));
+    if (slot < 0) return MinimapTile{};
+
+    const uint8_t* entry = base() + tileOffset(static_cast<uint32_t>(slot), pos.x, pos.y);
+    if (readLE<uint32_t>(entry) == 0) return MinimapTile{};
+
+    MinimapTile tile;
+    tile.color = entry[0];
+    tile.flags = entry[1];
+    tile.speed = readLE<uint16_t>(entry + 2);
+    return tile;
+}
+
+bool MinimapStore::set(const Position& pos, const MinimapTile& tile) {
+    uint64_t key = chunkKey(pos.x, pos.y, pos.z);
+    int64_t slot = findSlot(key);
+    if (slot < 0) {
+        if (tile == MinimapTile{}) return false;
+        slot = allocateSlot(key);
+        if (slot < 0) {
+            m_dropped++;
+            return false;
+        }
+    }
+
+    uint8_t* entry = base() + tileOffset(static_cast<uint32_t>(slot), pos.x, pos.y);
+    uint8_t packed[TILE_BYTES] = {tile.color, tile.flags, 0, 0};
+    writeLE<uint16_t>(packed + 2, tile.speed);
+
+    if (tile == MinimapTile{}) {
+        std::memset(packed, 0, TILE_BYTES);
+    }
+    if (std::memcmp(entry, packed, TILE_BYTES) == 0) {
+        return false;
+    }
+
+    std::memcpy(entry, packed, TILE_BYTES);
+    m_dirty.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void MinimapStore::flush(bool async) {
+    if (!m_file.isOpen()) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dirty = false;
+    m_file.flush(async);
+}
+
+void MinimapStore::prefetch(int startX, int startY, int endX, int endY, int z) const {
+    if (!m_file.isOpen()) return;
+
+    for (int y = startY & ~CHUNK_MASK; y <= endY; y += CHUNK_SIZE) {
+        for (int x = startX & ~CHUNK_MASK; x <= endX; x += CHUNK_SIZE) {
+            int64_t slot = findSlot(chunkKey(x, y, z));
+            if (slot >= 0) {
+                m_file.prefetch(DATA_OFFSET + static_cast<size_t>(slot) * CHUNK_BYTES, CHUNK_BYTES);
+            }
+        }
+    }
+}
+
+void MinimapStore::flushLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_flushRunning) {
+        m_flushCondition.wait_for(lock, std::chrono::seconds(FLUSH_INTERVAL));
+        if (m_flushRunning && m_dirty.exchange(false)) {
+            m_file.flush(true);
+        }
+    }
+}
+
+} // namespace client
+} // namespace shadow
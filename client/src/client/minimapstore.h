@@ -0,0 +1,129 @@
+/**
+ * Shadow OT Client - Minimap Store
+ *
+ * Explored minimap tiles in 64x64 chunks of 4-byte entries, kept in a
+ * memory-mapped file so they survive restarts and page in on demand.
+ * Opening reads only the chunk directory; tile reads and writes go
+ * straight to the mapping, and a background thread flushes dirty pages.
+ * Without a file the same layout lives in memory.
+ *
+ * File layout (little-endian):
+ *   header:    "SOMM" magic, u16 version, u16 chunk shift, u32 chunk count, reserved to 64 bytes
+ *   directory: MAX_CHUNKS u64 chunk keys, in allocation order
+ *   data:      chunk slots of CHUNK_BYTES each, from DATA_OFFSET
+ */
+
+#pragma once
+
+#include "position.h"
+#include <framework/core/mappedfile.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace shadow {
+namespace client {
+
+struct MinimapTile {
+    static constexpr uint8_t FlagSeen = 1 << 0;
+    static constexpr uint8_t FlagNotPathable = 1 << 1;
+    static constexpr uint8_t FlagNotWalkable = 1 << 2;
+
+    uint8_t color{0};
+    uint8_t flags{0};
+    uint16_t speed{100};
+
+    bool operator==(const MinimapTile& other) const {
+        return color == other.color && flags == other.flags && speed == other.speed;
+    }
+};
+
+class MinimapStore {
+public:
+    static constexpr uint32_t MAGIC = 0x4D4D4F53; // "SOMM"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr int CHUNK_SHIFT = 6;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr size_t TILE_BYTES = 4;
+    static constexpr size_t CHUNK_BYTES = CHUNK_SIZE * CHUNK_SIZE * TILE_BYTES;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t MAX_CHUNKS = 65536;
+    static constexpr size_t DATA_OFFSET =
+        (HEADER_SIZE + MAX_CHUNKS * sizeof(uint64_t) + CHUNK_BYTES - 1) / CHUNK_BYTES * CHUNK_BYTES;
+
+    // Seconds between background flushes of a dirty store
+    static constexpr int FLUSH_INTERVAL = 5;
+
+    MinimapStore();
+    ~MinimapStore();
+    MinimapStore(const MinimapStore&) = delete;
+    MinimapStore& operator=(const MinimapStore&) = delete;
+
+    // Switch to a file-backed store; tiles already held in memory are
+    // merged into it. Returns false (and stays in memory) on I/O errors.
+    bool open(const std::string& path);
+    // Flush and return to an empty in-memory store
+    void close();
+    bool isPersistent() const { return m_file.isOpen(); }
+
+    MinimapTile get(const Position& pos) const;
+    // Returns false if the tile already held this value or the store is full
+    bool set(const Position& pos, const MinimapTile& tile);
+
+    void flush(bool async = true);
+
+    // Page in the chunks covering an area ahead of use
+    void prefetch(int startX, int startY, int endX, int endY, int z) const;
+
+    // Whether any tile of the chunk holding (x, y, z) was ever written
+    bool hasChunk(int x, int y, int z) const { return findSlot(chunkKey(x, y, z)) >= 0; }
+    size_t getChunkCount() const { return m_index.size(); }
+    uint64_t getDroppedWrites() const { return m_dropped; }
+
+private:
+    static uint64_t chunkKey(int x, int y, int z) {
+        return (static_cast<uint64_t>(z) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(x >> CHUNK_SHIFT)) << 16) |
+               static_cast<uint16_t>(y >> CHUNK_SHIFT);
+    }
+    static size_t tileOffset(uint32_t slot, int x, int y) {
+        return DATA_OFFSET + slot * CHUNK_BYTES + (((y & CHUNK_MASK) << CHUNK_SHIFT) | (x & CHUNK_MASK)) * TILE_BYTES;
+    }
+
+    uint8_t* base() { return m_file.isOpen() ? m_file.data() : m_memory.data(); }
+    const uint8_t* base() const { return m_file.isOpen() ? m_file.data() : m_memory.data(); }
+    size_t capacity() const { return m_file.isOpen() ? m_file.size() : m_memory.size(); }
+
+    void reset();
+    // Explored chunks, which is what stays resident of a mapped file too
+    void reportUsage() const;
+    bool reserve(size_t bytes);
+    int64_t findSlot(uint64_t key) const;
+    int64_t allocateSlot(uint64_t key);
+    void writeHeader();
+    void flushLoop();
+
+    framework::MappedFile m_file;
+    std::vector<uint8_t> m_memory;
+
+    std::unordered_map<uint64_t, uint32_t> m_index;
+    mutable uint64_t m_lastKey{~0ull};
+    mutable int64_t m_lastSlot{-1};
+    uint64_t m_dropped{0};
+
+    // Guards the mapping against remaps while the flusher syncs it
+    std::mutex m_mutex;
+    std::condition_variable m_flushCondition;
+    std::thread m_flushThread;
+    bool m_flushRunning{false};
+    std::atomic<bool> m_dirty{false};
+};
+
+} // namespace client
+} // namespace shadow
@@ -0,0 +1,242 @@
+/**
+ * Shadow OT Client - Minimap View Implementation
+ */
+
+#include "minimapview.h"
+#include "map.h"
+#include <framework/ui/uiwidget.h>
+#include <algorithm>
+#include <cmath>
+
+namespace shadow {
+namespace client {
+
+using framework::g_graphics;
+
+MinimapView& MinimapView::instance() {
+    static MinimapView instance;
+    return instance;
+}
+
+framework::Color MinimapView::getColor(uint8_t color) {
+    if (color >= 216) return framework::Color::black();
+    return framework::Color(static_cast<uint8_t>(color / 36 % 6 * 51),
+                            static_cast<uint8_t>(color / 6 % 6 * 51),
+                            static_cast<uint8_t>(color % 6 * 51));
+}
+
+void MinimapView::terminate() {
+    m_atlas.reset();
+    m_dirty.clear();
+    m_empty.clear();
+    m_pending.clear();
+    m_widgets.clear();
+    m_pixels.clear();
+    m_pixels.shrink_to_fit();
+}
+
+void MinimapView::reset() {
+    if (m_atlas) m_atlas->clear();
+    m_dirty.clear();
+    m_empty.clear();
+}
+
+void MinimapView::setMemoryBudget(size_t bytes) {
+    m_memoryBudget = bytes;
+    if (m_atlas) m_atlas->setMemoryBudget(bytes);
+}
+
+bool MinimapView::ensureAtlas() {
+    if (!m_atlas) {
+        m_atlas = std::make_unique<framework::TextureAtlas>(PAGE_SIZE, m_memoryBudget);
+    }
+    return true;
+}
+
+void MinimapView::addWidget(framework::UIWidget* widget) {
+    if (std::find(m_widgets.begin(), m_widgets.end(), widget) == m_widgets.end()) {
+        m_widgets.push_back(widget);
+    }
+}
+
+void MinimapView::removeWidget(framework::UIWidget* widget) {
+    m_widgets.erase(std::remove(m_widgets.begin(), m_widgets.end(), widget), m_widgets.end());
+}
+
+void MinimapView::update() {
+    m_loadsLeft = CHUNK_LOADS_PER_FRAME;
+
+    bool changed = g_map.isMinimapReset() || !g_map.getMinimapChanges().empty();
+    if (g_map.isMinimapReset()) {
+        reset();
+    } else {
+        for (const Position& pos : g_map.getMinimapChanges()) {
+            markDirty(pos);
+        }
+    }
+    g_map.clearMinimapChanges();
+
+    flushDirty();
+    if (m_atlas) m_atlas->nextFrame();
+
+    if (changed || m_loadsPending) {
+        for (framework::UIWidget* widget : m_widgets) {
+            widget->invalidate();
+        }
+    }
+    m_loadsPending = false;
+}
+
+void MinimapView::markDirty(const Position& pos) {
+    uint64_t key = chunkKey(pos.x >> MinimapStore::CHUNK_SHIFT, pos.y >> MinimapStore::CHUNK_SHIFT, pos.z);
+    // A first tile in an empty chunk makes it worth loading
+    m_empty.erase(key);
+
+    int x = pos.x & MinimapStore::CHUNK_MASK;
+    int y = pos.y & MinimapStore::CHUNK_MASK;
+    auto [it, inserted] = m_dirty.try_emplace(key, DirtyArea{x, y, x, y});
+    if (!inserted) {
+        DirtyArea& area = it->second;
+        area.minX = std::min(area.minX, x);
+        area.minY = std::min(area.minY, y);
+        area.maxX = std::max(area.maxX, x);
+        area.maxY = std::max(area.maxY, y);
+    }
+}
+
+void MinimapView::flushDirty() {
+    if (!m_atlas) {
+        m_dirty.clear();
+        return;
+    }
+
+    // Chunks not resident pick the changes up when they load
+    for (const auto& [key, area] : m_dirty) {
+        const framework::AtlasRegion* region = m_atlas->find(key);
+        if (!region) continue;
+
+        int chunkX = static_cast<uint16_t>(key >> 16);
+        int chunkY = static_cast<uint16_t>(key);
+        int z = static_cast<int>(key >> 32);
+        fillPixels(chunkX, chunkY, z, area.minX, area.minY, area.maxX + 1, area.maxY + 1);
+
+        framework::Rect rect(region->rect.x + area.minX, region->rect.y + area.minY,
+                             area.maxX - area.minX + 1, area.maxY - area.minY + 1);
+        g_graphics.updateTexture(region->page, rect, m_pixels.data());
+        m_stats.subUploads++;
+        m_stats.tilesUploaded += static_cast<uint64_t>(rect.width) * rect.height;
+    }
+    m_dirty.clear();
+}
+
+void MinimapView::fillPixels(int chunkX, int chunkY, int z, int x0, int y0, int x1, int y1) {
+    const MinimapStore& store = g_map.getMinimapStore();
+    m_pixels.resize(static_cast<size_t>(x1 - x0) * (y1 - y0) * 4);
+
+    uint8_t* out = m_pixels.data();
+    int baseX = chunkX << MinimapStore::CHUNK_SHIFT;
+    int baseY = chunkY << MinimapStore::CHUNK_SHIFT;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            Position pos(static_cast<uint16_t>(baseX + x), static_cast<uint16_t>(baseY + y), static_cast<uint8_t>(z));
+            MinimapTile tile = store.get(pos);
+            if (tile.flags & MinimapTile::FlagSeen) {
+                framework::Color color = getColor(tile.color);
+                out[0] = color.r;
+                out[1] = color.g;
+                out[2] = color.b;
+                out[3] = 255;
+            } else {
+                // Unexplored tiles let the background through
+                out[0] = out[1] = out[2] = out[3] = 0;
+            }
+            out += 4;
+        }
+    }
+}
+
+const framework::AtlasRegion* MinimapView::loadChunk(int chunkX, int chunkY, int z) {
+    uint64_t key = chunkKey(chunkX, chunkY, z);
+    const MinimapStore& store = g_map.getMinimapStore();
+    if (!store.hasChunk(chunkX << MinimapStore::CHUNK_SHIFT, chunkY << MinimapStore::CHUNK_SHIFT, z)) {
+        m_empty.insert(key);
+        return nullptr;
+    }
+
+    fillPixels(chunkX, chunkY, z, 0, 0, CHUNK_SIZE, CHUNK_SIZE);
+    const framework::AtlasRegion* region = m_atlas->add(key, CHUNK_SIZE, CHUNK_SIZE, m_pixels.data());
+    if (region) {
+        // The upload already holds the pending changes
+        m_dirty.erase(key);
+        m_loadsLeft--;
+        m_stats.chunkLoads++;
+    }
+    return region;
+}
+
+void MinimapView::draw(const framework::Rect& area, float centerX, float centerY, int z, float zoom) {
+    if (area.width <= 0 || area.height <= 0 || !ensureAtlas()) return;
+    zoom = std::clamp(zoom, MIN_ZOOM, MAX_ZOOM);
+
+    // World tile coordinate at the area's top-left corner; the center
+    // tile's middle lands on the area's middle
+    double originX = centerX + 0.5 - area.width / 2.0 / zoom;
+    double originY = centerY + 0.5 - area.height / 2.0 / zoom;
+    auto toScreenX = [&](int tileX) { return area.x + static_cast<int>(std::lround((tileX - originX) * zoom)); };
+    auto toScreenY = [&](int tileY) { return area.y + static_cast<int>(std::lround((tileY - originY) * zoom)); };
+
+    constexpr int maxChunk = 0xFFFF >> MinimapStore::CHUNK_SHIFT;
+    int firstX = std::clamp(static_cast<int>(std::floor(originX)) >> MinimapStore::CHUNK_SHIFT, 0, maxChunk);
+    int firstY = std::clamp(static_cast<int>(std::floor(originY)) >> MinimapStore::CHUNK_SHIFT, 0, maxChunk);
+    int lastX = std::clamp(static_cast<int>(std::floor(originX + area.width / zoom)) >> MinimapStore::CHUNK_SHIFT, 0, maxChunk);
+    int lastY = std::clamp(static_cast<int>(std::floor(originY + area.height / zoom)) >> MinimapStore::CHUNK_SHIFT, 0, maxChunk);
+
+    // Edges from rounded tile positions, so neighbouring chunks never
+    // leave a seam between them
+    auto drawChunk = [&](const framework::AtlasRegion& region, int chunkX, int chunkY) {
+        int x0 = toScreenX(chunkX * CHUNK_SIZE);
+        int y0 = toScreenY(chunkY * CHUNK_SIZE);
+        int x1 = toScreenX((chunkX + 1) * CHUNK_SIZE);
+        int y1 = toScreenY((chunkY + 1) * CHUNK_SIZE);
+        g_graphics.drawTexture(region.page, region.rect, framework::Rect(x0, y0, x1 - x0, y1 - y0));
+    };
+
+    g_graphics.pushClipRect(area);
+
+    int64_t centerTileX = static_cast<int64_t>(centerX);
+    int64_t centerTileY = static_cast<int64_t>(centerY);
+    m_pending.clear();
+    for (int chunkY = firstY; chunkY <= lastY; ++chunkY) {
+        for (int chunkX = firstX; chunkX <= lastX; ++chunkX) {
+            uint64_t key = chunkKey(chunkX, chunkY, z);
+            if (const framework::AtlasRegion* region = m_atlas->find(key)) {
+                drawChunk(*region, chunkX, chunkY);
+            } else if (!m_empty.count(key)) {
+                int64_t dx = chunkX * CHUNK_SIZE + CHUNK_SIZE / 2 - centerTileX;
+                int64_t dy = chunkY * CHUNK_SIZE + CHUNK_SIZE / 2 - centerTileY;
+                m_pending.push_back({chunkX, chunkY, dx * dx + dy * dy});
+            }
+        }
+    }
+
+    m_loadsPending = m_loadsPending || !m_pending.empty();
+    if (!m_pending.empty() && m_loadsLeft > 0) {
+        std::sort(m_pending.begin(), m_pending.end(), [](const PendingChunk& a, const PendingChunk& b) {
+            return a.distance < b.distance;
+        });
+        for (const PendingChunk& chunk : m_pending) {
+            if (m_loadsLeft <= 0) break;
+            if (const framework::AtlasRegion* region = loadChunk(chunk.chunkX, chunk.chunkY, z)) {
+                drawChunk(*region, chunk.chunkX, chunk.chunkY);
+            }
+        }
+    }
+
+    g_graphics.popClipRect();
+}
+
+} // namespace client
+} // namespace shadow
+
+// Global accessor
+shadow::client::MinimapView& g_minimapView = shadow::client::MinimapView::instance();
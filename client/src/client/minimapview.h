@@ -0,0 +1,126 @@
+/**
+ * Shadow OT Client - Minimap View
+ *
+ * Draws the explored minimap from textures holding one texel per tile.
+ * Every 64x64 chunk of the minimap store is a region of a texture atlas,
+ * uploaded the first time it is drawn; tiles changed afterwards are
+ * collected from Map and written back with one sub-upload per chunk per
+ * frame. Zoom and pan only change the quads, so moving the view costs no
+ * uploads at all.
+ */
+
+#pragma once
+
+#include "minimapstore.h"
+#include <framework/graphics/graphics.h>
+#include <framework/graphics/textureatlas.h>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+class UIWidget;
+}
+
+namespace client {
+
+class MinimapView {
+public:
+    static MinimapView& instance();
+
+    static constexpr int CHUNK_SIZE = MinimapStore::CHUNK_SIZE;
+    // 256 chunks per page; the default budget keeps 1024 chunks resident
+    static constexpr int PAGE_SIZE = 1024;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 16 * 1024 * 1024;
+    // Chunks uploaded whole per frame, nearest to the center first; the
+    // rest show up over the next frames
+    static constexpr int CHUNK_LOADS_PER_FRAME = 16;
+
+    static constexpr float MIN_ZOOM = 0.25f;
+    static constexpr float MAX_ZOOM = 32.0f;
+
+    struct Stats {
+        uint64_t chunkLoads{0};
+        uint64_t subUploads{0};     // Dirty areas written back
+        uint64_t tilesUploaded{0};
+    };
+
+    void terminate();
+
+    // Write Map's minimap changes into the resident chunks; call once per
+    // frame, before drawing. Registered widgets are invalidated when the
+    // minimap changed or their last draw still had chunks to load.
+    void update();
+
+    // Floor z centered on tile (centerX, centerY) at zoom pixels per tile,
+    // clipped to area. Fractional centers pan smoothly between tiles.
+    void draw(const framework::Rect& area, float centerX, float centerY, int z, float zoom);
+
+    // Widgets drawing the minimap inside retained UI layers
+    void addWidget(framework::UIWidget* widget);
+    void removeWidget(framework::UIWidget* widget);
+
+    // Drop every chunk texture; they reload as they are drawn
+    void reset();
+
+    void setMemoryBudget(size_t bytes);
+    size_t getTextureBytes() const { return m_atlas ? m_atlas->getTextureBytes() : 0; }
+    size_t getResidentChunks() const { return m_atlas ? m_atlas->getRegionCount() : 0; }
+    const Stats& getStats() const { return m_stats; }
+
+    // RGB of an 8-bit minimap color (6x6x6 color cube)
+    static framework::Color getColor(uint8_t color);
+
+private:
+    MinimapView() = default;
+    ~MinimapView() = default;
+    MinimapView(const MinimapView&) = delete;
+    MinimapView& operator=(const MinimapView&) = delete;
+
+    // Dirty area of a resident chunk, in chunk-local tiles
+    struct DirtyArea {
+        int minX, minY, maxX, maxY;
+    };
+
+    static uint64_t chunkKey(int chunkX, int chunkY, int z) {
+        return (static_cast<uint64_t>(z) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(chunkX)) << 16) |
+               static_cast<uint16_t>(chunkY);
+    }
+
+    bool ensureAtlas();
+    const framework::AtlasRegion* loadChunk(int chunkX, int chunkY, int z);
+    void markDirty(const Position& pos);
+    void flushDirty();
+    // Texels of tiles [x0, x1) x [y0, y1) of a chunk into m_pixels
+    void fillPixels(int chunkX, int chunkY, int z, int x0, int y0, int x1, int y1);
+
+    std::unique_ptr<framework::TextureAtlas> m_atlas;
+    size_t m_memoryBudget{DEFAULT_MEMORY_BUDGET};
+
+    std::unordered_map<uint64_t, DirtyArea> m_dirty;
+    // Chunks the store has no tiles for, so they are not looked up again
+    // every frame; a change inside one forgets it
+    std::unordered_set<uint64_t> m_empty;
+    int m_loadsLeft{CHUNK_LOADS_PER_FRAME};
+    bool m_loadsPending{false};
+    std::vector<framework::UIWidget*> m_widgets;
+
+    struct PendingChunk {
+        int chunkX, chunkY;
+        int64_t distance;
+    };
+    std::vector<PendingChunk> m_pending;
+    std::vector<uint8_t> m_pixels;
+
+    Stats m_stats;
+};
+
+} // namespace client
+} // namespace shadow
+
+// Global accessor
+extern shadow::client::MinimapView& g_minimapView;
@@ -79,7 +79,7 @@ void Missile::update(float deltaTime) {
     }
 }
 
-int Missile::getDirectionPattern() const {
+int Missile::directionPattern(const Position& from, const Position& to) {
     // Calculate direction from source to destination
     // Returns pattern index 0-7 for 8 directions
     //
@@ -93,8 +93,8 @@ int Missile::getDirectionPattern() const {
     // 6 = South
     // 7 = South-East
 
-    int dx = m_destination.x - m_source.x;
-    int dy = m_destination.y - m_source.y;
+    int dx = to.x - from.x;
+    int dy = to.y - from.y;
 
     // Normalize to -1, 0, 1
     int ndx = (dx > 0) ? 1 : (dx < 0 ? -1 : 0);
@@ -129,7 +129,7 @@ void Missile::draw(int x, int y, float scale) {
     int patternX = pattern % type->getPatternX();
     int patternY = pattern / type->getPatternX();
 
-    type->draw(x, y, scale, patternX, patternY, 0, 0);
+    type->drawInstanced(x, y, scale, patternX, patternY, 0, 0);
 }
 
 void Missile::drawAtPosition(int baseX, int baseY, float scale) {
@@ -160,40 +160,85 @@ MissileManager& MissileManager::instance() {
     return instance;
 }
 
-MissilePtr MissileManager::createMissile(uint16_t missileId,
-                                          const Position& from,
-                                          const Position& to) {
-    auto missile = Missile::create(missileId, from, to);
-    m_missiles.push_back(missile);
-    return missile;
+bool MissileManager::createMissile(uint16_t missileId,
+                                   const Position& from,
+                                   const Position& to) {
+    ThingType* type = ThingTypeManager::instance().getMissileType(missileId);
+    if (!type) return false;
+    if (m_count == CAPACITY) {
+        m_dropped++;
+        return false;
+    }
+
+    // Same trajectory and direction pattern as a Missile takes
+    int dx = to.x - from.x;
+    int dy = to.y - from.y;
+    float duration = std::max(std::sqrt(static_cast<float>(dx * dx + dy * dy)) / MISSILE_SPEED, 0.1f);
+    int pattern = Missile::directionPattern(from, to);
+    int patternsX = std::max(type->getPatternX(), 1);
+
+    size_t i = m_count++;
+    m_types[i] = type;
+    m_progress[i] = 0.0f;
+    m_rates[i] = 1.0f / duration;
+    m_startX[i] = from.x * TILE_SIZE;
+    m_startY[i] = from.y * TILE_SIZE;
+    m_deltaX[i] = dx * TILE_SIZE;
+    m_deltaY[i] = dy * TILE_SIZE;
+    m_pixelX[i] = m_startX[i];
+    m_pixelY[i] = m_startY[i];
+    m_patternX[i] = static_cast<uint8_t>(pattern % patternsX);
+    m_patternY[i] = static_cast<uint8_t>(pattern / patternsX);
+    m_z[i] = from.z;
+    return true;
 }
 
 void MissileManager::update(float deltaTime) {
-    for (auto& missile : m_missiles) {
-        missile->update(deltaTime);
+    // Linear interpolation over the columns, branch-free so it vectorizes
+    for (size_t i = 0; i < m_count; ++i) {
+        m_progress[i] = std::min(m_progress[i] + deltaTime * m_rates[i], 1.0f);
+        m_pixelX[i] = m_startX[i] + m_deltaX[i] * m_progress[i];
+        m_pixelY[i] = m_startY[i] + m_deltaY[i] * m_progress[i];
     }
 
-    // Remove finished missiles
-    cleanup();
-}
-
-void MissileManager::draw(int viewX, int viewY, float scale) {
-    for (const auto& missile : m_missiles) {
-        if (!missile->isFinished()) {
-            missile->drawAtPosition(viewX, viewY, scale);
+    // Remove finished missiles; the moved one is checked in the same slot
+    for (size_t i = 0; i < m_count;) {
+        if (m_progress[i] >= 1.0f) {
+            swapRemove(i);
+        } else {
+            ++i;
         }
     }
 }
 
-void MissileManager::cleanup() {
-    m_missiles.erase(
-        std::remove_if(m_missiles.begin(), m_missiles.end(),
-            [](const MissilePtr& m) { return m->isFinished(); }),
-        m_missiles.end());
+void MissileManager::swapRemove(size_t index) {
+    size_t last = --m_count;
+    m_types[index] = m_types[last];
+    m_progress[index] = m_progress[last];
+    m_rates[index] = m_rates[last];
+    m_startX[index] = m_startX[last];
+    m_startY[index] = m_startY[last];
+    m_deltaX[index] = m_deltaX[last];
+    m_deltaY[index] = m_deltaY[last];
+    m_pixelX[index] = m_pixelX[last];
+    m_pixelY[index] = m_pixelY[last];
+    m_patternX[index] = m_patternX[last];
+    m_patternY[index] = m_patternY[last];
+    m_z[index] = m_z[last];
+}
+
+void MissileManager::draw(float viewX, float viewY, int z, float scale) {
+    for (size_t i = 0; i < m_count; ++i) {
+        if (m_z[i] != z) continue;
+
+        int screenX = static_cast<int>((m_pixelX[i] - viewX) * scale);
+        int screenY = static_cast<int>((m_pixelY[i] - viewY) * scale);
+        m_types[i]->drawInstanced(screenX, screenY, scale, m_patternX[i], m_patternY[i], 0, 0);
+    }
 }
 
 void MissileManager::clear() {
-    m_missiles.clear();
+    m_count = 0;
 }
 
 } // namespace client
@@ -10,8 +10,8 @@
 #include "thingtype.h"
 #include <cstdint>
 #include <memory>
+#include <array>
 #include <vector>
-#include <map>
 
 namespace shadow {
 namespace client {
@@ -47,7 +47,8 @@ public:
     float getProgress() const { return m_progress; }
 
     // Get direction pattern for sprite selection
-    int getDirectionPattern() const;
+    int getDirectionPattern() const { return directionPattern(m_source, m_destination); }
+    static int directionPattern(const Position& from, const Position& to);
 
     // Current pixel position for rendering
     float getPixelX() const { return m_pixelX; }
@@ -85,35 +86,58 @@ private:
 
 using MissilePtr = std::shared_ptr<Missile>;
 
-// Missile Manager - handles all active missiles
+// Missile Manager - handles all active missiles, pooled as columns like
+// EffectManager's: one linear pass moves every missile, swap-and-pop
+// drops the ones that arrived
 class MissileManager {
 public:
     static MissileManager& instance();
 
-    // Create and add missile
-    MissilePtr createMissile(uint16_t missileId,
-                             const Position& from,
-                             const Position& to);
+    static constexpr size_t CAPACITY = 1024;
+
+    // False, dropping the missile, when the pool is full or the type is
+    // unknown
+    bool createMissile(uint16_t missileId,
+                       const Position& from,
+                       const Position& to);
 
     // Update all missiles
     void update(float deltaTime);
 
-    // Draw all missiles (should be called after map tiles)
-    void draw(int viewX, int viewY, float scale = 1.0f);
-
-    // Remove finished missiles
-    void cleanup();
+    // Draw the missiles on floor z (should be called after map tiles).
+    // viewX/viewY is the world pixel drawn at the screen's top-left corner.
+    void draw(float viewX, float viewY, int z, float scale = 1.0f);
 
     // Clear all missiles
     void clear();
 
     // Get active missile count
-    size_t getActiveCount() const { return m_missiles.size(); }
+    size_t getActiveCount() const { return m_count; }
+    uint64_t getDroppedCount() const { return m_dropped; }
 
 private:
     MissileManager() = default;
 
-    std::vector<MissilePtr> m_missiles;
+    void swapRemove(size_t index);
+
+    // Speed in tiles per second
+    static constexpr float MISSILE_SPEED = 10.0f;
+    static constexpr float TILE_SIZE = 32.0f;
+
+    std::array<ThingType*, CAPACITY> m_types{};
+    std::array<float, CAPACITY> m_progress{};       // 0 at source, 1 at destination
+    std::array<float, CAPACITY> m_rates{};          // Progress per second
+    std::array<float, CAPACITY> m_startX{};         // World pixels
+    std::array<float, CAPACITY> m_startY{};
+    std::array<float, CAPACITY> m_deltaX{};
+    std::array<float, CAPACITY> m_deltaY{};
+    std::array<float, CAPACITY> m_pixelX{};
+    std::array<float, CAPACITY> m_pixelY{};
+    std::array<uint8_t, CAPACITY> m_patternX{};
+    std::array<uint8_t, CAPACITY> m_patternY{};
+    std::array<uint8_t, CAPACITY> m_z{};
+    size_t m_count{0};
+    uint64_t m_dropped{0};
 };
 
 } // namespace client
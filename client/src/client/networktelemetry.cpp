@@ -0,0 +1,205 @@
+/**
+ * Shadow OT Client - Network Telemetry Implementation
+ */
+
+#include "networktelemetry.h"
+#include "game.h"
+#include "protocolgame.h"
+#include <framework/graphics/graphics.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+namespace shadow {
+namespace client {
+
+using framework::g_graphics;
+using framework::Color;
+using framework::Rect;
+
+namespace {
+
+constexpr int OVERLAY_FONT_SIZE = 11;
+constexpr int OVERLAY_LINE_HEIGHT = 14;
+constexpr int OVERLAY_WIDTH = 300;
+constexpr int OVERLAY_LINES = 9;
+
+double toMs(uint64_t us) {
+    return us / 1000.0;
+}
+
+} // anonymous namespace
+
+NetworkTelemetry& NetworkTelemetry::instance() {
+    static NetworkTelemetry instance;
+    return instance;
+}
+
+void NetworkTelemetry::update() {
+    auto now = Clock::now();
+    auto protocol = g_game.getProtocol();
+    const framework::Connection* connection = protocol ? protocol->getConnection().get() : nullptr;
+    if (connection && !connection->isConnected()) {
+        connection = nullptr;
+    }
+
+    if (connection && m_pingInterval.count() > 0 && now - m_lastPing >= m_pingInterval) {
+        g_game.ping();
+        m_lastPing = now;
+    }
+
+    if (now - m_lastSample < SAMPLE_INTERVAL) return;
+    takeSample(connection, now);
+
+    if (m_exportFile.is_open() && now - m_lastExport >= m_exportInterval) {
+        exportSample();
+    }
+}
+
+void NetworkTelemetry::takeSample(const framework::Connection* connection, Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - m_lastSample).count();
+    bool continued = connection && connection == m_lastConnection;
+    m_lastSample = now;
+    m_lastConnection = connection;
+
+    Sample sample;
+    sample.seconds = std::chrono::duration<double>(now - m_epoch).count();
+    if (!connection) {
+        m_sample = sample;
+        return;
+    }
+    sample.connected = true;
+
+    uint64_t bytesSent = connection->getBytesSent();
+    uint64_t bytesReceived = connection->getBytesReceived();
+    uint64_t packetsSent = connection->getPacketsSent();
+    uint64_t packetsReceived = connection->getPacketsReceived();
+    // Counters reset when the connection reconnects; skip that interval
+    continued = continued && bytesSent >= m_lastBytesSent && bytesReceived >= m_lastBytesReceived &&
+                packetsSent >= m_lastPacketsSent && packetsReceived >= m_lastPacketsReceived;
+    if (continued && elapsed > 0.0) {
+        sample.bytesSentPerSecond = (bytesSent - m_lastBytesSent) / elapsed;
+        sample.bytesReceivedPerSecond = (bytesReceived - m_lastBytesReceived) / elapsed;
+        sample.packetsSentPerSecond = (packetsSent - m_lastPacketsSent) / elapsed;
+        sample.packetsReceivedPerSecond = (packetsReceived - m_lastPacketsReceived) / elapsed;
+    }
+    m_lastBytesSent = bytesSent;
+    m_lastBytesReceived = bytesReceived;
+    m_lastPacketsSent = packetsSent;
+    m_lastPacketsReceived = packetsReceived;
+
+    const framework::LatencyHistogram& rtt = connection->getRoundTrips();
+    sample.rttSamples = rtt.getCount();
+    sample.rttP50Us = rtt.getPercentile(0.50);
+    sample.rttP95Us = rtt.getPercentile(0.95);
+    sample.rttP99Us = rtt.getPercentile(0.99);
+    sample.jitterUs = connection->getJitterUs();
+
+    const framework::LatencyHistogram& queue = connection->getSendQueueTimes();
+    sample.sendQueueDepth = connection->getSendQueueDepth();
+    sample.sendQueueMaxDepth = connection->getMaxSendQueueDepth();
+    sample.queueP50Us = queue.getPercentile(0.50);
+    sample.queueP99Us = queue.getPercentile(0.99);
+
+    const framework::LatencyHistogram& receive = connection->getReceiveDelays();
+    sample.receiveP50Us = receive.getPercentile(0.50);
+    sample.receiveP95Us = receive.getPercentile(0.95);
+    sample.receiveP99Us = receive.getPercentile(0.99);
+
+    sample.tcp = connection->getTcpInfo();
+    m_sample = sample;
+}
+
+bool NetworkTelemetry::setExportFile(const std::string& path, std::chrono::seconds interval) {
+    m_exportFile.close();
+    m_exportPath.clear();
+    m_exportInterval = std::max(interval, std::chrono::seconds(1));
+    if (path.empty()) return true;
+
+    std::error_code error;
+    bool fresh = !std::filesystem::exists(path, error) || std::filesystem::file_size(path, error) == 0;
+    m_exportFile.open(path, std::ios::app);
+    if (!m_exportFile.is_open()) return false;
+
+    if (fresh) {
+        m_exportFile << "seconds,connected,bytes_sent_s,bytes_received_s,packets_sent_s,packets_received_s,"
+                        "rtt_samples,rtt_p50_us,rtt_p95_us,rtt_p99_us,jitter_us,"
+                        "send_queue,send_queue_max,queue_p50_us,queue_p99_us,"
+                        "receive_p50_us,receive_p95_us,receive_p99_us,"
+                        "tcp_rtt_us,tcp_rttvar_us,tcp_retransmits,tcp_lost,tcp_cwnd,tcp_unacked\n";
+    }
+    m_exportPath = path;
+    return true;
+}
+
+void NetworkTelemetry::exportSample() {
+    const Sample& s = m_sample;
+    m_lastExport = Clock::now();
+
+    char row[512];
+    std::snprintf(row, sizeof(row),
+                  "%.0f,%d,%.0f,%.0f,%.1f,%.1f,%llu,%llu,%llu,%llu,%llu,%u,%u,%llu,%llu,%llu,%llu,%llu,%u,%u,%u,%u,%u,%u\n",
+                  s.seconds, s.connected ? 1 : 0,
+                  s.bytesSentPerSecond, s.bytesReceivedPerSecond, s.packetsSentPerSecond, s.packetsReceivedPerSecond,
+                  static_cast<unsigned long long>(s.rttSamples), static_cast<unsigned long long>(s.rttP50Us),
+                  static_cast<unsigned long long>(s.rttP95Us), static_cast<unsigned long long>(s.rttP99Us),
+                  static_cast<unsigned long long>(s.jitterUs),
+                  s.sendQueueDepth, s.sendQueueMaxDepth,
+                  static_cast<unsigned long long>(s.queueP50Us), static_cast<unsigned long long>(s.queueP99Us),
+                  static_cast<unsigned long long>(s.receiveP50Us), static_cast<unsigned long long>(s.receiveP95Us),
+                  static_cast<unsigned long long>(s.receiveP99Us),
+                  s.tcp.rttUs, s.tcp.rttVarUs, s.tcp.retransmits, s.tcp.lost, s.tcp.congestionWindow, s.tcp.unacked);
+    m_exportFile << row;
+    m_exportFile.flush();
+}
+
+void NetworkTelemetry::drawOverlay(int x, int y) {
+    if (!m_overlayVisible) return;
+
+    const Sample& s = m_sample;
+    g_graphics.drawFilledRect(Rect(x, y, OVERLAY_WIDTH, OVERLAY_LINES * OVERLAY_LINE_HEIGHT + 8), Color(0, 0, 0, 180));
+
+    char line[128];
+    int textX = x + 6;
+    int textY = y + 4;
+    auto text = [&](const Color& color) {
+        g_graphics.drawText(line, textX, textY, color, OVERLAY_FONT_SIZE);
+        textY += OVERLAY_LINE_HEIGHT;
+    };
+
+    if (!s.connected) {
+        std::snprintf(line, sizeof(line), "network: not connected");
+        text(Color(160, 160, 160));
+        return;
+    }
+
+    std::snprintf(line, sizeof(line), "%-9s %9s %9s", "network", "up", "down");
+    text(Color(160, 160, 160));
+    std::snprintf(line, sizeof(line), "%-9s %9.1f %9.1f", "KB/s", s.bytesSentPerSecond / 1024.0, s.bytesReceivedPerSecond / 1024.0);
+    text(Color::white());
+    std::snprintf(line, sizeof(line), "%-9s %9.1f %9.1f", "packets/s", s.packetsSentPerSecond, s.packetsReceivedPerSecond);
+    text(Color::white());
+
+    std::snprintf(line, sizeof(line), "rtt ms  p50 %.1f  p95 %.1f  p99 %.1f", toMs(s.rttP50Us), toMs(s.rttP95Us), toMs(s.rttP99Us));
+    text(Color(200, 220, 255));
+    std::snprintf(line, sizeof(line), "jitter %.1f ms  (%llu probes)", toMs(s.jitterUs), static_cast<unsigned long long>(s.rttSamples));
+    text(Color(200, 220, 255));
+
+    std::snprintf(line, sizeof(line), "send queue %u (max %u)  p99 %.2f ms", s.sendQueueDepth, s.sendQueueMaxDepth, toMs(s.queueP99Us));
+    text(Color(200, 255, 200));
+    std::snprintf(line, sizeof(line), "recv->parse ms  p50 %.2f  p99 %.2f", toMs(s.receiveP50Us), toMs(s.receiveP99Us));
+    text(Color(200, 255, 200));
+
+    if (s.tcp.available) {
+        std::snprintf(line, sizeof(line), "tcp rtt %.1f/%.1f ms  cwnd %u", toMs(s.tcp.rttUs), toMs(s.tcp.rttVarUs), s.tcp.congestionWindow);
+        text(Color(255, 230, 200));
+        std::snprintf(line, sizeof(line), "tcp retrans %u  lost %u  unacked %u", s.tcp.retransmits, s.tcp.lost, s.tcp.unacked);
+        text(Color(255, 230, 200));
+    }
+}
+
+} // namespace client
+} // namespace shadow
+
+// Global accessor
+shadow::client::NetworkTelemetry& g_netTelemetry = shadow::client::NetworkTelemetry::instance();
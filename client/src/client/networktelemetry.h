@@ -0,0 +1,109 @@
+/**
+ * Shadow OT Client - Network Telemetry
+ *
+ * Samples the game connection once a second: per-direction byte and
+ * packet rates, RTT percentiles and jitter from periodic ping probes,
+ * send-queue depth and time in queue, receive-to-parse delay and the
+ * kernel's TCP state. The latest sample shows in an overlay, in g_net
+ * from Lua, and optionally as CSV rows for offline analysis.
+ */
+
+#pragma once
+
+#include <framework/net/connection.h>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace shadow {
+namespace client {
+
+class NetworkTelemetry {
+public:
+    static NetworkTelemetry& instance();
+
+    static constexpr auto SAMPLE_INTERVAL = std::chrono::seconds(1);
+    // Ping probes while online; zero turns them off
+    static constexpr auto DEFAULT_PING_INTERVAL = std::chrono::seconds(2);
+
+    struct Sample {
+        bool connected{false};
+        double seconds{0.0};            // Since startup
+
+        double bytesSentPerSecond{0.0};
+        double bytesReceivedPerSecond{0.0};
+        double packetsSentPerSecond{0.0};
+        double packetsReceivedPerSecond{0.0};
+
+        // Percentiles since the connection opened, in microseconds
+        uint64_t rttSamples{0};
+        uint64_t rttP50Us{0};
+        uint64_t rttP95Us{0};
+        uint64_t rttP99Us{0};
+        uint64_t jitterUs{0};
+
+        uint32_t sendQueueDepth{0};
+        uint32_t sendQueueMaxDepth{0};
+        uint64_t queueP50Us{0};
+        uint64_t queueP99Us{0};
+
+        uint64_t receiveP50Us{0};
+        uint64_t receiveP95Us{0};
+        uint64_t receiveP99Us{0};
+
+        framework::Connection::TcpInfo tcp;
+    };
+
+    // Call once per frame; does nothing between samples
+    void update();
+    const Sample& getSample() const { return m_sample; }
+
+    void setPingInterval(std::chrono::milliseconds interval) { m_pingInterval = interval; }
+    std::chrono::milliseconds getPingInterval() const { return m_pingInterval; }
+
+    // Appends one CSV row per interval; "" stops exporting
+    bool setExportFile(const std::string& path, std::chrono::seconds interval = std::chrono::seconds(10));
+    const std::string& getExportFile() const { return m_exportPath; }
+
+    void setOverlayVisible(bool visible) { m_overlayVisible = visible; }
+    bool isOverlayVisible() const { return m_overlayVisible; }
+    void drawOverlay(int x, int y);
+
+private:
+    NetworkTelemetry() = default;
+    ~NetworkTelemetry() = default;
+    NetworkTelemetry(const NetworkTelemetry&) = delete;
+    NetworkTelemetry& operator=(const NetworkTelemetry&) = delete;
+
+    using Clock = std::chrono::steady_clock;
+
+    void takeSample(const framework::Connection* connection, Clock::time_point now);
+    void exportSample();
+
+    Sample m_sample;
+    Clock::time_point m_epoch{Clock::now()};
+    Clock::time_point m_lastSample{};
+    Clock::time_point m_lastPing{};
+    std::chrono::milliseconds m_pingInterval{DEFAULT_PING_INTERVAL};
+
+    // Counters at the previous sample, for rates; a new connection starts over
+    const framework::Connection* m_lastConnection{nullptr};
+    uint64_t m_lastBytesSent{0};
+    uint64_t m_lastBytesReceived{0};
+    uint64_t m_lastPacketsSent{0};
+    uint64_t m_lastPacketsReceived{0};
+
+    std::string m_exportPath;
+    std::ofstream m_exportFile;
+    std::chrono::seconds m_exportInterval{10};
+    Clock::time_point m_lastExport{};
+
+    bool m_overlayVisible{false};
+};
+
+} // namespace client
+} // namespace shadow
+
+// Global accessor
+extern shadow::client::NetworkTelemetry& g_netTelemetry;
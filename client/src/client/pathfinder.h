@@ -0,0 +1,196 @@
+/**
+ * Shadow OT Client - Path Finder
+ *
+ * A* over a flat node grid centred on the start position, with a binary
+ * heap open list and per-thread scratch buffers reused across searches
+ * (and released again after unusually long ones).
+ * Step costs are integer ground speeds; the cost source is a template
+ * parameter so the live map and walkability snapshots share one search.
+ */
+
+#pragma once
+
+#include "position.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace shadow {
+namespace client {
+namespace pathfinding {
+
+// Diagonal steps take three times as long as straight ones
+constexpr uint32_t DIAGONAL_FACTOR = 3;
+
+// Cost used for a blocked destination (paths may end on one) and for
+// grounds that report no speed
+constexpr uint32_t DEFAULT_STEP_COST = 150;
+
+struct Node {
+    uint32_t g;
+    uint16_t stamp;       // Node is live for the search with this stamp
+    uint8_t dir;          // Direction of the step that reached this node
+    uint8_t closed;
+};
+
+struct HeapEntry {
+    uint32_t f;
+    uint32_t index;
+
+    // std::push_heap builds a max-heap; invert for a min-heap on f
+    bool operator<(const HeapEntry& other) const { return f > other.f; }
+};
+
+// Reused between searches on the same thread; a new stamp invalidates the
+// previous search's nodes without touching the grid
+struct Scratch {
+    // Grid kept between searches (maxDistance 180, 1 MB); larger searches
+    // free theirs when done instead of pinning it to the thread
+    static constexpr size_t RETAINED_NODES = 361 * 361;
+
+    std::vector<Node> nodes;
+    std::vector<HeapEntry> heap;
+    uint16_t stamp{0};
+
+    void begin(size_t nodeCount) {
+        if (nodes.size() < nodeCount) {
+            nodes.resize(nodeCount, Node{0, 0, 0, 0});
+        }
+        if (++stamp == 0) {
+            std::fill(nodes.begin(), nodes.end(), Node{0, 0, 0, 0});
+            stamp = 1;
+        }
+        heap.clear();
+    }
+
+    void end() {
+        if (nodes.size() > RETAINED_NODES) {
+            std::vector<Node>().swap(nodes);
+            std::vector<HeapEntry>().swap(heap);
+        }
+    }
+};
+
+inline Scratch& threadScratch() {
+    thread_local Scratch scratch;
+    return scratch;
+}
+
+constexpr int DIRECTION_DX[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+constexpr int DIRECTION_DY[8] = {-1, 0, 1, 0, -1, 1, 1, -1};
+
+// costAt(const Position&) returns the cost of stepping onto a tile, or 0
+// if it cannot be walked. Writes the steps into `path` (cleared first) and
+// returns false when there is no path within maxDistance of start.
+template<typename CostFn>
+bool findPath(const Position& start, const Position& end, int maxDistance,
+              CostFn&& costAt, std::vector<Position::Direction>& path) {
+    path.clear();
+    if (start == end || start.z != end.z || maxDistance <= 0) {
+        return false;
+    }
+
+    const int width = maxDistance * 2 + 1;
+    const int originX = static_cast<int>(start.x) - maxDistance;
+    const int originY = static_cast<int>(start.y) - maxDistance;
+    const int endX = end.x;
+    const int endY = end.y;
+
+    if (std::abs(endX - start.x) > maxDistance || std::abs(endY - start.y) > maxDistance) {
+        return false;
+    }
+
+    // Scale the heuristic by the cost of the starting ground: exact on
+    // uniform ground, slightly greedy across mixed terrain
+    uint32_t startCost = costAt(start);
+    const uint32_t heuristicScale = startCost ? startCost : DEFAULT_STEP_COST;
+    auto heuristic = [&](int x, int y) {
+        return static_cast<uint32_t>(std::abs(x - endX) + std::abs(y - endY)) * heuristicScale;
+    };
+
+    Scratch& scratch = threadScratch();
+    scratch.begin(static_cast<size_t>(width) * width);
+    const uint16_t stamp = scratch.stamp;
+    Node* nodes = scratch.nodes.data();
+    auto& heap = scratch.heap;
+
+    const uint32_t startIndex = static_cast<uint32_t>(maxDistance * width + maxDistance);
+    const uint32_t endIndex = static_cast<uint32_t>((endY - originY) * width + (endX - originX));
+    nodes[startIndex] = Node{0, stamp, static_cast<uint8_t>(Position::InvalidDirection), 0};
+    heap.push_back({heuristic(start.x, start.y), startIndex});
+
+    bool found = false;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        HeapEntry entry = heap.back();
+        heap.pop_back();
+
+        Node& current = nodes[entry.index];
+        if (current.closed) continue;   // Stale duplicate
+        current.closed = 1;
+
+        if (entry.index == endIndex) {
+            found = true;
+            break;
+        }
+
+        int cx = originX + static_cast<int>(entry.index % width);
+        int cy = originY + static_cast<int>(entry.index / width);
+
+        for (int dir = 0; dir < 8; ++dir) {
+            int nx = cx + DIRECTION_DX[dir];
+            int ny = cy + DIRECTION_DY[dir];
+            int lx = nx - originX;
+            int ly = ny - originY;
+            if (lx < 0 || ly < 0 || lx >= width || ly >= width) continue;
+            // Off the map edge, where the cast below would wrap
+            if (nx < 0 || ny < 0 || nx > std::numeric_limits<uint16_t>::max() ||
+                ny > std::numeric_limits<uint16_t>::max()) continue;
+
+            uint32_t index = static_cast<uint32_t>(ly * width + lx);
+            Node& neighbor = nodes[index];
+            if (neighbor.stamp == stamp && neighbor.closed) continue;
+
+            uint32_t stepCost = costAt(Position(static_cast<uint16_t>(nx), static_cast<uint16_t>(ny), start.z));
+            if (stepCost == 0) {
+                // Allow destination even if blocked
+                if (index != endIndex) continue;
+                stepCost = DEFAULT_STEP_COST;
+            }
+            if (dir >= Position::NorthEast) {
+                stepCost *= DIAGONAL_FACTOR;
+            }
+
+            uint32_t g = current.g + stepCost;
+            if (neighbor.stamp == stamp && neighbor.g <= g) continue;
+
+            neighbor = Node{g, stamp, static_cast<uint8_t>(dir), 0};
+            heap.push_back({g + heuristic(nx, ny), index});
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+
+    if (!found) {
+        scratch.end();
+        return false;
+    }
+
+    // Walk parents back from the goal, then reverse in place
+    uint32_t index = endIndex;
+    while (index != startIndex) {
+        uint8_t dir = nodes[index].dir;
+        path.push_back(static_cast<Position::Direction>(dir));
+        int lx = static_cast<int>(index % width) - DIRECTION_DX[dir];
+        int ly = static_cast<int>(index / width) - DIRECTION_DY[dir];
+        index = static_cast<uint32_t>(ly * width + lx);
+    }
+    std::reverse(path.begin(), path.end());
+    scratch.end();
+    return true;
+}
+
+} // namespace pathfinding
+} // namespace client
+} // namespace shadow
@@ -0,0 +1,248 @@
+/**
+ * Shadow OT Client - Path Service Implementation
+ */
+
+#include "pathservice.h"
+#include "pathfinder.h"
+#include "map.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace shadow {
+namespace client {
+
+// WalkabilitySnapshot
+
+WalkabilitySnapshot::WalkabilitySnapshot(int originX, int originY, int z, int width)
+    : m_originX(originX), m_originY(originY), m_z(z), m_width(width),
+      m_cost(static_cast<size_t>(width) * width, 0) {}
+
+bool WalkabilitySnapshot::covers(const Position& center, int radius) const {
+    return center.z == m_z &&
+           center.x - radius >= m_originX && center.y - radius >= m_originY &&
+           center.x + radius < m_originX + m_width && center.y + radius < m_originY + m_width;
+}
+
+// PathService
+
+PathService& PathService::instance() {
+    static PathService instance;
+    return instance;
+}
+
+PathService::~PathService() {
+    terminate();
+}
+
+void PathService::init() {
+    m_running = true;
+}
+
+void PathService::terminate() {
+    std::vector<framework::JobSystem::Handle> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_running = false;
+        for (auto& [id, job] : m_active) {
+            cancelLocked(*job);
+            tasks.push_back(job->task);
+        }
+    }
+
+    // Cancelled searches drain in a few steps and resolve as Cancelled
+    for (const auto& task : tasks) {
+        g_jobs.wait(task);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active.clear();
+    m_finished.clear();
+    m_frameSnapshot.reset();
+}
+
+std::shared_ptr<const WalkabilitySnapshot> PathService::getSnapshot(const Position& start, int maxDistance) {
+    if (m_frameSnapshot && m_frameSnapshot->covers(start, maxDistance)) {
+        return m_frameSnapshot;
+    }
+
+    auto snapshot = std::make_shared<WalkabilitySnapshot>(
+        start.x - maxDistance, start.y - maxDistance, start.z, maxDistance * 2 + 1);
+
+    // Only known tiles are visited; everything else stays blocked
+    g_map.forEachTile(start.x - maxDistance, start.y - maxDistance,
+                      start.x + maxDistance, start.y + maxDistance, start.z,
+                      [&](const TilePtr& tile, int x, int y) {
+        if (!tile->isPathable()) return;
+        uint16_t speed = tile->getGroundSpeed();
+        snapshot->setCost(x, y, speed ? speed : static_cast<uint16_t>(pathfinding::DEFAULT_STEP_COST));
+    });
+
+    m_frameSnapshot = snapshot;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.snapshots++;
+    return snapshot;
+}
+
+PathService::JobPtr PathService::createJob(const Position& start, const Position& goal, const Options& options) {
+    auto job = std::make_shared<Job>();
+    job->result.start = start;
+    job->result.goal = goal;
+    job->maxDistance = std::max(1, options.maxDistance);
+    job->group = options.group;
+    job->snapshot = getSnapshot(start, job->maxDistance);
+    return job;
+}
+
+uint64_t PathService::enqueue(const JobPtr& job) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t id = m_nextId++;
+    job->result.id = id;
+    m_stats.submitted++;
+
+    // Outside init()/terminate() nothing waits on searches; resolve at once
+    if (!m_running) cancelLocked(*job);
+
+    if (job->group != GROUP_NONE) {
+        for (auto& [activeId, other] : m_active) {
+            if (other->group == job->group) cancelLocked(*other);
+        }
+    }
+    m_active[id] = job;
+    lock.unlock();
+
+    // Without the job system this searches inline, still delivering
+    // through poll(). The handle is kept so terminate() can wait for it.
+    auto task = g_jobs.submit([this, job] {
+        run(*job);
+        finish(job);
+    }, framework::JobPriority::High);
+
+    lock.lock();
+    if (m_active.count(id)) job->task = std::move(task);
+    return id;
+}
+
+uint64_t PathService::request(const Position& start, const Position& goal, const Options& options, Callback callback) {
+    JobPtr job = createJob(start, goal, options);
+    job->callback = std::move(callback);
+    return enqueue(job);
+}
+
+std::future<PathResult> PathService::requestAsync(const Position& start, const Position& goal, const Options& options) {
+    JobPtr job = createJob(start, goal, options);
+    job->hasPromise = true;
+    std::future<PathResult> future = job->promise.get_future();
+    enqueue(job);
+    return future;
+}
+
+void PathService::cancelLocked(Job& job) {
+    job.cancelled.store(true, std::memory_order_relaxed);
+}
+
+void PathService::cancel(uint64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_active.find(id);
+    if (it != m_active.end()) cancelLocked(*it->second);
+}
+
+void PathService::cancelGroup(uint32_t group) {
+    if (group == GROUP_NONE) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [id, job] : m_active) {
+        if (job->group == group) cancelLocked(*job);
+    }
+}
+
+void PathService::cancelAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [id, job] : m_active) {
+        cancelLocked(*job);
+    }
+}
+
+void PathService::run(Job& job) {
+    if (job.cancelled.load(std::memory_order_relaxed)) {
+        job.result.status = PathStatus::Cancelled;
+        return;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    // Once cancelled every tile reads as blocked, which drains the open
+    // list within a few pops instead of finishing a search nobody wants
+    const WalkabilitySnapshot& snapshot = *job.snapshot;
+    bool found = pathfinding::findPath(job.result.start, job.result.goal, job.maxDistance,
+        [&](const Position& pos) -> uint32_t {
+            if (job.cancelled.load(std::memory_order_relaxed)) return 0;
+            return snapshot.costAt(pos);
+        }, job.result.path);
+
+    job.result.searchUs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+
+    if (job.cancelled.load(std::memory_order_relaxed)) {
+        job.result.status = PathStatus::Cancelled;
+        job.result.path.clear();
+    } else {
+        job.result.status = found ? PathStatus::Found : PathStatus::NoPath;
+    }
+}
+
+void PathService::finish(const JobPtr& job) {
+    job->snapshot.reset();
+    if (job->hasPromise) {
+        job->promise.set_value(job->result);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.searchUs += job->result.searchUs;
+    if (job->result.status == PathStatus::Cancelled) {
+        m_stats.cancelled++;
+    } else {
+        m_stats.completed++;
+    }
+
+    if (job->callback) {
+        m_finished.push_back(job);
+    } else {
+        m_active.erase(job->result.id);
+    }
+}
+
+void PathService::poll() {
+    // The map may change before the next request, so stop sharing this snapshot
+    m_frameSnapshot.reset();
+
+    std::vector<JobPtr> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished.empty()) return;
+        finished.swap(m_finished);
+        for (const auto& job : finished) {
+            m_active.erase(job->result.id);
+        }
+    }
+
+    for (const auto& job : finished) {
+        job->callback(job->result);
+    }
+}
+
+PathService::Stats PathService::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+size_t PathService::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active.size();
+}
+
+} // namespace client
+} // namespace shadow
+
+// Global accessor
+shadow::client::PathService& g_pathService = shadow::client::PathService::instance();
@@ -0,0 +1,148 @@
+/**
+ * Shadow OT Client - Path Service
+ *
+ * Runs path searches as high-priority jobs so the frame thread never does.
+ * Each request searches an immutable walkability snapshot taken on the main
+ * thread; results come back through poll() or a future. Requests sharing a
+ * group supersede each other, so a new click cancels the previous route.
+ */
+
+#pragma once
+
+#include "position.h"
+#include <framework/core/jobsystem.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace shadow {
+namespace client {
+
+// Step costs for a square window of one floor, copied out of the map so
+// workers never touch live tiles. 0 marks an unknown or blocked tile.
+class WalkabilitySnapshot {
+public:
+    WalkabilitySnapshot(int originX, int originY, int z, int width);
+
+    uint32_t costAt(const Position& pos) const {
+        int x = pos.x - m_originX;
+        int y = pos.y - m_originY;
+        if (pos.z != m_z || x < 0 || y < 0 || x >= m_width || y >= m_width) return 0;
+        return m_cost[static_cast<size_t>(y) * m_width + x];
+    }
+    void setCost(int x, int y, uint16_t cost) {
+        m_cost[static_cast<size_t>(y - m_originY) * m_width + (x - m_originX)] = cost;
+    }
+
+    // True if the window holds every tile within `radius` of `center`
+    bool covers(const Position& center, int radius) const;
+
+private:
+    int m_originX, m_originY, m_z, m_width;
+    std::vector<uint16_t> m_cost;
+};
+
+enum class PathStatus {
+    Found,
+    NoPath,
+    Cancelled
+};
+
+struct PathResult {
+    uint64_t id{0};
+    PathStatus status{PathStatus::NoPath};
+    Position start;
+    Position goal;
+    std::vector<Position::Direction> path;
+    uint32_t searchUs{0};
+};
+
+class PathService {
+public:
+    static PathService& instance();
+
+    // Group 0 never supersedes; GROUP_AUTOWALK belongs to Game::autoWalkTo
+    static constexpr uint32_t GROUP_NONE = 0;
+    static constexpr uint32_t GROUP_AUTOWALK = 1;
+
+    struct Options {
+        int maxDistance{100};
+        uint32_t group{GROUP_NONE};
+    };
+
+    using Callback = std::function<void(const PathResult&)>;
+
+    // Searches run on g_jobs; inline when it is not running
+    void init();
+    void terminate();
+
+    // Snapshots the map around start and queues the search. The callback runs
+    // from poll() on the main thread, including for cancelled requests.
+    uint64_t request(const Position& start, const Position& goal, const Options& options, Callback callback);
+    std::future<PathResult> requestAsync(const Position& start, const Position& goal, const Options& options);
+
+    void cancel(uint64_t id);
+    void cancelGroup(uint32_t group);
+    void cancelAll();
+
+    // Deliver finished results; also retires this frame's snapshot
+    void poll();
+
+    struct Stats {
+        uint64_t submitted{0};
+        uint64_t completed{0};
+        uint64_t cancelled{0};
+        uint64_t snapshots{0};
+        uint64_t searchUs{0};
+    };
+    Stats getStats() const;
+    size_t getPendingCount() const;
+
+private:
+    PathService() = default;
+    ~PathService();
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+
+    struct Job {
+        PathResult result;
+        int maxDistance{0};
+        uint32_t group{GROUP_NONE};
+        std::shared_ptr<const WalkabilitySnapshot> snapshot;
+        Callback callback;
+        std::promise<PathResult> promise;
+        bool hasPromise{false};
+        std::atomic<bool> cancelled{false};
+        framework::JobSystem::Handle task;
+    };
+    using JobPtr = std::shared_ptr<Job>;
+
+    JobPtr createJob(const Position& start, const Position& goal, const Options& options);
+    uint64_t enqueue(const JobPtr& job);
+    std::shared_ptr<const WalkabilitySnapshot> getSnapshot(const Position& start, int maxDistance);
+    void cancelLocked(Job& job);
+    void run(Job& job);
+    void finish(const JobPtr& job);
+
+    bool m_running{false};
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, JobPtr> m_active;
+    std::vector<JobPtr> m_finished;
+    uint64_t m_nextId{1};
+    Stats m_stats;
+
+    // Main thread only: snapshot shared by requests made in the same frame
+    std::shared_ptr<const WalkabilitySnapshot> m_frameSnapshot;
+};
+
+} // namespace client
+} // namespace shadow
+
+// Global accessor
+extern shadow::client::PathService& g_pathService;
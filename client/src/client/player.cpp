@@ -4,6 +4,7 @@
 
 #include "player.h"
 #include "item.h"
+#include <framework/core/objectpool.h>
 
 namespace shadow {
 namespace client {
@@ -12,7 +13,7 @@ Player::Player() : Creature() {
 }
 
 std::shared_ptr<Player> Player::create(uint32_t id) {
-    auto player = std::make_shared<Player>();
+    auto player = framework::makePooled<Player>();
     player->setCreatureId(id);
     return player;
 }
@@ -102,9 +103,35 @@ void Player::setInventoryItem(InventorySlot slot, std::shared_ptr<Item> item) {
     size_t idx = static_cast<size_t>(slot);
     if (idx < m_inventory.size()) {
         m_inventory[idx] = item;
+        if (m_onInventoryChange) {
+            m_onInventoryChange(slot, m_inventory[idx]);
+        }
     }
 }
 
+bool Player::describeInventoryItem(InventorySlot slot, const ItemDescription& description) {
+    size_t idx = static_cast<size_t>(slot);
+    if (idx >= m_inventory.size()) return false;
+
+    std::shared_ptr<Item>& current = m_inventory[idx];
+    if (description.id == 0) {
+        if (!current) return false;
+        setInventoryItem(slot, nullptr);
+        return true;
+    }
+    if (current && current->matches(description)) return false;
+
+    if (current && current->getId() == description.id) {
+        current->setSubTypeFrom(description);
+        if (m_onInventoryChange) {
+            m_onInventoryChange(slot, current);
+        }
+    } else {
+        setInventoryItem(slot, Item::create(description));
+    }
+    return true;
+}
+
 uint16_t Player::getBestiaryKills(uint16_t monsterId) const {
     auto it = m_bestiaryKills.find(monsterId);
     return (it != m_bestiaryKills.end()) ? it->second : 0;
@@ -8,6 +8,7 @@
 
 #include "creature.h"
 #include <array>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -16,6 +17,7 @@ namespace shadow {
 namespace client {
 
 class Item;
+struct ItemDescription;
 
 // Inventory slots
 enum class InventorySlot : uint8_t {
@@ -120,6 +122,13 @@ public:
     // Inventory
     std::shared_ptr<Item> getInventoryItem(InventorySlot slot) const;
     void setInventoryItem(InventorySlot slot, std::shared_ptr<Item> item);
+    // A slot as the server re-sends it: the current object stays when the
+    // id is the same, and nothing changes if it already matches. Id 0
+    // empties the slot. False when the slot was already this.
+    bool describeInventoryItem(InventorySlot slot, const ItemDescription& description);
+
+    using InventoryChangeCallback = std::function<void(InventorySlot, const std::shared_ptr<Item>&)>;
+    void setOnInventoryChange(InventoryChangeCallback cb) { m_onInventoryChange = cb; }
 
     // Stamina
     uint16_t getStamina() const { return m_stamina; }
@@ -202,6 +211,7 @@ private:
 
     // Inventory
     std::array<std::shared_ptr<Item>, static_cast<size_t>(InventorySlot::Last)> m_inventory;
+    InventoryChangeCallback m_onInventoryChange;
 
     // States
     uint32_t m_states{0};
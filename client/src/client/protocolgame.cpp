@@ -10,8 +10,17 @@
 #include "localplayer.h"
 #include "effect.h"
 #include "missile.h"
+#include "thingtype.h"
 #include <framework/net/protocol.h>
 #include <framework/net/connection.h>
+#include <framework/net/connectionprewarmer.h>
+#include <framework/core/profiler.h>
+#include <framework/core/stringtable.h>
+#include <framework/input/inputmanager.h>
+#include <framework/luaengine/luainterface.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
 
 namespace shadow {
 namespace client {
@@ -23,7 +32,7 @@ ProtocolGame::~ProtocolGame() {
     disconnect();
 }
 
-bool ProtocolGame::connect(const std::string& host, uint16_t port,
+void ProtocolGame::connect(const std::string& host, uint16_t port,
                            const std::string& accountName, const std::string& password,
                            const std::string& characterName, uint32_t token) {
     m_accountName = accountName;
@@ -31,26 +40,37 @@ bool ProtocolGame::connect(const std::string& host, uint16_t port,
     m_characterName = characterName;
     m_accountToken = token;
 
-    m_connection = std::make_shared<Connection>();
+    // A connection opened while the realm or character was highlighted has
+    // the resolve and handshake behind it already
+    m_connection = g_prewarmer.take(host, port);
+    bool prewarmed = m_connection != nullptr;
+    if (!prewarmed) {
+        m_connection = std::make_shared<Connection>();
+    }
 
     // Set message callback to handle incoming packets
     m_connection->setMessageCallback([this](NetworkMessage& msg) {
         onRecvMessage(msg);
     });
 
-    m_connection->connect(host, port);
-    // Connection is async, check state
-    if (m_connection->getState() == ConnectionState::Error) {
-        return false;
+    // Resolve and connect finish off the main thread; poll() reports a
+    // failure to the game
+    m_connection->setConnectCallback([this](bool success, const std::string& error) {
+        if (!success && !m_detached) {
+            g_game.processConnectError(error);
+        }
+    });
+
+    if (!prewarmed) {
+        m_connection->connect(host, port);
     }
 
     m_connected = true;
     m_firstReceived = false;
+    m_pingPending = false;
 
     // Send initial login packet would go here
     // For now, we wait for server response
-
-    return true;
 }
 
 void ProtocolGame::disconnect() {
@@ -59,6 +79,8 @@ void ProtocolGame::disconnect() {
         m_connection = nullptr;
     }
     m_connected = false;
+    m_compressionRequested = false;
+    m_compressionActive = false;
 }
 
 bool ProtocolGame::isConnected() const {
@@ -66,15 +88,31 @@ bool ProtocolGame::isConnected() const {
 }
 
 void ProtocolGame::poll() {
-    if (!isConnected()) return;
+    ProfileScope scope(Profiler::StageProtocol);
 
-    // Poll the connection - this processes any pending callbacks
-    if (m_connection) {
-        m_connection->poll();
+    if (m_replaying) {
+        m_replayer.poll([this](NetworkMessage& frame) {
+            onRecvMessage(frame);
+        });
+        return;
     }
+
+    // Also while connecting, to hear how the attempt ended
+    if (!m_connected || !m_connection) return;
+
+    // Poll the connection - this processes any pending callbacks
+    m_connection->poll();
 }
 
 void ProtocolGame::onRecvMessage(NetworkMessage& msg) {
+    // Replayed frames were captured after decryption and inflation
+    if (m_replaying) {
+        while (!msg.isEof()) {
+            parsePacket(msg);
+        }
+        return;
+    }
+
     // Decrypt if XTEA is enabled
     if (m_xtea.isEnabled() && m_firstReceived) {
         m_xtea.decrypt(msg);
@@ -83,9 +121,30 @@ void ProtocolGame::onRecvMessage(NetworkMessage& msg) {
     // Skip packet size header
     msg.setPosition(NetworkMessage::HEADER_SIZE);
 
+    // Once negotiated, every frame body leads with a compression flag; large
+    // frames are inflated straight from the receive buffer into a pooled one
+    NetworkMessage* packet = &msg;
+    NetworkMessage inflated;
+    if (m_compressionActive && !msg.isEof()) {
+        uint8_t flag = msg.readByte();
+        if (flag == PacketCompression::FLAG_DEFLATE) {
+            size_t offset = msg.getPosition();
+            if (!m_compression.inflate(msg.getBuffer() + offset, msg.getSize() - offset, inflated)) {
+                return;
+            }
+            packet = &inflated;
+        } else {
+            m_compression.countRawFrame();
+        }
+    }
+
+    if (m_recorder.isOpen()) {
+        m_recorder.record(*packet);
+    }
+
     // Parse all messages in packet
-    while (!msg.isEof()) {
-        parsePacket(msg);
+    while (!packet->isEof()) {
+        parsePacket(*packet);
     }
 
     m_firstReceived = true;
@@ -95,177 +154,221 @@ void ProtocolGame::setXTEAKey(const std::array<uint32_t, 4>& key) {
     m_xtea.setKey(key);
 }
 
-void ProtocolGame::parsePacket(NetworkMessage& msg) {
-    uint8_t opcode = msg.readByte();
+bool ProtocolGame::startCapture(const std::string& path) {
+    return m_recorder.open(path);
+}
 
-    switch (opcode) {
-        case ServerOpcode::LoginError:
-            parseLoginError(msg);
-            break;
-        case ServerOpcode::LoginAdvice:
-            parseLoginAdvice(msg);
-            break;
-        case ServerOpcode::LoginWait:
-            parseLoginWait(msg);
-            break;
-        case ServerOpcode::LoginSuccess:
-            parseLoginSuccess(msg);
-            break;
-        case ServerOpcode::Ping:
-            parsePing(msg);
-            break;
-        case ServerOpcode::Death:
-            parseDeath(msg);
-            break;
+void ProtocolGame::stopCapture() {
+    m_recorder.close();
+}
 
-        // Map
-        case ServerOpcode::MapDescription:
-            parseMapDescription(msg);
-            break;
-        case ServerOpcode::MoveNorth:
-            parseMoveNorth(msg);
-            break;
-        case ServerOpcode::MoveEast:
-            parseMoveEast(msg);
-            break;
-        case ServerOpcode::MoveSouth:
-            parseMoveSouth(msg);
-            break;
-        case ServerOpcode::MoveWest:
-            parseMoveWest(msg);
-            break;
-        case ServerOpcode::UpdateTile:
-            parseUpdateTile(msg);
-            break;
+bool ProtocolGame::startReplay(const std::string& path, PacketReplayer::Speed speed) {
+    if (!m_replayer.open(path)) {
+        return false;
+    }
 
-        // Creatures
-        case ServerOpcode::CreatureMove:
-            parseCreatureMove(msg);
-            break;
-        case ServerOpcode::CreatureAppear:
-            parseCreatureAppear(msg);
-            break;
-        case ServerOpcode::CreatureDisappear:
-            parseCreatureDisappear(msg);
-            break;
-        case ServerOpcode::CreatureHealth:
-            parseCreatureHealth(msg);
-            break;
-        case ServerOpcode::CreatureLight:
-            parseCreatureLight(msg);
-            break;
-        case ServerOpcode::CreatureOutfit:
-            parseCreatureOutfit(msg);
-            break;
-        case ServerOpcode::CreatureSpeed:
-            parseCreatureSpeed(msg);
-            break;
-        case ServerOpcode::CreatureSkull:
-            parseCreatureSkull(msg);
-            break;
-        case ServerOpcode::CreatureShield:
-            parseCreatureShield(msg);
-            break;
-        case ServerOpcode::CreatureSquare:
-            parseCreatureSquare(msg);
-            break;
+    m_replayer.setSpeed(speed);
+    m_replaying = true;
+    return true;
+}
 
-        // Containers
-        case ServerOpcode::Container:
-            parseContainer(msg);
-            break;
-        case ServerOpcode::ContainerClose:
-            parseContainerClose(msg);
-            break;
-        case ServerOpcode::ContainerAddItem:
-            parseContainerAddItem(msg);
-            break;
-        case ServerOpcode::ContainerUpdateItem:
-            parseContainerUpdateItem(msg);
-            break;
-        case ServerOpcode::ContainerRemoveItem:
-            parseContainerRemoveItem(msg);
-            break;
+void ProtocolGame::stopReplay() {
+    m_replayer.close();
+    m_replaying = false;
+}
 
-        // Inventory
-        case ServerOpcode::Inventory:
-            parseInventory(msg);
-            break;
-        case ServerOpcode::InventoryEmpty:
-            parseInventoryEmpty(msg);
-            break;
+void ProtocolGame::requestCompression(uint16_t threshold) {
+    if (!m_connection || m_compressionActive) return;
 
-        // World
-        case ServerOpcode::WorldLight:
-            parseWorldLight(msg);
-            break;
-        case ServerOpcode::Effect:
-            parseEffect(msg);
-            break;
-        case ServerOpcode::Missile:
-            parseMissile(msg);
-            break;
-        case ServerOpcode::AnimatedText:
-            parseAnimatedText(msg);
-            break;
+    m_compression.setThreshold(threshold);
+    m_compressionRequested = true;
 
-        // Player
-        case ServerOpcode::PlayerStats:
-            parsePlayerStats(msg);
-            break;
-        case ServerOpcode::PlayerSkills:
-            parsePlayerSkills(msg);
-            break;
-        case ServerOpcode::Icons:
-            parseIcons(msg);
-            break;
-        case ServerOpcode::CancelTarget:
-            parseCancelTarget(msg);
-            break;
-        case ServerOpcode::CancelWalk:
-            parseCancelWalk(msg);
-            break;
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::ExtendedOpcode);
+    m_sendBuffer.writeByte(ExtendedOpcode::Compression);
+    m_sendBuffer.writeString(std::to_string(threshold));
 
-        // Chat
-        case ServerOpcode::SpeakType:
-            parseSpeakType(msg);
-            break;
-        case ServerOpcode::ChannelList:
-            parseChannelList(msg);
-            break;
-        case ServerOpcode::OpenChannel:
-            parseOpenChannel(msg);
-            break;
-        case ServerOpcode::PrivateChannel:
-            parsePrivateChannel(msg);
-            break;
-        case ServerOpcode::CloseChannel:
-            parseCloseChannel(msg);
-            break;
-        case ServerOpcode::TextMessage:
-            parseTextMessage(msg);
-            break;
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
 
-        // Dialogs
-        case ServerOpcode::OutfitDialog:
-            parseOutfitDialog(msg);
-            break;
+    m_connection->send(m_sendBuffer);
+}
 
-        // VIP
-        case ServerOpcode::VipLogin:
-            parseVipLogin(msg);
-            break;
-        case ServerOpcode::VipLogout:
-            parseVipLogout(msg);
-            break;
-        case ServerOpcode::VipState:
-            parseVipState(msg);
-            break;
+constexpr ProtocolGame::ParserTable ProtocolGame::buildParserTable() {
+    ParserTable table{};
 
-        default:
-            // Unknown opcode - skip remaining packet
-            break;
+    table[ServerOpcode::ExtendedOpcode] = &ProtocolGame::parseExtendedOpcode;
+    table[ServerOpcode::LoginError] = &ProtocolGame::parseLoginError;
+    table[ServerOpcode::LoginAdvice] = &ProtocolGame::parseLoginAdvice;
+    table[ServerOpcode::LoginWait] = &ProtocolGame::parseLoginWait;
+    table[ServerOpcode::LoginSuccess] = &ProtocolGame::parseLoginSuccess;
+    table[ServerOpcode::Ping] = &ProtocolGame::parsePing;
+    table[ServerOpcode::PingBack] = &ProtocolGame::parsePingBack;
+    table[ServerOpcode::Death] = &ProtocolGame::parseDeath;
+
+    // Map
+    table[ServerOpcode::MapDescription] = &ProtocolGame::parseMapDescription;
+    table[ServerOpcode::MoveNorth] = &ProtocolGame::parseMoveNorth;
+    table[ServerOpcode::MoveEast] = &ProtocolGame::parseMoveEast;
+    table[ServerOpcode::MoveSouth] = &ProtocolGame::parseMoveSouth;
+    table[ServerOpcode::MoveWest] = &ProtocolGame::parseMoveWest;
+    table[ServerOpcode::UpdateTile] = &ProtocolGame::parseUpdateTile;
+
+    // Creatures
+    table[ServerOpcode::CreatureMove] = &ProtocolGame::parseCreatureMove;
+    table[ServerOpcode::CreatureAppear] = &ProtocolGame::parseCreatureAppear;
+    table[ServerOpcode::CreatureDisappear] = &ProtocolGame::parseCreatureDisappear;
+    table[ServerOpcode::CreatureTurn] = &ProtocolGame::parseCreatureTurn;
+    table[ServerOpcode::CreatureHealth] = &ProtocolGame::parseCreatureHealth;
+    table[ServerOpcode::CreatureLight] = &ProtocolGame::parseCreatureLight;
+    table[ServerOpcode::CreatureOutfit] = &ProtocolGame::parseCreatureOutfit;
+    table[ServerOpcode::CreatureSpeed] = &ProtocolGame::parseCreatureSpeed;
+    table[ServerOpcode::CreatureSkull] = &ProtocolGame::parseCreatureSkull;
+    table[ServerOpcode::CreatureShield] = &ProtocolGame::parseCreatureShield;
+    table[ServerOpcode::CreatureSquare] = &ProtocolGame::parseCreatureSquare;
+
+    // Containers
+    table[ServerOpcode::Container] = &ProtocolGame::parseContainer;
+    table[ServerOpcode::ContainerClose] = &ProtocolGame::parseContainerClose;
+    table[ServerOpcode::ContainerAddItem] = &ProtocolGame::parseContainerAddItem;
+    table[ServerOpcode::ContainerUpdateItem] = &ProtocolGame::parseContainerUpdateItem;
+    table[ServerOpcode::ContainerRemoveItem] = &ProtocolGame::parseContainerRemoveItem;
+
+    // Inventory
+    table[ServerOpcode::Inventory] = &ProtocolGame::parseInventory;
+    table[ServerOpcode::InventoryEmpty] = &ProtocolGame::parseInventoryEmpty;
+
+    // World
+    table[ServerOpcode::WorldLight] = &ProtocolGame::parseWorldLight;
+    table[ServerOpcode::Effect] = &ProtocolGame::parseEffect;
+    table[ServerOpcode::Missile] = &ProtocolGame::parseMissile;
+    table[ServerOpcode::AnimatedText] = &ProtocolGame::parseAnimatedText;
+
+    // Player
+    table[ServerOpcode::PlayerStats] = &ProtocolGame::parsePlayerStats;
+    table[ServerOpcode::PlayerSkills] = &ProtocolGame::parsePlayerSkills;
+    table[ServerOpcode::Icons] = &ProtocolGame::parseIcons;
+    table[ServerOpcode::CancelTarget] = &ProtocolGame::parseCancelTarget;
+    table[ServerOpcode::CancelWalk] = &ProtocolGame::parseCancelWalk;
+
+    // Chat
+    table[ServerOpcode::SpeakType] = &ProtocolGame::parseSpeakType;
+    table[ServerOpcode::ChannelList] = &ProtocolGame::parseChannelList;
+    table[ServerOpcode::OpenChannel] = &ProtocolGame::parseOpenChannel;
+    table[ServerOpcode::PrivateChannel] = &ProtocolGame::parsePrivateChannel;
+    table[ServerOpcode::CloseChannel] = &ProtocolGame::parseCloseChannel;
+    table[ServerOpcode::TextMessage] = &ProtocolGame::parseTextMessage;
+
+    // Dialogs
+    table[ServerOpcode::OutfitDialog] = &ProtocolGame::parseOutfitDialog;
+
+    // VIP
+    table[ServerOpcode::VipLogin] = &ProtocolGame::parseVipLogin;
+    table[ServerOpcode::VipLogout] = &ProtocolGame::parseVipLogout;
+    table[ServerOpcode::VipState] = &ProtocolGame::parseVipState;
+
+    // Market
+    table[ServerOpcode::MarketBrowse] = &ProtocolGame::parseMarketBrowse;
+
+    return table;
+}
+
+constinit const ProtocolGame::ParserTable ProtocolGame::s_parsers = ProtocolGame::buildParserTable();
+
+void ProtocolGame::registerHandler(uint8_t opcode, PacketHandler handler) {
+    if (!m_handlers) {
+        m_handlers = std::make_unique<std::array<PacketHandler, 256>>();
+    }
+    (*m_handlers)[opcode] = std::move(handler);
+}
+
+void ProtocolGame::unregisterHandler(uint8_t opcode) {
+    if (m_handlers) {
+        (*m_handlers)[opcode] = nullptr;
+    }
+}
+
+bool ProtocolGame::hasHandler(uint8_t opcode) const {
+    return (m_handlers && (*m_handlers)[opcode]) || s_parsers[opcode];
+}
+
+void ProtocolGame::setOpcodeProfiling(bool enabled) {
+    if (enabled && !m_opcodeStats) {
+        m_opcodeStats = std::make_unique<std::array<OpcodeStats, 256>>();
+    }
+    m_opcodeProfiling = enabled;
+}
+
+const ProtocolGame::OpcodeStats& ProtocolGame::getOpcodeStats(uint8_t opcode) const {
+    static const OpcodeStats none;
+    return m_opcodeStats ? (*m_opcodeStats)[opcode] : none;
+}
+
+void ProtocolGame::resetOpcodeStats() {
+    if (m_opcodeStats) {
+        m_opcodeStats->fill(OpcodeStats{});
+    }
+    m_unknownOpcodes = 0;
+}
+
+void ProtocolGame::parsePacket(NetworkMessage& msg) {
+    uint8_t opcode = msg.readByte();
+    size_t start = msg.getPosition();
+    if (m_packetObserver) {
+        m_packetObserver(opcode, msg.getRemainingSize());
+    }
+
+    if (!m_opcodeProfiling) {
+        if (dispatchPacket(opcode, msg)) wakePacketTasks(opcode, msg, start);
+        return;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    bool handled = dispatchPacket(opcode, msg);
+    if (!handled) return;
+    wakePacketTasks(opcode, msg, start);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+
+    OpcodeStats& stats = (*m_opcodeStats)[opcode];
+    stats.calls++;
+    stats.bytes += 1 + msg.getPosition() - start;
+    stats.totalNs += elapsed;
+
+    size_t bucket = std::bit_width(static_cast<uint64_t>(elapsed / 1000));
+    stats.histogram[std::min(bucket, OpcodeStats::HISTOGRAM_BUCKETS - 1)]++;
+}
+
+// Scripts waiting on the opcode wake with its payload, once the parser
+// has applied it
+void ProtocolGame::wakePacketTasks(uint8_t opcode, const NetworkMessage& msg, size_t start) {
+    if (m_detached) return;
+
+    framework::LuaScheduler& scheduler = g_lua.getScheduler();
+    if (scheduler.isWaitingForPacket(opcode)) {
+        scheduler.signalPacket(opcode, msg.getBuffer() + start, msg.getPosition() - start);
+    }
+}
+
+bool ProtocolGame::dispatchPacket(uint8_t opcode, NetworkMessage& msg) {
+    if (m_handlers) {
+        if (const auto& handler = (*m_handlers)[opcode]) {
+            handler(msg);
+            return true;
+        }
     }
+
+    if (Parser parser = s_parsers[opcode]) {
+        (this->*parser)(msg);
+        return true;
+    }
+
+    // Unknown opcode - the rest of the frame can't be framed, skip it
+    m_unknownOpcodes++;
+    msg.setPosition(msg.getSize());
+    return false;
 }
 
 // Helper methods
@@ -277,15 +380,14 @@ Position ProtocolGame::parsePosition(NetworkMessage& msg) {
     return Position(x, y, z);
 }
 
-ItemPtr ProtocolGame::parseItem(NetworkMessage& msg) {
-    uint16_t itemId = msg.readU16();
-    if (itemId == 0) return nullptr;
-
-    auto item = Item::create(itemId);
+ItemDescription ProtocolGame::parseItemDescription(NetworkMessage& msg) {
+    ItemDescription description;
+    description.id = msg.readU16();
+    if (description.id == 0) return description;
 
-    auto* type = item->getThingType();
+    auto* type = ThingTypeManager::instance().getItemType(description.id);
     if (type && type->isStackable()) {
-        item->setCount(msg.readByte());
+        description.subType = msg.readByte();
     }
 
     // Animation phase for animated items
@@ -293,7 +395,13 @@ ItemPtr ProtocolGame::parseItem(NetworkMessage& msg) {
         msg.readByte(); // animation phase
     }
 
-    return item;
+    return description;
+}
+
+ItemPtr ProtocolGame::parseItem(NetworkMessage& msg) {
+    ItemDescription description = parseItemDescription(msg);
+    if (description.id == 0 || m_detached) return nullptr;
+    return Item::create(description);
 }
 
 Outfit ProtocolGame::parseOutfitData(NetworkMessage& msg) {
@@ -316,13 +424,45 @@ Outfit ProtocolGame::parseOutfitData(NetworkMessage& msg) {
 }
 
 CreaturePtr ProtocolGame::parseCreature(NetworkMessage& msg, uint16_t type) {
-    CreaturePtr creature;
-
+    // The whole description is read before anything is looked up, so a
+    // creature the client does not know still leaves the message framed
+    uint32_t removeId = 0;
+    uint32_t id = 0;
+    uint8_t creatureType = 0;
+    std::string_view name;
     if (type == 0x61) {
         // New creature
-        uint32_t removeId = msg.readU32();
-        uint32_t id = msg.readU32();
+        removeId = msg.readU32();
+        id = msg.readU32();
+        creatureType = msg.readByte();
+        name = msg.readStringView();
+    } else {
+        // Known creature (0x62) or creature turn (0x63)
+        id = msg.readU32();
+    }
+
+    uint8_t healthPercent = msg.readByte();
+    auto direction = static_cast<Position::Direction>(msg.readByte());
+    Outfit outfit = parseOutfitData(msg);
+    uint8_t lightIntensity = msg.readByte();
+    uint8_t lightColor = msg.readByte();
+    uint16_t speed = msg.readU16();
+    auto skull = static_cast<Creature::Skull>(msg.readByte());
+    auto shield = static_cast<Creature::Shield>(msg.readByte());
 
+    // Emblem (if new creature)
+    if (type == 0x61) {
+        msg.readByte(); // emblem
+    }
+
+    // Unpassable
+    msg.readByte(); // unpassable
+
+    if (m_detached) return nullptr;
+
+    CreaturePtr creature;
+
+    if (type == 0x61) {
         // Remove old creature if exists
         if (removeId != 0) {
             auto old = g_map.getCreatureById(removeId);
@@ -332,11 +472,23 @@ CreaturePtr ProtocolGame::parseCreature(NetworkMessage& msg, uint16_t type) {
                     tile->removeCreature(old);
                 }
             }
+            g_map.removeCreature(removeId);
         }
 
-        uint8_t creatureType = msg.readByte();
+        // Sent in full after the server dropped the id; the client may
+        // still know it, and players need a Player object
+        creature = g_map.reviveCreature(id);
+        if (creature && creature->isPlayer() != (creatureType == 0)) {
+            creature = nullptr;
+        }
 
-        if (creatureType == 0) {
+        if (creature) {
+            if (creatureType == 1) {
+                creature->setType(CreatureType::Monster);
+            } else if (creatureType != 0) {
+                creature->setType(CreatureType::Npc);
+            }
+        } else if (creatureType == 0) {
             // Player
             creature = Player::create(id);
         } else if (creatureType == 1) {
@@ -349,59 +501,36 @@ CreaturePtr ProtocolGame::parseCreature(NetworkMessage& msg, uint16_t type) {
             creature->setType(CreatureType::Npc);
         }
 
-        creature->setName(msg.readString());
+        creature->setName(name);
+        g_map.addCreature(creature);
     } else if (type == 0x62) {
-        // Known creature
-        uint32_t id = msg.readU32();
-        creature = g_map.getCreatureById(id);
+        creature = g_map.reviveCreature(id);
         if (!creature) {
             creature = Creature::create(id);
+            g_map.addCreature(creature);
         }
     } else if (type == 0x63) {
-        // Creature turn
-        uint32_t id = msg.readU32();
         creature = g_map.getCreatureById(id);
     }
 
     if (!creature) return nullptr;
 
-    // Health percent
-    creature->setHealthPercent(msg.readByte());
-
-    // Direction
-    creature->setDirection(static_cast<Position::Direction>(msg.readByte()));
-
-    // Outfit
-    creature->setOutfit(parseOutfitData(msg));
-
-    // Light
-    uint8_t lightIntensity = msg.readByte();
-    uint8_t lightColor = msg.readByte();
+    creature->setHealthPercent(healthPercent);
+    creature->setDirection(direction);
+    creature->setOutfit(outfit);
     creature->setLight(lightIntensity, lightColor);
-
-    // Speed
-    creature->setSpeed(msg.readU16());
-
-    // Skull
-    creature->setSkull(static_cast<Creature::Skull>(msg.readByte()));
-
-    // Shield (party)
-    creature->setShield(static_cast<Creature::Shield>(msg.readByte()));
-
-    // Emblem (if new creature)
-    if (type == 0x61) {
-        msg.readByte(); // emblem
-    }
-
-    // Unpassable
-    msg.readByte(); // unpassable
+    creature->setSpeed(speed);
+    creature->setSkull(skull);
+    creature->setShield(shield);
 
     return creature;
 }
 
 int ProtocolGame::parseTileDescription(NetworkMessage& msg, const Position& pos) {
-    auto& map = g_map;
-    auto tile = map.getOrCreateTile(pos);
+    MapAreaStage::StagedTile staged;
+    staged.pos = pos;
+    staged.firstThing = static_cast<uint32_t>(m_mapStage.things.size());
+    staged.firstCreature = static_cast<uint32_t>(m_mapStage.creatures.size());
 
     int things = 0;
     bool finished = false;
@@ -415,17 +544,19 @@ int ProtocolGame::parseTileDescription(NetworkMessage& msg, const Position& pos)
         } else if (id == 0x61 || id == 0x62 || id == 0x63) {
             // Creature
             msg.readU16(); // consume id
+            // Counts toward the tile's things whether or not it was kept
             auto creature = parseCreature(msg, id);
             if (creature) {
-                tile->addCreature(creature);
-                creature->setPosition(pos);
-                things++;
+                m_mapStage.creatures.push_back(std::move(creature));
+                staged.creatureCount++;
             }
+            things++;
         } else {
-            // Item
-            auto item = parseItem(msg);
-            if (item) {
-                tile->addItem(item);
+            // The map keeps the tile's current object when it is unchanged
+            ItemDescription thing = parseItemDescription(msg);
+            if (thing.id != 0) {
+                m_mapStage.things.push_back(thing);
+                staged.thingCount++;
                 things++;
             }
         }
@@ -436,16 +567,19 @@ int ProtocolGame::parseTileDescription(NetworkMessage& msg, const Position& pos)
         }
     }
 
+    m_mapStage.tiles.push_back(staged);
     return things;
 }
 
 void ProtocolGame::parseMapArea(NetworkMessage& msg, const Position& pos, int width, int height) {
     Position start = pos;
     Position end(pos.x + width - 1, pos.y + height - 1, pos.z);
+    int lastZ = pos.z == 7 ? 7 : pos.z + 2;
 
     int skipTiles = 0;
+    m_mapStage.clear();
 
-    for (int z = pos.z; z <= (pos.z == 7 ? 7 : pos.z + 2); ++z) {
+    for (int z = pos.z; z <= lastZ; ++z) {
         for (int x = start.x; x <= end.x; ++x) {
             for (int y = start.y; y <= end.y; ++y) {
                 if (skipTiles > 0) {
@@ -466,37 +600,86 @@ void ProtocolGame::parseMapArea(NetworkMessage& msg, const Position& pos, int wi
             }
         }
     }
+
+    if (!m_detached) {
+        g_map.commitArea(m_mapStage, start, Position(end.x, end.y, lastZ));
+    }
+}
+
+std::shared_ptr<LocalPlayer> ProtocolGame::localPlayer() const {
+    return m_detached ? nullptr : g_game.getLocalPlayer();
+}
+
+CreaturePtr ProtocolGame::findCreature(uint32_t id) const {
+    return m_detached ? nullptr : g_map.getCreatureById(id);
+}
+
+std::shared_ptr<Tile> ProtocolGame::findTile(const Position& pos) const {
+    return m_detached ? nullptr : g_map.getTile(pos);
+}
+
+std::shared_ptr<Container> ProtocolGame::findContainer(uint8_t id) const {
+    return m_detached ? nullptr : g_containers.getContainer(id);
+}
+
+const Position& ProtocolGame::centralPosition() const {
+    return m_detached ? m_centralPosition : g_map.getCentralPosition();
+}
+
+void ProtocolGame::setCentralPosition(const Position& pos) {
+    if (m_detached) {
+        m_centralPosition = pos;
+    } else {
+        g_map.setCentralPosition(pos);
+    }
 }
 
 // Login packets
 
+void ProtocolGame::parseExtendedOpcode(NetworkMessage& msg) {
+    uint8_t extendedOpcode = msg.readByte();
+    std::string_view payload = msg.readStringView();
+
+    if (extendedOpcode == ExtendedOpcode::Compression && m_compressionRequested) {
+        // "1" acknowledges; frames after this packet carry the flag byte
+        m_compressionActive = payload == "1";
+        m_compressionRequested = false;
+    }
+}
+
 void ProtocolGame::parseLoginError(NetworkMessage& msg) {
-    std::string error = msg.readString();
+    std::string_view error = msg.readStringView();
+    (void)error;
     // Notify game of login error
-    g_game.processLogout();
+    if (!m_detached) {
+        g_game.processLogout();
+    }
 }
 
 void ProtocolGame::parseLoginAdvice(NetworkMessage& msg) {
-    std::string advice = msg.readString();
+    std::string_view advice = msg.readStringView();
+    (void)advice;
     // Display advice message
 }
 
 void ProtocolGame::parseLoginWait(NetworkMessage& msg) {
-    std::string message = msg.readString();
+    std::string_view message = msg.readStringView();
     uint8_t time = msg.readByte();
+    (void)message;
     // Show waiting dialog
 }
 
 void ProtocolGame::parseLoginSuccess(NetworkMessage& msg) {
     uint32_t playerId = msg.readU32();
 
-    // Create local player
-    auto localPlayer = LocalPlayer::create(playerId);
-    g_game.setLocalPlayer(localPlayer);
-
     // Beat duration for ping calculation
     uint16_t beatDuration = msg.readU16();
 
+    if (m_detached) return;
+
+    // Create local player
+    g_game.setLocalPlayer(LocalPlayer::create(playerId));
+
     // Game started
     g_game.processLogin();
 }
@@ -506,7 +689,12 @@ void ProtocolGame::parsePing(NetworkMessage& msg) {
 }
 
 void ProtocolGame::parsePingBack(NetworkMessage& msg) {
-    // Update latency
+    if (!m_pingPending) return;
+    m_pingPending = false;
+    if (m_connection) {
+        m_connection->recordRoundTrip(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_pingSentAt));
+    }
 }
 
 void ProtocolGame::parseDeath(NetworkMessage& msg) {
@@ -514,7 +702,7 @@ void ProtocolGame::parseDeath(NetworkMessage& msg) {
     uint8_t penalty = msg.readByte();
 
     // Show death dialog
-    if (g_game.onDeath) {
+    if (!m_detached && g_game.onDeath) {
         g_game.onDeath(deathType, penalty);
     }
 }
@@ -524,47 +712,47 @@ void ProtocolGame::parseDeath(NetworkMessage& msg) {
 void ProtocolGame::parseMapDescription(NetworkMessage& msg) {
     Position pos = parsePosition(msg);
 
-    g_map.setCentralPosition(pos);
+    setCentralPosition(pos);
 
     // Parse visible area (18x14 tiles, 8 floors)
     parseMapArea(msg, Position(pos.x - 8, pos.y - 6, pos.z), 18, 14);
 }
 
 void ProtocolGame::parseMoveNorth(NetworkMessage& msg) {
-    auto& pos = g_map.getCentralPosition();
+    auto& pos = centralPosition();
     Position newPos(pos.x, pos.y - 1, pos.z);
 
-    g_map.setCentralPosition(newPos);
+    setCentralPosition(newPos);
 
     // Parse new row at north
     parseMapArea(msg, Position(newPos.x - 8, newPos.y - 6, newPos.z), 18, 1);
 }
 
 void ProtocolGame::parseMoveEast(NetworkMessage& msg) {
-    auto& pos = g_map.getCentralPosition();
+    auto& pos = centralPosition();
     Position newPos(pos.x + 1, pos.y, pos.z);
 
-    g_map.setCentralPosition(newPos);
+    setCentralPosition(newPos);
 
     // Parse new column at east
     parseMapArea(msg, Position(newPos.x + 9, newPos.y - 6, newPos.z), 1, 14);
 }
 
 void ProtocolGame::parseMoveSouth(NetworkMessage& msg) {
-    auto& pos = g_map.getCentralPosition();
+    auto& pos = centralPosition();
     Position newPos(pos.x, pos.y + 1, pos.z);
 
-    g_map.setCentralPosition(newPos);
+    setCentralPosition(newPos);
 
     // Parse new row at south
     parseMapArea(msg, Position(newPos.x - 8, newPos.y + 7, newPos.z), 18, 1);
 }
 
 void ProtocolGame::parseMoveWest(NetworkMessage& msg) {
-    auto& pos = g_map.getCentralPosition();
+    auto& pos = centralPosition();
     Position newPos(pos.x - 1, pos.y, pos.z);
 
-    g_map.setCentralPosition(newPos);
+    setCentralPosition(newPos);
 
     // Parse new column at west
     parseMapArea(msg, Position(newPos.x - 8, newPos.y - 6, newPos.z), 1, 14);
@@ -574,19 +762,28 @@ void ProtocolGame::parseUpdateTile(NetworkMessage& msg) {
     Position pos = parsePosition(msg);
 
     // Clear existing tile
-    g_map.cleanTile(pos);
+    if (!m_detached) {
+        g_map.cleanTile(pos);
+    }
 
     // Parse tile contents
     uint16_t peek = msg.peekU16();
     if (peek != 0xFF01) {
+        m_mapStage.clear();
         parseTileDescription(msg, pos);
+        if (!m_detached) {
+            g_map.commitArea(m_mapStage, pos, pos);
+        }
     } else {
         msg.readU16(); // consume end marker
+        if (auto tile = findTile(pos)) {
+            g_map.updateMinimapTile(*tile);
+        }
     }
 }
 
 void ProtocolGame::parseFloorChange(NetworkMessage& msg, uint8_t direction) {
-    auto& pos = g_map.getCentralPosition();
+    auto& pos = centralPosition();
     Position newPos = pos;
 
     if (direction == ServerOpcode::FloorChange) {
@@ -605,7 +802,17 @@ void ProtocolGame::parseCreatureMove(NetworkMessage& msg) {
     uint8_t fromStackPos = msg.readByte();
     Position toPos = parsePosition(msg);
 
-    auto tile = g_map.getTile(fromPos);
+    // A predicted step is already on screen, and the player is no longer
+    // on fromPos. Any other move from the confirmed position drops the
+    // prediction first, so the player is found there.
+    if (auto player = localPlayer(); player && player->isPreWalking()) {
+        if (player->confirmStep(fromPos, toPos)) return;
+        if (fromPos == player->getServerPosition()) {
+            player->cancelPreWalk();
+        }
+    }
+
+    auto tile = findTile(fromPos);
     if (!tile) return;
 
     auto thing = tile->getThing(fromStackPos);
@@ -628,7 +835,7 @@ void ProtocolGame::parseCreatureTurn(NetworkMessage& msg) {
     uint8_t stackPos = msg.readByte();
     auto direction = static_cast<Position::Direction>(msg.readByte());
 
-    auto tile = g_map.getTile(pos);
+    auto tile = findTile(pos);
     if (!tile) return;
 
     auto thing = tile->getThing(stackPos);
@@ -648,7 +855,7 @@ void ProtocolGame::parseCreatureDisappear(NetworkMessage& msg) {
     Position pos = parsePosition(msg);
     uint8_t stackPos = msg.readByte();
 
-    auto tile = g_map.getTile(pos);
+    auto tile = findTile(pos);
     if (!tile) return;
 
     auto thing = tile->getThing(stackPos);
@@ -665,7 +872,7 @@ void ProtocolGame::parseCreatureHealth(NetworkMessage& msg) {
     uint32_t id = msg.readU32();
     uint8_t percent = msg.readByte();
 
-    auto creature = g_map.getCreatureById(id);
+    auto creature = findCreature(id);
     if (creature) {
         creature->setHealthPercent(percent);
     }
@@ -676,7 +883,7 @@ void ProtocolGame::parseCreatureLight(NetworkMessage& msg) {
     uint8_t intensity = msg.readByte();
     uint8_t color = msg.readByte();
 
-    auto creature = g_map.getCreatureById(id);
+    auto creature = findCreature(id);
     if (creature) {
         creature->setLight(intensity, color);
     }
@@ -686,7 +893,7 @@ void ProtocolGame::parseCreatureOutfit(NetworkMessage& msg) {
     uint32_t id = msg.readU32();
     Outfit outfit = parseOutfitData(msg);
 
-    auto creature = g_map.getCreatureById(id);
+    auto creature = findCreature(id);
     if (creature) {
         creature->setOutfit(outfit);
     }
@@ -697,7 +904,7 @@ void ProtocolGame::parseCreatureSpeed(NetworkMessage& msg) {
     uint16_t baseSpeed = msg.readU16();
     uint16_t speed = msg.readU16();
 
-    auto creature = g_map.getCreatureById(id);
+    auto creature = findCreature(id);
     if (creature) {
         creature->setSpeed(speed);
     }
@@ -707,7 +914,7 @@ void ProtocolGame::parseCreatureSkull(NetworkMessage& msg) {
     uint32_t id = msg.readU32();
     uint8_t skull = msg.readByte();
 
-    auto creature = g_map.getCreatureById(id);
+    auto creature = findCreature(id);
     if (creature) {
         creature->setSkull(static_cast<Creature::Skull>(skull));
     }
@@ -717,7 +924,7 @@ void ProtocolGame::parseCreatureShield(NetworkMessage& msg) {
     uint32_t id = msg.readU32();
     uint8_t shield = msg.readByte();
 
-    auto creature = g_map.getCreatureById(id);
+    auto creature = findCreature(id);
     if (creature) {
         creature->setShield(static_cast<Creature::Shield>(shield));
     }
@@ -727,7 +934,7 @@ void ProtocolGame::parseCreatureSquare(NetworkMessage& msg) {
     uint32_t id = msg.readU32();
     uint8_t color = msg.readByte();
 
-    auto creature = g_map.getCreatureById(id);
+    auto creature = findCreature(id);
     if (creature) {
         creature->setSquare(color);
     }
@@ -738,7 +945,7 @@ void ProtocolGame::parseCreatureSquare(NetworkMessage& msg) {
 void ProtocolGame::parseContainer(NetworkMessage& msg) {
     uint8_t containerId = msg.readByte();
     uint16_t containerItemId = msg.readU16();
-    std::string name = msg.readString();
+    std::string_view name = msg.readStringView();
     uint8_t capacity = msg.readByte();
     bool hasParent = msg.readByte() != 0;
     bool canUseDepotSearch = msg.readByte() != 0;
@@ -753,23 +960,38 @@ void ProtocolGame::parseContainer(NetworkMessage& msg) {
         itemCount = msg.readU16();
     }
 
-    auto container = g_containers.createContainer(containerId);
-    container->setContainerItemId(containerItemId);
-    container->setName(name);
-    container->setCapacity(capacity);
-    container->setHasParent(hasParent);
-
+    m_itemScratch.clear();
     for (uint16_t i = 0; i < itemCount; ++i) {
-        auto item = parseItem(msg);
-        if (item) {
-            container->addItem(item);
+        ItemDescription item = parseItemDescription(msg);
+        if (item.id != 0) {
+            m_itemScratch.push_back(item);
         }
     }
+
+    if (m_detached) return;
+
+    // The server re-sends open containers whole; the same container comes
+    // back as slot changes against what is shown
+    auto container = findContainer(containerId);
+    bool reopened = container && container->getContainerItemId() == containerItemId &&
+                    container->getName() == name && container->getCapacity() == capacity;
+    if (!reopened) {
+        container = g_containers.createContainer(containerId);
+        container->setContainerItemId(containerItemId);
+        container->setName(std::string(name));
+        container->setCapacity(capacity);
+    }
+    container->setHasParent(hasParent);
+    container->setPagination(isPaginationEnabled);
+    container->setFirstIndex(startIndex);
+    container->setItems(m_itemScratch.data(), m_itemScratch.size());
 }
 
 void ProtocolGame::parseContainerClose(NetworkMessage& msg) {
     uint8_t containerId = msg.readByte();
-    g_containers.removeContainer(containerId);
+    if (!m_detached) {
+        g_containers.removeContainer(containerId);
+    }
 }
 
 void ProtocolGame::parseContainerAddItem(NetworkMessage& msg) {
@@ -777,7 +999,7 @@ void ProtocolGame::parseContainerAddItem(NetworkMessage& msg) {
     uint16_t slot = msg.readU16();
     auto item = parseItem(msg);
 
-    auto container = g_containers.getContainer(containerId);
+    auto container = findContainer(containerId);
     if (container && item) {
         container->insertItem(slot, item);
     }
@@ -786,10 +1008,10 @@ void ProtocolGame::parseContainerAddItem(NetworkMessage& msg) {
 void ProtocolGame::parseContainerUpdateItem(NetworkMessage& msg) {
     uint8_t containerId = msg.readByte();
     uint16_t slot = msg.readU16();
-    auto item = parseItem(msg);
+    ItemDescription item = parseItemDescription(msg);
 
-    auto container = g_containers.getContainer(containerId);
-    if (container && item) {
+    auto container = findContainer(containerId);
+    if (container && item.id != 0) {
         container->updateItem(slot, item);
     }
 }
@@ -798,7 +1020,7 @@ void ProtocolGame::parseContainerRemoveItem(NetworkMessage& msg) {
     uint8_t containerId = msg.readByte();
     uint16_t slot = msg.readU16();
 
-    auto container = g_containers.getContainer(containerId);
+    auto container = findContainer(containerId);
     if (container) {
         container->removeItem(slot);
     }
@@ -814,18 +1036,18 @@ void ProtocolGame::parseContainerRemoveItem(NetworkMessage& msg) {
 
 void ProtocolGame::parseInventory(NetworkMessage& msg) {
     uint8_t slot = msg.readByte();
-    auto item = parseItem(msg);
+    ItemDescription item = parseItemDescription(msg);
 
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
-        player->setInventoryItem(static_cast<InventorySlot>(slot), item);
+        player->describeInventoryItem(static_cast<InventorySlot>(slot), item);
     }
 }
 
 void ProtocolGame::parseInventoryEmpty(NetworkMessage& msg) {
     uint8_t slot = msg.readByte();
 
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         player->setInventoryItem(static_cast<InventorySlot>(slot), nullptr);
     }
@@ -837,14 +1059,18 @@ void ProtocolGame::parseWorldLight(NetworkMessage& msg) {
     uint8_t intensity = msg.readByte();
     uint8_t color = msg.readByte();
 
-    g_map.setWorldLight(intensity, color);
+    if (!m_detached) {
+        g_map.setWorldLight(intensity, color);
+    }
 }
 
 void ProtocolGame::parseEffect(NetworkMessage& msg) {
     Position pos = parsePosition(msg);
     uint8_t effectId = msg.readByte();
 
-    g_effects.createEffect(effectId, pos);
+    if (!m_detached) {
+        g_effects.createEffect(effectId, pos);
+    }
 }
 
 void ProtocolGame::parseMissile(NetworkMessage& msg) {
@@ -852,16 +1078,18 @@ void ProtocolGame::parseMissile(NetworkMessage& msg) {
     Position to = parsePosition(msg);
     uint8_t missileId = msg.readByte();
 
-    g_missiles.createMissile(missileId, from, to);
+    if (!m_detached) {
+        g_missiles.createMissile(missileId, from, to);
+    }
 }
 
 void ProtocolGame::parseAnimatedText(NetworkMessage& msg) {
     Position pos = parsePosition(msg);
     uint8_t color = msg.readByte();
-    std::string text = msg.readString();
+    std::string_view text = msg.readStringView();
 
     // Create animated text at position
-    if (g_game.onAnimatedText) {
+    if (!m_detached && g_game.onAnimatedText) {
         g_game.onAnimatedText(pos, color, text);
     }
 }
@@ -869,62 +1097,56 @@ void ProtocolGame::parseAnimatedText(NetworkMessage& msg) {
 // Player packets
 
 void ProtocolGame::parsePlayerStats(NetworkMessage& msg) {
-    auto player = g_game.getLocalPlayer();
-    if (!player) return;
-
     uint16_t health = msg.readU16();
     uint16_t maxHealth = msg.readU16();
-    player->setHealth(health, maxHealth);
-
     uint32_t freeCapacity = msg.readU32();
-
     uint64_t experience = msg.readU64();
-
     uint16_t level = msg.readU16();
     uint8_t levelPercent = msg.readByte();
-    player->setLevel(level);
-    player->setLevelPercent(levelPercent);
-
     uint16_t mana = msg.readU16();
     uint16_t maxMana = msg.readU16();
-    player->setMana(mana, maxMana);
-
     uint8_t magicLevel = msg.readByte();
     uint8_t baseMagicLevel = msg.readByte();
     uint8_t magicLevelPercent = msg.readByte();
-    player->setMagicLevel(magicLevel, baseMagicLevel);
-
     uint8_t soul = msg.readByte();
-    player->setSoul(soul);
-
     uint16_t stamina = msg.readU16();
-    player->setStamina(stamina);
-
     uint16_t baseSpeed = msg.readU16();
-    player->setSpeed(baseSpeed);
-
     uint16_t regeneration = msg.readU16();
     uint16_t offlineTraining = msg.readU16();
+
+    auto player = localPlayer();
+    if (!player) return;
+
+    player->setHealth(health, maxHealth);
+    player->setLevel(level);
+    player->setLevelPercent(levelPercent);
+    player->setMana(mana, maxMana);
+    player->setMagicLevel(magicLevel, baseMagicLevel);
+    player->setSoul(soul);
+    player->setStamina(stamina);
+    player->setSpeed(baseSpeed);
 }
 
 void ProtocolGame::parsePlayerSkills(NetworkMessage& msg) {
-    auto player = g_game.getLocalPlayer();
-    if (!player) return;
+    auto player = localPlayer();
 
+    // Read whether or not there is a player to apply them to
     for (int i = 0; i <= static_cast<int>(Skill::Fishing); ++i) {
         uint16_t level = msg.readU16();
         uint16_t baseLevel = msg.readU16();
         uint8_t percent = msg.readByte();
 
-        player->setSkill(static_cast<Skill>(i), level, baseLevel,
-                        static_cast<float>(percent));
+        if (player) {
+            player->setSkill(static_cast<Skill>(i), level, baseLevel,
+                             static_cast<float>(percent));
+        }
     }
 }
 
 void ProtocolGame::parseIcons(NetworkMessage& msg) {
     uint32_t icons = msg.readU32();
 
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         player->setStates(icons);
     }
@@ -932,13 +1154,15 @@ void ProtocolGame::parseIcons(NetworkMessage& msg) {
 
 void ProtocolGame::parseCancelTarget(NetworkMessage& msg) {
     uint32_t sequence = msg.readU32();
-    g_game.cancelAttackAndFollow();
+    if (!m_detached) {
+        g_game.cancelAttackAndFollow();
+    }
 }
 
 void ProtocolGame::parseCancelWalk(NetworkMessage& msg) {
     auto direction = static_cast<Position::Direction>(msg.readByte());
 
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         player->cancelPreWalk();
         player->setDirection(direction);
@@ -949,7 +1173,7 @@ void ProtocolGame::parseCancelWalk(NetworkMessage& msg) {
 
 void ProtocolGame::parseSpeakType(NetworkMessage& msg) {
     uint32_t statementId = msg.readU32();
-    std::string senderName = msg.readString();
+    std::string_view senderName = msg.readStringView();
     uint16_t level = msg.readU16();
     auto speakType = static_cast<SpeakType>(msg.readByte());
 
@@ -975,9 +1199,9 @@ void ProtocolGame::parseSpeakType(NetworkMessage& msg) {
             break;
     }
 
-    std::string text = msg.readString();
+    std::string_view text = msg.readStringView();
 
-    if (g_game.onTalk) {
+    if (!m_detached && g_game.onTalk) {
         g_game.onTalk(senderName, level, static_cast<uint8_t>(speakType), pos, channelId, text);
     }
 }
@@ -985,42 +1209,42 @@ void ProtocolGame::parseSpeakType(NetworkMessage& msg) {
 void ProtocolGame::parseChannelList(NetworkMessage& msg) {
     uint8_t count = msg.readByte();
 
-    std::vector<std::pair<uint16_t, std::string>> channels;
+    std::vector<std::pair<uint16_t, std::string_view>> channels;
+    channels.reserve(count);
     for (int i = 0; i < count; ++i) {
         uint16_t id = msg.readU16();
-        std::string name = msg.readString();
-        channels.emplace_back(id, name);
+        channels.emplace_back(id, msg.readStringView());
     }
 
-    if (g_game.onChannelList) {
+    if (!m_detached && g_game.onChannelList) {
         g_game.onChannelList(channels);
     }
 }
 
 void ProtocolGame::parseOpenChannel(NetworkMessage& msg) {
     uint16_t channelId = msg.readU16();
-    std::string channelName = msg.readString();
+    std::string_view channelName = msg.readStringView();
 
     // Read participants
     uint16_t joinedCount = msg.readU16();
     for (int i = 0; i < joinedCount; ++i) {
-        msg.readString(); // player name
+        msg.readStringView(); // player name
     }
 
     uint16_t invitedCount = msg.readU16();
     for (int i = 0; i < invitedCount; ++i) {
-        msg.readString(); // player name
+        msg.readStringView(); // player name
     }
 
-    if (g_game.onOpenChannel) {
+    if (!m_detached && g_game.onOpenChannel) {
         g_game.onOpenChannel(channelId, channelName);
     }
 }
 
 void ProtocolGame::parsePrivateChannel(NetworkMessage& msg) {
-    std::string name = msg.readString();
+    std::string_view name = msg.readStringView();
 
-    if (g_game.onOpenPrivateChannel) {
+    if (!m_detached && g_game.onOpenPrivateChannel) {
         g_game.onOpenPrivateChannel(0, name);  // Private channel with ID 0
     }
 }
@@ -1028,16 +1252,16 @@ void ProtocolGame::parsePrivateChannel(NetworkMessage& msg) {
 void ProtocolGame::parseCloseChannel(NetworkMessage& msg) {
     uint16_t channelId = msg.readU16();
 
-    if (g_game.onCloseChannel) {
+    if (!m_detached && g_game.onCloseChannel) {
         g_game.onCloseChannel(channelId);
     }
 }
 
 void ProtocolGame::parseTextMessage(NetworkMessage& msg) {
     auto type = static_cast<TextMessageType>(msg.readByte());
-    std::string text = msg.readString();
+    std::string_view text = msg.readStringView();
 
-    if (g_game.onTextMessage) {
+    if (!m_detached && g_game.onTextMessage) {
         g_game.onTextMessage(static_cast<uint8_t>(type), text);
     }
 }
@@ -1049,11 +1273,12 @@ void ProtocolGame::parseOutfitDialog(NetworkMessage& msg) {
 
     // Available outfits
     uint16_t count = msg.readU16();
-    std::vector<std::pair<uint16_t, std::string>> outfits;
+    std::vector<std::pair<uint16_t, std::string_view>> outfits;
+    outfits.reserve(count);
 
     for (int i = 0; i < count; ++i) {
         uint16_t lookType = msg.readU16();
-        std::string name = msg.readString();
+        std::string_view name = g_strings.intern(msg.readStringView()).view();
         uint8_t addons = msg.readByte();
         msg.readByte(); // locked
         msg.readU32(); // store offer id
@@ -1063,18 +1288,19 @@ void ProtocolGame::parseOutfitDialog(NetworkMessage& msg) {
 
     // Available mounts
     uint16_t mountCount = msg.readU16();
-    std::vector<std::pair<uint16_t, std::string>> mounts;
+    std::vector<std::pair<uint16_t, std::string_view>> mounts;
+    mounts.reserve(mountCount);
 
     for (int i = 0; i < mountCount; ++i) {
         uint16_t mountId = msg.readU16();
-        std::string name = msg.readString();
+        std::string_view name = g_strings.intern(msg.readStringView()).view();
         msg.readByte(); // locked
         msg.readU32(); // store offer id
 
         mounts.emplace_back(mountId, name);
     }
 
-    if (g_game.onOutfitDialog) {
+    if (!m_detached && g_game.onOutfitDialog) {
         g_game.onOutfitDialog(currentOutfit, outfits, mounts);
     }
 }
@@ -1084,12 +1310,12 @@ void ProtocolGame::parseOutfitDialog(NetworkMessage& msg) {
 void ProtocolGame::parseVipLogin(NetworkMessage& msg) {
     uint32_t playerId = msg.readU32();
 
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         player->setVIPOnline(playerId, true);
     }
 
-    if (g_game.onVipStateChange) {
+    if (!m_detached && g_game.onVipStateChange) {
         g_game.onVipStateChange(playerId, true);
     }
 }
@@ -1097,12 +1323,12 @@ void ProtocolGame::parseVipLogin(NetworkMessage& msg) {
 void ProtocolGame::parseVipLogout(NetworkMessage& msg) {
     uint32_t playerId = msg.readU32();
 
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         player->setVIPOnline(playerId, false);
     }
 
-    if (g_game.onVipStateChange) {
+    if (!m_detached && g_game.onVipStateChange) {
         g_game.onVipStateChange(playerId, false);
     }
 }
@@ -1115,7 +1341,7 @@ void ProtocolGame::parseVipState(NetworkMessage& msg) {
     bool notifyLogin = msg.readByte() != 0;
     uint8_t status = msg.readByte();
 
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         LocalPlayer::VIPEntry vip;
         vip.id = playerId;
@@ -1129,8 +1355,50 @@ void ProtocolGame::parseVipState(NetworkMessage& msg) {
     }
 }
 
+// u16 category, then u32 count and buy offers, u32 count and sell offers;
+// each offer is u32 timestamp, u16 counter, u16 item, u8 tier, u16 amount,
+// u64 price and the holder's name (empty when anonymous)
+void ProtocolGame::parseMarketBrowse(NetworkMessage& msg) {
+    uint16_t category = msg.readU16();
+
+    std::vector<MarketOffer> offers;
+    for (MarketSide side : {MarketSide::Buy, MarketSide::Sell}) {
+        uint32_t count = msg.readU32();
+        for (uint32_t i = 0; i < count && !msg.isEof(); ++i) {
+            MarketOffer offer;
+            offer.side = side;
+            offer.timestamp = msg.readU32();
+            offer.counter = msg.readU16();
+            offer.itemId = msg.readU16();
+            offer.tier = msg.readByte();
+            offer.amount = msg.readU16();
+            offer.price = msg.readU64();
+            offer.holder = msg.readString();
+            offers.push_back(std::move(offer));
+        }
+    }
+
+    if (m_detached) return;
+
+    g_game.getMarket().setCategoryOffers(category, std::move(offers));
+    if (g_game.onMarketBrowse) {
+        g_game.onMarketBrowse(category);
+    }
+}
+
 // Send packets
 
+void ProtocolGame::sendEnterWorld() {
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::EnterWorld);
+
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
+
+    m_connection->send(m_sendBuffer);
+}
+
 void ProtocolGame::sendPing() {
     m_sendBuffer.reset();
     m_sendBuffer.writeByte(ClientOpcode::Ping);
@@ -1142,6 +1410,25 @@ void ProtocolGame::sendPing() {
     m_connection->send(m_sendBuffer);
 }
 
+bool ProtocolGame::sendPingRequest() {
+    auto now = std::chrono::steady_clock::now();
+    if (!isConnected() || (m_pingPending && now - m_pingSentAt < PING_TIMEOUT)) {
+        return false;
+    }
+
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::PingRequest);
+
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
+
+    m_connection->send(m_sendBuffer);
+    m_pingSentAt = now;
+    m_pingPending = true;
+    return true;
+}
+
 void ProtocolGame::sendLogout() {
     m_sendBuffer.reset();
     m_sendBuffer.writeByte(ClientOpcode::QuitGame);
@@ -1191,6 +1478,7 @@ void ProtocolGame::sendWalk(Position::Direction direction) {
     }
 
     m_connection->send(m_sendBuffer);
+    g_input.markInputSent();
 }
 
 void ProtocolGame::sendStop() {
@@ -1367,6 +1655,7 @@ void ProtocolGame::sendAttack(uint32_t creatureId) {
     }
 
     m_connection->send(m_sendBuffer);
+    g_input.markInputSent();
 }
 
 void ProtocolGame::sendFollow(uint32_t creatureId) {
@@ -1504,6 +1793,72 @@ void ProtocolGame::sendCloseNpcTrade() {
     m_connection->send(m_sendBuffer);
 }
 
+void ProtocolGame::sendMarketLeave() {
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::MarketLeave);
+
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
+
+    m_connection->send(m_sendBuffer);
+}
+
+void ProtocolGame::sendMarketBrowse(uint16_t categoryId) {
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::MarketBrowse);
+    m_sendBuffer.writeU16(categoryId);
+
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
+
+    m_connection->send(m_sendBuffer);
+}
+
+void ProtocolGame::sendMarketCreate(uint8_t type, uint16_t itemId, uint16_t amount, uint32_t price, bool anonymous) {
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::MarketCreate);
+    m_sendBuffer.writeByte(type);
+    m_sendBuffer.writeU16(itemId);
+    m_sendBuffer.writeU16(amount);
+    m_sendBuffer.writeU32(price);
+    m_sendBuffer.writeByte(anonymous ? 1 : 0);
+
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
+
+    m_connection->send(m_sendBuffer);
+}
+
+void ProtocolGame::sendMarketCancel(uint32_t timestamp, uint16_t counter) {
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::MarketCancel);
+    m_sendBuffer.writeU32(timestamp);
+    m_sendBuffer.writeU16(counter);
+
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
+
+    m_connection->send(m_sendBuffer);
+}
+
+void ProtocolGame::sendMarketAccept(uint32_t timestamp, uint16_t counter, uint16_t amount) {
+    m_sendBuffer.reset();
+    m_sendBuffer.writeByte(ClientOpcode::MarketAccept);
+    m_sendBuffer.writeU32(timestamp);
+    m_sendBuffer.writeU16(counter);
+    m_sendBuffer.writeU16(amount);
+
+    if (m_xtea.isEnabled()) {
+        m_xtea.encrypt(m_sendBuffer);
+    }
+
+    m_connection->send(m_sendBuffer);
+}
+
 void ProtocolGame::sendRequestChannels() {
     m_sendBuffer.reset();
     m_sendBuffer.writeByte(ClientOpcode::RequestChannels);
@@ -1894,13 +2249,11 @@ void ProtocolGame::sendPartyAnalyzerAction(uint8_t action) {
     m_connection->send(m_sendBuffer);
 }
 
-void ProtocolGame::sendClientCheck(const std::vector<uint8_t>& data) {
+void ProtocolGame::sendClientCheck(std::span<const uint8_t> data) {
     m_sendBuffer.reset();
     m_sendBuffer.writeByte(0x63); // ClientCheck opcode
     m_sendBuffer.writeU16(static_cast<uint16_t>(data.size()));
-    for (uint8_t byte : data) {
-        m_sendBuffer.writeByte(byte);
-    }
+    m_sendBuffer.writeBytes(data.data(), data.size());
 
     if (m_xtea.isEnabled()) {
         m_xtea.encrypt(m_sendBuffer);
@@ -1915,7 +2268,7 @@ void ProtocolGame::parseBestiaryData(NetworkMessage& msg) {
     // Parse bestiary overview data
     uint16_t raceCount = msg.readU16();
     for (uint16_t i = 0; i < raceCount; ++i) {
-        std::string raceName = msg.readString();
+        std::string_view raceName = msg.readStringView();
         uint16_t monsterCount = msg.readU16();
         for (uint16_t j = 0; j < monsterCount; ++j) {
             uint16_t monsterId = msg.readU16();
@@ -1931,7 +2284,7 @@ void ProtocolGame::parseBosstiaryData(NetworkMessage& msg) {
     uint16_t bossCount = msg.readU16();
     for (uint16_t i = 0; i < bossCount; ++i) {
         uint32_t bossId = msg.readU32();
-        std::string bossName = msg.readString();
+        std::string_view bossName = msg.readStringView();
         uint8_t tier = msg.readByte(); // 0=bane, 1=prowess, 2=expertise
         uint16_t killsToUnlock = msg.readU16();
         uint16_t currentKills = msg.readU16();
@@ -1966,7 +2319,7 @@ void ProtocolGame::parseImbuementData(NetworkMessage& msg) {
         bool hasImbuement = msg.readByte() != 0;
         if (hasImbuement) {
             uint32_t imbuementId = msg.readU32();
-            std::string imbuementName = msg.readString();
+            std::string_view imbuementName = msg.readStringView();
             uint32_t duration = msg.readU32();
             uint8_t removeRequired = msg.readByte();
             (void)imbuementId; (void)imbuementName;
@@ -1993,7 +2346,7 @@ void ProtocolGame::parseStoreCoins(NetworkMessage& msg) {
     uint32_t coins = msg.readU32();
     uint32_t transferableCoins = msg.readU32();
     // Update local player
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         player->setStoreCoins(coins);
         player->setTransferableCoins(transferableCoins);
@@ -2004,8 +2357,8 @@ void ProtocolGame::parseCyclopediaCharacterInfo(NetworkMessage& msg) {
     uint8_t infoType = msg.readByte();
     switch (infoType) {
         case 0: { // Basic info
-            std::string name = msg.readString();
-            std::string vocation = msg.readString();
+            std::string_view name = msg.readStringView();
+            std::string_view vocation = msg.readStringView();
             uint16_t level = msg.readU16();
             (void)name; (void)vocation; (void)level;
             break;
@@ -2034,7 +2387,7 @@ void ProtocolGame::parseExaltationForge(NetworkMessage& msg) {
     uint8_t dustLevel = msg.readByte();
     uint8_t sliverAmount = msg.readByte();
     uint8_t coreAmount = msg.readByte();
-    auto player = g_game.getLocalPlayer();
+    auto player = localPlayer();
     if (player) {
         player->setForgeDust(dustAmount);
         player->setForgeDustLevel(dustLevel);
@@ -2046,7 +2399,7 @@ void ProtocolGame::parseFamiliarData(NetworkMessage& msg) {
     uint8_t familiarCount = msg.readByte();
     for (uint8_t i = 0; i < familiarCount; ++i) {
         uint16_t familiarId = msg.readU16();
-        std::string familiarName = msg.readString();
+        std::string_view familiarName = msg.readStringView();
         (void)familiarId; (void)familiarName;
     }
 }
@@ -2064,7 +2417,7 @@ void ProtocolGame::parsePartyAnalyzer(NetworkMessage& msg) {
     uint8_t memberCount = msg.readByte();
     for (uint8_t i = 0; i < memberCount; ++i) {
         uint32_t playerId = msg.readU32();
-        std::string playerName = msg.readString();
+        std::string_view playerName = msg.readStringView();
         uint64_t damage = msg.readU64();
         uint64_t healing = msg.readU64();
         uint64_t lootValue = msg.readU64();
@@ -2076,12 +2429,9 @@ void ProtocolGame::parsePartyAnalyzer(NetworkMessage& msg) {
 void ProtocolGame::parseClientCheck(NetworkMessage& msg) {
     // Client needs to respond with a hash based on the data
     uint16_t dataSize = msg.readU16();
-    std::vector<uint8_t> checkData(dataSize);
-    for (uint16_t i = 0; i < dataSize; ++i) {
-        checkData[i] = msg.readByte();
-    }
-    // Respond to client check
-    sendClientCheck(checkData);
+    // Respond to client check; the reply is built in m_sendBuffer, so the
+    // span into this message stays valid throughout
+    sendClientCheck(msg.readSpan(dataSize));
 }
 
 void ProtocolGame::parseBosstiaryCooldown(NetworkMessage& msg) {
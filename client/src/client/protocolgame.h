@@ -8,9 +8,14 @@
 
 #include <framework/net/protocol.h>
 #include <framework/net/connection.h>
+#include <framework/net/compression.h>
+#include <framework/net/packetcapture.h>
 #include "position.h"
 #include "creature.h"
 #include "item.h"
+#include "map.h"
+#include <array>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
@@ -78,7 +83,7 @@ public:
     ~ProtocolGame();
 
     // Connection
-    bool connect(const std::string& host, uint16_t port,
+    void connect(const std::string& host, uint16_t port,
                  const std::string& accountName, const std::string& password,
                  const std::string& characterName, uint32_t token = 0);
     void disconnect();
@@ -91,7 +96,13 @@ public:
     void onRecvMessage(framework::NetworkMessage& msg);
 
     // Send packets
+    // World entry, once the connection is up
+    void sendEnterWorld();
     void sendPing();
+    // Round-trip probe; skipped while an earlier one is unanswered for
+    // less than PING_TIMEOUT. The reply feeds Connection's RTT stats.
+    static constexpr auto PING_TIMEOUT = std::chrono::seconds(5);
+    bool sendPingRequest();
     void sendLogout();
     void sendAutoWalk(const std::vector<Position::Direction>& path);
     void sendWalk(Position::Direction direction);
@@ -119,6 +130,11 @@ public:
     void sendBuyItem(uint16_t itemId, uint8_t subType, uint8_t amount, bool ignoreCapacity, bool withBackpack);
     void sendSellItem(uint16_t itemId, uint8_t subType, uint8_t amount, bool ignoreEquipped);
     void sendCloseNpcTrade();
+    void sendMarketLeave();
+    void sendMarketBrowse(uint16_t categoryId);
+    void sendMarketCreate(uint8_t type, uint16_t itemId, uint16_t amount, uint32_t price, bool anonymous);
+    void sendMarketCancel(uint32_t timestamp, uint16_t counter);
+    void sendMarketAccept(uint32_t timestamp, uint16_t counter, uint16_t amount);
     void sendRequestChannels();
     void sendOpenChannel(uint16_t channelId);
     void sendCloseChannel(uint16_t channelId);
@@ -153,16 +169,80 @@ public:
     void sendRequestSupplyStash();
     void sendStashAction(uint8_t action, uint16_t itemId, uint32_t count);
     void sendPartyAnalyzerAction(uint8_t action);
-    void sendClientCheck(const std::vector<uint8_t>& data);
+    void sendClientCheck(std::span<const uint8_t> data);
+
+    // Live connection, null while disconnected or replaying
+    const std::shared_ptr<framework::Connection>& getConnection() const { return m_connection; }
 
     // XTEA key
     void setXTEAKey(const std::array<uint32_t, 4>& key);
 
+    // Compression (opt-in; active once the server acknowledges)
+    void requestCompression(uint16_t threshold = framework::PacketCompression::DEFAULT_THRESHOLD);
+    bool isCompressionActive() const { return m_compressionActive; }
+    const framework::PacketCompression::Stats& getCompressionStats() const { return m_compression.getStats(); }
+
+    // Capture plaintext inbound frames, or replay a capture without a
+    // server; replay is driven by poll()
+    bool startCapture(const std::string& path);
+    void stopCapture();
+    bool isCapturing() const { return m_recorder.isOpen(); }
+
+    bool startReplay(const std::string& path,
+                     framework::PacketReplayer::Speed speed = framework::PacketReplayer::Speed::Realtime);
+    void stopReplay();
+    bool isReplaying() const { return m_replaying; }
+    bool isReplayFinished() const { return m_replayer.isFinished(); }
+    const framework::PacketReplayer& getReplayer() const { return m_replayer; }
+
+    // Opcode dispatch: registered handlers override the built-in parser
+    // and must consume their whole message
+    using PacketHandler = std::function<void(framework::NetworkMessage&)>;
+    void registerHandler(uint8_t opcode, PacketHandler handler);
+    void unregisterHandler(uint8_t opcode);
+    bool hasHandler(uint8_t opcode) const;
+
+    // Every packet before it is dispatched, e.g. for load statistics
+    using PacketObserver = std::function<void(uint8_t opcode, size_t size)>;
+    void setPacketObserver(PacketObserver observer) { m_packetObserver = std::move(observer); }
+
+    // A detached protocol parses every packet in full but applies none of
+    // it: g_game, g_map, the containers, effects and script callbacks stay
+    // untouched, and only the view position it needs to frame map slices
+    // is kept here. Many detached sessions can share one process.
+    void setDetached(bool detached) { m_detached = detached; }
+    bool isDetached() const { return m_detached; }
+
+    // Per-opcode profiling (off by default)
+    struct OpcodeStats {
+        static constexpr size_t HISTOGRAM_BUCKETS = 12;
+
+        uint64_t calls{0};
+        uint64_t bytes{0};
+        uint64_t totalNs{0};
+        // Bucket i counts parses that took [2^(i-1), 2^i) microseconds;
+        // the last bucket is open-ended
+        std::array<uint32_t, HISTOGRAM_BUCKETS> histogram{};
+    };
+    void setOpcodeProfiling(bool enabled);
+    bool isOpcodeProfiling() const { return m_opcodeProfiling; }
+    const OpcodeStats& getOpcodeStats(uint8_t opcode) const;
+    uint64_t getUnknownOpcodes() const { return m_unknownOpcodes; }
+    void resetOpcodeStats();
+
 private:
     // Packet parsing
+    using Parser = void (ProtocolGame::*)(framework::NetworkMessage&);
+    using ParserTable = std::array<Parser, 256>;
+    static constexpr ParserTable buildParserTable();
+    static const ParserTable s_parsers;
+
     void parsePacket(framework::NetworkMessage& msg);
+    bool dispatchPacket(uint8_t opcode, framework::NetworkMessage& msg);
+    void wakePacketTasks(uint8_t opcode, const framework::NetworkMessage& msg, size_t start);
 
     // Server message parsers
+    void parseExtendedOpcode(framework::NetworkMessage& msg);
     void parseLoginError(framework::NetworkMessage& msg);
     void parseLoginAdvice(framework::NetworkMessage& msg);
     void parseLoginWait(framework::NetworkMessage& msg);
@@ -233,6 +313,9 @@ private:
     void parseVipLogout(framework::NetworkMessage& msg);
     void parseVipState(framework::NetworkMessage& msg);
 
+    // Market packets
+    void parseMarketBrowse(framework::NetworkMessage& msg);
+
     // Modern Tibia packets (12.x+)
     void parseBestiaryData(framework::NetworkMessage& msg);
     void parseBosstiaryData(framework::NetworkMessage& msg);
@@ -252,16 +335,30 @@ private:
     // Helper methods for parsing
     Position parsePosition(framework::NetworkMessage& msg);
     ItemPtr parseItem(framework::NetworkMessage& msg);
+    // The same wire format without creating an Item; id 0 for none
+    ItemDescription parseItemDescription(framework::NetworkMessage& msg);
     CreaturePtr parseCreature(framework::NetworkMessage& msg, uint16_t type);
     Outfit parseOutfitData(framework::NetworkMessage& msg);
     void parseMapArea(framework::NetworkMessage& msg, const Position& pos, int width, int height);
+    // Stages the tile into m_mapStage; the caller commits
     int parseTileDescription(framework::NetworkMessage& msg, const Position& pos);
 
+    // The world a packet applies to; a detached protocol finds nothing
+    std::shared_ptr<LocalPlayer> localPlayer() const;
+    CreaturePtr findCreature(uint32_t id) const;
+    std::shared_ptr<Tile> findTile(const Position& pos) const;
+    std::shared_ptr<Container> findContainer(uint8_t id) const;
+    const Position& centralPosition() const;
+    void setCentralPosition(const Position& pos);
+
     // Network
     std::shared_ptr<framework::Connection> m_connection;
     framework::XTEACipher m_xtea;
     framework::NetworkMessage m_sendBuffer;
     framework::NetworkMessage m_recvBuffer;
+    framework::PacketCompression m_compression;
+    framework::PacketRecorder m_recorder;
+    framework::PacketReplayer m_replayer;
 
     // State
     std::string m_accountName;
@@ -270,6 +367,24 @@ private:
     uint32_t m_accountToken{0};
     bool m_connected{false};
     bool m_firstReceived{false};
+    std::chrono::steady_clock::time_point m_pingSentAt{};
+    bool m_pingPending{false};
+    bool m_compressionRequested{false};
+    bool m_compressionActive{false};
+    bool m_replaying{false};
+    bool m_detached{false};
+    Position m_centralPosition;     // Detached only; g_map holds it otherwise
+
+    // Dispatch; the handler and stats tables are allocated on first use
+    std::unique_ptr<std::array<PacketHandler, 256>> m_handlers;
+    PacketObserver m_packetObserver;
+    std::unique_ptr<std::array<OpcodeStats, 256>> m_opcodeStats;
+    uint64_t m_unknownOpcodes{0};
+    bool m_opcodeProfiling{false};
+
+    // Map descriptions are parsed here whole, then committed to g_map
+    MapAreaStage m_mapStage;
+    std::vector<ItemDescription> m_itemScratch;
 };
 
 } // namespace client
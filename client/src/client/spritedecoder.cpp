@@ -0,0 +1,184 @@
+/**
+ * Shadow OT Client - Sprite Decoder Implementation
+ *
+ * The run structure is walked by shared scalar code; only the expansion of
+ * a colored run from packed RGB to RGBA differs per kernel. SSSE3 shuffles
+ * 12 source bytes into four pixels per load and only loads a full 16 bytes
+ * while they lie inside the stream; NEON deinterleaves eight pixels with
+ * vld3 and stores them back with an opaque alpha plane.
+ */
+
+#include "spritedecoder.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SHADOW_SPRITE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SHADOW_TARGET_SSSE3
+#else
+#define SHADOW_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SHADOW_SPRITE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace shadow {
+namespace client {
+namespace spritecodec {
+
+const char* getKernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar: return "scalar";
+        case Kernel::SSSE3: return "ssse3";
+        case Kernel::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+// Walks the runs; expand(src, count, dst, readable) widens one colored run,
+// where `readable` is how many bytes past src may be loaded
+template<typename Expand>
+static inline bool decodeRuns(const uint8_t* data, size_t size, uint8_t* rgba, Expand expand) {
+    size_t pos = 0;
+    size_t written = 0;
+    bool complete = true;
+
+    while (pos + 2 <= size && written < PIXEL_COUNT) {
+        size_t transparent = std::min<size_t>(data[pos] | (data[pos + 1] << 8), PIXEL_COUNT - written);
+        pos += 2;
+        std::memset(rgba + written * 4, 0, transparent * 4);
+        written += transparent;
+
+        if (pos + 2 > size) break;
+
+        size_t colored = std::min<size_t>(data[pos] | (data[pos + 1] << 8), PIXEL_COUNT - written);
+        pos += 2;
+        if (pos + colored * 3 > size) {
+            complete = false;
+            break;
+        }
+
+        expand(data + pos, colored, rgba + written * 4, size - pos);
+        pos += colored * 3;
+        written += colored;
+    }
+
+    std::memset(rgba + written * 4, 0, (PIXEL_COUNT - written) * 4);
+    return complete;
+}
+
+static inline void expandScalar(const uint8_t* src, size_t count, uint8_t* dst) {
+    for (size_t i = 0; i < count; ++i, src += 3, dst += 4) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+    }
+}
+
+static bool decodeScalar(const uint8_t* data, size_t size, uint8_t* rgba) {
+    return decodeRuns(data, size, rgba, [](const uint8_t* src, size_t count, uint8_t* dst, size_t) {
+        expandScalar(src, count, dst);
+    });
+}
+
+#ifdef SHADOW_SPRITE_X86
+
+SHADOW_TARGET_SSSE3
+static void expandSSSE3(const uint8_t* src, size_t count, uint8_t* dst, size_t readable) {
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    size_t i = 0;
+    for (; i + 4 <= count && i * 3 + 16 <= readable; i += 4) {
+        __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        __m128i pixels = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), pixels);
+    }
+    expandScalar(src + i * 3, count - i, dst + i * 4);
+}
+
+SHADOW_TARGET_SSSE3
+static bool decodeSSSE3(const uint8_t* data, size_t size, uint8_t* rgba) {
+    return decodeRuns(data, size, rgba, expandSSSE3);
+}
+
+static bool cpuHasSSSE3() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+#endif // SHADOW_SPRITE_X86
+
+#ifdef SHADOW_SPRITE_NEON
+
+static void expandNEON(const uint8_t* src, size_t count, uint8_t* dst, size_t) {
+    const uint8x8_t alpha = vdup_n_u8(255);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x3_t rgb = vld3_u8(src + i * 3);
+        uint8x8x4_t pixels = {{rgb.val[0], rgb.val[1], rgb.val[2], alpha}};
+        vst4_u8(dst + i * 4, pixels);
+    }
+    expandScalar(src + i * 3, count - i, dst + i * 4);
+}
+
+static bool decodeNEON(const uint8_t* data, size_t size, uint8_t* rgba) {
+    return decodeRuns(data, size, rgba, expandNEON);
+}
+
+#endif // SHADOW_SPRITE_NEON
+
+bool isKernelSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#ifdef SHADOW_SPRITE_X86
+        case Kernel::SSSE3: {
+            static const bool hasSSSE3 = cpuHasSSSE3();
+            return hasSSSE3;
+        }
+#endif
+#ifdef SHADOW_SPRITE_NEON
+        case Kernel::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+Kernel getBestKernel() {
+    for (Kernel kernel : {Kernel::NEON, Kernel::SSSE3}) {
+        if (isKernelSupported(kernel)) {
+            return kernel;
+        }
+    }
+    return Kernel::Scalar;
+}
+
+bool decode(Kernel kernel, const uint8_t* data, size_t size, uint8_t* rgba) {
+    switch (kernel) {
+#ifdef SHADOW_SPRITE_X86
+        case Kernel::SSSE3: return decodeSSSE3(data, size, rgba);
+#endif
+#ifdef SHADOW_SPRITE_NEON
+        case Kernel::NEON: return decodeNEON(data, size, rgba);
+#endif
+        default: return decodeScalar(data, size, rgba);
+    }
+}
+
+} // namespace spritecodec
+} // namespace client
+} // namespace shadow
@@ -0,0 +1,39 @@
+/**
+ * Shadow OT Client - Sprite Decoder
+ *
+ * Expands the RLE pixel stream of a .spr sprite into 32x32 RGBA. Colored
+ * runs are widened from RGB to RGBA four (SSSE3) or eight (NEON) pixels
+ * at a time, selected at runtime. All kernels produce identical output.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shadow {
+namespace client {
+namespace spritecodec {
+
+constexpr int SPRITE_SIZE = 32;
+constexpr size_t PIXEL_COUNT = SPRITE_SIZE * SPRITE_SIZE;
+constexpr size_t RGBA_SIZE = PIXEL_COUNT * 4;
+
+enum class Kernel {
+    Scalar,
+    SSSE3,
+    NEON
+};
+
+const char* getKernelName(Kernel kernel);
+bool isKernelSupported(Kernel kernel);
+Kernel getBestKernel();
+
+// Decode `size` bytes of alternating (transparent count, colored count,
+// RGB...) runs into RGBA_SIZE bytes at `rgba`. Every output byte is
+// written, transparent pixels as zero. Returns false on a truncated run.
+bool decode(Kernel kernel, const uint8_t* data, size_t size, uint8_t* rgba);
+
+} // namespace spritecodec
+} // namespace client
+} // namespace shadow
@@ -50,7 +50,8 @@ public:
     // Drawing
     virtual void draw(int x, int y, float scale = 1.0f) {}
 
-    // Animation
+    // Per-frame tick, for things with state beyond a timed animation
+    // (walking, speech); timed phases come from the shared clock instead
     virtual void update(float deltaTime) {}
 
     // Light
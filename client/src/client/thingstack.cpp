@@ -0,0 +1,152 @@
+/**
+ * Shadow OT Client - Thing Stack Implementation
+ */
+
+#include "thingstack.h"
+#include "thingtype.h"
+#include <algorithm>
+
+namespace shadow {
+namespace client {
+
+ThingStack::Bucket ThingStack::classify(const ThingType* type) {
+    if (!type) return BucketCommon;
+    if (type->isGround()) return BucketGround;
+    if (type->hasAttr(ThingAttr::TopOrder1) || type->hasAttr(ThingAttr::TopOrder2)) return BucketBottom;
+    if (type->hasAttr(ThingAttr::TopOrder3)) return BucketTop;
+    return BucketCommon;
+}
+
+void ThingStack::grow() {
+    size_t grown = capacity() * 2;
+    auto heap = std::make_unique<HeapColumns>();
+    heap->items.resize(grown);
+    heap->types.resize(grown);
+    heap->ids.resize(grown);
+    heap->subTypes.resize(grown);
+    heap->buckets.resize(grown);
+
+    std::move(items(), items() + m_size, heap->items.begin());
+    std::copy(types(), types() + m_size, heap->types.begin());
+    std::copy(ids(), ids() + m_size, heap->ids.begin());
+    std::copy(subTypes(), subTypes() + m_size, heap->subTypes.begin());
+    std::copy(buckets(), buckets() + m_size, heap->buckets.begin());
+
+    // Moved-from inline slots are already empty
+    m_heap = std::move(heap);
+}
+
+void ThingStack::write(size_t index, ItemPtr item, ThingType* type, Bucket bucket) {
+    uint8_t subType = type && type->isStackable() ? item->getCount() : item->getSubType();
+    uint16_t id = item->getId();
+
+    auto assign = [&](auto* column, auto value) { column[index] = std::move(value); };
+    if (m_heap) {
+        assign(m_heap->items.data(), std::move(item));
+        assign(m_heap->types.data(), type);
+        assign(m_heap->ids.data(), id);
+        assign(m_heap->subTypes.data(), subType);
+        assign(m_heap->buckets.data(), static_cast<uint8_t>(bucket));
+    } else {
+        assign(m_inline.items.data(), std::move(item));
+        assign(m_inline.types.data(), type);
+        assign(m_inline.ids.data(), id);
+        assign(m_inline.subTypes.data(), subType);
+        assign(m_inline.buckets.data(), static_cast<uint8_t>(bucket));
+    }
+}
+
+int ThingStack::insert(ItemPtr item) {
+    if (!item) return -1;
+    ThingType* type = item->getItemType();
+    return insert(std::move(item), type, classify(type));
+}
+
+int ThingStack::insert(ItemPtr item, Bucket bucket) {
+    if (!item) return -1;
+    ThingType* type = item->getItemType();
+    return insert(std::move(item), type, bucket);
+}
+
+int ThingStack::insert(ItemPtr item, ThingType* type, Bucket bucket) {
+    if (m_size >= MAX_SIZE) return -1;
+    if (m_size == capacity()) {
+        grow();
+    }
+
+    size_t index = end(bucket);
+
+    forEachColumn([&](auto* column) {
+        std::move_backward(column + index, column + m_size, column + m_size + 1);
+    });
+    write(index, std::move(item), type, bucket);
+
+    m_size++;
+    for (size_t b = bucket + 1; b <= BucketCount; ++b) {
+        m_bucketStart[b]++;
+    }
+    return static_cast<int>(index);
+}
+
+void ThingStack::eraseAt(size_t index) {
+    if (index >= m_size) return;
+
+    Bucket removed = bucket(index);
+    forEachColumn([&](auto* column) {
+        std::move(column + index + 1, column + m_size, column + index);
+    });
+
+    m_size--;
+    if (m_heap) {
+        m_heap->items[m_size].reset();
+    } else {
+        m_inline.items[m_size].reset();
+    }
+    for (size_t b = removed + 1; b <= BucketCount; ++b) {
+        m_bucketStart[b]--;
+    }
+}
+
+bool ThingStack::erase(const ItemPtr& item) {
+    int index = find(item.get());
+    if (index < 0) return false;
+    eraseAt(static_cast<size_t>(index));
+    return true;
+}
+
+void ThingStack::clear() {
+    for (auto& item : m_inline.items) {
+        item.reset();
+    }
+    m_heap.reset();
+    m_bucketStart.fill(0);
+    m_size = 0;
+}
+
+int ThingStack::find(const Item* item) const {
+    const ItemPtr* column = items();
+    for (size_t i = 0; i < m_size; ++i) {
+        if (column[i].get() == item) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void ThingStack::refresh(size_t index) {
+    if (index >= m_size) return;
+
+    ItemPtr item = items()[index];
+    ThingType* type = item->getItemType();
+    Bucket bucket = classify(type);
+
+    if (bucket == this->bucket(index)) {
+        write(index, std::move(item), type, bucket);
+        return;
+    }
+
+    // Transformed into another layer: move it to the end of its new bucket
+    eraseAt(index);
+    insert(std::move(item), type, bucket);
+}
+
+} // namespace client
+} // namespace shadow
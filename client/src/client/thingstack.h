@@ -0,0 +1,119 @@
+/**
+ * Shadow OT Client - Thing Stack
+ *
+ * The items of a tile as parallel columns: item id, count or subtype,
+ * cached ThingType and draw bucket side by side. Up to INLINE_CAPACITY
+ * items live inside the stack itself; larger piles move to the heap.
+ * Entries stay grouped by bucket (ground, bottom, common, top), so each
+ * draw pass walks one contiguous range without asking the type for its
+ * attributes.
+ */
+
+#pragma once
+
+#include "item.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace shadow {
+namespace client {
+
+class ThingType;
+
+class ThingStack {
+public:
+    static constexpr size_t INLINE_CAPACITY = 8;
+    static constexpr size_t MAX_SIZE = 255;     // Stack positions are a byte on the wire
+
+    enum Bucket : uint8_t {
+        BucketGround = 0,
+        BucketBottom,       // Ground borders and bottom items (TopOrder1, TopOrder2)
+        BucketCommon,
+        BucketTop,          // Drawn over creatures (TopOrder3)
+        BucketCount
+    };
+
+    static Bucket classify(const ThingType* type);
+
+    ThingStack() = default;
+    ThingStack(const ThingStack&) = delete;
+    ThingStack& operator=(const ThingStack&) = delete;
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool isInline() const { return !m_heap; }
+
+    // Appends to the item's bucket; returns its index, or -1 when full
+    int insert(ItemPtr item);
+    int insert(ItemPtr item, Bucket bucket);
+    bool erase(const ItemPtr& item);
+    void eraseAt(size_t index);
+    void clear();
+
+    // Index of an item, or -1
+    int find(const Item* item) const;
+
+    // Re-read id, count and type after an item changed in place
+    void refresh(size_t index);
+
+    const ItemPtr& item(size_t index) const { return items()[index]; }
+    uint16_t id(size_t index) const { return ids()[index]; }
+    uint8_t subType(size_t index) const { return subTypes()[index]; }   // Count for stackables
+    ThingType* type(size_t index) const { return types()[index]; }
+    Bucket bucket(size_t index) const { return static_cast<Bucket>(buckets()[index]); }
+
+    // Index range [begin, end) of a bucket
+    size_t begin(Bucket bucket) const { return m_bucketStart[bucket]; }
+    size_t end(Bucket bucket) const { return m_bucketStart[bucket + 1]; }
+    size_t count(Bucket bucket) const { return end(bucket) - begin(bucket); }
+
+    // Columns, valid for [0, size())
+    const ItemPtr* items() const { return m_heap ? m_heap->items.data() : m_inline.items.data(); }
+    ThingType* const* types() const { return m_heap ? m_heap->types.data() : m_inline.types.data(); }
+    const uint16_t* ids() const { return m_heap ? m_heap->ids.data() : m_inline.ids.data(); }
+    const uint8_t* subTypes() const { return m_heap ? m_heap->subTypes.data() : m_inline.subTypes.data(); }
+    const uint8_t* buckets() const { return m_heap ? m_heap->buckets.data() : m_inline.buckets.data(); }
+
+private:
+    struct InlineColumns {
+        std::array<ItemPtr, INLINE_CAPACITY> items;
+        std::array<ThingType*, INLINE_CAPACITY> types{};
+        std::array<uint16_t, INLINE_CAPACITY> ids{};
+        std::array<uint8_t, INLINE_CAPACITY> subTypes{};
+        std::array<uint8_t, INLINE_CAPACITY> buckets{};
+    };
+    struct HeapColumns {
+        std::vector<ItemPtr> items;
+        std::vector<ThingType*> types;
+        std::vector<uint16_t> ids;
+        std::vector<uint8_t> subTypes;
+        std::vector<uint8_t> buckets;
+    };
+
+    size_t capacity() const { return m_heap ? m_heap->items.size() : INLINE_CAPACITY; }
+    int insert(ItemPtr item, ThingType* type, Bucket bucket);
+    void grow();
+    void write(size_t index, ItemPtr item, ThingType* type, Bucket bucket);
+
+    template<typename F>
+    void forEachColumn(F&& f) {
+        if (m_heap) {
+            f(m_heap->items.data()); f(m_heap->types.data()); f(m_heap->ids.data());
+            f(m_heap->subTypes.data()); f(m_heap->buckets.data());
+        } else {
+            f(m_inline.items.data()); f(m_inline.types.data()); f(m_inline.ids.data());
+            f(m_inline.subTypes.data()); f(m_inline.buckets.data());
+        }
+    }
+
+    InlineColumns m_inline;
+    std::unique_ptr<HeapColumns> m_heap;
+    std::array<uint16_t, BucketCount + 1> m_bucketStart{};
+    uint16_t m_size{0};
+};
+
+} // namespace client
+} // namespace shadow
@@ -3,10 +3,17 @@
  */
 
 #include "thingtype.h"
+#include "spritedecoder.h"
+#include "thingtypecache.h"
+#include <framework/core/memorytracker.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/graphics/graphics.h>
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <cstdio>
 #include <cstring>
+#include <thread>
 
 // Globals are declared in shadow::framework namespace
 using shadow::framework::g_graphics;
@@ -27,13 +34,13 @@ bool ThingType::load(const uint8_t* data, size_t size) {
         if (attr == 0xFF) break;
 
         ThingAttr thingAttr = static_cast<ThingAttr>(attr);
-        m_attrs[thingAttr] = true;
+        m_hot.attrs |= attrMask(thingAttr);
 
         // Parse attribute data based on type
         switch (static_cast<int>(attr)) {
             case 0: // Ground - has speed
                 if (pos + 2 <= size) {
-                    m_speed = data[pos] | (data[pos + 1] << 8);
+                    m_hot.speed = data[pos] | (data[pos + 1] << 8);
                     pos += 2;
                 }
                 break;
@@ -77,8 +84,8 @@ bool ThingType::load(const uint8_t* data, size_t size) {
 
             case 22: // Light - has intensity and color
                 if (pos + 2 <= size) {
-                    m_lightIntensity = data[pos++];
-                    m_lightColor = data[pos++];
+                    m_hot.lightIntensity = data[pos++];
+                    m_hot.lightColor = data[pos++];
                 }
                 break;
 
@@ -96,7 +103,7 @@ bool ThingType::load(const uint8_t* data, size_t size) {
 
             case 26: // Elevation - has height
                 if (pos + 2 <= size) {
-                    m_elevation = data[pos] | (data[pos + 1] << 8);
+                    m_hot.elevation = data[pos] | (data[pos + 1] << 8);
                     pos += 2;
                 }
                 break;
@@ -209,10 +216,10 @@ bool ThingType::load(const uint8_t* data, size_t size) {
     }
 
     // Read dimensions
-    if (pos < size) m_width = data[pos++];
-    if (pos < size) m_height = data[pos++];
+    if (pos < size) m_hot.width = data[pos++];
+    if (pos < size) m_hot.height = data[pos++];
 
-    if (m_width > 1 || m_height > 1) {
+    if (m_hot.width > 1 || m_hot.height > 1) {
         if (pos < size) m_exactSize = data[pos++];
     } else {
         m_exactSize = 32;
@@ -253,7 +260,7 @@ bool ThingType::load(const uint8_t* data, size_t size) {
     }
 
     // Read sprite IDs
-    int spriteCount = m_width * m_height * m_layers * m_patternX * m_patternY * m_patternZ * m_animPhases;
+    int spriteCount = m_hot.width * m_hot.height * m_layers * m_patternX * m_patternY * m_patternZ * m_animPhases;
     m_spriteIds.resize(spriteCount);
     for (int i = 0; i < spriteCount && pos + 4 <= size; i++) {
         m_spriteIds[i] = data[pos] | (data[pos + 1] << 8) |
@@ -261,12 +268,44 @@ bool ThingType::load(const uint8_t* data, size_t size) {
         pos += 4;
     }
 
+    buildPhaseTable();
     return true;
 }
 
-bool ThingType::hasAttr(ThingAttr attr) const {
-    auto it = m_attrs.find(attr);
-    return it != m_attrs.end() && it->second;
+void ThingType::buildPhaseTable() {
+    m_phaseEnds.clear();
+    m_phaseOffset = 0;
+    if (m_animPhases <= 1) return;
+
+    uint32_t end = 0;
+    m_phaseEnds.reserve(m_animPhases);
+    for (int i = 0; i < m_animPhases; ++i) {
+        uint32_t duration = DEFAULT_PHASE_DURATION;
+        if (i < static_cast<int>(m_animationDurations.size())) {
+            const auto& [minDuration, maxDuration] = m_animationDurations[i];
+            uint64_t middle = (static_cast<uint64_t>(minDuration) + std::max(minDuration, maxDuration)) / 2;
+            if (middle > 0) duration = static_cast<uint32_t>(std::min<uint64_t>(middle, UINT32_MAX / 256));
+        }
+        end += duration;
+        m_phaseEnds.push_back(end);
+    }
+
+    if (m_animationStartPhase > 0 && m_animationStartPhase < m_animPhases) {
+        m_phaseOffset = m_phaseEnds[m_animationStartPhase - 1];
+    }
+}
+
+int ThingType::getPhaseAt(uint32_t elapsedMs) const {
+    if (m_phaseEnds.size() <= 1) return 0;
+
+    uint32_t cycle = m_phaseEnds.back();
+    if (m_animationLoopCount > 0 && !isSyncAnimation() &&
+        elapsedMs / cycle >= static_cast<uint32_t>(m_animationLoopCount)) {
+        return static_cast<int>(m_phaseEnds.size()) - 1;
+    }
+
+    uint32_t t = static_cast<uint32_t>((static_cast<uint64_t>(elapsedMs) + m_phaseOffset) % cycle);
+    return static_cast<int>(std::upper_bound(m_phaseEnds.begin(), m_phaseEnds.end(), t) - m_phaseEnds.begin());
 }
 
 void ThingType::draw(int x, int y, float scale, int patternX, int patternY, int patternZ, int animationPhase) {
@@ -283,18 +322,18 @@ void ThingType::draw(int x, int y, float scale, int patternX, int patternY, int
 
     // Draw each layer, each tile
     for (int layer = 0; layer < m_layers; layer++) {
-        for (int py = 0; py < m_height; py++) {
-            for (int px = 0; px < m_width; px++) {
+        for (int py = 0; py < m_hot.height; py++) {
+            for (int px = 0; px < m_hot.width; px++) {
                 // Calculate sprite index
                 int idx = ((((animationPhase * m_patternZ + patternZ) * m_patternY + patternY) *
-                           m_patternX + patternX) * m_layers + layer) * m_width * m_height +
-                          py * m_width + px;
+                           m_patternX + patternX) * m_layers + layer) * m_hot.width * m_hot.height +
+                          py * m_hot.width + px;
 
-                if (idx >= 0 && idx < static_cast<int>(m_sprites.size())) {
-                    auto sprite = m_sprites[idx];
+                if (idx >= 0 && idx < static_cast<int>(m_spriteIds.size())) {
+                    const framework::AtlasRegion* sprite = ThingTypeManager::instance().loadSprite(m_spriteIds[idx]);
                     if (sprite) {
-                        int drawX = x - (m_width - 1 - px) * 32 * static_cast<int>(scale);
-                        int drawY = y - (m_height - 1 - py) * 32 * static_cast<int>(scale);
+                        int drawX = x - (m_hot.width - 1 - px) * 32 * static_cast<int>(scale);
+                        int drawY = y - (m_hot.height - 1 - py) * 32 * static_cast<int>(scale);
 
                         // Apply displacement
                         drawX -= m_displacementX;
@@ -303,7 +342,7 @@ void ThingType::draw(int x, int y, float scale, int patternX, int patternY, int
                         framework::Rect destRect{drawX, drawY,
                                                   static_cast<int>(32 * scale),
                                                   static_cast<int>(32 * scale)};
-                        g_graphics.drawTexture(sprite.get(), destRect);
+                        g_graphics.drawTexture(sprite->page, sprite->rect, destRect);
                     }
                 }
             }
@@ -311,18 +350,54 @@ void ThingType::draw(int x, int y, float scale, int patternX, int patternY, int
     }
 }
 
-void ThingType::setSprite(int index, std::shared_ptr<framework::Texture> sprite) {
-    if (index >= static_cast<int>(m_sprites.size())) {
-        m_sprites.resize(index + 1);
-    }
-    m_sprites[index] = sprite;
-}
+void ThingType::drawInstanced(int x, int y, float scale, int patternX, int patternY, int patternZ, int animationPhase,
+                              const std::array<framework::Color, 4>* outfitColors) {
+    auto& manager = ThingTypeManager::instance();
 
-std::shared_ptr<framework::Texture> ThingType::getSprite(int index) const {
-    if (index >= 0 && index < static_cast<int>(m_sprites.size())) {
-        return m_sprites[index];
+    patternX = patternX % m_patternX;
+    patternY = patternY % m_patternY;
+    patternZ = patternZ % m_patternZ;
+    animationPhase = animationPhase % m_animPhases;
+
+    // Colored outfits fold the template layer into the base layer's instance
+    bool colorize = outfitColors && m_layers > 1;
+    int layers = colorize ? 1 : m_layers;
+    int spritesPerLayer = m_hot.width * m_hot.height;
+    int size = static_cast<int>(32 * scale);
+
+    framework::SpriteInstance instance;
+    if (outfitColors) instance.outfitColors = *outfitColors;
+
+    for (int layer = 0; layer < layers; layer++) {
+        int first = ((((animationPhase * m_patternZ + patternZ) * m_patternY + patternY) *
+                      m_patternX + patternX) * m_layers + layer) * spritesPerLayer;
+
+        for (int py = 0; py < m_hot.height; py++) {
+            for (int px = 0; px < m_hot.width; px++) {
+                int idx = first + py * m_hot.width + px;
+                if (idx >= static_cast<int>(m_spriteIds.size())) continue;
+
+                // Copy the region out: loading the template may move it
+                const framework::AtlasRegion* sprite = manager.loadSprite(m_spriteIds[idx]);
+                if (!sprite) continue;
+                const framework::Texture* page = sprite->page;
+                instance.src = sprite->rect;
+
+                const framework::Texture* maskPage = nullptr;
+                instance.maskSrc = framework::Rect();
+                if (colorize && idx + spritesPerLayer < static_cast<int>(m_spriteIds.size())) {
+                    if (const framework::AtlasRegion* mask = manager.loadSprite(m_spriteIds[idx + spritesPerLayer])) {
+                        maskPage = mask->page;
+                        instance.maskSrc = mask->rect;
+                    }
+                }
+
+                instance.dest = framework::Rect(x - (m_hot.width - 1 - px) * size - m_displacementX,
+                                                y - (m_hot.height - 1 - py) * size - m_displacementY, size, size);
+                g_graphics.drawSpriteInstance(page, instance, maskPage);
+            }
+        }
     }
-    return nullptr;
 }
 
 // ThingTypeManager implementation
@@ -332,10 +407,56 @@ ThingTypeManager& ThingTypeManager::instance() {
     return instance;
 }
 
+ThingTypeManager::~ThingTypeManager() {
+    terminateDecoder();
+}
+
+std::span<const uint8_t> ThingTypeManager::openFile(const std::string& filename, framework::MappedFile& file,
+                                                    std::vector<uint8_t>& buffer) {
+    file.close();
+    buffer.clear();
+    if (g_resources.mapFile(filename, file)) {
+        return {file.data(), file.size()};
+    }
+    buffer = g_resources.readFile(filename);
+    return buffer;
+}
+
 bool ThingTypeManager::loadDat(const std::string& filename) {
-    // g_resources already available from using declaration
+    m_generation++;
+
+    ThingTypeCache::Tables tables{&m_items, &m_creatures, &m_effects, &m_missiles};
+    ThingTypeCache::Source source;
+    std::string cachePath;
+
+    std::string path = g_resources.resolvePath(filename);
+    if (!m_cacheDirectory.empty() && !path.empty() && ThingTypeCache::getSource(path, source)) {
+        // The path hash keeps .dat files of different client versions apart
+        std::filesystem::path datPath(path);
+        char suffix[17];
+        std::snprintf(suffix, sizeof(suffix), "%016zx", std::hash<std::string>{}(datPath.lexically_normal().string()));
+        cachePath = (std::filesystem::path(m_cacheDirectory) /
+                     (datPath.stem().string() + "-" + suffix + ".ttc")).string();
+
+        if (ThingTypeCache::load(cachePath, source, tables)) {
+            return true;
+        }
+    }
+
+    if (!parseDat(filename)) {
+        return false;
+    }
+    if (!cachePath.empty()) {
+        ThingTypeCache::save(cachePath, source, tables);
+    }
+    return true;
+}
 
-    std::vector<uint8_t> data = g_resources.readFile(filename);
+bool ThingTypeManager::parseDat(const std::string& filename) {
+    // Mapped for the parse only; nothing points into it afterwards
+    framework::MappedFile file;
+    std::vector<uint8_t> buffer;
+    std::span<const uint8_t> data = openFile(filename, file, buffer);
     if (data.empty()) {
         return false;
     }
@@ -435,7 +556,23 @@ bool ThingTypeManager::loadDat(const std::string& filename) {
 bool ThingTypeManager::loadSpr(const std::string& filename) {
     // g_resources already available from using declaration
 
-    m_sprData = g_resources.readFile(filename);
+    // Decode jobs read the sprite data; stop them while it is replaced
+    int jobs = static_cast<int>(m_decodeJobLimit);
+    bool decoding = m_decodeRunning;
+    terminateDecoder();
+    m_spriteAtlas.clear();
+    m_generation++;
+
+    bool loaded = parseSpr(filename);
+    if (decoding) {
+        initDecoder(jobs);
+    }
+    return loaded;
+}
+
+bool ThingTypeManager::parseSpr(const std::string& filename) {
+    m_spriteOffsets.clear();
+    m_sprData = openFile(filename, m_sprFile, m_sprBuffer);
     if (m_sprData.empty()) {
         return false;
     }
@@ -499,74 +636,228 @@ ThingType* ThingTypeManager::getMissileType(uint16_t id) {
     return nullptr;
 }
 
-std::shared_ptr<framework::Texture> ThingTypeManager::loadSprite(uint32_t spriteId) {
-    // Check cache
-    auto it = m_spriteCache.find(spriteId);
-    if (it != m_spriteCache.end()) {
-        return it->second;
+const framework::AtlasRegion* ThingTypeManager::loadSprite(uint32_t spriteId) {
+    if (const framework::AtlasRegion* region = m_spriteAtlas.find(spriteId)) {
+        return region;
     }
 
-    if (spriteId == 0 || spriteId >= m_spriteOffsets.size()) {
+    if (m_decodeRunning) {
+        if (m_invalidSprites.count(spriteId)) {
+            return nullptr;
+        }
+        m_deferredSprites++;
+        bool queue = m_decodePending.insert(spriteId).second;
+        if (queue || m_prefetchWaiting.load(std::memory_order_relaxed) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(m_decodeMutex);
+                // Pending only as a prefetch hint: move it ahead
+                if (!queue && m_prefetchQueued.erase(spriteId)) {
+                    m_prefetchWaiting.fetch_sub(1, std::memory_order_relaxed);
+                    queue = true;
+                }
+                if (queue) {
+                    m_decodeQueue.push_back(spriteId);
+                }
+            }
+            if (queue) {
+                scheduleDecode();
+            }
+        }
         return nullptr;
     }
 
-    uint32_t offset = m_spriteOffsets[spriteId];
-    if (offset == 0 || offset >= m_sprData.size()) {
+    m_decodeBuffer.resize(SPRITE_BYTES);
+    if (!decodeSprite(spriteId, m_decodeBuffer.data())) {
         return nullptr;
     }
+    return m_spriteAtlas.add(spriteId, SPRITE_SIZE, SPRITE_SIZE, m_decodeBuffer.data());
+}
 
-    // Parse sprite data
-    // Format: 3 bytes transparent color, 2 bytes data size, then pixel data
-    size_t pos = offset;
+void ThingTypeManager::prefetchSprites(const std::vector<uint32_t>& spriteIds) {
+    if (!m_decodeRunning || spriteIds.empty()) return;
+
+    size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        for (uint32_t spriteId : spriteIds) {
+            if (m_prefetchQueue.size() >= PREFETCH_QUEUE_MAX) break;
+            if (spriteId == 0 || m_decodePending.count(spriteId) || m_invalidSprites.count(spriteId) ||
+                m_spriteAtlas.find(spriteId)) {
+                continue;
+            }
+            m_decodePending.insert(spriteId);
+            m_prefetchQueued.insert(spriteId);
+            m_prefetchQueue.push_back(spriteId);
+            queued++;
+        }
+        m_prefetchWaiting.fetch_add(queued, std::memory_order_relaxed);
+    }
 
-    if (pos + 5 > m_sprData.size()) return nullptr;
+    if (queued > 0) {
+        m_prefetchedSprites += queued;
+        scheduleDecode();
+    }
+}
 
-    // Skip transparent color (3 bytes)
-    pos += 3;
+void ThingTypeManager::initDecoder(int jobs) {
+    if (m_decodeRunning) return;
 
-    // Pixel data size
-    uint16_t pixelDataSize = m_sprData[pos] | (m_sprData[pos + 1] << 8);
-    pos += 2;
+    if (jobs <= 0) {
+        jobs = std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1, 4);
+    }
 
-    if (pos + pixelDataSize > m_sprData.size()) return nullptr;
+    m_decodeJobLimit = static_cast<size_t>(jobs);
+    m_decodeRunning = true;
+}
 
-    // Decode RLE sprite into 32x32 RGBA
-    std::vector<uint8_t> pixels(32 * 32 * 4, 0);
+void ThingTypeManager::terminateDecoder() {
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        m_decodeRunning = false;
+        m_decodeQueue.clear();
+        m_prefetchQueue.clear();
+        m_prefetchQueued.clear();
+        m_prefetchWaiting.store(0, std::memory_order_relaxed);
+    }
 
-    size_t writePos = 0;
-    size_t endPos = pos + pixelDataSize;
+    // Each job stops after the sprite it is on
+    for (const auto& job : m_decodeJobs) {
+        g_jobs.wait(job);
+    }
+    m_decodeJobs.clear();
+    m_decoded.clear();
+    m_uploading.clear();
+    m_decodePending.clear();
+    m_invalidSprites.clear();
+}
 
-    while (pos < endPos && writePos < 32 * 32) {
-        // Transparent pixels
-        uint16_t transparentPixels = m_sprData[pos] | (m_sprData[pos + 1] << 8);
-        pos += 2;
-        writePos += transparentPixels;
+void ThingTypeManager::scheduleDecode() {
+    size_t spawn = 0;
+    framework::JobPriority priority = framework::JobPriority::Low;
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        if (!m_decodeRunning || m_decodeJobsActive >= m_decodeJobLimit) return;
+        size_t queued = m_decodeQueue.size() + m_prefetchQueue.size();
+        spawn = std::min(m_decodeJobLimit - m_decodeJobsActive, queued);
+        m_decodeJobsActive += spawn;
+        // A draw is waiting on the demand queue; prefetch hints can wait
+        if (!m_decodeQueue.empty()) {
+            priority = framework::JobPriority::High;
+        }
+    }
 
-        if (pos >= endPos) break;
+    std::erase_if(m_decodeJobs, [](const auto& job) { return framework::JobSystem::isDone(job); });
+    for (size_t i = 0; i < spawn; ++i) {
+        m_decodeJobs.push_back(g_jobs.submit([this] { decodeQueued(); }, priority));
+    }
+}
 
-        // Colored pixels
-        uint16_t coloredPixels = m_sprData[pos] | (m_sprData[pos + 1] << 8);
-        pos += 2;
+void ThingTypeManager::decodeQueued() {
+    std::unique_lock<std::mutex> lock(m_decodeMutex);
+    while (true) {
+        // Leaving under the lock, so a sprite queued after this check
+        // finds the job gone and schedules another
+        if (!m_decodeRunning || (m_decodeQueue.empty() && m_prefetchQueue.empty())) {
+            m_decodeJobsActive--;
+            return;
+        }
+
+        DecodedSprite sprite;
+        if (!m_decodeQueue.empty()) {
+            sprite.spriteId = m_decodeQueue.front();
+            m_decodeQueue.pop_front();
+        } else {
+            sprite.spriteId = m_prefetchQueue.front();
+            m_prefetchQueue.pop_front();
+            if (!m_prefetchQueued.erase(sprite.spriteId)) continue;     // Promoted
+            m_prefetchWaiting.fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (!m_freePixels.empty()) {
+            sprite.pixels = std::move(m_freePixels.back());
+            m_freePixels.pop_back();
+        }
+        lock.unlock();
+
+        sprite.pixels.resize(SPRITE_BYTES);
+        if (!decodeSprite(sprite.spriteId, sprite.pixels.data())) {
+            sprite.pixels.clear();
+        }
 
-        for (uint16_t i = 0; i < coloredPixels && writePos < 32 * 32; i++) {
-            if (pos + 3 > m_sprData.size()) break;
+        lock.lock();
+        m_decoded.push_back(std::move(sprite));
+    }
+}
 
-            size_t pixelOffset = writePos * 4;
-            pixels[pixelOffset + 0] = m_sprData[pos++]; // R
-            pixels[pixelOffset + 1] = m_sprData[pos++]; // G
-            pixels[pixelOffset + 2] = m_sprData[pos++]; // B
-            pixels[pixelOffset + 3] = 255;               // A
+void ThingTypeManager::nextFrame() {
+    m_animationTime = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - m_animationEpoch).count());
+    m_spriteAtlas.nextFrame();
+    if (!m_decodePending.empty()) {
+        uploadDecodedSprites();
+    }
+    g_memory.setUsage(framework::MemoryTag::Sprites, m_spriteAtlas.getTextureBytes());
+}
 
-            writePos++;
+void ThingTypeManager::uploadDecodedSprites() {
+    {
+        std::lock_guard<std::mutex> lock(m_decodeMutex);
+        size_t count = std::min(m_decoded.size(), m_uploadBudget);
+        auto first = m_decoded.end() - static_cast<std::ptrdiff_t>(count);
+        std::move(first, m_decoded.end(), std::back_inserter(m_uploading));
+        m_decoded.erase(first, m_decoded.end());
+    }
+
+    for (auto& sprite : m_uploading) {
+        // Invalid sprites are remembered so they are not decoded again
+        m_decodePending.erase(sprite.spriteId);
+        if (sprite.pixels.empty()) {
+            m_invalidSprites.insert(sprite.spriteId);
+            continue;
         }
+
+        m_spriteAtlas.add(sprite.spriteId, SPRITE_SIZE, SPRITE_SIZE, sprite.pixels.data());
     }
 
-    // Create texture
-    // g_graphics is declared in framework/graphics/graphics.h
-    auto texture = g_graphics.createTexture(32, 32, pixels.data());
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    for (auto& sprite : m_uploading) {
+        if (sprite.pixels.capacity() >= SPRITE_BYTES) {
+            m_freePixels.push_back(std::move(sprite.pixels));
+        }
+    }
+    m_uploading.clear();
+}
+
+bool ThingTypeManager::decodeSprite(uint32_t spriteId, uint8_t* pixels) const {
+    if (spriteId == 0 || spriteId >= m_spriteOffsets.size()) {
+        return false;
+    }
+
+    uint32_t offset = m_spriteOffsets[spriteId];
+    if (offset == 0 || offset >= m_sprData.size()) {
+        return false;
+    }
+
+    // Parse sprite data
+    // Format: 3 bytes transparent color, 2 bytes data size, then pixel data
+    size_t pos = offset;
+
+    if (pos + 5 > m_sprData.size()) return false;
+
+    // Skip transparent color (3 bytes)
+    pos += 3;
 
-    m_spriteCache[spriteId] = texture;
-    return texture;
+    // Pixel data size
+    uint16_t pixelDataSize = m_sprData[pos] | (m_sprData[pos + 1] << 8);
+    pos += 2;
+
+    if (pos + pixelDataSize > m_sprData.size()) return false;
+
+    static_assert(SPRITE_BYTES == spritecodec::RGBA_SIZE, "sprite size mismatch");
+
+    // A truncated run still yields the pixels decoded before it
+    static const spritecodec::Kernel kernel = spritecodec::getBestKernel();
+    spritecodec::decode(kernel, m_sprData.data() + pos, pixelDataSize, pixels);
+    return true;
 }
 
 } // namespace client
@@ -6,12 +6,22 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_set>
 #include <vector>
 #include <map>
 #include <string>
+#include <framework/core/jobsystem.h>
+#include <framework/core/mappedfile.h>
 #include <framework/graphics/graphics.h>
+#include <framework/graphics/textureatlas.h>
 
 namespace shadow {
 namespace client {
@@ -85,8 +95,8 @@ public:
     void setCategory(ThingCategory cat) { m_category = cat; }
 
     // Dimensions
-    int getWidth() const { return m_width; }
-    int getHeight() const { return m_height; }
+    int getWidth() const { return m_hot.width; }
+    int getHeight() const { return m_hot.height; }
     int getExactSize() const { return m_exactSize; }
     int getLayers() const { return m_layers; }
     int getPatternX() const { return m_patternX; }
@@ -98,8 +108,14 @@ public:
     int getDisplacementX() const { return m_displacementX; }
     int getDisplacementY() const { return m_displacementY; }
 
-    // Flags
-    bool hasAttr(ThingAttr attr) const;
+    // Flags: one bit per attribute, Animation in the top bit
+    static constexpr uint64_t attrMask(ThingAttr attr) {
+        uint8_t value = static_cast<uint8_t>(attr);
+        if (attr == ThingAttr::Animation) return 1ull << 63;
+        return value < 63 ? 1ull << value : 0;
+    }
+    bool hasAttr(ThingAttr attr) const { return (m_hot.attrs & attrMask(attr)) != 0; }
+    uint64_t getAttrs() const { return m_hot.attrs; }
     bool isGround() const { return hasAttr(ThingAttr::Ground); }
     bool isStackable() const { return hasAttr(ThingAttr::Stackable); }
     bool isContainer() const { return hasAttr(ThingAttr::Container); }
@@ -117,14 +133,14 @@ public:
     bool isAnimateAlways() const { return hasAttr(ThingAttr::AnimateAlways); }
 
     // Light
-    uint8_t getLightIntensity() const { return m_lightIntensity; }
-    uint8_t getLightColor() const { return m_lightColor; }
+    uint8_t getLightIntensity() const { return m_hot.lightIntensity; }
+    uint8_t getLightColor() const { return m_hot.lightColor; }
 
     // Speed (for ground)
-    uint16_t getSpeed() const { return m_speed; }
+    uint16_t getSpeed() const { return m_hot.speed; }
 
     // Elevation
-    int getElevation() const { return m_elevation; }
+    int getElevation() const { return m_hot.elevation; }
 
     // Container size
     uint8_t getContainerSize() const { return m_containerSize; }
@@ -162,6 +178,21 @@ public:
     uint8_t getAnimationStartPhase() const { return m_animationStartPhase; }
     const std::vector<std::pair<uint32_t, uint32_t>>& getAnimationDurations() const { return m_animationDurations; }
 
+    // Timed animation from the shared clock (ThingTypeManager::
+    // getAnimationTime) instead of a per-object tick. Each phase lasts the
+    // middle of its .dat duration range, or DEFAULT_PHASE_DURATION in
+    // formats without one; their ends within a cycle are tabled at load.
+    // Sync types, and all of those older formats, show the same phase
+    // everywhere; async ones count from when the object appeared, and a
+    // finite loop count holds the last phase once played.
+    static constexpr uint32_t DEFAULT_PHASE_DURATION = 500;    // ms
+    static constexpr uint8_t RANDOM_START_PHASE = 255;
+    bool isAnimated() const { return m_phaseEnds.size() > 1; }
+    bool isSyncAnimation() const { return m_animationType == 1 || m_animationDurations.empty(); }
+    uint32_t getAnimationCycle() const { return m_phaseEnds.empty() ? 0 : m_phaseEnds.back(); }
+    // elapsedMs: the clock for sync types, time since appearing for async
+    int getPhaseAt(uint32_t elapsedMs) const;
+
     // Sprite IDs
     const std::vector<uint32_t>& getSpriteIds() const { return m_spriteIds; }
     uint32_t getSpriteId(int index) const { return index < static_cast<int>(m_spriteIds.size()) ? m_spriteIds[index] : 0; }
@@ -170,18 +201,37 @@ public:
     void draw(int x, int y, float scale = 1.0f,
               int patternX = 0, int patternY = 0, int patternZ = 0,
               int animationPhase = 0);
-
-    // Sprites
-    void setSprite(int index, std::shared_ptr<framework::Texture> sprite);
-    std::shared_ptr<framework::Texture> getSprite(int index) const;
+    // Same sprites through the instanced path. With outfit colors (head,
+    // body, legs, feet) layer 1 is the template that colors layer 0 in the
+    // shader; without, every layer is drawn as is.
+    void drawInstanced(int x, int y, float scale, int patternX, int patternY, int patternZ, int animationPhase,
+                       const std::array<framework::Color, 4>* outfitColors = nullptr);
 
 private:
+    friend class ThingTypeCache;
+
+    // Derived from the animation data after a parse or cache load
+    void buildPhaseTable();
+
+    // What tiles, pathfinding and the draw loop read for every thing,
+    // packed into 16 bytes at the start of the type
+    struct HotProperties {
+        uint64_t attrs{0};
+        uint16_t speed{0};
+        uint16_t elevation{0};
+        uint8_t lightIntensity{0};
+        uint8_t lightColor{0};
+        uint8_t width{1};
+        uint8_t height{1};
+    };
+    static_assert(sizeof(HotProperties) == 16, "hot properties should stay packed");
+
+    HotProperties m_hot;
+
     uint16_t m_id{0};
     ThingCategory m_category{ThingCategory::Item};
 
     // Dimensions
-    int m_width{1};
-    int m_height{1};
     int m_exactSize{32};
     int m_layers{1};
     int m_patternX{1};
@@ -193,14 +243,7 @@ private:
     int m_displacementX{0};
     int m_displacementY{0};
 
-    // Attributes
-    std::map<ThingAttr, bool> m_attrs;
-
     // Properties
-    uint16_t m_speed{0};
-    uint8_t m_lightIntensity{0};
-    uint8_t m_lightColor{0};
-    int m_elevation{0};
     uint8_t m_containerSize{0};
     uint8_t m_minimapColor{0};
     uint16_t m_lensHelp{0};
@@ -227,12 +270,12 @@ private:
     int32_t m_animationLoopCount{-1};
     uint8_t m_animationStartPhase{0};
     std::vector<std::pair<uint32_t, uint32_t>> m_animationDurations;
+    std::vector<uint32_t> m_phaseEnds;      // Each phase's end within one cycle, ms
+    uint32_t m_phaseOffset{0};              // Start of the start phase
 
     // Sprite IDs
     std::vector<uint32_t> m_spriteIds;
 
-    // Loaded sprites (textures)
-    std::vector<std::shared_ptr<framework::Texture>> m_sprites;
 };
 
 // Alias for items
@@ -244,6 +287,8 @@ class ThingTypeManager {
 public:
     static ThingTypeManager& instance();
 
+    // Served from a binary cache of the parsed tables when one exists for
+    // this .dat in the cache directory; otherwise parsed and cached
     bool loadDat(const std::string& filename);
     bool loadSpr(const std::string& filename);
 
@@ -253,8 +298,57 @@ public:
     ThingType* getEffectType(uint16_t id);
     ThingType* getMissileType(uint16_t id);
 
-    // Sprite loading
-    std::shared_ptr<framework::Texture> loadSprite(uint32_t spriteId);
+    // Sprite loading: decoded on first use into the sprite atlas. The
+    // region stays valid until the next sprite is loaded. While the
+    // decoder runs, a sprite not yet in the atlas is queued and nullptr is
+    // returned; callers skip it until it arrives a frame or two later.
+    static constexpr int SPRITE_SIZE = 32;
+    static constexpr size_t SPRITE_BYTES = SPRITE_SIZE * SPRITE_SIZE * 4;
+    const framework::AtlasRegion* loadSprite(uint32_t spriteId);
+    const framework::TextureAtlas& getSpriteAtlas() const { return m_spriteAtlas; }
+
+    // Decoding on g_jobs, at most `jobs` sprites at once; 0 picks a count
+    // from the hardware. Without it sprites are decoded inline on first draw.
+    void initDecoder(int jobs = 0);
+    void terminateDecoder();
+
+    // Warm sprites likely to be drawn soon, such as those on the known
+    // tiles the player walks toward. They decode after every sprite a
+    // draw is waiting on, and a draw that asks for one still queued moves
+    // it ahead. Without the decoder this does nothing.
+    static constexpr size_t PREFETCH_QUEUE_MAX = 1024;
+    void prefetchSprites(const std::vector<uint32_t>& spriteIds);
+    uint64_t getPrefetchedSpriteCount() const { return m_prefetchedSprites; }
+
+    // Decoded sprites uploaded per frame; the rest wait for later frames
+    void setSpriteUploadBudget(size_t sprites) { m_uploadBudget = sprites; }
+    size_t getPendingSpriteCount() const { return m_decodePending.size(); }
+
+    // Lookups that returned nullptr because the sprite was still decoding.
+    // Callers that keep what they drew compare it before and after drawing
+    // to know the result is incomplete.
+    uint64_t getDeferredSpriteCount() const { return m_deferredSprites; }
+
+    // Bumped whenever .dat or .spr data is replaced, invalidating anything
+    // rendered from the previous data
+    uint32_t getGeneration() const { return m_generation; }
+
+    // Advance sprite page recency, upload decoded sprites and sample the
+    // animation clock; call once per rendered frame
+    void nextFrame();
+
+    // Milliseconds since start, the same for every draw of a frame
+    uint32_t getAnimationTime() const { return m_animationTime; }
+
+    // Texture memory the sprite atlas may hold; the least recently drawn
+    // page is recycled once it is reached
+    void setSpriteCacheBudget(size_t bytes) { m_spriteAtlas.setMemoryBudget(bytes); }
+    size_t getSpriteCacheBudget() const { return m_spriteAtlas.getMemoryBudget(); }
+    const framework::TextureAtlas::Stats& getSpriteCacheStats() const { return m_spriteAtlas.getStats(); }
+
+    // Where parsed .dat tables are cached; empty disables the cache
+    void setCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+    const std::string& getCacheDirectory() const { return m_cacheDirectory; }
 
     // Stats
     uint16_t getItemCount() const { return static_cast<uint16_t>(m_items.size()); }
@@ -262,16 +356,71 @@ public:
 
 private:
     ThingTypeManager() = default;
+    ~ThingTypeManager();
 
     std::vector<std::unique_ptr<ThingType>> m_items;
     std::vector<std::unique_ptr<ThingType>> m_creatures;
     std::vector<std::unique_ptr<ThingType>> m_effects;
     std::vector<std::unique_ptr<ThingType>> m_missiles;
+    std::string m_cacheDirectory;
+
+    std::chrono::steady_clock::time_point m_animationEpoch{std::chrono::steady_clock::now()};
+    uint32_t m_animationTime{0};
+
+    bool parseDat(const std::string& filename);
 
-    // Sprite file data
-    std::vector<uint8_t> m_sprData;
+    // Sprite file data: a read-only map of the .spr file, or a copy of it
+    // when it cannot be mapped (e.g. it came from an asset pack). Only the
+    // offset table is read at load; sprite pages fault in on first decode.
+    // decodeSprite writes every byte of its output.
+    framework::MappedFile m_sprFile;
+    std::vector<uint8_t> m_sprBuffer;
+    std::span<const uint8_t> m_sprData;
     std::vector<uint32_t> m_spriteOffsets;
-    std::map<uint32_t, std::shared_ptr<framework::Texture>> m_spriteCache;
+    framework::TextureAtlas m_spriteAtlas;
+    std::vector<uint8_t> m_decodeBuffer;
+
+    bool parseSpr(const std::string& filename);
+    static std::span<const uint8_t> openFile(const std::string& filename, framework::MappedFile& file,
+                                             std::vector<uint8_t>& buffer);
+    bool decodeSprite(uint32_t spriteId, uint8_t* rgba) const;
+
+    // Background decoding. Decode jobs only read m_sprData, which loadSpr
+    // replaces after stopping them.
+    struct DecodedSprite {
+        uint32_t spriteId{0};
+        std::vector<uint8_t> pixels;     // Empty for an invalid sprite
+    };
+
+    // Tops up decode jobs for what is queued; main thread
+    void scheduleDecode();
+    // One decode job: takes sprites until both queues are empty
+    void decodeQueued();
+    void uploadDecodedSprites();
+
+    std::vector<framework::JobSystem::Handle> m_decodeJobs;    // Main thread only
+    size_t m_decodeJobLimit{0};
+    bool m_decodeRunning{false};
+    std::mutex m_decodeMutex;
+    size_t m_decodeJobsActive{0};
+    std::deque<uint32_t> m_decodeQueue;
+    // Prefetch hints, taken only when m_decodeQueue is empty. An id leaves
+    // m_prefetchQueued when a draw promotes it; its stale queue entry is
+    // then skipped.
+    std::deque<uint32_t> m_prefetchQueue;
+    std::unordered_set<uint32_t> m_prefetchQueued;
+    std::atomic<size_t> m_prefetchWaiting{0};
+    std::vector<DecodedSprite> m_decoded;
+    std::vector<std::vector<uint8_t>> m_freePixels;   // Recycled decode buffers
+    std::vector<DecodedSprite> m_uploading;           // Main thread only
+
+    // Main thread only: queued or decoded, not yet in the atlas
+    std::unordered_set<uint32_t> m_decodePending;
+    std::unordered_set<uint32_t> m_invalidSprites;    // Decoded once and failed
+    size_t m_uploadBudget{256};
+    uint64_t m_deferredSprites{0};
+    uint64_t m_prefetchedSprites{0};
+    uint32_t m_generation{0};
 };
 
 } // namespace client
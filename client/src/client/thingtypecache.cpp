@@ -0,0 +1,284 @@
+/**
+ * Shadow OT Client - Thing Type Cache Implementation
+ */
+
+#include "thingtypecache.h"
+#include "thingtype.h"
+#include <framework/core/mappedfile.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace shadow {
+namespace client {
+
+template<typename T>
+static void writeLE(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8));
+    }
+}
+
+template<typename T>
+static T readLE(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (i * 8);
+    }
+    return static_cast<T>(value);
+}
+
+static uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Appends fields in little-endian order
+class CacheWriter {
+public:
+    explicit CacheWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    template<typename T>
+    void operator()(const T& value) {
+        if constexpr (std::is_enum_v<T>) {
+            (*this)(static_cast<std::underlying_type_t<T>>(value));
+        } else {
+            size_t pos = m_out.size();
+            m_out.resize(pos + sizeof(T));
+            writeLE(m_out.data() + pos, value);
+        }
+    }
+
+    void operator()(const std::string& value) {
+        (*this)(static_cast<uint32_t>(value.size()));
+        m_out.insert(m_out.end(), value.begin(), value.end());
+    }
+
+    template<typename T>
+    void operator()(const std::vector<T>& values) {
+        (*this)(static_cast<uint32_t>(values.size()));
+        for (const auto& value : values) (*this)(value);
+    }
+
+    template<typename A, typename B>
+    void operator()(const std::pair<A, B>& value) {
+        (*this)(value.first);
+        (*this)(value.second);
+    }
+
+private:
+    std::vector<uint8_t>& m_out;
+};
+
+// Reads fields back; once out of data every later read fails
+class CacheReader {
+public:
+    CacheReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    bool ok() const { return m_ok; }
+
+    template<typename T>
+    void operator()(T& value) {
+        if constexpr (std::is_enum_v<T>) {
+            std::underlying_type_t<T> raw{};
+            (*this)(raw);
+            value = static_cast<T>(raw);
+        } else {
+            if (!take(sizeof(T))) return;
+            value = readLE<T>(m_data + m_pos - sizeof(T));
+        }
+    }
+
+    void operator()(std::string& value) {
+        uint32_t size = 0;
+        (*this)(size);
+        if (!take(size)) return;
+        value.assign(reinterpret_cast<const char*>(m_data + m_pos - size), size);
+    }
+
+    template<typename T>
+    void operator()(std::vector<T>& values) {
+        uint32_t count = 0;
+        (*this)(count);
+        if (!m_ok || count > m_size - m_pos) {
+            m_ok = false;
+            return;
+        }
+        values.resize(count);
+        for (auto& value : values) (*this)(value);
+    }
+
+    template<typename A, typename B>
+    void operator()(std::pair<A, B>& value) {
+        (*this)(value.first);
+        (*this)(value.second);
+    }
+
+private:
+    bool take(size_t bytes) {
+        if (!m_ok || bytes > m_size - m_pos) {
+            m_ok = false;
+            return false;
+        }
+        m_pos += bytes;
+        return true;
+    }
+
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos{0};
+    bool m_ok{true};
+};
+
+template<typename Archive, typename Type>
+void ThingTypeCache::transfer(Archive& ar, Type& type) {
+    ar(type.m_id);
+    ar(type.m_category);
+    ar(type.m_hot.attrs);
+    ar(type.m_hot.speed);
+    ar(type.m_hot.elevation);
+    ar(type.m_hot.lightIntensity);
+    ar(type.m_hot.lightColor);
+    ar(type.m_hot.width);
+    ar(type.m_hot.height);
+    ar(type.m_exactSize);
+    ar(type.m_layers);
+    ar(type.m_patternX);
+    ar(type.m_patternY);
+    ar(type.m_patternZ);
+    ar(type.m_animPhases);
+    ar(type.m_displacementX);
+    ar(type.m_displacementY);
+    ar(type.m_containerSize);
+    ar(type.m_minimapColor);
+    ar(type.m_lensHelp);
+    ar(type.m_maxTextLength);
+    ar(type.m_clothSlot);
+    ar(type.m_marketCategory);
+    ar(type.m_marketTradeAs);
+    ar(type.m_marketShowAs);
+    ar(type.m_marketName);
+    ar(type.m_defaultAction);
+    ar(type.m_cyclopediaType);
+    ar(type.m_upgradeClassification);
+    ar(type.m_animationType);
+    ar(type.m_animationLoopCount);
+    ar(type.m_animationStartPhase);
+    ar(type.m_animationDurations);
+    ar(type.m_spriteIds);
+}
+
+bool ThingTypeCache::getSource(const std::string& path, Source& source) {
+    std::error_code error;
+    uintmax_t size = fs::file_size(path, error);
+    if (error) return false;
+    auto mtime = fs::last_write_time(path, error);
+    if (error) return false;
+
+    source.size = static_cast<uint64_t>(size);
+    source.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+bool ThingTypeCache::load(const std::string& cachePath, const Source& source, const Tables& tables) {
+    framework::MappedFile file;
+    if (!file.open(cachePath, framework::MappedFile::Mode::ReadOnly) || file.size() < HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t* header = file.data();
+    uint64_t payloadSize = readLE<uint64_t>(header + 24);
+    if (readLE<uint32_t>(header) != MAGIC ||
+        readLE<uint16_t>(header + 4) != VERSION ||
+        readLE<uint64_t>(header + 8) != source.size ||
+        readLE<int64_t>(header + 16) != source.mtime ||
+        payloadSize != file.size() - HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t* payload = header + HEADER_SIZE;
+    if (fnv1a(payload, payloadSize) != readLE<uint64_t>(header + 32)) {
+        return false;
+    }
+
+    // Parse into scratch tables so a bad cache leaves the current ones alone
+    std::array<Table, CATEGORY_COUNT> loaded;
+    CacheReader reader(payload, payloadSize);
+    for (auto& table : loaded) {
+        uint32_t slots = 0;
+        reader(slots);
+        if (!reader.ok() || slots > payloadSize) return false;
+
+        table.resize(slots);
+        for (auto& slot : table) {
+            uint8_t present = 0;
+            reader(present);
+            if (!present) continue;
+
+            slot = std::make_unique<ThingType>();
+            transfer(reader, *slot);
+            slot->buildPhaseTable();
+        }
+    }
+    if (!reader.ok()) return false;
+
+    for (int i = 0; i < CATEGORY_COUNT; ++i) {
+        *tables[i] = std::move(loaded[i]);
+    }
+    return true;
+}
+
+bool ThingTypeCache::save(const std::string& cachePath, const Source& source, const Tables& tables) {
+    std::vector<uint8_t> data(HEADER_SIZE);
+    CacheWriter writer(data);
+    for (const Table* table : tables) {
+        writer(static_cast<uint32_t>(table->size()));
+        for (const auto& slot : *table) {
+            writer(static_cast<uint8_t>(slot != nullptr));
+            if (slot) transfer(writer, *slot);
+        }
+    }
+
+    uint8_t* header = data.data();
+    uint64_t payloadSize = data.size() - HEADER_SIZE;
+    writeLE<uint32_t>(header, MAGIC);
+    writeLE<uint16_t>(header + 4, VERSION);
+    writeLE<uint16_t>(header + 6, 0);
+    writeLE<uint64_t>(header + 8, source.size);
+    writeLE<int64_t>(header + 16, source.mtime);
+    writeLE<uint64_t>(header + 24, payloadSize);
+    writeLE<uint64_t>(header + 32, fnv1a(header + HEADER_SIZE, payloadSize));
+
+    std::error_code error;
+    fs::path target(cachePath);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), error);
+    }
+
+    fs::path temporary = target;
+    temporary += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            out.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace client
+} // namespace shadow
@@ -0,0 +1,59 @@
+/**
+ * Shadow OT Client - Thing Type Cache
+ *
+ * Binary snapshot of the parsed ThingType tables, so later launches skip
+ * the .dat parse. The file is keyed on the size and modification time of
+ * the .dat it was built from and checksummed; any mismatch means the
+ * caller parses the .dat again and rewrites the cache.
+ *
+ *   header:  "STTC" magic, u16 version, u16 reserved, u64 source size,
+ *            i64 source mtime, u64 payload size, u64 payload FNV-1a
+ *   payload: per category a u32 slot count and, per slot, a presence
+ *            byte followed by the type's fields
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace shadow {
+namespace client {
+
+class ThingType;
+
+class ThingTypeCache {
+public:
+    static constexpr uint32_t MAGIC = 0x43545453; // "STTC"
+    static constexpr uint16_t VERSION = 2;
+    static constexpr size_t HEADER_SIZE = 40;
+    static constexpr int CATEGORY_COUNT = 4;
+
+    using Table = std::vector<std::unique_ptr<ThingType>>;
+    using Tables = std::array<Table*, CATEGORY_COUNT>;   // Items, creatures, effects, missiles
+
+    // Identity of the source file; false if it cannot be stat'ed
+    struct Source {
+        uint64_t size{0};
+        int64_t mtime{0};
+    };
+    static bool getSource(const std::string& path, Source& source);
+
+    // Fill the tables from the cache at cachePath if it was built from source
+    static bool load(const std::string& cachePath, const Source& source, const Tables& tables);
+
+    // Written to a temporary file and renamed into place, so clients starting
+    // at the same time never read a partial cache
+    static bool save(const std::string& cachePath, const Source& source, const Tables& tables);
+
+private:
+    // Field list shared by reading and writing; bump VERSION when it changes
+    template<typename Archive, typename Type>
+    static void transfer(Archive& ar, Type& type);
+};
+
+} // namespace client
+} // namespace shadow
@@ -4,75 +4,221 @@
 
 #include "tile.h"
 #include "thingtype.h"
+#include "map.h"
+#include <framework/core/memorytracker.h>
 #include <framework/graphics/graphics.h>
 #include <algorithm>
+#include <array>
 
 namespace shadow {
 namespace client {
 
-Tile::Tile(const Position& pos) : m_position(pos) {}
+Tile::Tile(const Position& pos) : m_position(pos) {
+    g_memory.allocate(framework::MemoryTag::MapTiles, sizeof(Tile));
+}
+
+Tile::~Tile() {
+    g_memory.release(framework::MemoryTag::MapTiles, sizeof(Tile));
+}
 
 void Tile::setGround(ItemPtr item) {
-    m_ground = item;
+    while (m_things.count(ThingStack::BucketGround)) {
+        m_things.eraseAt(m_things.begin(ThingStack::BucketGround));
+    }
     if (item) {
         item->setTile(shared_from_this());
         item->setPosition(m_position);
-        item->setStackPos(0);
+        m_things.insert(item, ThingStack::BucketGround);
     }
+    g_map.invalidateGround(m_position);
+    updateStackPositions();
     updateFlags();
+    updateLights();
 }
 
 void Tile::addItem(ItemPtr item) {
     if (!item) return;
 
+    // Ground replaces ground; everything else goes to the end of its layer
+    ThingType* type = item->getItemType();
+    if (ThingStack::classify(type) == ThingStack::BucketGround) {
+        setGround(item);
+        return;
+    }
+
     item->setTile(shared_from_this());
     item->setPosition(m_position);
-
-    // Insert based on item type
-    // Ground items go first, then by layer
-    if (item->isGround()) {
-        setGround(item);
-    } else {
-        m_items.push_back(item);
-        item->setStackPos(static_cast<int>(m_items.size()));
+    if (m_things.insert(item) >= 0 && ThingStack::classify(type) == ThingStack::BucketBottom) {
+        g_map.invalidateGround(m_position);
     }
 
+    updateStackPositions();
     updateFlags();
+    updateLights();
 }
 
 void Tile::removeItem(ItemPtr item) {
     if (!item) return;
 
-    if (m_ground == item) {
-        m_ground = nullptr;
-    } else {
-        auto it = std::find(m_items.begin(), m_items.end(), item);
-        if (it != m_items.end()) {
-            m_items.erase(it);
+    int index = m_things.find(item.get());
+    if (index >= 0 && m_things.bucket(static_cast<size_t>(index)) <= ThingStack::BucketBottom) {
+        g_map.invalidateGround(m_position);
+    }
+    if (m_things.erase(item)) {
+        updateStackPositions();
+        updateLights();
+    }
+    updateFlags();
+}
+
+void Tile::refreshItem(const ItemPtr& item) {
+    int index = m_things.find(item.get());
+    if (index < 0) return;
+
+    // The item may have moved between layers as well as changed
+    m_things.refresh(static_cast<size_t>(index));
+    g_map.invalidateGround(m_position);
+    updateStackPositions();
+    updateFlags();
+    updateLights();
+}
+
+bool Tile::describe(const ItemDescription* things, size_t count, size_t& reused) {
+    count = std::min(count, ThingStack::MAX_SIZE);
+
+    // Where each described item lands, as addItem would place it: the
+    // last ground wins, everything else goes to the end of its layer
+    std::array<ThingType*, ThingStack::MAX_SIZE> types;
+    std::array<uint8_t, ThingStack::MAX_SIZE> buckets;
+    size_t ground = count;
+    for (size_t i = 0; i < count; ++i) {
+        types[i] = ThingTypeManager::instance().getItemType(things[i].id);
+        buckets[i] = ThingStack::classify(types[i]);
+        if (buckets[i] == ThingStack::BucketGround) ground = i;
+    }
+    auto placed = [&](size_t i, uint8_t bucket) {
+        return buckets[i] == bucket && (bucket != ThingStack::BucketGround || i == ground);
+    };
+
+    size_t index = 0;
+    bool same = true;
+    for (uint8_t bucket = 0; bucket < ThingStack::BucketCount && same; ++bucket) {
+        for (size_t i = 0; i < count && same; ++i) {
+            if (!placed(i, bucket)) continue;
+            same = index < m_things.size() && m_things.id(index) == things[i].id &&
+                   m_things.subType(index) == things[i].subType;
+            index++;
         }
     }
+    if (same && index == m_things.size()) {
+        return false;
+    }
 
-    // Update stack positions
-    for (size_t i = 0; i < m_items.size(); i++) {
-        m_items[i]->setStackPos(static_cast<int>(i + 1));
+    std::array<ItemPtr, ThingStack::MAX_SIZE> previous;
+    size_t previousCount = m_things.size();
+    for (size_t i = 0; i < previousCount; ++i) {
+        previous[i] = m_things.item(i);
+    }
+    m_things.clear();
+
+    TilePtr self = shared_from_this();
+    for (uint8_t bucket = 0; bucket < ThingStack::BucketCount; ++bucket) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!placed(i, bucket)) continue;
+
+            ItemPtr item;
+            for (size_t j = 0; j < previousCount && !item; ++j) {
+                if (previous[j] && previous[j]->matches(things[i])) {
+                    item = std::move(previous[j]);
+                }
+            }
+
+            if (item) {
+                reused++;
+            } else {
+                item = Item::create(things[i]);
+            }
+            item->setTile(self);
+            item->setPosition(m_position);
+            m_things.insert(std::move(item), static_cast<ThingStack::Bucket>(bucket));
+        }
     }
 
+    g_map.invalidateGround(m_position);
+    updateStackPositions();
     updateFlags();
+    updateLights();
+    return true;
+}
+
+bool Tile::setCreatures(const CreaturePtr* creatures, size_t count) {
+    if (count == m_creatures.size() && std::equal(creatures, creatures + count, m_creatures.begin())) {
+        return false;
+    }
+
+    for (const auto& creature : m_creatures) {
+        if (creature->getTile().get() == this) creature->setTile(nullptr);
+    }
+    TilePtr self = shared_from_this();
+    m_creatures.assign(creatures, creatures + count);
+    for (const auto& creature : m_creatures) {
+        creature->setTile(self);
+        creature->setPosition(m_position);
+    }
+    updateFlags();
+    return true;
+}
+
+void Tile::clear() {
+    if (!m_things.empty()) {
+        g_map.invalidateGround(m_position);
+    }
+    m_things.clear();
+    for (const auto& creature : m_creatures) {
+        if (creature->getTile().get() == this) creature->setTile(nullptr);
+    }
+    m_creatures.clear();
+    m_effects.clear();
+    m_flags = 0;
+    updateLights();
+}
+
+void Tile::updateLights() {
+    bool lit = false;
+    for (size_t i = 0; i < m_things.size() && !lit; ++i) {
+        const ThingType* type = m_things.type(i);
+        lit = type && type->getLightIntensity() > 0;
+    }
+
+    // Unlit tiles that stay unlit never touch the light index
+    if (lit || m_lit) {
+        g_map.updateTileLights(*this);
+    }
+    m_lit = lit;
+}
+
+void Tile::updateStackPositions() {
+    // Ground is stack position 0 whether or not the tile has one
+    size_t offset = m_things.count(ThingStack::BucketGround) ? 0 : 1;
+    for (size_t i = 0; i < m_things.size(); i++) {
+        m_things.item(i)->setStackPos(static_cast<int>(i + offset));
+    }
 }
 
 ItemPtr Tile::getItem(int stackPos) const {
-    if (stackPos == 0) return m_ground;
-    if (stackPos > 0 && stackPos <= static_cast<int>(m_items.size())) {
-        return m_items[stackPos - 1];
+    if (stackPos == 0) return getGround();
+    size_t index = static_cast<size_t>(stackPos - 1) + m_things.count(ThingStack::BucketGround);
+    if (stackPos > 0 && index < m_things.size()) {
+        return m_things.item(index);
     }
     return nullptr;
 }
 
 ItemPtr Tile::getTopItem() const {
-    if (!m_items.empty()) {
-        return m_items.back();
+    if (!m_things.empty()) {
+        return m_things.item(m_things.size() - 1);
     }
-    return m_ground;
+    return nullptr;
 }
 
 void Tile::addCreature(CreaturePtr creature) {
@@ -93,6 +239,11 @@ void Tile::removeCreature(CreaturePtr creature) {
         m_creatures.erase(it);
     }
 
+    // Off the map; the creature may live on as a known creature
+    if (creature->getTile().get() == this) {
+        creature->setTile(nullptr);
+    }
+
     updateFlags();
 }
 
@@ -130,13 +281,13 @@ void Tile::removeEffect(ThingPtr effect) {
 ThingPtr Tile::getThing(int stackPos) const {
     // Stack order: ground, items (bottom to top), creatures, effects
 
-    if (stackPos == 0) return m_ground;
+    if (stackPos == 0) return getGround();
 
     int pos = 1;
 
     // Items
-    for (const auto& item : m_items) {
-        if (pos == stackPos) return item;
+    for (size_t i = m_things.begin(ThingStack::BucketBottom); i < m_things.size(); ++i) {
+        if (pos == stackPos) return m_things.item(i);
         pos++;
     }
 
@@ -156,8 +307,7 @@ ThingPtr Tile::getThing(int stackPos) const {
 }
 
 int Tile::getThingCount() const {
-    int count = m_ground ? 1 : 0;
-    count += static_cast<int>(m_items.size());
+    int count = static_cast<int>(m_things.size());
     count += static_cast<int>(m_creatures.size());
     count += static_cast<int>(m_effects.size());
     return count;
@@ -165,15 +315,13 @@ int Tile::getThingCount() const {
 
 bool Tile::isWalkable() const {
     // Check if tile is walkable
-    if (!m_ground) return false;
+    if (!m_things.count(ThingStack::BucketGround)) return false;
     if (m_flags & TileFlag_Blocking) return false;
 
-    // Check ground item
-    if (m_ground && m_ground->blocksSolid()) return false;
-
-    // Check items
-    for (const auto& item : m_items) {
-        if (item->blocksSolid()) return false;
+    // Check ground and items
+    for (size_t i = 0; i < m_things.size(); ++i) {
+        const ThingType* type = m_things.type(i);
+        if (type && type->blocksSolid()) return false;
     }
 
     // Check creatures
@@ -188,36 +336,35 @@ bool Tile::isPathable() const {
     if (!isWalkable()) return false;
 
     // Additional pathfind check
-    if (m_ground && m_ground->blocksPathfind()) return false;
-
-    for (const auto& item : m_items) {
-        if (item->blocksPathfind()) return false;
+    for (size_t i = 0; i < m_things.size(); ++i) {
+        const ThingType* type = m_things.type(i);
+        if (type && type->blocksPathfind()) return false;
     }
 
     return true;
 }
 
 bool Tile::isFullGround() const {
-    if (!m_ground) return false;
+    if (!m_things.count(ThingStack::BucketGround)) return false;
 
-    auto type = m_ground->getItemType();
+    auto type = m_things.type(m_things.begin(ThingStack::BucketGround));
     return type && type->isFullGround();
 }
 
 uint16_t Tile::getGroundSpeed() const {
-    if (!m_ground) return 150;
-    return m_ground->getSpeed();
+    if (!m_things.count(ThingStack::BucketGround)) return 150;
+
+    auto type = m_things.type(m_things.begin(ThingStack::BucketGround));
+    return type ? type->getSpeed() : 0;
 }
 
 uint8_t Tile::getLightIntensity() const {
     uint8_t maxIntensity = 0;
 
-    if (m_ground) {
-        maxIntensity = std::max(maxIntensity, m_ground->getLightIntensity());
-    }
-
-    for (const auto& item : m_items) {
-        maxIntensity = std::max(maxIntensity, item->getLightIntensity());
+    for (size_t i = 0; i < m_things.size(); ++i) {
+        if (const ThingType* type = m_things.type(i)) {
+            maxIntensity = std::max(maxIntensity, type->getLightIntensity());
+        }
     }
 
     for (const auto& creature : m_creatures) {
@@ -232,19 +379,11 @@ uint8_t Tile::getLightColor() const {
     uint8_t maxIntensity = 0;
     uint8_t color = 0;
 
-    if (m_ground) {
-        uint8_t intensity = m_ground->getLightIntensity();
-        if (intensity > maxIntensity) {
-            maxIntensity = intensity;
-            color = m_ground->getLightColor();
-        }
-    }
-
-    for (const auto& item : m_items) {
-        uint8_t intensity = item->getLightIntensity();
-        if (intensity > maxIntensity) {
-            maxIntensity = intensity;
-            color = item->getLightColor();
+    for (size_t i = 0; i < m_things.size(); ++i) {
+        const ThingType* type = m_things.type(i);
+        if (type && type->getLightIntensity() > maxIntensity) {
+            maxIntensity = type->getLightIntensity();
+            color = type->getLightColor();
         }
     }
 
@@ -262,36 +401,43 @@ uint8_t Tile::getLightColor() const {
 int Tile::getElevation() const {
     int elevation = 0;
 
-    for (const auto& item : m_items) {
-        elevation += item->getElevation();
+    for (size_t i = m_things.begin(ThingStack::BucketBottom); i < m_things.size(); ++i) {
+        if (const ThingType* type = m_things.type(i)) {
+            elevation += type->getElevation();
+        }
     }
 
     return elevation;
 }
 
 void Tile::draw(int x, int y, float scale) {
-    // Draw order: ground, bottom items, creatures, top items, effects
+    // Draw order: ground, bottom items, common items, creatures, top items, effects
 
     int elevation = 0;
+    auto drawItems = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_things.item(i)->draw(x, y - elevation, scale);
+            if (const ThingType* type = m_things.type(i)) {
+                elevation += type->getElevation();
+            }
+        }
+    };
 
     // Draw ground
-    if (m_ground) {
-        m_ground->draw(x, y, scale);
+    for (size_t i = m_things.begin(ThingStack::BucketGround); i < m_things.end(ThingStack::BucketGround); ++i) {
+        m_things.item(i)->draw(x, y, scale);
     }
 
     // Draw items (bottom layers first)
-    for (const auto& item : m_items) {
-        if (!item->isGround()) {
-            item->draw(x, y - elevation, scale);
-            elevation += item->getElevation();
-        }
-    }
+    drawItems(m_things.begin(ThingStack::BucketBottom), m_things.end(ThingStack::BucketCommon));
 
     // Draw creatures
     for (const auto& creature : m_creatures) {
         creature->draw(x, y - elevation, scale);
     }
 
+    drawItems(m_things.begin(ThingStack::BucketTop), m_things.end(ThingStack::BucketTop));
+
     // Draw effects
     for (const auto& effect : m_effects) {
         effect->draw(x, y, scale);
@@ -302,14 +448,11 @@ void Tile::updateFlags() {
     m_flags = 0;
 
     // Update flags based on items and creatures
-    if (m_ground) {
-        if (m_ground->blocksSolid()) m_flags |= TileFlag_Blocking;
-        if (m_ground->blocksProjectile()) m_flags |= TileFlag_BlockProjectile;
-    }
-
-    for (const auto& item : m_items) {
-        if (item->blocksSolid()) m_flags |= TileFlag_Blocking;
-        if (item->blocksProjectile()) m_flags |= TileFlag_BlockProjectile;
+    for (size_t i = 0; i < m_things.size(); ++i) {
+        const ThingType* type = m_things.type(i);
+        if (!type) continue;
+        if (type->blocksSolid()) m_flags |= TileFlag_Blocking;
+        if (type->blocksProjectile()) m_flags |= TileFlag_BlockProjectile;
     }
 
     for (const auto& creature : m_creatures) {
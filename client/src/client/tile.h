@@ -2,6 +2,7 @@
  * Shadow OT Client - Tile
  *
  * Single map tile containing ground, items, and creatures.
+ * Ground and items share one ThingStack, grouped by draw layer.
  */
 
 #pragma once
@@ -9,6 +10,7 @@
 #include "thing.h"
 #include "item.h"
 #include "creature.h"
+#include "thingstack.h"
 #include <vector>
 #include <memory>
 
@@ -18,11 +20,14 @@ namespace client {
 class Tile : public std::enable_shared_from_this<Tile> {
 public:
     Tile(const Position& pos);
+    ~Tile();
 
     const Position& getPosition() const { return m_position; }
 
     // Ground item
-    ItemPtr getGround() const { return m_ground; }
+    ItemPtr getGround() const {
+        return m_things.count(ThingStack::BucketGround) ? m_things.item(m_things.begin(ThingStack::BucketGround)) : nullptr;
+    }
     void setGround(ItemPtr item);
 
     // Items
@@ -30,8 +35,19 @@ public:
     void removeItem(ItemPtr item);
     ItemPtr getItem(int stackPos) const;
     ItemPtr getTopItem() const;
-    const std::vector<ItemPtr>& getItems() const { return m_items; }
-    int getItemCount() const { return static_cast<int>(m_items.size()); }
+    int getItemCount() const { return static_cast<int>(m_things.size() - m_things.count(ThingStack::BucketGround)); }
+    // Re-read an item's id, count and type after it changed in place
+    void refreshItem(const ItemPtr& item);
+
+    // Ground and items by draw layer
+    const ThingStack& getThings() const { return m_things; }
+
+    // Replace ground and items with a full description in wire order,
+    // updating stack positions, flags and lights once. Current items with
+    // a matching id and count are kept, with their animation state, and
+    // counted in reused. False, touching nothing, if the tile already
+    // holds exactly these things.
+    bool describe(const ItemDescription* things, size_t count, size_t& reused);
 
     // Creatures
     void addCreature(CreaturePtr creature);
@@ -39,6 +55,8 @@ public:
     CreaturePtr getCreature(int stackPos) const;
     CreaturePtr getTopCreature() const;
     const std::vector<CreaturePtr>& getCreatures() const { return m_creatures; }
+    // Replace all creatures; false if they were already these
+    bool setCreatures(const CreaturePtr* creatures, size_t count);
     int getCreatureCount() const { return static_cast<int>(m_creatures.size()); }
 
     // Effects
@@ -47,13 +65,7 @@ public:
     const std::vector<ThingPtr>& getEffects() const { return m_effects; }
 
     // Clear all things from tile
-    void clear() {
-        m_ground = nullptr;
-        m_items.clear();
-        m_creatures.clear();
-        m_effects.clear();
-        m_flags = 0;
-    }
+    void clear();
 
     // Get any thing by stack position
     ThingPtr getThing(int stackPos) const;
@@ -64,7 +76,7 @@ public:
     bool isPathable() const;
     bool isFullGround() const;
     bool hasCreature() const { return !m_creatures.empty(); }
-    bool hasTopItem() const { return !m_items.empty(); }
+    bool hasTopItem() const { return getItemCount() > 0; }
 
     // Speed modifier for walking
     uint16_t getGroundSpeed() const;
@@ -102,13 +114,15 @@ public:
 
 private:
     void updateFlags();
+    void updateStackPositions();
+    void updateLights();
 
     Position m_position;
-    ItemPtr m_ground;
-    std::vector<ItemPtr> m_items;
+    ThingStack m_things;
     std::vector<CreaturePtr> m_creatures;
     std::vector<ThingPtr> m_effects;
     uint32_t m_flags{0};
+    bool m_lit{false};      // Has emitters registered with the map
 };
 
 using TilePtr = std::shared_ptr<Tile>;
@@ -0,0 +1,62 @@
+/**
+ * Shadow OT Client - UI Minimap Implementation
+ */
+
+#include "uiminimap.h"
+#include "minimapview.h"
+#include <framework/graphics/graphics.h>
+#include <algorithm>
+
+namespace shadow {
+namespace client {
+
+using framework::g_graphics;
+
+UIMinimap::UIMinimap() : UIWidget() {
+    m_backgroundColor = framework::Color{0, 0, 0, 255};
+    m_borderColor = framework::Color{60, 60, 60, 255};
+    m_borderWidth = 1;
+    g_minimapView.addWidget(this);
+}
+
+UIMinimap::~UIMinimap() {
+    g_minimapView.removeWidget(this);
+}
+
+void UIMinimap::setCenter(float x, float y, int z) {
+    m_centerX = x;
+    m_centerY = y;
+    m_floor = std::clamp(z, 0, 15);
+    invalidate();
+}
+
+void UIMinimap::setZoom(int zoom) {
+    m_zoom = std::clamp(zoom, MIN_ZOOM, MAX_ZOOM);
+    invalidate();
+}
+
+void UIMinimap::drawSelf() {
+    framework::Rect absRect = getAbsoluteRect();
+
+    framework::Color bgColor = m_backgroundColor;
+    bgColor.a = static_cast<uint8_t>(bgColor.a * m_opacity);
+    g_graphics.drawFilledRect(absRect, bgColor);
+
+    g_minimapView.draw(absRect, m_centerX, m_centerY, m_floor, static_cast<float>(TILE_SIZE * m_zoom));
+
+    // Center mark
+    int cx = absRect.x + absRect.width / 2;
+    int cy = absRect.y + absRect.height / 2;
+    framework::Color markColor{255, 255, 255, static_cast<uint8_t>(255 * m_opacity)};
+    g_graphics.drawLine(cx - 3, cy, cx + 4, cy, markColor);
+    g_graphics.drawLine(cx, cy - 3, cx, cy + 4, markColor);
+
+    if (m_borderWidth > 0) {
+        framework::Color borderColor = m_borderColor;
+        borderColor.a = static_cast<uint8_t>(borderColor.a * m_opacity);
+        g_graphics.drawRect(absRect, borderColor);
+    }
+}
+
+} // namespace client
+} // namespace shadow
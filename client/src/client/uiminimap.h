@@ -0,0 +1,44 @@
+/**
+ * Shadow OT Client - UI Minimap
+ *
+ * Widget showing the explored minimap through MinimapView. Centering and
+ * zooming only move the chunk quads; the tile textures stay as they are.
+ */
+
+#pragma once
+
+#include <framework/ui/uiwidget.h>
+
+namespace shadow {
+namespace client {
+
+class UIMinimap : public framework::UIWidget {
+public:
+    UIMinimap();
+    ~UIMinimap() override;
+
+    // Pixels per tile at zoom 1
+    static constexpr int TILE_SIZE = 2;
+    static constexpr int MIN_ZOOM = 1;
+    static constexpr int MAX_ZOOM = 8;
+
+    void setCenter(float x, float y, int z);
+    float getCenterX() const { return m_centerX; }
+    float getCenterY() const { return m_centerY; }
+    int getFloor() const { return m_floor; }
+
+    void setZoom(int zoom);
+    int getZoom() const { return m_zoom; }
+    int getTileSize() const { return TILE_SIZE; }
+
+    void drawSelf() override;
+
+private:
+    float m_centerX{0.0f};
+    float m_centerY{0.0f};
+    int m_floor{7};
+    int m_zoom{2};
+};
+
+} // namespace client
+} // namespace shadow
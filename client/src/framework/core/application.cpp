@@ -3,10 +3,12 @@
  */
 
 #include "application.h"
+#include <framework/core/profiler.h>
 #include <framework/graphics/graphics.h>
+#include <framework/input/inputmanager.h>
 #include <framework/platform/platform.h>
+#include <algorithm>
 #include <chrono>
-#include <thread>
 
 // Platform is in shadowot namespace to avoid macOS MacTypes.h conflicts
 // g_platform is in global namespace
@@ -25,6 +27,7 @@ struct Application::Impl {
     std::chrono::high_resolution_clock::time_point lastUpdateTime;
     int frameCount{0};
     double fpsAccumulator{0};
+    FramePacer pacer;
 };
 
 Application& Application::instance() {
@@ -94,6 +97,7 @@ void Application::initWindow() {
     });
 
     g_platform.setFocusCallback([this](bool focused) {
+        m_focused = focused;
         if (m_focusCallback) {
             m_focusCallback(focused);
         }
@@ -103,15 +107,96 @@ void Application::initWindow() {
         m_shouldClose = true;
         return true;
     });
+
+    // Queued here, dispatched with the frame by InputManager::dispatchEvents
+    g_platform.setInputCallback([](const shadowot::framework::Platform::InputRecord& record) {
+        using Record = shadowot::framework::Platform::InputRecord;
+        InputEvent event;
+        event.modifiers = record.modifiers;
+        event.code = record.code;
+        event.x = static_cast<int>(record.x);
+        event.y = static_cast<int>(record.y);
+        event.timeUs = record.timeUs;
+        switch (record.type) {
+            case Record::Type::Key:
+                event.type = record.pressed ? InputEvent::Type::KeyDown : InputEvent::Type::KeyUp;
+                event.repeat = record.repeat;
+                break;
+            case Record::Type::Char:
+                event.type = InputEvent::Type::Text;
+                break;
+            case Record::Type::MouseButton:
+                event.type = record.pressed ? InputEvent::Type::MouseDown : InputEvent::Type::MouseUp;
+                break;
+            case Record::Type::MouseMove:
+                event.type = InputEvent::Type::MouseMove;
+                break;
+            case Record::Type::Scroll:
+                // Touchpads report fractions; any movement is at least one step
+                event.type = InputEvent::Type::Wheel;
+                event.x = record.x == 0.0 ? 0 : record.x > 0.0 ? std::max(1, event.x) : std::min(-1, event.x);
+                event.y = record.y == 0.0 ? 0 : record.y > 0.0 ? std::max(1, event.y) : std::min(-1, event.y);
+                break;
+        }
+        g_input.queueEvent(event);
+    });
 }
 
 void Application::poll() {
-    processEvents();
-    updateTiming();
+    if (m_lateLatch) {
+        waitForFrame();
+        processEvents();
+        updateTiming();
+    } else {
+        processEvents();
+        updateTiming();
+        waitForFrame();
+    }
 }
 
 void Application::processEvents() {
+    ProfileScope scope(Profiler::StagePoll);
     g_platform.pollEvents();
+
+    if (m_impl->window) {
+        m_minimized = g_platform.isWindowMinimized(m_impl->window);
+    }
+}
+
+int Application::getPacedFPS() const {
+    if (m_minimized) return m_minimizedFPS;
+    if (!m_focused) return m_backgroundFPS;
+    return m_targetFPS;
+}
+
+void Application::waitForFrame() {
+#ifndef SHADOW_PLATFORM_WEB
+    m_impl->pacer.setTargetFPS(getPacedFPS());
+    if (m_idleCallback) {
+        m_idleCallback(m_impl->pacer.getIdleBudgetMs());
+    }
+
+    // The browser paces the web build through requestAnimationFrame
+    ProfileScope scope(Profiler::StageIdle);
+    m_impl->pacer.wait();
+#else
+    if (m_idleCallback) {
+        m_idleCallback(0.0);
+    }
+#endif
+}
+
+void Application::setVSync(bool enabled) {
+    // The swap interval belongs to the thread holding the context
+    if (g_graphics.isRenderThreadRunning()) {
+        g_graphics.setSwapInterval(enabled ? 1 : 0);
+    } else {
+        g_platform.setVSync(enabled);
+    }
+}
+
+const FramePacer& Application::getFramePacer() const {
+    return m_impl->pacer;
 }
 
 void Application::updateTiming() {
@@ -134,14 +219,6 @@ void Application::updateTiming() {
     std::chrono::duration<double> totalElapsed = now - m_impl->startTime;
     m_frameTime = totalElapsed.count();
 
-    // Frame limiting
-    if (m_targetFPS > 0) {
-        double targetFrameTime = 1.0 / m_targetFPS;
-        if (m_deltaTime < targetFrameTime) {
-            double sleepTime = targetFrameTime - m_deltaTime;
-            std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
-        }
-    }
 }
 
 void Application::setWindowTitle(const std::string& title) {
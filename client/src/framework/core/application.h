@@ -11,6 +11,7 @@
 #include <memory>
 #include <functional>
 #include <atomic>
+#include "framepacer.h"
 
 namespace shadow {
 namespace framework {
@@ -39,9 +40,28 @@ public:
     double getFrameTime() const { return m_frameTime; }
     double getDeltaTime() const { return m_deltaTime; }
     int getFPS() const { return m_fps; }
-    void setTargetFPS(int fps) { m_targetFPS = fps; }
     uint64_t getMilliseconds() const;
 
+    // Frame pacing. poll() holds each frame to the rate of the window's
+    // state: the target while focused, lower rates in the background and
+    // while minimized (0 = unlimited).
+    void setTargetFPS(int fps) { m_targetFPS = fps; }
+    void setBackgroundFPS(int fps) { m_backgroundFPS = fps; }
+    void setMinimizedFPS(int fps) { m_minimizedFPS = fps; }
+    int getTargetFPS() const { return m_targetFPS; }
+    int getPacedFPS() const;
+    bool isFocused() const { return m_focused; }
+    bool isMinimized() const { return m_minimized; }
+    // Late latching waits for the frame deadline before polling events, so
+    // input and everything polled after it is as fresh as possible when the
+    // frame is drawn. Off, poll() waits after the events instead.
+    void setLateLatch(bool enabled) { m_lateLatch = enabled; }
+    bool isLateLatch() const { return m_lateLatch; }
+    // Without vsync the swap returns at once and the pacer alone sets the
+    // rate: lower latency, possible tearing
+    void setVSync(bool enabled);
+    const FramePacer& getFramePacer() const;
+
     // Application info
     const std::string& getVersion() const { return m_version; }
     const std::string& getPlatform() const { return m_platform; }
@@ -58,6 +78,11 @@ public:
     void setResizeCallback(ResizeCallback callback) { m_resizeCallback = callback; }
     void setFocusCallback(FocusCallback callback) { m_focusCallback = callback; }
 
+    // Runs before each frame wait with the time the pacer has to spare
+    // (FramePacer::getIdleBudgetMs); 0 on the web build
+    using IdleCallback = std::function<void(double budgetMs)>;
+    void setIdleCallback(IdleCallback callback) { m_idleCallback = callback; }
+
 private:
     Application();
     ~Application();
@@ -68,12 +93,18 @@ private:
     void initWindow();
     void processEvents();
     void updateTiming();
+    void waitForFrame();
 
     std::atomic<bool> m_shouldClose{false};
     bool m_fullscreen{false};
     int m_windowWidth{1280};
     int m_windowHeight{720};
     int m_targetFPS{60};
+    int m_backgroundFPS{20};
+    int m_minimizedFPS{5};
+    bool m_focused{true};
+    bool m_minimized{false};
+    bool m_lateLatch{true};
     int m_fps{0};
     double m_frameTime{0.0};
     double m_deltaTime{0.0};
@@ -87,6 +118,7 @@ private:
 
     ResizeCallback m_resizeCallback;
     FocusCallback m_focusCallback;
+    IdleCallback m_idleCallback;
 
     struct Impl;
     std::unique_ptr<Impl> m_impl;
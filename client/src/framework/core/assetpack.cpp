@@ -0,0 +1,378 @@
+/**
+ * Shadow OT Client - Asset Pack Implementation
+ */
+
+#include "assetpack.h"
+#include <zlib.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+template<typename T>
+void writeLE(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8));
+    }
+}
+
+template<typename T>
+T readLE(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (i * 8);
+    }
+    return static_cast<T>(value);
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+std::string_view directoryPrefix(std::string_view directory, std::string& storage) {
+    storage = AssetPack::normalize(directory);
+    if (!storage.empty()) storage += '/';
+    return storage;
+}
+
+} // anonymous namespace
+
+// AssetPack
+
+std::string AssetPack::normalize(std::string_view name) {
+    std::string out;
+    out.reserve(name.size());
+    for (size_t i = 0; i < name.size(); ++i) {
+        char c = name[i] == '\\' ? '/' : name[i];
+        if (c == '/') {
+            if (out.empty() || out.back() == '/') continue;
+        } else if (c == '.' && (out.empty() || out.back() == '/') &&
+                   (i + 1 == name.size() || name[i + 1] == '/' || name[i + 1] == '\\')) {
+            continue; // "./"
+        }
+        out += c;
+    }
+    if (!out.empty() && out.back() == '/') out.pop_back();
+    return out;
+}
+
+uint64_t AssetPack::hashName(std::string_view name) {
+    return fnv1a(reinterpret_cast<const uint8_t*>(name.data()), name.size());
+}
+
+bool AssetPack::open(const std::string& path) {
+    close();
+    if (!m_file.open(path, MappedFile::Mode::ReadOnly) || m_file.size() < HEADER_SIZE) {
+        close();
+        return false;
+    }
+
+    const uint8_t* header = m_file.data();
+    uint32_t entryCount = readLE<uint32_t>(header + 8);
+    uint32_t slotCount = readLE<uint32_t>(header + 12);
+    uint64_t tocOffset = readLE<uint64_t>(header + 16);
+    uint64_t tocSize = readLE<uint64_t>(header + 24);
+    uint64_t namesSize = readLE<uint64_t>(header + 40);
+    uint64_t fileSize = m_file.size();
+
+    bool valid = readLE<uint32_t>(header) == MAGIC && readLE<uint16_t>(header + 4) == VERSION &&
+                 slotCount > entryCount && (slotCount & (slotCount - 1)) == 0 &&
+                 tocOffset >= HEADER_SIZE && tocOffset <= fileSize && tocSize <= fileSize - tocOffset &&
+                 tocSize == entryCount * ENTRY_SIZE + uint64_t{slotCount} * sizeof(uint32_t) + namesSize;
+    if (!valid || fnv1a(header + tocOffset, tocSize) != readLE<uint64_t>(header + 32)) {
+        close();
+        return false;
+    }
+
+    const uint8_t* toc = header + tocOffset;
+    const uint8_t* slots = toc + entryCount * ENTRY_SIZE;
+    m_names = reinterpret_cast<const char*>(slots + slotCount * sizeof(uint32_t));
+
+    m_entries.resize(entryCount);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        const uint8_t* in = toc + i * ENTRY_SIZE;
+        Entry& entry = m_entries[i];
+        entry.hash = readLE<uint64_t>(in);
+        entry.offset = readLE<uint64_t>(in + 8);
+        entry.storedSize = readLE<uint64_t>(in + 16);
+        entry.size = readLE<uint64_t>(in + 24);
+        entry.nameOffset = readLE<uint32_t>(in + 32);
+        entry.nameLength = readLE<uint16_t>(in + 36);
+        entry.flags = in[38];
+
+        if (entry.offset > tocOffset || entry.storedSize > tocOffset - entry.offset ||
+            entry.nameOffset + uint64_t{entry.nameLength} > namesSize ||
+            (!entry.isCompressed() && entry.storedSize != entry.size)) {
+            close();
+            return false;
+        }
+    }
+
+    m_slots.resize(slotCount);
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        m_slots[i] = readLE<uint32_t>(slots + i * sizeof(uint32_t));
+        if (m_slots[i] > entryCount) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetPack::close() {
+    m_file.close();
+    m_entries.clear();
+    m_slots.clear();
+    m_names = nullptr;
+}
+
+const AssetPack::Entry* AssetPack::find(std::string_view name) const {
+    if (m_slots.empty()) return nullptr;
+
+    uint64_t hash = hashName(name);
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = hash & mask, probes = 0; probes < m_slots.size(); i = (i + 1) & mask, ++probes) {
+        uint32_t slot = m_slots[i];
+        if (slot == 0) return nullptr;
+        const Entry& entry = m_entries[slot - 1];
+        if (entry.hash == hash && getName(entry) == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetPack::read(const Entry& entry, std::vector<uint8_t>& out) const {
+    const uint8_t* data = m_file.data() + entry.offset;
+    if (!entry.isCompressed()) {
+        out.assign(data, data + entry.size);
+        return true;
+    }
+
+    out.resize(entry.size);
+    uLongf size = static_cast<uLongf>(entry.size);
+    if (uncompress(out.data(), &size, data, static_cast<uLong>(entry.storedSize)) != Z_OK || size != entry.size) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+std::span<const uint8_t> AssetPack::view(const Entry& entry) const {
+    if (entry.isCompressed()) return {};
+    return {m_file.data() + entry.offset, entry.size};
+}
+
+size_t AssetPack::lowerBound(std::string_view name) const {
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), name,
+                               [this](const Entry& entry, std::string_view key) { return getName(entry) < key; });
+    return static_cast<size_t>(it - m_entries.begin());
+}
+
+std::vector<std::string> AssetPack::list(std::string_view directory) const {
+    std::string storage;
+    std::string_view prefix = directoryPrefix(directory, storage);
+
+    // Everything under the prefix is contiguous in name order, and so is
+    // every entry under one child directory
+    std::vector<std::string> children;
+    for (size_t i = lowerBound(prefix); i < m_entries.size(); ++i) {
+        std::string_view name = getName(m_entries[i]);
+        if (!name.starts_with(prefix)) break;
+
+        std::string_view child = name.substr(prefix.size());
+        child = child.substr(0, child.find('/'));
+        if (children.empty() || children.back() != child) {
+            children.emplace_back(child);
+        }
+    }
+    return children;
+}
+
+bool AssetPack::hasDirectory(std::string_view directory) const {
+    std::string storage;
+    std::string_view prefix = directoryPrefix(directory, storage);
+    if (prefix.empty()) return !m_entries.empty();
+
+    size_t i = lowerBound(prefix);
+    return i < m_entries.size() && getName(m_entries[i]).starts_with(prefix);
+}
+
+// AssetPackWriter
+
+void AssetPackWriter::addFile(const std::string& name, const std::string& sourcePath, bool compress) {
+    m_pending.push_back({AssetPack::normalize(name), sourcePath, {}, compress});
+}
+
+void AssetPackWriter::add(const std::string& name, std::vector<uint8_t> data, bool compress) {
+    m_pending.push_back({AssetPack::normalize(name), {}, std::move(data), compress});
+}
+
+bool AssetPackWriter::write(const std::string& path, int level) const {
+    m_stats = Stats{};
+
+    // Name order, the last add of a name winning
+    std::vector<const Pending*> order;
+    for (auto it = m_pending.rbegin(); it != m_pending.rend(); ++it) {
+        order.push_back(&*it);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Pending* a, const Pending* b) { return a->name < b->name; });
+    order.erase(std::unique(order.begin(), order.end(),
+                            [](const Pending* a, const Pending* b) { return a->name == b->name; }),
+                order.end());
+
+    std::error_code error;
+    fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), error);
+    }
+    fs::path temporary = target;
+    temporary += ".tmp" + std::to_string(std::random_device{}());
+
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    auto fail = [&] {
+        out.close();
+        fs::remove(temporary, error);
+        return false;
+    };
+
+    std::vector<uint8_t> head(AssetPack::HEADER_SIZE, 0);
+    if (!out.write(reinterpret_cast<const char*>(head.data()), AssetPack::HEADER_SIZE)) {
+        return fail();
+    }
+
+    std::vector<AssetPack::Entry> entries;
+    std::string names;
+    std::vector<uint8_t> contents;
+    std::vector<uint8_t> deflated;
+    uint64_t position = AssetPack::HEADER_SIZE;
+
+    for (const Pending* pending : order) {
+        if (pending->name.empty() || pending->name.size() > UINT16_MAX) continue;
+
+        const std::vector<uint8_t>* data = &pending->data;
+        if (!pending->sourcePath.empty()) {
+            std::ifstream file(pending->sourcePath, std::ios::binary);
+            if (!file) return fail();
+            contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data = &contents;
+        }
+
+        const std::vector<uint8_t>* payload = data;
+        uint8_t flags = 0;
+        if (pending->compress && !data->empty()) {
+            uLongf size = compressBound(static_cast<uLong>(data->size()));
+            deflated.resize(size);
+            if (compress2(deflated.data(), &size, data->data(), static_cast<uLong>(data->size()), level) == Z_OK &&
+                size <= data->size() - data->size() / 8) {
+                deflated.resize(size);
+                payload = &deflated;
+                flags = AssetPack::FLAG_DEFLATE;
+            }
+        }
+
+        // Stored entries start on a page so they can be mapped in place
+        if (!flags) {
+            uint64_t aligned = (position + AssetPack::ALIGNMENT - 1) / AssetPack::ALIGNMENT * AssetPack::ALIGNMENT;
+            head.assign(aligned - position, 0);
+            if (!out.write(reinterpret_cast<const char*>(head.data()), static_cast<std::streamsize>(head.size()))) {
+                return fail();
+            }
+            position = aligned;
+        }
+        if (!out.write(reinterpret_cast<const char*>(payload->data()), static_cast<std::streamsize>(payload->size()))) {
+            return fail();
+        }
+
+        AssetPack::Entry entry;
+        entry.hash = AssetPack::hashName(pending->name);
+        entry.offset = position;
+        entry.storedSize = payload->size();
+        entry.size = data->size();
+        entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.nameLength = static_cast<uint16_t>(pending->name.size());
+        entry.flags = flags;
+        entries.push_back(entry);
+        names += pending->name;
+        position += payload->size();
+
+        m_stats.entries++;
+        m_stats.compressed += flags ? 1 : 0;
+        m_stats.inputBytes += data->size();
+    }
+
+    // Half-full open addressing keeps probes short
+    uint32_t slotCount = 16;
+    while (slotCount < entries.size() * 2) slotCount <<= 1;
+    std::vector<uint32_t> slots(slotCount, 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        size_t slot = entries[i].hash & (slotCount - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (slotCount - 1);
+        slots[slot] = static_cast<uint32_t>(i + 1);
+    }
+
+    std::vector<uint8_t> toc(entries.size() * AssetPack::ENTRY_SIZE + slotCount * sizeof(uint32_t) + names.size());
+    uint8_t* cursor = toc.data();
+    for (const auto& entry : entries) {
+        writeLE<uint64_t>(cursor, entry.hash);
+        writeLE<uint64_t>(cursor + 8, entry.offset);
+        writeLE<uint64_t>(cursor + 16, entry.storedSize);
+        writeLE<uint64_t>(cursor + 24, entry.size);
+        writeLE<uint32_t>(cursor + 32, entry.nameOffset);
+        writeLE<uint16_t>(cursor + 36, entry.nameLength);
+        cursor[38] = entry.flags;
+        cursor[39] = 0;
+        cursor += AssetPack::ENTRY_SIZE;
+    }
+    for (uint32_t slot : slots) {
+        writeLE<uint32_t>(cursor, slot);
+        cursor += sizeof(uint32_t);
+    }
+    std::copy(names.begin(), names.end(), cursor);
+
+    if (!out.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size()))) {
+        return fail();
+    }
+
+    uint8_t header[AssetPack::HEADER_SIZE] = {};
+    writeLE<uint32_t>(header, AssetPack::MAGIC);
+    writeLE<uint16_t>(header + 4, AssetPack::VERSION);
+    writeLE<uint32_t>(header + 8, static_cast<uint32_t>(entries.size()));
+    writeLE<uint32_t>(header + 12, slotCount);
+    writeLE<uint64_t>(header + 16, position);
+    writeLE<uint64_t>(header + 24, toc.size());
+    writeLE<uint64_t>(header + 32, fnv1a(toc.data(), toc.size()));
+    writeLE<uint64_t>(header + 40, names.size());
+    out.seekp(0);
+    if (!out.write(reinterpret_cast<const char*>(header), sizeof(header))) {
+        return fail();
+    }
+    out.close();
+    if (!out) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    m_stats.outputBytes = position + toc.size();
+
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,129 @@
+/**
+ * Shadow OT Client - Asset Pack
+ *
+ * Client assets in one file, so startup opens and stats a single file
+ * instead of thousands. A hash index over the table of contents makes a
+ * lookup one probe into memory; names are also kept sorted for directory
+ * listings. Entries are stored as-is or deflated: stored entries start on
+ * a 4 KB boundary so they can be mapped or read in place, and compression
+ * is kept only where it saves at least an eighth. The pack is mapped
+ * read-only and never changes once open, so any thread may read it.
+ *
+ * File layout (little-endian):
+ *   header:  "SAPK" magic, u16 version, u16 reserved, u32 entry count,
+ *            u32 slot count, u64 TOC offset, u64 TOC size, u64 TOC FNV-1a,
+ *            u64 names size, reserved to 64 bytes
+ *   data:    entry payloads
+ *   TOC:     entries sorted by name (ENTRY_SIZE bytes each), then hash slots
+ *            (u32 entry index + 1, 0 for empty), then the name bytes
+ *   entry:   u64 name FNV-1a, u64 offset, u64 stored size, u64 size,
+ *            u32 name offset, u16 name length, u8 flags, u8 reserved
+ */
+
+#pragma once
+
+#include "mappedfile.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+class AssetPack {
+public:
+    static constexpr uint32_t MAGIC = 0x4B504153; // "SAPK"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t ENTRY_SIZE = 40;
+    static constexpr size_t ALIGNMENT = 4096;
+    static constexpr uint8_t FLAG_DEFLATE = 1 << 0;
+
+    struct Entry {
+        uint64_t hash{0};
+        uint64_t offset{0};
+        uint64_t storedSize{0};
+        uint64_t size{0};
+        uint32_t nameOffset{0};
+        uint16_t nameLength{0};
+        uint8_t flags{0};
+
+        bool isCompressed() const { return flags & FLAG_DEFLATE; }
+    };
+
+    // Names are relative, '/'-separated, without "./" or duplicate slashes
+    static std::string normalize(std::string_view name);
+    static uint64_t hashName(std::string_view name);
+
+    AssetPack() = default;
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Fails on I/O errors, a bad header or a TOC that does not check out
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    const std::string& getPath() const { return m_file.getPath(); }
+
+    // Lookup by normalized name; nullptr if not packed
+    const Entry* find(std::string_view name) const;
+    std::string_view getName(const Entry& entry) const {
+        return {m_names + entry.nameOffset, entry.nameLength};
+    }
+    const std::vector<Entry>& getEntries() const { return m_entries; }
+
+    bool read(const Entry& entry, std::vector<uint8_t>& out) const;
+    // A stored entry's bytes inside the pack mapping; empty if compressed
+    std::span<const uint8_t> view(const Entry& entry) const;
+
+    // Immediate children of a directory ("" for the root), names only
+    std::vector<std::string> list(std::string_view directory) const;
+    bool hasDirectory(std::string_view directory) const;
+
+private:
+    // Index of the first entry named at or after `name`
+    size_t lowerBound(std::string_view name) const;
+
+    MappedFile m_file;
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_slots;
+    const char* m_names{nullptr};
+};
+
+// Builds a pack; used by the shadow-pack tool
+class AssetPackWriter {
+public:
+    // Contents read from sourcePath when the pack is written. A later add
+    // of the same name replaces the earlier one.
+    void addFile(const std::string& name, const std::string& sourcePath, bool compress);
+    void add(const std::string& name, std::vector<uint8_t> data, bool compress);
+    size_t getEntryCount() const { return m_pending.size(); }
+
+    // Written to a temporary file and renamed into place
+    bool write(const std::string& path, int level = 6) const;
+
+    struct Stats {
+        size_t entries{0};
+        size_t compressed{0};
+        uint64_t inputBytes{0};
+        uint64_t outputBytes{0};
+    };
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct Pending {
+        std::string name;
+        std::string sourcePath;
+        std::vector<uint8_t> data;
+        bool compress{false};
+    };
+
+    std::vector<Pending> m_pending;
+    mutable Stats m_stats;
+};
+
+} // namespace framework
+} // namespace shadow
@@ -75,6 +75,7 @@ bool ConfigManager::load(const std::string& filename) {
         }
     }
 
+    refreshAll();
     return true;
 }
 
@@ -115,6 +116,7 @@ bool ConfigManager::save(const std::string& filename) {
 
 void ConfigManager::clear() {
     m_values.clear();
+    refreshAll();
 }
 
 bool ConfigManager::getBool(const std::string& key, bool defaultValue) const {
@@ -173,18 +175,22 @@ std::string ConfigManager::getString(const std::string& key, const std::string&
 
 void ConfigManager::setBool(const std::string& key, bool value) {
     m_values[key] = value;
+    changed(key);
 }
 
 void ConfigManager::setInt(const std::string& key, int value) {
     m_values[key] = value;
+    changed(key);
 }
 
 void ConfigManager::setDouble(const std::string& key, double value) {
     m_values[key] = value;
+    changed(key);
 }
 
 void ConfigManager::setString(const std::string& key, const std::string& value) {
     m_values[key] = value;
+    changed(key);
 }
 
 bool ConfigManager::hasKey(const std::string& key) const {
@@ -192,7 +198,9 @@ bool ConfigManager::hasKey(const std::string& key) const {
 }
 
 void ConfigManager::remove(const std::string& key) {
-    m_values.erase(key);
+    if (m_values.erase(key)) {
+        changed(key);
+    }
 }
 
 std::map<std::string, ConfigManager::ConfigValue> ConfigManager::getSection(const std::string& prefix) const {
@@ -210,7 +218,85 @@ std::map<std::string, ConfigManager::ConfigValue> ConfigManager::getSection(cons
 
 void ConfigManager::setSection(const std::string& prefix, const std::map<std::string, ConfigValue>& values) {
     for (const auto& [key, value] : values) {
-        m_values[prefix + "." + key] = value;
+        std::string fullKey = prefix + "." + key;
+        m_values[fullKey] = value;
+        changed(fullKey);
+    }
+}
+
+ConfigManager::Slot& ConfigManager::intern(const std::string& key) {
+    auto it = m_slotIndex.find(key);
+    if (it != m_slotIndex.end()) {
+        return *it->second;
+    }
+
+    Slot& slot = m_slots.emplace_back();
+    slot.key = key;
+    m_slotIndex.emplace(key, &slot);
+
+    auto value = m_values.find(key);
+    refresh(slot, value != m_values.end() ? &value->second : nullptr);
+    return slot;
+}
+
+bool ConfigManager::refresh(Slot& slot, const ConfigValue* value) {
+    uint8_t present = slot.present;
+    bool asBool = slot.asBool;
+    double asDouble = slot.asDouble;
+    std::string asString = std::move(slot.asString);
+
+    slot.present = 0;
+    slot.asString.clear();
+    if (value) {
+        assign(slot, *value);
+    }
+    // asInt follows asDouble
+    return present != slot.present || asBool != slot.asBool || asDouble != slot.asDouble || asString != slot.asString;
+}
+
+void ConfigManager::assign(Slot& slot, const ConfigValue& value) {
+    std::visit([&slot](auto&& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, bool>) {
+            slot.asBool = v;
+            slot.present = PresentBool;
+        } else if constexpr (std::is_same_v<T, int>) {
+            slot.asInt = v;
+            slot.asDouble = static_cast<double>(v);
+            slot.present = PresentInt | PresentDouble;
+        } else if constexpr (std::is_same_v<T, double>) {
+            slot.asDouble = v;
+            slot.asInt = static_cast<int>(v);
+            slot.present = PresentInt | PresentDouble;
+        } else {
+            slot.asString = v;
+            slot.present = PresentString;
+        }
+    }, value);
+}
+
+void ConfigManager::changed(const std::string& key) {
+    auto it = m_slotIndex.find(key);
+    if (it == m_slotIndex.end()) {
+        return;
+    }
+
+    Slot& slot = *it->second;
+    auto value = m_values.find(key);
+    if (!refresh(slot, value != m_values.end() ? &value->second : nullptr)) {
+        return;
+    }
+    slot.version++;
+
+    // Index-based: a watcher may add another watcher
+    for (size_t i = 0; i < slot.watchers.size(); ++i) {
+        slot.watchers[i]();
+    }
+}
+
+void ConfigManager::refreshAll() {
+    for (Slot& slot : m_slots) {
+        changed(slot.key);
     }
 }
 
@@ -2,24 +2,67 @@
  * Shadow OT Client - Configuration Manager
  *
  * Handles loading and saving of configuration settings.
+ *
+ * Code that reads a setting often takes a ConfigHandle instead of going
+ * through the string-keyed getters: the key is interned once into a slot
+ * that caches the value in every type it converts to, so a read is a
+ * pointer dereference. Every write, load, remove or clear refreshes the
+ * interned slots in place and runs the watchers of those that changed.
  */
 
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <string>
+#include <type_traits>
 #include <map>
+#include <unordered_map>
 #include <variant>
 #include <optional>
+#include <vector>
 
 namespace shadow {
 namespace framework {
 
+template<typename T>
+class ConfigHandle;
+
 class ConfigManager {
 public:
     static ConfigManager& instance();
 
     using ConfigValue = std::variant<bool, int, double, std::string>;
 
+    // Cached conversions of one key, same rules as the getters: ints and
+    // doubles convert to each other, bools and strings only to themselves
+    struct Slot {
+        std::string key;
+        bool asBool{false};
+        int asInt{0};
+        double asDouble{0.0};
+        std::string asString;
+        uint8_t present{0};     // PresentBool | ... for the conversions above
+        uint32_t version{0};    // Bumped on every change
+        std::vector<std::function<void()>> watchers;
+    };
+    static constexpr uint8_t PresentBool = 1 << 0;
+    static constexpr uint8_t PresentInt = 1 << 1;
+    static constexpr uint8_t PresentDouble = 1 << 2;
+    static constexpr uint8_t PresentString = 1 << 3;
+
+    // T is bool, int, double or std::string. Handles stay valid for the
+    // manager's lifetime.
+    template<typename T>
+    ConfigHandle<T> handle(const std::string& key, T defaultValue = T{});
+
+    // Runs on the thread that changed the value, after the handle sees it;
+    // with callNow also once right away
+    template<typename T>
+    void watch(const ConfigHandle<T>& handle, std::type_identity_t<std::function<void(const T&)>> callback,
+               bool callNow = true);
+
     // Load/save configuration
     bool load(const std::string& filename);
     bool save(const std::string& filename);
@@ -57,10 +100,77 @@ private:
     ConfigManager(const ConfigManager&) = delete;
     ConfigManager& operator=(const ConfigManager&) = delete;
 
+    Slot& intern(const std::string& key);
+    // True if the cached value changed
+    static bool refresh(Slot& slot, const ConfigValue* value);
+    static void assign(Slot& slot, const ConfigValue& value);
+    // After m_values[key] changed or was erased; watchers only run if the
+    // value differs from what the slot held
+    void changed(const std::string& key);
+    void refreshAll();
+
     std::map<std::string, ConfigValue> m_values;
     std::string m_loadedFile;
+
+    // Deque, so slots never move once handed out
+    std::deque<Slot> m_slots;
+    std::unordered_map<std::string, Slot*> m_slotIndex;
 };
 
+template<typename T>
+class ConfigHandle {
+public:
+    ConfigHandle() = default;
+
+    const T& get() const {
+        if (!m_slot) return m_default;
+        if constexpr (std::is_same_v<T, bool>) {
+            return (m_slot->present & ConfigManager::PresentBool) ? m_slot->asBool : m_default;
+        } else if constexpr (std::is_same_v<T, int>) {
+            return (m_slot->present & ConfigManager::PresentInt) ? m_slot->asInt : m_default;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return (m_slot->present & ConfigManager::PresentDouble) ? m_slot->asDouble : m_default;
+        } else {
+            static_assert(std::is_same_v<T, std::string>, "config values are bool, int, double or string");
+            return (m_slot->present & ConfigManager::PresentString) ? m_slot->asString : m_default;
+        }
+    }
+    operator const T&() const { return get(); }
+
+    bool isValid() const { return m_slot != nullptr; }
+    const std::string& getKey() const;
+    // Compare against a saved version to see whether the value changed
+    uint32_t getVersion() const { return m_slot ? m_slot->version : 0; }
+
+private:
+    friend class ConfigManager;
+    ConfigHandle(const ConfigManager::Slot* slot, T defaultValue) : m_slot(slot), m_default(std::move(defaultValue)) {}
+
+    const ConfigManager::Slot* m_slot{nullptr};
+    T m_default{};
+};
+
+template<typename T>
+const std::string& ConfigHandle<T>::getKey() const {
+    static const std::string empty;
+    return m_slot ? m_slot->key : empty;
+}
+
+template<typename T>
+ConfigHandle<T> ConfigManager::handle(const std::string& key, T defaultValue) {
+    return ConfigHandle<T>(&intern(key), std::move(defaultValue));
+}
+
+template<typename T>
+void ConfigManager::watch(const ConfigHandle<T>& handle, std::type_identity_t<std::function<void(const T&)>> callback,
+                          bool callNow) {
+    if (!handle.m_slot || !callback) return;
+    if (callNow) callback(handle.get());
+
+    Slot& slot = const_cast<Slot&>(*handle.m_slot);
+    slot.watchers.push_back([handle, callback = std::move(callback)] { callback(handle.get()); });
+}
+
 } // namespace framework
 } // namespace shadow
 
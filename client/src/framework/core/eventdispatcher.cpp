@@ -4,6 +4,8 @@
 
 #include "eventdispatcher.h"
 #include <framework/core/application.h>
+#include <framework/core/jobsystem.h>
+#include <framework/core/profiler.h>
 #include <algorithm>
 
 namespace shadow {
@@ -14,42 +16,49 @@ EventDispatcher& EventDispatcher::instance() {
     return instance;
 }
 
+EventDispatcher::~EventDispatcher() {
+    while (PostedEvent* event = m_queue.pop()) {
+        delete event;
+    }
+}
+
 EventDispatcher::CallbackId EventDispatcher::subscribe(const std::string& eventType, EventCallback callback) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    Subscription sub;
-    sub.id = m_nextCallbackId++;
-    sub.eventType = eventType;
-    sub.callback = std::move(callback);
-
-    m_subscriptions.push_back(std::move(sub));
-
-    return sub.id;
+    CallbackId id = m_nextCallbackId++;
+    m_subscriptions[eventType].push_back({id, std::move(callback)});
+    return id;
 }
 
 void EventDispatcher::unsubscribe(CallbackId id) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& [type, subscriptions] : m_subscriptions) {
+            auto it = std::find_if(subscriptions.begin(), subscriptions.end(),
+                                   [id](const Subscription& sub) { return sub.id == id; });
+            if (it != subscriptions.end()) {
+                subscriptions.erase(it);
+                return;
+            }
+        }
+    }
 
-    m_subscriptions.erase(
-        std::remove_if(m_subscriptions.begin(), m_subscriptions.end(),
-            [id](const Subscription& sub) { return sub.id == id; }),
-        m_subscriptions.end()
-    );
+    std::lock_guard<std::mutex> lock(m_channelsMutex);
+    for (auto& channel : m_channels) {
+        if (channel->remove(id)) {
+            return;
+        }
+    }
 }
 
 void EventDispatcher::unsubscribeAll(const std::string& eventType) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_subscriptions.erase(
-        std::remove_if(m_subscriptions.begin(), m_subscriptions.end(),
-            [&eventType](const Subscription& sub) { return sub.eventType == eventType; }),
-        m_subscriptions.end()
-    );
+    m_subscriptions.erase(eventType);
 }
 
 void EventDispatcher::dispatch(const Event& event) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_eventQueue.push(event);
+    enqueue(event);
 }
 
 void EventDispatcher::dispatchImmediate(const Event& event) {
@@ -57,10 +66,12 @@ void EventDispatcher::dispatchImmediate(const Event& event) {
 
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        for (const auto& sub : m_subscriptions) {
-            if (sub.eventType == event.type) {
-                callbacks.push_back(sub.callback);
-            }
+        auto it = m_subscriptions.find(event.type);
+        if (it == m_subscriptions.end()) {
+            return;
+        }
+        for (const auto& sub : it->second) {
+            callbacks.push_back(sub.callback);
         }
     }
 
@@ -69,77 +80,88 @@ void EventDispatcher::dispatchImmediate(const Event& event) {
     }
 }
 
-void EventDispatcher::dispatchDelayed(const Event& event, double delayMs) {
+EventDispatcher::TimerHandle EventDispatcher::dispatchDelayed(const Event& event, double delayMs) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     ScheduledEvent scheduled;
     scheduled.event = event;
-    scheduled.triggerTime = g_app.getFrameTime() + (delayMs / 1000.0);
-    scheduled.interval = 0;
-    scheduled.repeat = false;
-
-    m_scheduledEvents.push_back(std::move(scheduled));
+    return m_timers.add(g_app.getFrameTime() + (delayMs / 1000.0), std::move(scheduled));
 }
 
-void EventDispatcher::scheduleEvent(const std::string& type, double intervalMs, bool repeat) {
+EventDispatcher::TimerHandle EventDispatcher::scheduleEvent(const std::string& type, double intervalMs, bool repeat) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     ScheduledEvent scheduled;
     scheduled.event = createEvent(type);
-    scheduled.triggerTime = g_app.getFrameTime() + (intervalMs / 1000.0);
     scheduled.interval = intervalMs / 1000.0;
     scheduled.repeat = repeat;
+    return m_timers.add(g_app.getFrameTime() + scheduled.interval, std::move(scheduled));
+}
 
-    m_scheduledEvents.push_back(std::move(scheduled));
+bool EventDispatcher::cancelTimer(TimerHandle handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timers.cancel(handle);
 }
 
 void EventDispatcher::cancelScheduled(const std::string& type) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_scheduledEvents.erase(
-        std::remove_if(m_scheduledEvents.begin(), m_scheduledEvents.end(),
-            [&type](const ScheduledEvent& se) { return se.event.type == type; }),
-        m_scheduledEvents.end()
-    );
+    m_timers.cancelIf([&type](const ScheduledEvent& se) { return se.event.type == type; });
+}
+
+size_t EventDispatcher::getTimerCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timers.size();
 }
 
 void EventDispatcher::poll() {
+    ProfileScope scope(Profiler::StageDispatcher);
     double currentTime = g_app.getFrameTime();
 
-    // Process scheduled events
+    // Main-thread continuations of finished background jobs
+    g_jobs.poll();
+
+    // Due timers, from the top of the heap only
     {
         std::lock_guard<std::mutex> lock(m_mutex);
 
-        for (auto it = m_scheduledEvents.begin(); it != m_scheduledEvents.end();) {
-            if (currentTime >= it->triggerTime) {
-                m_eventQueue.push(it->event);
-
-                if (it->repeat) {
-                    it->triggerTime = currentTime + it->interval;
-                    ++it;
-                } else {
-                    it = m_scheduledEvents.erase(it);
-                }
-            } else {
-                ++it;
-            }
-        }
+        m_timers.runExpired(currentTime, [this, currentTime](TimerHandle, const ScheduledEvent& scheduled) {
+            enqueue(scheduled.event);
+            return scheduled.repeat ? currentTime + scheduled.interval : -1.0;
+        });
     }
 
-    // Process queued events
-    while (true) {
-        Event event;
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (m_eventQueue.empty()) break;
-            event = m_eventQueue.front();
-            m_eventQueue.pop();
-        }
+    // Posted events, oldest first. Whatever is left over waits for the
+    // next frame rather than stretching this one.
+    size_t depth = m_queue.size();
+    m_peakDepth = std::max(m_peakDepth, depth);
+
+    size_t delivered = 0;
+    while (m_maxEventsPerPoll == 0 || delivered < m_maxEventsPerPoll) {
+        std::unique_ptr<PostedEvent> event(m_queue.pop());
+        if (!event) break;
+        event->deliver(*this);
+        delivered++;
+    }
 
-        dispatchImmediate(event);
+    m_lastBatch = delivered;
+    m_delivered += delivered;
+    if (m_maxEventsPerPoll > 0 && delivered == m_maxEventsPerPoll && m_queue.size() > 0) {
+        m_backloggedPolls++;
     }
 }
 
+EventDispatcher::QueueStats EventDispatcher::getQueueStats() const {
+    QueueStats stats;
+    stats.depth = m_queue.size();
+    stats.peakDepth = m_peakDepth;
+    stats.lastBatch = m_lastBatch;
+    stats.posted = m_posted.load(std::memory_order_relaxed);
+    stats.delivered = m_delivered;
+    stats.backloggedPolls = m_backloggedPolls;
+    return stats;
+}
+
 } // namespace framework
 } // namespace shadow
 
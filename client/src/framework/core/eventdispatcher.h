@@ -1,7 +1,18 @@
 /**
  * Shadow OT Client - Event Dispatcher
  *
- * Central event system for decoupled component communication.
+ * Central event system for decoupled component communication. Events are
+ * plain structs, each type its own channel with its own subscriber list:
+ *
+ *   struct HealthChanged { uint32_t creatureId; uint8_t percent; };
+ *   g_dispatcher.subscribe<HealthChanged>([](const HealthChanged& e) { ... });
+ *   g_dispatcher.post(HealthChanged{id, 50});
+ *
+ * The string-keyed Event API remains for scripts.
+ *
+ * Posted events of both kinds share one lock-free queue, so worker
+ * threads never wait on the main thread; poll() delivers them in posting
+ * order, at most getMaxEventsPerPoll() a frame, leaving the rest queued.
  */
 
 #pragma once
@@ -9,11 +20,16 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
-#include <queue>
 #include <mutex>
 #include <any>
+#include <atomic>
+#include <type_traits>
+#include <algorithm>
+#include <framework/core/mpscqueue.h>
+#include <framework/core/timerqueue.h>
 
 namespace shadow {
 namespace framework {
@@ -41,22 +57,68 @@ class EventDispatcher {
 public:
     static EventDispatcher& instance();
 
+    static constexpr size_t DEFAULT_MAX_EVENTS_PER_POLL = 1024;
+
     using EventCallback = std::function<void(const Event&)>;
     using CallbackId = uint64_t;
+    using TimerHandle = uint64_t;           // 0 is never a valid handle
+
+    // Typed channels. subscribe, unsubscribe and emit belong to the main
+    // thread; post may be called from any thread and is delivered by the
+    // next poll. Subscribing from inside a callback takes effect after
+    // the current delivery.
+    template<typename T>
+    CallbackId subscribe(std::function<void(const T&)> callback) {
+        CallbackId id = m_nextCallbackId++;
+        channel<T>().add(id, std::move(callback));
+        return id;
+    }
+
+    template<typename T>
+    void post(const T& event) {
+        static_assert(std::is_trivially_copyable_v<T>, "typed events are plain structs");
+        m_posted.fetch_add(1, std::memory_order_relaxed);
+        m_queue.push(new PostedTyped<T>(event));
+    }
+
+    template<typename T>
+    void emit(const T& event) {
+        channel<T>().deliver(event);
+    }
 
-    // Subscribe to events
+    template<typename T>
+    size_t getSubscriberCount() {
+        return channel<T>().subscriberCount();
+    }
+
+    // String-keyed events
     CallbackId subscribe(const std::string& eventType, EventCallback callback);
+    // Either kind of subscription
     void unsubscribe(CallbackId id);
     void unsubscribeAll(const std::string& eventType);
 
     // Dispatch events
     void dispatch(const Event& event);
     void dispatchImmediate(const Event& event);
-    void dispatchDelayed(const Event& event, double delayMs);
+    TimerHandle dispatchDelayed(const Event& event, double delayMs);
 
     // Process queued events
     void poll();
 
+    // 0 delivers everything queued, including events posted meanwhile
+    void setMaxEventsPerPoll(size_t count) { m_maxEventsPerPoll = count; }
+    size_t getMaxEventsPerPoll() const { return m_maxEventsPerPoll; }
+
+    struct QueueStats {
+        size_t depth{0};            // Queued now
+        size_t peakDepth{0};        // Deepest seen at the start of a poll
+        size_t lastBatch{0};        // Delivered by the last poll
+        uint64_t posted{0};
+        uint64_t delivered{0};
+        uint64_t backloggedPolls{0};    // Polls that hit the batch limit
+    };
+    QueueStats getQueueStats() const;
+
     // Event creation helpers
     static Event createEvent(const std::string& type) {
         Event e;
@@ -64,34 +126,157 @@ public:
         return e;
     }
 
-    // Scheduled events
-    void scheduleEvent(const std::string& type, double intervalMs, bool repeat = false);
+    // Scheduled events. Handles cancel in O(log n); cancelScheduled looks
+    // at every timer.
+    TimerHandle scheduleEvent(const std::string& type, double intervalMs, bool repeat = false);
+    bool cancelTimer(TimerHandle handle);
     void cancelScheduled(const std::string& type);
+    size_t getTimerCount() const;
 
 private:
     EventDispatcher() = default;
-    ~EventDispatcher() = default;
+    ~EventDispatcher();
     EventDispatcher(const EventDispatcher&) = delete;
     EventDispatcher& operator=(const EventDispatcher&) = delete;
 
     struct ScheduledEvent {
         Event event;
-        double triggerTime;
-        double interval;
-        bool repeat;
+        double interval{0.0};
+        bool repeat{false};
     };
 
     struct Subscription {
         CallbackId id;
-        std::string eventType;
         EventCallback callback;
     };
 
-    std::mutex m_mutex;
-    std::vector<Subscription> m_subscriptions;
-    std::queue<Event> m_eventQueue;
-    std::vector<ScheduledEvent> m_scheduledEvents;
-    CallbackId m_nextCallbackId{1};
+    class ChannelBase {
+    public:
+        virtual ~ChannelBase() = default;
+        virtual bool remove(CallbackId id) = 0;
+    };
+
+    template<typename T>
+    class Channel : public ChannelBase {
+    public:
+        void add(CallbackId id, std::function<void(const T&)> callback) {
+            // Appending while delivering could move the callback being run
+            (m_delivering > 0 ? m_added : m_subscribers).push_back({id, std::move(callback), true});
+        }
+
+        bool remove(CallbackId id) override {
+            for (auto* list : {&m_subscribers, &m_added}) {
+                for (auto& subscriber : *list) {
+                    if (subscriber.id == id && subscriber.active) {
+                        // Not reset: it may be the callback running now
+                        subscriber.active = false;
+                        m_removed = true;
+                        compact();
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void deliver(const T& event) {
+            m_delivering++;
+            for (size_t i = 0; i < m_subscribers.size(); ++i) {
+                if (m_subscribers[i].active) {
+                    m_subscribers[i].callback(event);
+                }
+            }
+            m_delivering--;
+            compact();
+        }
+
+        size_t subscriberCount() const { return m_subscribers.size() + m_added.size(); }
+
+    private:
+        struct Subscriber {
+            CallbackId id;
+            std::function<void(const T&)> callback;
+            bool active{true};
+        };
+
+        void compact() {
+            if (m_delivering > 0) return;
+            if (m_removed) {
+                for (auto* list : {&m_subscribers, &m_added}) {
+                    list->erase(std::remove_if(list->begin(), list->end(),
+                                               [](const Subscriber& s) { return !s.active; }),
+                                list->end());
+                }
+                m_removed = false;
+            }
+            if (!m_added.empty()) {
+                for (auto& subscriber : m_added) {
+                    m_subscribers.push_back(std::move(subscriber));
+                }
+                m_added.clear();
+            }
+        }
+
+        std::vector<Subscriber> m_subscribers;
+        std::vector<Subscriber> m_added;
+        int m_delivering{0};
+        bool m_removed{false};
+    };
+
+    // Queued posts; each delivers itself on the main thread
+    struct PostedEvent : MPSCNode {
+        virtual ~PostedEvent() = default;
+        virtual void deliver(EventDispatcher& dispatcher) = 0;
+    };
+
+    struct PostedString : PostedEvent {
+        explicit PostedString(const Event& e) : event(e) {}
+        void deliver(EventDispatcher& dispatcher) override { dispatcher.dispatchImmediate(event); }
+        Event event;
+    };
+
+    template<typename T>
+    struct PostedTyped : PostedEvent {
+        explicit PostedTyped(const T& e) : event(e) {}
+        void deliver(EventDispatcher& dispatcher) override { dispatcher.channel<T>().deliver(event); }
+        T event;
+    };
+
+    void enqueue(const Event& event) {
+        m_posted.fetch_add(1, std::memory_order_relaxed);
+        m_queue.push(new PostedString(event));
+    }
+
+    // One channel per event type, created on first use
+    template<typename T>
+    Channel<T>& channel() {
+        static Channel<T>& instance = registerChannel(std::make_unique<Channel<T>>());
+        return instance;
+    }
+
+    template<typename C>
+    C& registerChannel(std::unique_ptr<C> channel) {
+        C& ref = *channel;
+        std::lock_guard<std::mutex> lock(m_channelsMutex);
+        m_channels.push_back(std::move(channel));
+        return ref;
+    }
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::vector<Subscription>> m_subscriptions;
+    TimerQueue<ScheduledEvent> m_timers;
+    std::atomic<CallbackId> m_nextCallbackId{1};
+
+    MPSCQueue<PostedEvent> m_queue;
+    std::atomic<uint64_t> m_posted{0};
+    size_t m_maxEventsPerPoll{DEFAULT_MAX_EVENTS_PER_POLL};
+    size_t m_peakDepth{0};
+    size_t m_lastBatch{0};
+    uint64_t m_delivered{0};
+    uint64_t m_backloggedPolls{0};
+
+    std::mutex m_channelsMutex;
+    std::vector<std::unique_ptr<ChannelBase>> m_channels;
 };
 
 } // namespace framework
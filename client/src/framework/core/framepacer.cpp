@@ -0,0 +1,77 @@
+/**
+ * Shadow OT Client - Frame Pacer Implementation
+ */
+
+#include "framepacer.h"
+#include <algorithm>
+#include <thread>
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+double toMs(FramePacer::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // anonymous namespace
+
+void FramePacer::setTargetFPS(int fps) {
+    if (fps == m_targetFPS) return;
+
+    m_targetFPS = std::max(fps, 0);
+    m_period = m_targetFPS > 0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_targetFPS))
+        : Clock::duration{};
+
+    // Restart from now so a rate change takes effect on the next frame
+    m_deadline = Clock::now() + m_period;
+}
+
+void FramePacer::wait() {
+    Clock::time_point start = Clock::now();
+    if (m_targetFPS <= 0) {
+        m_stats.lastWaitMs = 0.0;
+        return;
+    }
+
+    // Far behind (a stall, a breakpoint): start over rather than rushing
+    // through frames to catch up
+    if (start - m_deadline > m_period) {
+        m_deadline = start;
+        m_stats.missedDeadlines++;
+    }
+
+    double marginMs = std::clamp(m_overshootMs * 1.5, MIN_SPIN_MARGIN_MS, MAX_SPIN_MARGIN_MS);
+    double remainingMs = toMs(m_deadline - start);
+
+    if (remainingMs > marginMs) {
+        auto requested = std::chrono::duration<double, std::milli>(remainingMs - marginMs);
+        Clock::time_point sleepStart = Clock::now();
+        std::this_thread::sleep_for(requested);
+
+        // Smooth, but let a bad overshoot raise the margin at once
+        double overshoot = std::max(toMs(Clock::now() - sleepStart) - requested.count(), 0.0);
+        m_overshootMs = std::max(overshoot, m_overshootMs * 0.95 + overshoot * 0.05);
+    }
+
+    while (Clock::now() < m_deadline) {
+        std::this_thread::yield();
+    }
+
+    m_deadline += m_period;
+    m_stats.lastWaitMs = toMs(Clock::now() - start);
+    m_stats.sleepOvershootMs = m_overshootMs;
+    m_stats.spinMarginMs = marginMs;
+}
+
+double FramePacer::getIdleBudgetMs() const {
+    if (m_targetFPS <= 0) return 0.0;
+
+    double marginMs = std::clamp(m_overshootMs * 1.5, MIN_SPIN_MARGIN_MS, MAX_SPIN_MARGIN_MS);
+    return std::max(toMs(m_deadline - Clock::now()) - marginMs, 0.0);
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,55 @@
+/**
+ * Shadow OT Client - Frame Pacer
+ *
+ * Holds frames to fixed deadlines. OS sleeps overshoot by up to the timer
+ * granularity, so the pacer sleeps until shortly before the deadline and
+ * spins for the rest; the margin follows the overshoot it measures.
+ * Deadlines advance by whole frame periods, so a late frame does not push
+ * every later one back.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace shadow {
+namespace framework {
+
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double MIN_SPIN_MARGIN_MS = 0.25;
+    static constexpr double MAX_SPIN_MARGIN_MS = 4.0;
+
+    struct Stats {
+        double lastWaitMs{0.0};
+        double sleepOvershootMs{0.0};   // Smoothed OS sleep overshoot
+        double spinMarginMs{0.0};
+        uint64_t missedDeadlines{0};    // Frames that started a full period late
+    };
+
+    // 0 disables pacing
+    void setTargetFPS(int fps);
+    int getTargetFPS() const { return m_targetFPS; }
+
+    // Block until the next frame deadline
+    void wait();
+
+    // Time until wait() would start sleeping, for work that can fill the
+    // end of a frame; 0 without pacing or when behind
+    double getIdleBudgetMs() const;
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    int m_targetFPS{0};
+    Clock::duration m_period{};
+    Clock::time_point m_deadline{};
+    double m_overshootMs{1.0};
+    Stats m_stats;
+};
+
+} // namespace framework
+} // namespace shadow
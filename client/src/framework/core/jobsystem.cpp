@@ -0,0 +1,481 @@
+/**
+ * Shadow OT Client - Job System Implementation
+ */
+
+#include "jobsystem.h"
+#include "profiler.h"
+#include <algorithm>
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+thread_local int t_workerIndex = -1;
+thread_local bool t_ioWorker = false;
+
+} // anonymous namespace
+
+class JobSystem::Job {
+public:
+    Work work;
+    JobPriority priority{JobPriority::Normal};
+    bool blocking{false};
+    std::atomic<int> pending{0};        // Unfinished dependencies, plus one while being submitted
+    std::atomic<bool> finished{false};
+    std::string error;                  // Set before finished
+    std::atomic<int> waiters{0};        // Threads blocked in wait()
+
+    std::mutex mutex;
+    std::vector<Handle> continuations;
+    std::vector<std::function<void()>> callbacks;
+};
+
+JobSystem& JobSystem::instance() {
+    static JobSystem instance;
+    return instance;
+}
+
+JobSystem::~JobSystem() {
+    terminate();
+}
+
+void JobSystem::init(int workers, int ioWorkers) {
+    if (isRunning()) return;
+
+    if (workers <= 0) {
+        workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    for (int i = 0; i < workers; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_utilization.assign(workers, 0.0f);
+    m_lastSample = std::chrono::steady_clock::now();
+
+    m_stopping = false;
+    m_running.store(true, std::memory_order_release);
+    for (int i = 0; i < workers; ++i) {
+        m_workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+    for (int i = 0; i < std::max(ioWorkers, 1); ++i) {
+        m_ioWorkers.emplace_back(&JobSystem::ioLoop, this);
+    }
+}
+
+void JobSystem::terminate() {
+    // Jobs scheduled from here on run inline
+    if (!m_running.exchange(false)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_ioWake.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+    for (auto& thread : m_ioWorkers) {
+        if (thread.joinable()) thread.join();
+    }
+
+    // Anything pushed while the workers were leaving
+    while (Handle job = findJob(-1)) {
+        execute(job, nullptr);
+    }
+    while (Handle job = findBlockingJob()) {
+        execute(job, nullptr);
+    }
+
+    m_workers.clear();
+    m_ioWorkers.clear();
+    m_utilization.clear();
+    m_stopping = false;
+
+    std::lock_guard<std::mutex> lock(m_completedMutex);
+    m_completed.clear();
+}
+
+JobSystem::Handle JobSystem::create(Work work, JobPriority priority, bool blocking) {
+    auto job = std::make_shared<Job>();
+    job->work = std::move(work);
+    job->priority = priority;
+    job->blocking = blocking;
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+JobSystem::Handle JobSystem::submit(Work work, JobPriority priority) {
+    Handle job = create(std::move(work), priority);
+    schedule(job);
+    return job;
+}
+
+JobSystem::Handle JobSystem::submitBlocking(Work work, JobPriority priority) {
+    Handle job = create(std::move(work), priority, true);
+    schedule(job);
+    return job;
+}
+
+JobSystem::Handle JobSystem::submitAfter(const std::vector<Handle>& dependencies, Work work, JobPriority priority) {
+    Handle job = create(std::move(work), priority);
+
+    // The extra count keeps dependencies finishing meanwhile from queuing
+    // the job before every one of them has been looked at
+    job->pending.store(static_cast<int>(dependencies.size()) + 1);
+    for (const Handle& dependency : dependencies) {
+        if (dependency) {
+            std::lock_guard<std::mutex> lock(dependency->mutex);
+            if (!dependency->finished.load()) {
+                dependency->continuations.push_back(job);
+                continue;
+            }
+        }
+        job->pending.fetch_sub(1);
+    }
+
+    if (job->pending.fetch_sub(1) == 1) {
+        schedule(job);
+    }
+    return job;
+}
+
+void JobSystem::whenDone(const Handle& job, std::function<void()> callback) {
+    if (job) {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (!job->finished.load()) {
+            job->callbacks.push_back(std::move(callback));
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_completedMutex);
+    m_completed.push_back(std::move(callback));
+}
+
+bool JobSystem::isDone(const Handle& job) {
+    return !job || job->finished.load(std::memory_order_acquire);
+}
+
+std::string JobSystem::getError(const Handle& job) {
+    return isDone(job) && job ? job->error : std::string();
+}
+
+void JobSystem::schedule(const Handle& job) {
+    if (!isRunning()) {
+        m_inline.fetch_add(1, std::memory_order_relaxed);
+        execute(job, nullptr);
+        return;
+    }
+
+    size_t priority = static_cast<size_t>(job->priority);
+    if (job->blocking) {
+        {
+            std::lock_guard<std::mutex> lock(m_blockingMutex);
+            m_blocking[priority].push_back(job);
+        }
+        m_blockingQueued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_ioWake.notify_one();
+        return;
+    }
+
+    int self = t_workerIndex;
+    if (self >= 0 && self < static_cast<int>(m_workers.size())) {
+        // Its own newest job is the one a worker runs next, while its cache
+        // is still warm with whatever produced it
+        Worker& worker = *m_workers[self];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[priority].push_back(job);
+    } else {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        m_shared[priority].push_back(job);
+    }
+    m_queued.fetch_add(1);
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+JobSystem::Handle JobSystem::findJob(int self) {
+    size_t count = m_workers.size();
+
+    for (size_t priority = 0; priority < static_cast<size_t>(JobPriority::Count); ++priority) {
+        Handle job;
+
+        if (self >= 0) {
+            Worker& worker = *m_workers[self];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            auto& queue = worker.queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.back());
+                queue.pop_back();
+            }
+        }
+
+        if (!job) {
+            std::lock_guard<std::mutex> lock(m_sharedMutex);
+            auto& queue = m_shared[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+        }
+
+        // Steal the oldest, which tends to be the largest piece of work left
+        for (size_t i = 1; !job && i <= count; ++i) {
+            size_t victim = (static_cast<size_t>(self + count) + i) % count;
+            if (static_cast<int>(victim) == self) continue;
+
+            Worker& other = *m_workers[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            auto& queue = other.queues[priority];
+            if (!queue.empty()) {
+                job = std::move(queue.front());
+                queue.pop_front();
+                if (self >= 0) m_workers[self]->stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (job) {
+            m_queued.fetch_sub(1);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+JobSystem::Handle JobSystem::findBlockingJob() {
+    std::lock_guard<std::mutex> lock(m_blockingMutex);
+    for (auto& queue : m_blocking) {
+        if (!queue.empty()) {
+            Handle job = std::move(queue.front());
+            queue.pop_front();
+            m_blockingQueued.fetch_sub(1);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(const Handle& job, Worker* worker) {
+    // Dropping the work right away releases what it captured, which may
+    // include a handle to this very job
+    Work work = std::move(job->work);
+    job->work = nullptr;
+
+    auto begin = std::chrono::steady_clock::now();
+    try {
+        if (work) work();
+    } catch (const std::exception& e) {
+        job->error = e.what();
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    work = nullptr;
+
+    if (worker) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+        worker->busyNs.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+        worker->executed.fetch_add(1, std::memory_order_relaxed);
+    } else if (t_ioWorker) {
+        m_executedBlocking.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_executedOffPool.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    complete(*job);
+}
+
+void JobSystem::complete(Job& job) {
+    std::vector<Handle> continuations;
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        job.finished.store(true);
+        continuations.swap(job.continuations);
+        callbacks.swap(job.callbacks);
+    }
+
+    for (const Handle& continuation : continuations) {
+        if (continuation->pending.fetch_sub(1) == 1) {
+            schedule(continuation);
+        }
+    }
+
+    if (!callbacks.empty()) {
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        for (auto& callback : callbacks) {
+            m_completed.push_back(std::move(callback));
+        }
+    }
+
+    if (job.waiters.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_all();
+        m_ioWake.notify_all();
+    }
+}
+
+void JobSystem::wait(const Handle& job) {
+    if (!job) return;
+
+    int self = t_workerIndex < static_cast<int>(m_workers.size()) ? t_workerIndex : -1;
+    Worker* worker = self >= 0 ? m_workers[self].get() : nullptr;
+
+    while (!job->finished.load(std::memory_order_acquire)) {
+        if (t_ioWorker) {
+            // Blocking jobs waiting on others, e.g. a probe on its lookups,
+            // run them here rather than hold every I/O thread
+            if (Handle other = findBlockingJob()) {
+                execute(other, nullptr);
+                continue;
+            }
+            job->waiters.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                m_ioWake.wait(lock, [&] {
+                    return job->finished.load() || m_blockingQueued.load() > 0;
+                });
+            }
+            job->waiters.fetch_sub(1);
+            continue;
+        }
+
+        if (Handle other = findJob(self)) {
+            execute(other, worker);
+            continue;
+        }
+
+        // Nothing to help with: sleep until this job or new work shows up
+        job->waiters.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [&] {
+                return job->finished.load() || m_queued.load() > 0;
+            });
+        }
+        job->waiters.fetch_sub(1);
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn,
+                            JobPriority priority) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || !isRunning()) {
+        fn(0, count);
+        return;
+    }
+
+    std::vector<Handle> jobs;
+    jobs.reserve(chunks - 1);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        size_t begin = chunk * grain;
+        size_t end = std::min(count, begin + grain);
+        jobs.push_back(submit([&fn, begin, end] { fn(begin, end); }, priority));
+    }
+
+    fn(0, std::min(count, grain));
+    for (const Handle& job : jobs) {
+        wait(job);
+    }
+}
+
+void JobSystem::poll() {
+    std::vector<std::function<void()>> completed;
+    {
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        completed.swap(m_completed);
+    }
+    for (auto& callback : completed) {
+        callback();
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (m_workers.empty() || now - m_lastSample < UTILIZATION_INTERVAL) return;
+
+    double elapsedNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastSample).count());
+    m_lastSample = now;
+
+    float total = 0.0f;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        Worker& worker = *m_workers[i];
+        uint64_t busy = worker.busyNs.load(std::memory_order_relaxed);
+        m_utilization[i] = static_cast<float>(std::clamp((busy - worker.sampledBusyNs) / elapsedNs, 0.0, 1.0));
+        worker.sampledBusyNs = busy;
+        total += m_utilization[i];
+    }
+
+    g_profiler.setWorkerLoads(m_utilization.data(), m_utilization.size());
+    g_profiler.setGauge(Profiler::GaugeJobUtilization, total * 100.0f / m_workers.size());
+    g_profiler.setGauge(Profiler::GaugeJobsQueued, static_cast<float>(getQueuedCount()));
+}
+
+int JobSystem::getCurrentWorker() {
+    return t_workerIndex;
+}
+
+JobSystem::Stats JobSystem::getStats() const {
+    Stats stats;
+    stats.submitted = m_submitted.load(std::memory_order_relaxed);
+    stats.executed = m_executedOffPool.load(std::memory_order_relaxed);
+    stats.ranInline = m_inline.load(std::memory_order_relaxed);
+    stats.blocking = m_executedBlocking.load(std::memory_order_relaxed);
+    stats.failed = m_failed.load(std::memory_order_relaxed);
+    stats.executed += stats.blocking;
+    for (const auto& worker : m_workers) {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void JobSystem::workerLoop(int index) {
+    t_workerIndex = index;
+    Worker& self = *m_workers[index];
+
+    for (;;) {
+        if (Handle job = findJob(index)) {
+            execute(job, &self);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return m_stopping || m_queued.load() > 0; });
+        if (m_stopping && m_queued.load() <= 0) break;
+    }
+
+    t_workerIndex = -1;
+}
+
+void JobSystem::ioLoop() {
+    t_ioWorker = true;
+
+    for (;;) {
+        if (Handle job = findBlockingJob()) {
+            execute(job, nullptr);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_ioWake.wait(lock, [this] { return m_stopping || m_blockingQueued.load() > 0; });
+        if (m_stopping && m_blockingQueued.load() <= 0) break;
+    }
+
+    t_ioWorker = false;
+}
+
+} // namespace framework
+} // namespace shadow
+
+// Global instance
+shadow::framework::JobSystem& g_jobs = shadow::framework::JobSystem::instance();
@@ -0,0 +1,179 @@
+/**
+ * Shadow OT Client - Job System
+ *
+ * One work-stealing thread pool for every subsystem's background work.
+ * Jobs queue by priority; each worker takes its own newest job first and,
+ * when it runs dry, steals the oldest from the others. Jobs submitted
+ * from the main thread go to a shared queue that every worker drains.
+ *
+ * Blocking jobs, for work that mostly waits on files, DNS or sockets, run
+ * on a separate set of I/O threads instead, so a slow read or download
+ * never holds a worker that CPU jobs need. They take part in handles,
+ * dependencies and callbacks like any other job.
+ *
+ * A job can wait on others: it is queued once all the jobs it depends on
+ * have finished, which is also how continuations run after their job.
+ * Callbacks registered with whenDone() run on the main thread, from
+ * poll(), which EventDispatcher::poll calls every frame.
+ *
+ * Without init() nothing runs in the background: submitted jobs run
+ * inline once their dependencies are done, so headless tools and tests
+ * behave the same, only serially.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+enum class JobPriority : uint8_t {
+    High,       // The player is waiting on it, e.g. a path for a click
+    Normal,
+    Low,        // Prefetch and other speculative work
+    Count
+};
+
+class JobSystem {
+public:
+    static JobSystem& instance();
+
+    static constexpr auto UTILIZATION_INTERVAL = std::chrono::milliseconds(500);
+    static constexpr int DEFAULT_IO_WORKERS = 4;
+
+    using Work = std::function<void()>;
+    class Job;
+    using Handle = std::shared_ptr<Job>;    // Null handles count as finished
+
+    // workers == 0 leaves one hardware thread to the main loop; blocking
+    // jobs get ioWorkers threads of their own
+    void init(int workers = 0, int ioWorkers = DEFAULT_IO_WORKERS);
+    // Runs whatever is still queued, then joins the workers. Main-thread
+    // callbacks not delivered yet are dropped.
+    void terminate();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    size_t getWorkerCount() const { return m_workers.size(); }
+    size_t getIoWorkerCount() const { return m_ioWorkers.size(); }
+
+    Handle submit(Work work, JobPriority priority = JobPriority::Normal);
+    // On the I/O threads
+    Handle submitBlocking(Work work, JobPriority priority = JobPriority::Normal);
+    // Queued once every dependency has finished
+    Handle submitAfter(const std::vector<Handle>& dependencies, Work work,
+                       JobPriority priority = JobPriority::Normal);
+    Handle then(const Handle& job, Work work, JobPriority priority = JobPriority::Normal) {
+        return submitAfter({job}, std::move(work), priority);
+    }
+
+    // callback runs from poll() on the main thread once the job has finished,
+    // at the next poll if it already has
+    void whenDone(const Handle& job, std::function<void()> callback);
+
+    static bool isDone(const Handle& job);
+    // What the job's work threw, once it has finished; empty if it returned
+    static std::string getError(const Handle& job);
+
+    // Runs other queued jobs while waiting, so a job may wait on another
+    // without tying up its worker; I/O threads help with blocking jobs
+    void wait(const Handle& job);
+
+    // fn(begin, end) over [0, count) in chunks of about grain; the caller
+    // takes a share and returns when every chunk is done
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn,
+                     JobPriority priority = JobPriority::High);
+
+    // Main thread, per frame: completion callbacks and utilization sampling
+    void poll();
+
+    // Index of the worker running the calling thread, -1 off the pool
+    static int getCurrentWorker();
+
+    struct Stats {
+        uint64_t submitted{0};
+        uint64_t executed{0};
+        uint64_t stolen{0};         // Taken from another worker's queue
+        uint64_t ranInline{0};      // Run by the submitting thread, pool not running
+        uint64_t blocking{0};       // Run on the I/O threads
+        uint64_t failed{0};         // Threw; see getError()
+    };
+    Stats getStats() const;
+    size_t getQueuedCount() const { return static_cast<size_t>(m_queued.load(std::memory_order_relaxed)); }
+
+    // Busy share of each worker over the last UTILIZATION_INTERVAL, 0..1
+    const std::vector<float>& getUtilization() const { return m_utilization; }
+
+private:
+    JobSystem() = default;
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    using Queues = std::array<std::deque<Handle>, static_cast<size_t>(JobPriority::Count)>;
+
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        Queues queues;              // Owner pops the back, thieves the front
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+        uint64_t sampledBusyNs{0};  // Main thread, for utilization
+    };
+
+    Handle create(Work work, JobPriority priority, bool blocking = false);
+    void schedule(const Handle& job);
+    Handle findJob(int self);
+    Handle findBlockingJob();
+    void execute(const Handle& job, Worker* worker);
+    void complete(Job& job);
+    void workerLoop(int index);
+    void ioLoop();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopping{false};
+
+    std::mutex m_sharedMutex;
+    Queues m_shared;                // Submitted from off the pool
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int64_t> m_queued{0};
+
+    std::vector<std::thread> m_ioWorkers;
+    std::mutex m_blockingMutex;
+    Queues m_blocking;
+    std::condition_variable m_ioWake;   // With m_sleepMutex
+    std::atomic<int64_t> m_blockingQueued{0};
+    std::atomic<uint64_t> m_executedBlocking{0};
+
+    std::mutex m_completedMutex;
+    std::vector<std::function<void()>> m_completed;
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_inline{0};
+    std::atomic<uint64_t> m_failed{0};
+    std::atomic<uint64_t> m_executedOffPool{0};    // Inline, or by a thread waiting in wait()
+
+    std::vector<float> m_utilization;
+    std::chrono::steady_clock::time_point m_lastSample;
+};
+
+} // namespace framework
+} // namespace shadow
+
+// Global accessor
+extern shadow::framework::JobSystem& g_jobs;
@@ -0,0 +1,295 @@
+/**
+ * Shadow OT Client - Mapped File Implementation
+ */
+
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace shadow {
+namespace framework {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, Mode mode, size_t minSize) {
+    close();
+
+    bool writable = mode == Mode::ReadWrite;
+    HANDLE file = CreateFileA(path.c_str(),
+                              writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                              FILE_SHARE_READ, nullptr,
+                              writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_path = path;
+    m_mode = mode;
+
+    size_t size = static_cast<size_t>(fileSize.QuadPart);
+    if (writable && size < minSize) size = minSize;
+    if (size == 0 || !map(size)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::openRange(const std::string& path, size_t offset, size_t length) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || length == 0 ||
+        offset + length > static_cast<size_t>(fileSize.QuadPart)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_path = path;
+    m_mode = Mode::ReadOnly;
+    if (!map(length, offset)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::map(size_t size, size_t offset) {
+    bool writable = m_mode == Mode::ReadWrite;
+    LARGE_INTEGER mapSize;
+    mapSize.QuadPart = writable ? static_cast<LONGLONG>(size) : 0;
+
+    // A read-write mapping larger than the file extends it; a read-only
+    // one covers the whole file
+    HANDLE mapping = CreateFileMappingA(m_file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        mapSize.HighPart, mapSize.LowPart, nullptr);
+    if (!mapping) return false;
+
+    // Views start on an allocation-granularity boundary
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    size_t delta = offset % system.dwAllocationGranularity;
+    LARGE_INTEGER viewStart;
+    viewStart.QuadPart = static_cast<LONGLONG>(offset - delta);
+
+    void* view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                               viewStart.HighPart, viewStart.LowPart, size + delta);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t*>(view) + delta;
+    m_size = size;
+    m_viewOffset = delta;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (m_data) {
+        UnmapViewOfFile(m_data - m_viewOffset);
+        m_data = nullptr;
+        m_viewOffset = 0;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_size = 0;
+}
+
+void MappedFile::close() {
+    if (m_data && m_mode == Mode::ReadWrite) {
+        flush(false);
+    }
+    unmap();
+    if (m_file) {
+        CloseHandle(m_file);
+        m_file = nullptr;
+    }
+    m_path.clear();
+}
+
+bool MappedFile::resize(size_t size) {
+    if (!m_file || m_mode != Mode::ReadWrite || size == 0) return false;
+    if (size == m_size) return true;
+
+    unmap();
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(m_file)) {
+        return false;
+    }
+    return map(size);
+}
+
+bool MappedFile::flush(bool async) {
+    if (!m_data || m_mode != Mode::ReadWrite) return false;
+    if (!FlushViewOfFile(m_data, 0)) return false;
+    return async || FlushFileBuffers(m_file);
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+    if (!m_data || offset >= m_size) return;
+    if (length > m_size - offset) length = m_size - offset;
+
+    WIN32_MEMORY_RANGE_ENTRY range{m_data + offset, length};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, Mode mode, size_t minSize) {
+    close();
+
+    bool writable = mode == Mode::ReadWrite;
+    int fd = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_path = path;
+    m_mode = mode;
+
+    size_t size = static_cast<size_t>(info.st_size);
+    if (writable && size < minSize) {
+        if (ftruncate(fd, static_cast<off_t>(minSize)) != 0) {
+            close();
+            return false;
+        }
+        size = minSize;
+    }
+
+    if (size == 0 || !map(size)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::openRange(const std::string& path, size_t offset, size_t length) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || length == 0 || offset + length > static_cast<size_t>(info.st_size)) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_path = path;
+    m_mode = Mode::ReadOnly;
+    if (!map(length, offset)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::map(size_t size, size_t offset) {
+    // mmap wants a page-aligned file offset
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t delta = offset & (page - 1);
+
+    int protection = m_mode == Mode::ReadWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* data = mmap(nullptr, size + delta, protection, MAP_SHARED, m_fd, static_cast<off_t>(offset - delta));
+    if (data == MAP_FAILED) return false;
+
+    m_data = static_cast<uint8_t*>(data) + delta;
+    m_size = size;
+    m_viewOffset = delta;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (m_data) {
+        munmap(m_data - m_viewOffset, m_size + m_viewOffset);
+        m_data = nullptr;
+        m_viewOffset = 0;
+    }
+    m_size = 0;
+}
+
+void MappedFile::close() {
+    if (m_data && m_mode == Mode::ReadWrite) {
+        flush(false);
+    }
+    unmap();
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_path.clear();
+}
+
+bool MappedFile::resize(size_t size) {
+    if (m_fd < 0 || m_mode != Mode::ReadWrite || size == 0) return false;
+    if (size == m_size) return true;
+
+    unmap();
+    if (ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+        return false;
+    }
+    return map(size);
+}
+
+bool MappedFile::flush(bool async) {
+    if (!m_data || m_mode != Mode::ReadWrite) return false;
+    return msync(m_data, m_size, async ? MS_ASYNC : MS_SYNC) == 0;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+    if (!m_data || offset >= m_size) return;
+    if (length > m_size - offset) length = m_size - offset;
+
+    // madvise wants a page-aligned start; ranged maps may not begin on one
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(m_data + offset);
+    uintptr_t aligned = start & ~static_cast<uintptr_t>(page - 1);
+    madvise(reinterpret_cast<void*>(aligned), length + (start - aligned), MADV_WILLNEED);
+}
+
+#endif
+
+} // namespace framework
+} // namespace shadow
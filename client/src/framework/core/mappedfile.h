@@ -0,0 +1,73 @@
+/**
+ * Shadow OT Client - Mapped File
+ *
+ * Thin cross-platform wrapper around a memory-mapped file. Read-only maps
+ * share pages with the OS file cache; read-write maps can grow in place
+ * and be flushed asynchronously.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace shadow {
+namespace framework {
+
+class MappedFile {
+public:
+    enum class Mode {
+        ReadOnly,
+        ReadWrite    // Creates the file if missing
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // ReadWrite maps are extended to at least minSize bytes
+    bool open(const std::string& path, Mode mode, size_t minSize = 0);
+    // Read-only map of [offset, offset + length) of a file. The offset need
+    // not be page aligned; data() points at it either way.
+    bool openRange(const std::string& path, size_t offset, size_t length);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    Mode getMode() const { return m_mode; }
+    const std::string& getPath() const { return m_path; }
+
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    // Grow or shrink a ReadWrite map; data() may move
+    bool resize(size_t size);
+
+    // Write dirty pages back; async only schedules the write
+    bool flush(bool async = true);
+
+    // Hint that a range is about to be read
+    void prefetch(size_t offset, size_t length) const;
+
+private:
+    bool map(size_t size, size_t offset = 0);
+    void unmap();
+
+    std::string m_path;
+    Mode m_mode{Mode::ReadOnly};
+    uint8_t* m_data{nullptr};
+    size_t m_size{0};
+    size_t m_viewOffset{0};     // data() - start of the mapped view
+
+#ifdef _WIN32
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#else
+    int m_fd{-1};
+#endif
+};
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,98 @@
+/**
+ * Shadow OT Client - Memory Tracker Implementation
+ */
+
+#include "memorytracker.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+constexpr const char* TAG_NAMES[MemoryTracker::TAG_COUNT] = {
+    "tiles", "minimap", "sprites", "sound", "lua", "ui", "network"
+};
+
+} // anonymous namespace
+
+// Never destroyed: pooled buffers and other counted allocations may be
+// released from static destructors in any translation unit. Dump rows are
+// flushed as they are written, so nothing is lost at exit.
+MemoryTracker& MemoryTracker::instance() {
+    static MemoryTracker* tracker = new MemoryTracker;
+    return *tracker;
+}
+
+MemoryTracker::MemoryTracker() : m_epoch(std::chrono::steady_clock::now()), m_lastDump(m_epoch) {}
+
+const char* MemoryTracker::getTagName(MemoryTag tag) {
+    size_t index = static_cast<size_t>(tag);
+    return index < TAG_COUNT ? TAG_NAMES[index] : "unknown";
+}
+
+MemoryTracker::Usage MemoryTracker::getUsage(MemoryTag tag) const {
+    const Counter& counter = m_counters[static_cast<size_t>(tag)];
+    Usage usage;
+    usage.bytes = counter.bytes.load(std::memory_order_relaxed);
+    usage.peakBytes = counter.peakBytes.load(std::memory_order_relaxed);
+    usage.allocations = counter.allocations.load(std::memory_order_relaxed);
+    return usage;
+}
+
+int64_t MemoryTracker::getTotalBytes() const {
+    int64_t total = 0;
+    for (const Counter& counter : m_counters) {
+        total += counter.bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+bool MemoryTracker::setDumpFile(const std::string& path, std::chrono::seconds interval) {
+    m_dumpFile.close();
+    m_dumpPath.clear();
+    m_dumpInterval = std::max(interval, std::chrono::seconds(1));
+    if (path.empty()) return true;
+
+    std::error_code error;
+    bool fresh = !std::filesystem::exists(path, error) || std::filesystem::file_size(path, error) == 0;
+    m_dumpFile.open(path, std::ios::app);
+    if (!m_dumpFile.is_open()) return false;
+
+    if (fresh) {
+        m_dumpFile << "seconds";
+        for (const char* name : TAG_NAMES) {
+            m_dumpFile << ',' << name;
+        }
+        m_dumpFile << ",total\n";
+    }
+    m_dumpPath = path;
+    dump();
+    return true;
+}
+
+void MemoryTracker::dump() {
+    if (!m_dumpFile.is_open()) return;
+
+    auto now = std::chrono::steady_clock::now();
+    m_lastDump = now;
+    m_dumpFile << std::chrono::duration_cast<std::chrono::seconds>(now - m_epoch).count();
+    for (const Counter& counter : m_counters) {
+        m_dumpFile << ',' << counter.bytes.load(std::memory_order_relaxed);
+    }
+    m_dumpFile << ',' << getTotalBytes() << '\n';
+    m_dumpFile.flush();
+}
+
+void MemoryTracker::poll() {
+    if (m_dumpFile.is_open() && std::chrono::steady_clock::now() - m_lastDump >= m_dumpInterval) {
+        dump();
+    }
+}
+
+} // namespace framework
+} // namespace shadow
+
+// Global instance
+shadow::framework::MemoryTracker& g_memory = shadow::framework::MemoryTracker::instance();
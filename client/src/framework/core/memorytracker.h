@@ -0,0 +1,118 @@
+/**
+ * Shadow OT Client - Memory Tracker
+ *
+ * Bytes held per subsystem, to tell where a long session's memory went.
+ * Subsystems that allocate piecemeal count each allocation and release
+ * against their tag; those that already know their resident size (the
+ * sprite atlas, the minimap store) report it with setUsage(). Counters are
+ * atomic, so workers and the network thread may count too.
+ *
+ * The totals show in the profiler overlay and in g_memory from Lua. With
+ * a dump file set, poll() appends one CSV row per interval, which is what
+ * to diff when hunting a leak across hours.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace shadow {
+namespace framework {
+
+enum class MemoryTag : uint8_t {
+    MapTiles,       // Tile and chunk objects, not the things on them
+    Minimap,
+    Sprites,        // Sprite atlas pages
+    Sound,          // Decoded effects and music stream buffers
+    Lua,
+    UI,             // Widget objects
+    Network,        // Message buffers
+    Count
+};
+
+class MemoryTracker {
+public:
+    static MemoryTracker& instance();
+
+    static constexpr size_t TAG_COUNT = static_cast<size_t>(MemoryTag::Count);
+
+    struct Usage {
+        int64_t bytes{0};
+        int64_t peakBytes{0};
+        int64_t allocations{0};     // Live; counted ones only
+    };
+
+    static const char* getTagName(MemoryTag tag);
+
+    void allocate(MemoryTag tag, size_t bytes) {
+        Counter& counter = m_counters[static_cast<size_t>(tag)];
+        raisePeak(counter, counter.bytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes));
+        counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void release(MemoryTag tag, size_t bytes) {
+        Counter& counter = m_counters[static_cast<size_t>(tag)];
+        counter.bytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        counter.allocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+    // Existing allocation changing size, e.g. a realloc
+    void resize(MemoryTag tag, size_t oldBytes, size_t newBytes) {
+        Counter& counter = m_counters[static_cast<size_t>(tag)];
+        int64_t delta = static_cast<int64_t>(newBytes) - static_cast<int64_t>(oldBytes);
+        raisePeak(counter, counter.bytes.fetch_add(delta, std::memory_order_relaxed) + delta);
+    }
+    // For owners that track their own size; replaces the byte count
+    void setUsage(MemoryTag tag, size_t bytes) {
+        Counter& counter = m_counters[static_cast<size_t>(tag)];
+        counter.bytes.store(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        raisePeak(counter, static_cast<int64_t>(bytes));
+    }
+
+    Usage getUsage(MemoryTag tag) const;
+    int64_t getTotalBytes() const;
+
+    // Appends a row of per-tag bytes every interval, with a header row
+    // when the file is new; an empty path stops dumping
+    bool setDumpFile(const std::string& path, std::chrono::seconds interval = std::chrono::seconds(60));
+    const std::string& getDumpFile() const { return m_dumpPath; }
+    void dump();
+
+    // Main thread, per frame
+    void poll();
+
+private:
+    MemoryTracker();
+    ~MemoryTracker() = default;
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    struct Counter {
+        std::atomic<int64_t> bytes{0};
+        std::atomic<int64_t> peakBytes{0};
+        std::atomic<int64_t> allocations{0};
+    };
+
+    static void raisePeak(Counter& counter, int64_t bytes) {
+        int64_t peak = counter.peakBytes.load(std::memory_order_relaxed);
+        while (bytes > peak && !counter.peakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+    }
+
+    std::array<Counter, TAG_COUNT> m_counters;
+
+    std::chrono::steady_clock::time_point m_epoch;
+    std::string m_dumpPath;
+    std::ofstream m_dumpFile;
+    std::chrono::seconds m_dumpInterval{60};
+    std::chrono::steady_clock::time_point m_lastDump;
+};
+
+} // namespace framework
+} // namespace shadow
+
+// Global accessor
+extern shadow::framework::MemoryTracker& g_memory;
@@ -0,0 +1,86 @@
+/**
+ * Shadow OT Client - MPSC Queue
+ *
+ * Intrusive, unbounded multi-producer/single-consumer queue (Vyukov's
+ * node queue). Pushing is one atomic exchange and never blocks, so worker
+ * threads can hand work to the main thread without contending on a lock;
+ * only the owning thread may pop. Elements derive from MPSCNode and stay
+ * owned by the caller.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace shadow {
+namespace framework {
+
+struct MPSCNode {
+    std::atomic<MPSCNode*> next{nullptr};
+};
+
+template<typename T>
+class MPSCQueue {
+public:
+    MPSCQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // Any thread
+    void push(T* node) {
+        m_depth.fetch_add(1, std::memory_order_relaxed);
+        pushNode(node);
+    }
+
+    // Consumer thread only. nullptr when empty, or when a producer is
+    // between its exchange and its link; that element shows up next call.
+    T* pop() {
+        MPSCNode* tail = m_tail;
+        MPSCNode* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (!next) return nullptr;
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            m_tail = next;
+            return taken(tail);
+        }
+
+        if (tail != m_head.load(std::memory_order_acquire)) return nullptr;
+
+        // tail is the last element: park the stub behind it so it can go
+        pushNode(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            return taken(tail);
+        }
+        return nullptr;
+    }
+
+    // Approximate while producers are pushing
+    size_t size() const { return m_depth.load(std::memory_order_relaxed); }
+
+private:
+    void pushNode(MPSCNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MPSCNode* previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    T* taken(MPSCNode* node) {
+        m_depth.fetch_sub(1, std::memory_order_relaxed);
+        return static_cast<T*>(node);
+    }
+
+    MPSCNode m_stub;
+    alignas(64) std::atomic<MPSCNode*> m_head;     // Producers
+    alignas(64) MPSCNode* m_tail;                  // Consumer
+    std::atomic<size_t> m_depth{0};
+};
+
+} // namespace framework
+} // namespace shadow
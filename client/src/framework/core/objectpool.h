@@ -0,0 +1,163 @@
+/**
+ * Shadow OT Client - Object Pool
+ *
+ * Fixed-size block pools for objects created in bursts, such as the tiles,
+ * items and creatures of a map description. makePooled<T>() is a drop-in
+ * for std::make_shared<T>() whose object and control block share one block
+ * from T's pool; the block goes back to the free list when the last
+ * reference drops, ready for the next packet.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+// One pool per Tag. The block size is fixed by the first allocation;
+// requests that do not fit fall through to operator new.
+template<typename Tag>
+class ObjectPool {
+public:
+    static constexpr size_t BLOCKS_PER_SLAB = 256;
+
+    // Never destroyed: pooled objects owned by other singletons may still
+    // be released during static destruction
+    static ObjectPool& instance() {
+        static ObjectPool* pool = new ObjectPool;
+        return *pool;
+    }
+
+    void* allocate(size_t size, size_t alignment) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_blockSize == 0) {
+            m_alignment = std::max(alignment, alignof(FreeBlock));
+            m_blockSize = (std::max(size, sizeof(FreeBlock)) + m_alignment - 1) / m_alignment * m_alignment;
+        }
+        if (!fits(size, alignment)) {
+            m_stats.oversized++;
+            return ::operator new(size);
+        }
+
+        if (!m_free) {
+            grow();
+        }
+        m_stats.allocations++;
+
+        FreeBlock* block = m_free;
+        m_free = block->next;
+        m_stats.inUse++;
+        m_stats.peakInUse = std::max(m_stats.peakInUse, m_stats.inUse);
+        return block;
+    }
+
+    void deallocate(void* pointer, size_t size, size_t alignment) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!fits(size, alignment)) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto* block = static_cast<FreeBlock*>(pointer);
+        block->next = m_free;
+        m_free = block;
+        m_stats.inUse--;
+    }
+
+    struct Stats {
+        size_t inUse{0};
+        size_t peakInUse{0};
+        size_t slabs{0};
+        uint64_t allocations{0};   // Served from slabs; compare with slabs * BLOCKS_PER_SLAB
+        uint64_t oversized{0};
+    };
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+    size_t getBlockSize() const { return m_blockSize; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    ObjectPool() = default;
+    ~ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    bool fits(size_t size, size_t alignment) const {
+        return size <= m_blockSize && alignment <= m_alignment;
+    }
+
+    // Slabs are kept for the pool's lifetime; the high-water mark stays
+    // allocated so the next burst does not touch the system allocator
+    void grow() {
+        auto* slab = static_cast<uint8_t*>(::operator new(m_blockSize * BLOCKS_PER_SLAB, std::align_val_t(m_alignment)));
+        m_slabs.push_back(slab);
+        m_stats.slabs++;
+
+        for (size_t i = BLOCKS_PER_SLAB; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(slab + i * m_blockSize);
+            block->next = m_free;
+            m_free = block;
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    FreeBlock* m_free{nullptr};
+    std::vector<void*> m_slabs;
+    size_t m_blockSize{0};
+    size_t m_alignment{0};
+    Stats m_stats;
+};
+
+// Allocator over ObjectPool<Tag>, keeping Tag through rebinds so the
+// control block allocate_shared builds lands in the same pool
+template<typename T, typename Tag = T>
+struct PoolAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = PoolAllocator<U, Tag>;
+    };
+
+    PoolAllocator() noexcept = default;
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n != 1) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(ObjectPool<Tag>::instance().allocate(sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t n) noexcept {
+        if (n != 1) {
+            ::operator delete(pointer);
+            return;
+        }
+        ObjectPool<Tag>::instance().deallocate(pointer, sizeof(T), alignof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U, Tag>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const PoolAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+template<typename T, typename... Args>
+std::shared_ptr<T> makePooled(Args&&... args) {
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,317 @@
+/**
+ * Shadow OT Client - Frame Profiler Implementation
+ */
+
+#include "profiler.h"
+#include "memorytracker.h"
+#include <framework/graphics/graphics.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+constexpr const char* STAGE_NAMES[Profiler::StageCount] = {
+    "poll", "idle", "lua gc", "lua tasks", "dispatcher", "protocol",
+    "ground", "things", "creatures", "top", "effects", "light",
+    "ui", "swap"
+};
+
+constexpr const char* GAUGE_NAMES[Profiler::GaugeCount] = {
+    "lua heap KB", "lua gc ms", "lua tasks", "voices", "culled", "stolen", "creature hit %",
+    "input ms", "jobs busy %", "jobs queued", "render ms", "render dropped"
+};
+
+constexpr int OVERLAY_FONT_SIZE = 11;
+constexpr int OVERLAY_LINE_HEIGHT = 14;
+constexpr int OVERLAY_WIDTH = 260;
+constexpr int OVERLAY_GRAPH_HEIGHT = 40;
+constexpr float OVERLAY_GRAPH_MAX_MS = 50.0f;
+
+} // anonymous namespace
+
+Profiler& Profiler::instance() {
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::Profiler() : m_epoch(Clock::now()), m_lastSummary(m_epoch) {}
+
+const char* Profiler::getStageName(Stage stage) {
+    return stage < StageCount ? STAGE_NAMES[stage] : "unknown";
+}
+
+void Profiler::setEnabled(bool enabled) {
+    if (m_enabled == enabled) return;
+
+    m_enabled = enabled;
+    m_inFrame = false;
+    if (enabled && m_history.empty()) {
+        m_history.resize(HISTORY_FRAMES);
+    }
+}
+
+void Profiler::setOverlayVisible(bool visible) {
+    m_overlayVisible = visible;
+    if (visible) {
+        setEnabled(true);
+    }
+}
+
+void Profiler::setWorkerLoads(const float* loads, size_t count) {
+    m_workerLoadCount = std::min(count, MAX_WORKER_LOADS);
+    std::copy(loads, loads + m_workerLoadCount, m_workerLoads.begin());
+}
+
+void Profiler::beginFrame() {
+    if (!m_enabled) return;
+
+    m_frameStart = Clock::now();
+    m_current = FrameSample{};
+    m_current.frame = m_frameCounter++;
+    m_current.startMs = msSince(m_epoch, m_frameStart);
+    m_stageDepth.fill(0);
+    m_gpuStage = -1;
+    m_inFrame = true;
+}
+
+void Profiler::endFrame() {
+    if (!m_enabled || !m_inFrame) return;
+
+    Clock::time_point now = Clock::now();
+    m_current.frameMs = static_cast<float>(msSince(m_frameStart, now));
+    m_inFrame = false;
+
+    m_history[m_historyHead] = m_current;
+    m_historyHead = (m_historyHead + 1) % HISTORY_FRAMES;
+    m_historySize = std::min(m_historySize + 1, HISTORY_FRAMES);
+
+    // Graphics collected the GPU timers of the frame that many frames back
+    // when this frame began
+    if (m_historySize > Graphics::GPU_TIMER_FRAMES) {
+        FrameSample& timed = sampleAt(Graphics::GPU_TIMER_FRAMES);
+        for (uint32_t stage = 0; stage < StageCount; ++stage) {
+            timed.stages[stage].gpuMs = g_graphics.getGpuTimerMs(stage);
+        }
+    }
+
+    if (msSince(m_lastSummary, now) >= SUMMARY_INTERVAL * 1000.0) {
+        updateSummary();
+        m_lastSummary = now;
+    }
+}
+
+void Profiler::beginStage(Stage stage, bool gpu) {
+    if (!m_inFrame || stage >= StageCount) return;
+
+    // Re-entered stages count once
+    if (m_stageDepth[stage]++ > 0) return;
+
+    Clock::time_point now = Clock::now();
+    m_stageStart[stage] = now;
+    StageSample& sample = m_current.stages[stage];
+    if (sample.cpuMs == 0.0f) {
+        sample.startMs = static_cast<float>(msSince(m_frameStart, now));
+    }
+
+    if (gpu && m_gpuStage < 0) {
+        g_graphics.beginGpuTimer(stage);
+        m_gpuStage = stage;
+    }
+}
+
+void Profiler::endStage(Stage stage) {
+    if (!m_inFrame || stage >= StageCount || m_stageDepth[stage] == 0) return;
+    if (--m_stageDepth[stage] > 0) return;
+
+    if (m_gpuStage == stage) {
+        g_graphics.endGpuTimer();
+        m_gpuStage = -1;
+    }
+
+    m_current.stages[stage].cpuMs += static_cast<float>(msSince(m_stageStart[stage], Clock::now()));
+}
+
+Profiler::FrameSample& Profiler::sampleAt(size_t age) {
+    return m_history[(m_historyHead + HISTORY_FRAMES - 1 - age) % HISTORY_FRAMES];
+}
+
+const Profiler::FrameSample& Profiler::sampleAt(size_t age) const {
+    return m_history[(m_historyHead + HISTORY_FRAMES - 1 - age) % HISTORY_FRAMES];
+}
+
+const Profiler::FrameSample* Profiler::getLastFrame() const {
+    return m_historySize > 0 ? &sampleAt(0) : nullptr;
+}
+
+void Profiler::updateSummary() {
+    Summary summary;
+    summary.frames = static_cast<uint32_t>(m_historySize);
+    if (m_historySize == 0) {
+        m_summary = summary;
+        return;
+    }
+
+    std::array<uint32_t, StageCount> gpuFrames{};
+    m_sortScratch.clear();
+    double total = 0.0;
+    for (size_t age = 0; age < m_historySize; ++age) {
+        const FrameSample& sample = sampleAt(age);
+        m_sortScratch.push_back(sample.frameMs);
+        total += sample.frameMs;
+
+        for (uint32_t stage = 0; stage < StageCount; ++stage) {
+            summary.stageCpuMs[stage] += sample.stages[stage].cpuMs;
+            if (sample.stages[stage].gpuMs >= 0.0f) {
+                summary.stageGpuMs[stage] += sample.stages[stage].gpuMs;
+                gpuFrames[stage]++;
+            }
+        }
+    }
+
+    summary.averageMs = static_cast<float>(total / m_historySize);
+    for (uint32_t stage = 0; stage < StageCount; ++stage) {
+        summary.stageCpuMs[stage] /= static_cast<float>(m_historySize);
+        summary.stageGpuMs[stage] = gpuFrames[stage] ? summary.stageGpuMs[stage] / gpuFrames[stage] : -1.0f;
+    }
+
+    // Percentiles by selection; each pass leaves larger values above the pivot
+    auto percentile = [this](double fraction) {
+        size_t index = std::min(static_cast<size_t>(m_sortScratch.size() * fraction), m_sortScratch.size() - 1);
+        std::nth_element(m_sortScratch.begin(), m_sortScratch.begin() + index, m_sortScratch.end());
+        return m_sortScratch[index];
+    };
+    summary.low1Ms = percentile(0.99);
+    summary.low01Ms = percentile(0.999);
+    summary.worstMs = *std::max_element(m_sortScratch.begin(), m_sortScratch.end());
+
+    m_summary = summary;
+}
+
+void Profiler::drawOverlay(int x, int y) {
+    if (!m_overlayVisible) return;
+
+    const FrameSample* last = getLastFrame();
+    int lines = 3 + StageCount + GaugeCount + (m_workerLoadCount > 0 ? 1 : 0) + 1 + MemoryTracker::TAG_COUNT;
+    Rect panel(x, y, OVERLAY_WIDTH, lines * OVERLAY_LINE_HEIGHT + OVERLAY_GRAPH_HEIGHT + 12);
+    g_graphics.drawFilledRect(panel, Color(0, 0, 0, 180));
+
+    char line[128];
+    int textX = x + 6;
+    int textY = y + 4;
+    auto text = [&](const Color& color) {
+        g_graphics.drawText(line, textX, textY, color, OVERLAY_FONT_SIZE);
+        textY += OVERLAY_LINE_HEIGHT;
+    };
+
+    float frameMs = last ? last->frameMs : 0.0f;
+    std::snprintf(line, sizeof(line), "frame %.2f ms (%.0f fps)", frameMs, frameMs > 0.0f ? 1000.0f / frameMs : 0.0f);
+    text(Color::white());
+    std::snprintf(line, sizeof(line), "avg %.2f  1%% %.2f  0.1%% %.2f  max %.1f",
+                  m_summary.averageMs, m_summary.low1Ms, m_summary.low01Ms, m_summary.worstMs);
+    text(Color::white());
+    std::snprintf(line, sizeof(line), "%-11s %7s %7s", "stage", "cpu ms", "gpu ms");
+    text(Color(160, 160, 160));
+
+    for (uint32_t stage = 0; stage < StageCount; ++stage) {
+        float gpu = m_summary.stageGpuMs[stage];
+        if (gpu >= 0.0f) {
+            std::snprintf(line, sizeof(line), "%-11s %7.2f %7.2f", STAGE_NAMES[stage], m_summary.stageCpuMs[stage], gpu);
+        } else {
+            std::snprintf(line, sizeof(line), "%-11s %7.2f %7s", STAGE_NAMES[stage], m_summary.stageCpuMs[stage], "-");
+        }
+        text(Color(200, 220, 255));
+    }
+    for (uint32_t gauge = 0; gauge < GaugeCount; ++gauge) {
+        std::snprintf(line, sizeof(line), "%-11s %7.2f", GAUGE_NAMES[gauge], m_gauges[gauge]);
+        text(Color(200, 255, 200));
+    }
+    if (m_workerLoadCount > 0) {
+        int used = std::snprintf(line, sizeof(line), "%-11s", "workers %");
+        for (size_t i = 0; i < m_workerLoadCount && used < static_cast<int>(sizeof(line)) - 5; ++i) {
+            used += std::snprintf(line + used, sizeof(line) - used, " %3.0f", m_workerLoads[i] * 100.0f);
+        }
+        text(Color(200, 255, 200));
+    }
+
+    std::snprintf(line, sizeof(line), "%-11s %7.1f %7s", "memory MB", g_memory.getTotalBytes() / (1024.0 * 1024.0), "peak");
+    text(Color(160, 160, 160));
+    for (size_t tag = 0; tag < MemoryTracker::TAG_COUNT; ++tag) {
+        MemoryTracker::Usage usage = g_memory.getUsage(static_cast<MemoryTag>(tag));
+        std::snprintf(line, sizeof(line), "%-11s %7.1f %7.1f", MemoryTracker::getTagName(static_cast<MemoryTag>(tag)),
+                      usage.bytes / (1024.0 * 1024.0), usage.peakBytes / (1024.0 * 1024.0));
+        text(Color(255, 230, 200));
+    }
+
+    // Frame time graph, newest on the right; green within 60 fps, yellow
+    // within 30 fps, red beyond
+    int graphBottom = panel.y + panel.height - 4;
+    int bars = std::min<int>(static_cast<int>(m_historySize), OVERLAY_WIDTH - 12);
+    for (int i = 0; i < bars; ++i) {
+        float ms = sampleAt(i).frameMs;
+        int height = std::max(1, static_cast<int>(std::min(ms, OVERLAY_GRAPH_MAX_MS) / OVERLAY_GRAPH_MAX_MS * OVERLAY_GRAPH_HEIGHT));
+        Color color = ms <= 16.7f ? Color(64, 200, 64) : ms <= 33.4f ? Color(220, 200, 64) : Color(220, 64, 64);
+        g_graphics.drawFilledRect(Rect(x + OVERLAY_WIDTH - 6 - i, graphBottom - height, 1, height), color);
+    }
+}
+
+bool Profiler::exportTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Complete ("X") events in microseconds. CPU stages and frames go on
+    // one track; GPU times on a second, placed at the CPU start of their
+    // stage since the queries carry no timestamps.
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"cpu\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"gpu\"}}";
+
+    char event[256];
+    for (size_t age = m_historySize; age-- > 0;) {
+        const FrameSample& sample = sampleAt(age);
+        double frameUs = sample.startMs * 1000.0;
+
+        std::snprintf(event, sizeof(event),
+                      ",\n{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                      "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+                      frameUs, sample.frameMs * 1000.0, static_cast<unsigned long long>(sample.frame));
+        file << event;
+
+        for (uint32_t stage = 0; stage < StageCount; ++stage) {
+            const StageSample& timing = sample.stages[stage];
+            double startUs = frameUs + timing.startMs * 1000.0;
+            if (timing.cpuMs > 0.0f) {
+                std::snprintf(event, sizeof(event),
+                              ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                              STAGE_NAMES[stage], startUs, timing.cpuMs * 1000.0);
+                file << event;
+            }
+            if (timing.gpuMs >= 0.0f) {
+                std::snprintf(event, sizeof(event),
+                              ",\n{\"name\":\"%s\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+                              STAGE_NAMES[stage], startUs, timing.gpuMs * 1000.0);
+                file << event;
+            }
+        }
+    }
+
+    file << "\n]}\n";
+    return file.good();
+}
+
+void Profiler::clear() {
+    m_historyHead = 0;
+    m_historySize = 0;
+    m_summary = Summary{};
+}
+
+// Global instance inside the namespace
+Profiler& g_profiler = Profiler::instance();
+
+} // namespace framework
+} // namespace shadow
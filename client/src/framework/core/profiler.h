@@ -0,0 +1,189 @@
+/**
+ * Shadow OT Client - Frame Profiler
+ *
+ * Per-stage CPU and GPU timings of the frame loop. Stages are timed with
+ * ProfileScope at their entry points; render stages also time the GPU
+ * through Graphics' timer queries. A rolling history feeds the overlay's
+ * 1% and 0.1% lows and can be exported as a Chrome trace (chrome://tracing,
+ * Perfetto) to attribute stutters.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+class Profiler {
+public:
+    static Profiler& instance();
+
+    enum Stage : uint8_t {
+        StagePoll,          // Window and input events
+        StageIdle,          // Frame limiter sleep
+        StageLuaGC,         // Collection scheduled into idle time
+        StageLuaTasks,      // Script coroutines resumed
+        StageDispatcher,
+        StageProtocol,
+        StageGround,
+        StageThings,
+        StageCreatures,
+        StageTop,
+        StageEffects,
+        StageLight,
+        StageUI,
+        StageSwap,
+        StageCount
+    };
+
+    static constexpr size_t HISTORY_FRAMES = 4096;
+    static constexpr double SUMMARY_INTERVAL = 0.5;    // Seconds between lows updates
+
+    struct StageSample {
+        float startMs{0.0f};        // From the frame start; first entry if repeated
+        float cpuMs{0.0f};          // Summed over the frame
+        float gpuMs{-1.0f};         // -1 when not timed on the GPU
+    };
+
+    struct FrameSample {
+        uint64_t frame{0};
+        double startMs{0.0};        // From the profiler's epoch
+        float frameMs{0.0f};
+        std::array<StageSample, StageCount> stages;
+    };
+
+    // Over the history: average, and the frame times that 1% and 0.1% of
+    // frames exceed
+    struct Summary {
+        uint32_t frames{0};
+        float averageMs{0.0f};
+        float low1Ms{0.0f};
+        float low01Ms{0.0f};
+        float worstMs{0.0f};
+        std::array<float, StageCount> stageCpuMs{};     // Per-frame averages
+        std::array<float, StageCount> stageGpuMs{};     // -1 when never timed
+    };
+
+    // Values subsystems report once per frame, listed under the stages
+    enum Gauge : uint8_t {
+        GaugeLuaHeapKB,
+        GaugeLuaGCPauseMs,  // Longest step over the last second
+        GaugeLuaTasks,      // Script coroutines alive
+        GaugeVoices,        // Sound voices playing
+        GaugeVoicesCulled,  // Since start
+        GaugeVoicesStolen,
+        GaugeCreatureHitRate, // Known creatures revived, percent
+        GaugeInputLatencyMs,  // Slowest input to reach the screen last frame
+        GaugeJobUtilization,  // Job workers busy, percent, averaged over workers
+        GaugeJobsQueued,
+        GaugeRenderMs,        // Render thread's replay and swap of the last snapshot
+        GaugeFramesDropped,   // Snapshots replaced before drawn, since start
+        GaugeCount
+    };
+
+    // Busy share of each job system worker, 0..1, one overlay line
+    static constexpr size_t MAX_WORKER_LOADS = 16;
+
+    static const char* getStageName(Stage stage);
+
+    // Scopes are nearly free while disabled. Enabling also turns on GPU
+    // timers, whose flushes split batches at stage boundaries.
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    // Showing the overlay enables profiling
+    void setOverlayVisible(bool visible);
+    bool isOverlayVisible() const { return m_overlayVisible; }
+    void toggleOverlay() { setOverlayVisible(!m_overlayVisible); }
+
+    // Bracket one iteration of the main loop, one Graphics frame each
+    void beginFrame();
+    void endFrame();
+
+    void beginStage(Stage stage, bool gpu);
+    void endStage(Stage stage);
+
+    void setGauge(Gauge gauge, float value) { m_gauges[gauge] = value; }
+    float getGauge(Gauge gauge) const { return m_gauges[gauge]; }
+
+    void setWorkerLoads(const float* loads, size_t count);
+
+    size_t getHistorySize() const { return m_historySize; }
+    // Latest complete frame; its GPU times lag by Graphics::GPU_TIMER_FRAMES
+    const FrameSample* getLastFrame() const;
+    const Summary& getSummary() const { return m_summary; }
+
+    void drawOverlay(int x, int y);
+
+    // Write the history as Chrome trace events
+    bool exportTrace(const std::string& filename) const;
+
+    void clear();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Profiler();
+    ~Profiler() = default;
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    FrameSample& sampleAt(size_t age);     // 0 = newest
+    const FrameSample& sampleAt(size_t age) const;
+    void updateSummary();
+    double msSince(Clock::time_point from, Clock::time_point to) const {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    bool m_enabled{false};
+    bool m_overlayVisible{false};
+    bool m_inFrame{false};
+
+    Clock::time_point m_epoch;
+    Clock::time_point m_frameStart;
+    std::array<Clock::time_point, StageCount> m_stageStart;
+    std::array<int, StageCount> m_stageDepth{};
+    int m_gpuStage{-1};                     // Stage holding the GPU timer
+    FrameSample m_current;
+    std::array<float, GaugeCount> m_gauges{};
+    std::array<float, MAX_WORKER_LOADS> m_workerLoads{};
+    size_t m_workerLoadCount{0};
+    uint64_t m_frameCounter{0};
+
+    std::vector<FrameSample> m_history;     // Ring of HISTORY_FRAMES
+    size_t m_historyHead{0};                // Next slot to write
+    size_t m_historySize{0};
+
+    Summary m_summary;
+    std::vector<float> m_sortScratch;
+    Clock::time_point m_lastSummary;
+};
+
+// Times a stage for the lifetime of the scope
+class ProfileScope {
+public:
+    explicit ProfileScope(Profiler::Stage stage, bool gpu = false)
+        : m_stage(stage), m_active(Profiler::instance().isEnabled()) {
+        if (m_active) Profiler::instance().beginStage(stage, gpu);
+    }
+    ~ProfileScope() {
+        if (m_active) Profiler::instance().endStage(m_stage);
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler::Stage m_stage;
+    bool m_active;
+};
+
+// Global accessor inside namespace
+extern Profiler& g_profiler;
+
+} // namespace framework
+} // namespace shadow
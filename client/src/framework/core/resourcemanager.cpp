@@ -3,11 +3,14 @@
  */
 
 #include "resourcemanager.h"
+#include "mappedfile.h"
 #include <framework/graphics/graphics.h>
+#include <framework/graphics/font.h>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <filesystem>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -19,16 +22,58 @@ ResourceManager& ResourceManager::instance() {
     return instance;
 }
 
-bool ResourceManager::init() {
+bool ResourceManager::init(int ioJobs) {
     // Add default search paths
     addSearchPath("data");
     addSearchPath(".");
+
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    if (!m_ioRunning) {
+        if (ioJobs <= 0) {
+            // Reads mostly wait on the disk, so a couple at once is enough
+            ioJobs = std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 4, 1, 2);
+        }
+        m_ioJobLimit = static_cast<size_t>(ioJobs);
+        m_ioRunning = true;
+    }
     return true;
 }
 
 void ResourceManager::terminate() {
+    std::vector<IoRequestPtr> abandoned;
+    std::vector<JobSystem::Handle> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        m_ioRunning = false;
+        for (auto& [filename, request] : m_inFlight) {
+            abandoned.push_back(request);
+        }
+        m_inFlight.clear();
+        for (auto& queue : m_ioQueues) {
+            queue.clear();
+        }
+        jobs.swap(m_ioJobs);
+    }
+
+    // Each job stops after the read it is on
+    for (const auto& job : jobs) {
+        g_jobs.wait(job);
+    }
+
+    // Futures see a failed read rather than a broken promise
+    for (auto& request : abandoned) {
+        for (auto& promise : request->promises) {
+            promise.set_value(nullptr);
+        }
+    }
+    m_ioFinished.clear();
+    m_prefetched.clear();
+    m_prefetchOrder.clear();
+    m_prefetchedBytes = 0;
+
     clearCache();
     m_searchPaths.clear();
+    m_packs.clear();
 }
 
 void ResourceManager::addSearchPath(const std::string& path) {
@@ -44,37 +89,85 @@ void ResourceManager::removeSearchPath(const std::string& path) {
     );
 }
 
-std::string ResourceManager::resolvePath(const std::string& filename) const {
+bool ResourceManager::locate(const std::string& filename, Location& location) const {
+    // Paths resolvePath handed out for packed files
+    for (const auto& [mount, pack] : m_packs) {
+        if (filename.size() > mount.size() && filename[mount.size()] == '/' && filename.starts_with(mount)) {
+            std::string name = AssetPack::normalize(std::string_view(filename).substr(mount.size() + 1));
+            if (const AssetPack::Entry* entry = pack->find(name)) {
+                location = {filename, pack.get(), entry};
+                return true;
+            }
+        }
+    }
+
     // Check if absolute path
     if (fs::path(filename).is_absolute()) {
         if (fs::exists(filename)) {
-            return filename;
+            location = {filename, nullptr, nullptr};
+            return true;
         }
-        return "";
+        return false;
     }
 
     // Search in registered paths
+    std::string packedName;
     for (const auto& searchPath : m_searchPaths) {
+        auto pack = m_packs.find(searchPath);
+        if (pack != m_packs.end()) {
+            if (packedName.empty()) packedName = AssetPack::normalize(filename);
+            if (const AssetPack::Entry* entry = pack->second->find(packedName)) {
+                location = {searchPath + "/" + packedName, pack->second.get(), entry};
+                return true;
+            }
+            continue;
+        }
+
         fs::path fullPath = fs::path(searchPath) / filename;
         if (fs::exists(fullPath)) {
-            return fullPath.string();
+            location = {fullPath.string(), nullptr, nullptr};
+            return true;
         }
     }
 
-    return "";
+    return false;
+}
+
+std::string ResourceManager::resolvePath(const std::string& filename) const {
+    Location location;
+    return locate(filename, location) ? location.path : "";
 }
 
 bool ResourceManager::fileExists(const std::string& filename) const {
-    return !resolvePath(filename).empty();
+    Location location;
+    return locate(filename, location);
 }
 
 std::vector<uint8_t> ResourceManager::readFile(const std::string& filename) const {
-    std::string path = resolvePath(filename);
-    if (path.empty()) {
+    FileData prefetched;
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        takePrefetchedLocked(filename, prefetched);
+    }
+    if (prefetched) {
+        return *prefetched;
+    }
+    return readFromDisk(filename);
+}
+
+std::vector<uint8_t> ResourceManager::readFromDisk(const std::string& filename) const {
+    Location location;
+    if (!locate(filename, location)) {
         return {};
     }
 
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    std::vector<uint8_t> buffer;
+    if (location.pack) {
+        location.pack->read(*location.entry, buffer);
+        return buffer;
+    }
+
+    std::ifstream file(location.path, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         return {};
     }
@@ -82,7 +175,7 @@ std::vector<uint8_t> ResourceManager::readFile(const std::string& filename) cons
     std::streamsize size = file.tellg();
     file.seekg(0, std::ios::beg);
 
-    std::vector<uint8_t> buffer(size);
+    buffer.resize(size);
     if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
         return {};
     }
@@ -90,13 +183,33 @@ std::vector<uint8_t> ResourceManager::readFile(const std::string& filename) cons
     return buffer;
 }
 
+bool ResourceManager::mapFile(const std::string& filename, MappedFile& file) const {
+    Location location;
+    if (!locate(filename, location)) {
+        return false;
+    }
+
+    // Stored pack entries are page aligned; compressed ones cannot be mapped
+    if (location.pack) {
+        return !location.entry->isCompressed() &&
+               file.openRange(location.pack->getPath(), location.entry->offset, location.entry->size);
+    }
+    return file.open(location.path, MappedFile::Mode::ReadOnly);
+}
+
 std::string ResourceManager::readFileText(const std::string& filename) const {
-    std::string path = resolvePath(filename);
-    if (path.empty()) {
+    Location location;
+    if (!locate(filename, location)) {
         return "";
     }
 
-    std::ifstream file(path);
+    if (location.pack) {
+        std::vector<uint8_t> bytes;
+        location.pack->read(*location.entry, bytes);
+        return std::string(bytes.begin(), bytes.end());
+    }
+
+    std::ifstream file(location.path);
     if (!file.is_open()) {
         return "";
     }
@@ -126,11 +239,284 @@ bool ResourceManager::writeFileText(const std::string& filename, const std::stri
     return file.good();
 }
 
+void ResourceManager::readFileAsync(const std::string& filename, IoPriority priority, ReadCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        IoRequestPtr request = submitLocked(filename, priority);
+        if (callback) {
+            request->callbacks.push_back(std::move(callback));
+        }
+    }
+    scheduleReads();
+}
+
+std::future<ResourceManager::FileData> ResourceManager::readFileFuture(const std::string& filename,
+                                                                       IoPriority priority) {
+    std::promise<FileData> promise;
+    std::future<FileData> future = promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        IoRequestPtr request = submitLocked(filename, priority);
+        if (m_inFlight.count(filename)) {
+            request->promises.push_back(std::move(promise));
+        } else {
+            // Served from the prefetch cache or read inline; waiting on it
+            // must not depend on a poll()
+            promise.set_value(request->data);
+        }
+    }
+    scheduleReads();
+    return future;
+}
+
+ResourceManager::IoRequestPtr ResourceManager::submitLocked(const std::string& filename, IoPriority priority) {
+    m_ioStats.requests++;
+
+    auto it = m_inFlight.find(filename);
+    if (it != m_inFlight.end()) {
+        IoRequestPtr request = it->second;
+        m_ioStats.deduplicated++;
+        if (!request->started && priority < request->priority) {
+            request->priority = priority;
+            m_ioQueues[static_cast<size_t>(priority)].push_back(request);
+            m_ioStats.promoted++;
+        }
+        return request;
+    }
+
+    auto request = std::make_shared<IoRequest>();
+    request->filename = filename;
+    request->priority = priority;
+
+    if (takePrefetchedLocked(filename, request->data)) {
+        request->started = true;
+        m_ioFinished.push_back(request);
+        return request;
+    }
+
+    if (!m_ioRunning) {
+        // Before init or after terminate; read here, deliver on poll
+        request->data = std::make_shared<const std::vector<uint8_t>>(readFromDisk(filename));
+        if (request->data->empty()) request->data = nullptr;
+        request->started = true;
+        m_ioFinished.push_back(request);
+        return request;
+    }
+
+    m_inFlight.emplace(filename, request);
+    m_ioQueues[static_cast<size_t>(priority)].push_back(request);
+    return request;
+}
+
+void ResourceManager::prefetch(const std::vector<std::string>& files) {
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        if (!m_ioRunning) return;
+
+        auto& queue = m_ioQueues[static_cast<size_t>(IoPriority::Prefetch)];
+        for (const auto& file : files) {
+            if (m_inFlight.count(file) || m_prefetched.count(file)) {
+                continue;
+            }
+            if (queue.size() >= PREFETCH_QUEUE_MAX) {
+                m_ioStats.prefetchDropped++;
+                continue;
+            }
+
+            auto request = std::make_shared<IoRequest>();
+            request->filename = file;
+            m_inFlight.emplace(file, request);
+            queue.push_back(std::move(request));
+        }
+    }
+    scheduleReads();
+}
+
+void ResourceManager::setPrefetchLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    m_prefetchLimit = bytes;
+    storePrefetchedLocked({}, nullptr);
+}
+
+bool ResourceManager::takePrefetchedLocked(const std::string& filename, FileData& data) const {
+    auto it = m_prefetched.find(filename);
+    if (it == m_prefetched.end()) {
+        return false;
+    }
+
+    data = std::move(it->second);
+    m_prefetchedBytes -= data->size();
+    m_prefetched.erase(it);
+    m_ioStats.prefetchHits++;
+    return true;
+}
+
+void ResourceManager::storePrefetchedLocked(const std::string& filename, FileData data) {
+    if (data && data->size() <= m_prefetchLimit && m_prefetched.emplace(filename, data).second) {
+        m_prefetchedBytes += data->size();
+        m_prefetchOrder.push_back(filename);
+    }
+
+    // The order list keeps names already taken; they are skipped here
+    while (m_prefetchedBytes > m_prefetchLimit && !m_prefetchOrder.empty()) {
+        auto it = m_prefetched.find(m_prefetchOrder.front());
+        m_prefetchOrder.pop_front();
+        if (it != m_prefetched.end()) {
+            m_prefetchedBytes -= it->second->size();
+            m_prefetched.erase(it);
+            m_ioStats.prefetchDropped++;
+        }
+    }
+    if (m_prefetchOrder.size() > m_prefetched.size() * 2 + 64) {
+        std::erase_if(m_prefetchOrder, [this](const std::string& name) { return !m_prefetched.count(name); });
+    }
+}
+
+void ResourceManager::scheduleReads() {
+    std::vector<JobSystem::Handle> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        if (!m_ioRunning || m_ioJobsActive >= m_ioJobLimit) return;
+        size_t queued = 0;
+        for (const auto& queue : m_ioQueues) {
+            queued += queue.size();
+        }
+        size_t spawn = std::min(m_ioJobLimit - m_ioJobsActive, queued);
+        if (spawn == 0) return;
+        m_ioJobsActive += spawn;
+        jobs.resize(spawn);
+    }
+
+    // Submitted unlocked: with the job system stopped they run right here
+    for (auto& job : jobs) {
+        job = g_jobs.submitBlocking([this] { readQueued(); });
+    }
+
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    std::erase_if(m_ioJobs, [](const auto& job) { return JobSystem::isDone(job); });
+    m_ioJobs.insert(m_ioJobs.end(), jobs.begin(), jobs.end());
+}
+
+void ResourceManager::readQueued() {
+    std::unique_lock<std::mutex> lock(m_ioMutex);
+    while (true) {
+        IoRequestPtr request;
+        for (size_t priority = 0; priority < m_ioQueues.size() && !request; ++priority) {
+            auto& queue = m_ioQueues[priority];
+            while (!queue.empty()) {
+                IoRequestPtr next = std::move(queue.front());
+                queue.pop_front();
+                // Promoted entries left behind in a lower queue
+                if (!next->started && static_cast<size_t>(next->priority) == priority) {
+                    request = std::move(next);
+                    break;
+                }
+            }
+        }
+        // Leaving under the lock, so a request queued after this finds the
+        // job gone and schedules another
+        if (!m_ioRunning || !request) {
+            m_ioJobsActive--;
+            return;
+        }
+
+        request->started = true;
+        lock.unlock();
+
+        std::vector<uint8_t> bytes = readFromDisk(request->filename);
+        FileData data;
+        if (!bytes.empty()) {
+            data = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+        }
+
+        lock.lock();
+        m_inFlight.erase(request->filename);
+        request->data = data;
+        m_ioStats.completed++;
+        if (data) {
+            m_ioStats.bytesRead += data->size();
+        } else {
+            m_ioStats.failed++;
+        }
+
+        // Nobody but a hint asked for it: keep it for the first real read
+        std::vector<std::promise<FileData>> promises = std::move(request->promises);
+        if (request->callbacks.empty() && promises.empty()) {
+            storePrefetchedLocked(request->filename, std::move(data));
+        } else if (!request->callbacks.empty()) {
+            m_ioFinished.push_back(request);
+        }
+
+        lock.unlock();
+        for (auto& promise : promises) {
+            promise.set_value(request->data);
+        }
+        lock.lock();
+    }
+}
+
+void ResourceManager::poll() {
+    std::vector<IoRequestPtr> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+        if (m_ioFinished.empty()) return;
+        finished.swap(m_ioFinished);
+    }
+
+    for (const auto& request : finished) {
+        for (const auto& callback : request->callbacks) {
+            callback(request->data);
+        }
+        for (auto& promise : request->promises) {
+            promise.set_value(request->data);
+        }
+    }
+}
+
+ResourceManager::IoStats ResourceManager::getIoStats() const {
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    return m_ioStats;
+}
+
+size_t ResourceManager::getPendingReadCount() const {
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    return m_inFlight.size() + m_ioFinished.size();
+}
+
+std::string ResourceManager::locateDirectory(const std::string& path, const AssetPack** pack) const {
+    *pack = nullptr;
+    if (fs::path(path).is_absolute()) {
+        return fs::is_directory(path) ? path : "";
+    }
+
+    for (const auto& searchPath : m_searchPaths) {
+        auto mounted = m_packs.find(searchPath);
+        if (mounted != m_packs.end()) {
+            if (mounted->second->hasDirectory(path)) {
+                *pack = mounted->second.get();
+                return searchPath + "/" + AssetPack::normalize(path);
+            }
+            continue;
+        }
+
+        fs::path fullPath = fs::path(searchPath) / path;
+        if (fs::is_directory(fullPath)) {
+            return fullPath.string();
+        }
+    }
+    return "";
+}
+
 std::vector<std::string> ResourceManager::listDirectory(const std::string& path) const {
-    std::vector<std::string> result;
-    std::string resolvedPath = resolvePath(path);
+    const AssetPack* pack = nullptr;
+    std::string resolvedPath = locateDirectory(path, &pack);
+    if (pack) {
+        return pack->list(path);
+    }
 
-    if (resolvedPath.empty() || !fs::is_directory(resolvedPath)) {
+    std::vector<std::string> result;
+    if (resolvedPath.empty()) {
         return result;
     }
 
@@ -142,8 +528,8 @@ std::vector<std::string> ResourceManager::listDirectory(const std::string& path)
 }
 
 bool ResourceManager::directoryExists(const std::string& path) const {
-    std::string resolved = resolvePath(path);
-    return !resolved.empty() && fs::is_directory(resolved);
+    const AssetPack* pack = nullptr;
+    return !locateDirectory(path, &pack).empty();
 }
 
 bool ResourceManager::createDirectory(const std::string& path) {
@@ -210,8 +596,16 @@ std::shared_ptr<Font> ResourceManager::loadFont(const std::string& filename, int
         return it->second;
     }
 
-    // Font loading would be implemented with FreeType
-    return nullptr;
+    // Bitmap fonts carry their own size; outline formats are not supported
+    if (fs::path(filename).extension() != ".otfont") {
+        return nullptr;
+    }
+
+    auto font = g_fonts.importFont(filename);
+    if (font) {
+        m_fonts[key] = font;
+    }
+    return font;
 }
 
 std::shared_ptr<Font> ResourceManager::getFont(const std::string& name) const {
@@ -242,7 +636,7 @@ void ResourceManager::preloadResources(const std::vector<std::string>& files) {
             loadTexture(file);
         } else if (ext == ".ogg" || ext == ".wav") {
             loadSound(file);
-        } else if (ext == ".ttf" || ext == ".otf") {
+        } else if (ext == ".otfont" || ext == ".ttf" || ext == ".otf") {
             loadFont(file, 12);
         }
     }
@@ -266,14 +660,31 @@ void ResourceManager::setCacheLimit(size_t bytes) {
 }
 
 bool ResourceManager::loadAssetPack(const std::string& filename) {
-    // Asset pack loading (ZIP/custom format) would be implemented here
-    // For now, just add the path
-    addSearchPath(filename);
+    if (m_packs.count(filename)) {
+        return true;
+    }
+
+    // The pack file itself may sit in a search path
+    std::string path = fs::exists(filename) ? filename : resolvePath(filename);
+    auto pack = std::make_unique<AssetPack>();
+    if (path.empty() || !pack->open(path)) {
+        return false;
+    }
+
+    removeSearchPath(filename);
+    m_searchPaths.insert(m_searchPaths.begin(), filename);
+    m_packs.emplace(filename, std::move(pack));
     return true;
 }
 
 void ResourceManager::unloadAssetPack(const std::string& filename) {
     removeSearchPath(filename);
+    m_packs.erase(filename);
+}
+
+const AssetPack* ResourceManager::getAssetPack(const std::string& filename) const {
+    auto it = m_packs.find(filename);
+    return it != m_packs.end() ? it->second.get() : nullptr;
 }
 
 // Global instance inside namespace
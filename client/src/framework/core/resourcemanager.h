@@ -2,15 +2,37 @@
  * Shadow OT Client - Resource Manager
  *
  * Handles loading and caching of game resources.
+ *
+ * Reads can also go through blocking jobs on g_jobs, a few at a time.
+ * Requests are queued by priority (critical UI before visible assets
+ * before prefetch hints);
+ * a file already in flight gets the new waiter attached instead of a
+ * second read, and its priority raised if the new caller needs it
+ * sooner. Callbacks run from poll() on the main thread; futures are
+ * fulfilled by the job that read the file. Prefetched files wait in a bounded cache
+ * until the first readFile or async read takes them.
+ *
+ * Asset packs (see assetpack.h) mount ahead of the directory search
+ * paths; a file inside one is found with a table lookup instead of a stat
+ * per directory. Its resolved path is "<pack>/<name>", which only the
+ * functions here can open.
  */
 
 #pragma once
 
+#include "assetpack.h"
+#include "jobsystem.h"
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <map>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
 
 namespace shadow {
 namespace framework {
@@ -19,15 +41,32 @@ namespace framework {
 class Texture;
 class Sound;
 class Font;
+class MappedFile;
+
+enum class IoPriority : uint8_t {
+    Critical,   // UI the player is waiting on
+    Visible,    // Assets needed on screen this frame or the next
+    Prefetch,   // Hints; queued last and dropped when the queue is long
+    Count
+};
 
 class ResourceManager {
 public:
+    static constexpr size_t PREFETCH_QUEUE_MAX = 256;
+
+    // Shared between every waiter on the same read; nullptr if the file
+    // was not found or could not be read
+    using FileData = std::shared_ptr<const std::vector<uint8_t>>;
+    using ReadCallback = std::function<void(const FileData&)>;
+
     static ResourceManager& instance();
 
-    bool init();
+    // At most ioJobs reads at once; 0 picks a count from the hardware
+    bool init(int ioJobs = 0);
     void terminate();
 
-    // Path management
+    // Path management. Read jobs resolve paths too, so search paths should
+    // only change while no async reads are outstanding.
     void addSearchPath(const std::string& path);
     void removeSearchPath(const std::string& path);
     std::string resolvePath(const std::string& filename) const;
@@ -35,10 +74,34 @@ public:
 
     // File operations
     std::vector<uint8_t> readFile(const std::string& filename) const;
+    // Read-only map of a file on disk; pages load on first access
+    bool mapFile(const std::string& filename, MappedFile& file) const;
     std::string readFileText(const std::string& filename) const;
     bool writeFile(const std::string& filename, const std::vector<uint8_t>& data);
     bool writeFileText(const std::string& filename, const std::string& text);
 
+    // Async reads. The callback runs from poll(), also when the read failed.
+    void readFileAsync(const std::string& filename, IoPriority priority, ReadCallback callback);
+    std::future<FileData> readFileFuture(const std::string& filename, IoPriority priority = IoPriority::Visible);
+    // Warm files that are likely to be read soon; never blocks
+    void prefetch(const std::vector<std::string>& files);
+    void setPrefetchLimit(size_t bytes);
+    // Deliver finished reads; call once per frame on the main thread
+    void poll();
+
+    struct IoStats {
+        uint64_t requests{0};
+        uint64_t deduplicated{0};       // Attached to a read already in flight
+        uint64_t promoted{0};           // ...that then moved to a higher priority
+        uint64_t completed{0};
+        uint64_t failed{0};
+        uint64_t bytesRead{0};
+        uint64_t prefetchHits{0};       // Reads served from the prefetch cache
+        uint64_t prefetchDropped{0};    // Hints refused or evicted unused
+    };
+    IoStats getIoStats() const;
+    size_t getPendingReadCount() const;
+
     // Directory operations
     std::vector<std::string> listDirectory(const std::string& path) const;
     bool directoryExists(const std::string& path) const;
@@ -65,9 +128,11 @@ public:
     size_t getCacheSize() const;
     void setCacheLimit(size_t bytes);
 
-    // Asset pack support
+    // Asset pack support. Packs mounted later are searched first; a pack
+    // must not be unloaded while async reads are outstanding.
     bool loadAssetPack(const std::string& filename);
     void unloadAssetPack(const std::string& filename);
+    const AssetPack* getAssetPack(const std::string& filename) const;
 
 private:
     ResourceManager() = default;
@@ -75,7 +140,57 @@ private:
     ResourceManager(const ResourceManager&) = delete;
     ResourceManager& operator=(const ResourceManager&) = delete;
 
+    struct IoRequest {
+        std::string filename;
+        IoPriority priority{IoPriority::Prefetch};
+        bool started{false};
+        FileData data;
+        std::vector<ReadCallback> callbacks;
+        std::vector<std::promise<FileData>> promises;
+    };
+    using IoRequestPtr = std::shared_ptr<IoRequest>;
+
+    // Where a file is found: a pack entry, or (pack == nullptr) a path
+    struct Location {
+        std::string path;
+        const AssetPack* pack{nullptr};
+        const AssetPack::Entry* entry{nullptr};
+    };
+    bool locate(const std::string& filename, Location& location) const;
+    // Empty if no search path has the directory; pack set when packed
+    std::string locateDirectory(const std::string& path, const AssetPack** pack) const;
+
+    std::vector<uint8_t> readFromDisk(const std::string& filename) const;
+    // Both with m_ioMutex held
+    IoRequestPtr submitLocked(const std::string& filename, IoPriority priority);
+    bool takePrefetchedLocked(const std::string& filename, FileData& data) const;
+    void storePrefetchedLocked(const std::string& filename, FileData data);
+    // Tops up read jobs for what is queued; without m_ioMutex held
+    void scheduleReads();
+    // One read job: takes requests until the queues are empty
+    void readQueued();
+
+    bool m_ioRunning{false};
+    mutable std::mutex m_ioMutex;
+    std::vector<JobSystem::Handle> m_ioJobs;
+    size_t m_ioJobLimit{0};
+    size_t m_ioJobsActive{0};
+    // A promoted request stays in its old queue too; read jobs skip entries
+    // whose priority no longer matches the queue
+    std::array<std::deque<IoRequestPtr>, static_cast<size_t>(IoPriority::Count)> m_ioQueues;
+    std::unordered_map<std::string, IoRequestPtr> m_inFlight;
+    std::vector<IoRequestPtr> m_ioFinished;
+    mutable IoStats m_ioStats;
+
+    // Prefetched files not yet read, evicted oldest first past the limit
+    mutable std::unordered_map<std::string, FileData> m_prefetched;
+    mutable std::deque<std::string> m_prefetchOrder;
+    mutable size_t m_prefetchedBytes{0};
+    size_t m_prefetchLimit{32 * 1024 * 1024};
+
     std::vector<std::string> m_searchPaths;
+    // Keyed by the search path each is mounted as
+    std::unordered_map<std::string, std::unique_ptr<AssetPack>> m_packs;
     std::map<std::string, std::shared_ptr<Texture>> m_textures;
     std::map<std::string, std::shared_ptr<Sound>> m_sounds;
     std::map<std::string, std::shared_ptr<Font>> m_fonts;
@@ -0,0 +1,334 @@
+/**
+ * Shadow OT Client - Startup Graph Implementation
+ */
+
+#include "startupgraph.h"
+#include "jobsystem.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+const char* stateName(StartupGraph::State state) {
+    switch (state) {
+        case StartupGraph::State::Waiting: return "waiting";
+        case StartupGraph::State::Queued: return "queued";
+        case StartupGraph::State::Running: return "running";
+        case StartupGraph::State::Done: return "done";
+        case StartupGraph::State::Failed: return "FAILED";
+        case StartupGraph::State::Skipped: return "skipped";
+    }
+    return "";
+}
+
+} // anonymous namespace
+
+StartupGraph::~StartupGraph() {
+    // Main stages still queued are dropped; workers must not outlive us
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_running == 0; });
+}
+
+void StartupGraph::add(const std::string& name, const std::vector<std::string>& after, StageThread thread, Action action) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t index = m_stages.size();
+
+    Stage& stage = m_stages.emplace_back();
+    stage.record.name = name;
+    stage.record.thread = thread;
+    stage.action = std::move(action);
+
+    for (const std::string& dependency : after) {
+        size_t found = findLocked(dependency);
+        if (found == NOT_FOUND || found == index) {
+            stage.record.error = "depends on unknown stage " + dependency;
+            stage.action = nullptr;
+            stage.record.state = State::Failed;
+            continue;
+        }
+        m_stages[found].dependents.push_back(index);
+        stage.pending++;
+    }
+}
+
+bool StartupGraph::start() {
+    std::vector<size_t> submitNow;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_started) return true;
+        for (const Stage& stage : m_stages) {
+            if (stage.record.state == State::Failed) return false;
+        }
+
+        m_started = true;
+        m_start = Clock::now();
+        m_unfinished = m_stages.size();
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            if (m_stages[i].pending == 0) {
+                queueLocked(i, submitNow);
+            }
+        }
+    }
+    submit(submitNow);
+    return true;
+}
+
+void StartupGraph::queueLocked(size_t index, std::vector<size_t>& submit) {
+    Stage& stage = m_stages[index];
+    stage.record.state = State::Queued;
+    if (stage.record.thread == StageThread::Main) {
+        m_mainQueue.push_back(index);
+    } else {
+        m_running++;
+        submit.push_back(index);
+    }
+}
+
+void StartupGraph::skipDependentsLocked(size_t index) {
+    for (size_t dependent : m_stages[index].dependents) {
+        Stage& stage = m_stages[dependent];
+        if (stage.record.state != State::Waiting) continue;
+        stage.record.state = State::Skipped;
+        m_unfinished--;
+        skipDependentsLocked(dependent);
+    }
+}
+
+void StartupGraph::submit(const std::vector<size_t>& stages) {
+    // Without the job system running these run right here, in order
+    for (size_t index : stages) {
+        g_jobs.submit([this, index] { runStage(index); }, JobPriority::High);
+    }
+}
+
+void StartupGraph::runStage(size_t index) {
+    Action action;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stage& stage = m_stages[index];
+        stage.record.state = State::Running;
+        stage.record.worker = JobSystem::getCurrentWorker();
+        stage.record.startMs = std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+        action = std::move(stage.action);
+    }
+
+    bool ok = false;
+    std::string error;
+    try {
+        ok = !action || action();
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    action = nullptr;
+
+    std::vector<size_t> submitNow;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stage& stage = m_stages[index];
+        double nowMs = std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+        stage.record.durationMs = nowMs - stage.record.startMs;
+        stage.record.state = ok ? State::Done : State::Failed;
+        stage.record.error = std::move(error);
+        m_lastFinishMs = std::max(m_lastFinishMs, nowMs);
+        m_unfinished--;
+
+        if (ok) {
+            for (size_t dependent : stage.dependents) {
+                Stage& next = m_stages[dependent];
+                if (--next.pending == 0 && next.record.state == State::Waiting) {
+                    queueLocked(dependent, submitNow);
+                }
+            }
+        } else {
+            skipDependentsLocked(index);
+        }
+
+        // Counted down after queuing, so waiters never see zero in between
+        if (stage.record.thread == StageThread::Any) {
+            m_running--;
+        }
+        // Under the lock: once m_running is zero the graph may be destroyed
+        m_changed.notify_all();
+    }
+    submit(submitNow);
+}
+
+bool StartupGraph::runMainStage(std::unique_lock<std::mutex>& lock) {
+    if (m_mainQueue.empty()) return false;
+
+    size_t index = m_mainQueue.front();
+    m_mainQueue.erase(m_mainQueue.begin());
+    lock.unlock();
+    runStage(index);
+    lock.lock();
+    return true;
+}
+
+bool StartupGraph::runUntil(const std::vector<std::string>& names) {
+    if (!start()) return false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::vector<size_t> targets;
+    for (const std::string& name : names) {
+        size_t index = findLocked(name);
+        if (index == NOT_FOUND) {
+            m_unknownTarget = name;
+            return false;
+        }
+        targets.push_back(index);
+    }
+
+    auto reached = [&] {
+        return std::all_of(targets.begin(), targets.end(), [&](size_t index) { return finishedLocked(index); });
+    };
+    while (!reached()) {
+        if (runMainStage(lock)) continue;
+        // Nothing left that could finish them
+        if (m_running == 0) break;
+        m_changed.wait(lock, [&] { return reached() || !m_mainQueue.empty() || m_running == 0; });
+    }
+
+    return std::all_of(targets.begin(), targets.end(), [&](size_t index) {
+        return m_stages[index].record.state == State::Done;
+    });
+}
+
+bool StartupGraph::runAll() {
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const Stage& stage : m_stages) {
+            names.push_back(stage.record.name);
+        }
+    }
+    return runUntil(names);
+}
+
+void StartupGraph::poll() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (runMainStage(lock)) {}
+}
+
+bool StartupGraph::finishedLocked(size_t index) const {
+    State state = m_stages[index].record.state;
+    return state == State::Done || state == State::Failed || state == State::Skipped;
+}
+
+size_t StartupGraph::findLocked(const std::string& name) const {
+    for (size_t i = 0; i < m_stages.size(); ++i) {
+        if (m_stages[i].record.name == name) return i;
+    }
+    return NOT_FOUND;
+}
+
+bool StartupGraph::isDone(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t index = findLocked(name);
+    return index != NOT_FOUND && m_stages[index].record.state == State::Done;
+}
+
+bool StartupGraph::isFinished() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_started && m_unfinished == 0;
+}
+
+bool StartupGraph::hasFailed() const {
+    return !getFailedStage().empty();
+}
+
+std::string StartupGraph::getFailedStage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Stage& stage : m_stages) {
+        if (stage.record.state == State::Failed) return stage.record.name;
+    }
+    return {};
+}
+
+std::string StartupGraph::getFailure() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_unknownTarget.empty()) {
+        return "unknown stage " + m_unknownTarget;
+    }
+    for (const Stage& stage : m_stages) {
+        if (stage.record.state != State::Failed) continue;
+        return stage.record.error.empty() ? stage.record.name : stage.record.name + ": " + stage.record.error;
+    }
+    return {};
+}
+
+std::vector<StartupGraph::StageRecord> StartupGraph::getRecords() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<StageRecord> records;
+    records.reserve(m_stages.size());
+    for (const Stage& stage : m_stages) {
+        records.push_back(stage.record);
+    }
+    return records;
+}
+
+double StartupGraph::getElapsedMs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastFinishMs;
+}
+
+void StartupGraph::printSummary(std::ostream& out) const {
+    std::vector<StageRecord> records = getRecords();
+    std::stable_sort(records.begin(), records.end(), [](const StageRecord& a, const StageRecord& b) {
+        return a.startMs < b.startMs;
+    });
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "Startup %.1f ms\n", getElapsedMs());
+    out << line;
+    std::snprintf(line, sizeof(line), "  %-12s %9s %9s  %s\n", "stage", "start ms", "took ms", "thread");
+    out << line;
+    for (const StageRecord& record : records) {
+        char thread[32];
+        if (record.state != State::Done) {
+            std::snprintf(thread, sizeof(thread), "%s", stateName(record.state));
+        } else if (record.worker >= 0) {
+            std::snprintf(thread, sizeof(thread), "worker %d", record.worker);
+        } else {
+            std::snprintf(thread, sizeof(thread), "main");
+        }
+        std::snprintf(line, sizeof(line), "  %-12s %9.1f %9.1f  %s\n",
+                      record.name.c_str(), record.startMs, record.durationMs, thread);
+        out << line;
+    }
+}
+
+bool StartupGraph::exportTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Complete ("X") events in microseconds; the main thread is track 1,
+    // job worker n is track n + 2
+    std::vector<StageRecord> records = getRecords();
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}";
+
+    char event[256];
+    for (const StageRecord& record : records) {
+        if (record.state != State::Done && record.state != State::Failed) continue;
+        std::snprintf(event, sizeof(event),
+                      ",\n{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                      "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"ok\":%s}}",
+                      record.name.c_str(), record.worker + 2, record.startMs * 1000.0, record.durationMs * 1000.0,
+                      record.state == State::Done ? "true" : "false");
+        file << event;
+    }
+    file << "\n]}\n";
+    return file.good();
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,127 @@
+/**
+ * Shadow OT Client - Startup Graph
+ *
+ * Startup as stages with dependencies instead of one long sequence. A
+ * stage runs once every stage it names has finished: Any stages on the
+ * job system, so independent ones overlap, Main stages on the thread
+ * that drives the graph, for GL and whatever the main loop also touches.
+ *
+ * runUntil() drives the graph until the named stages are done, which is
+ * how the login screen comes up before the rest has loaded; poll() then
+ * runs the remaining Main stages from the frame loop. A stage that fails
+ * skips everything depending on it. Each stage's timing is kept for a
+ * printed summary or a Chrome trace.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+enum class StageThread : uint8_t {
+    Main,
+    Any
+};
+
+class StartupGraph {
+public:
+    // Returning false fails the stage
+    using Action = std::function<bool()>;
+
+    enum class State : uint8_t {
+        Waiting,
+        Queued,
+        Running,
+        Done,
+        Failed,
+        Skipped     // A dependency failed
+    };
+
+    struct StageRecord {
+        std::string name;
+        StageThread thread{StageThread::Main};
+        State state{State::Waiting};
+        int worker{-1};             // Job worker that ran it, -1 off the pool
+        double startMs{0.0};        // From start()
+        double durationMs{0.0};
+        std::string error;          // Why it failed, if it threw or was misdeclared
+    };
+
+    StartupGraph() = default;
+    // Waits for stages still running on workers
+    ~StartupGraph();
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    // Dependencies must be added before the stages that name them
+    void add(const std::string& name, const std::vector<std::string>& after, StageThread thread, Action action);
+
+    // Queues the stages without dependencies; false on an unknown
+    // dependency, with nothing started
+    bool start();
+
+    // Main thread: runs Main stages as they become ready, sleeping while
+    // only workers have something to do. False if any of them failed.
+    bool runUntil(const std::vector<std::string>& names);
+    bool runAll();
+
+    // Main thread, per frame: runs the Main stages that are ready
+    void poll();
+
+    bool isDone(const std::string& name) const;
+    bool isFinished() const;
+    bool hasFailed() const;
+    std::string getFailedStage() const;
+    // The failed stage and its error, or the unknown stage runUntil() was
+    // asked for; empty while nothing has failed
+    std::string getFailure() const;
+
+    std::vector<StageRecord> getRecords() const;
+    // Wall time from start() to the last stage finishing, so far
+    double getElapsedMs() const;
+
+    void printSummary(std::ostream& out) const;
+    bool exportTrace(const std::string& filename) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stage {
+        StageRecord record;
+        Action action;
+        std::vector<size_t> dependents;
+        size_t pending{0};
+    };
+
+    bool finishedLocked(size_t index) const;
+    size_t findLocked(const std::string& name) const;
+    // Both with m_mutex held; Any stages come back to be submitted unlocked
+    void queueLocked(size_t index, std::vector<size_t>& submit);
+    void skipDependentsLocked(size_t index);
+    void submit(const std::vector<size_t>& stages);
+    void runStage(size_t index);
+    bool runMainStage(std::unique_lock<std::mutex>& lock);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::vector<Stage> m_stages;
+    std::vector<size_t> m_mainQueue;
+    size_t m_unfinished{0};
+    size_t m_running{0};            // On workers
+    bool m_started{false};
+    Clock::time_point m_start;
+    double m_lastFinishMs{0.0};
+    std::string m_unknownTarget;
+};
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,46 @@
+/**
+ * Shadow OT Client - String Table Implementation
+ */
+
+#include "stringtable.h"
+
+namespace shadow {
+namespace framework {
+
+const std::string& InternedString::emptyValue() {
+    static const std::string empty;
+    return empty;
+}
+
+StringTable& StringTable::instance() {
+    static StringTable instance;
+    return instance;
+}
+
+InternedString StringTable::intern(std::string_view value) {
+    if (value.empty()) return InternedString();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_strings.find(value);
+    if (it == m_strings.end()) {
+        it = m_strings.emplace(value).first;
+        m_bytes += value.size();
+    }
+    return InternedString(&*it);
+}
+
+size_t StringTable::getCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_strings.size();
+}
+
+size_t StringTable::getBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+// Global instance inside the namespace
+StringTable& g_strings = StringTable::instance();
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,77 @@
+/**
+ * Shadow OT Client - String Table
+ *
+ * Interned copies of values the server sends over and over from a closed
+ * vocabulary, such as outfit and mount names. Each distinct value is
+ * allocated once and lives until exit, so parsers can hand out references
+ * and views to it instead of a fresh std::string per packet, and interned
+ * strings compare by pointer. Nothing is ever freed, so open-ended values
+ * (creature and player names, channel names, chat) must not be interned;
+ * they are copied where kept and read as string views otherwise.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace shadow {
+namespace framework {
+
+class InternedString {
+public:
+    InternedString() : m_value(&emptyValue()) {}
+
+    const std::string& str() const { return *m_value; }
+    std::string_view view() const { return *m_value; }
+    operator const std::string&() const { return *m_value; }
+    bool empty() const { return m_value->empty(); }
+
+    // Every value is interned once, so equal strings share storage
+    bool operator==(const InternedString& other) const { return m_value == other.m_value; }
+
+private:
+    friend class StringTable;
+    explicit InternedString(const std::string* value) : m_value(value) {}
+
+    static const std::string& emptyValue();
+
+    const std::string* m_value;
+};
+
+class StringTable {
+public:
+    static StringTable& instance();
+
+    // Looks up without allocating; copies only the first time a value is seen
+    InternedString intern(std::string_view value);
+
+    size_t getCount() const;
+    size_t getBytes() const;
+
+private:
+    StringTable() = default;
+    ~StringTable() = default;
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    // Node-based, so interned values keep their address across rehashes
+    std::unordered_set<std::string, Hash, std::equal_to<>> m_strings;
+    size_t m_bytes{0};
+    mutable std::mutex m_mutex;
+};
+
+// Global accessor inside namespace
+extern StringTable& g_strings;
+
+} // namespace framework
+} // namespace shadow
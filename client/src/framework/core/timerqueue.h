@@ -0,0 +1,220 @@
+/**
+ * Shadow OT Client - Timer Queue
+ *
+ * Min-heap of timers with handles. Adding, cancelling and rescheduling
+ * cost O(log n); finding what is due looks only at the top of the heap,
+ * so idle timers cost nothing per frame. Each heap entry knows its slot
+ * and each slot its heap position, which lets cancel remove an entry in
+ * place. Handles carry a generation, so a stale one never hits a slot
+ * that has been reused.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+template<typename T>
+class TimerQueue {
+public:
+    using Handle = uint64_t;                // 0 is never a valid handle
+
+    Handle add(double time, T payload) {
+        uint32_t slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+
+        Slot& s = m_slots[slot];
+        s.payload = std::move(payload);
+        s.heapIndex = static_cast<uint32_t>(m_heap.size());
+        m_heap.push_back({time, m_nextSequence++, slot});
+        siftUp(s.heapIndex);
+        return makeHandle(slot, s.generation);
+    }
+
+    bool cancel(Handle handle) {
+        uint32_t slot;
+        if (!resolve(handle, slot)) return false;
+        removeAt(m_slots[slot].heapIndex);
+        release(slot);
+        return true;
+    }
+
+    bool reschedule(Handle handle, double time) {
+        uint32_t slot;
+        if (!resolve(handle, slot)) return false;
+        uint32_t index = m_slots[slot].heapIndex;
+        m_heap[index].time = time;
+        m_heap[index].sequence = m_nextSequence++;
+        siftDown(siftUp(index));
+        return true;
+    }
+
+    bool contains(Handle handle) const {
+        uint32_t slot;
+        return resolve(handle, slot);
+    }
+
+    T* find(Handle handle) {
+        uint32_t slot;
+        return resolve(handle, slot) ? &m_slots[slot].payload : nullptr;
+    }
+
+    // Runs fn(handle, payload) for each timer due by now, earliest first
+    // and in insertion order among equal times. fn returns the timer's
+    // next time, or a negative value to drop it. A timer rescheduled from
+    // fn runs again on a later call at the earliest, even if it is
+    // already due. fn must not add or cancel timers.
+    template<typename F>
+    size_t runExpired(double now, F&& fn) {
+        size_t ran = 0;
+        while (!m_heap.empty() && m_heap[0].time <= now) {
+            uint32_t slot = m_heap[0].slot;
+            double next = fn(makeHandle(slot, m_slots[slot].generation), m_slots[slot].payload);
+            ran++;
+
+            removeAt(0);
+            if (next < 0.0) {
+                release(slot);
+            } else {
+                // Held out of the heap until the pass ends
+                m_rearm.push_back({next, 0, slot});
+            }
+        }
+
+        for (Entry& entry : m_rearm) {
+            entry.sequence = m_nextSequence++;
+            m_heap.push_back(entry);
+            siftUp(static_cast<uint32_t>(m_heap.size() - 1));
+        }
+        m_rearm.clear();
+        return ran;
+    }
+
+    // Cancels every timer whose payload matches; O(n)
+    template<typename P>
+    size_t cancelIf(P&& predicate) {
+        // Removal reorders the heap, so match first
+        std::vector<uint32_t> matched;
+        for (const Entry& entry : m_heap) {
+            if (predicate(m_slots[entry.slot].payload)) matched.push_back(entry.slot);
+        }
+        for (uint32_t slot : matched) {
+            removeAt(m_slots[slot].heapIndex);
+            release(slot);
+        }
+        return matched.size();
+    }
+
+    size_t size() const { return m_heap.size(); }
+    bool empty() const { return m_heap.empty(); }
+    // Time of the earliest timer; only meaningful when not empty
+    double nextTime() const { return m_heap.empty() ? 0.0 : m_heap[0].time; }
+
+    void clear() {
+        for (const Entry& entry : m_heap) {
+            release(entry.slot);
+        }
+        m_heap.clear();
+    }
+
+private:
+    static constexpr uint32_t NO_INDEX = UINT32_MAX;
+
+    struct Entry {
+        double time;
+        uint64_t sequence;
+        uint32_t slot;
+    };
+
+    struct Slot {
+        T payload{};
+        uint32_t heapIndex{NO_INDEX};
+        uint32_t generation{1};
+    };
+
+    static Handle makeHandle(uint32_t slot, uint32_t generation) {
+        return (static_cast<Handle>(generation) << 32) | (slot + 1);
+    }
+
+    bool resolve(Handle handle, uint32_t& slot) const {
+        uint32_t low = static_cast<uint32_t>(handle);
+        if (low == 0 || low > m_slots.size()) return false;
+        slot = low - 1;
+        const Slot& s = m_slots[slot];
+        return s.heapIndex != NO_INDEX && s.generation == static_cast<uint32_t>(handle >> 32);
+    }
+
+    void release(uint32_t slot) {
+        Slot& s = m_slots[slot];
+        s.payload = T{};
+        s.heapIndex = NO_INDEX;
+        if (++s.generation == 0) s.generation = 1;
+        m_freeSlots.push_back(slot);
+    }
+
+    static bool before(const Entry& a, const Entry& b) {
+        return a.time < b.time || (a.time == b.time && a.sequence < b.sequence);
+    }
+
+    void place(uint32_t index, const Entry& entry) {
+        m_heap[index] = entry;
+        m_slots[entry.slot].heapIndex = index;
+    }
+
+    uint32_t siftUp(uint32_t index) {
+        Entry entry = m_heap[index];
+        while (index > 0) {
+            uint32_t parent = (index - 1) / 2;
+            if (!before(entry, m_heap[parent])) break;
+            place(index, m_heap[parent]);
+            index = parent;
+        }
+        place(index, entry);
+        return index;
+    }
+
+    void siftDown(uint32_t index) {
+        Entry entry = m_heap[index];
+        uint32_t count = static_cast<uint32_t>(m_heap.size());
+        while (true) {
+            uint32_t child = index * 2 + 1;
+            if (child >= count) break;
+            if (child + 1 < count && before(m_heap[child + 1], m_heap[child])) child++;
+            if (!before(m_heap[child], entry)) break;
+            place(index, m_heap[child]);
+            index = child;
+        }
+        place(index, entry);
+    }
+
+    void removeAt(uint32_t index) {
+        uint32_t last = static_cast<uint32_t>(m_heap.size() - 1);
+        if (index != last) {
+            place(index, m_heap[last]);
+            m_heap.pop_back();
+            siftDown(siftUp(index));
+        } else {
+            m_heap.pop_back();
+        }
+    }
+
+    std::vector<Entry> m_heap;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<Entry> m_rearm;
+    uint64_t m_nextSequence{0};
+};
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,369 @@
+/**
+ * Shadow OT Client - Bitmap Fonts Implementation
+ */
+
+#include "font.h"
+#include "image.h"
+#include <framework/core/resourcemanager.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+// "24 24" -> 24, 24
+void parsePair(std::string_view value, int& a, int& b) {
+    std::istringstream stream{std::string(value)};
+    stream >> a >> b;
+}
+
+// The "11" of "verdana-11px-antialised", or 0
+int parsePixelSize(const std::string& name) {
+    size_t px = name.find("px");
+    while (px != std::string::npos) {
+        size_t start = px;
+        while (start > 0 && std::isdigit(static_cast<unsigned char>(name[start - 1]))) start--;
+        if (start < px) {
+            return std::stoi(name.substr(start, px - start));
+        }
+        px = name.find("px", px + 2);
+    }
+    return 0;
+}
+
+// Next glyph code of UTF-8 text. Latin-1 code points map onto the font's
+// code page directly; anything else becomes '?'. Stray bytes that are not
+// valid UTF-8 are taken as single-byte characters.
+int nextGlyph(std::string_view text, size_t& pos) {
+    uint8_t lead = static_cast<uint8_t>(text[pos++]);
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    int length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    if (length == 0 || pos + length > text.size()) {
+        return lead;
+    }
+    for (int i = 0; i < length; ++i) {
+        if ((static_cast<uint8_t>(text[pos + i]) & 0xC0) != 0x80) {
+            return lead;
+        }
+    }
+
+    int code = '?';
+    if (length == 1) {
+        int decoded = ((lead & 0x1F) << 6) | (static_cast<uint8_t>(text[pos]) & 0x3F);
+        if (decoded < Font::GLYPH_COUNT) {
+            code = decoded;
+        }
+    }
+    pos += length;
+    return code;
+}
+
+} // anonymous namespace
+
+bool Font::load(const std::string& filename, TextureAtlas& atlas, uint32_t id) {
+    std::string content = g_resources.readFileText(filename);
+    if (content.empty()) {
+        return false;
+    }
+
+    std::string texture;
+    int cellWidth = 0;
+    int cellHeight = 0;
+    int spaceWidth = 0;
+    int yOffset = 0;
+    int fixedWidth = 0;
+
+    std::istringstream lines(content);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+
+        std::string_view key = trim(std::string_view(line).substr(0, colon));
+        std::string_view value = trim(std::string_view(line).substr(colon + 1));
+
+        if (key == "name") m_name = value;
+        else if (key == "texture") texture = value;
+        else if (key == "height") m_glyphHeight = std::atoi(std::string(value).c_str());
+        else if (key == "glyph-size") parsePair(value, cellWidth, cellHeight);
+        else if (key == "space-width") spaceWidth = std::atoi(std::string(value).c_str());
+        else if (key == "spacing") parsePair(value, m_spacingX, m_spacingY);
+        else if (key == "y-offset") yOffset = std::atoi(std::string(value).c_str());
+        else if (key == "fixed-glyph-width") fixedWidth = std::atoi(std::string(value).c_str());
+        else if (key == "default") m_default = value == "true";
+    }
+
+    if (texture.empty() || cellWidth <= 0 || cellHeight <= 0) {
+        return false;
+    }
+    if (m_name.empty()) {
+        m_name = fs::path(filename).stem().string();
+    }
+    if (m_glyphHeight <= 0) {
+        m_glyphHeight = cellHeight;
+    }
+    m_pixelSize = parsePixelSize(m_name);
+    if (m_pixelSize <= 0) {
+        m_pixelSize = m_glyphHeight;
+    }
+
+    // The texture is named relative to the description, usually without
+    // its extension
+    fs::path texturePath = fs::path(filename).parent_path() / texture;
+    if (!texturePath.has_extension()) {
+        texturePath += ".png";
+    }
+
+    std::vector<uint8_t> data = g_resources.readFile(texturePath.generic_string());
+    Image image;
+    if (data.empty() || !decodePng(data.data(), data.size(), image)) {
+        return false;
+    }
+
+    int columns = image.width / cellWidth;
+    int rows = image.height / cellHeight;
+    int glyphHeight = std::min(m_glyphHeight, cellHeight - yOffset);
+    std::vector<uint8_t> pixels;
+
+    for (int code = FIRST_GLYPH; code < GLYPH_COUNT; ++code) {
+        int cell = code - FIRST_GLYPH;
+        if (columns <= 0 || cell / columns >= rows) {
+            break;
+        }
+
+        int cellX = (cell % columns) * cellWidth;
+        int cellY = (cell / columns) * cellHeight + yOffset;
+        Glyph& glyph = m_glyphs[code];
+
+        // Blank space keeps its configured width; others end at their
+        // rightmost painted column unless the font is fixed width
+        bool blank = code == ' ' || code == 0xA0;
+        int width = fixedWidth;
+        if (!blank && width <= 0) {
+            for (int x = cellWidth - 1; x >= 0 && width <= 0; --x) {
+                for (int y = 0; y < glyphHeight; ++y) {
+                    if (image.pixels[((cellY + y) * image.width + cellX + x) * 4 + 3] != 0) {
+                        width = x + 1;
+                        break;
+                    }
+                }
+            }
+        }
+        glyph.advance = (blank ? spaceWidth : width) + m_spacingX;
+
+        if (blank || width <= 0 || glyphHeight <= 0) {
+            continue;
+        }
+
+        pixels.resize(static_cast<size_t>(width) * glyphHeight * 4);
+        for (int y = 0; y < glyphHeight; ++y) {
+            const uint8_t* src = &image.pixels[((cellY + y) * image.width + cellX) * 4];
+            std::copy(src, src + width * 4, pixels.begin() + static_cast<size_t>(y) * width * 4);
+        }
+
+        const AtlasRegion* region = atlas.add((static_cast<uint64_t>(id) << 8) | code, width, glyphHeight, pixels.data());
+        if (region) {
+            glyph.page = region->page;
+            glyph.src = region->rect;
+        }
+    }
+
+    // Characters past the end of the grid fall back to '?'
+    for (int code = FIRST_GLYPH; code < GLYPH_COUNT; ++code) {
+        if (code - FIRST_GLYPH >= columns * rows) {
+            m_glyphs[code] = m_glyphs['?'];
+        }
+    }
+
+    return true;
+}
+
+void Font::drawText(std::string_view text, int x, int y, const Color& color) {
+    if (text.empty()) {
+        return;
+    }
+
+    for (const GlyphQuad& quad : layout(text).quads) {
+        g_graphics.drawTextureColored(quad.page, quad.src,
+                                      Rect(x + quad.x, y + quad.y, quad.src.width, quad.src.height), color);
+    }
+}
+
+Size Font::measureText(std::string_view text) const {
+    int width = 0;
+    int lineWidth = 0;
+    int lines = 1;
+
+    for (size_t pos = 0; pos < text.size();) {
+        int code = nextGlyph(text, pos);
+        if (code == '\n') {
+            width = std::max(width, lineWidth);
+            lineWidth = 0;
+            lines++;
+            continue;
+        }
+        lineWidth += m_glyphs[code].advance;
+    }
+
+    width = std::max(width, lineWidth);
+    return Size(width, lines * m_glyphHeight + (lines - 1) * m_spacingY);
+}
+
+const Font::Layout& Font::layout(std::string_view text) {
+    m_useClock++;
+
+    auto it = m_layouts.find(text);
+    if (it != m_layouts.end()) {
+        m_stats.layoutHits++;
+        it->second.lastUsed = m_useClock;
+        return it->second;
+    }
+
+    m_stats.layoutMisses++;
+    if (m_layouts.size() >= LAYOUT_CACHE_MAX) {
+        trimLayouts();
+    }
+
+    Layout& entry = m_layouts.try_emplace(std::string(text)).first->second;
+    entry.lastUsed = m_useClock;
+
+    int penX = 0;
+    int penY = 0;
+    for (size_t pos = 0; pos < text.size();) {
+        int code = nextGlyph(text, pos);
+        if (code == '\n') {
+            penX = 0;
+            penY += getLineHeight();
+            continue;
+        }
+
+        const Glyph& glyph = m_glyphs[code];
+        if (glyph.page) {
+            entry.quads.push_back({glyph.page, glyph.src, penX, penY});
+        }
+        penX += glyph.advance;
+    }
+
+    return entry;
+}
+
+void Font::trimLayouts() {
+    // Drop the least recently drawn half; strings redrawn every frame
+    // (labels, names) stay, one-off strings (chat, damage) cycle out
+    m_trimScratch.clear();
+    for (const auto& [text, layout] : m_layouts) {
+        m_trimScratch.push_back(layout.lastUsed);
+    }
+
+    auto middle = m_trimScratch.begin() + m_trimScratch.size() / 2;
+    std::nth_element(m_trimScratch.begin(), middle, m_trimScratch.end());
+    uint64_t threshold = *middle;
+
+    for (auto it = m_layouts.begin(); it != m_layouts.end();) {
+        if (it->second.lastUsed <= threshold) {
+            it = m_layouts.erase(it);
+            m_stats.layoutsEvicted++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+FontManager& FontManager::instance() {
+    static FontManager instance;
+    return instance;
+}
+
+void FontManager::terminate() {
+    m_defaultFont.reset();
+    m_fonts.clear();
+    m_glyphAtlas.reset();
+}
+
+std::shared_ptr<Font> FontManager::importFont(const std::string& filename) {
+    if (!m_glyphAtlas) {
+        m_glyphAtlas = std::make_unique<TextureAtlas>(GLYPH_PAGE_SIZE, GLYPH_MEMORY_BUDGET);
+    }
+
+    auto font = std::make_shared<Font>();
+    if (!font->load(filename, *m_glyphAtlas, m_nextFontId++)) {
+        return nullptr;
+    }
+
+    // A reloaded font replaces the old one of the same name
+    auto it = std::find_if(m_fonts.begin(), m_fonts.end(),
+                           [&](const auto& other) { return other->getName() == font->getName(); });
+    if (it != m_fonts.end()) {
+        if (m_defaultFont == *it) {
+            m_defaultFont.reset();
+        }
+        *it = font;
+    } else {
+        m_fonts.push_back(font);
+    }
+
+    if (font->isDefault() || !m_defaultFont) {
+        m_defaultFont = font;
+    }
+    return font;
+}
+
+std::vector<std::string> FontManager::importFonts(const std::string& directory) {
+    std::vector<std::string> files = g_resources.listDirectory(directory);
+    std::sort(files.begin(), files.end());
+
+    std::vector<std::string> failed;
+    for (const auto& file : files) {
+        if (fs::path(file).extension() == ".otfont" && !importFont(directory + "/" + file)) {
+            failed.push_back(directory + "/" + file);
+        }
+    }
+    return failed;
+}
+
+std::shared_ptr<Font> FontManager::getFont(const std::string& name) const {
+    for (const auto& font : m_fonts) {
+        if (font->getName() == name) {
+            return font;
+        }
+    }
+    return nullptr;
+}
+
+Font* FontManager::getFont(int pixelSize) const {
+    Font* best = m_defaultFont.get();
+    int bestDistance = best ? std::abs(best->getPixelSize() - pixelSize) : 0;
+
+    for (const auto& font : m_fonts) {
+        int distance = std::abs(font->getPixelSize() - pixelSize);
+        if (distance < bestDistance) {
+            best = font.get();
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+// Global instance inside the namespace
+FontManager& g_fonts = FontManager::instance();
+
+} // namespace framework
+} // namespace shadow
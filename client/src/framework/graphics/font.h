@@ -0,0 +1,138 @@
+/**
+ * Shadow OT Client - Bitmap Fonts
+ *
+ * OTClient-style bitmap fonts: an .otfont description plus a PNG holding a
+ * row-major grid of glyph cells from character 32 on. Glyphs are cut out
+ * once at load and packed into a glyph atlas shared by all fonts, so text
+ * of any font goes out through the regular quad batch. Laid out strings
+ * are cached per font and measuring walks the glyph advances without
+ * allocating.
+ */
+
+#pragma once
+
+#include "graphics.h"
+#include "textureatlas.h"
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+class Font {
+public:
+    static constexpr int FIRST_GLYPH = 32;
+    static constexpr int GLYPH_COUNT = 256;
+    static constexpr size_t LAYOUT_CACHE_MAX = 512;
+
+    struct Stats {
+        uint64_t layoutHits{0};
+        uint64_t layoutMisses{0};
+        uint64_t layoutsEvicted{0};
+    };
+
+    // Parse an .otfont file and pack its glyphs into the atlas under keys
+    // derived from id
+    bool load(const std::string& filename, TextureAtlas& atlas, uint32_t id);
+
+    const std::string& getName() const { return m_name; }
+    // Nominal size: the "Npx" of the name, else the glyph height
+    int getPixelSize() const { return m_pixelSize; }
+    int getGlyphHeight() const { return m_glyphHeight; }
+    int getLineHeight() const { return m_glyphHeight + m_spacingY; }
+    bool isDefault() const { return m_default; }
+
+    // Top-left of the first line at x, y; '\n' starts a new line. Text is
+    // UTF-8, drawn in the font's single-byte code page.
+    void drawText(std::string_view text, int x, int y, const Color& color);
+    Size measureText(std::string_view text) const;
+
+    size_t getLayoutCount() const { return m_layouts.size(); }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct Glyph {
+        const Texture* page{nullptr};   // Null for blank glyphs
+        Rect src;                       // Within the page
+        int advance{0};
+    };
+
+    struct GlyphQuad {
+        const Texture* page;
+        Rect src;
+        int x, y;                       // Relative to the text origin
+    };
+
+    struct Layout {
+        std::vector<GlyphQuad> quads;
+        uint64_t lastUsed{0};
+    };
+
+    struct TextHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+    };
+
+    const Layout& layout(std::string_view text);
+    void trimLayouts();
+
+    std::string m_name;
+    int m_pixelSize{0};
+    int m_glyphHeight{0};
+    int m_spacingX{0};
+    int m_spacingY{0};
+    bool m_default{false};
+    std::array<Glyph, GLYPH_COUNT> m_glyphs;
+
+    std::unordered_map<std::string, Layout, TextHash, std::equal_to<>> m_layouts;
+    std::vector<uint64_t> m_trimScratch;
+    uint64_t m_useClock{0};
+    Stats m_stats;
+};
+
+class FontManager {
+public:
+    static FontManager& instance();
+
+    // Fonts keep the regions of their glyphs, so the glyph pages are never
+    // evicted; the budget only caps how many may be created
+    static constexpr int GLYPH_PAGE_SIZE = 1024;
+    static constexpr size_t GLYPH_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    // Releases the fonts and their glyph pages; call before Graphics::terminate
+    void terminate();
+
+    // Load one .otfont, or every .otfont of a directory in name order;
+    // the directory import returns the files that failed
+    std::shared_ptr<Font> importFont(const std::string& filename);
+    std::vector<std::string> importFonts(const std::string& directory);
+
+    std::shared_ptr<Font> getFont(const std::string& name) const;
+    // Closest nominal size; ties go to the default font, then load order
+    Font* getFont(int pixelSize) const;
+    Font* getDefaultFont() const { return m_defaultFont.get(); }
+    size_t getFontCount() const { return m_fonts.size(); }
+    const TextureAtlas* getGlyphAtlas() const { return m_glyphAtlas.get(); }
+
+private:
+    FontManager() = default;
+    ~FontManager() = default;
+    FontManager(const FontManager&) = delete;
+    FontManager& operator=(const FontManager&) = delete;
+
+    std::vector<std::shared_ptr<Font>> m_fonts;
+    std::shared_ptr<Font> m_defaultFont;
+    std::unique_ptr<TextureAtlas> m_glyphAtlas;
+    uint32_t m_nextFontId{0};
+};
+
+// Global accessor inside namespace
+extern FontManager& g_fonts;
+
+} // namespace framework
+} // namespace shadow
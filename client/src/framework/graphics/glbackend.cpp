@@ -0,0 +1,741 @@
+/**
+ * Shadow OT Client - OpenGL Backend Implementation
+ */
+
+#include "glbackend.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <cstring>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+// Last GL state set through the backend, so binds, toggles and uniform
+// uploads that would change nothing are never issued; per-call driver
+// overhead is high on some platforms, macOS above all. Everything starts
+// unknown and is set on first use. GL calls that bypass the cache must be
+// followed by invalidate().
+struct GLStateCache {
+    static constexpr GLuint UNKNOWN = ~GLuint{0};
+    static constexpr int TEXTURE_UNITS = 2;
+
+    GLuint program{UNKNOWN};
+    GLuint vertexArray{UNKNOWN};
+    GLuint arrayBuffer{UNKNOWN};
+    GLuint unpackBuffer{UNKNOWN};
+    GLuint framebuffer{UNKNOWN};
+    int activeUnit{-1};
+    GLuint textures[TEXTURE_UNITS]{UNKNOWN, UNKNOWN};
+    GLenum blend[4]{};
+    bool blendKnown{false};
+    int scissorTest{-1};
+    GLint scissorBox[4]{};
+    bool scissorKnown{false};
+    GLint viewport[4]{};
+    bool viewportKnown{false};
+
+    // Last value per program and location: a matrix, or an int in the
+    // first float's bytes
+    struct Uniform {
+        GLuint program;
+        GLint location;
+        float value[16];
+    };
+    std::vector<Uniform> uniforms;
+
+    // Calls made and skipped since the counters were last taken
+    uint32_t issued{0};
+    uint32_t skipped{0};
+
+    bool differs(bool changed) {
+        changed ? issued++ : skipped++;
+        return changed;
+    }
+
+    std::pair<uint32_t, uint32_t> takeCounters() {
+        std::pair<uint32_t, uint32_t> counters{issued, skipped};
+        issued = 0;
+        skipped = 0;
+        return counters;
+    }
+
+    void invalidate() {
+        GLStateCache fresh;
+        fresh.issued = issued;
+        fresh.skipped = skipped;
+        *this = std::move(fresh);
+    }
+
+    void useProgram(GLuint id) {
+        if (differs(program != id)) {
+            glUseProgram(id);
+            program = id;
+        }
+    }
+
+    void bindVertexArray(GLuint id) {
+        if (differs(vertexArray != id)) {
+            glBindVertexArray(id);
+            vertexArray = id;
+        }
+    }
+
+    // GL_ARRAY_BUFFER or GL_PIXEL_UNPACK_BUFFER
+    void bindBuffer(GLenum target, GLuint id) {
+        GLuint& bound = target == GL_PIXEL_UNPACK_BUFFER ? unpackBuffer : arrayBuffer;
+        if (differs(bound != id)) {
+            glBindBuffer(target, id);
+            bound = id;
+        }
+    }
+
+    void bindFramebuffer(GLuint id) {
+        if (differs(framebuffer != id)) {
+            glBindFramebuffer(GL_FRAMEBUFFER, id);
+            framebuffer = id;
+        }
+    }
+
+    void activeTexture(int unit) {
+        if (differs(activeUnit != unit)) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            activeUnit = unit;
+        }
+    }
+
+    // For sampling; the active unit is left wherever it ends up
+    void bindTexture(int unit, GLuint id) {
+        if (!differs(textures[unit] != id)) return;
+        activeTexture(unit);
+        glBindTexture(GL_TEXTURE_2D, id);
+        textures[unit] = id;
+    }
+
+    // For glTex* calls, which act on the active unit's texture
+    void bindTextureForEdit(GLuint id) {
+        activeTexture(0);
+        bindTexture(0, id);
+    }
+
+    // Deleting a bound object reverts its bindings to zero
+    void forgetTexture(GLuint id) {
+        for (GLuint& bound : textures) {
+            if (bound == id) bound = 0;
+        }
+    }
+
+    void forgetFramebuffer(GLuint id) {
+        if (framebuffer == id) framebuffer = 0;
+    }
+
+    void blendFunc(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha) {
+        bool same = blendKnown && blend[0] == srcRgb && blend[1] == dstRgb &&
+                    blend[2] == srcAlpha && blend[3] == dstAlpha;
+        if (differs(!same)) {
+            glBlendFuncSeparate(srcRgb, dstRgb, srcAlpha, dstAlpha);
+            blend[0] = srcRgb;
+            blend[1] = dstRgb;
+            blend[2] = srcAlpha;
+            blend[3] = dstAlpha;
+            blendKnown = true;
+        }
+    }
+
+    void setScissorTest(bool enabled) {
+        if (differs(scissorTest != static_cast<int>(enabled))) {
+            if (enabled) {
+                glEnable(GL_SCISSOR_TEST);
+            } else {
+                glDisable(GL_SCISSOR_TEST);
+            }
+            scissorTest = enabled;
+        }
+    }
+
+    void scissor(GLint x, GLint y, GLint width, GLint height) {
+        bool same = scissorKnown && scissorBox[0] == x && scissorBox[1] == y &&
+                    scissorBox[2] == width && scissorBox[3] == height;
+        if (differs(!same)) {
+            glScissor(x, y, width, height);
+            scissorBox[0] = x;
+            scissorBox[1] = y;
+            scissorBox[2] = width;
+            scissorBox[3] = height;
+            scissorKnown = true;
+        }
+    }
+
+    void setViewport(GLint x, GLint y, GLint width, GLint height) {
+        bool same = viewportKnown && viewport[0] == x && viewport[1] == y &&
+                    viewport[2] == width && viewport[3] == height;
+        if (differs(!same)) {
+            glViewport(x, y, width, height);
+            viewport[0] = x;
+            viewport[1] = y;
+            viewport[2] = width;
+            viewport[3] = height;
+            viewportKnown = true;
+        }
+    }
+
+    Uniform* findUniform(GLuint owner, GLint location) {
+        for (Uniform& uniform : uniforms) {
+            if (uniform.program == owner && uniform.location == location) return &uniform;
+        }
+        return nullptr;
+    }
+
+    // Without switching programs, so callers can skip the switch as well
+    bool isUniformChanged(GLuint owner, GLint location, const float* matrix) {
+        if (location < 0) return false;
+        const Uniform* uniform = findUniform(owner, location);
+        bool changed = !uniform || std::memcmp(uniform->value, matrix, sizeof(uniform->value)) != 0;
+        if (!changed) skipped++;
+        return changed;
+    }
+
+    // Uniforms of the program in use
+    void uniform1i(GLint location, int value) {
+        if (location < 0) return;
+        Uniform* uniform = findUniform(program, location);
+        if (!differs(!uniform || std::memcmp(uniform->value, &value, sizeof(value)) != 0)) return;
+        glUniform1i(location, value);
+        if (!uniform) uniform = &uniforms.emplace_back(Uniform{program, location, {}});
+        std::memcpy(uniform->value, &value, sizeof(value));
+    }
+
+    void uniformMatrix4(GLint location, const float* matrix) {
+        if (location < 0) return;
+        glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+        issued++;
+        Uniform* uniform = findUniform(program, location);
+        if (!uniform) uniform = &uniforms.emplace_back(Uniform{program, location, {}});
+        std::memcpy(uniform->value, matrix, sizeof(uniform->value));
+    }
+};
+
+const char* vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+uniform mat4 projection;
+
+void main() {
+    gl_Position = projection * vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+}
+)";
+
+const char* fragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoord;
+in vec4 Color;
+
+out vec4 FragColor;
+
+uniform sampler2D tex;
+uniform int useTexture;
+
+void main() {
+    if (useTexture != 0) {
+        FragColor = texture(tex, TexCoord) * Color;
+    } else {
+        FragColor = Color;
+    }
+}
+)";
+
+const char* instanceVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec4 aDest;
+layout (location = 1) in vec4 aTexRect;
+layout (location = 2) in vec4 aMaskRect;
+layout (location = 3) in vec4 aTint;
+layout (location = 4) in vec4 aHead;
+layout (location = 5) in vec4 aBody;
+layout (location = 6) in vec4 aLegs;
+layout (location = 7) in vec4 aFeet;
+
+out vec2 TexCoord;
+out vec2 MaskCoord;
+out vec4 Tint;
+flat out int HasMask;
+flat out vec3 Head;
+flat out vec3 Body;
+flat out vec3 Legs;
+flat out vec3 Feet;
+
+uniform mat4 projection;
+
+void main() {
+    // Triangle strip over the corners (0,0) (1,0) (0,1) (1,1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = projection * vec4(aDest.xy + corner * aDest.zw, 0.0, 1.0);
+    TexCoord = mix(aTexRect.xy, aTexRect.zw, corner);
+    MaskCoord = mix(aMaskRect.xy, aMaskRect.zw, corner);
+    HasMask = aMaskRect.z > aMaskRect.x ? 1 : 0;
+    Tint = aTint;
+    Head = aHead.rgb;
+    Body = aBody.rgb;
+    Legs = aLegs.rgb;
+    Feet = aFeet.rgb;
+}
+)";
+
+const char* instanceFragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoord;
+in vec2 MaskCoord;
+in vec4 Tint;
+flat in int HasMask;
+flat in vec3 Head;
+flat in vec3 Body;
+flat in vec3 Legs;
+flat in vec3 Feet;
+
+out vec4 FragColor;
+
+uniform sampler2D tex;
+uniform sampler2D maskTex;
+
+void main() {
+    vec4 color = texture(tex, TexCoord);
+    if (HasMask != 0) {
+        // Template colors: yellow head, red body, green legs, blue feet
+        vec4 mask = texture(maskTex, MaskCoord);
+        if (mask.a > 0.5) {
+            if (mask.r > 0.5 && mask.g > 0.5) color.rgb *= Head;
+            else if (mask.r > 0.5) color.rgb *= Body;
+            else if (mask.g > 0.5) color.rgb *= Legs;
+            else if (mask.b > 0.5) color.rgb *= Feet;
+        }
+    }
+    FragColor = color * Tint;
+}
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char log[512];
+        glGetShaderInfoLog(shader, 512, nullptr, log);
+        // Log error
+    }
+
+    return shader;
+}
+
+class GLBackend : public RenderBackend {
+public:
+    RenderBackendType getType() const override { return RenderBackendType::OpenGL; }
+
+    bool init(DeviceInfo& info) override;
+    void terminate() override;
+    void setWindow(void* window) override { m_window = static_cast<GLFWwindow*>(window); }
+    void makeCurrent(bool current) override { glfwMakeContextCurrent(current ? m_window : nullptr); }
+
+    TextureId createTexture(int width, int height, const uint8_t* pixels, bool hasAlpha, bool smooth) override;
+    void updateTexture(TextureId texture, const Rect& region, const uint8_t* pixels) override;
+    void deleteTextures(const TextureId* textures, size_t count) override;
+    FramebufferId createFramebuffer(TextureId color) override;
+    void deleteFramebuffers(const FramebufferId* framebuffers, size_t count) override;
+    TextureId getWhiteTexture() const override { return m_whiteTexture; }
+
+    void bindFramebuffer(FramebufferId framebuffer) override { m_state.bindFramebuffer(framebuffer); }
+    void setViewport(int x, int y, int width, int height) override { m_state.setViewport(x, y, width, height); }
+    void setProjection(const float* matrix) override;
+    void setBlendMode(int mode) override;
+    void setScissorTest(bool enabled) override { m_state.setScissorTest(enabled); }
+    // GL scissor boxes are bottom-up
+    void setScissor(const Rect& rect, int surfaceHeight) override {
+        m_state.scissor(rect.x, surfaceHeight - rect.y - rect.height, rect.width, rect.height);
+    }
+
+    void clear(const Color& color) override;
+    void drawLineLoop(const BatchVertex* vertices, size_t count) override;
+    void drawQuads(TextureId texture, const BatchVertex* vertices, size_t quads) override;
+    void drawSprites(TextureId texture, TextureId mask, const InstanceData* instances, size_t count) override;
+    void present() override;
+    void setSwapInterval(int interval) override { glfwSwapInterval(interval); }
+
+    void beginTimer(uint32_t frame, uint32_t slot) override;
+    void endTimer() override { glEndQuery(GL_TIME_ELAPSED); }
+    float readTimerMs(uint32_t frame, uint32_t slot) override;
+
+    std::pair<uint32_t, uint32_t> takeStateCounters() override { return m_state.takeCounters(); }
+
+private:
+    GLFWwindow* m_window{nullptr};
+    GLStateCache m_state;
+
+    GLuint m_shaderProgram{0};
+    GLint m_projectionLocation{-1};
+    GLint m_useTextureLocation{-1};
+    GLuint m_whiteTexture{0};   // Also bound instead of nothing: silences macOS warnings
+
+    // Outlines, a few vertices at a time
+    GLuint m_lineVao{0};
+    GLuint m_lineVbo{0};
+
+    // Quad batch, streamed into an orphaned buffer on every draw
+    GLuint m_batchVao{0};
+    GLuint m_batchVbo{0};
+    GLuint m_batchIbo{0};
+
+    // Instanced sprites; the quad corners come from gl_VertexID
+    GLuint m_instanceProgram{0};
+    GLint m_instanceProjectionLocation{-1};
+    GLuint m_instanceVao{0};
+    GLuint m_instanceVbo{0};
+
+    // Pixel unpack buffer for texture uploads, orphaned when full
+    GLuint m_uploadPbo{0};
+    size_t m_uploadOffset{0};
+
+    GLuint m_timerQueries[Graphics::GPU_TIMER_FRAMES][Graphics::GPU_TIMER_SLOTS]{};
+    int m_blendMode{-1};
+};
+
+bool GLBackend::init(DeviceInfo& info) {
+    // Initialize GLEW - requires valid OpenGL context (window must be created first)
+    glewExperimental = GL_TRUE;
+    GLenum glewErr = glewInit();
+    if (glewErr != GLEW_OK) {
+        // GLEW initialization failed
+        return false;
+    }
+    // Clear any GL errors from GLEW initialization
+    glGetError();
+
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    info.renderer = renderer ? renderer : "Unknown";
+    info.vendor = vendor ? vendor : "Unknown";
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &info.maxTextureSize);
+
+    // Create shader program
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+
+    m_shaderProgram = glCreateProgram();
+    glAttachShader(m_shaderProgram, vertexShader);
+    glAttachShader(m_shaderProgram, fragmentShader);
+    glLinkProgram(m_shaderProgram);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    m_projectionLocation = glGetUniformLocation(m_shaderProgram, "projection");
+    m_useTextureLocation = glGetUniformLocation(m_shaderProgram, "useTexture");
+
+    GLuint instanceVertexShader = compileShader(GL_VERTEX_SHADER, instanceVertexShaderSource);
+    GLuint instanceFragmentShader = compileShader(GL_FRAGMENT_SHADER, instanceFragmentShaderSource);
+
+    m_instanceProgram = glCreateProgram();
+    glAttachShader(m_instanceProgram, instanceVertexShader);
+    glAttachShader(m_instanceProgram, instanceFragmentShader);
+    glLinkProgram(m_instanceProgram);
+
+    glDeleteShader(instanceVertexShader);
+    glDeleteShader(instanceFragmentShader);
+
+    m_instanceProjectionLocation = glGetUniformLocation(m_instanceProgram, "projection");
+    glUseProgram(m_instanceProgram);
+    glUniform1i(glGetUniformLocation(m_instanceProgram, "tex"), 0);
+    glUniform1i(glGetUniformLocation(m_instanceProgram, "maskTex"), 1);
+
+    // Outlines and the quad batch share a vertex layout
+    auto setBatchLayout = [] {
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, x));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, u));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, r));
+        glEnableVertexAttribArray(2);
+    };
+
+    glGenVertexArrays(1, &m_lineVao);
+    glGenBuffers(1, &m_lineVbo);
+    glBindVertexArray(m_lineVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_lineVbo);
+    setBatchLayout();
+
+    // Quad batch: a static index buffer and a streamed vertex buffer
+    glGenVertexArrays(1, &m_batchVao);
+    glGenBuffers(1, &m_batchVbo);
+    glGenBuffers(1, &m_batchIbo);
+
+    glBindVertexArray(m_batchVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_batchVbo);
+    glBufferData(GL_ARRAY_BUFFER, Graphics::BATCH_MAX_QUADS * 4 * sizeof(BatchVertex), nullptr, GL_STREAM_DRAW);
+    setBatchLayout();
+
+    std::vector<uint16_t> indices(Graphics::BATCH_MAX_QUADS * 6);
+    for (size_t quad = 0; quad < Graphics::BATCH_MAX_QUADS; ++quad) {
+        uint16_t base = static_cast<uint16_t>(quad * 4);
+        uint16_t* out = &indices[quad * 6];
+        out[0] = base; out[1] = base + 1; out[2] = base + 2;
+        out[3] = base; out[4] = base + 2; out[5] = base + 3;
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_batchIbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+
+    // Instanced sprites: one streamed buffer, every attribute advancing per instance
+    glGenVertexArrays(1, &m_instanceVao);
+    glGenBuffers(1, &m_instanceVbo);
+
+    glBindVertexArray(m_instanceVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, Graphics::BATCH_MAX_INSTANCES * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, x));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, u0));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, mu0));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData), (void*)offsetof(InstanceData, tint));
+    for (GLuint channel = 0; channel < 4; ++channel) {
+        glVertexAttribPointer(4 + channel, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData),
+                              (void*)(offsetof(InstanceData, colors) + channel * 4));
+    }
+    for (GLuint attribute = 0; attribute < 8; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+
+    glGenBuffers(1, &m_uploadPbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uploadPbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, Graphics::UPLOAD_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    m_blendMode = BlendNormal;
+
+    // Create a 1x1 white dummy texture to bind when not using textures
+    // This silences macOS Metal-backed OpenGL warnings about unloadable textures
+    glGenTextures(1, &m_whiteTexture);
+    glBindTexture(GL_TEXTURE_2D, m_whiteTexture);
+    uint32_t whitePixel = 0xFFFFFFFF;
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &whitePixel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Setup above went straight to GL; the cache learns the state on use
+    m_state.invalidate();
+    return true;
+}
+
+void GLBackend::terminate() {
+    if (m_timerQueries[0][0]) glDeleteQueries(Graphics::GPU_TIMER_FRAMES * Graphics::GPU_TIMER_SLOTS, &m_timerQueries[0][0]);
+    if (m_uploadPbo) glDeleteBuffers(1, &m_uploadPbo);
+    if (m_batchIbo) glDeleteBuffers(1, &m_batchIbo);
+    if (m_batchVbo) glDeleteBuffers(1, &m_batchVbo);
+    if (m_batchVao) glDeleteVertexArrays(1, &m_batchVao);
+    if (m_instanceVbo) glDeleteBuffers(1, &m_instanceVbo);
+    if (m_instanceVao) glDeleteVertexArrays(1, &m_instanceVao);
+    if (m_instanceProgram) glDeleteProgram(m_instanceProgram);
+    if (m_lineVbo) glDeleteBuffers(1, &m_lineVbo);
+    if (m_lineVao) glDeleteVertexArrays(1, &m_lineVao);
+    if (m_whiteTexture) glDeleteTextures(1, &m_whiteTexture);
+    if (m_shaderProgram) glDeleteProgram(m_shaderProgram);
+    m_state.invalidate();
+}
+
+RenderBackend::TextureId GLBackend::createTexture(int width, int height, const uint8_t* pixels, bool hasAlpha, bool smooth) {
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    m_state.bindTextureForEdit(textureId);
+
+    GLint filter = smooth ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+
+    GLenum format = hasAlpha ? GL_RGBA : GL_RGB;
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    return textureId;
+}
+
+void GLBackend::updateTexture(TextureId texture, const Rect& region, const uint8_t* pixels) {
+    size_t bytes = static_cast<size_t>(region.width) * region.height * 4;
+    m_state.bindTextureForEdit(texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (!m_uploadPbo || bytes > Graphics::UPLOAD_BUFFER_SIZE) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, region.width, region.height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        return;
+    }
+
+    // Append to the staging buffer, so the copy into the texture runs on
+    // the GPU; a full buffer is orphaned rather than waiting for the GPU to
+    // finish reading it
+    m_state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uploadPbo);
+    if (m_uploadOffset + bytes > Graphics::UPLOAD_BUFFER_SIZE) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, Graphics::UPLOAD_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+        m_uploadOffset = 0;
+    }
+    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, m_uploadOffset, bytes, pixels);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, region.width, region.height,
+                    GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(m_uploadOffset));
+    m_uploadOffset += (bytes + 15) & ~size_t(15);
+    // Left bound, it would turn the pixel pointers of later uploads into offsets
+    m_state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void GLBackend::deleteTextures(const TextureId* textures, size_t count) {
+    if (count == 0) return;
+    glDeleteTextures(static_cast<GLsizei>(count), textures);
+    for (size_t i = 0; i < count; ++i) {
+        m_state.forgetTexture(textures[i]);
+    }
+}
+
+RenderBackend::FramebufferId GLBackend::createFramebuffer(TextureId color) {
+    // Put back whatever was drawing, screen or target
+    GLuint previous = m_state.framebuffer == GLStateCache::UNKNOWN ? 0 : m_state.framebuffer;
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    m_state.bindFramebuffer(framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    m_state.bindFramebuffer(previous);
+
+    if (!complete) {
+        glDeleteFramebuffers(1, &framebuffer);
+        return 0;
+    }
+    return framebuffer;
+}
+
+void GLBackend::deleteFramebuffers(const FramebufferId* framebuffers, size_t count) {
+    if (count == 0) return;
+    glDeleteFramebuffers(static_cast<GLsizei>(count), framebuffers);
+    for (size_t i = 0; i < count; ++i) {
+        m_state.forgetFramebuffer(framebuffers[i]);
+    }
+}
+
+void GLBackend::setProjection(const float* matrix) {
+    // The same projection as last time, the usual case from frame to
+    // frame, costs neither a program switch nor an upload
+    if (m_state.isUniformChanged(m_shaderProgram, m_projectionLocation, matrix)) {
+        m_state.useProgram(m_shaderProgram);
+        m_state.uniformMatrix4(m_projectionLocation, matrix);
+    }
+    if (m_instanceProgram && m_state.isUniformChanged(m_instanceProgram, m_instanceProjectionLocation, matrix)) {
+        m_state.useProgram(m_instanceProgram);
+        m_state.uniformMatrix4(m_instanceProjectionLocation, matrix);
+    }
+}
+
+void GLBackend::setBlendMode(int mode) {
+    if (mode == m_blendMode) return;
+    m_blendMode = mode;
+
+    switch (mode) {
+        case BlendAdditive:
+            m_state.blendFunc(GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE);
+            break;
+        case BlendMultiply:
+            m_state.blendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA, GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case BlendPremultiplied:
+            m_state.blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        default:
+            m_state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+    }
+}
+
+void GLBackend::clear(const Color& color) {
+    glClearColor(color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void GLBackend::drawLineLoop(const BatchVertex* vertices, size_t count) {
+    m_state.useProgram(m_shaderProgram);
+    m_state.uniform1i(m_useTextureLocation, 0);
+
+    m_state.bindVertexArray(m_lineVao);
+    m_state.bindBuffer(GL_ARRAY_BUFFER, m_lineVbo);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(BatchVertex), vertices, GL_DYNAMIC_DRAW);
+
+    glDrawArrays(GL_LINE_LOOP, 0, static_cast<GLsizei>(count));
+}
+
+void GLBackend::drawQuads(TextureId texture, const BatchVertex* vertices, size_t quads) {
+    m_state.useProgram(m_shaderProgram);
+    m_state.uniform1i(m_useTextureLocation, 1);
+    m_state.bindTexture(0, texture);
+
+    // Orphan the buffer so the driver never waits on the last draw
+    m_state.bindVertexArray(m_batchVao);
+    m_state.bindBuffer(GL_ARRAY_BUFFER, m_batchVbo);
+    glBufferData(GL_ARRAY_BUFFER, Graphics::BATCH_MAX_QUADS * 4 * sizeof(BatchVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, quads * 4 * sizeof(BatchVertex), vertices);
+
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(quads * 6), GL_UNSIGNED_SHORT, nullptr);
+}
+
+void GLBackend::drawSprites(TextureId texture, TextureId mask, const InstanceData* instances, size_t count) {
+    m_state.useProgram(m_instanceProgram);
+    m_state.bindTexture(1, mask ? mask : m_whiteTexture);
+    m_state.bindTexture(0, texture);
+
+    m_state.bindVertexArray(m_instanceVao);
+    m_state.bindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, Graphics::BATCH_MAX_INSTANCES * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceData), instances);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count));
+}
+
+void GLBackend::present() {
+    if (m_window) {
+        glfwSwapBuffers(m_window);
+    }
+}
+
+void GLBackend::beginTimer(uint32_t frame, uint32_t slot) {
+    if (!m_timerQueries[0][0]) {
+        glGenQueries(Graphics::GPU_TIMER_FRAMES * Graphics::GPU_TIMER_SLOTS, &m_timerQueries[0][0]);
+    }
+    glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[frame][slot]);
+}
+
+float GLBackend::readTimerMs(uint32_t frame, uint32_t slot) {
+    if (!m_timerQueries[0][0]) return -1.0f;
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(m_timerQueries[frame][slot], GL_QUERY_RESULT, &nanoseconds);
+    return static_cast<float>(nanoseconds / 1.0e6);
+}
+
+} // anonymous namespace
+
+std::unique_ptr<RenderBackend> createGLBackend() {
+    return std::make_unique<GLBackend>();
+}
+
+} // namespace framework
+} // namespace shadow
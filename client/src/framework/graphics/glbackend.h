@@ -0,0 +1,21 @@
+/**
+ * Shadow OT Client - OpenGL Backend
+ *
+ * RenderBackend over OpenGL 3.3 core through GLEW and a GLFW context.
+ * Binds, toggles and uniform uploads go through a cache of the last state
+ * set, since per-call driver overhead is high on some platforms, macOS
+ * above all.
+ */
+
+#pragma once
+
+#include "renderbackend.h"
+#include <memory>
+
+namespace shadow {
+namespace framework {
+
+std::unique_ptr<RenderBackend> createGLBackend();
+
+} // namespace framework
+} // namespace shadow
@@ -3,15 +3,24 @@
  */
 
 #include "graphics.h"
+#include "font.h"
+#include "image.h"
+#include "renderbackend.h"
+#include <framework/core/profiler.h>
 #include <framework/core/resourcemanager.h>
 
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
-
+#include <algorithm>
 #include <vector>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstddef>
 #include <cstring>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace shadow {
 namespace framework {
@@ -42,31 +51,22 @@ Color Color::fromHex(const std::string& hex) {
     return Color::white();
 }
 
-class GLTexture : public Texture {
+// Shared ownership lets a recorded snapshot keep what it draws alive
+// until the render thread has drawn it
+class GpuTexture : public Texture, public std::enable_shared_from_this<GpuTexture> {
 public:
-    GLTexture(uint32_t id, int width, int height, bool alpha)
+    GpuTexture(uint32_t id, int width, int height, bool alpha)
         : m_id(id), m_width(width), m_height(height), m_hasAlpha(alpha) {}
 
-    ~GLTexture() override {
-        if (m_id) {
-            glDeleteTextures(1, &m_id);
-        }
-    }
+    ~GpuTexture() override;
 
     uint32_t getId() const override { return m_id; }
+    // Render thread, when it creates a texture queued from another thread
+    void setId(uint32_t id) { m_id = id; }
     int getWidth() const override { return m_width; }
     int getHeight() const override { return m_height; }
     bool hasAlpha() const override { return m_hasAlpha; }
 
-    void bind(int unit) const override {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, m_id);
-    }
-
-    void unbind() const override {
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-
 private:
     uint32_t m_id;
     int m_width;
@@ -74,187 +74,345 @@ private:
     bool m_hasAlpha;
 };
 
-struct Graphics::Impl {
-    GLuint vao{0};
-    GLuint vbo{0};
-    GLuint shaderProgram{0};
-    GLuint dummyTexture{0};  // 1x1 white texture to avoid macOS warnings
+class GpuRenderTarget : public RenderTarget, public std::enable_shared_from_this<GpuRenderTarget> {
+public:
+    GpuRenderTarget(uint32_t framebuffer, std::shared_ptr<Texture> texture)
+        : m_framebuffer(framebuffer), m_texture(std::move(texture)) {}
 
-    std::vector<Rect> clipStack;
-    Color currentColor{255, 255, 255, 255};
-    float opacity{1.0f};
+    ~GpuRenderTarget() override;
 
-    int viewportWidth{0};
-    int viewportHeight{0};
+    const Texture* getTexture() const override { return m_texture.get(); }
+    int getWidth() const override { return m_texture->getWidth(); }
+    int getHeight() const override { return m_texture->getHeight(); }
+    uint32_t getFramebuffer() const { return m_framebuffer; }
+    void setFramebuffer(uint32_t framebuffer) { m_framebuffer = framebuffer; }
 
-    GLFWwindow* window{nullptr};
+private:
+    uint32_t m_framebuffer;
+    std::shared_ptr<Texture> m_texture;
+};
 
-    void setWindow(GLFWwindow* win) { window = win; }
+enum class DrawOp : uint8_t {
+    Clear,
+    Viewport,
+    Ortho,
+    Rect,
+    FilledRect,
+    Texture,
+    RenderTarget,
+    Sprite,
+    PushClip,
+    PopClip,
+    Blend,
+    Opacity,
+    BeginTarget,
+    EndTarget,
+    BeginGpuTimer,
+    EndGpuTimer,
+    Flush,
+    SwapInterval
 };
 
-Graphics& Graphics::instance() {
-    static Graphics instance;
-    return instance;
-}
+// One draw call as made on the update thread, replayed as the same call
+// on the render thread
+struct DrawCommand {
+    DrawOp op;
+    int value{0};                   // Blend mode, timer slot, swap interval or sprite index
+    float scalar{0.0f};             // Opacity
+    Rect dest;                      // Also viewport, ortho size and target origin
+    Rect src;
+    Color color;
+    const Texture* texture{nullptr};
+    const Texture* mask{nullptr};
+    const RenderTarget* target{nullptr};
+};
 
-static const char* vertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec2 aTexCoord;
-layout (location = 2) in vec4 aColor;
+struct Graphics::Snapshot {
+    std::vector<DrawCommand> commands;
+    std::vector<SpriteInstance> sprites;
+    // Everything drawn, held until the snapshot is replayed or dropped.
+    // Draws mostly repeat the previous texture, so only changes are kept.
+    std::vector<std::shared_ptr<const void>> references;
+    const void* lastReference{nullptr};
+
+    void retain(const Texture* texture) {
+        if (!texture || texture == lastReference) return;
+        lastReference = texture;
+        references.push_back(static_cast<const GpuTexture*>(texture)->shared_from_this());
+    }
+    void retain(const RenderTarget* target) {
+        if (!target || target == lastReference) return;
+        lastReference = target;
+        references.push_back(static_cast<const GpuRenderTarget*>(target)->shared_from_this());
+    }
 
-out vec2 TexCoord;
-out vec4 Color;
+    void clear() {
+        commands.clear();
+        sprites.clear();
+        references.clear();
+        lastReference = nullptr;
+    }
+};
 
-uniform mat4 projection;
+struct Graphics::Impl {
+    std::unique_ptr<RenderBackend> backend;
+    uint32_t whiteTexture{0};
+
+    // Quad batch, handed to the backend on every flush
+    std::vector<BatchVertex> batchVertices;
+    uint32_t batchTexture{0};
+    int blendMode{BlendNormal};
+
+    // Instanced sprites
+    std::vector<InstanceData> instances;
+    uint32_t instanceTexture{0};
+    uint32_t instanceMask{0};
+
+    // Render target state saved by beginRenderTarget
+    GpuRenderTarget* renderTarget{nullptr};
+    int savedViewport[4]{0, 0, 0, 0};
+    int viewport[4]{0, 0, 0, 0};    // Last setViewport(), never read back
+    int originX{0};             // Projection origin inside a render target
+    int originY{0};
+    size_t targetClipBase{0};   // Clip rects below this belong to the screen
+    int savedOrthoWidth{0};
+    int savedOrthoHeight{0};
+
+    // Timers per frame in flight; results of the frame a set was issued
+    // in are collected when the set comes around again
+    bool gpuIssued[GPU_TIMER_FRAMES][GPU_TIMER_SLOTS]{};
+    float gpuResults[GPU_TIMER_SLOTS]{};
+    uint32_t gpuFrame{0};
+    int gpuActiveSlot{-1};
 
-void main() {
-    gl_Position = projection * vec4(aPos, 0.0, 1.0);
-    TexCoord = aTexCoord;
-    Color = aColor;
-}
-)";
+    std::vector<Rect> clipStack;
+    Color currentColor{255, 255, 255, 255};
+    float opacity{1.0f};
 
-static const char* fragmentShaderSource = R"(
-#version 330 core
-in vec2 TexCoord;
-in vec4 Color;
+    int viewportWidth{0};
+    int viewportHeight{0};
 
-out vec4 FragColor;
+    void* window{nullptr};
+
+    // Render thread. The handoff, the last frame's counters and the GPU
+    // timer results are all guarded by frameMutex.
+    std::thread renderThread;
+    std::thread::id renderThreadId;
+    std::atomic<bool> threaded{false};
+    mutable std::mutex frameMutex;
+    std::condition_variable frameReady;
+    bool stopping{false};
+    std::unique_ptr<Snapshot> recording;    // Update thread only
+    std::unique_ptr<Snapshot> pending;      // Newest handed over, not yet picked up
+    std::vector<std::unique_ptr<Snapshot>> freeSnapshots;
+    RenderThreadStats renderStats;
+
+    // Creation, uploads and deletes from threads without the context
+    std::mutex resourceMutex;
+    std::vector<std::function<void()>> resourceQueue;
+    std::vector<RenderBackend::TextureId> deadTextures;
+    std::vector<RenderBackend::FramebufferId> deadFramebuffers;
+
+    // True on any thread but the render thread while it runs
+    bool isRecording() const {
+        return threaded.load(std::memory_order_acquire) && std::this_thread::get_id() != renderThreadId;
+    }
 
-uniform sampler2D tex;
-uniform int useTexture;
+    DrawCommand& record(DrawOp op) {
+        DrawCommand& command = recording->commands.emplace_back();
+        command.op = op;
+        return command;
+    }
 
-void main() {
-    if (useTexture != 0) {
-        FragColor = texture(tex, TexCoord) * Color;
-    } else {
-        FragColor = Color;
+    void queueResource(std::function<void()> work) {
+        std::lock_guard<std::mutex> lock(resourceMutex);
+        resourceQueue.push_back(std::move(work));
+    }
+
+    void applyScissor(const Rect& rect) {
+        backend->setScissor(Rect(rect.x - originX, rect.y - originY, rect.width, rect.height), viewportHeight);
+    }
+};
+
+GpuTexture::~GpuTexture() {
+    if (m_id) {
+        Graphics& graphics = Graphics::instance();
+        if (graphics.m_impl && graphics.m_impl->isRecording()) {
+            std::lock_guard<std::mutex> lock(graphics.m_impl->resourceMutex);
+            graphics.m_impl->deadTextures.push_back(m_id);
+            return;
+        }
+
+        // Quads queued with this texture must be drawn before it goes away
+        if (graphics.m_impl && (graphics.m_impl->batchTexture == m_id || graphics.m_impl->instanceTexture == m_id ||
+                                graphics.m_impl->instanceMask == m_id)) {
+            graphics.flush();
+        }
+        if (graphics.m_impl) graphics.m_impl->backend->deleteTextures(&m_id, 1);
     }
 }
-)";
 
-static GLuint compileShader(GLenum type, const char* source) {
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
+GpuRenderTarget::~GpuRenderTarget() {
+    if (!m_framebuffer) return;
 
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetShaderInfoLog(shader, 512, nullptr, log);
-        // Log error
+    Graphics& graphics = Graphics::instance();
+    if (graphics.m_impl && graphics.m_impl->isRecording()) {
+        std::lock_guard<std::mutex> lock(graphics.m_impl->resourceMutex);
+        graphics.m_impl->deadFramebuffers.push_back(m_framebuffer);
+        return;
     }
+    if (graphics.m_impl) graphics.m_impl->backend->deleteFramebuffers(&m_framebuffer, 1);
+}
 
-    return shader;
+Graphics& Graphics::instance() {
+    static Graphics instance;
+    return instance;
 }
 
-bool Graphics::init() {
+bool Graphics::init(RenderBackendType type) {
     m_impl = std::make_unique<Impl>();
+    std::fill(std::begin(m_impl->gpuResults), std::end(m_impl->gpuResults), -1.0f);
+
+    // Exactly the backend asked for: one not built in fails rather than
+    // quietly running another
+    m_impl->backend = createRenderBackend(type);
 
-    // Initialize GLEW - requires valid OpenGL context (window must be created first)
-    glewExperimental = GL_TRUE;
-    GLenum glewErr = glewInit();
-    if (glewErr != GLEW_OK) {
-        // GLEW initialization failed
+    RenderBackend::DeviceInfo info;
+    if (!m_impl->backend || !m_impl->backend->init(info)) {
+        m_impl.reset();
         return false;
     }
-    // Clear any GL errors from GLEW initialization
-    glGetError();
-
-    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
-    const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
-    m_renderer = renderer ? renderer : "Unknown";
-    m_vendor = vendor ? vendor : "Unknown";
-    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_maxTextureSize);
-
-    // Create shader program
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-    m_impl->shaderProgram = glCreateProgram();
-    glAttachShader(m_impl->shaderProgram, vertexShader);
-    glAttachShader(m_impl->shaderProgram, fragmentShader);
-    glLinkProgram(m_impl->shaderProgram);
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // Create VAO/VBO
-    glGenVertexArrays(1, &m_impl->vao);
-    glGenBuffers(1, &m_impl->vbo);
-
-    glBindVertexArray(m_impl->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_impl->vbo);
-
-    // Position
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // TexCoord
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // Color
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(4 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // Create a 1x1 white dummy texture to bind when not using textures
-    // This silences macOS Metal-backed OpenGL warnings about unloadable textures
-    glGenTextures(1, &m_impl->dummyTexture);
-    glBindTexture(GL_TEXTURE_2D, m_impl->dummyTexture);
-    uint32_t whitePixel = 0xFFFFFFFF;
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &whitePixel);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
+    m_backendType = m_impl->backend->getType();
+    m_renderer = info.renderer;
+    m_vendor = info.vendor;
+    m_maxTextureSize = info.maxTextureSize;
+    m_impl->whiteTexture = m_impl->backend->getWhiteTexture();
+
+    m_impl->batchVertices.reserve(BATCH_MAX_QUADS * 4);
+    m_impl->instances.reserve(BATCH_MAX_INSTANCES);
     return true;
 }
 
 void Graphics::terminate() {
+    stopRenderThread();
+
     if (m_impl) {
-        if (m_impl->vbo) glDeleteBuffers(1, &m_impl->vbo);
-        if (m_impl->vao) glDeleteVertexArrays(1, &m_impl->vao);
-        if (m_impl->shaderProgram) glDeleteProgram(m_impl->shaderProgram);
+        m_impl->backend->terminate();
         m_impl.reset();
     }
 }
 
 void Graphics::beginFrame() {
-    // Nothing specific needed
+    // Recording: the render thread begins the frame when it replays it
+    if (m_impl && m_impl->isRecording()) return;
+
+    m_frameStats = FrameStats{};
+    if (!m_impl) return;
+    m_impl->backend->takeStateCounters();
+
+    // Collect the timers of the frame that last used this query set
+    m_impl->gpuFrame = (m_impl->gpuFrame + 1) % GPU_TIMER_FRAMES;
+    uint32_t set = m_impl->gpuFrame;
+    float results[GPU_TIMER_SLOTS];
+    for (uint32_t slot = 0; slot < GPU_TIMER_SLOTS; ++slot) {
+        results[slot] = -1.0f;
+        if (!m_impl->gpuIssued[set][slot]) continue;
+
+        results[slot] = m_impl->backend->readTimerMs(set, slot);
+        m_impl->gpuIssued[set][slot] = false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_impl->frameMutex);
+    std::copy(std::begin(results), std::end(results), m_impl->gpuResults);
 }
 
 void Graphics::endFrame() {
-    // Nothing specific needed
+    if (!m_impl) return;
+    if (m_impl->isRecording()) return;
+
+    flush();
+    auto [issued, skipped] = m_impl->backend->takeStateCounters();
+    m_frameStats.stateChanges = issued;
+    m_frameStats.stateChangesSkipped = skipped;
+    std::lock_guard<std::mutex> lock(m_impl->frameMutex);
+    m_lastFrameStats = m_frameStats;
+}
+
+Graphics::FrameStats Graphics::getFrameStats() const {
+    if (!m_impl) return m_lastFrameStats;
+    std::lock_guard<std::mutex> lock(m_impl->frameMutex);
+    return m_lastFrameStats;
 }
 
 void Graphics::render() {
+    if (m_impl && m_impl->isRecording()) {
+        // Hand the snapshot over. One still waiting is stale by now and is
+        // dropped; its snapshot becomes the one recorded next.
+        RenderThreadStats stats;
+        {
+            std::lock_guard<std::mutex> lock(m_impl->frameMutex);
+            if (m_impl->pending) {
+                std::swap(m_impl->pending, m_impl->recording);
+                m_impl->renderStats.framesDropped++;
+            } else {
+                m_impl->pending = std::move(m_impl->recording);
+                if (!m_impl->freeSnapshots.empty()) {
+                    m_impl->recording = std::move(m_impl->freeSnapshots.back());
+                    m_impl->freeSnapshots.pop_back();
+                } else {
+                    m_impl->recording = std::make_unique<Snapshot>();
+                }
+            }
+            stats = m_impl->renderStats;
+        }
+        m_impl->frameReady.notify_one();
+        // Releases what the dropped snapshot held, off the lock
+        m_impl->recording->clear();
+
+        g_profiler.setGauge(Profiler::GaugeRenderMs, stats.renderMs);
+        g_profiler.setGauge(Profiler::GaugeFramesDropped, static_cast<float>(stats.framesDropped));
+        return;
+    }
+
+    flush();
+
     // Swap buffers to present the frame
     if (m_impl && m_impl->window) {
-        glfwSwapBuffers(m_impl->window);
+        ProfileScope scope(Profiler::StageSwap);
+        m_impl->backend->present();
     }
 }
 
 void Graphics::setViewport(int x, int y, int width, int height) {
-    glViewport(x, y, width, height);
-    if (m_impl) {
-        m_impl->viewportWidth = width;
-        m_impl->viewportHeight = height;
+    if (m_impl && m_impl->isRecording()) {
+        m_impl->record(DrawOp::Viewport).dest = Rect(x, y, width, height);
+        return;
     }
+
+    if (!m_impl) return;
+    m_impl->backend->setViewport(x, y, width, height);
+    m_impl->viewport[0] = x;
+    m_impl->viewport[1] = y;
+    m_impl->viewport[2] = width;
+    m_impl->viewport[3] = height;
+    m_impl->viewportWidth = width;
+    m_impl->viewportHeight = height;
 }
 
 void Graphics::setOrtho(int width, int height) {
-    if (!m_impl || !m_impl->shaderProgram) return;
+    if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::Ortho).dest = Rect(0, 0, width, height);
+        return;
+    }
 
-    glUseProgram(m_impl->shaderProgram);
+    flush();
 
     // Create orthographic projection matrix
-    float left = 0.0f;
-    float right = static_cast<float>(width);
-    float bottom = static_cast<float>(height);
-    float top = 0.0f;
+    float left = static_cast<float>(m_impl->originX);
+    float right = left + static_cast<float>(width);
+    float top = static_cast<float>(m_impl->originY);
+    float bottom = top + static_cast<float>(height);
     float nearPlane = -1.0f;
     float farPlane = 1.0f;
 
@@ -265,8 +423,7 @@ void Graphics::setOrtho(int width, int height) {
         -(right + left) / (right - left), -(top + bottom) / (top - bottom), -(farPlane + nearPlane) / (farPlane - nearPlane), 1.0f
     };
 
-    GLint loc = glGetUniformLocation(m_impl->shaderProgram, "projection");
-    glUniformMatrix4fv(loc, 1, GL_FALSE, projection);
+    m_impl->backend->setProjection(projection);
 
     m_impl->viewportWidth = width;
     m_impl->viewportHeight = height;
@@ -274,45 +431,42 @@ void Graphics::setOrtho(int width, int height) {
 
 void Graphics::drawRect(const Rect& rect, const Color& color) {
     if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        DrawCommand& command = m_impl->record(DrawOp::Rect);
+        command.dest = rect;
+        command.color = color;
+        return;
+    }
 
-    float vertices[] = {
-        (float)rect.x, (float)rect.y, 0.0f, 0.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-        (float)(rect.x + rect.width), (float)rect.y, 0.0f, 0.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-        (float)(rect.x + rect.width), (float)(rect.y + rect.height), 0.0f, 0.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-        (float)rect.x, (float)(rect.y + rect.height), 0.0f, 0.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
+    // Outlines are line loops and cannot join the quad batch
+    flush();
+
+    float x0 = static_cast<float>(rect.x);
+    float y0 = static_cast<float>(rect.y);
+    float x1 = static_cast<float>(rect.x + rect.width);
+    float y1 = static_cast<float>(rect.y + rect.height);
+    uint8_t alpha = static_cast<uint8_t>(color.a * m_impl->opacity);
+    BatchVertex vertices[] = {
+        {x0, y0, 0.0f, 0.0f, color.r, color.g, color.b, alpha},
+        {x1, y0, 0.0f, 0.0f, color.r, color.g, color.b, alpha},
+        {x1, y1, 0.0f, 0.0f, color.r, color.g, color.b, alpha},
+        {x0, y1, 0.0f, 0.0f, color.r, color.g, color.b, alpha},
     };
-
-    glUseProgram(m_impl->shaderProgram);
-    glUniform1i(glGetUniformLocation(m_impl->shaderProgram, "useTexture"), 0);
-
-    glBindVertexArray(m_impl->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_impl->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-
-    glDrawArrays(GL_LINE_LOOP, 0, 4);
+    m_impl->backend->drawLineLoop(vertices, 4);
+    m_frameStats.drawCalls++;
 }
 
 void Graphics::drawFilledRect(const Rect& rect, const Color& color) {
     if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        DrawCommand& command = m_impl->record(DrawOp::FilledRect);
+        command.dest = rect;
+        command.color = color;
+        return;
+    }
 
-    float vertices[] = {
-        (float)rect.x, (float)rect.y, 0.0f, 0.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-        (float)(rect.x + rect.width), (float)rect.y, 1.0f, 0.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-        (float)(rect.x + rect.width), (float)(rect.y + rect.height), 1.0f, 1.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-
-        (float)rect.x, (float)rect.y, 0.0f, 0.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-        (float)(rect.x + rect.width), (float)(rect.y + rect.height), 1.0f, 1.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-        (float)rect.x, (float)(rect.y + rect.height), 0.0f, 1.0f, color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f * m_impl->opacity,
-    };
-
-    glUseProgram(m_impl->shaderProgram);
-    glUniform1i(glGetUniformLocation(m_impl->shaderProgram, "useTexture"), 0);
-
-    glBindVertexArray(m_impl->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_impl->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    // The white texture lets fills share batches with sprites
+    queueQuad(m_impl->whiteTexture, rect, 0.0f, 0.0f, 1.0f, 1.0f, color);
 }
 
 void Graphics::drawTexture(const Texture* texture, int x, int y) {
@@ -322,93 +476,265 @@ void Graphics::drawTexture(const Texture* texture, int x, int y) {
 
 void Graphics::drawTexture(const Texture* texture, const Rect& dest) {
     if (!texture || !m_impl) return;
+    if (m_impl->isRecording()) {
+        drawTextureColored(texture, dest, Color::white());
+        return;
+    }
+    queueQuad(texture->getId(), dest, 0.0f, 0.0f, 1.0f, 1.0f, Color::white());
+}
 
-    float vertices[] = {
-        (float)dest.x, (float)dest.y, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)(dest.x + dest.width), (float)dest.y, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)(dest.x + dest.width), (float)(dest.y + dest.height), 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, m_impl->opacity,
+void Graphics::drawTexture(const Texture* texture, const Rect& src, const Rect& dest) {
+    if (!texture || !m_impl) return;
+    if (m_impl->isRecording()) {
+        drawTextureColored(texture, src, dest, Color::white());
+        return;
+    }
 
-        (float)dest.x, (float)dest.y, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)(dest.x + dest.width), (float)(dest.y + dest.height), 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)dest.x, (float)(dest.y + dest.height), 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-    };
+    float tw = static_cast<float>(texture->getWidth());
+    float th = static_cast<float>(texture->getHeight());
 
-    glUseProgram(m_impl->shaderProgram);
-    glUniform1i(glGetUniformLocation(m_impl->shaderProgram, "useTexture"), 1);
+    float u0 = src.x / tw;
+    float v0 = src.y / th;
+    float u1 = (src.x + src.width) / tw;
+    float v1 = (src.y + src.height) / th;
 
-    texture->bind(0);
+    queueQuad(texture->getId(), dest, u0, v0, u1, v1, Color::white());
+}
 
-    glBindVertexArray(m_impl->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_impl->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+void Graphics::drawTextureColored(const Texture* texture, const Rect& dest, const Color& color) {
+    if (!texture || !m_impl) return;
+    if (m_impl->isRecording()) {
+        drawTextureColored(texture, Rect(0, 0, texture->getWidth(), texture->getHeight()), dest, color);
+        return;
+    }
+    queueQuad(texture->getId(), dest, 0.0f, 0.0f, 1.0f, 1.0f, color);
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void Graphics::drawTextureColored(const Texture* texture, const Rect& src, const Rect& dest, const Color& color) {
+    if (!texture || !m_impl) return;
+    if (m_impl->isRecording()) {
+        DrawCommand& command = m_impl->record(DrawOp::Texture);
+        command.texture = texture;
+        command.src = src;
+        command.dest = dest;
+        command.color = color;
+        m_impl->recording->retain(texture);
+        return;
+    }
+
+    float tw = static_cast<float>(texture->getWidth());
+    float th = static_cast<float>(texture->getHeight());
+    queueQuad(texture->getId(), dest, src.x / tw, src.y / th,
+              (src.x + src.width) / tw, (src.y + src.height) / th, color);
 }
 
-void Graphics::drawTexture(const Texture* texture, const Rect& src, const Rect& dest) {
+void Graphics::drawRenderTarget(const RenderTarget* target, const Rect& dest) {
+    if (!target || !m_impl) return;
+    if (m_impl->isRecording()) {
+        drawRenderTarget(target, Rect(0, 0, target->getWidth(), target->getHeight()), dest);
+        return;
+    }
+    // Rendered bottom-up: sample with v flipped
+    queueQuad(target->getTexture()->getId(), dest, 0.0f, 1.0f, 1.0f, 0.0f, Color::white());
+}
+
+void Graphics::drawRenderTarget(const RenderTarget* target, const Rect& src, const Rect& dest) {
+    if (!target || !m_impl) return;
+    if (m_impl->isRecording()) {
+        DrawCommand& command = m_impl->record(DrawOp::RenderTarget);
+        command.target = target;
+        command.src = src;
+        command.dest = dest;
+        m_impl->recording->retain(target);
+        return;
+    }
+
+    // src is top-down like the draws that filled the target
+    float tw = static_cast<float>(target->getWidth());
+    float th = static_cast<float>(target->getHeight());
+    queueQuad(target->getTexture()->getId(), dest,
+              src.x / tw, 1.0f - src.y / th,
+              (src.x + src.width) / tw, 1.0f - (src.y + src.height) / th, Color::white());
+}
+
+void Graphics::queueQuad(uint32_t texture, const Rect& dest, float u0, float v0, float u1, float v1, const Color& color) {
+    // Quads and instances never share a draw call; keep them in order
+    if (!m_impl->instances.empty()) {
+        flushInstances();
+    }
+
+    auto& vertices = m_impl->batchVertices;
+    if (texture != m_impl->batchTexture || vertices.size() >= BATCH_MAX_QUADS * 4) {
+        flush();
+        m_impl->batchTexture = texture;
+    }
+
+    float x0 = static_cast<float>(dest.x);
+    float y0 = static_cast<float>(dest.y);
+    float x1 = static_cast<float>(dest.x + dest.width);
+    float y1 = static_cast<float>(dest.y + dest.height);
+    uint8_t alpha = static_cast<uint8_t>(color.a * m_impl->opacity);
+
+    vertices.push_back({x0, y0, u0, v0, color.r, color.g, color.b, alpha});
+    vertices.push_back({x1, y0, u1, v0, color.r, color.g, color.b, alpha});
+    vertices.push_back({x1, y1, u1, v1, color.r, color.g, color.b, alpha});
+    vertices.push_back({x0, y1, u0, v1, color.r, color.g, color.b, alpha});
+    m_frameStats.quads++;
+}
+
+void Graphics::drawSpriteInstance(const Texture* texture, const SpriteInstance& instance, const Texture* mask) {
     if (!texture || !m_impl) return;
+    if (m_impl->isRecording()) {
+        Snapshot& snapshot = *m_impl->recording;
+        DrawCommand& command = m_impl->record(DrawOp::Sprite);
+        command.texture = texture;
+        command.mask = mask;
+        command.value = static_cast<int>(snapshot.sprites.size());
+        snapshot.sprites.push_back(instance);
+        snapshot.retain(texture);
+        snapshot.retain(mask);
+        return;
+    }
+
+    uint32_t maskId = mask ? mask->getId() : m_impl->whiteTexture;
+    if (!m_impl->batchVertices.empty()) {
+        flush();
+    }
+    if (texture->getId() != m_impl->instanceTexture || maskId != m_impl->instanceMask ||
+        m_impl->instances.size() >= BATCH_MAX_INSTANCES) {
+        flushInstances();
+        m_impl->instanceTexture = texture->getId();
+        m_impl->instanceMask = maskId;
+    }
+
+    InstanceData data{};
+    data.x = static_cast<float>(instance.dest.x);
+    data.y = static_cast<float>(instance.dest.y);
+    data.width = static_cast<float>(instance.dest.width);
+    data.height = static_cast<float>(instance.dest.height);
 
     float tw = static_cast<float>(texture->getWidth());
     float th = static_cast<float>(texture->getHeight());
+    data.u0 = instance.src.x / tw;
+    data.v0 = instance.src.y / th;
+    data.u1 = (instance.src.x + instance.src.width) / tw;
+    data.v1 = (instance.src.y + instance.src.height) / th;
+
+    if (mask && instance.maskSrc.width > 0 && instance.maskSrc.height > 0) {
+        float mw = static_cast<float>(mask->getWidth());
+        float mh = static_cast<float>(mask->getHeight());
+        data.mu0 = instance.maskSrc.x / mw;
+        data.mv0 = instance.maskSrc.y / mh;
+        data.mu1 = (instance.maskSrc.x + instance.maskSrc.width) / mw;
+        data.mv1 = (instance.maskSrc.y + instance.maskSrc.height) / mh;
+    }
 
-    float u0 = src.x / tw;
-    float v0 = src.y / th;
-    float u1 = (src.x + src.width) / tw;
-    float v1 = (src.y + src.height) / th;
+    data.tint[0] = instance.tint.r;
+    data.tint[1] = instance.tint.g;
+    data.tint[2] = instance.tint.b;
+    data.tint[3] = static_cast<uint8_t>(instance.tint.a * m_impl->opacity);
+    for (size_t channel = 0; channel < 4; ++channel) {
+        const Color& color = instance.outfitColors[channel];
+        data.colors[channel][0] = color.r;
+        data.colors[channel][1] = color.g;
+        data.colors[channel][2] = color.b;
+        data.colors[channel][3] = color.a;
+    }
 
-    float vertices[] = {
-        (float)dest.x, (float)dest.y, u0, v0, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)(dest.x + dest.width), (float)dest.y, u1, v0, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)(dest.x + dest.width), (float)(dest.y + dest.height), u1, v1, 1.0f, 1.0f, 1.0f, m_impl->opacity,
+    m_impl->instances.push_back(data);
+    m_frameStats.instances++;
+}
 
-        (float)dest.x, (float)dest.y, u0, v0, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)(dest.x + dest.width), (float)(dest.y + dest.height), u1, v1, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-        (float)dest.x, (float)(dest.y + dest.height), u0, v1, 1.0f, 1.0f, 1.0f, m_impl->opacity,
-    };
+void Graphics::flushInstances() {
+    auto& instances = m_impl->instances;
+    if (instances.empty()) return;
 
-    glUseProgram(m_impl->shaderProgram);
-    glUniform1i(glGetUniformLocation(m_impl->shaderProgram, "useTexture"), 1);
+    m_impl->backend->drawSprites(m_impl->instanceTexture, m_impl->instanceMask, instances.data(), instances.size());
+    m_frameStats.drawCalls++;
+    m_frameStats.batches++;
 
-    texture->bind(0);
+    instances.clear();
+}
+
+void Graphics::flush() {
+    if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::Flush);
+        return;
+    }
+    flushInstances();
+    if (m_impl->batchVertices.empty()) return;
 
-    glBindVertexArray(m_impl->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_impl->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+    auto& vertices = m_impl->batchVertices;
+    m_impl->backend->drawQuads(m_impl->batchTexture, vertices.data(), vertices.size() / 4);
+    m_frameStats.drawCalls++;
+    m_frameStats.batches++;
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    vertices.clear();
 }
 
 void Graphics::pushClipRect(const Rect& rect) {
     if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::PushClip).dest = rect;
+        return;
+    }
+    flush();
     m_impl->clipStack.push_back(rect);
-    glEnable(GL_SCISSOR_TEST);
-    glScissor(rect.x, m_impl->viewportHeight - rect.y - rect.height, rect.width, rect.height);
+    m_impl->backend->setScissorTest(true);
+    m_impl->applyScissor(rect);
 }
 
 void Graphics::popClipRect() {
     if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::PopClip);
+        return;
+    }
+    flush();
 
     if (!m_impl->clipStack.empty()) {
         m_impl->clipStack.pop_back();
     }
 
-    if (m_impl->clipStack.empty()) {
-        glDisable(GL_SCISSOR_TEST);
+    size_t base = m_impl->renderTarget ? m_impl->targetClipBase : 0;
+    if (m_impl->clipStack.size() <= base) {
+        m_impl->backend->setScissorTest(false);
     } else {
-        const Rect& rect = m_impl->clipStack.back();
-        glScissor(rect.x, m_impl->viewportHeight - rect.y - rect.height, rect.width, rect.height);
+        m_impl->applyScissor(m_impl->clipStack.back());
     }
 }
 
+void Graphics::setBlendMode(int mode) {
+    if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::Blend).value = mode;
+        return;
+    }
+    if (mode == m_impl->blendMode) return;
+    flush();
+    m_impl->blendMode = mode;
+
+    m_impl->backend->setBlendMode(mode);
+}
+
 void Graphics::setOpacity(float opacity) {
-    if (m_impl) {
+    if (m_impl && m_impl->isRecording()) {
+        m_impl->record(DrawOp::Opacity).scalar = opacity;
+    } else if (m_impl) {
         m_impl->opacity = opacity;
     }
 }
 
 void Graphics::clear(const Color& color) {
-    glClearColor(color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (m_impl && m_impl->isRecording()) {
+        m_impl->record(DrawOp::Clear).color = color;
+        return;
+    }
+
+    if (!m_impl) return;
+    flush();
+    m_impl->backend->clear(color);
 }
 
 void Graphics::present() {
@@ -417,53 +743,376 @@ void Graphics::present() {
 
 void Graphics::setWindow(void* window) {
     if (m_impl) {
-        m_impl->window = static_cast<GLFWwindow*>(window);
+        m_impl->window = window;
+        m_impl->backend->setWindow(window);
+    }
+}
+
+void Graphics::setSwapInterval(int interval) {
+    if (m_impl && m_impl->isRecording()) {
+        m_impl->record(DrawOp::SwapInterval).value = interval;
+        return;
     }
+    if (m_impl) m_impl->backend->setSwapInterval(interval);
 }
 
 std::shared_ptr<Texture> Graphics::createTexture(int width, int height, const uint8_t* data, bool hasAlpha) {
-    GLuint textureId;
-    glGenTextures(1, &textureId);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    return makeTexture(width, height, data, hasAlpha, false);
+}
+
+std::shared_ptr<Texture> Graphics::createSmoothTexture(int width, int height, const uint8_t* data) {
+    return makeTexture(width, height, data, true, true);
+}
+
+std::shared_ptr<Texture> Graphics::makeTexture(int width, int height, const uint8_t* data, bool hasAlpha, bool smooth) {
+    if (!m_impl) return nullptr;
+    auto createObject = [this, width, height, hasAlpha, smooth](const uint8_t* pixels) {
+        return m_impl->backend->createTexture(width, height, pixels, hasAlpha, smooth);
+    };
+
+    if (!m_impl->isRecording()) {
+        return std::make_shared<GpuTexture>(createObject(data), width, height, hasAlpha);
+    }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // The id is filled in by the render thread before anything draws it
+    auto texture = std::make_shared<GpuTexture>(0, width, height, hasAlpha);
+    std::vector<uint8_t> pixels;
+    if (data) {
+        pixels.assign(data, data + static_cast<size_t>(width) * height * (hasAlpha ? 4 : 3));
+    }
+    m_impl->queueResource([texture, pixels = std::move(pixels), createObject] {
+        texture->setId(createObject(pixels.empty() ? nullptr : pixels.data()));
+    });
+    return texture;
+}
+
+std::shared_ptr<RenderTarget> Graphics::createRenderTarget(int width, int height, bool smooth) {
+    if (!m_impl || width <= 0 || height <= 0) return nullptr;
+
+    auto texture = smooth ? createSmoothTexture(width, height, nullptr) : createTexture(width, height, nullptr, true);
+    if (!texture) return nullptr;
+
+    auto createFramebuffer = [this](uint32_t textureId) {
+        return m_impl->backend->createFramebuffer(textureId);
+    };
+
+    if (!m_impl->isRecording()) {
+        uint32_t framebuffer = createFramebuffer(texture->getId());
+        if (!framebuffer) return nullptr;
+        return std::make_shared<GpuRenderTarget>(framebuffer, std::move(texture));
+    }
 
-    GLenum format = hasAlpha ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    // Completeness is only known on the render thread; an incomplete target
+    // stays without a framebuffer and draws into it are dropped
+    auto target = std::make_shared<GpuRenderTarget>(0, std::move(texture));
+    m_impl->queueResource([target, createFramebuffer] {
+        target->setFramebuffer(createFramebuffer(target->getTexture()->getId()));
+    });
+    return target;
+}
 
-    return std::make_shared<GLTexture>(textureId, width, height, hasAlpha);
+void Graphics::beginRenderTarget(RenderTarget* target, const Point& origin) {
+    if (!m_impl || !target) return;
+    if (m_impl->isRecording()) {
+        DrawCommand& command = m_impl->record(DrawOp::BeginTarget);
+        command.target = target;
+        command.dest = Rect(origin.x, origin.y, 0, 0);
+        m_impl->recording->retain(static_cast<const RenderTarget*>(target));
+        return;
+    }
+    if (m_impl->renderTarget || !static_cast<GpuRenderTarget*>(target)->getFramebuffer()) return;
+    flush();
+
+    m_impl->renderTarget = static_cast<GpuRenderTarget*>(target);
+    std::copy(std::begin(m_impl->viewport), std::end(m_impl->viewport), m_impl->savedViewport);
+    m_impl->savedOrthoWidth = m_impl->viewportWidth;
+    m_impl->savedOrthoHeight = m_impl->viewportHeight;
+
+    RenderBackend& backend = *m_impl->backend;
+    backend.bindFramebuffer(m_impl->renderTarget->getFramebuffer());
+    backend.setScissorTest(false);
+    backend.setViewport(0, 0, target->getWidth(), target->getHeight());
+    m_impl->originX = origin.x;
+    m_impl->originY = origin.y;
+    m_impl->targetClipBase = m_impl->clipStack.size();
+    setOrtho(target->getWidth(), target->getHeight());
+}
+
+void Graphics::endRenderTarget() {
+    if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::EndTarget);
+        return;
+    }
+    if (!m_impl->renderTarget) return;
+    flush();
+
+    m_impl->renderTarget = nullptr;
+    m_impl->clipStack.resize(std::min(m_impl->clipStack.size(), m_impl->targetClipBase));
+    RenderBackend& backend = *m_impl->backend;
+    backend.bindFramebuffer(0);
+    const int* viewport = m_impl->savedViewport;
+    backend.setViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    m_impl->originX = 0;
+    m_impl->originY = 0;
+    setOrtho(m_impl->savedOrthoWidth, m_impl->savedOrthoHeight);
+
+    if (!m_impl->clipStack.empty()) {
+        backend.setScissorTest(true);
+        m_impl->applyScissor(m_impl->clipStack.back());
+    }
+}
+
+void Graphics::updateTexture(const Texture* texture, const Rect& region, const uint8_t* data) {
+    if (!texture || !data || !m_impl) return;
+    if (m_impl->isRecording()) {
+        // Applied before the render thread's next frame
+        auto keep = static_cast<const GpuTexture*>(texture)->shared_from_this();
+        std::vector<uint8_t> pixels(data, data + static_cast<size_t>(region.width) * region.height * 4);
+        m_impl->queueResource([this, keep, region, pixels = std::move(pixels)] {
+            updateTexture(keep.get(), region, pixels.data());
+        });
+        return;
+    }
+
+    // Queued quads must sample what the texture held when they were drawn
+    if (m_impl->batchTexture == texture->getId() || m_impl->instanceTexture == texture->getId() ||
+        m_impl->instanceMask == texture->getId()) {
+        flush();
+    }
+
+    size_t bytes = static_cast<size_t>(region.width) * region.height * 4;
+    m_frameStats.textureUploads++;
+    m_frameStats.uploadBytes += static_cast<uint32_t>(bytes);
+
+    m_impl->backend->updateTexture(texture->getId(), region, data);
+}
+
+void Graphics::beginGpuTimer(uint32_t slot) {
+    if (!m_impl || slot >= GPU_TIMER_SLOTS) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::BeginGpuTimer).value = static_cast<int>(slot);
+        return;
+    }
+    if (m_impl->gpuActiveSlot >= 0) return;
+
+    uint32_t set = m_impl->gpuFrame;
+    if (m_impl->gpuIssued[set][slot]) return;
+
+    // Draws queued before the timer belong to whatever came before it
+    flush();
+    m_impl->backend->beginTimer(set, slot);
+    m_impl->gpuIssued[set][slot] = true;
+    m_impl->gpuActiveSlot = static_cast<int>(slot);
+}
+
+void Graphics::endGpuTimer() {
+    if (!m_impl) return;
+    if (m_impl->isRecording()) {
+        m_impl->record(DrawOp::EndGpuTimer);
+        return;
+    }
+    if (m_impl->gpuActiveSlot < 0) return;
+
+    flush();
+    m_impl->backend->endTimer();
+    m_impl->gpuActiveSlot = -1;
+}
+
+float Graphics::getGpuTimerMs(uint32_t slot) const {
+    if (!m_impl || slot >= GPU_TIMER_SLOTS) return -1.0f;
+    std::lock_guard<std::mutex> lock(m_impl->frameMutex);
+    return m_impl->gpuResults[slot];
+}
+
+bool Graphics::startRenderThread() {
+    if (!m_impl || !m_impl->window || m_impl->threaded.load()) return false;
+
+    flush();
+    m_impl->recording = std::make_unique<Snapshot>();
+    m_impl->stopping = false;
+    m_impl->renderStats = RenderThreadStats{};
+
+    // A context is current on one thread at a time
+    m_impl->backend->makeCurrent(false);
+    m_impl->renderThread = std::thread([this] { renderThreadMain(); });
+    m_impl->renderThreadId = m_impl->renderThread.get_id();
+    m_impl->threaded.store(true, std::memory_order_release);
+    return true;
+}
+
+void Graphics::stopRenderThread() {
+    if (!m_impl || !m_impl->threaded.load()) return;
+
+    // Snapshots not yet drawn are dropped; queued resources still run
+    {
+        std::lock_guard<std::mutex> lock(m_impl->frameMutex);
+        m_impl->stopping = true;
+    }
+    m_impl->frameReady.notify_one();
+    m_impl->renderThread.join();
+
+    m_impl->threaded.store(false, std::memory_order_release);
+    m_impl->renderThreadId = std::thread::id();
+    m_impl->backend->makeCurrent(true);
+
+    // Textures only the snapshots held are deleted here, on the context
+    m_impl->recording.reset();
+    m_impl->pending.reset();
+    m_impl->freeSnapshots.clear();
+    runResourceQueue();
+}
+
+bool Graphics::isRenderThreadRunning() const {
+    return m_impl && m_impl->threaded.load(std::memory_order_acquire);
+}
+
+Graphics::RenderThreadStats Graphics::getRenderThreadStats() const {
+    if (!m_impl) return RenderThreadStats{};
+    std::lock_guard<std::mutex> lock(m_impl->frameMutex);
+    return m_impl->renderStats;
+}
+
+void Graphics::runResourceQueue() {
+    std::vector<std::function<void()>> work;
+    std::vector<RenderBackend::TextureId> textures;
+    std::vector<RenderBackend::FramebufferId> framebuffers;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->resourceMutex);
+        work.swap(m_impl->resourceQueue);
+        textures.swap(m_impl->deadTextures);
+        framebuffers.swap(m_impl->deadFramebuffers);
+    }
+
+    for (auto& task : work) {
+        task();
+    }
+    // Dropping the tasks may free more; those delete directly, being here
+    work.clear();
+    m_impl->backend->deleteFramebuffers(framebuffers.data(), framebuffers.size());
+    m_impl->backend->deleteTextures(textures.data(), textures.size());
+}
+
+void Graphics::replay(const Snapshot& snapshot) {
+    for (const DrawCommand& command : snapshot.commands) {
+        switch (command.op) {
+            case DrawOp::Clear:
+                clear(command.color);
+                break;
+            case DrawOp::Viewport:
+                setViewport(command.dest.x, command.dest.y, command.dest.width, command.dest.height);
+                break;
+            case DrawOp::Ortho:
+                setOrtho(command.dest.width, command.dest.height);
+                break;
+            case DrawOp::Rect:
+                drawRect(command.dest, command.color);
+                break;
+            case DrawOp::FilledRect:
+                drawFilledRect(command.dest, command.color);
+                break;
+            case DrawOp::Texture:
+                drawTextureColored(command.texture, command.src, command.dest, command.color);
+                break;
+            case DrawOp::RenderTarget:
+                drawRenderTarget(command.target, command.src, command.dest);
+                break;
+            case DrawOp::Sprite:
+                drawSpriteInstance(command.texture, snapshot.sprites[command.value], command.mask);
+                break;
+            case DrawOp::PushClip:
+                pushClipRect(command.dest);
+                break;
+            case DrawOp::PopClip:
+                popClipRect();
+                break;
+            case DrawOp::Blend:
+                setBlendMode(command.value);
+                break;
+            case DrawOp::Opacity:
+                setOpacity(command.scalar);
+                break;
+            case DrawOp::BeginTarget:
+                beginRenderTarget(const_cast<RenderTarget*>(command.target), Point(command.dest.x, command.dest.y));
+                break;
+            case DrawOp::EndTarget:
+                endRenderTarget();
+                break;
+            case DrawOp::BeginGpuTimer:
+                beginGpuTimer(static_cast<uint32_t>(command.value));
+                break;
+            case DrawOp::EndGpuTimer:
+                endGpuTimer();
+                break;
+            case DrawOp::Flush:
+                flush();
+                break;
+            case DrawOp::SwapInterval:
+                setSwapInterval(command.value);
+                break;
+        }
+    }
+}
+
+void Graphics::renderThreadMain() {
+    Impl& impl = *m_impl;
+    impl.backend->makeCurrent(true);
+
+    for (;;) {
+        std::unique_ptr<Snapshot> snapshot;
+        {
+            std::unique_lock<std::mutex> lock(impl.frameMutex);
+            impl.frameReady.wait(lock, [&impl] { return impl.pending || impl.stopping; });
+            if (impl.stopping) break;
+            snapshot = std::move(impl.pending);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        runResourceQueue();
+        beginFrame();
+        replay(*snapshot);
+        // A snapshot cut off mid-target must not leave the next one in it
+        endRenderTarget();
+        endGpuTimer();
+        endFrame();
+        if (impl.window) {
+            impl.backend->present();
+        }
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // The references go here, on the context
+        snapshot->clear();
+        std::lock_guard<std::mutex> lock(impl.frameMutex);
+        impl.freeSnapshots.push_back(std::move(snapshot));
+        impl.renderStats.renderMs = ms;
+        impl.renderStats.framesDrawn++;
+    }
+
+    runResourceQueue();
+    impl.backend->makeCurrent(false);
 }
 
 std::shared_ptr<Texture> Graphics::loadTexture(const std::string& filename) {
-    // Simple BMP/PNG loader would go here
-    // For now, return nullptr - texture loading requires stb_image or similar
-    return nullptr;
+    Image image;
+    if (filename.empty() || !loadImage(filename, image)) {
+        return nullptr;
+    }
+    return createTexture(image.width, image.height, image.pixels.data());
 }
 
 void Graphics::drawText(const std::string& text, int x, int y, const Color& color, int fontSize) {
-    // Text rendering would require a proper font rendering system (FreeType, stb_truetype, etc.)
-    // For now, this is a stub - text will not be visible until font rendering is implemented
-    // In a full implementation, this would:
-    // 1. Get/load font at the specified size
-    // 2. Render each character glyph using textures
-    // 3. Position characters with proper kerning
-    (void)text;
-    (void)x;
-    (void)y;
-    (void)color;
-    (void)fontSize;
+    if (Font* font = g_fonts.getFont(fontSize)) {
+        font->drawText(text, x, y, color);
+    }
 }
 
 Size Graphics::measureText(const std::string& text, int fontSize) const {
-    // Placeholder text measurement
-    // In a full implementation, this would use the actual font metrics
-    // For now, estimate based on character count
-    int charWidth = fontSize * 6 / 10;  // Rough estimate for monospace
-    int charHeight = fontSize;
-    return Size(static_cast<int>(text.length()) * charWidth, charHeight);
+    if (const Font* font = g_fonts.getFont(fontSize)) {
+        return font->measureText(text);
+    }
+
+    // No fonts yet: a rough monospace estimate keeps layouts sensible
+    return Size(static_cast<int>(text.length()) * fontSize * 6 / 10, fontSize);
 }
 
 // Global instance inside the namespace
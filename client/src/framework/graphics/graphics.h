@@ -1,7 +1,8 @@
 /**
  * Shadow OT Client - Graphics System
  *
- * OpenGL-based rendering system with modern features.
+ * Batched 2D renderer over a RenderBackend (see renderbackend.h): OpenGL
+ * 3.3 today, with other GPU APIs picked at init.
  */
 
 #pragma once
@@ -9,6 +10,7 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <array>
 #include <cstdint>
 
 namespace shadow {
@@ -57,6 +59,20 @@ struct Size {
     Size(int w, int h) : width(w), height(h) {}
 };
 
+// GPU API behind Graphics; "graphics-backend" in the config
+enum class RenderBackendType : uint8_t {
+    OpenGL,
+    Vulkan,
+    Metal
+};
+
+enum BlendMode : int {
+    BlendNormal = 0,    // Source alpha over destination
+    BlendAdditive = 1,  // Lights and glows
+    BlendMultiply = 2,  // Light maps and shadows
+    BlendPremultiplied = 3  // Compositing render targets filled with BlendNormal
+};
+
 class Texture {
 public:
     virtual ~Texture() = default;
@@ -65,16 +81,58 @@ public:
     virtual int getWidth() const = 0;
     virtual int getHeight() const = 0;
     virtual bool hasAlpha() const = 0;
+};
 
-    virtual void bind(int unit = 0) const = 0;
-    virtual void unbind() const = 0;
+// Offscreen color buffer; its texture is stored bottom-up, so draw it
+// with Graphics::drawRenderTarget
+class RenderTarget {
+public:
+    virtual ~RenderTarget() = default;
+
+    virtual const Texture* getTexture() const = 0;
+    virtual int getWidth() const = 0;
+    virtual int getHeight() const = 0;
+};
+
+// One sprite of the instanced path. An outfit sprite also names the rect
+// of its template layer, whose yellow, red, green and blue pixels mark
+// where the shader multiplies in the head, body, legs and feet colors.
+struct SpriteInstance {
+    Rect dest;
+    Rect src;                       // In texture pixels
+    Rect maskSrc;                   // Template layer; empty without one
+    Color tint;
+    std::array<Color, 4> outfitColors;
 };
 
 class Graphics {
 public:
     static Graphics& instance();
 
-    bool init();
+    // Textured and filled quads are batched: consecutive quads sharing a
+    // texture, blend mode and clip rect go out in one draw call. The batch
+    // is flushed on a state change, before outlines and at the end of the
+    // frame.
+    static constexpr size_t BATCH_MAX_QUADS = 4096;
+    static constexpr size_t BATCH_MAX_INSTANCES = 4096;
+    static constexpr size_t UPLOAD_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    struct FrameStats {
+        uint32_t drawCalls{0};
+        uint32_t quads{0};
+        uint32_t batches{0};
+        uint32_t instances{0};
+        uint32_t textureUploads{0};
+        uint32_t uploadBytes{0};
+        // Backend binds, toggles and uniform uploads made, and those
+        // skipped because the state was already set
+        uint32_t stateChanges{0};
+        uint32_t stateChangesSkipped{0};
+    };
+
+    // Fails for a backend not built into this client; see
+    // isRenderBackendBuiltIn
+    bool init(RenderBackendType backend = RenderBackendType::OpenGL);
     void terminate();
 
     void beginFrame();
@@ -99,8 +157,17 @@ public:
     void drawTexture(const Texture* texture, const Rect& dest);
     void drawTexture(const Texture* texture, const Rect& src, const Rect& dest);
     void drawTextureColored(const Texture* texture, const Rect& dest, const Color& color);
+    void drawTextureColored(const Texture* texture, const Rect& src, const Rect& dest, const Color& color);
+    void drawRenderTarget(const RenderTarget* target, const Rect& dest);
+    void drawRenderTarget(const RenderTarget* target, const Rect& src, const Rect& dest);
+
+    // Instanced sprites: consecutive instances sharing a texture, template
+    // texture and state go out in one instanced draw call, in the order
+    // they were queued relative to other draws
+    void drawSpriteInstance(const Texture* texture, const SpriteInstance& instance, const Texture* mask = nullptr);
 
-    // Text drawing (requires font)
+    // Text in the loaded bitmap font closest to fontSize (see FontManager);
+    // nothing is drawn before fonts are imported
     void drawText(const std::string& text, int x, int y, const Color& color, int fontSize = 12);
     Size measureText(const std::string& text, int fontSize = 12) const;
 
@@ -108,6 +175,24 @@ public:
     void pushClipRect(const Rect& rect);
     void popClipRect();
 
+    // Submit queued quads now
+    void flush();
+
+    // Counters of the last completed frame
+    FrameStats getFrameStats() const;
+
+    // GPU time of up to GPU_TIMER_SLOTS stages per frame, measured with
+    // the backend's timer queries. Timers cannot overlap and flush the
+    // batch on both ends, so each stage's draws are attributed to it. A slot is timed
+    // once per frame; results are collected GPU_TIMER_FRAMES frames later,
+    // so reading them never stalls on the GPU.
+    static constexpr uint32_t GPU_TIMER_SLOTS = 16;
+    static constexpr uint32_t GPU_TIMER_FRAMES = 4;
+    void beginGpuTimer(uint32_t slot);
+    void endGpuTimer();
+    // Milliseconds of the frame GPU_TIMER_FRAMES back, or -1 if not timed
+    float getGpuTimerMs(uint32_t slot) const;
+
     // State management
     void setBlendMode(int mode);
     void setColor(const Color& color);
@@ -119,26 +204,81 @@ public:
 
     // Window management (for buffer swapping)
     void setWindow(void* window);
+    // Vsync on whichever thread holds the context
+    void setSwapInterval(int interval);
+
+    // Render thread. Once started it owns the GPU context: draws made on the
+    // update thread are recorded into a frame snapshot instead, render()
+    // hands the snapshot over without waiting, and the render thread draws
+    // it while the next one is recorded. A snapshot not yet picked up when
+    // the next arrives is dropped, so neither side waits for the other.
+    // Texture and target creation, uploads and deletes are queued from any
+    // thread and run before the render thread's next frame; draws come from
+    // one thread only.
+    struct RenderThreadStats {
+        float renderMs{0.0f};       // Replay and swap of the last snapshot
+        uint64_t framesDrawn{0};
+        uint64_t framesDropped{0};
+    };
+
+    bool startRenderThread();
+    void stopRenderThread();
+    bool isRenderThreadRunning() const;
+    RenderThreadStats getRenderThreadStats() const;
 
     // Info
+    RenderBackendType getBackendType() const { return m_backendType; }
     const std::string& getRenderer() const { return m_renderer; }
     const std::string& getVendor() const { return m_vendor; }
     int getMaxTextureSize() const { return m_maxTextureSize; }
 
     // Create resources
     std::shared_ptr<Texture> createTexture(int width, int height, const uint8_t* data, bool hasAlpha = true);
+    // Replace a region of an RGBA texture. The pixels are staged in a
+    // streamed pixel buffer, so the copy into the texture runs on the GPU.
+    void updateTexture(const Texture* texture, const Rect& region, const uint8_t* data);
+    // PNG file by its resolved path
     std::shared_ptr<Texture> loadTexture(const std::string& filename);
+    // Same as createTexture, but sampled with linear filtering
+    std::shared_ptr<Texture> createSmoothTexture(int width, int height, const uint8_t* data);
+
+    // Offscreen rendering. Between begin and end, draws go to the target
+    // with the projection set to its size, its top-left at origin; clip
+    // rects pushed before begin are suspended, ones pushed inside apply in
+    // the same coordinates as the draws. Targets do not nest. BlendNormal
+    // accumulates coverage in the alpha channel, so a target drawn over a
+    // transparent clear composites correctly with BlendPremultiplied.
+    // Smooth targets are sampled with linear filtering.
+    std::shared_ptr<RenderTarget> createRenderTarget(int width, int height, bool smooth = true);
+    void beginRenderTarget(RenderTarget* target, const Point& origin = Point());
+    void endRenderTarget();
 
 private:
+    friend class GpuTexture;
+    friend class GpuRenderTarget;
+    struct Snapshot;
+
     Graphics() = default;
     ~Graphics() = default;
     Graphics(const Graphics&) = delete;
     Graphics& operator=(const Graphics&) = delete;
 
+    void queueQuad(uint32_t texture, const Rect& dest, float u0, float v0, float u1, float v1, const Color& color);
+    void flushInstances();
+
+    std::shared_ptr<Texture> makeTexture(int width, int height, const uint8_t* data, bool hasAlpha, bool smooth);
+    void replay(const Snapshot& snapshot);
+    void runResourceQueue();
+    void renderThreadMain();
+
+    RenderBackendType m_backendType{RenderBackendType::OpenGL};
     std::string m_renderer;
     std::string m_vendor;
     int m_maxTextureSize{4096};
 
+    FrameStats m_frameStats;
+    FrameStats m_lastFrameStats;
+
     struct Impl;
     std::unique_ptr<Impl> m_impl;
 };
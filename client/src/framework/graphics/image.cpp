@@ -0,0 +1,184 @@
+/**
+ * Shadow OT Client - Image Decoding Implementation
+ */
+
+#include "image.h"
+#include <zlib.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+constexpr uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+enum PngColorType : uint8_t {
+    PngGray = 0,
+    PngRgb = 2,
+    PngPalette = 3,
+    PngGrayAlpha = 4,
+    PngRgba = 6
+};
+
+uint32_t readBE32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+int channelCount(uint8_t colorType) {
+    switch (colorType) {
+        case PngGray: return 1;
+        case PngRgb: return 3;
+        case PngPalette: return 1;
+        case PngGrayAlpha: return 2;
+        case PngRgba: return 4;
+        default: return 0;
+    }
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = int(a) + int(b) - int(c);
+    int pa = std::abs(p - int(a));
+    int pb = std::abs(p - int(b));
+    int pc = std::abs(p - int(c));
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+// Undo the per-row filters in place; each row is preceded by its filter byte
+bool unfilter(uint8_t* data, int height, size_t rowBytes, int bytesPerPixel) {
+    const uint8_t* prior = nullptr;
+    for (int y = 0; y < height; ++y) {
+        uint8_t filter = data[0];
+        uint8_t* row = data + 1;
+
+        for (size_t i = 0; i < rowBytes; ++i) {
+            uint8_t left = i >= size_t(bytesPerPixel) ? row[i - bytesPerPixel] : 0;
+            uint8_t up = prior ? prior[i] : 0;
+            uint8_t upLeft = prior && i >= size_t(bytesPerPixel) ? prior[i - bytesPerPixel] : 0;
+
+            switch (filter) {
+                case 0: break;
+                case 1: row[i] = uint8_t(row[i] + left); break;
+                case 2: row[i] = uint8_t(row[i] + up); break;
+                case 3: row[i] = uint8_t(row[i] + ((int(left) + int(up)) >> 1)); break;
+                case 4: row[i] = uint8_t(row[i] + paeth(left, up, upLeft)); break;
+                default: return false;
+            }
+        }
+
+        prior = row;
+        data += rowBytes + 1;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+bool decodePng(const uint8_t* data, size_t size, Image& image) {
+    if (size < 8 || std::memcmp(data, PNG_SIGNATURE, 8) != 0) {
+        return false;
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t colorType = 0;
+    bool haveHeader = false;
+    uint8_t palette[256][4] = {};
+    std::vector<uint8_t> compressed;
+
+    size_t pos = 8;
+    while (pos + 12 <= size) {
+        uint32_t length = readBE32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* chunk = data + pos + 8;
+        if (length > size - pos - 12) {
+            return false;
+        }
+
+        if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+            width = readBE32(chunk);
+            height = readBE32(chunk + 4);
+            uint8_t bitDepth = chunk[8];
+            colorType = chunk[9];
+            uint8_t interlace = chunk[12];
+            if (bitDepth != 8 || interlace != 0 || channelCount(colorType) == 0 ||
+                width == 0 || height == 0 || width > 16384 || height > 16384) {
+                return false;
+            }
+            haveHeader = true;
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            for (uint32_t i = 0; i < length / 3 && i < 256; ++i) {
+                palette[i][0] = chunk[i * 3];
+                palette[i][1] = chunk[i * 3 + 1];
+                palette[i][2] = chunk[i * 3 + 2];
+                palette[i][3] = 255;
+            }
+        } else if (std::memcmp(type, "tRNS", 4) == 0 && colorType == PngPalette) {
+            for (uint32_t i = 0; i < length && i < 256; ++i) {
+                palette[i][3] = chunk[i];
+            }
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+
+        pos += length + 12;
+    }
+
+    if (!haveHeader || compressed.empty()) {
+        return false;
+    }
+
+    int channels = channelCount(colorType);
+    size_t rowBytes = size_t(width) * channels;
+    std::vector<uint8_t> raw((rowBytes + 1) * height);
+
+    uLongf rawSize = static_cast<uLongf>(raw.size());
+    if (uncompress(raw.data(), &rawSize, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK ||
+        rawSize != raw.size()) {
+        return false;
+    }
+
+    if (!unfilter(raw.data(), static_cast<int>(height), rowBytes, channels)) {
+        return false;
+    }
+
+    image.width = static_cast<int>(width);
+    image.height = static_cast<int>(height);
+    image.pixels.resize(size_t(width) * height * 4);
+
+    uint8_t* out = image.pixels.data();
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = raw.data() + y * (rowBytes + 1) + 1;
+        for (uint32_t x = 0; x < width; ++x, out += 4) {
+            const uint8_t* p = row + size_t(x) * channels;
+            switch (colorType) {
+                case PngGray: out[0] = out[1] = out[2] = p[0]; out[3] = 255; break;
+                case PngGrayAlpha: out[0] = out[1] = out[2] = p[0]; out[3] = p[1]; break;
+                case PngRgb: out[0] = p[0]; out[1] = p[1]; out[2] = p[2]; out[3] = 255; break;
+                case PngPalette: std::memcpy(out, palette[p[0]], 4); break;
+                default: std::memcpy(out, p, 4); break;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool loadImage(const std::string& path, Image& image) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decodePng(data.data(), data.size(), image);
+}
+
+} // namespace framework
+} // namespace shadow
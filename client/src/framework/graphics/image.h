@@ -0,0 +1,32 @@
+/**
+ * Shadow OT Client - Image Decoding
+ *
+ * Decodes PNG files into RGBA pixels using zlib. Covers the non-interlaced
+ * 8-bit images the client ships (fonts, UI skins, icons); other variants
+ * are rejected rather than decoded wrongly.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+struct Image {
+    int width{0};
+    int height{0};
+    std::vector<uint8_t> pixels;    // RGBA, top row first
+};
+
+// Gray, gray+alpha, RGB, RGBA and palette images with 8 bits per channel
+bool decodePng(const uint8_t* data, size_t size, Image& image);
+
+// Read and decode a file by its resolved path
+bool loadImage(const std::string& path, Image& image);
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,60 @@
+/**
+ * Shadow OT Client - Render Backend Implementation
+ */
+
+#include "renderbackend.h"
+#include "glbackend.h"
+#include <algorithm>
+#include <cctype>
+
+namespace shadow {
+namespace framework {
+
+const char* getRenderBackendName(RenderBackendType type) {
+    switch (type) {
+        case RenderBackendType::OpenGL: return "opengl";
+        case RenderBackendType::Vulkan: return "vulkan";
+        case RenderBackendType::Metal: return "metal";
+    }
+    return "unknown";
+}
+
+bool parseRenderBackend(std::string_view name, RenderBackendType& type) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (lower == "opengl" || lower == "gl") {
+        type = RenderBackendType::OpenGL;
+    } else if (lower == "vulkan") {
+        type = RenderBackendType::Vulkan;
+    } else if (lower == "metal") {
+        type = RenderBackendType::Metal;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool isRenderBackendBuiltIn(RenderBackendType type) {
+    switch (type) {
+        case RenderBackendType::OpenGL:
+            return true;
+        case RenderBackendType::Vulkan:
+        case RenderBackendType::Metal:
+            return false;
+    }
+    return false;
+}
+
+std::unique_ptr<RenderBackend> createRenderBackend(RenderBackendType type) {
+    switch (type) {
+        case RenderBackendType::OpenGL:
+            return createGLBackend();
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace framework
+} // namespace shadow
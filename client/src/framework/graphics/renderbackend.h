@@ -0,0 +1,120 @@
+/**
+ * Shadow OT Client - Render Backend
+ *
+ * What Graphics needs from a GPU API: textures and framebuffers, streamed
+ * vertex and instance buffers, the three pipelines it draws with, render
+ * state and command submission. Graphics keeps batching, clipping, render
+ * targets, GPU timer bookkeeping and the render thread; a backend turns
+ * finished batches into API calls and skips state that is already set.
+ *
+ * Render target textures are sampled bottom-up, the way GL stores them; a
+ * backend with top-down targets flips its projection while rendering into
+ * one, so Graphics' texture coordinates hold for every backend.
+ */
+
+#pragma once
+
+#include "graphics.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace shadow {
+namespace framework {
+
+const char* getRenderBackendName(RenderBackendType type);
+// "opengl", "gl", "vulkan" or "metal", ignoring case
+bool parseRenderBackend(std::string_view name, RenderBackendType& type);
+
+// Batched quad corner; color is normalized from bytes by the vertex fetch
+struct BatchVertex {
+    float x, y;
+    float u, v;
+    uint8_t r, g, b, a;
+};
+
+// Per-instance attributes of the instanced sprite path; colors are
+// normalized from bytes by the vertex fetch
+struct InstanceData {
+    float x, y, width, height;
+    float u0, v0, u1, v1;
+    float mu0, mv0, mu1, mv1;       // Template layer; all zero without one
+    uint8_t tint[4];
+    uint8_t colors[4][4];           // Head, body, legs, feet
+};
+
+class RenderBackend {
+public:
+    // Backend objects by id; 0 is none
+    using TextureId = uint32_t;
+    using FramebufferId = uint32_t;
+
+    struct DeviceInfo {
+        std::string renderer;
+        std::string vendor;
+        int maxTextureSize{4096};
+    };
+
+    virtual ~RenderBackend() = default;
+
+    virtual RenderBackendType getType() const = 0;
+
+    // With the window's context current on the calling thread
+    virtual bool init(DeviceInfo& info) = 0;
+    virtual void terminate() = 0;
+    virtual void setWindow(void* window) = 0;
+    // Gives the context to the calling thread, or lets go of it
+    virtual void makeCurrent(bool current) = 0;
+
+    // Resources. Pixels are RGBA, or RGB without alpha; null leaves the
+    // texture undefined.
+    virtual TextureId createTexture(int width, int height, const uint8_t* pixels, bool hasAlpha, bool smooth) = 0;
+    virtual void updateTexture(TextureId texture, const Rect& region, const uint8_t* pixels) = 0;
+    virtual void deleteTextures(const TextureId* textures, size_t count) = 0;
+    // 0 when the texture cannot be rendered to
+    virtual FramebufferId createFramebuffer(TextureId color) = 0;
+    virtual void deleteFramebuffers(const FramebufferId* framebuffers, size_t count) = 0;
+    // 1x1 white, for fills that share batches with sprites
+    virtual TextureId getWhiteTexture() const = 0;
+
+    // State
+    virtual void bindFramebuffer(FramebufferId framebuffer) = 0;
+    virtual void setViewport(int x, int y, int width, int height) = 0;
+    // Column-major, applied to every pipeline
+    virtual void setProjection(const float* matrix) = 0;
+    virtual void setBlendMode(int mode) = 0;
+    virtual void setScissorTest(bool enabled) = 0;
+    // Top-down, in pixels of a surface surfaceHeight tall
+    virtual void setScissor(const Rect& rect, int surfaceHeight) = 0;
+
+    // Command submission. Pipelines: an untextured line loop for outlines,
+    // indexed textured quads for the sprite batch, and instanced quads
+    // with an outfit template layer for creatures.
+    virtual void clear(const Color& color) = 0;
+    virtual void drawLineLoop(const BatchVertex* vertices, size_t count) = 0;
+    virtual void drawQuads(TextureId texture, const BatchVertex* vertices, size_t quads) = 0;
+    virtual void drawSprites(TextureId texture, TextureId mask, const InstanceData* instances, size_t count) = 0;
+    virtual void present() = 0;
+    virtual void setSwapInterval(int interval) = 0;
+
+    // GPU timers, one per frame set and slot, as in Graphics::beginGpuTimer.
+    // Reading waits for the result, so read a set only when it comes
+    // around again.
+    virtual void beginTimer(uint32_t frame, uint32_t slot) = 0;
+    virtual void endTimer() = 0;
+    virtual float readTimerMs(uint32_t frame, uint32_t slot) = 0;
+
+    // State changes issued and skipped since last taken
+    virtual std::pair<uint32_t, uint32_t> takeStateCounters() = 0;
+};
+
+// Only OpenGL so far; Vulkan and Metal parse but are not built in
+bool isRenderBackendBuiltIn(RenderBackendType type);
+// Null when the backend is not built into this client
+std::unique_ptr<RenderBackend> createRenderBackend(RenderBackendType type);
+
+} // namespace framework
+} // namespace shadow
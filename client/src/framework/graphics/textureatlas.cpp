@@ -0,0 +1,171 @@
+/**
+ * Shadow OT Client - Texture Atlas Implementation
+ */
+
+#include "textureatlas.h"
+#include <algorithm>
+
+namespace shadow {
+namespace framework {
+
+TextureAtlas::TextureAtlas(int pageSize, size_t memoryBudget)
+    : m_pageSize(pageSize), m_memoryBudget(memoryBudget) {}
+
+TextureAtlas::~TextureAtlas() = default;
+
+const AtlasRegion* TextureAtlas::find(uint64_t key) {
+    auto it = m_regions.find(key);
+    if (it == m_regions.end()) {
+        m_stats.misses++;
+        return nullptr;
+    }
+
+    m_stats.hits++;
+    m_pages[it->second.pageIndex].lastUsed = m_frame;
+    return &it->second;
+}
+
+const AtlasRegion* TextureAtlas::add(uint64_t key, int width, int height, const uint8_t* rgba) {
+    remove(key);
+
+    // The page size is settled by the first page, once GL limits are known
+    int limit = m_pages.empty() ? std::min(m_pageSize, g_graphics.getMaxTextureSize()) : m_pageSize;
+    if (width <= 0 || height <= 0 || width > limit || height > limit) {
+        return nullptr;
+    }
+
+    Rect rect;
+    uint32_t index = 0;
+    bool placed = false;
+
+    // The page filled last first, so images loaded together share a page
+    for (size_t i = 0; i < m_pages.size() && !placed; ++i) {
+        uint32_t candidate = static_cast<uint32_t>((m_fillPage + i) % m_pages.size());
+        if (allocate(m_pages[candidate], width, height, rect)) {
+            index = candidate;
+            placed = true;
+        }
+    }
+
+    if (!placed && (m_pages.empty() || m_pages.size() < getMaxPages()) && createPage()) {
+        index = static_cast<uint32_t>(m_pages.size() - 1);
+        placed = allocate(m_pages[index], width, height, rect);
+    }
+
+    if (!placed && !m_pages.empty()) {
+        index = findLeastRecentPage();
+        evictPage(index);
+        placed = allocate(m_pages[index], width, height, rect);
+    }
+
+    if (!placed) return nullptr;
+
+    m_fillPage = index;
+    Page& page = m_pages[index];
+    g_graphics.updateTexture(page.texture.get(), rect, rgba);
+    page.keys.push_back(key);
+    page.lastUsed = m_frame;
+
+    AtlasRegion& region = m_regions[key];
+    region.page = page.texture.get();
+    region.rect = rect;
+    region.pageIndex = index;
+    return &region;
+}
+
+void TextureAtlas::remove(uint64_t key) {
+    auto it = m_regions.find(key);
+    if (it == m_regions.end()) return;
+
+    auto& keys = m_pages[it->second.pageIndex].keys;
+    auto pos = std::find(keys.begin(), keys.end(), key);
+    if (pos != keys.end()) {
+        *pos = keys.back();
+        keys.pop_back();
+    }
+    m_regions.erase(it);
+}
+
+void TextureAtlas::setMemoryBudget(size_t bytes) {
+    m_memoryBudget = bytes;
+    while (m_pages.size() > getMaxPages()) {
+        releasePage(findLeastRecentPage());
+    }
+}
+
+void TextureAtlas::clear() {
+    m_regions.clear();
+    m_pages.clear();
+    m_fillPage = 0;
+}
+
+bool TextureAtlas::allocate(Page& page, int width, int height, Rect& out) {
+    // Best-fitting shelf that is not much taller than the image
+    Shelf* best = nullptr;
+    for (auto& shelf : page.shelves) {
+        if (shelf.height < height || shelf.height > height + height / 2) continue;
+        if (shelf.cursorX + width > m_pageSize) continue;
+        if (!best || shelf.height < best->height) best = &shelf;
+    }
+
+    if (!best) {
+        if (page.nextShelfY + height > m_pageSize) return false;
+        page.shelves.push_back({page.nextShelfY, height, 0});
+        page.nextShelfY += height;
+        best = &page.shelves.back();
+    }
+
+    out = Rect(best->cursorX, best->y, width, height);
+    best->cursorX += width;
+    return true;
+}
+
+bool TextureAtlas::createPage() {
+    if (m_pages.empty()) {
+        m_pageSize = std::min(m_pageSize, g_graphics.getMaxTextureSize());
+    }
+
+    auto texture = g_graphics.createTexture(m_pageSize, m_pageSize, nullptr, true);
+    if (!texture) return false;
+
+    Page page;
+    page.texture = std::move(texture);
+    page.lastUsed = m_frame;
+    m_pages.push_back(std::move(page));
+    return true;
+}
+
+uint32_t TextureAtlas::findLeastRecentPage() const {
+    auto lru = std::min_element(m_pages.begin(), m_pages.end(), [](const Page& a, const Page& b) {
+        return a.lastUsed < b.lastUsed;
+    });
+    return static_cast<uint32_t>(lru - m_pages.begin());
+}
+
+void TextureAtlas::evictPage(uint32_t index) {
+    Page& page = m_pages[index];
+    for (uint64_t key : page.keys) {
+        m_regions.erase(key);
+    }
+    m_stats.evictedPages++;
+    m_stats.evictedRegions += page.keys.size();
+    page.keys.clear();
+    page.shelves.clear();
+    page.nextShelfY = 0;
+
+    // Draws queued from the old contents go out before anything is overwritten
+    g_graphics.flush();
+}
+
+void TextureAtlas::releasePage(uint32_t index) {
+    evictPage(index);
+    m_pages.erase(m_pages.begin() + index);
+
+    for (auto& [key, region] : m_regions) {
+        if (region.pageIndex > index) region.pageIndex--;
+    }
+    if (m_fillPage >= m_pages.size()) m_fillPage = 0;
+}
+
+} // namespace framework
+} // namespace shadow
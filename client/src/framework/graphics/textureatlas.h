@@ -0,0 +1,108 @@
+/**
+ * Shadow OT Client - Texture Atlas
+ *
+ * Packs small RGBA images into a few large texture pages so that things
+ * drawn together share one texture and one batch. Images are placed on
+ * shelves (rows of equal height) and looked up by a caller-chosen key.
+ * Pages are bounded by a byte budget. When every page is full, the least
+ * recently used page is wiped and refilled; its images are simply
+ * uploaded again when next requested.
+ */
+
+#pragma once
+
+#include "graphics.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+struct AtlasRegion {
+    const Texture* page{nullptr};
+    Rect rect;              // Pixels within the page
+    uint32_t pageIndex{0};
+};
+
+class TextureAtlas {
+public:
+    static constexpr int DEFAULT_PAGE_SIZE = 2048;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictedPages{0};
+        uint64_t evictedRegions{0};
+    };
+
+    // pageSize is capped by Graphics::getMaxTextureSize. The budget always
+    // allows at least one page.
+    explicit TextureAtlas(int pageSize = DEFAULT_PAGE_SIZE, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    ~TextureAtlas();
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Region of a previously added image, or nullptr. Returned regions stay
+    // valid until the next add, remove or clear.
+    const AtlasRegion* find(uint64_t key);
+
+    // Upload an image; returns nullptr if it cannot fit in a page or no
+    // page could be created
+    const AtlasRegion* add(uint64_t key, int width, int height, const uint8_t* rgba);
+
+    // Space is only reclaimed when the whole page is evicted
+    void remove(uint64_t key);
+    void clear();
+
+    // Lowering the budget releases the least recently used pages at once
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const { return m_memoryBudget; }
+
+    // Counts the frame for page recency; call once per frame
+    void nextFrame() { m_frame++; }
+
+    int getPageSize() const { return m_pageSize; }
+    size_t getPageCount() const { return m_pages.size(); }
+    size_t getRegionCount() const { return m_regions.size(); }
+    size_t getPageBytes() const { return static_cast<size_t>(m_pageSize) * m_pageSize * 4; }
+    size_t getTextureBytes() const { return m_pages.size() * getPageBytes(); }
+    size_t getMaxPages() const { return std::max<size_t>(m_memoryBudget / getPageBytes(), 1); }
+    const Stats& getStats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+private:
+    struct Shelf {
+        int y;
+        int height;
+        int cursorX;
+    };
+    struct Page {
+        std::shared_ptr<Texture> texture;
+        std::vector<Shelf> shelves;
+        std::vector<uint64_t> keys;
+        int nextShelfY{0};
+        uint64_t lastUsed{0};
+    };
+
+    bool allocate(Page& page, int width, int height, Rect& out);
+    bool createPage();
+    void evictPage(uint32_t index);
+    void releasePage(uint32_t index);
+    uint32_t findLeastRecentPage() const;
+
+    int m_pageSize;
+    size_t m_memoryBudget;
+    std::vector<Page> m_pages;
+    std::unordered_map<uint64_t, AtlasRegion> m_regions;
+    uint32_t m_fillPage{0};
+    uint64_t m_frame{0};
+    Stats m_stats;
+};
+
+} // namespace framework
+} // namespace shadow
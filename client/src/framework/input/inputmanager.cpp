@@ -3,6 +3,8 @@
  */
 
 #include "inputmanager.h"
+#include <framework/core/profiler.h>
+#include <framework/platform/platform.h>
 #include <algorithm>
 
 namespace shadow {
@@ -39,6 +41,151 @@ void InputManager::update() {
     m_mouseUp.fill(false);
 }
 
+void InputManager::queueEvent(const InputEvent& event) {
+    if (event.type == InputEvent::Type::MouseMove && m_ringHead != m_ringTail) {
+        InputEvent& last = m_ring[(m_ringHead - 1) % EVENT_RING_SIZE];
+        if (last.type == InputEvent::Type::MouseMove) {
+            last.x = event.x;
+            last.y = event.y;
+            return;
+        }
+    }
+
+    if (m_ringHead - m_ringTail >= EVENT_RING_SIZE) {
+        m_latencyStats.dropped++;
+        return;
+    }
+
+    InputEvent& slot = m_ring[m_ringHead % EVENT_RING_SIZE];
+    slot = event;
+    slot.id = m_nextInputId++;
+    if (m_nextInputId == 0) m_nextInputId = 1;
+    m_ringHead++;
+}
+
+void InputManager::dispatchEvents() {
+    uint64_t now = shadowot::framework::Platform::getTickMicroseconds();
+
+    while (m_ringTail != m_ringHead) {
+        const InputEvent& event = m_ring[m_ringTail % EVENT_RING_SIZE];
+        m_activeInput = &event;
+        m_activeSent = false;
+
+        bool traced = false;
+        switch (event.type) {
+            case InputEvent::Type::KeyDown:
+                traced = !event.repeat;
+                processKeyDown(event.code, event.modifiers, event.repeat);
+                break;
+            case InputEvent::Type::KeyUp:
+                processKeyUp(event.code, event.modifiers);
+                break;
+            case InputEvent::Type::MouseMove:
+                processMouseMove(event.x, event.y, event.x - m_mouseX, event.y - m_mouseY);
+                break;
+            case InputEvent::Type::MouseDown:
+                traced = true;
+                processMouseButtonDown(event.code, event.x, event.y, 1);
+                break;
+            case InputEvent::Type::MouseUp:
+                processMouseButtonUp(event.code, event.x, event.y);
+                break;
+            case InputEvent::Type::Wheel:
+                traced = true;
+                processMouseWheel(m_mouseX, m_mouseY, event.x, event.y);
+                break;
+            case InputEvent::Type::Text: {
+                traced = m_textInputActive;
+                // UTF-8 of one codepoint
+                uint32_t c = static_cast<uint32_t>(event.code);
+                std::string text;
+                if (c < 0x80) {
+                    text += static_cast<char>(c);
+                } else if (c < 0x800) {
+                    text += static_cast<char>(0xC0 | (c >> 6));
+                    text += static_cast<char>(0x80 | (c & 0x3F));
+                } else if (c < 0x10000) {
+                    text += static_cast<char>(0xE0 | (c >> 12));
+                    text += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    text += static_cast<char>(0x80 | (c & 0x3F));
+                } else {
+                    text += static_cast<char>(0xF0 | (c >> 18));
+                    text += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                    text += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    text += static_cast<char>(0x80 | (c & 0x3F));
+                }
+                processTextInput(text);
+                break;
+            }
+        }
+
+        if (traced) {
+            m_latencyStats.traced++;
+            m_dispatchLatency.add(static_cast<float>(now - event.timeUs) / 1000.0f);
+            m_awaitingPresent.push_back({event.timeUs});
+        }
+        m_ringTail++;
+    }
+    m_activeInput = nullptr;
+}
+
+uint32_t InputManager::markInputSent() {
+    if (!m_activeInput) return 0;
+
+    // Several packets for one input count once, at the first
+    if (!m_activeSent) {
+        m_activeSent = true;
+        m_latencyStats.sent++;
+        uint64_t now = shadowot::framework::Platform::getTickMicroseconds();
+        m_sendLatency.add(static_cast<float>(now - m_activeInput->timeUs) / 1000.0f);
+    }
+    return m_activeInput->id;
+}
+
+void InputManager::markFramePresented() {
+    if (m_awaitingPresent.empty()) return;
+
+    uint64_t now = shadowot::framework::Platform::getTickMicroseconds();
+    float worst = 0.0f;
+    for (const auto& input : m_awaitingPresent) {
+        float ms = static_cast<float>(now - input.timeUs) / 1000.0f;
+        m_presentLatency.add(ms);
+        worst = std::max(worst, ms);
+    }
+    m_awaitingPresent.clear();
+    g_profiler.setGauge(Profiler::GaugeInputLatencyMs, worst);
+}
+
+void InputManager::LatencyWindow::summarize(float& avg, float& max, float* p95) const {
+    avg = max = 0.0f;
+    if (count == 0) {
+        if (p95) *p95 = 0.0f;
+        return;
+    }
+
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        sum += samples[i];
+        max = std::max(max, samples[i]);
+    }
+    avg = sum / static_cast<float>(count);
+
+    if (p95) {
+        std::array<float, LATENCY_WINDOW> sorted = samples;
+        size_t rank = (count * 95 + 99) / 100 - 1;
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + count);
+        *p95 = sorted[rank];
+    }
+}
+
+InputManager::LatencyStats InputManager::getLatencyStats() const {
+    LatencyStats stats = m_latencyStats;
+    m_dispatchLatency.summarize(stats.dispatchAvgMs, stats.dispatchMaxMs, nullptr);
+    m_sendLatency.summarize(stats.sendAvgMs, stats.sendMaxMs, nullptr);
+    m_presentLatency.summarize(stats.presentAvgMs, stats.presentMaxMs, &stats.presentP95Ms);
+    return stats;
+}
+
 void InputManager::processKeyDown(int keyCode, uint16_t modifiers, bool repeat) {
     if (keyCode < 0 || keyCode >= static_cast<int>(KeyCode::MaxKeys)) return;
 
@@ -59,7 +206,7 @@ void InputManager::processKeyDown(int keyCode, uint16_t modifiers, bool repeat)
     event.modifiers = m_currentModifiers;
     event.pressed = true;
     event.repeat = repeat;
-    event.timestamp = 0;  // Would use SDL_GetTicks() or similar
+    event.timestamp = eventTimestamp();
 
     // Check hotkeys
     if (!repeat) {
@@ -90,7 +237,7 @@ void InputManager::processKeyUp(int keyCode, uint16_t modifiers) {
     event.modifiers = m_currentModifiers;
     event.pressed = false;
     event.repeat = false;
-    event.timestamp = 0;
+    event.timestamp = eventTimestamp();
 
     // Notify callback
     if (m_keyCallback) {
@@ -110,7 +257,7 @@ void InputManager::processMouseMove(int x, int y, int relX, int relY) {
     event.button = MouseButton::Left;
     event.pressed = false;
     event.clicks = 0;
-    event.timestamp = 0;
+    event.timestamp = eventTimestamp();
 
     if (m_mouseCallback) {
         m_mouseCallback(event);
@@ -136,7 +283,7 @@ void InputManager::processMouseButtonDown(int button, int x, int y, int clicks)
     event.button = static_cast<MouseButton>(button);
     event.pressed = true;
     event.clicks = clicks;
-    event.timestamp = 0;
+    event.timestamp = eventTimestamp();
 
     if (m_mouseCallback) {
         m_mouseCallback(event);
@@ -160,7 +307,7 @@ void InputManager::processMouseButtonUp(int button, int x, int y) {
     event.button = static_cast<MouseButton>(button);
     event.pressed = false;
     event.clicks = 0;
-    event.timestamp = 0;
+    event.timestamp = eventTimestamp();
 
     if (m_mouseCallback) {
         m_mouseCallback(event);
@@ -173,7 +320,7 @@ void InputManager::processMouseWheel(int x, int y, int scrollX, int scrollY) {
     event.y = m_mouseY;
     event.scrollX = scrollX;
     event.scrollY = scrollY;
-    event.timestamp = 0;
+    event.timestamp = eventTimestamp();
 
     if (m_wheelCallback) {
         m_wheelCallback(event);
@@ -185,7 +332,7 @@ void InputManager::processTextInput(const std::string& text) {
 
     TextInputEvent event;
     event.text = text;
-    event.timestamp = 0;
+    event.timestamp = eventTimestamp();
 
     if (m_textCallback) {
         m_textCallback(event);
@@ -2,6 +2,13 @@
  * Shadow OT Client - Input Manager
  *
  * Handles keyboard and mouse input with hotkey support.
+ *
+ * The platform layer queues raw input into a ring as the window system
+ * reports it, each event stamped with its arrival time; dispatchEvents()
+ * consumes the whole batch once per frame, in order. While an event is
+ * being dispatched it is the active input, so code acting on it (the
+ * packet a walk key sends) can attribute its work to it, and the next
+ * frame swap closes its trace: arrival to dispatch, to packet, to present.
  */
 
 #pragma once
@@ -135,6 +142,19 @@ struct TextInputEvent {
     uint32_t timestamp;
 };
 
+// Raw input waiting in the ring; timestamps above are timeUs / 1000
+struct InputEvent {
+    enum class Type : uint8_t { KeyDown, KeyUp, MouseMove, MouseDown, MouseUp, Wheel, Text };
+    Type type{Type::KeyDown};
+    bool repeat{false};
+    uint16_t modifiers{0};
+    int code{0};            // Key code, mouse button or text codepoint
+    int x{0};               // Cursor position; scroll amounts for Wheel
+    int y{0};
+    uint64_t timeUs{0};     // Platform::getTickMicroseconds() on arrival
+    uint32_t id{0};         // Assigned when queued
+};
+
 // Hotkey binding
 struct Hotkey {
     KeyCode key;
@@ -151,6 +171,34 @@ public:
     void init();
     void terminate();
 
+    // Input ring. Consecutive mouse moves merge into one event that keeps
+    // the first arrival time; a full ring drops new events.
+    static constexpr size_t EVENT_RING_SIZE = 256;
+    void queueEvent(const InputEvent& event);
+    // Once per frame, after update()
+    void dispatchEvents();
+    size_t getQueuedEventCount() const { return m_ringHead - m_ringTail; }
+
+    // Input latency. Only key presses, clicks, wheel and text are traced;
+    // moves and releases would swamp the window.
+    uint32_t getActiveInputId() const { return m_activeInput ? m_activeInput->id : 0; }
+    // The active input produced a packet; returns its id, or 0 outside dispatch
+    uint32_t markInputSent();
+    // Right after the frame is swapped
+    void markFramePresented();
+
+    static constexpr size_t LATENCY_WINDOW = 128;
+    struct LatencyStats {
+        uint64_t traced{0};
+        uint64_t sent{0};           // Traced inputs that produced a packet
+        uint64_t dropped{0};        // Lost to a full ring
+        // Milliseconds from arrival, over the last LATENCY_WINDOW samples
+        float dispatchAvgMs{0.0f}, dispatchMaxMs{0.0f};
+        float sendAvgMs{0.0f}, sendMaxMs{0.0f};
+        float presentAvgMs{0.0f}, presentMaxMs{0.0f}, presentP95Ms{0.0f};
+    };
+    LatencyStats getLatencyStats() const;
+
     // Process SDL events
     void processKeyDown(int keyCode, uint16_t modifiers, bool repeat);
     void processKeyUp(int keyCode, uint16_t modifiers);
@@ -209,6 +257,40 @@ private:
     InputManager() = default;
 
     void checkHotkeys(const KeyEvent& event);
+    uint32_t eventTimestamp() const {
+        return m_activeInput ? static_cast<uint32_t>(m_activeInput->timeUs / 1000) : 0;
+    }
+
+    struct LatencyWindow {
+        std::array<float, LATENCY_WINDOW> samples{};
+        size_t count{0};
+        size_t next{0};
+
+        void add(float ms) {
+            samples[next] = ms;
+            next = (next + 1) % LATENCY_WINDOW;
+            if (count < LATENCY_WINDOW) count++;
+        }
+        void summarize(float& avg, float& max, float* p95) const;
+    };
+
+    // Single producer and consumer, both on the main thread (GLFW calls
+    // back from pollEvents); indices wrap freely
+    std::array<InputEvent, EVENT_RING_SIZE> m_ring{};
+    uint32_t m_ringHead{0};
+    uint32_t m_ringTail{0};
+    uint32_t m_nextInputId{1};
+
+    const InputEvent* m_activeInput{nullptr};
+    bool m_activeSent{false};
+    struct TracedInput {
+        uint64_t timeUs;
+    };
+    std::vector<TracedInput> m_awaitingPresent;
+    LatencyWindow m_dispatchLatency;
+    LatencyWindow m_sendLatency;
+    LatencyWindow m_presentLatency;
+    LatencyStats m_latencyStats;
 
     // Key states
     std::array<bool, static_cast<size_t>(KeyCode::MaxKeys)> m_keyPressed{};
@@ -0,0 +1,297 @@
+/**
+ * Shadow OT Client - Lua Binder
+ *
+ * Compile-time bindings between Lua and native code. Each bound function
+ * or member becomes its own lua_CFunction, generated from the function
+ * pointer, that reads its arguments off the stack and pushes its result
+ * as native types: no std::function, no boxing, no allocation per call.
+ *
+ * Bound classes travel as pointer boxes (a userdata holding T*) tagged
+ * with the class metatable. The metatable is kept by registry reference,
+ * so pushing and checking an object is an integer lookup rather than the
+ * name lookup of luaL_getmetatable and luaL_checkudata.
+ *
+ *   lua::registerClass<Creature>(L, "Creature");
+ *   lua::setMethod(L, "getName", &lua::method<&Creature::getName>);
+ *   lua_pop(L, 1);
+ *
+ * Other value types can be bound by specializing lua::Stack. The
+ * registry references belong to one lua_State; registering a class again
+ * on a new state replaces them.
+ */
+
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <memory>
+#include <framework/luaengine/luainterface.h>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+namespace shadow {
+namespace framework {
+namespace lua {
+
+// Metatable of a bound class, per type
+template<typename T>
+struct ClassInfo {
+    static inline int metatableRef = LUA_NOREF;
+    static inline const char* name = "object";
+};
+
+// Creates the metatable of T with __index on itself, also under name in
+// the registry for code that still uses luaL_checkudata. Leaves it on the
+// stack.
+template<typename T>
+void registerClass(lua_State* L, const char* name) {
+    luaL_newmetatable(L, name);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+
+    lua_pushvalue(L, -1);
+    if (ClassInfo<T>::metatableRef != LUA_NOREF) {
+        luaL_unref(L, LUA_REGISTRYINDEX, ClassInfo<T>::metatableRef);
+    }
+    ClassInfo<T>::metatableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+    ClassInfo<T>::name = name;
+}
+
+template<typename T>
+void pushMetatable(lua_State* L) {
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ClassInfo<T>::metatableRef);
+}
+
+// Sets a function on the table on top of the stack
+inline void setMethod(lua_State* L, const char* name, lua_CFunction function) {
+    lua_pushcfunction(L, function);
+    lua_setfield(L, -2, name);
+}
+
+template<typename T>
+void pushObject(lua_State* L, T* object) {
+    if (!object) {
+        lua_pushnil(L);
+        return;
+    }
+    auto** box = static_cast<T**>(lua_newuserdata(L, sizeof(T*)));
+    *box = object;
+    pushMetatable<T>(L);
+    lua_setmetatable(L, -2);
+}
+
+// The object at index if it is a T, otherwise nullptr
+template<typename T>
+T* toObject(lua_State* L, int index) {
+    void* box = lua_touserdata(L, index);
+    if (!box || !lua_getmetatable(L, index)) return nullptr;
+
+    pushMetatable<T>(L);
+    bool matches = lua_rawequal(L, -1, -2) != 0;
+    lua_pop(L, 2);
+    return matches ? *static_cast<T**>(box) : nullptr;
+}
+
+template<typename T>
+T* checkObject(lua_State* L, int index) {
+    T* object = toObject<T>(L, index);
+    if (!object) {
+        lua_pushfstring(L, "%s expected", ClassInfo<T>::name);
+        luaL_argerror(L, index, lua_tostring(L, -1));
+    }
+    return object;
+}
+
+// Stack conversions; push puts a value on the stack, check reads an
+// argument and raises a Lua error if it has the wrong type
+template<typename T, typename = void>
+struct Stack;
+
+template<>
+struct Stack<bool> {
+    static void push(lua_State* L, bool value) { lua_pushboolean(L, value); }
+    static bool check(lua_State* L, int index) { return lua_toboolean(L, index) != 0; }
+};
+
+// Integers and enums. 64-bit values go as numbers, which carry them on
+// every Lua the client builds against.
+template<typename T>
+struct Stack<T, std::enable_if_t<(std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>>> {
+    static void push(lua_State* L, T value) {
+        if constexpr (sizeof(T) >= 8) {
+            lua_pushnumber(L, static_cast<lua_Number>(value));
+        } else {
+            lua_pushinteger(L, static_cast<lua_Integer>(value));
+        }
+    }
+    static T check(lua_State* L, int index) {
+        if constexpr (sizeof(T) >= 8) {
+            return static_cast<T>(luaL_checknumber(L, index));
+        } else {
+            return static_cast<T>(luaL_checkinteger(L, index));
+        }
+    }
+};
+
+template<typename T>
+struct Stack<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static void push(lua_State* L, T value) { lua_pushnumber(L, static_cast<lua_Number>(value)); }
+    static T check(lua_State* L, int index) { return static_cast<T>(luaL_checknumber(L, index)); }
+};
+
+template<>
+struct Stack<std::string> {
+    static void push(lua_State* L, const std::string& value) { lua_pushlstring(L, value.data(), value.size()); }
+    static std::string check(lua_State* L, int index) {
+        size_t length = 0;
+        const char* text = luaL_checklstring(L, index, &length);
+        return std::string(text, length);
+    }
+};
+
+// Views into the Lua string; valid while it stays on the stack, which
+// covers the call
+template<>
+struct Stack<std::string_view> {
+    static void push(lua_State* L, std::string_view value) { lua_pushlstring(L, value.data(), value.size()); }
+    static std::string_view check(lua_State* L, int index) {
+        size_t length = 0;
+        const char* text = luaL_checklstring(L, index, &length);
+        return std::string_view(text, length);
+    }
+};
+
+template<>
+struct Stack<const char*> {
+    static void push(lua_State* L, const char* value) { lua_pushstring(L, value); }
+    static const char* check(lua_State* L, int index) { return luaL_checkstring(L, index); }
+};
+
+// Bound classes, const or not; nil reads as nullptr
+template<typename T>
+struct Stack<T*, std::enable_if_t<std::is_class_v<T>>> {
+    using Class = std::remove_const_t<T>;
+    static void push(lua_State* L, T* value) { pushObject(L, const_cast<Class*>(value)); }
+    static T* check(lua_State* L, int index) {
+        return lua_isnoneornil(L, index) ? nullptr : checkObject<Class>(L, index);
+    }
+};
+
+template<typename T>
+struct Stack<std::shared_ptr<T>> {
+    static void push(lua_State* L, const std::shared_ptr<T>& value) { pushObject(L, value.get()); }
+};
+
+template<typename T>
+using StackOf = Stack<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+// Parts of a bound function pointer
+template<typename F>
+struct FunctionTraits;
+
+template<typename R, typename... A>
+struct FunctionTraits<R (*)(A...)> {
+    using Return = R;
+    using Arguments = std::tuple<A...>;
+};
+
+template<typename C, typename R, typename... A>
+struct FunctionTraits<R (C::*)(A...)> {
+    using Class = C;
+    using Return = R;
+    using Arguments = std::tuple<A...>;
+};
+
+template<typename C, typename R, typename... A>
+struct FunctionTraits<R (C::*)(A...) const> : FunctionTraits<R (C::*)(A...)> {};
+
+namespace detail {
+
+// Arguments are read from Lua index first on
+template<typename R, typename... A, size_t... I, typename F>
+int call(lua_State* L, int first, F&& function, std::tuple<A...>*, std::index_sequence<I...>) {
+    if constexpr (std::is_void_v<R>) {
+        function(StackOf<A>::check(L, first + static_cast<int>(I))...);
+        return 0;
+    } else {
+        StackOf<R>::push(L, function(StackOf<A>::check(L, first + static_cast<int>(I))...));
+        return 1;
+    }
+}
+
+template<typename R, typename Arguments, typename F>
+int call(lua_State* L, int first, F&& function) {
+    return call<R>(L, first, std::forward<F>(function), static_cast<Arguments*>(nullptr),
+                   std::make_index_sequence<std::tuple_size_v<Arguments>>());
+}
+
+} // namespace detail
+
+// Free function trampoline
+template<auto Function>
+int function(lua_State* L) {
+    using Traits = FunctionTraits<decltype(Function)>;
+    return detail::call<typename Traits::Return, typename Traits::Arguments>(
+        L, 1, [](auto&&... args) -> decltype(auto) { return Function(std::forward<decltype(args)>(args)...); });
+}
+
+// Member function trampoline; self is argument 1. T is the bound class
+// the receiver is checked against, for members inherited from a base.
+template<auto Method, typename T = typename FunctionTraits<decltype(Method)>::Class>
+int method(lua_State* L) {
+    using Traits = FunctionTraits<decltype(Method)>;
+    static_assert(std::is_base_of_v<typename Traits::Class, T>, "method does not belong to T");
+
+    T* self = checkObject<T>(L, 1);
+    return detail::call<typename Traits::Return, typename Traits::Arguments>(
+        L, 2, [self](auto&&... args) -> decltype(auto) { return (self->*Method)(std::forward<decltype(args)>(args)...); });
+}
+
+} // namespace lua
+
+// LuaInterface binding templates, on its state
+
+template<auto Function>
+void LuaInterface::registerGlobalFunction(const std::string& name) {
+    lua_pushcfunction(m_state, &lua::function<Function>);
+    lua_setglobal(m_state, name.c_str());
+}
+
+template<typename T>
+void LuaInterface::registerClass(const std::string& name) {
+    lua::registerClass<T>(m_state, name.c_str());
+    lua_pop(m_state, 1);
+}
+
+template<auto Method, typename T>
+void LuaInterface::bindClassMemberFunction(const std::string& name) {
+    using Class = std::conditional_t<std::is_void_v<T>, typename lua::FunctionTraits<decltype(Method)>::Class, T>;
+    lua::pushMetatable<Class>(m_state);
+    lua::setMethod(m_state, name.c_str(), &lua::method<Method, Class>);
+    lua_pop(m_state, 1);
+}
+
+template<auto Getter, auto Setter, typename T>
+void LuaInterface::bindClassProperty(const std::string& name) {
+    using Class = std::conditional_t<std::is_void_v<T>, typename lua::FunctionTraits<decltype(Getter)>::Class, T>;
+    lua::pushMetatable<Class>(m_state);
+    lua::setMethod(m_state, name.c_str(), &lua::method<Getter, Class>);
+    if constexpr (!std::is_same_v<decltype(Setter), std::nullptr_t>) {
+        std::string setter = "set" + name;
+        setter[3] = static_cast<char>(std::toupper(static_cast<unsigned char>(setter[3])));
+        lua::setMethod(m_state, setter.c_str(), &lua::method<Setter, Class>);
+    }
+    lua_pop(m_state, 1);
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,152 @@
+/**
+ * Shadow OT Client - Lua Bytecode Cache Implementation
+ */
+
+#include "luabytecodecache.h"
+#include <framework/core/mappedfile.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+template<typename T>
+void writeLE(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8));
+    }
+}
+
+template<typename T>
+T readLE(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (i * 8);
+    }
+    return static_cast<T>(value);
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+int appendChunk(lua_State*, const void* bytes, size_t size, void* userdata) {
+    auto* out = static_cast<std::vector<uint8_t>*>(userdata);
+    const uint8_t* in = static_cast<const uint8_t*>(bytes);
+    out->insert(out->end(), in, in + size);
+    return 0;
+}
+
+bool dumpFunction(lua_State* L, std::vector<uint8_t>& out) {
+#if LUA_VERSION_NUM >= 503
+    return lua_dump(L, appendChunk, &out, 0) == 0;
+#else
+    return lua_dump(L, appendChunk, &out) == 0;
+#endif
+}
+
+} // anonymous namespace
+
+uint64_t LuaBytecodeCache::hashSource(const std::string& code) {
+    return fnv1a(reinterpret_cast<const uint8_t*>(code.data()), code.size());
+}
+
+uint64_t LuaBytecodeCache::interpreterStamp(lua_State* L) {
+    if (luaL_loadbuffer(L, "", 0, "=stamp") != LUA_OK) {
+        lua_pop(L, 1);
+        return 0;
+    }
+
+    std::vector<uint8_t> chunk;
+    bool dumped = dumpFunction(L, chunk);
+    lua_pop(L, 1);
+    return dumped ? fnv1a(chunk.data(), chunk.size()) ^ LUA_VERSION_NUM : 0;
+}
+
+bool LuaBytecodeCache::load(lua_State* L, const std::string& cachePath, uint64_t sourceHash,
+                            uint64_t stamp, const std::string& chunkName) {
+    MappedFile file;
+    if (stamp == 0 || !file.open(cachePath, MappedFile::Mode::ReadOnly) || file.size() < HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t* header = file.data();
+    uint64_t payloadSize = readLE<uint64_t>(header + 24);
+    if (readLE<uint32_t>(header) != MAGIC ||
+        readLE<uint16_t>(header + 4) != VERSION ||
+        readLE<uint64_t>(header + 8) != sourceHash ||
+        readLE<uint64_t>(header + 16) != stamp ||
+        payloadSize != file.size() - HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t* payload = header + HEADER_SIZE;
+    if (fnv1a(payload, payloadSize) != readLE<uint64_t>(header + 32)) {
+        return false;
+    }
+
+    if (luaL_loadbuffer(L, reinterpret_cast<const char*>(payload), payloadSize, chunkName.c_str()) != LUA_OK) {
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+
+bool LuaBytecodeCache::save(lua_State* L, const std::string& cachePath, uint64_t sourceHash, uint64_t stamp) {
+    std::vector<uint8_t> data(HEADER_SIZE);
+    if (stamp == 0 || !dumpFunction(L, data)) {
+        return false;
+    }
+
+    uint8_t* header = data.data();
+    uint64_t payloadSize = data.size() - HEADER_SIZE;
+    writeLE<uint32_t>(header, MAGIC);
+    writeLE<uint16_t>(header + 4, VERSION);
+    writeLE<uint16_t>(header + 6, 0);
+    writeLE<uint64_t>(header + 8, sourceHash);
+    writeLE<uint64_t>(header + 16, stamp);
+    writeLE<uint64_t>(header + 24, payloadSize);
+    writeLE<uint64_t>(header + 32, fnv1a(header + HEADER_SIZE, payloadSize));
+
+    std::error_code error;
+    fs::path target(cachePath);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), error);
+    }
+
+    fs::path temporary = target;
+    temporary += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            out.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace framework
+} // namespace shadow
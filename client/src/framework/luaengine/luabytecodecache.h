@@ -0,0 +1,50 @@
+/**
+ * Shadow OT Client - Lua Bytecode Cache
+ *
+ * Compiled chunks written to disk so later launches and module reloads
+ * skip the parse. The file is keyed on a hash of the script text and on
+ * a stamp of the interpreter that compiled it, and checksummed; any
+ * mismatch means the caller compiles from source and rewrites the cache.
+ *
+ *   header:  "SLBC" magic, u16 version, u16 reserved, u64 source FNV-1a,
+ *            u64 interpreter stamp, u64 payload size, u64 payload FNV-1a
+ *   payload: lua_dump output, with debug info so errors and the profiler
+ *            still see lines
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct lua_State;
+
+namespace shadow {
+namespace framework {
+
+class LuaBytecodeCache {
+public:
+    static constexpr uint32_t MAGIC = 0x43424C53; // "SLBC"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 40;
+
+    static uint64_t hashSource(const std::string& code);
+
+    // Hash of the bytecode header the running interpreter emits, which
+    // encodes its version, format and number sizes
+    static uint64_t interpreterStamp(lua_State* L);
+
+    // Push the chunk cached at cachePath if it was compiled from a source
+    // with this hash by this interpreter
+    static bool load(lua_State* L, const std::string& cachePath, uint64_t sourceHash,
+                     uint64_t stamp, const std::string& chunkName);
+
+    // Dump the function on top of the stack, leaving it there. Written to a
+    // temporary file and renamed into place, so clients starting at the
+    // same time never read a partial cache
+    static bool save(lua_State* L, const std::string& cachePath, uint64_t sourceHash, uint64_t stamp);
+};
+
+} // namespace framework
+} // namespace shadow
@@ -3,7 +3,14 @@
  */
 
 #include "luainterface.h"
+#include "luabytecodecache.h"
+#include "luaprofiler.h"
+#include <framework/core/memorytracker.h>
+#include <framework/core/profiler.h>
 #include <framework/core/resourcemanager.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 
 extern "C" {
@@ -17,6 +24,43 @@ namespace fs = std::filesystem;
 namespace shadow {
 namespace framework {
 
+namespace {
+
+double heapKB(lua_State* L) {
+    return lua_gc(L, LUA_GCCOUNT, 0) + lua_gc(L, LUA_GCCOUNTB, 0) / 1024.0;
+}
+
+// realloc, counted against MemoryTag::Lua. A null ptr means osize holds a
+// type tag, not a size.
+void* trackedAlloc(void*, void* ptr, size_t osize, size_t nsize) {
+    if (nsize == 0) {
+        if (ptr) g_memory.release(MemoryTag::Lua, osize);
+        std::free(ptr);
+        return nullptr;
+    }
+
+    void* block = std::realloc(ptr, nsize);
+    if (!block) return nullptr;
+    if (ptr) {
+        g_memory.resize(MemoryTag::Lua, osize, nsize);
+    } else {
+        g_memory.allocate(MemoryTag::Lua, nsize);
+    }
+    return block;
+}
+
+int panic(lua_State* L) {
+    const char* message = lua_tostring(L, -1);
+    std::fprintf(stderr, "Lua panic: %s\n", message ? message : "(error object is not a string)");
+    return 0;
+}
+
+double toMs(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // anonymous namespace
+
 LuaInterface& LuaInterface::instance() {
     static LuaInterface instance;
     return instance;
@@ -29,8 +73,15 @@ LuaInterface::~LuaInterface() {
 bool LuaInterface::init() {
     if (m_state) return true;
 
-    // Create Lua state
-    m_state = luaL_newstate();
+    // Create Lua state. 64-bit LuaJIT refuses custom allocators; its heap
+    // is then reported from the collector's count instead.
+    m_state = lua_newstate(trackedAlloc, nullptr);
+    m_countedAllocator = m_state != nullptr;
+    if (m_state) {
+        lua_atpanic(m_state, panic);
+    } else {
+        m_state = luaL_newstate();
+    }
     if (!m_state) {
         m_lastError = "Failed to create Lua state";
         return false;
@@ -42,6 +93,15 @@ bool LuaInterface::init() {
     // Register core bindings
     registerCoreBindings();
 
+    // Task errors land where call errors do
+    m_scheduler.init(m_state, [this](const std::string& error) {
+        m_lastError = error;
+        if (m_errorHandler) {
+            m_errorHandler(m_lastError);
+        }
+    });
+    m_scheduler.registerBindings();
+
     // Add default module paths
     addModulePath("modules");
     addModulePath("data/modules");
@@ -51,12 +111,17 @@ bool LuaInterface::init() {
 
 void LuaInterface::terminate() {
     if (m_state) {
+        g_luaProfiler.stop();
+        m_scheduler.terminate();
         lua_close(m_state);
         m_state = nullptr;
+        if (!m_countedAllocator) g_memory.setUsage(MemoryTag::Lua, 0);
     }
 
     m_loadedModules.clear();
-    m_classes.clear();
+    m_interpreterStamp = 0;
+    m_gcMode = GCMode::Automatic;
+    m_gcCycleActive = false;
 }
 
 void LuaInterface::setupStandardLibraries() {
@@ -134,20 +199,6 @@ void LuaInterface::registerCoreBindings() {
     });
     lua_setglobal(m_state, "import");
 
-    // Schedule function for delayed execution
-    lua_pushcfunction(m_state, [](lua_State* L) -> int {
-        if (!lua_isnumber(L, 1) || !lua_isfunction(L, 2)) {
-            lua_pushboolean(L, 0);
-            return 1;
-        }
-
-        // Store callback for later execution
-        // This would integrate with the event dispatcher
-        lua_pushboolean(L, 1);
-        return 1;
-    });
-    lua_setglobal(m_state, "scheduleEvent");
-
     // Add g_game, g_map bindings (placeholders for now)
     lua_newtable(m_state);
     lua_setglobal(m_state, "g_game");
@@ -170,8 +221,46 @@ bool LuaInterface::loadScript(const std::string& filename) {
         m_lastError = "Failed to read script: " + filename;
         return false;
     }
+    if (!m_state) {
+        m_lastError = "Lua state not initialized";
+        return false;
+    }
 
-    return runScript(content);
+    if (!loadChunk(content, filename)) {
+        return handleError(LUA_ERRSYNTAX);
+    }
+    g_luaProfiler.enter();
+    return handleError(lua_pcall(m_state, 0, LUA_MULTRET, 0));
+}
+
+bool LuaInterface::loadChunk(const std::string& code, const std::string& filename) {
+    // "@" marks the chunk name as a file, which errors and the profiler show
+    std::string chunkName = "@" + filename;
+    if (m_bytecodeCacheDirectory.empty()) {
+        return luaL_loadbuffer(m_state, code.data(), code.size(), chunkName.c_str()) == LUA_OK;
+    }
+
+    // The path hash keeps same-named scripts of different modules apart
+    fs::path scriptPath(filename);
+    char suffix[17];
+    std::snprintf(suffix, sizeof(suffix), "%016zx", std::hash<std::string>{}(scriptPath.lexically_normal().string()));
+    std::string cachePath = (fs::path(m_bytecodeCacheDirectory) / (scriptPath.stem().string() + "-" + suffix + ".luac")).string();
+
+    if (m_interpreterStamp == 0) {
+        m_interpreterStamp = LuaBytecodeCache::interpreterStamp(m_state);
+    }
+    uint64_t sourceHash = LuaBytecodeCache::hashSource(code);
+    if (LuaBytecodeCache::load(m_state, cachePath, sourceHash, m_interpreterStamp, chunkName)) {
+        m_bytecodeCacheStats.hits++;
+        return true;
+    }
+
+    if (luaL_loadbuffer(m_state, code.data(), code.size(), chunkName.c_str()) != LUA_OK) {
+        return false;
+    }
+    m_bytecodeCacheStats.compiled++;
+    LuaBytecodeCache::save(m_state, cachePath, sourceHash, m_interpreterStamp);
+    return true;
 }
 
 bool LuaInterface::runScript(const std::string& code) {
@@ -180,6 +269,7 @@ bool LuaInterface::runScript(const std::string& code) {
         return false;
     }
 
+    g_luaProfiler.enter();
     int result = luaL_dostring(m_state, code.c_str());
     return handleError(result);
 }
@@ -299,6 +389,7 @@ bool LuaInterface::callFunction(const std::string& name, int nargs, int nresults
         lua_insert(m_state, -(nargs + 1));
     }
 
+    g_luaProfiler.enter();
     int result = lua_pcall(m_state, nargs, nresults, 0);
     return handleError(result);
 }
@@ -333,6 +424,7 @@ bool LuaInterface::callMethod(const std::string& objName, const std::string& met
     // Remove the original table reference
     lua_remove(m_state, -(nargs + 2));
 
+    g_luaProfiler.enter();
     int result = lua_pcall(m_state, nargs + 1, nresults, 0);
     return handleError(result);
 }
@@ -400,6 +492,100 @@ void LuaInterface::registerWidgetCallback(const std::string& widgetType, const s
     // This would be called when widgets emit events
 }
 
+LuaInterface::GCMode LuaInterface::setGCMode(GCMode mode) {
+    if (!m_state) return m_gcMode;
+
+#ifdef LUA_GCGEN
+    if (mode == GCMode::Generational) {
+        lua_gc(m_state, LUA_GCGEN, 0, 0);
+    } else {
+        lua_gc(m_state, LUA_GCINC, 0, 0, 0);
+    }
+#else
+    if (mode == GCMode::Generational) {
+        mode = GCMode::Incremental;
+    }
+#endif
+
+    if (mode == GCMode::Automatic) {
+        lua_gc(m_state, LUA_GCRESTART, 0);
+    } else {
+        lua_gc(m_state, LUA_GCSTOP, 0);
+    }
+
+    m_gcMode = mode;
+    m_gcCycleActive = false;
+    m_gcStats.heapKB = heapKB(m_state);
+    m_gcStats.dueKB = m_gcStats.heapKB * (mode == GCMode::Generational ? GC_GENERATIONAL_PAUSE : GC_INCREMENTAL_PAUSE);
+    m_gcWindowStart = std::chrono::steady_clock::now();
+    return mode;
+}
+
+void LuaInterface::collectGarbage(double budgetMs) {
+    if (!m_state) return;
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    if (start - m_gcWindowStart >= std::chrono::seconds(1)) {
+        m_gcStats.windowPauseMs = m_gcWindowPauseMs;
+        m_gcWindowPauseMs = 0.0;
+        m_gcWindowStart = start;
+    }
+
+    double heap = heapKB(m_state);
+    if (m_gcMode != GCMode::Automatic && (m_gcCycleActive || heap >= m_gcStats.dueKB)) {
+        ProfileScope scope(Profiler::StageLuaGC);
+        bool generational = m_gcMode == GCMode::Generational;
+        bool forced = heap >= m_gcStats.dueKB * GC_FORCE_RATIO;
+        m_gcCycleActive = true;
+
+        // In generational mode each step is a whole minor collection
+        double elapsedMs = 0.0;
+        double longestMs = 0.0;
+        int steps = 0;
+        while (elapsedMs + m_gcStepEstimateMs <= budgetMs || (forced && steps == 0)) {
+            Clock::time_point stepStart = Clock::now();
+            bool finished = lua_gc(m_state, LUA_GCSTEP, generational ? 0 : GC_STEP_KB) != 0 || generational;
+            double stepMs = toMs(Clock::now() - stepStart);
+
+            // Smooth, but let a slow step raise the estimate at once
+            m_gcStepEstimateMs = std::max(stepMs, m_gcStepEstimateMs * 0.9 + stepMs * 0.1);
+            longestMs = std::max(longestMs, stepMs);
+            elapsedMs += stepMs;
+            steps++;
+
+            if (finished) {
+                m_gcCycleActive = false;
+                m_gcStats.cycles++;
+                m_gcStats.dueKB = heapKB(m_state) * (generational ? GC_GENERATIONAL_PAUSE : GC_INCREMENTAL_PAUSE);
+                break;
+            }
+        }
+
+        // A step re-arms the automatic collector under Lua 5.1 and LuaJIT
+        lua_gc(m_state, LUA_GCSTOP, 0);
+
+        if (steps > 0) {
+            m_gcStats.steps += steps;
+            m_gcStats.lastPauseMs = longestMs;
+            m_gcStats.worstPauseMs = std::max(m_gcStats.worstPauseMs, longestMs);
+            m_gcWindowPauseMs = std::max(m_gcWindowPauseMs, longestMs);
+            if (elapsedMs > budgetMs) {
+                m_gcStats.forcedFrames++;
+            }
+        }
+        heap = heapKB(m_state);
+    }
+
+    m_gcStats.heapKB = heap;
+    if (!m_countedAllocator) {
+        g_memory.setUsage(MemoryTag::Lua, static_cast<size_t>(heap * 1024.0));
+    }
+    m_gcStats.peakHeapKB = std::max(m_gcStats.peakHeapKB, heap);
+    g_profiler.setGauge(Profiler::GaugeLuaHeapKB, static_cast<float>(heap));
+    g_profiler.setGauge(Profiler::GaugeLuaGCPauseMs, static_cast<float>(std::max(m_gcStats.windowPauseMs, m_gcWindowPauseMs)));
+}
+
 bool LuaInterface::handleError(int result) {
     if (result != LUA_OK) {
         m_lastError = lua_tostring(m_state, -1);
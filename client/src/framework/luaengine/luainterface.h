@@ -1,17 +1,19 @@
 /**
  * Shadow OT Client - Lua Interface
  *
- * LuaJIT integration for scripting and module support.
+ * LuaJIT integration for scripting and module support. Scripts that wait
+ * on time or engine events run as coroutine tasks (see luascheduler.h).
  */
 
 #pragma once
 
+#include "luascheduler.h"
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <functional>
 #include <memory>
-#include <map>
-#include <any>
 
 struct lua_State;
 
@@ -30,21 +32,32 @@ public:
     bool runScript(const std::string& code);
     bool loadModules(const std::string& modulePath);
 
-    // Global functions
-    template<typename Func>
-    void registerGlobalFunction(const std::string& name, Func func);
+    // With a directory set, scripts loaded from files are also kept there
+    // compiled, so later launches and reloads skip the parse
+    void setBytecodeCacheDirectory(const std::string& directory) { m_bytecodeCacheDirectory = directory; }
+    const std::string& getBytecodeCacheDirectory() const { return m_bytecodeCacheDirectory; }
 
-    // Class registration
-    template<typename T>
-    void registerClass();
+    struct BytecodeCacheStats {
+        uint32_t hits{0};
+        uint32_t compiled{0};
+    };
+    const BytecodeCacheStats& getBytecodeCacheStats() const { return m_bytecodeCacheStats; }
 
-    template<typename T, typename Func>
-    void bindClassMemberFunction(const std::string& name, Func func);
+    // Native functions and members, each bound through its own generated
+    // trampoline (see luabinder.h, which defines these)
+    template<auto Function>
+    void registerGlobalFunction(const std::string& name);
 
     template<typename T>
-    void bindClassProperty(const std::string& name,
-                          std::function<std::any(T*)> getter,
-                          std::function<void(T*, std::any)> setter = nullptr);
+    void registerClass(const std::string& name);
+
+    // T overrides the class a member is bound on, for inherited members
+    template<auto Method, typename T = void>
+    void bindClassMemberFunction(const std::string& name);
+
+    // The getter under name, the setter under "set" + Name
+    template<auto Getter, auto Setter = nullptr, typename T = void>
+    void bindClassProperty(const std::string& name);
 
     // Value manipulation
     void pushValue(bool value);
@@ -76,6 +89,37 @@ public:
     bool callMethod(const std::string& objName, const std::string& methodName,
                    int nargs = 0, int nresults = 0);
 
+    // Garbage collection. Outside Automatic the collector no longer runs
+    // on allocation; collectGarbage runs it once per frame instead, in the
+    // idle time the frame pacer leaves, and steps without idle time only
+    // once the heap is well past the point a collection was due.
+    // Generational needs Lua 5.4 and falls back to Incremental elsewhere.
+    enum class GCMode { Automatic, Incremental, Generational };
+    static constexpr int GC_STEP_KB = 64;
+    static constexpr double GC_INCREMENTAL_PAUSE = 2.0;    // Heap growth that starts a cycle
+    static constexpr double GC_GENERATIONAL_PAUSE = 1.2;   // Heap growth that runs a minor collection
+    static constexpr double GC_FORCE_RATIO = 1.5;          // Past the due point, step without idle time
+
+    GCMode setGCMode(GCMode mode);
+    GCMode getGCMode() const { return m_gcMode; }
+    void collectGarbage(double budgetMs);
+
+    struct GCStats {
+        double heapKB{0.0};
+        double peakHeapKB{0.0};
+        double dueKB{0.0};              // Heap size that starts the next collection
+        double lastPauseMs{0.0};        // Longest single step of the last frame that stepped
+        double worstPauseMs{0.0};
+        double windowPauseMs{0.0};      // Longest step over the last second
+        uint64_t steps{0};
+        uint64_t cycles{0};
+        uint64_t forcedFrames{0};       // Frames that stepped past their idle budget
+    };
+    const GCStats& getGCStats() const { return m_gcStats; }
+
+    // Coroutine tasks; call getScheduler().update() once per frame
+    LuaScheduler& getScheduler() { return m_scheduler; }
+
     // Error handling
     const std::string& getLastError() const { return m_lastError; }
     void setErrorHandler(std::function<void(const std::string&)> handler);
@@ -107,20 +151,26 @@ private:
     void setupStandardLibraries();
     void registerCoreBindings();
     bool handleError(int result);
+    bool loadChunk(const std::string& code, const std::string& filename);
 
     lua_State* m_state{nullptr};
+    bool m_countedAllocator{false};     // Allocations reach g_memory directly
     std::string m_lastError;
     std::function<void(const std::string&)> m_errorHandler;
     std::vector<std::string> m_modulePaths;
     std::vector<std::string> m_loadedModules;
-
-    // Class metadata storage
-    struct ClassMeta {
-        std::string name;
-        std::map<std::string, std::any> methods;
-        std::map<std::string, std::pair<std::any, std::any>> properties;
-    };
-    std::map<std::string, ClassMeta> m_classes;
+    std::string m_bytecodeCacheDirectory;
+    uint64_t m_interpreterStamp{0};
+    BytecodeCacheStats m_bytecodeCacheStats;
+
+    GCMode m_gcMode{GCMode::Automatic};
+    bool m_gcCycleActive{false};
+    double m_gcStepEstimateMs{0.1};
+    double m_gcWindowPauseMs{0.0};
+    std::chrono::steady_clock::time_point m_gcWindowStart;
+    GCStats m_gcStats;
+
+    LuaScheduler m_scheduler;
 };
 
 } // namespace framework
@@ -0,0 +1,380 @@
+/**
+ * Shadow OT Client - Lua Profiler Implementation
+ */
+
+#include "luaprofiler.h"
+#include <framework/graphics/graphics.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+constexpr int OVERLAY_FONT_SIZE = 11;
+constexpr int OVERLAY_LINE_HEIGHT = 14;
+constexpr int OVERLAY_WIDTH = 300;
+constexpr size_t OVERLAY_MODULES = 8;
+
+double usSince(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+// "@modules/game_battle/battle.lua" -> "game_battle"; files elsewhere
+// count under their own name, chunks run from strings as "(string)"
+std::string moduleName(const char* source) {
+    if (!source || source[0] != '@') {
+        return source && source[0] == '=' ? "" : "(string)";
+    }
+
+    std::string path(source + 1);
+    std::replace(path.begin(), path.end(), '\\', '/');
+    size_t modules = path.rfind("modules/");
+    if (modules != std::string::npos && (modules == 0 || path[modules - 1] == '/')) {
+        size_t start = modules + 8;
+        size_t end = path.find('/', start);
+        if (end != std::string::npos) {
+            return path.substr(start, end - start);
+        }
+    }
+
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+} // anonymous namespace
+
+LuaProfiler& LuaProfiler::instance() {
+    static LuaProfiler instance;
+    return instance;
+}
+
+bool LuaProfiler::start(lua_State* L, int sampleInterval) {
+    if (!L) return false;
+    if (m_state) stop();
+
+    m_state = L;
+    if (m_nodes.empty()) {
+        m_nodes.emplace_back();
+    }
+    setJit(false);
+    resetBaseline();
+    m_windowStart = Clock::now();
+    lua_sethook(L, &LuaProfiler::hook, LUA_MASKCOUNT, std::max(sampleInterval, 1));
+    return true;
+}
+
+void LuaProfiler::stop() {
+    if (!m_state) return;
+
+    lua_sethook(m_state, nullptr, 0, 0);
+    setJit(true);
+    m_state = nullptr;
+}
+
+void LuaProfiler::setJit(bool enabled) {
+    // Only LuaJIT has a jit table; plain Lua ignores this
+    luaL_dostring(m_state, enabled ? "if jit then jit.on() end" : "if jit then jit.off() jit.flush() end");
+}
+
+void LuaProfiler::hook(lua_State* L, lua_Debug* ar) {
+    instance().sample(L);
+}
+
+void LuaProfiler::resetBaseline() {
+    m_lastSample = Clock::now();
+    m_lastHeapKB = heapKB();
+}
+
+double LuaProfiler::heapKB() const {
+    return lua_gc(m_state, LUA_GCCOUNT, 0) + lua_gc(m_state, LUA_GCCOUNTB, 0) / 1024.0;
+}
+
+void LuaProfiler::sample(lua_State* L) {
+    if (L != m_state) return;
+
+    Clock::time_point now = Clock::now();
+    double us = usSince(m_lastSample, now);
+    double heap = heapKB();
+    double allocKB = std::max(heap - m_lastHeapKB, 0.0);
+    m_lastSample = now;
+    m_lastHeapKB = heap;
+
+    // Innermost first
+    uint32_t stack[MAX_STACK_DEPTH];
+    int depth = 0;
+    lua_Debug ar;
+    for (int level = 0; depth < MAX_STACK_DEPTH && lua_getstack(L, level, &ar); ++level) {
+        if (!lua_getinfo(L, "Sn", &ar)) break;
+        stack[depth++] = internFrame(ar);
+    }
+    if (depth == 0) return;
+
+    uint64_t sampleId = ++m_sampleCount;
+    uint32_t module = NO_MODULE;
+    for (int i = 0; i < depth; ++i) {
+        Frame& frame = m_frames[stack[i]];
+        if (frame.lastSample != sampleId) {
+            frame.lastSample = sampleId;
+            frame.totalUs += us;
+        }
+        if (module == NO_MODULE) {
+            module = frame.module;
+        }
+    }
+
+    Frame& leaf = m_frames[stack[0]];
+    leaf.selfUs += us;
+    leaf.allocKB += allocKB;
+    leaf.samples++;
+
+    if (module != NO_MODULE) {
+        Module& owner = m_modules[module];
+        owner.totalUs += us;
+        owner.frameUs += us;
+        owner.allocKB += allocKB;
+        owner.samples++;
+    }
+
+    uint32_t node = 0;
+    for (int i = depth; i-- > 0;) {
+        node = childOf(node, stack[i]);
+    }
+    m_nodes[node].selfUs += us;
+}
+
+uint32_t LuaProfiler::internFrame(const lua_Debug& ar) {
+    // Sources and names are interned Lua strings, stable while their
+    // chunk lives; C functions all share one source, so go by name
+    bool native = ar.what && std::strcmp(ar.what, "C") == 0;
+    FrameKey key{native ? static_cast<const void*>(ar.name) : ar.source, native ? -2 : ar.linedefined};
+    auto it = m_frameIndex.find(key);
+    if (it != m_frameIndex.end()) {
+        return it->second;
+    }
+
+    Frame frame;
+    char name[256];
+    if (native) {
+        std::snprintf(name, sizeof(name), "[C] %s", ar.name ? ar.name : "?");
+    } else if (ar.what && std::strcmp(ar.what, "main") == 0) {
+        std::snprintf(name, sizeof(name), "main chunk (%s)", ar.short_src);
+    } else {
+        std::snprintf(name, sizeof(name), "%s (%s:%d)", ar.name ? ar.name : "?", ar.short_src, ar.linedefined);
+    }
+    frame.name = name;
+    frame.module = internModule(ar.source);
+
+    uint32_t index = static_cast<uint32_t>(m_frames.size());
+    m_frames.push_back(std::move(frame));
+    m_frameIndex.emplace(key, index);
+    return index;
+}
+
+uint32_t LuaProfiler::internModule(const char* source) {
+    std::string name = moduleName(source);
+    if (name.empty()) {
+        return NO_MODULE;       // C functions count toward their Lua caller
+    }
+
+    auto it = m_moduleIndex.find(name);
+    if (it != m_moduleIndex.end()) {
+        return it->second;
+    }
+
+    uint32_t index = static_cast<uint32_t>(m_modules.size());
+    Module module;
+    module.name = name;
+    m_modules.push_back(std::move(module));
+    m_moduleIndex.emplace(std::move(name), index);
+    return index;
+}
+
+uint32_t LuaProfiler::childOf(uint32_t node, uint32_t frame) {
+    auto it = m_nodes[node].children.find(frame);
+    if (it != m_nodes[node].children.end()) {
+        return it->second;
+    }
+
+    uint32_t child = static_cast<uint32_t>(m_nodes.size());
+    m_nodes[node].children.emplace(frame, child);
+    m_nodes.emplace_back();
+    m_nodes.back().frame = frame;
+    return child;
+}
+
+void LuaProfiler::beginFrame() {
+    for (Module& module : m_modules) {
+        module.frameUs = 0.0;
+    }
+}
+
+void LuaProfiler::endFrame() {
+    if (!m_state) return;
+
+    Clock::time_point now = Clock::now();
+    for (Module& module : m_modules) {
+        double ms = module.frameUs / 1000.0;
+        module.windowUs += module.frameUs;
+        module.frameUs = 0.0;
+        module.worstFrameMs = std::max(module.worstFrameMs, ms);
+
+        if (ms <= m_frameBudgetMs) continue;
+        module.overBudgetFrames++;
+        if (m_budgetCallback && (module.lastWarning == Clock::time_point{} ||
+            std::chrono::duration<double>(now - module.lastWarning).count() >= WARNING_INTERVAL)) {
+            module.lastWarning = now;
+            m_budgetCallback(module.name, ms, module.overBudgetFrames);
+        }
+    }
+
+    double windowSeconds = std::chrono::duration<double>(now - m_windowStart).count();
+    if (windowSeconds >= SUMMARY_INTERVAL) {
+        for (Module& module : m_modules) {
+            module.msPerSecond = module.windowUs / 1000.0 / windowSeconds;
+            module.windowUs = 0.0;
+        }
+        m_windowStart = now;
+    }
+}
+
+std::vector<LuaProfiler::ModuleStats> LuaProfiler::getTopModules(size_t count) const {
+    std::vector<ModuleStats> result;
+    result.reserve(m_modules.size());
+    for (const Module& module : m_modules) {
+        ModuleStats stats;
+        stats.name = module.name;
+        stats.cpuMs = module.totalUs / 1000.0;
+        stats.allocKB = module.allocKB;
+        stats.msPerSecond = module.msPerSecond;
+        stats.worstFrameMs = module.worstFrameMs;
+        stats.samples = module.samples;
+        stats.overBudgetFrames = module.overBudgetFrames;
+        result.push_back(std::move(stats));
+    }
+
+    std::sort(result.begin(), result.end(), [](const ModuleStats& a, const ModuleStats& b) {
+        return a.msPerSecond != b.msPerSecond ? a.msPerSecond > b.msPerSecond : a.cpuMs > b.cpuMs;
+    });
+    if (result.size() > count) result.resize(count);
+    return result;
+}
+
+std::vector<LuaProfiler::FunctionStats> LuaProfiler::getTopFunctions(size_t count) const {
+    std::vector<const Frame*> frames;
+    frames.reserve(m_frames.size());
+    for (const Frame& frame : m_frames) {
+        if (frame.samples > 0 || frame.totalUs > 0.0) frames.push_back(&frame);
+    }
+
+    size_t kept = std::min(count, frames.size());
+    std::partial_sort(frames.begin(), frames.begin() + kept, frames.end(),
+                      [](const Frame* a, const Frame* b) { return a->selfUs > b->selfUs; });
+
+    std::vector<FunctionStats> result;
+    result.reserve(kept);
+    for (size_t i = 0; i < kept; ++i) {
+        const Frame& frame = *frames[i];
+        FunctionStats stats;
+        stats.name = frame.name;
+        stats.module = frame.module != NO_MODULE ? m_modules[frame.module].name : "";
+        stats.selfMs = frame.selfUs / 1000.0;
+        stats.totalMs = frame.totalUs / 1000.0;
+        stats.allocKB = frame.allocKB;
+        stats.samples = frame.samples;
+        result.push_back(std::move(stats));
+    }
+    return result;
+}
+
+bool LuaProfiler::exportFlameGraph(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Depth-first over the call tree; folded format has no spaces or
+    // semicolons inside frame names
+    auto frameName = [this](uint32_t frame) {
+        std::string name = m_frames[frame].name;
+        for (char& c : name) {
+            if (c == ';') c = ':';
+            else if (c == ' ') c = '_';
+        }
+        return name;
+    };
+
+    std::vector<std::pair<uint32_t, std::string>> pending;
+    if (!m_nodes.empty()) {
+        pending.emplace_back(0, std::string());
+    }
+    while (!pending.empty()) {
+        auto [index, path] = std::move(pending.back());
+        pending.pop_back();
+
+        const Node& node = m_nodes[index];
+        if (index != 0 && node.selfUs >= 1.0) {
+            file << path << ' ' << static_cast<uint64_t>(node.selfUs) << '\n';
+        }
+        for (const auto& [frame, child] : node.children) {
+            pending.emplace_back(child, path.empty() ? frameName(frame) : path + ';' + frameName(frame));
+        }
+    }
+    return file.good();
+}
+
+void LuaProfiler::drawOverlay(int x, int y) {
+    if (!m_overlayVisible) return;
+
+    std::vector<ModuleStats> top = getTopModules(OVERLAY_MODULES);
+    int lines = 2 + static_cast<int>(std::max<size_t>(top.size(), 1));
+    g_graphics.drawFilledRect(Rect(x, y, OVERLAY_WIDTH, lines * OVERLAY_LINE_HEIGHT + 8), Color(0, 0, 0, 180));
+
+    char line[128];
+    int textX = x + 6;
+    int textY = y + 4;
+    auto text = [&](const Color& color) {
+        g_graphics.drawText(line, textX, textY, color, OVERLAY_FONT_SIZE);
+        textY += OVERLAY_LINE_HEIGHT;
+    };
+
+    std::snprintf(line, sizeof(line), "lua %s  budget %.1f ms/frame", m_state ? "sampling" : "stopped", m_frameBudgetMs);
+    text(Color::white());
+    std::snprintf(line, sizeof(line), "%-16s %7s %7s %8s", "module", "ms/s", "worst", "alloc kb");
+    text(Color(160, 160, 160));
+
+    if (top.empty()) {
+        std::snprintf(line, sizeof(line), "no samples");
+        text(Color(200, 220, 255));
+    }
+    for (const ModuleStats& module : top) {
+        std::snprintf(line, sizeof(line), "%-16.16s %7.2f %7.2f %8.0f",
+                      module.name.c_str(), module.msPerSecond, module.worstFrameMs, module.allocKB);
+        text(module.worstFrameMs > m_frameBudgetMs ? Color(220, 200, 64) : Color(200, 220, 255));
+    }
+}
+
+void LuaProfiler::clear() {
+    m_frames.clear();
+    m_frameIndex.clear();
+    m_modules.clear();
+    m_moduleIndex.clear();
+    m_nodes.clear();
+    m_nodes.emplace_back();
+    m_sampleCount = 0;
+    m_windowStart = Clock::now();
+}
+
+// Global instance inside the namespace
+LuaProfiler& g_luaProfiler = LuaProfiler::instance();
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,180 @@
+/**
+ * Shadow OT Client - Lua Profiler
+ *
+ * Sampling profiler for scripts. A count hook fires every few thousand
+ * VM instructions and charges the time and heap growth since the last
+ * sample to the Lua call stack at that point. Samples are attributed to
+ * functions and to the module each function was loaded from (the
+ * directory under modules/), and build a call tree that exports as
+ * folded stacks for flamegraph.pl, speedscope or Perfetto.
+ *
+ * Per frame, a module that accounts for more than the frame budget raises
+ * a warning callback, rate-limited per module. The overlay lists the modules
+ * using the most CPU over the last second.
+ *
+ * Under LuaJIT the JIT is switched off while profiling, since compiled
+ * traces never call hooks. Allocations are heap growth between samples,
+ * so a collection in between undercounts that interval.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+struct lua_Debug;
+
+namespace shadow {
+namespace framework {
+
+class LuaProfiler {
+public:
+    static LuaProfiler& instance();
+
+    static constexpr int DEFAULT_SAMPLE_INTERVAL = 1000;     // VM instructions
+    static constexpr int MAX_STACK_DEPTH = 32;
+    static constexpr double DEFAULT_FRAME_BUDGET_MS = 2.0;
+    static constexpr double SUMMARY_INTERVAL = 1.0;         // Seconds per live window
+    static constexpr double WARNING_INTERVAL = 5.0;         // Seconds between warnings per module
+
+    struct ModuleStats {
+        std::string name;
+        double cpuMs{0.0};
+        double allocKB{0.0};
+        double msPerSecond{0.0};        // Over the last live window
+        double worstFrameMs{0.0};
+        uint64_t samples{0};
+        uint32_t overBudgetFrames{0};
+    };
+
+    struct FunctionStats {
+        std::string name;               // "function (source:line)"
+        std::string module;
+        double selfMs{0.0};
+        double totalMs{0.0};            // Including callees
+        double allocKB{0.0};
+        uint64_t samples{0};
+    };
+
+    bool start(lua_State* L, int sampleInterval = DEFAULT_SAMPLE_INTERVAL);
+    void stop();
+    bool isRunning() const { return m_state != nullptr; }
+
+    // C++ calling into Lua; time since the last sample was spent outside
+    // the VM and is not charged
+    void enter() {
+        if (m_state) resetBaseline();
+    }
+
+    // Bracket one iteration of the main loop
+    void beginFrame();
+    void endFrame();
+
+    void setFrameBudget(double ms) { m_frameBudgetMs = ms; }
+    double getFrameBudget() const { return m_frameBudgetMs; }
+
+    // From endFrame(), for a module over the budget this frame
+    using BudgetCallback = std::function<void(const std::string& module, double ms, uint32_t framesOver)>;
+    void setBudgetCallback(BudgetCallback callback) { m_budgetCallback = std::move(callback); }
+
+    // Busiest first: modules by the live window, then by total time;
+    // functions by self time
+    std::vector<ModuleStats> getTopModules(size_t count) const;
+    std::vector<FunctionStats> getTopFunctions(size_t count) const;
+
+    // One "outer;...;inner microseconds" line per call path
+    bool exportFlameGraph(const std::string& filename) const;
+
+    void setOverlayVisible(bool visible) { m_overlayVisible = visible; }
+    bool isOverlayVisible() const { return m_overlayVisible; }
+    void drawOverlay(int x, int y);
+
+    void clear();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint32_t NO_MODULE = UINT32_MAX;
+
+    LuaProfiler() = default;
+    ~LuaProfiler() = default;
+    LuaProfiler(const LuaProfiler&) = delete;
+    LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+    struct Frame {
+        std::string name;
+        uint32_t module{NO_MODULE};
+        double selfUs{0.0};
+        double totalUs{0.0};
+        double allocKB{0.0};
+        uint64_t samples{0};
+        uint64_t lastSample{0};         // Counts recursion once per sample
+    };
+
+    struct Module {
+        std::string name;
+        double totalUs{0.0};
+        double allocKB{0.0};
+        double frameUs{0.0};
+        double windowUs{0.0};
+        double msPerSecond{0.0};
+        double worstFrameMs{0.0};
+        uint64_t samples{0};
+        uint32_t overBudgetFrames{0};
+        Clock::time_point lastWarning{};
+    };
+
+    // Call tree; node 0 is the root
+    struct Node {
+        uint32_t frame{0};
+        double selfUs{0.0};
+        std::unordered_map<uint32_t, uint32_t> children;
+    };
+
+    struct FrameKey {
+        const void* source;
+        int line;
+        bool operator==(const FrameKey& other) const { return source == other.source && line == other.line; }
+    };
+    struct FrameKeyHash {
+        size_t operator()(const FrameKey& key) const {
+            return std::hash<const void*>()(key.source) ^ (static_cast<size_t>(key.line) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    static void hook(lua_State* L, lua_Debug* ar);
+    void sample(lua_State* L);
+    void resetBaseline();
+    double heapKB() const;
+    uint32_t internFrame(const lua_Debug& ar);
+    uint32_t internModule(const char* source);
+    uint32_t childOf(uint32_t node, uint32_t frame);
+    void setJit(bool enabled);
+
+    lua_State* m_state{nullptr};
+    Clock::time_point m_lastSample;
+    double m_lastHeapKB{0.0};
+    uint64_t m_sampleCount{0};
+
+    std::vector<Frame> m_frames;
+    std::unordered_map<FrameKey, uint32_t, FrameKeyHash> m_frameIndex;
+    std::vector<Module> m_modules;
+    std::unordered_map<std::string, uint32_t> m_moduleIndex;
+    std::vector<Node> m_nodes;
+
+    double m_frameBudgetMs{DEFAULT_FRAME_BUDGET_MS};
+    BudgetCallback m_budgetCallback;
+    Clock::time_point m_windowStart;
+    bool m_overlayVisible{false};
+};
+
+// Global accessor inside namespace
+extern LuaProfiler& g_luaProfiler;
+
+} // namespace framework
+} // namespace shadow
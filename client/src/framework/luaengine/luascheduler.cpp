@@ -0,0 +1,476 @@
+/**
+ * Shadow OT Client - Lua Scheduler Implementation
+ */
+
+#include "luascheduler.h"
+#include "luaprofiler.h"
+#include <framework/core/profiler.h>
+#include <algorithm>
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+double toMs(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// lua_resume across 5.1/LuaJIT, 5.2-5.3 and 5.4; nresults is what the
+// thread yielded or returned
+int resumeThread(lua_State* thread, lua_State* from, int nargs, int& nresults) {
+#if LUA_VERSION_NUM >= 504
+    return lua_resume(thread, from, nargs, &nresults);
+#elif LUA_VERSION_NUM >= 502
+    int status = lua_resume(thread, from, nargs);
+    nresults = lua_gettop(thread);
+    return status;
+#else
+    (void)from;
+    int status = lua_resume(thread, nargs);
+    nresults = lua_gettop(thread);
+    return status;
+#endif
+}
+
+void removeWaiter(std::vector<LuaScheduler::TaskId>& waiters, LuaScheduler::TaskId id) {
+    auto it = std::find(waiters.begin(), waiters.end(), id);
+    if (it != waiters.end()) waiters.erase(it);
+}
+
+} // anonymous namespace
+
+void LuaScheduler::init(lua_State* L, ErrorHandler errorHandler) {
+    m_state = L;
+    m_errorHandler = std::move(errorHandler);
+    m_epoch = Clock::now();
+}
+
+void LuaScheduler::terminate() {
+    // Threads and results are anchored in the registry and go with the state
+    m_tasks.clear();
+    m_ready.clear();
+    m_timers.clear();
+    m_eventWaiters.clear();
+    for (auto& waiters : m_packetWaiters) {
+        waiters.clear();
+    }
+    m_futures.clear();
+    m_current = 0;
+    m_state = nullptr;
+}
+
+void LuaScheduler::registerBindings() {
+    const std::pair<const char*, lua_CFunction> functions[] = {
+        {"spawn", luaSpawn},
+        {"scheduleEvent", luaScheduleEvent},
+        {"killTask", luaKillTask},
+        {"removeEvent", luaKillTask},
+        {"wait", luaWait},
+        {"waitFor", luaWaitFor},
+        {"waitPacket", luaWaitPacket},
+        {"waitPath", luaWaitPath},
+        {"signal", luaSignal},
+    };
+
+    for (const auto& [name, function] : functions) {
+        lua_pushlightuserdata(m_state, this);
+        lua_pushcclosure(m_state, function, 1);
+        lua_setglobal(m_state, name);
+    }
+}
+
+void LuaScheduler::update() {
+    if (!m_state || m_tasks.empty()) {
+        m_lastUpdateMs = 0.0;
+        return;
+    }
+
+    ProfileScope scope(Profiler::StageLuaTasks);
+    Clock::time_point start = Clock::now();
+
+    // Delays end, and timeouts give up on their event or packet
+    m_timers.runExpired(toMs(start - m_epoch), [this](TimerQueue<TaskId>::Handle, TaskId id) {
+        auto it = m_tasks.find(id);
+        if (it == m_tasks.end()) return -1.0;
+
+        Task& task = it->second;
+        task.timer = 0;
+        if (task.wait == Wait::Delay) {
+            wake(id, task, 0);
+        } else {
+            dropWait(id, task);
+            lua_pushboolean(task.thread, 0);
+            wake(id, task, 1);
+        }
+        return -1.0;
+    });
+
+    // Tasks woken while this pass runs wait for the next frame, and at
+    // least one task runs per frame however slow it is
+    size_t pending = m_ready.size();
+    size_t resumed = 0;
+    while (pending > 0 && !m_ready.empty()) {
+        if (resumed > 0 && toMs(Clock::now() - start) >= m_frameBudgetMs) {
+            m_deferredFrames++;
+            break;
+        }
+
+        TaskId id = m_ready.front();
+        m_ready.pop_front();
+        pending--;
+        if (resume(id)) resumed++;
+    }
+
+    m_resumed += resumed;
+    m_lastUpdateMs = toMs(Clock::now() - start);
+    g_profiler.setGauge(Profiler::GaugeLuaTasks, static_cast<float>(m_tasks.size()));
+}
+
+size_t LuaScheduler::signal(std::string_view event, const PushResults& push) {
+    auto it = m_eventWaiters.find(event);
+    if (it == m_eventWaiters.end()) return 0;
+
+    std::vector<TaskId> waiters = std::move(it->second);
+    m_eventWaiters.erase(it);
+    wakeAll(waiters, push);
+    return waiters.size();
+}
+
+size_t LuaScheduler::signalPacket(uint8_t opcode, const uint8_t* payload, size_t size) {
+    if (m_packetWaiters[opcode].empty()) return 0;
+
+    std::vector<TaskId> waiters;
+    waiters.swap(m_packetWaiters[opcode]);
+    wakeAll(waiters, [payload, size](lua_State* thread) {
+        lua_pushlstring(thread, reinterpret_cast<const char*>(payload), size);
+        return 1;
+    });
+    return waiters.size();
+}
+
+LuaScheduler::FutureId LuaScheduler::createFuture() {
+    FutureId id = m_nextFutureId++;
+    m_futures.emplace(id, Future{});
+    return id;
+}
+
+void LuaScheduler::completeFuture(FutureId future, const PushResults& push) {
+    auto it = m_futures.find(future);
+    if (!m_state || it == m_futures.end() || it->second.completed) return;
+
+    Future& f = it->second;
+    if (f.abandoned) {
+        m_futures.erase(it);
+        return;
+    }
+
+    if (f.waiter) {
+        TaskId id = f.waiter;
+        m_futures.erase(it);
+
+        Task& task = m_tasks.at(id);
+        task.future = 0;
+        wake(id, task, push(task.thread));
+        return;
+    }
+
+    // Nobody waits yet; keep the results as a table
+    int top = lua_gettop(m_state);
+    int count = push(m_state);
+    lua_createtable(m_state, count, 0);
+    lua_insert(m_state, top + 1);
+    for (int i = count; i >= 1; i--) {
+        lua_rawseti(m_state, top + 1, i);
+    }
+    f.results = luaL_ref(m_state, LUA_REGISTRYINDEX);
+    f.resultCount = count;
+    f.completed = true;
+}
+
+bool LuaScheduler::killTask(TaskId id) {
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end()) return false;
+
+    if (id == m_current) {
+        it->second.killed = true;
+    } else {
+        release(id);
+    }
+    return true;
+}
+
+LuaScheduler::Stats LuaScheduler::getStats() const {
+    Stats stats;
+    stats.tasks = m_tasks.size();
+    for (const auto& [id, task] : m_tasks) {
+        if (task.ready) {
+            stats.ready++;
+        } else if (task.wait == Wait::Delay) {
+            stats.sleeping++;
+        } else if (task.wait != Wait::None) {
+            stats.waiting++;
+        }
+    }
+    stats.resumed = m_resumed;
+    stats.deferredFrames = m_deferredFrames;
+    stats.lastUpdateMs = m_lastUpdateMs;
+    return stats;
+}
+
+// Lua functions
+
+LuaScheduler& LuaScheduler::self(lua_State* L) {
+    return *static_cast<LuaScheduler*>(lua_touserdata(L, lua_upvalueindex(1)));
+}
+
+LuaScheduler::Task& LuaScheduler::currentTask(lua_State* L, TaskId& id) {
+    auto it = m_tasks.find(m_current);
+    if (it == m_tasks.end() || it->second.thread != L) {
+        luaL_error(L, "can only wait inside a task; start one with spawn");
+    }
+    id = m_current;
+    return it->second;
+}
+
+int LuaScheduler::luaSpawn(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    LuaScheduler& scheduler = self(L);
+
+    TaskId id = scheduler.spawn(L, lua_gettop(L) - 1);
+    scheduler.wake(id, scheduler.m_tasks.at(id), 0);
+    lua_pushinteger(L, static_cast<lua_Integer>(id));
+    return 1;
+}
+
+int LuaScheduler::luaScheduleEvent(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    double delayMs = luaL_optnumber(L, 2, 0.0);
+    LuaScheduler& scheduler = self(L);
+
+    lua_settop(L, 1);
+    TaskId id = scheduler.spawn(L, 0);
+    Task& task = scheduler.m_tasks.at(id);
+    task.wait = Wait::Delay;
+    scheduler.setTimeout(id, task, delayMs);
+    lua_pushinteger(L, static_cast<lua_Integer>(id));
+    return 1;
+}
+
+int LuaScheduler::luaKillTask(lua_State* L) {
+    TaskId id = static_cast<TaskId>(luaL_checkinteger(L, 1));
+    lua_pushboolean(L, self(L).killTask(id));
+    return 1;
+}
+
+int LuaScheduler::luaWait(lua_State* L) {
+    double ms = luaL_checknumber(L, 1);
+    LuaScheduler& scheduler = self(L);
+
+    TaskId id;
+    Task& task = scheduler.currentTask(L, id);
+    task.wait = Wait::Delay;
+    scheduler.setTimeout(id, task, ms);
+    return lua_yield(L, 0);
+}
+
+int LuaScheduler::luaWaitFor(lua_State* L) {
+    const char* event = luaL_checkstring(L, 1);
+    double timeoutMs = luaL_optnumber(L, 2, -1.0);
+    LuaScheduler& scheduler = self(L);
+
+    TaskId id;
+    Task& task = scheduler.currentTask(L, id);
+    task.wait = Wait::Event;
+    task.event = event;
+    scheduler.m_eventWaiters[task.event].push_back(id);
+    if (timeoutMs >= 0.0) scheduler.setTimeout(id, task, timeoutMs);
+    return lua_yield(L, 0);
+}
+
+int LuaScheduler::luaWaitPacket(lua_State* L) {
+    lua_Integer opcode = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, opcode >= 0 && opcode <= 0xFF, 1, "opcode out of range");
+    double timeoutMs = luaL_optnumber(L, 2, -1.0);
+    LuaScheduler& scheduler = self(L);
+
+    TaskId id;
+    Task& task = scheduler.currentTask(L, id);
+    task.wait = Wait::Packet;
+    task.opcode = static_cast<uint8_t>(opcode);
+    scheduler.m_packetWaiters[task.opcode].push_back(id);
+    if (timeoutMs >= 0.0) scheduler.setTimeout(id, task, timeoutMs);
+    return lua_yield(L, 0);
+}
+
+int LuaScheduler::luaWaitPath(lua_State* L) {
+    FutureId future = static_cast<FutureId>(luaL_checkinteger(L, 1));
+    LuaScheduler& scheduler = self(L);
+
+    auto it = scheduler.m_futures.find(future);
+    luaL_argcheck(L, it != scheduler.m_futures.end(), 1, "unknown or already consumed future");
+    luaL_argcheck(L, !it->second.waiter, 1, "future already waited on");
+
+    // Completed before anyone waited; no need to yield
+    if (it->second.completed) {
+        int count = it->second.resultCount;
+        lua_rawgeti(L, LUA_REGISTRYINDEX, it->second.results);
+        int table = lua_gettop(L);
+        for (int i = 1; i <= count; i++) {
+            lua_rawgeti(L, table, i);
+        }
+        lua_remove(L, table);
+        luaL_unref(L, LUA_REGISTRYINDEX, it->second.results);
+        scheduler.m_futures.erase(it);
+        return count;
+    }
+
+    TaskId id;
+    Task& task = scheduler.currentTask(L, id);
+    task.wait = Wait::Future;
+    task.future = future;
+    it->second.waiter = id;
+    return lua_yield(L, 0);
+}
+
+int LuaScheduler::luaSignal(lua_State* L) {
+    const char* event = luaL_checkstring(L, 1);
+    int count = lua_gettop(L) - 1;
+
+    size_t woken = self(L).signal(event, [L, count](lua_State* thread) {
+        if (!lua_checkstack(thread, count)) return 0;
+        for (int i = 2; i <= count + 1; i++) {
+            lua_pushvalue(L, i);
+            lua_xmove(L, thread, 1);
+        }
+        return count;
+    });
+    lua_pushinteger(L, static_cast<lua_Integer>(woken));
+    return 1;
+}
+
+// Task bookkeeping
+
+double LuaScheduler::nowMs() const {
+    return toMs(Clock::now() - m_epoch);
+}
+
+LuaScheduler::TaskId LuaScheduler::spawn(lua_State* L, int nargs) {
+    lua_State* thread = lua_newthread(L);
+    int ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_xmove(L, thread, nargs + 1);
+
+    TaskId id = m_nextTaskId++;
+    Task& task = m_tasks[id];
+    task.thread = thread;
+    task.ref = ref;
+    return id;
+}
+
+void LuaScheduler::wake(TaskId id, Task& task, int nargs) {
+    if (task.timer) {
+        m_timers.cancel(task.timer);
+        task.timer = 0;
+    }
+    task.wait = Wait::None;
+    task.resumeArgs = nargs;
+    if (!task.ready) {
+        task.ready = true;
+        m_ready.push_back(id);
+    }
+}
+
+void LuaScheduler::wakeAll(std::vector<TaskId>& waiters, const PushResults& push) {
+    for (TaskId id : waiters) {
+        Task& task = m_tasks.at(id);
+        lua_pushboolean(task.thread, 1);
+        wake(id, task, 1 + (push ? push(task.thread) : 0));
+    }
+}
+
+void LuaScheduler::setTimeout(TaskId id, Task& task, double timeoutMs) {
+    task.timer = m_timers.add(nowMs() + std::max(timeoutMs, 0.0), id);
+}
+
+void LuaScheduler::dropWait(TaskId id, Task& task) {
+    if (task.timer) {
+        m_timers.cancel(task.timer);
+        task.timer = 0;
+    }
+
+    if (task.wait == Wait::Event) {
+        auto it = m_eventWaiters.find(task.event);
+        if (it != m_eventWaiters.end()) {
+            removeWaiter(it->second, id);
+            if (it->second.empty()) m_eventWaiters.erase(it);
+        }
+    } else if (task.wait == Wait::Packet) {
+        removeWaiter(m_packetWaiters[task.opcode], id);
+    } else if (task.wait == Wait::Future) {
+        auto it = m_futures.find(task.future);
+        if (it != m_futures.end()) {
+            it->second.waiter = 0;
+            it->second.abandoned = true;
+        }
+        task.future = 0;
+    }
+    task.wait = Wait::None;
+}
+
+bool LuaScheduler::resume(TaskId id) {
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end() || !it->second.ready) return false;
+
+    Task& task = it->second;
+    lua_State* thread = task.thread;
+    int nargs = task.resumeArgs;
+    if (!task.started) {
+        // The function sits under its arguments
+        task.started = true;
+        nargs = lua_gettop(thread) - 1;
+    }
+    task.ready = false;
+    task.resumeArgs = 0;
+
+    m_current = id;
+    g_luaProfiler.enter();
+    int nresults = 0;
+    int status = resumeThread(thread, m_state, nargs, nresults);
+    m_current = 0;
+
+    // A running task is only flagged when killed, so task is still valid
+    if (status == LUA_YIELD && !task.killed) {
+        lua_pop(thread, nresults);
+        if (task.wait == Wait::None) {
+            wake(id, task, 0);
+        }
+        return true;
+    }
+
+    if (status != LUA_OK && status != LUA_YIELD) {
+        const char* message = lua_tostring(thread, -1);
+        if (m_errorHandler) {
+            m_errorHandler(message ? message : "(error object is not a string)");
+        }
+    }
+    release(id);
+    return true;
+}
+
+void LuaScheduler::release(TaskId id) {
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end()) return;
+
+    dropWait(id, it->second);
+    luaL_unref(m_state, LUA_REGISTRYINDEX, it->second.ref);
+    m_tasks.erase(it);
+}
+
+} // namespace framework
+} // namespace shadow
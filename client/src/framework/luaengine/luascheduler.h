@@ -0,0 +1,165 @@
+/**
+ * Shadow OT Client - Lua Scheduler
+ *
+ * Coroutine tasks for scripts. A task runs until it waits on a delay, a
+ * named event, a packet opcode or a future such as a path request, and
+ * costs nothing while it waits: only the condition it waits on makes it
+ * ready again. update() resumes ready tasks in the order they became
+ * ready, within a per-frame time budget; what the budget leaves over
+ * waits for the next frame. Delays share one timer heap, so a hundred
+ * sleeping scripts cost one look at its top per frame.
+ *
+ * From Lua:
+ *   spawn(fn, ...)                     task id; fn(...) starts on the next update
+ *   scheduleEvent(fn, delayMs)         task id; fn() starts after the delay
+ *   killTask(id), removeEvent(id)      a task killing itself stops at its next wait
+ *   wait(ms)
+ *   waitFor(event [, timeoutMs])       true, signal args... or false on timeout
+ *   waitPacket(opcode [, timeoutMs])   true, payload or false on timeout
+ *   waitPath(future)                   what completed the future
+ *   signal(event, ...)                 tasks woken
+ * The wait functions yield, so they work only inside a task; a plain
+ * coroutine.yield() in a task waits one frame.
+ */
+
+#pragma once
+
+#include <framework/core/timerqueue.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+
+namespace shadow {
+namespace framework {
+
+class LuaScheduler {
+public:
+    static constexpr double DEFAULT_FRAME_BUDGET_MS = 2.0;
+
+    using TaskId = uint64_t;                // 0 is never a valid task
+    using FutureId = uint64_t;              // 0 is never a valid future
+    // Pushes a wait's results onto the given thread and returns how many
+    using PushResults = std::function<int(lua_State*)>;
+    using ErrorHandler = std::function<void(const std::string&)>;
+
+    void init(lua_State* L, ErrorHandler errorHandler);
+    void terminate();
+    // Registers the globals listed above
+    void registerBindings();
+
+    // Once per frame, on the main thread
+    void update();
+    void setFrameBudget(double ms) { m_frameBudgetMs = ms; }
+    double getFrameBudget() const { return m_frameBudgetMs; }
+
+    // Engine side. Each wakes every task waiting on the key; tasks see
+    // true followed by what push leaves on their stack.
+    size_t signal(std::string_view event, const PushResults& push = nullptr);
+    bool isWaitingForPacket(uint8_t opcode) const { return !m_packetWaiters[opcode].empty(); }
+    size_t signalPacket(uint8_t opcode, const uint8_t* payload, size_t size);
+
+    // A future completes once; its results go to the task waiting on it,
+    // or wait in the registry for the first task that does
+    FutureId createFuture();
+    void completeFuture(FutureId future, const PushResults& push);
+
+    bool killTask(TaskId id);
+
+    struct Stats {
+        size_t tasks{0};
+        size_t waiting{0};              // On an event, packet or future
+        size_t sleeping{0};             // On a delay or timeout
+        size_t ready{0};                // Left for the next frame
+        uint64_t resumed{0};            // Since start
+        uint64_t deferredFrames{0};     // Frames that ran out of budget
+        double lastUpdateMs{0.0};
+    };
+    Stats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Wait : uint8_t { None, Delay, Event, Packet, Future };
+
+    struct Task {
+        lua_State* thread{nullptr};
+        int ref{0};                     // Anchors the thread in the registry
+        bool started{false};
+        bool ready{false};
+        bool killed{false};
+        Wait wait{Wait::None};
+        TimerQueue<TaskId>::Handle timer{0};
+        std::string event;
+        uint8_t opcode{0};
+        FutureId future{0};
+        int resumeArgs{0};
+    };
+
+    struct Future {
+        TaskId waiter{0};
+        bool completed{false};
+        bool abandoned{false};          // Its waiter was killed
+        int results{0};                 // Registry table of the results
+        int resultCount{0};
+    };
+
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    static int luaSpawn(lua_State* L);
+    static int luaScheduleEvent(lua_State* L);
+    static int luaKillTask(lua_State* L);
+    static int luaWait(lua_State* L);
+    static int luaWaitFor(lua_State* L);
+    static int luaWaitPacket(lua_State* L);
+    static int luaWaitPath(lua_State* L);
+    static int luaSignal(lua_State* L);
+
+    static LuaScheduler& self(lua_State* L);
+    // The task running on L; raises a Lua error outside one
+    Task& currentTask(lua_State* L, TaskId& id);
+
+    double nowMs() const;
+    // Function and arguments on top of L move to a new task
+    TaskId spawn(lua_State* L, int nargs);
+    void wake(TaskId id, Task& task, int nargs);
+    void wakeAll(std::vector<TaskId>& waiters, const PushResults& push);
+    void setTimeout(TaskId id, Task& task, double timeoutMs);
+    void dropWait(TaskId id, Task& task);
+    bool resume(TaskId id);
+    void release(TaskId id);
+
+    lua_State* m_state{nullptr};
+    ErrorHandler m_errorHandler;
+    double m_frameBudgetMs{DEFAULT_FRAME_BUDGET_MS};
+    Clock::time_point m_epoch{Clock::now()};
+
+    std::unordered_map<TaskId, Task> m_tasks;
+    TaskId m_nextTaskId{1};
+    TaskId m_current{0};
+    std::deque<TaskId> m_ready;
+    TimerQueue<TaskId> m_timers;
+
+    std::unordered_map<std::string, std::vector<TaskId>, Hash, std::equal_to<>> m_eventWaiters;
+    std::array<std::vector<TaskId>, 256> m_packetWaiters;
+    std::unordered_map<FutureId, Future> m_futures;
+    FutureId m_nextFutureId{1};
+
+    uint64_t m_resumed{0};
+    uint64_t m_deferredFrames{0};
+    double m_lastUpdateMs{0.0};
+};
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,64 @@
+/**
+ * Shadow OT Client - Packet Compression Implementation
+ */
+
+#include "compression.h"
+#include <zlib.h>
+
+namespace shadow {
+namespace framework {
+
+struct PacketCompression::Impl {
+    z_stream stream{};
+    bool initialized{false};
+};
+
+PacketCompression::PacketCompression() : m_impl(std::make_unique<Impl>()) {
+    // Negative window bits: raw deflate, no zlib header or adler32 trailer
+    m_impl->initialized = inflateInit2(&m_impl->stream, -MAX_WBITS) == Z_OK;
+}
+
+PacketCompression::~PacketCompression() {
+    if (m_impl->initialized) {
+        inflateEnd(&m_impl->stream);
+    }
+}
+
+bool PacketCompression::inflate(const uint8_t* data, size_t length, NetworkMessage& out) {
+    if (!m_impl->initialized) {
+        m_stats.failures++;
+        return false;
+    }
+
+    // The inflated frame lands directly in a pooled buffer of the largest
+    // size class; frames cannot exceed it
+    out = NetworkMessage(NetworkMessage::MAX_SIZE);
+    uint8_t* buffer = out.getBuffer();
+
+    z_stream& stream = m_impl->stream;
+    inflateReset(&stream);
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = static_cast<uInt>(length);
+    stream.next_out = buffer + NetworkMessage::HEADER_SIZE;
+    stream.avail_out = static_cast<uInt>(NetworkMessage::MAX_SIZE - NetworkMessage::HEADER_SIZE);
+
+    int result = ::inflate(&stream, Z_FINISH);
+    if (result != Z_STREAM_END) {
+        m_stats.failures++;
+        return false;
+    }
+
+    size_t inflated = stream.total_out;
+    buffer[0] = inflated & 0xFF;
+    buffer[1] = (inflated >> 8) & 0xFF;
+    out.setSize(NetworkMessage::HEADER_SIZE + inflated);
+    out.setPosition(NetworkMessage::HEADER_SIZE);
+
+    m_stats.compressedFrames++;
+    m_stats.compressedBytes += length - stream.avail_in;
+    m_stats.uncompressedBytes += inflated;
+    return true;
+}
+
+} // namespace framework
+} // namespace shadow
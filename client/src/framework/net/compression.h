@@ -0,0 +1,58 @@
+/**
+ * Shadow OT Client - Packet Compression
+ *
+ * Raw-deflate inflation of compressed game frames straight into pooled
+ * NetworkMessage buffers.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "protocol.h"
+
+namespace shadow {
+namespace framework {
+
+class PacketCompression {
+public:
+    // Leading byte of every frame body once compression is negotiated
+    static constexpr uint8_t FLAG_RAW = 0x00;
+    static constexpr uint8_t FLAG_DEFLATE = 0x01;
+
+    // Server frames smaller than this are not worth compressing
+    static constexpr uint16_t DEFAULT_THRESHOLD = 512;
+
+    PacketCompression();
+    ~PacketCompression();
+
+    // Inflate `length` bytes of raw deflate into `out` (header included)
+    bool inflate(const uint8_t* data, size_t length, NetworkMessage& out);
+
+    void setThreshold(uint16_t threshold) { m_threshold = threshold; }
+    uint16_t getThreshold() const { return m_threshold; }
+
+    // Byte counters over frames that arrived compressed
+    struct Stats {
+        uint64_t compressedBytes{0};
+        uint64_t uncompressedBytes{0};
+        uint64_t compressedFrames{0};
+        uint64_t rawFrames{0};
+        uint64_t failures{0};
+    };
+    const Stats& getStats() const { return m_stats; }
+    void countRawFrame() { m_stats.rawFrames++; }
+
+private:
+    uint16_t m_threshold{DEFAULT_THRESHOLD};
+    Stats m_stats;
+
+    // Persistent z_stream, reset per frame rather than reallocated
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace framework
+} // namespace shadow
@@ -3,7 +3,10 @@
  */
 
 #include "connection.h"
-#include <framework/core/application.h>
+#include "framebuffer.h"
+#include "networkreactor.h"
+#include <algorithm>
+#include <vector>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -20,20 +23,101 @@ typedef int socklen_t;
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/uio.h>
 #define SOCKET int
 #define INVALID_SOCKET -1
 #define SOCKET_ERROR -1
 #define closesocket close
 #endif
 
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
 namespace shadow {
 namespace framework {
 
+namespace {
+
+bool socketWouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+std::vector<const addrinfo*> orderCandidates(const addrinfo* list, bool preferIPv6) {
+    std::vector<const addrinfo*> primary, secondary;
+    int primaryFamily = preferIPv6 ? AF_INET6 : AF_INET;
+
+    for (const addrinfo* ai = list; ai; ai = ai->ai_next) {
+        if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6) continue;
+        (ai->ai_family == primaryFamily ? primary : secondary).push_back(ai);
+    }
+
+    // Alternate families so one broken family cannot stall the other
+    std::vector<const addrinfo*> ordered;
+    ordered.reserve(primary.size() + secondary.size());
+    for (size_t i = 0; i < std::max(primary.size(), secondary.size()); ++i) {
+        if (i < primary.size()) ordered.push_back(primary[i]);
+        if (i < secondary.size()) ordered.push_back(secondary[i]);
+    }
+    return ordered;
+}
+
+SOCKET openCandidate(const addrinfo* candidate) {
+    SOCKET sock = socket(candidate->ai_family, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        return INVALID_SOCKET;
+    }
+
+    // Set non-blocking
+#ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(sock, FIONBIO, &mode);
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+#endif
+
+    // Disable Nagle's algorithm
+    int flag = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&flag, sizeof(flag));
+#ifdef SO_NOSIGPIPE
+    // No MSG_NOSIGNAL on Apple platforms
+    setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, (char*)&flag, sizeof(flag));
+#endif
+
+    int connectResult = ::connect(sock, candidate->ai_addr, static_cast<int>(candidate->ai_addrlen));
+#ifdef _WIN32
+    if (connectResult == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK) {
+#else
+    if (connectResult == -1 && errno != EINPROGRESS) {
+#endif
+        closesocket(sock);
+        return INVALID_SOCKET;
+    }
+
+    return sock;
+}
+
+} // anonymous namespace
+
 struct Connection::Impl {
     SOCKET socket{INVALID_SOCKET};
     std::string host;
     uint16_t port{0};
 
+    // Inbound bytes awaiting frame reassembly (both backends)
+    FrameBuffer readBuffer;
+    // When the last bytes were read, stamped on the frames they complete
+    std::chrono::steady_clock::time_point lastRead;
+
+    // Reactor backend state
+    bool registered{false};
+    size_t writeOffset{0};
+
 #ifdef _WIN32
     static bool wsaInitialized;
     static void initWSA() {
@@ -65,91 +149,207 @@ void Connection::connect(const std::string& host, uint16_t port) {
         return;
     }
 
+    // A previous attempt that failed on its own thread may still be winding down
+    if (m_connectThread && m_connectThread->joinable()) {
+        m_connectThread->join();
+    }
+
     m_state = ConnectionState::Connecting;
+    resetNetworkStats();
     m_impl->host = host;
     m_impl->port = port;
-
-    // Create socket
-    m_impl->socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (m_impl->socket == INVALID_SOCKET) {
-        handleError("Failed to create socket");
-        return;
+    m_connectCancelled = false;
+    {
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        m_connectResult = {};
+        m_ioError.clear();
     }
 
-    // Set non-blocking
-#ifdef _WIN32
-    u_long mode = 1;
-    ioctlsocket(m_impl->socket, FIONBIO, &mode);
-#else
-    int flags = fcntl(m_impl->socket, F_GETFL, 0);
-    fcntl(m_impl->socket, F_SETFL, flags | O_NONBLOCK);
-#endif
+    // Resolution and connect both block, so neither runs on the caller's thread
+    m_connectThread = std::make_unique<std::thread>([this, host, port]() {
+        connectWorker(host, port);
+    });
+}
 
-    // Disable Nagle's algorithm
-    int flag = 1;
-    setsockopt(m_impl->socket, IPPROTO_TCP, TCP_NODELAY, (char*)&flag, sizeof(flag));
+void Connection::connectWorker(const std::string& host, uint16_t port) {
+    auto started = std::chrono::steady_clock::now();
+    auto elapsedUs = [&started]() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started).count());
+    };
 
-    // Resolve hostname
+    // Resolve hostname, both families
     struct addrinfo hints{}, *result = nullptr;
-    hints.ai_family = AF_INET;
+    hints.ai_family = AF_UNSPEC;
     hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
 
     std::string portStr = std::to_string(port);
-    if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0) {
-        handleError("Failed to resolve hostname");
+    if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0 || !result) {
+        finishConnect(false, "Failed to resolve hostname");
         return;
     }
 
-    // Connect
-    int connectResult = ::connect(m_impl->socket, result->ai_addr, static_cast<int>(result->ai_addrlen));
+    ConnectStats stats;
+    stats.resolveUs = elapsedUs();
+
+    std::vector<const addrinfo*> candidates = orderCandidates(result, s_ipv6Healthy);
+
+    // Happy eyeballs (RFC 8305): start the next address whenever the current
+    // ones have not connected within ATTEMPT_DELAY, keep every attempt in
+    // flight, and take whichever completes first
+    struct Attempt {
+        SOCKET socket;
+        int family;
+    };
+    std::vector<Attempt> pending;
+    SOCKET winner = INVALID_SOCKET;
+    int winnerFamily = 0;
+    bool ipv6Failed = false;
+    size_t next = 0;
+    auto nextStart = std::chrono::steady_clock::now();
+    auto deadline = started + CONNECT_TIMEOUT;
+
+    while (winner == INVALID_SOCKET && !m_connectCancelled) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline || (pending.empty() && next >= candidates.size())) {
+            break;
+        }
+
+        if (next < candidates.size() && (pending.empty() || now >= nextStart)) {
+            const addrinfo* candidate = candidates[next++];
+            SOCKET socket = openCandidate(candidate);
+            stats.attempts++;
+            if (socket != INVALID_SOCKET) {
+                pending.push_back({socket, candidate->ai_family});
+            } else if (candidate->ai_family == AF_INET6) {
+                ipv6Failed = true;
+            }
+            nextStart = now + ATTEMPT_DELAY;
+            continue;
+        }
+
+        fd_set writeSet, errorSet;
+        FD_ZERO(&writeSet);
+        FD_ZERO(&errorSet);
+        SOCKET maxSocket = 0;
+        for (const auto& attempt : pending) {
+            FD_SET(attempt.socket, &writeSet);
+            FD_SET(attempt.socket, &errorSet);
+            maxSocket = std::max(maxSocket, attempt.socket);
+        }
+
+        // Short slices so disconnect() can cancel promptly
+        auto wait = std::min<std::chrono::steady_clock::duration>(
+            {next < candidates.size() ? nextStart - now : deadline - now,
+             deadline - now, std::chrono::milliseconds(50)});
+        auto waitUs = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(wait).count());
+
+        struct timeval timeout;
+        timeout.tv_sec = static_cast<long>(waitUs / 1000000);
+        timeout.tv_usec = static_cast<long>(waitUs % 1000000);
+
+        if (select(static_cast<int>(maxSocket) + 1, nullptr, &writeSet, &errorSet, &timeout) <= 0) {
+            continue;
+        }
+
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (!FD_ISSET(it->socket, &writeSet) && !FD_ISSET(it->socket, &errorSet)) {
+                ++it;
+                continue;
+            }
+
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(it->socket, SOL_SOCKET, SO_ERROR, (char*)&error, &len);
+            if (error == 0 && winner == INVALID_SOCKET) {
+                winner = it->socket;
+                winnerFamily = it->family;
+            } else {
+                if (it->family == AF_INET6) {
+                    ipv6Failed = true;
+                }
+                closesocket(it->socket);
+            }
+            it = pending.erase(it);
+        }
+    }
+
+    for (const auto& attempt : pending) {
+        closesocket(attempt.socket);
+    }
     freeaddrinfo(result);
 
-#ifdef _WIN32
-    if (connectResult == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK) {
-#else
-    if (connectResult == -1 && errno != EINPROGRESS) {
-#endif
-        handleError("Connection failed");
+    if (winner == INVALID_SOCKET) {
+        finishConnect(false, std::chrono::steady_clock::now() >= deadline ? "Connection timeout" : "Connection failed");
         return;
     }
 
-    // Start read/write threads
-    m_running = true;
+    // Remember whether IPv6 is worth leading with next time
+    if (winnerFamily == AF_INET6) {
+        s_ipv6Healthy = true;
+    } else if (ipv6Failed) {
+        s_ipv6Healthy = false;
+    }
 
-    m_readThread = std::make_unique<std::thread>([this]() {
-        readLoop();
-    });
+    stats.connectUs = elapsedUs() - stats.resolveUs;
+    stats.totalUs = elapsedUs();
+    stats.ipv6 = winnerFamily == AF_INET6;
+
+    {
+        // disconnect() cancels under this lock, so the socket is either
+        // installed before it runs or closed here
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        if (m_connectCancelled) {
+            closesocket(winner);
+            return;
+        }
 
-    m_writeThread = std::make_unique<std::thread>([this]() {
-        writeLoop();
-    });
+        m_impl->socket = winner;
+        m_connectStats = stats;
+        m_running = true;
+        m_impl->readBuffer.clear();
+        m_state = ConnectionState::Connected;
 
-    // Wait for connection to complete
-    fd_set writeSet;
-    FD_ZERO(&writeSet);
-    FD_SET(m_impl->socket, &writeSet);
+        if (m_backend == NetworkBackend::Threaded) {
+            m_readThread = std::make_unique<std::thread>([this]() {
+                readLoop();
+            });
 
-    struct timeval timeout;
-    timeout.tv_sec = 10;
-    timeout.tv_usec = 0;
+            m_writeThread = std::make_unique<std::thread>([this]() {
+                writeLoop();
+            });
+        } else {
+            m_impl->writeOffset = 0;
+            m_impl->registered = g_reactor.add(static_cast<NativeSocket>(m_impl->socket),
+                NetworkReactor::Readable | NetworkReactor::Writable,
+                [this](uint32_t events) { onReactorEvent(events); });
+        }
 
-    int selectResult = select(static_cast<int>(m_impl->socket) + 1, nullptr, &writeSet, nullptr, &timeout);
+        m_connectResult = {true, true, ""};
+    }
+}
 
-    if (selectResult > 0) {
-        int error = 0;
-        socklen_t len = sizeof(error);
-        getsockopt(m_impl->socket, SOL_SOCKET, SO_ERROR, (char*)&error, &len);
+void Connection::finishConnect(bool success, const std::string& error) {
+    std::lock_guard<std::mutex> lock(m_connectMutex);
+    if (!m_connectCancelled) {
+        m_connectResult = {true, success, error};
+    }
+}
 
-        if (error == 0) {
-            m_state = ConnectionState::Connected;
-            if (m_connectCallback) {
-                m_connectCallback(true, "");
-            }
-        } else {
-            handleError("Connection failed");
-        }
-    } else {
-        handleError("Connection timeout");
+void Connection::pollConnect() {
+    ConnectResult result;
+    {
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        if (!m_connectResult.pending) return;
+        result = std::move(m_connectResult);
+        m_connectResult = {};
+    }
+
+    if (!result.success) {
+        handleError(result.error);
+    } else if (m_connectCallback) {
+        m_connectCallback(true, "");
     }
 }
 
@@ -159,18 +359,35 @@ void Connection::disconnect() {
     }
 
     m_state = ConnectionState::Disconnecting;
-    m_running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        m_connectCancelled = true;
+        m_ioError.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_running = false;
+    }
+    m_sendCondition.notify_all();
+
+    // Unregister first so no reactor handler can run against a closed socket
+    if (m_impl->registered) {
+        g_reactor.remove(static_cast<NativeSocket>(m_impl->socket));
+        m_impl->registered = false;
+    }
 
     if (m_impl->socket != INVALID_SOCKET) {
         closesocket(m_impl->socket);
         m_impl->socket = INVALID_SOCKET;
     }
 
-    if (m_readThread && m_readThread->joinable()) {
-        m_readThread->join();
-    }
-    if (m_writeThread && m_writeThread->joinable()) {
-        m_writeThread->join();
+    // Never called from the I/O threads themselves (their errors go
+    // through poll()), so each can be joined
+    for (auto* thread : {&m_connectThread, &m_readThread, &m_writeThread}) {
+        if (*thread && (*thread)->joinable()) {
+            (*thread)->join();
+        }
+        thread->reset();
     }
 
     m_state = ConnectionState::Disconnected;
@@ -193,22 +410,49 @@ void Connection::send(NetworkMessage& msg) {
     msg.getBuffer()[0] = size & 0xFF;
     msg.getBuffer()[1] = (size >> 8) & 0xFF;
 
-    std::lock_guard<std::mutex> lock(m_sendMutex);
-    m_sendQueue.push(msg);
+    // Hand the pooled buffer to the queue; the caller's handle is left empty
+    // and acquires a fresh buffer on its next write
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_sendQueue.push_back({std::move(msg), std::chrono::steady_clock::now()});
+        uint32_t depth = ++m_sendQueueDepth;
+        if (depth > m_sendQueueMaxDepth) {
+            m_sendQueueMaxDepth = depth;
+        }
+        if (m_impl->registered && m_sendQueue.size() == 1) {
+            g_reactor.modify(static_cast<NativeSocket>(m_impl->socket),
+                             NetworkReactor::Readable | NetworkReactor::Writable);
+        }
+    }
+    m_sendCondition.notify_one();
 }
 
 void Connection::poll() {
+    pollConnect();
+
     // Process received messages
     while (true) {
-        NetworkMessage msg;
+        IncomingMessage incoming;
         {
             std::lock_guard<std::mutex> lock(m_recvMutex);
             if (m_recvQueue.empty()) break;
-            msg = m_recvQueue.front();
+            incoming = std::move(m_recvQueue.front());
             m_recvQueue.pop();
         }
 
-        processIncoming(msg);
+        m_receiveDelays.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - incoming.receivedAt).count()));
+        processIncoming(incoming.msg);
+    }
+
+    // After the frames that arrived before it
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        error.swap(m_ioError);
+    }
+    if (!error.empty()) {
+        handleError(error);
     }
 }
 
@@ -221,7 +465,8 @@ void Connection::enableEncryption(bool enable) {
 }
 
 void Connection::sendPing() {
-    m_lastPingTime = g_app.getMilliseconds();
+    m_lastPingTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
 
     NetworkMessage msg;
     msg.writeByte(ClientOpcode::Ping);
@@ -229,7 +474,7 @@ void Connection::sendPing() {
 }
 
 void Connection::readLoop() {
-    std::vector<uint8_t> buffer(NetworkMessage::MAX_SIZE);
+    FrameBuffer& buffer = m_impl->readBuffer;
 
     while (m_running && m_impl->socket != INVALID_SOCKET) {
         fd_set readSet;
@@ -243,82 +488,354 @@ void Connection::readLoop() {
         int selectResult = select(static_cast<int>(m_impl->socket) + 1, &readSet, nullptr, nullptr, &timeout);
 
         if (selectResult > 0 && FD_ISSET(m_impl->socket, &readSet)) {
-            // Read header (2 bytes)
-            int headerRead = recv(m_impl->socket, (char*)buffer.data(), 2, MSG_WAITALL);
-            if (headerRead <= 0) {
+            // Take whatever is available in one call; frames may span reads
+            int received = recv(m_impl->socket, (char*)buffer.writePtr(),
+                                static_cast<int>(buffer.writable()), 0);
+            if (received == 0) {
                 if (m_running) {
-                    handleError("Connection closed");
+                    drainFrames();
+                    deferError("Connection closed");
                 }
                 break;
             }
-
-            uint16_t messageSize = buffer[0] | (buffer[1] << 8);
-            if (messageSize > NetworkMessage::MAX_SIZE - 2) {
-                handleError("Invalid message size");
+            if (received < 0) {
+                if (socketWouldBlock()) {
+                    continue;
+                }
+                if (m_running) {
+                    deferError("Receive failed");
+                }
                 break;
             }
 
-            // Read body
-            int bodyRead = recv(m_impl->socket, (char*)buffer.data() + 2, messageSize, MSG_WAITALL);
-            if (bodyRead != messageSize) {
-                handleError("Incomplete message");
+            buffer.commit(received);
+            m_bytesReceived += received;
+            m_impl->lastRead = std::chrono::steady_clock::now();
+
+            if (!drainFrames()) {
                 break;
             }
+        }
+    }
+}
 
-            m_bytesReceived += headerRead + bodyRead;
+double Connection::getAverageSendLatencyUs() const {
+    uint64_t samples = m_sendLatencySamples;
+    return samples > 0 ? static_cast<double>(m_sendLatencyTotalUs) / samples : 0.0;
+}
 
-            // Create message
-            NetworkMessage msg;
-            std::memcpy(msg.getBuffer(), buffer.data(), 2 + messageSize);
-            msg.setSize(2 + messageSize);
-            msg.setPosition(2);
+Connection::ConnectStats Connection::getConnectStats() const {
+    std::lock_guard<std::mutex> lock(m_connectMutex);
+    return m_connectStats;
+}
 
-            // Decrypt if enabled
-            m_cipher.decrypt(msg);
+double Connection::getPacketsPerSyscall() const {
+    uint64_t syscalls = m_sendSyscalls;
+    return syscalls > 0 ? static_cast<double>(m_packetsSent) / syscalls : 0.0;
+}
 
-            std::lock_guard<std::mutex> lock(m_recvMutex);
-            m_recvQueue.push(msg);
-        }
+void Connection::recordRoundTrip(std::chrono::microseconds rtt) {
+    uint64_t us = static_cast<uint64_t>(std::max<int64_t>(rtt.count(), 0));
+    m_rtt.record(us);
+    m_ping = static_cast<int>(us / 1000);
+
+    // J += (|D| - J) / 16, kept in integer microseconds
+    uint64_t last = m_lastRttUs.exchange(us);
+    if (m_rtt.getCount() > 1) {
+        int64_t variation = us > last ? static_cast<int64_t>(us - last) : static_cast<int64_t>(last - us);
+        int64_t jitter = static_cast<int64_t>(m_jitterUs.load());
+        m_jitterUs = static_cast<uint64_t>(jitter + (variation - jitter) / 16);
     }
 }
 
+void Connection::resetNetworkStats() {
+    m_rtt.reset();
+    m_sendQueueTimes.reset();
+    m_receiveDelays.reset();
+    m_jitterUs = 0;
+    m_lastRttUs = 0;
+    m_packetsReceived = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_sendQueueDepth = static_cast<uint32_t>(m_sendQueue.size());
+    }
+    m_sendQueueMaxDepth = m_sendQueueDepth.load();
+}
+
+Connection::TcpInfo Connection::getTcpInfo() const {
+    TcpInfo info;
+#if defined(__linux__) && defined(TCP_INFO)
+    if (m_impl->socket == INVALID_SOCKET || m_state != ConnectionState::Connected) {
+        return info;
+    }
+
+    struct tcp_info kernel{};
+    socklen_t length = sizeof(kernel);
+    if (getsockopt(m_impl->socket, IPPROTO_TCP, TCP_INFO, &kernel, &length) == 0) {
+        info.available = true;
+        info.rttUs = kernel.tcpi_rtt;
+        info.rttVarUs = kernel.tcpi_rttvar;
+        info.retransmits = kernel.tcpi_total_retrans;
+        info.lost = kernel.tcpi_lost;
+        info.congestionWindow = kernel.tcpi_snd_cwnd;
+        info.unacked = kernel.tcpi_unacked;
+    }
+#endif
+    return info;
+}
+
 void Connection::writeLoop() {
+    std::deque<OutgoingMessage> batch;
+
     while (m_running && m_impl->socket != INVALID_SOCKET) {
-        NetworkMessage msg;
         {
-            std::lock_guard<std::mutex> lock(m_sendMutex);
-            if (m_sendQueue.empty()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                continue;
+            // Sleep until send() or disconnect() wakes us
+            std::unique_lock<std::mutex> lock(m_sendMutex);
+            m_sendCondition.wait(lock, [this]() {
+                return !m_running || !m_sendQueue.empty();
+            });
+
+            // Let a burst accumulate before flushing it
+            auto delay = getCoalesceDelay();
+            if (m_running && delay.count() > 0) {
+                m_sendCondition.wait_for(lock, delay, [this]() {
+                    return !m_running || m_sendQueue.size() >= MAX_GATHER;
+                });
             }
-            msg = m_sendQueue.front();
-            m_sendQueue.pop();
+            if (!m_running) {
+                break;
+            }
+            batch.swap(m_sendQueue);
         }
 
-        // Send message
-        int totalSent = 0;
-        int messageSize = static_cast<int>(msg.getSize());
-
-        while (totalSent < messageSize) {
-            int sent = ::send(m_impl->socket, (char*)msg.getBuffer() + totalSent,
-                            messageSize - totalSent, 0);
-            if (sent <= 0) {
-                handleError("Send failed");
+        size_t offset = 0;
+        while (!batch.empty()) {
+            int sent = gatherSend(batch, offset);
+            if (sent < 0) {
+                if (socketWouldBlock() && waitWritable()) {
+                    continue;
+                }
+                if (m_running) {
+                    deferError("Send failed");
+                }
                 return;
             }
-            totalSent += sent;
+            consumeSent(batch, offset, sent);
+        }
+    }
+}
+
+int Connection::gatherSend(const std::deque<OutgoingMessage>& messages, size_t offset) {
+#ifdef _WIN32
+    WSABUF buffers[MAX_GATHER];
+    DWORD count = 0;
+    for (const auto& outgoing : messages) {
+        if (count == MAX_GATHER) break;
+        buffers[count].buf = (char*)outgoing.msg.getBuffer() + offset;
+        buffers[count].len = static_cast<ULONG>(outgoing.msg.getSize() - offset);
+        offset = 0;
+        count++;
+    }
+
+    DWORD sent = 0;
+    if (WSASend(m_impl->socket, buffers, count, &sent, 0, nullptr, nullptr) == SOCKET_ERROR) {
+        return -1;
+    }
+    return static_cast<int>(sent);
+#else
+    struct iovec buffers[MAX_GATHER];
+    size_t count = 0;
+    for (const auto& outgoing : messages) {
+        if (count == MAX_GATHER) break;
+        buffers[count].iov_base = (void*)(outgoing.msg.getBuffer() + offset);
+        buffers[count].iov_len = outgoing.msg.getSize() - offset;
+        offset = 0;
+        count++;
+    }
+
+    // sendmsg rather than writev so MSG_NOSIGNAL applies
+    struct msghdr header{};
+    header.msg_iov = buffers;
+    header.msg_iovlen = count;
+    return static_cast<int>(sendmsg(m_impl->socket, &header, MSG_NOSIGNAL));
+#endif
+}
+
+void Connection::consumeSent(std::deque<OutgoingMessage>& messages, size_t& offset, size_t sent) {
+    m_bytesSent += sent;
+    m_sendSyscalls++;
+
+    while (sent > 0 && !messages.empty()) {
+        size_t remaining = messages.front().msg.getSize() - offset;
+        if (sent < remaining) {
+            offset += sent;
+            return;
+        }
+
+        sent -= remaining;
+        offset = 0;
+        recordSendLatency(messages.front().queuedAt);
+        m_packetsSent++;
+        m_sendQueueDepth--;
+        messages.pop_front();
+    }
+}
+
+bool Connection::waitWritable() {
+    fd_set writeSet;
+    FD_ZERO(&writeSet);
+    FD_SET(m_impl->socket, &writeSet);
+
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 100000; // 100ms
+
+    select(static_cast<int>(m_impl->socket) + 1, nullptr, &writeSet, nullptr, &timeout);
+    return m_running.load();
+}
+
+void Connection::recordSendLatency(std::chrono::steady_clock::time_point queuedAt) {
+    uint64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - queuedAt).count();
+    m_sendQueueTimes.record(latencyUs);
+    m_sendLatencyTotalUs += latencyUs;
+    m_sendLatencySamples++;
+    if (latencyUs > m_sendLatencyMaxUs) {
+        m_sendLatencyMaxUs = latencyUs;
+    }
+}
+
+bool Connection::drainFrames() {
+    // Slice every complete frame out of the read buffer; a trailing partial
+    // frame stays buffered until the rest of it arrives
+    NetworkMessage msg;
+    while (true) {
+        auto result = m_impl->readBuffer.nextFrame(msg);
+        if (result == FrameBuffer::Result::NeedMore) {
+            return true;
+        }
+        if (result == FrameBuffer::Result::Invalid) {
+            deferError("Invalid message size");
+            return false;
+        }
+
+        m_cipher.decrypt(msg);
+        m_packetsReceived++;
+
+        std::lock_guard<std::mutex> lock(m_recvMutex);
+        m_recvQueue.push({std::move(msg), m_impl->lastRead});
+    }
+}
+
+// Reactor backend
+
+void Connection::onReactorEvent(uint32_t events) {
+    bool ok = true;
+    if (events & (NetworkReactor::ReadReady | NetworkReactor::Hangup)) {
+        ok = reactorRead();
+    }
+    if (ok && (events & NetworkReactor::WriteReady)) {
+        ok = reactorWrite();
+    }
+
+    // Stop watching a failed socket until poll() disconnects; removing from
+    // inside the handler is safe, and disconnect()'s remove is then a no-op
+    if (!ok) {
+        g_reactor.remove(static_cast<NativeSocket>(m_impl->socket));
+    }
+}
+
+bool Connection::reactorRead() {
+    // Drain everything the kernel has buffered, then slice out whole frames
+    while (true) {
+        size_t space = m_impl->readBuffer.writable();
+        int received = recv(m_impl->socket, (char*)m_impl->readBuffer.writePtr(),
+                            static_cast<int>(space), 0);
+        if (received > 0) {
+            m_impl->readBuffer.commit(received);
+            m_bytesReceived += received;
+            m_impl->lastRead = std::chrono::steady_clock::now();
+            if (static_cast<size_t>(received) < space) {
+                break;
+            }
+            if (!drainFrames()) {
+                return false;
+            }
+            continue;
         }
 
-        m_bytesSent += totalSent;
+        if (received == 0) {
+            drainFrames();
+            deferError("Connection closed");
+            return false;
+        }
+
+        if (!socketWouldBlock()) {
+            deferError("Receive failed");
+            return false;
+        }
+        break;
     }
+
+    return drainFrames();
 }
 
+bool Connection::reactorWrite() {
+    bool failed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        while (!m_sendQueue.empty()) {
+            int sent = gatherSend(m_sendQueue, m_impl->writeOffset);
+            if (sent < 0) {
+                if (socketWouldBlock()) {
+                    // Kernel buffer full; resume on the next writable event
+                    return true;
+                }
+                failed = true;
+                break;
+            }
+            consumeSent(m_sendQueue, m_impl->writeOffset, sent);
+        }
+
+        if (!failed) {
+            // Queue drained; send() re-arms write interest under this lock
+            g_reactor.modify(static_cast<NativeSocket>(m_impl->socket), NetworkReactor::Readable);
+        }
+    }
+
+    if (failed) {
+        deferError("Send failed");
+        return false;
+    }
+    return true;
+}
+
+
 void Connection::processIncoming(NetworkMessage& msg) {
     if (m_messageCallback) {
         m_messageCallback(msg);
     }
 }
 
+void Connection::deferError(const std::string& error) {
+    {
+        // Nothing to report once disconnect() has started
+        std::lock_guard<std::mutex> lock(m_connectMutex);
+        if (m_connectCancelled) {
+            return;
+        }
+        if (m_ioError.empty()) {
+            m_ioError = error;
+        }
+    }
+    m_state = ConnectionState::Error;
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_running = false;
+    }
+    m_sendCondition.notify_all();
+}
+
 void Connection::handleError(const std::string& error) {
     m_state = ConnectionState::Error;
 
@@ -470,6 +987,9 @@ void ProtocolGame::sendLogout() {
 
 void ProtocolGame::parseMessage(NetworkMessage& msg) {
     uint8_t opcode = msg.readByte();
+    if (m_packetCallback) {
+        m_packetCallback(opcode, msg.getSize());
+    }
 
     switch (opcode) {
         case ServerOpcode::LoginSuccess:
@@ -597,7 +1117,7 @@ void ProtocolLogin::parseCharacterList(NetworkMessage& msg) {
 
     uint8_t motdLen = msg.readByte();
     if (motdLen > 0) {
-        msg.readString(); // MOTD
+        msg.readStringView(); // MOTD
     }
 
     uint8_t charCount = msg.readByte();
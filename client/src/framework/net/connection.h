@@ -10,12 +10,18 @@
 #include <memory>
 #include <functional>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <condition_variable>
+#include <chrono>
 
+#include "latencyhistogram.h"
 #include "protocol.h"
 
+struct addrinfo;
+
 namespace shadow {
 namespace framework {
 
@@ -27,20 +33,39 @@ enum class ConnectionState {
     Error
 };
 
+// I/O strategy behind a Connection. Threaded gives every connection its own
+// read and write thread; Reactor multiplexes all of them on g_reactor.
+enum class NetworkBackend {
+    Threaded,
+    Reactor
+};
+
 class Connection {
 public:
     Connection();
     ~Connection();
 
+    // Backend selection. The default applies to connections created
+    // afterwards; setBackend() takes effect on the next connect().
+    static void setDefaultBackend(NetworkBackend backend) { s_defaultBackend = backend; }
+    static NetworkBackend getDefaultBackend() { return s_defaultBackend; }
+    void setBackend(NetworkBackend backend) { m_backend = backend; }
+    NetworkBackend getBackend() const { return m_backend; }
+
     // Connection management
     void connect(const std::string& host, uint16_t port);
     void disconnect();
     bool isConnected() const { return m_state == ConnectionState::Connected; }
     ConnectionState getState() const { return m_state; }
 
-    // Message handling
+    // Message handling. poll() delivers the connect callback, then
+    // received messages, then any I/O error, on the calling thread; no
+    // callback ever runs on an I/O or reactor thread.
     void send(NetworkMessage& msg);
     void poll();
+    // Only the connect outcome, for connections whose messages are not
+    // being read yet
+    void pollConnect();
 
     // Encryption
     void setXTEAKey(const std::array<uint32_t, 4>& key);
@@ -64,23 +89,132 @@ public:
     int getPing() const { return m_ping; }
     void sendPing();
 
+    // Time from send() until the message is written to the socket
+    double getAverageSendLatencyUs() const;
+    uint64_t getMaxSendLatencyUs() const { return m_sendLatencyMaxUs; }
+
+    // Send coalescing: everything queued is flushed with one gather write.
+    // A non-zero delay lets a burst accumulate before the flush (threaded
+    // backend; the reactor flushes on the next writable event).
+    void setCoalesceDelay(std::chrono::microseconds delay) { m_coalesceDelayUs = delay.count(); }
+    std::chrono::microseconds getCoalesceDelay() const { return std::chrono::microseconds(m_coalesceDelayUs); }
+    uint64_t getPacketsSent() const { return m_packetsSent; }
+    uint64_t getSendSyscalls() const { return m_sendSyscalls; }
+    double getPacketsPerSyscall() const;
+
+    // Time-to-connect breakdown of the last successful connect()
+    struct ConnectStats {
+        uint64_t resolveUs{0};
+        uint64_t connectUs{0};
+        uint64_t totalUs{0};
+        uint32_t attempts{0};
+        bool ipv6{false};
+    };
+    ConnectStats getConnectStats() const;
+
+    // Kernel view of the socket (Linux TCP_INFO); available is false
+    // elsewhere or before connecting
+    struct TcpInfo {
+        bool available{false};
+        uint32_t rttUs{0};
+        uint32_t rttVarUs{0};
+        uint32_t retransmits{0};        // Segments retransmitted in total
+        uint32_t lost{0};               // Segments currently considered lost
+        uint32_t congestionWindow{0};   // Segments
+        uint32_t unacked{0};
+    };
+    TcpInfo getTcpInfo() const;
+
+    // Round trips measured by the protocol (ping to ping-back); jitter is
+    // the smoothed RTT variation of RFC 3550
+    void recordRoundTrip(std::chrono::microseconds rtt);
+    const LatencyHistogram& getRoundTrips() const { return m_rtt; }
+    uint64_t getJitterUs() const { return m_jitterUs; }
+
+    // Messages queued by send() and not yet written to the socket
+    uint32_t getSendQueueDepth() const { return m_sendQueueDepth; }
+    uint32_t getMaxSendQueueDepth() const { return m_sendQueueMaxDepth; }
+    const LatencyHistogram& getSendQueueTimes() const { return m_sendQueueTimes; }
+
+    // Time from the socket read that completed a frame until poll() hands
+    // it to the message callback
+    const LatencyHistogram& getReceiveDelays() const { return m_receiveDelays; }
+    uint64_t getPacketsReceived() const { return m_packetsReceived; }
+
+    // Clears every histogram and counter above
+    void resetNetworkStats();
+
 private:
+    // Resolve and connect off the caller's thread, racing the resolved
+    // addresses happy-eyeballs style
+    static constexpr auto ATTEMPT_DELAY = std::chrono::milliseconds(250);
+    static constexpr auto CONNECT_TIMEOUT = std::chrono::seconds(10);
+    void connectWorker(const std::string& host, uint16_t port);
+    void finishConnect(bool success, const std::string& error);
+
     void readLoop();
     void writeLoop();
     void processIncoming(NetworkMessage& msg);
+    bool drainFrames();
     void handleError(const std::string& error);
+    // I/O threads stop and leave the error for poll() to handle
+    void deferError(const std::string& error);
+    void recordSendLatency(std::chrono::steady_clock::time_point queuedAt);
+
+    // Gather I/O over the front of a send queue, starting offset bytes into
+    // its first message; returns bytes written or -1
+    struct OutgoingMessage;
+    static constexpr size_t MAX_GATHER = 64;
+    int gatherSend(const std::deque<OutgoingMessage>& messages, size_t offset);
+    void consumeSent(std::deque<OutgoingMessage>& messages, size_t& offset, size_t sent);
+    bool waitWritable();
+
+    // Reactor backend
+    void onReactorEvent(uint32_t events);
+    bool reactorRead();
+    bool reactorWrite();
+
+    static inline NetworkBackend s_defaultBackend{NetworkBackend::Threaded};
+
+    // Shared across connections: lead with IPv6 until it loses to IPv4
+    static inline std::atomic<bool> s_ipv6Healthy{true};
+    NetworkBackend m_backend{s_defaultBackend};
 
     std::atomic<ConnectionState> m_state{ConnectionState::Disconnected};
     XTEACipher m_cipher;
 
     // Threading
+    std::unique_ptr<std::thread> m_connectThread;
     std::unique_ptr<std::thread> m_readThread;
     std::unique_ptr<std::thread> m_writeThread;
+    struct OutgoingMessage {
+        NetworkMessage msg;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
     std::mutex m_sendMutex;
     std::mutex m_recvMutex;
-    std::queue<NetworkMessage> m_sendQueue;
-    std::queue<NetworkMessage> m_recvQueue;
+    std::condition_variable m_sendCondition;
+    struct IncomingMessage {
+        NetworkMessage msg;
+        std::chrono::steady_clock::time_point receivedAt;
+    };
+
+    std::deque<OutgoingMessage> m_sendQueue;
+    std::queue<IncomingMessage> m_recvQueue;
     std::atomic<bool> m_running{false};
+    mutable std::mutex m_connectMutex;
+    std::atomic<bool> m_connectCancelled{false};
+    // Left by the connect thread for poll(); guarded by m_connectMutex
+    struct ConnectResult {
+        bool pending{false};
+        bool success{false};
+        std::string error;
+    };
+    ConnectResult m_connectResult;
+    // First error an I/O thread hit; also guarded by m_connectMutex
+    std::string m_ioError;
+    ConnectStats m_connectStats;
 
     // Callbacks
     ConnectCallback m_connectCallback;
@@ -93,6 +227,20 @@ private:
     std::atomic<uint64_t> m_bytesReceived{0};
     std::atomic<int> m_ping{0};
     uint64_t m_lastPingTime{0};
+    std::atomic<uint64_t> m_sendLatencyTotalUs{0};
+    std::atomic<uint64_t> m_sendLatencySamples{0};
+    std::atomic<uint64_t> m_sendLatencyMaxUs{0};
+    std::atomic<int64_t> m_coalesceDelayUs{0};
+    std::atomic<uint64_t> m_packetsSent{0};
+    std::atomic<uint64_t> m_sendSyscalls{0};
+    std::atomic<uint64_t> m_packetsReceived{0};
+    LatencyHistogram m_rtt;
+    std::atomic<uint64_t> m_jitterUs{0};
+    std::atomic<uint64_t> m_lastRttUs{0};
+    std::atomic<uint32_t> m_sendQueueDepth{0};
+    std::atomic<uint32_t> m_sendQueueMaxDepth{0};
+    LatencyHistogram m_sendQueueTimes;
+    LatencyHistogram m_receiveDelays;
 
     // Socket implementation
     struct Impl;
@@ -152,10 +300,15 @@ public:
     using LoginCallback = std::function<void(bool success, const std::string& message)>;
     using MapCallback = std::function<void()>;
     using DeathCallback = std::function<void()>;
+    // Every received message before it is parsed, e.g. for load statistics
+    using PacketCallback = std::function<void(uint8_t opcode, size_t size)>;
 
     void setLoginCallback(LoginCallback cb) { m_loginCallback = cb; }
     void setMapCallback(MapCallback cb) { m_mapCallback = cb; }
     void setDeathCallback(DeathCallback cb) { m_deathCallback = cb; }
+    void setPacketCallback(PacketCallback cb) { m_packetCallback = cb; }
+
+    const Connection& getConnection() const { return *m_connection; }
 
 private:
     void parseMessage(NetworkMessage& msg);
@@ -181,6 +334,7 @@ private:
     LoginCallback m_loginCallback;
     MapCallback m_mapCallback;
     DeathCallback m_deathCallback;
+    PacketCallback m_packetCallback;
 };
 
 // Login protocol handler
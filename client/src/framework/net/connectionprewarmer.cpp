@@ -0,0 +1,96 @@
+/**
+ * Shadow OT Client - Connection Prewarmer Implementation
+ */
+
+#include "connectionprewarmer.h"
+#include <algorithm>
+
+namespace shadow {
+namespace framework {
+
+ConnectionPrewarmer& ConnectionPrewarmer::instance() {
+    static ConnectionPrewarmer instance;
+    return instance;
+}
+
+ConnectionPrewarmer::~ConnectionPrewarmer() {
+    clear();
+}
+
+bool ConnectionPrewarmer::usable(const Connection& connection) {
+    ConnectionState state = connection.getState();
+    return state == ConnectionState::Connecting || state == ConnectionState::Connected;
+}
+
+void ConnectionPrewarmer::warm(const std::string& host, uint16_t port) {
+    auto now = std::chrono::steady_clock::now();
+    auto it = std::find_if(m_warm.begin(), m_warm.end(), [&](const Warm& warm) {
+        return warm.port == port && warm.host == host;
+    });
+    if (it != m_warm.end()) {
+        if (usable(*it->connection)) {
+            // Most recently highlighted goes last, furthest from eviction
+            Warm warm = std::move(*it);
+            m_warm.erase(it);
+            warm.expires = now + IDLE_TIMEOUT;
+            m_warm.push_back(std::move(warm));
+            return;
+        }
+        it->connection->disconnect();
+        m_warm.erase(it);
+    }
+
+    while (m_warm.size() >= MAX_WARM) {
+        m_warm.front().connection->disconnect();
+        m_warm.pop_front();
+    }
+
+    auto connection = std::make_shared<Connection>();
+    connection->connect(host, port);
+    m_warm.push_back({host, port, std::move(connection), now + IDLE_TIMEOUT});
+    m_stats.warmed++;
+}
+
+std::shared_ptr<Connection> ConnectionPrewarmer::take(const std::string& host, uint16_t port) {
+    for (auto it = m_warm.begin(); it != m_warm.end(); ++it) {
+        if (it->port != port || it->host != host) continue;
+
+        std::shared_ptr<Connection> connection = std::move(it->connection);
+        m_warm.erase(it);
+        if (!usable(*connection)) {
+            connection->disconnect();
+            return nullptr;
+        }
+        m_stats.taken++;
+        return connection;
+    }
+    return nullptr;
+}
+
+void ConnectionPrewarmer::poll() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = m_warm.begin(); it != m_warm.end();) {
+        // Failed attempts show as errors only once their outcome is taken
+        it->connection->pollConnect();
+        if (now < it->expires && usable(*it->connection)) {
+            ++it;
+            continue;
+        }
+        it->connection->disconnect();
+        it = m_warm.erase(it);
+        m_stats.expired++;
+    }
+}
+
+void ConnectionPrewarmer::clear() {
+    for (auto& warm : m_warm) {
+        warm.connection->disconnect();
+    }
+    m_warm.clear();
+}
+
+} // namespace framework
+} // namespace shadow
+
+// Global instance
+shadow::framework::ConnectionPrewarmer& g_prewarmer = shadow::framework::ConnectionPrewarmer::instance();
@@ -0,0 +1,77 @@
+/**
+ * Shadow OT Client - Connection Prewarmer
+ *
+ * Speculative connections to endpoints the player is likely to log into,
+ * opened as soon as a realm or character is highlighted. Resolution and
+ * the TCP handshake then overlap with the player's choice instead of
+ * running after it; whoever connects to the endpoint next takes the open
+ * connection over, and with it anything the server sent meanwhile.
+ * Connections nobody takes are closed after IDLE_TIMEOUT, before a game
+ * server would drop them for not logging in.
+ */
+
+#pragma once
+
+#include "connection.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace shadow {
+namespace framework {
+
+class ConnectionPrewarmer {
+public:
+    static ConnectionPrewarmer& instance();
+
+    static constexpr auto IDLE_TIMEOUT = std::chrono::seconds(20);
+    // Highlighting moves on quickly; only the latest few are kept warm
+    static constexpr size_t MAX_WARM = 2;
+
+    // Starts a connection unless one to this endpoint is already warm, in
+    // which case its idle timeout starts over
+    void warm(const std::string& host, uint16_t port);
+
+    // The warm connection to host:port, connecting or connected, or nullptr.
+    // Its messages are queued until the new owner polls it.
+    std::shared_ptr<Connection> take(const std::string& host, uint16_t port);
+
+    // Closes connections that failed or idled out; main thread, per frame
+    void poll();
+    void clear();
+
+    size_t getWarmCount() const { return m_warm.size(); }
+
+    struct Stats {
+        uint64_t warmed{0};
+        uint64_t taken{0};
+        uint64_t expired{0};
+    };
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    ConnectionPrewarmer() = default;
+    ~ConnectionPrewarmer();
+    ConnectionPrewarmer(const ConnectionPrewarmer&) = delete;
+    ConnectionPrewarmer& operator=(const ConnectionPrewarmer&) = delete;
+
+    struct Warm {
+        std::string host;
+        uint16_t port{0};
+        std::shared_ptr<Connection> connection;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    static bool usable(const Connection& connection);
+
+    std::deque<Warm> m_warm;    // Oldest first
+    Stats m_stats;
+};
+
+} // namespace framework
+} // namespace shadow
+
+// Global accessor
+extern shadow::framework::ConnectionPrewarmer& g_prewarmer;
@@ -0,0 +1,118 @@
+/**
+ * Shadow OT Client - Frame Buffer Implementation
+ */
+
+#include "framebuffer.h"
+#include <cstring>
+#include <utility>
+
+namespace shadow {
+namespace framework {
+
+FrameBuffer::FrameBuffer(size_t capacity)
+    : m_block(NetworkMessagePool::instance().acquireBlock(capacity)) {
+}
+
+FrameBuffer::~FrameBuffer() {
+    NetworkMessagePool::instance().release(m_block);
+    NetworkMessagePool::instance().release(m_spare);
+}
+
+uint8_t* FrameBuffer::writePtr() {
+    if (m_writePos == m_block->capacity) {
+        compact();
+    }
+    return m_block->data + m_writePos;
+}
+
+size_t FrameBuffer::writable() {
+    if (m_writePos == m_block->capacity) {
+        compact();
+    }
+    return m_block->capacity - m_writePos;
+}
+
+void FrameBuffer::commit(size_t bytes) {
+    m_writePos += bytes;
+}
+
+void FrameBuffer::clear() {
+    // Frames already handed out keep their bytes; only unread ones go
+    m_readPos = m_writePos;
+    compact();
+}
+
+FrameBuffer::Result FrameBuffer::nextFrame(NetworkMessage& out) {
+    size_t available = buffered();
+    if (available < NetworkMessage::HEADER_SIZE) {
+        reserveContiguous(NetworkMessage::HEADER_SIZE);
+        return Result::NeedMore;
+    }
+
+    const uint8_t* frame = m_block->data + m_readPos;
+    size_t bodySize = frame[0] | (frame[1] << 8);
+    size_t frameSize = NetworkMessage::HEADER_SIZE + bodySize;
+    if (frameSize > NetworkMessage::MAX_SIZE) {
+        return Result::Invalid;
+    }
+
+    if (available < frameSize) {
+        reserveContiguous(frameSize);
+        return Result::NeedMore;
+    }
+
+    out = NetworkMessage(NetworkMessagePool::instance().slice(m_block, m_readPos, frameSize), frameSize);
+
+    m_readPos += frameSize;
+    if (m_readPos == m_writePos && unshared(m_block)) {
+        m_readPos = m_writePos = 0;
+    }
+
+    return Result::Frame;
+}
+
+bool FrameBuffer::unshared(const MessageBuffer* block) {
+    // Frames are released on the thread that parses them
+    return block->refs.load(std::memory_order_acquire) == 1;
+}
+
+void FrameBuffer::reserveContiguous(size_t frameSize) {
+    if (m_readPos + frameSize > m_block->capacity) {
+        compact();
+    }
+}
+
+void FrameBuffer::compact() {
+    // Move the trailing partial frame to the front so the next read lands
+    // contiguously after it
+    if (m_readPos == 0) {
+        return;
+    }
+
+    size_t remaining = buffered();
+    if (unshared(m_block)) {
+        if (remaining > 0) {
+            std::memmove(m_block->data, m_block->data + m_readPos, remaining);
+        }
+    } else {
+        // Frames before m_readPos are still being parsed; the partial frame
+        // moves to a block nobody reads
+        auto& pool = NetworkMessagePool::instance();
+        MessageBuffer* next = nullptr;
+        if (m_spare && unshared(m_spare)) {
+            next = std::exchange(m_spare, nullptr);
+        } else {
+            next = pool.acquireBlock(m_block->capacity);
+        }
+        if (remaining > 0) {
+            std::memcpy(next->data, m_block->data + m_readPos, remaining);
+        }
+        pool.release(m_spare);
+        m_spare = std::exchange(m_block, next);
+    }
+    m_readPos = 0;
+    m_writePos = remaining;
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,67 @@
+/**
+ * Shadow OT Client - Frame Buffer
+ *
+ * Contiguous receive buffer that reassembles length-prefixed frames
+ * from arbitrarily segmented TCP reads. Frames are handed out as slices
+ * of the buffer's block rather than copies; the bytes a frame occupies
+ * are not written again until its message is released, i.e. after the
+ * parser returns. When the block fills while frames are still out, the
+ * partial frame at its end moves to a second block and the first is
+ * freed by its last frame.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "protocol.h"
+
+namespace shadow {
+namespace framework {
+
+class FrameBuffer {
+public:
+    // Room for one maximum-size frame plus the start of the next
+    static constexpr size_t DEFAULT_CAPACITY = NetworkMessage::MAX_SIZE * 2;
+
+    enum class Result {
+        Frame,      // A complete frame was extracted
+        NeedMore,   // The buffered bytes do not hold a complete frame yet
+        Invalid     // The next frame header announces an impossible size
+    };
+
+    explicit FrameBuffer(size_t capacity = DEFAULT_CAPACITY);
+    ~FrameBuffer();
+
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    // Receive side: write into writePtr(), then commit what was read
+    uint8_t* writePtr();
+    size_t writable();
+    void commit(size_t bytes);
+
+    // Slice the next complete frame (header included) out of the buffer;
+    // out may be decrypted in place
+    Result nextFrame(NetworkMessage& out);
+
+    size_t buffered() const { return m_writePos - m_readPos; }
+    void clear();
+
+private:
+    // Compact only when the pending frame would not fit after m_readPos
+    void reserveContiguous(size_t frameSize);
+    void compact();
+    // No frame sliced from the block is still alive
+    static bool unshared(const MessageBuffer* block);
+
+    MessageBuffer* m_block{nullptr};
+    // The previous block, reused once its last frame is released
+    MessageBuffer* m_spare{nullptr};
+    size_t m_readPos{0};
+    size_t m_writePos{0};
+};
+
+} // namespace framework
+} // namespace shadow
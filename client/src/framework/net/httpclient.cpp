@@ -0,0 +1,819 @@
+/**
+ * Shadow OT Client - HTTP Client Implementation
+ */
+
+#include "httpclient.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string_view>
+
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#define SOCKET int
+#define INVALID_SOCKET -1
+#define closesocket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace fs = std::filesystem;
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x43544853;    // "SHTC"
+constexpr uint16_t CACHE_VERSION = 1;
+constexpr size_t CACHE_HEADER_SIZE = 36;
+
+template<typename T>
+void writeLE(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8));
+    }
+}
+
+template<typename T>
+T readLE(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (i * 8);
+    }
+    return static_cast<T>(value);
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) return {};
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+void setTimeouts(SOCKET sock, int ms) {
+#ifdef _WIN32
+    DWORD timeout = static_cast<DWORD>(ms);
+#else
+    struct timeval timeout;
+    timeout.tv_sec = ms / 1000;
+    timeout.tv_usec = (ms % 1000) * 1000;
+#endif
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+}
+
+void setBlocking(SOCKET sock, bool blocking) {
+#ifdef _WIN32
+    u_long mode = blocking ? 0 : 1;
+    ioctlsocket(sock, FIONBIO, &mode);
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK));
+#endif
+}
+
+// Connect with a deadline, then hand back a blocking socket whose reads
+// and writes time out on their own
+SOCKET connectTo(const std::string& host, uint16_t port, int timeoutMs) {
+    struct addrinfo hints{}, *result = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    std::string portStr = std::to_string(port);
+    if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result) != 0 || !result) {
+        return INVALID_SOCKET;
+    }
+
+    SOCKET connected = INVALID_SOCKET;
+    for (const addrinfo* ai = result; ai && connected == INVALID_SOCKET; ai = ai->ai_next) {
+        SOCKET sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock == INVALID_SOCKET) continue;
+
+        setBlocking(sock, false);
+        int rc = ::connect(sock, ai->ai_addr, static_cast<int>(ai->ai_addrlen));
+#ifdef _WIN32
+        bool inProgress = rc == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        bool inProgress = rc == -1 && errno == EINPROGRESS;
+#endif
+        if (rc != 0 && inProgress) {
+            fd_set writeSet;
+            FD_ZERO(&writeSet);
+            FD_SET(sock, &writeSet);
+            struct timeval timeout;
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_usec = (timeoutMs % 1000) * 1000;
+            int error = -1;
+            socklen_t len = sizeof(error);
+            if (select(static_cast<int>(sock) + 1, nullptr, &writeSet, nullptr, &timeout) > 0) {
+                getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&error, &len);
+            }
+            rc = error == 0 ? 0 : -1;
+        }
+
+        if (rc != 0) {
+            closesocket(sock);
+            continue;
+        }
+
+        setBlocking(sock, true);
+        setTimeouts(sock, timeoutMs);
+        int flag = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&flag, sizeof(flag));
+#ifdef SO_NOSIGPIPE
+        setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, (char*)&flag, sizeof(flag));
+#endif
+        connected = sock;
+    }
+    freeaddrinfo(result);
+    return connected;
+}
+
+} // anonymous namespace
+
+struct HttpClient::Url {
+    bool tls{false};
+    std::string host;
+    uint16_t port{0};
+    std::string path;
+
+    // Pool key; connections are only reused for the same scheme and host
+    std::string endpoint() const {
+        return (tls ? "https://" : "http://") + host + ":" + std::to_string(port);
+    }
+
+    bool parse(const std::string& url) {
+        size_t rest;
+        if (url.compare(0, 8, "https://") == 0) {
+            tls = true;
+            rest = 8;
+        } else if (url.compare(0, 7, "http://") == 0) {
+            tls = false;
+            rest = 7;
+        } else {
+            return false;
+        }
+
+        size_t pathStart = url.find_first_of("/?#", rest);
+        std::string authority = url.substr(rest, pathStart == std::string::npos ? std::string::npos : pathStart - rest);
+        path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+        path = path.substr(0, path.find('#'));
+        if (path.empty() || path[0] != '/') path.insert(path.begin(), '/');
+
+        port = tls ? 443 : 80;
+        size_t colon = authority.rfind(':');
+        if (!authority.empty() && authority[0] == '[') {
+            // IPv6 literal
+            size_t close = authority.find(']');
+            if (close == std::string::npos) return false;
+            host = authority.substr(1, close - 1);
+            colon = authority.size() > close + 1 && authority[close + 1] == ':' ? close + 1 : std::string::npos;
+        } else {
+            host = authority.substr(0, colon);
+        }
+        if (colon != std::string::npos) {
+            int value = std::atoi(authority.c_str() + colon + 1);
+            if (value <= 0 || value > 65535) return false;
+            port = static_cast<uint16_t>(value);
+        }
+        return !host.empty();
+    }
+};
+
+// A blocking connection, optionally wrapped in TLS, with buffered reads
+struct HttpClient::Stream {
+    SOCKET socket{INVALID_SOCKET};
+    SSL* ssl{nullptr};
+    std::string buffer;
+
+    ~Stream() {
+        if (ssl) SSL_free(ssl);
+        if (socket != INVALID_SOCKET) closesocket(socket);
+    }
+
+    bool send(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            int chunk = static_cast<int>(std::min<size_t>(data.size() - sent, 1 << 20));
+            int n = ssl ? SSL_write(ssl, data.data() + sent, chunk)
+                        : ::send(socket, data.data() + sent, chunk, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool fill() {
+        char chunk[16384];
+        int n = ssl ? SSL_read(ssl, chunk, sizeof(chunk)) : ::recv(socket, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    bool readLine(std::string& line) {
+        size_t end;
+        while ((end = buffer.find("\r\n")) == std::string::npos) {
+            if (buffer.size() > 65536 || !fill()) return false;
+        }
+        line = buffer.substr(0, end);
+        buffer.erase(0, end + 2);
+        return true;
+    }
+
+    bool readExact(size_t size, std::vector<uint8_t>& out) {
+        while (buffer.size() < size) {
+            if (!fill()) return false;
+        }
+        out.insert(out.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(size));
+        buffer.erase(0, size);
+        return true;
+    }
+
+    // Pooled connections the server has closed, or sent anything on, are
+    // not reusable
+    bool idleAndOpen() const {
+        if (!buffer.empty()) return false;
+        if (ssl && SSL_pending(ssl) > 0) return false;
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(socket, &readSet);
+        struct timeval timeout{0, 0};
+        return select(static_cast<int>(socket) + 1, &readSet, nullptr, nullptr, &timeout) == 0;
+    }
+};
+
+HttpClient& HttpClient::instance() {
+    static HttpClient instance;
+    return instance;
+}
+
+HttpClient::~HttpClient() {
+    terminate();
+}
+
+bool HttpClient::init(const std::string& cacheDirectory, int concurrency) {
+    if (m_running) return true;
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    m_cacheDirectory = cacheDirectory;
+    if (!m_cacheDirectory.empty()) {
+        std::error_code error;
+        fs::create_directories(m_cacheDirectory, error);
+    }
+
+    SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+    if (context) {
+        SSL_CTX_set_min_proto_version(context, TLS1_2_VERSION);
+        SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+        SSL_CTX_set_default_verify_paths(context);
+    }
+    m_tlsContext = context;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobLimit = static_cast<size_t>(std::max(concurrency, 1));
+    m_running = true;
+    return true;
+}
+
+void HttpClient::terminate() {
+    std::vector<JobSystem::Handle> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running && m_jobs.empty()) return;
+        m_running = false;
+        jobs.swap(m_jobs);
+    }
+    // Each job stops after the request it is on
+    for (const auto& job : jobs) {
+        g_jobs.wait(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+        m_inFlight.clear();
+        m_finished.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_idle.clear();
+    }
+    if (m_tlsContext) {
+        SSL_CTX_free(static_cast<SSL_CTX*>(m_tlsContext));
+        m_tlsContext = nullptr;
+    }
+}
+
+void HttpClient::get(const std::string& url, ResponseCallback callback, Decoder decoder) {
+    std::string key = (decoder ? "d:" : "r:") + url;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.requests++;
+
+        auto it = m_inFlight.find(key);
+        if (it != m_inFlight.end()) {
+            it->second->callbacks.push_back(std::move(callback));
+            m_stats.coalesced++;
+            return;
+        }
+
+        auto request = std::make_shared<Request>();
+        request->key = std::move(key);
+        request->url = url;
+        request->decoder = std::move(decoder);
+        request->callbacks.push_back(std::move(callback));
+
+        if (!m_running) {
+            request->response.error = "HTTP client not initialized";
+            m_finished.push_back(std::move(request));
+            return;
+        }
+
+        m_inFlight[request->key] = request;
+        m_queue.push_back(std::move(request));
+    }
+    scheduleRequests();
+}
+
+void HttpClient::scheduleRequests() {
+    std::vector<JobSystem::Handle> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running || m_jobsActive >= m_jobLimit) return;
+        size_t spawn = std::min(m_jobLimit - m_jobsActive, m_queue.size());
+        if (spawn == 0) return;
+        m_jobsActive += spawn;
+        jobs.resize(spawn);
+    }
+
+    // Submitted unlocked: with the job system stopped they run right here
+    for (auto& job : jobs) {
+        job = g_jobs.submitBlocking([this] { runQueued(); });
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::erase_if(m_jobs, [](const auto& job) { return JobSystem::isDone(job); });
+    m_jobs.insert(m_jobs.end(), jobs.begin(), jobs.end());
+}
+
+void HttpClient::poll() {
+    std::vector<std::shared_ptr<Request>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished.swap(m_finished);
+    }
+
+    for (const auto& request : finished) {
+        for (const auto& callback : request->callbacks) {
+            if (callback) callback(request->response);
+        }
+    }
+}
+
+HttpClient::Stats HttpClient::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+size_t HttpClient::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inFlight.size() + m_finished.size();
+}
+
+void HttpClient::runQueued() {
+#ifndef _WIN32
+    // A write to a connection the server closed would raise SIGPIPE; with it
+    // blocked on whichever thread runs the job the write fails with EPIPE
+    // instead. TLS writes go through write(), where MSG_NOSIGNAL cannot be
+    // passed.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+#endif
+
+    while (true) {
+        std::shared_ptr<Request> request;
+        {
+            // Leaving under the lock, so a request queued after this finds
+            // the job gone and schedules another
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running || m_queue.empty()) {
+                m_jobsActive--;
+                return;
+            }
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        execute(*request);
+
+        // Callbacks are only appended under the lock while the request is in
+        // flight, so once it leaves m_inFlight the list is final
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight.erase(request->key);
+        m_finished.push_back(std::move(request));
+    }
+}
+
+void HttpClient::execute(Request& request) {
+    HttpResponse& response = request.response;
+
+    std::string etag;
+    HttpResponse cached;
+    bool haveCached = loadCached(request.url, etag, cached);
+    bool validated;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        validated = m_validated.count(request.url) > 0;
+    }
+
+    if (haveCached && validated) {
+        response = cached;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.cacheHits++;
+    } else {
+        std::string responseEtag;
+        bool answered = fetch(request.url, haveCached ? etag : std::string(), response, responseEtag);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (answered && response.status == 304 && haveCached) {
+            response = cached;
+            m_validated.insert(request.url);
+            m_stats.notModified++;
+        } else if (answered && response.ok()) {
+            m_validated.insert(request.url);
+            m_stats.downloads++;
+            m_stats.bytesDownloaded += response.body->size();
+        } else if (haveCached && (!answered || response.status >= 500)) {
+            // Offline or a failing server; what we have beats nothing
+            response = cached;
+            m_stats.cacheHits++;
+        } else {
+            m_stats.failures++;
+        }
+
+        if (answered && response.ok() && !response.fromCache) {
+            saveCached(request.url, responseEtag, response);
+        }
+    }
+
+    if (response.ok() && request.decoder) {
+        response.decoded = request.decoder(*response.body);
+    }
+}
+
+bool HttpClient::fetch(const std::string& target, const std::string& etag, HttpResponse& response,
+                       std::string& responseEtag) {
+    std::string current = target;
+    for (int hop = 0; hop <= MAX_REDIRECTS; ++hop) {
+        Url url;
+        if (!url.parse(current)) {
+            response.error = "Unsupported URL: " + current;
+            return false;
+        }
+
+        std::string location;
+        if (!exchange(url, etag, response, responseEtag, location)) {
+            return false;
+        }
+
+        bool redirect = response.status == 301 || response.status == 302 || response.status == 303 ||
+                        response.status == 307 || response.status == 308;
+        if (!redirect || location.empty()) {
+            return true;
+        }
+
+        if (location.compare(0, 7, "http://") == 0 || location.compare(0, 8, "https://") == 0) {
+            current = location;
+        } else if (!location.empty() && location[0] == '/') {
+            current = url.endpoint() + location;
+        } else {
+            return true;
+        }
+    }
+
+    response.status = 0;
+    response.error = "Too many redirects";
+    return false;
+}
+
+bool HttpClient::exchange(const Url& url, const std::string& etag, HttpResponse& response,
+                          std::string& responseEtag, std::string& location) {
+    std::string request = "GET " + url.path + " HTTP/1.1\r\n"
+                          "Host: " + url.host + "\r\n"
+                          "User-Agent: ShadowOT\r\n"
+                          "Accept-Encoding: identity\r\n"
+                          "Connection: keep-alive\r\n";
+    if (!etag.empty()) {
+        request += "If-None-Match: " + etag + "\r\n";
+    }
+    request += "\r\n";
+
+    // A pooled connection may have been closed by the server in the
+    // meantime; that costs one retry on a fresh connection
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        std::unique_ptr<Stream> stream = acquireStream(url, reused);
+        if (!stream) {
+            response.error = "Could not connect to " + url.host;
+            return false;
+        }
+
+        std::string statusLine;
+        if (!stream->send(request) || !stream->readLine(statusLine)) {
+            if (reused) continue;
+            response.error = "No response from " + url.host;
+            return false;
+        }
+
+        // "HTTP/1.1 200 OK"
+        if (statusLine.compare(0, 5, "HTTP/") != 0 || statusLine.size() < 12) {
+            response.error = "Malformed response from " + url.host;
+            return false;
+        }
+        bool http10 = statusLine.compare(5, 3, "1.0") == 0;
+        response.status = std::atoi(statusLine.c_str() + 9);
+
+        int64_t contentLength = -1;
+        bool chunked = false;
+        bool keepAlive = !http10;
+        std::string line;
+        while (true) {
+            if (!stream->readLine(line)) {
+                response.status = 0;
+                response.error = "Truncated response from " + url.host;
+                return false;
+            }
+            if (line.empty()) break;
+
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = toLower(line.substr(0, colon));
+            std::string value = trim(line.substr(colon + 1));
+            if (name == "content-length") {
+                contentLength = std::atoll(value.c_str());
+            } else if (name == "transfer-encoding") {
+                chunked = toLower(value).find("chunked") != std::string::npos;
+            } else if (name == "connection") {
+                std::string token = toLower(value);
+                if (token.find("close") != std::string::npos) keepAlive = false;
+                if (token.find("keep-alive") != std::string::npos) keepAlive = true;
+            } else if (name == "etag") {
+                responseEtag = value;
+            } else if (name == "content-type") {
+                response.contentType = value;
+            } else if (name == "location") {
+                location = value;
+            }
+        }
+
+        auto body = std::make_shared<std::vector<uint8_t>>();
+        bool bodyless = response.status == 204 || response.status == 304 || response.status < 200;
+        bool complete = true;
+        if (bodyless) {
+            // Nothing follows the headers
+        } else if (chunked) {
+            while (complete) {
+                if (!stream->readLine(line)) {
+                    complete = false;
+                    break;
+                }
+                size_t size = std::strtoull(line.c_str(), nullptr, 16);
+                if (size == 0) {
+                    // Trailers end with an empty line
+                    while ((complete = stream->readLine(line)) && !line.empty()) {}
+                    break;
+                }
+                if (body->size() + size > MAX_BODY_SIZE) {
+                    complete = false;
+                    break;
+                }
+                complete = stream->readExact(size, *body) && stream->readLine(line);
+            }
+        } else if (contentLength >= 0) {
+            complete = static_cast<uint64_t>(contentLength) <= MAX_BODY_SIZE &&
+                       stream->readExact(static_cast<size_t>(contentLength), *body);
+        } else {
+            // Delimited by the server closing the connection
+            keepAlive = false;
+            while (stream->fill()) {
+                if (stream->buffer.size() > MAX_BODY_SIZE) {
+                    complete = false;
+                    break;
+                }
+            }
+            body->assign(stream->buffer.begin(), stream->buffer.end());
+            stream->buffer.clear();
+        }
+
+        if (!complete) {
+            response.status = 0;
+            response.error = "Truncated or oversized body from " + url.host;
+            return false;
+        }
+
+        response.body = std::move(body);
+        if (keepAlive) {
+            releaseStream(url, std::move(stream));
+        }
+        return true;
+    }
+
+    response.error = "No response from " + url.host;
+    return false;
+}
+
+std::unique_ptr<HttpClient::Stream> HttpClient::acquireStream(const Url& url, bool& reused) {
+    std::string endpoint = url.endpoint();
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        auto now = std::chrono::steady_clock::now();
+        m_idle.erase(std::remove_if(m_idle.begin(), m_idle.end(), [now](const IdleStream& idle) {
+            return now - idle.since > std::chrono::milliseconds(IDLE_TIMEOUT_MS);
+        }), m_idle.end());
+
+        // Most recently returned first; it is the least likely to be closed
+        for (auto it = m_idle.rbegin(); it != m_idle.rend(); ++it) {
+            if (it->endpoint != endpoint) continue;
+            std::unique_ptr<Stream> stream = std::move(it->stream);
+            m_idle.erase(std::next(it).base());
+            if (stream->idleAndOpen()) {
+                reused = true;
+                std::lock_guard<std::mutex> statsLock(m_mutex);
+                m_stats.connectionsReused++;
+                return stream;
+            }
+            break;
+        }
+    }
+
+    auto stream = std::make_unique<Stream>();
+    stream->socket = connectTo(url.host, url.port, TIMEOUT_MS);
+    if (stream->socket == INVALID_SOCKET) {
+        return nullptr;
+    }
+
+    if (url.tls) {
+        if (!m_tlsContext) return nullptr;
+        stream->ssl = SSL_new(static_cast<SSL_CTX*>(m_tlsContext));
+        if (!stream->ssl) return nullptr;
+        SSL_set_fd(stream->ssl, static_cast<int>(stream->socket));
+        SSL_set_tlsext_host_name(stream->ssl, url.host.c_str());
+        SSL_set1_host(stream->ssl, url.host.c_str());
+        if (SSL_connect(stream->ssl) != 1) {
+            return nullptr;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.connectionsOpened++;
+    return stream;
+}
+
+void HttpClient::releaseStream(const Url& url, std::unique_ptr<Stream> stream) {
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    if (m_idle.size() >= MAX_IDLE_CONNECTIONS) {
+        m_idle.pop_front();
+    }
+    m_idle.push_back({url.endpoint(), std::move(stream), std::chrono::steady_clock::now()});
+}
+
+std::string HttpClient::cachePath(const std::string& url) const {
+    static const char* digits = "0123456789abcdef";
+    uint64_t hash = fnv1a(reinterpret_cast<const uint8_t*>(url.data()), url.size());
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) {
+        name[i] = digits[hash & 0xF];
+    }
+    return (fs::path(m_cacheDirectory) / (name + ".http")).string();
+}
+
+// Cache entry: "SHTC" magic, u16 version, u16 reserved, u64 body size,
+// u64 body FNV-1a, u32 ETag length, u32 content type length, u32 URL
+// length, then the ETag, content type, URL and body
+bool HttpClient::loadCached(const std::string& url, std::string& etag, HttpResponse& response) const {
+    if (m_cacheDirectory.empty()) return false;
+
+    std::ifstream in(cachePath(url), std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < CACHE_HEADER_SIZE) return false;
+
+    const uint8_t* header = data.data();
+    uint64_t bodySize = readLE<uint64_t>(header + 8);
+    uint32_t etagSize = readLE<uint32_t>(header + 24);
+    uint32_t typeSize = readLE<uint32_t>(header + 28);
+    uint32_t urlSize = readLE<uint32_t>(header + 32);
+    uint64_t expected = CACHE_HEADER_SIZE + uint64_t(etagSize) + typeSize + urlSize + bodySize;
+    if (readLE<uint32_t>(header) != CACHE_MAGIC || readLE<uint16_t>(header + 4) != CACHE_VERSION ||
+        expected != data.size()) {
+        return false;
+    }
+
+    const char* strings = reinterpret_cast<const char*>(header + CACHE_HEADER_SIZE);
+    // Entries are named by hash; a colliding URL is a miss
+    if (std::string_view(strings + etagSize + typeSize, urlSize) != url) return false;
+
+    const uint8_t* body = header + CACHE_HEADER_SIZE + etagSize + typeSize + urlSize;
+    if (fnv1a(body, bodySize) != readLE<uint64_t>(header + 16)) return false;
+
+    etag.assign(strings, etagSize);
+    response.status = 200;
+    response.contentType.assign(strings + etagSize, typeSize);
+    response.body = std::make_shared<std::vector<uint8_t>>(body, body + bodySize);
+    response.fromCache = true;
+    return true;
+}
+
+bool HttpClient::saveCached(const std::string& url, const std::string& etag, const HttpResponse& response) const {
+    if (m_cacheDirectory.empty() || !response.body) return false;
+
+    const auto& body = *response.body;
+    std::vector<uint8_t> data(CACHE_HEADER_SIZE);
+    uint8_t* header = data.data();
+    writeLE<uint32_t>(header, CACHE_MAGIC);
+    writeLE<uint16_t>(header + 4, CACHE_VERSION);
+    writeLE<uint16_t>(header + 6, 0);
+    writeLE<uint64_t>(header + 8, body.size());
+    writeLE<uint64_t>(header + 16, fnv1a(body.data(), body.size()));
+    writeLE<uint32_t>(header + 24, static_cast<uint32_t>(etag.size()));
+    writeLE<uint32_t>(header + 28, static_cast<uint32_t>(response.contentType.size()));
+    writeLE<uint32_t>(header + 32, static_cast<uint32_t>(url.size()));
+    data.insert(data.end(), etag.begin(), etag.end());
+    data.insert(data.end(), response.contentType.begin(), response.contentType.end());
+    data.insert(data.end(), url.begin(), url.end());
+    data.insert(data.end(), body.begin(), body.end());
+
+    // Written aside and renamed, so a reader never sees a partial entry
+    std::error_code error;
+    fs::path target(cachePath(url));
+    fs::path temporary = target;
+    temporary += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            out.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace framework
+} // namespace shadow
+
+// Global instance
+shadow::framework::HttpClient& g_http = shadow::framework::HttpClient::instance();
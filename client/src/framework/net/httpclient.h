@@ -0,0 +1,150 @@
+/**
+ * Shadow OT Client - HTTP Client
+ *
+ * Asynchronous HTTP/1.1 GETs for web assets such as NFT metadata and
+ * images. Requests run as blocking jobs on g_jobs, a few at once, and
+ * each returns its connection to a shared keep-alive pool, so
+ * follow-up requests to the same host skip the TCP and TLS handshakes.
+ * Several requests for one URL while it is in flight share a single
+ * download.
+ *
+ * Responses are kept in a disk cache along with their ETag. A cached URL
+ * is revalidated with If-None-Match once per session; after that, and
+ * while the server cannot be reached, it is served from disk. An optional
+ * decode step runs in the request's job, so images arrive decoded. Callbacks run
+ * from poll() on the main thread.
+ */
+
+#pragma once
+
+#include <framework/core/jobsystem.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+struct HttpResponse {
+    int status{0};                  // 0 if the request never got an answer
+    std::string error;
+    std::string contentType;
+    std::shared_ptr<const std::vector<uint8_t>> body;
+    std::shared_ptr<const void> decoded;    // Result of the request's decode step
+    bool fromCache{false};
+
+    bool ok() const { return status >= 200 && status < 300 && body; }
+};
+
+class HttpClient {
+public:
+    static constexpr int DEFAULT_CONCURRENCY = 4;
+    static constexpr size_t MAX_BODY_SIZE = 16 * 1024 * 1024;
+    static constexpr int MAX_REDIRECTS = 3;
+    static constexpr int TIMEOUT_MS = 10000;
+    static constexpr int IDLE_TIMEOUT_MS = 30000;
+    static constexpr size_t MAX_IDLE_CONNECTIONS = 8;
+
+    using ResponseCallback = std::function<void(const HttpResponse&)>;
+    // Runs in the request's job for a successful response; the result is passed on as
+    // HttpResponse::decoded, nullptr meaning the body could not be decoded
+    using Decoder = std::function<std::shared_ptr<const void>(const std::vector<uint8_t>&)>;
+
+    static HttpClient& instance();
+
+    // Responses are cached under cacheDirectory; empty disables the cache.
+    // At most `concurrency` requests run at once.
+    bool init(const std::string& cacheDirectory, int concurrency = DEFAULT_CONCURRENCY);
+    void terminate();
+
+    // http:// and https:// URLs. Requests for a URL already in flight with
+    // the same kind of decoder join it.
+    void get(const std::string& url, ResponseCallback callback, Decoder decoder = nullptr);
+
+    // Deliver finished requests; main thread
+    void poll();
+
+    struct Stats {
+        uint64_t requests{0};
+        uint64_t coalesced{0};
+        uint64_t cacheHits{0};          // Served from disk without the network
+        uint64_t notModified{0};        // Revalidated with a 304
+        uint64_t downloads{0};
+        uint64_t bytesDownloaded{0};
+        uint64_t connectionsOpened{0};
+        uint64_t connectionsReused{0};
+        uint64_t failures{0};
+    };
+    Stats getStats() const;
+    size_t getPendingCount() const;
+
+private:
+    HttpClient() = default;
+    ~HttpClient();
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    struct Request {
+        std::string key;
+        std::string url;
+        Decoder decoder;
+        std::vector<ResponseCallback> callbacks;
+        HttpResponse response;
+    };
+    struct Stream;
+    struct Url;
+
+    // Tops up request jobs for what is queued; without m_mutex held
+    void scheduleRequests();
+    // One request job: takes requests until the queue is empty
+    void runQueued();
+    void execute(Request& request);
+    // One exchange, following redirects; fills status, headers and body
+    bool fetch(const std::string& url, const std::string& etag, HttpResponse& response,
+               std::string& responseEtag);
+    bool exchange(const Url& url, const std::string& etag, HttpResponse& response,
+                  std::string& responseEtag, std::string& location);
+
+    std::unique_ptr<Stream> acquireStream(const Url& url, bool& reused);
+    void releaseStream(const Url& url, std::unique_ptr<Stream> stream);
+
+    bool loadCached(const std::string& url, std::string& etag, HttpResponse& response) const;
+    bool saveCached(const std::string& url, const std::string& etag, const HttpResponse& response) const;
+    std::string cachePath(const std::string& url) const;
+
+    std::string m_cacheDirectory;
+    void* m_tlsContext{nullptr};    // SSL_CTX, created in init()
+
+    mutable std::mutex m_mutex;
+    bool m_running{false};
+    std::vector<JobSystem::Handle> m_jobs;
+    size_t m_jobLimit{0};
+    size_t m_jobsActive{0};
+    std::deque<std::shared_ptr<Request>> m_queue;
+    std::unordered_map<std::string, std::shared_ptr<Request>> m_inFlight;
+    std::vector<std::shared_ptr<Request>> m_finished;
+    std::unordered_set<std::string> m_validated;    // URLs checked against the server this session
+
+    std::mutex m_poolMutex;
+    struct IdleStream {
+        std::string endpoint;
+        std::unique_ptr<Stream> stream;
+        std::chrono::steady_clock::time_point since;
+    };
+    std::deque<IdleStream> m_idle;
+
+    Stats m_stats;
+};
+
+} // namespace framework
+} // namespace shadow
+
+// Global accessor
+extern shadow::framework::HttpClient& g_http;
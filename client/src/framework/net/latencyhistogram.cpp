@@ -0,0 +1,78 @@
+/**
+ * Shadow OT Client - Latency Histogram Implementation
+ */
+
+#include "latencyhistogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace shadow {
+namespace framework {
+
+size_t LatencyHistogram::bucketOf(uint64_t us) {
+    if (us < LINEAR_BUCKETS) return static_cast<size_t>(us);
+    us = std::min<uint64_t>(us, UINT32_MAX);
+
+    // Exponent 4 and up; the three bits under the leading one pick the
+    // sub-bucket
+    int exponent = std::bit_width(us) - 1;
+    size_t sub = static_cast<size_t>(us >> (exponent - 3)) & (SUB_BUCKETS - 1);
+    return LINEAR_BUCKETS + static_cast<size_t>(exponent - 4) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::valueOf(size_t bucket) {
+    if (bucket < LINEAR_BUCKETS) return bucket;
+    int exponent = static_cast<int>((bucket - LINEAR_BUCKETS) / SUB_BUCKETS) + 4;
+    uint64_t sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+    uint64_t width = uint64_t{1} << (exponent - 3);
+    return (uint64_t{1} << exponent) + sub * width + width / 2;
+}
+
+void LatencyHistogram::record(uint64_t us) {
+    m_buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(us, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean() const {
+    uint64_t count = getCount();
+    return count > 0 ? static_cast<double>(m_total.load(std::memory_order_relaxed)) / count : 0.0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double q) const {
+    // Sum the buckets rather than trusting m_count, which a concurrent
+    // record() may have bumped before its bucket
+    uint64_t count = 0;
+    for (const auto& bucket : m_buckets) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+    if (count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(valueOf(i), getMax());
+        }
+    }
+    return getMax();
+}
+
+} // namespace framework
+} // namespace shadow
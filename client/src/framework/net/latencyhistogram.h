@@ -0,0 +1,47 @@
+/**
+ * Shadow OT Client - Latency Histogram
+ *
+ * Lock-free histogram of durations in microseconds, for percentiles of
+ * samples recorded on I/O threads and read from the main thread. Buckets
+ * are log-linear: exact below 16us, then eight per power of two, so any
+ * percentile is within about 6% of the true value up to an hour.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace shadow {
+namespace framework {
+
+class LatencyHistogram {
+public:
+    static constexpr size_t LINEAR_BUCKETS = 16;
+    static constexpr size_t SUB_BUCKETS = 8;
+    static constexpr size_t BUCKET_COUNT = LINEAR_BUCKETS + (32 - 4) * SUB_BUCKETS;
+
+    void record(uint64_t us);
+    void reset();
+
+    uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return m_max.load(std::memory_order_relaxed); }
+    double getMean() const;
+    // Value below which the fraction q (0..1) of samples fall; 0 when empty
+    uint64_t getPercentile(double q) const;
+
+private:
+    static size_t bucketOf(uint64_t us);
+    // Middle of the bucket's range
+    static uint64_t valueOf(size_t bucket);
+
+    std::array<std::atomic<uint32_t>, BUCKET_COUNT> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_total{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+} // namespace framework
+} // namespace shadow
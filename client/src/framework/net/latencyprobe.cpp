@@ -0,0 +1,188 @@
+/**
+ * Shadow OT Client - Latency Probe Implementation
+ */
+
+#include "latencyprobe.h"
+#include <framework/core/jobsystem.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#define SOCKET int
+#define INVALID_SOCKET -1
+#define closesocket close
+#endif
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+struct Endpoint {
+    sockaddr_storage address{};
+    socklen_t length{0};
+    int family{AF_UNSPEC};
+};
+
+bool resolve(const LatencyProbe::Target& target, Endpoint& endpoint) {
+    struct addrinfo hints{}, *result = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    std::string port = std::to_string(target.port);
+    if (getaddrinfo(target.host.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+        return false;
+    }
+
+    // The first address is the one the resolver would have us connect to
+    bool found = false;
+    for (const addrinfo* ai = result; ai && !found; ai = ai->ai_next) {
+        if ((ai->ai_family == AF_INET || ai->ai_family == AF_INET6) && ai->ai_addrlen <= sizeof(endpoint.address)) {
+            std::memcpy(&endpoint.address, ai->ai_addr, ai->ai_addrlen);
+            endpoint.length = static_cast<socklen_t>(ai->ai_addrlen);
+            endpoint.family = ai->ai_family;
+            found = true;
+        }
+    }
+    freeaddrinfo(result);
+    return found;
+}
+
+SOCKET startConnect(const Endpoint& endpoint) {
+    SOCKET sock = socket(endpoint.family, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        return INVALID_SOCKET;
+    }
+
+#ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(sock, FIONBIO, &mode);
+    if (::connect(sock, reinterpret_cast<const sockaddr*>(&endpoint.address), endpoint.length) == SOCKET_ERROR &&
+        WSAGetLastError() != WSAEWOULDBLOCK) {
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    if (::connect(sock, reinterpret_cast<const sockaddr*>(&endpoint.address), endpoint.length) == -1 &&
+        errno != EINPROGRESS) {
+#endif
+        closesocket(sock);
+        return INVALID_SOCKET;
+    }
+    return sock;
+}
+
+} // anonymous namespace
+
+std::vector<int> LatencyProbe::measure(const std::vector<Target>& targets, int rounds,
+                                       std::chrono::milliseconds timeout, const std::atomic<bool>* cancel) {
+#ifdef _WIN32
+    static bool wsaInitialized = [] {
+        WSADATA wsaData;
+        return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+    }();
+    (void)wsaInitialized;
+#endif
+
+    auto cancelled = [cancel]() { return cancel && cancel->load(std::memory_order_relaxed); };
+    std::vector<int> results(targets.size(), -1);
+
+    // getaddrinfo blocks, so the targets resolve side by side; waiting on
+    // the I/O threads runs lookups still queued
+    std::vector<JobSystem::Handle> resolving;
+    std::vector<Endpoint> endpoints(targets.size());
+    auto resolved = std::make_unique<bool[]>(targets.size());
+    resolving.reserve(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i) {
+        resolving.push_back(g_jobs.submitBlocking([&targets, &endpoints, &resolved, i]() {
+            resolved[i] = resolve(targets[i], endpoints[i]);
+        }));
+    }
+    for (const auto& job : resolving) {
+        g_jobs.wait(job);
+    }
+
+    struct Attempt {
+        size_t target;
+        SOCKET socket;
+    };
+
+    for (int round = 0; round < rounds && !cancelled(); ++round) {
+        std::vector<Attempt> pending;
+        auto started = std::chrono::steady_clock::now();
+        auto deadline = started + timeout;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (!resolved[i]) continue;
+            SOCKET sock = startConnect(endpoints[i]);
+            if (sock != INVALID_SOCKET) {
+                pending.push_back({i, sock});
+            }
+        }
+
+        while (!pending.empty() && !cancelled()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) break;
+
+            fd_set writeSet, errorSet;
+            FD_ZERO(&writeSet);
+            FD_ZERO(&errorSet);
+            SOCKET maxSocket = 0;
+            for (const auto& attempt : pending) {
+                FD_SET(attempt.socket, &writeSet);
+                FD_SET(attempt.socket, &errorSet);
+                maxSocket = std::max(maxSocket, attempt.socket);
+            }
+
+            // Short slices so cancellation is prompt
+            auto waitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::min<std::chrono::steady_clock::duration>(deadline - now, std::chrono::milliseconds(50))).count();
+            struct timeval wait;
+            wait.tv_sec = static_cast<long>(waitUs / 1000000);
+            wait.tv_usec = static_cast<long>(waitUs % 1000000);
+            if (select(static_cast<int>(maxSocket) + 1, nullptr, &writeSet, &errorSet, &wait) <= 0) {
+                continue;
+            }
+
+            auto completed = std::chrono::steady_clock::now();
+            for (auto it = pending.begin(); it != pending.end();) {
+                if (!FD_ISSET(it->socket, &writeSet) && !FD_ISSET(it->socket, &errorSet)) {
+                    ++it;
+                    continue;
+                }
+
+                int error = 0;
+                socklen_t len = sizeof(error);
+                getsockopt(it->socket, SOL_SOCKET, SO_ERROR, (char*)&error, &len);
+                if (error == 0) {
+                    int ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                        completed - started).count());
+                    int& best = results[it->target];
+                    best = best < 0 ? ms : std::min(best, ms);
+                }
+                closesocket(it->socket);
+                it = pending.erase(it);
+            }
+        }
+
+        for (const auto& attempt : pending) {
+            closesocket(attempt.socket);
+        }
+    }
+    return results;
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,344 @@
+/**
+ * Shadow OT Client - Network Reactor Implementation
+ */
+
+#include "networkreactor.h"
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#include <unistd.h>
+#define SHADOW_REACTOR_KQUEUE
+#else
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#define SHADOW_REACTOR_EPOLL
+#endif
+
+namespace shadow {
+namespace framework {
+
+static constexpr int MAX_EVENTS = 64;
+
+struct NetworkReactor::Impl {
+#if defined(SHADOW_REACTOR_EPOLL)
+    int epollFd{-1};
+    int wakeFd{-1};
+
+    static uint32_t toEpoll(uint32_t interest) {
+        uint32_t events = EPOLLRDHUP;
+        if (interest & Readable) events |= EPOLLIN;
+        if (interest & Writable) events |= EPOLLOUT;
+        return events;
+    }
+
+    void ctl(int op, NativeSocket socket, uint32_t interest) {
+        epoll_event ev{};
+        ev.events = toEpoll(interest);
+        ev.data.u64 = socket;
+        epoll_ctl(epollFd, op, static_cast<int>(socket), &ev);
+    }
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    int kqueueFd{-1};
+
+    void apply(NativeSocket socket, uint32_t interest, bool adding) {
+        struct kevent changes[2];
+        uint16_t readFlags = adding ? EV_ADD : 0;
+        uint16_t writeFlags = adding ? EV_ADD : 0;
+        readFlags |= (interest & Readable) ? EV_ENABLE : EV_DISABLE;
+        writeFlags |= (interest & Writable) ? EV_ENABLE : EV_DISABLE;
+        EV_SET(&changes[0], socket, EVFILT_READ, readFlags, 0, 0, nullptr);
+        EV_SET(&changes[1], socket, EVFILT_WRITE, writeFlags, 0, 0, nullptr);
+        kevent(kqueueFd, changes, 2, nullptr, 0, nullptr);
+    }
+#else
+    // WSAPoll cannot wait on an event object, so wakeups go through a
+    // loopback UDP socket that is polled alongside the connections
+    SOCKET wakeRecv{INVALID_SOCKET};
+    SOCKET wakeSend{INVALID_SOCKET};
+#endif
+};
+
+NetworkReactor& NetworkReactor::instance() {
+    static NetworkReactor instance;
+    return instance;
+}
+
+NetworkReactor::NetworkReactor() : m_impl(std::make_unique<Impl>()) {
+#if defined(SHADOW_REACTOR_EPOLL)
+    m_impl->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_impl->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = static_cast<NativeSocket>(m_impl->wakeFd);
+    epoll_ctl(m_impl->epollFd, EPOLL_CTL_ADD, m_impl->wakeFd, &ev);
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    m_impl->kqueueFd = kqueue();
+    struct kevent ev;
+    EV_SET(&ev, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+    kevent(m_impl->kqueueFd, &ev, 1, nullptr, 0, nullptr);
+#else
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int addrLen = sizeof(addr);
+
+    m_impl->wakeRecv = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    bind(m_impl->wakeRecv, reinterpret_cast<sockaddr*>(&addr), addrLen);
+    getsockname(m_impl->wakeRecv, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+
+    m_impl->wakeSend = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    connect(m_impl->wakeSend, reinterpret_cast<sockaddr*>(&addr), addrLen);
+
+    u_long mode = 1;
+    ioctlsocket(m_impl->wakeRecv, FIONBIO, &mode);
+#endif
+}
+
+NetworkReactor::~NetworkReactor() {
+    shutdown();
+
+#if defined(SHADOW_REACTOR_EPOLL)
+    close(m_impl->wakeFd);
+    close(m_impl->epollFd);
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    close(m_impl->kqueueFd);
+#else
+    closesocket(m_impl->wakeSend);
+    closesocket(m_impl->wakeRecv);
+#endif
+}
+
+bool NetworkReactor::add(NativeSocket socket, uint32_t interest, Handler handler) {
+    auto entry = std::make_shared<Entry>();
+    entry->interest = interest;
+    entry->handler = std::move(handler);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_entries.count(socket)) {
+            return false;
+        }
+        m_entries[socket] = entry;
+    }
+
+#if defined(SHADOW_REACTOR_EPOLL)
+    m_impl->ctl(EPOLL_CTL_ADD, socket, interest);
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    m_impl->apply(socket, interest, true);
+#else
+    wakeup();
+#endif
+
+    start();
+    return true;
+}
+
+void NetworkReactor::modify(NativeSocket socket, uint32_t interest) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(socket);
+        if (it == m_entries.end() || it->second->interest == interest) {
+            return;
+        }
+        it->second->interest = interest;
+    }
+
+#if defined(SHADOW_REACTOR_EPOLL)
+    m_impl->ctl(EPOLL_CTL_MOD, socket, interest);
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    m_impl->apply(socket, interest, false);
+#else
+    wakeup();
+#endif
+}
+
+void NetworkReactor::remove(NativeSocket socket) {
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(socket);
+        if (it == m_entries.end()) {
+            return;
+        }
+        entry = it->second;
+        m_entries.erase(it);
+    }
+
+#if defined(SHADOW_REACTOR_EPOLL)
+    epoll_event ev{};
+    epoll_ctl(m_impl->epollFd, EPOLL_CTL_DEL, static_cast<int>(socket), &ev);
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    struct kevent changes[2];
+    EV_SET(&changes[0], socket, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    EV_SET(&changes[1], socket, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    kevent(m_impl->kqueueFd, changes, 2, nullptr, 0, nullptr);
+#else
+    wakeup();
+#endif
+
+    // Wait out a handler that is mid-dispatch on the reactor thread
+    std::lock_guard<std::recursive_mutex> dispatchLock(entry->dispatchMutex);
+    entry->removed = true;
+}
+
+size_t NetworkReactor::getSocketCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+void NetworkReactor::start() {
+    bool expected = false;
+    if (!m_running.compare_exchange_strong(expected, true)) {
+        return;
+    }
+
+    m_thread = std::make_unique<std::thread>([this]() {
+        run();
+    });
+}
+
+void NetworkReactor::shutdown() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+
+    wakeup();
+    if (m_thread && m_thread->joinable()) {
+        m_thread->join();
+    }
+    m_thread.reset();
+}
+
+void NetworkReactor::wakeup() {
+#if defined(SHADOW_REACTOR_EPOLL)
+    uint64_t one = 1;
+    ssize_t written = write(m_impl->wakeFd, &one, sizeof(one));
+    (void)written;
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    struct kevent ev;
+    EV_SET(&ev, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+    kevent(m_impl->kqueueFd, &ev, 1, nullptr, 0, nullptr);
+#else
+    char byte = 0;
+    ::send(m_impl->wakeSend, &byte, 1, 0);
+#endif
+}
+
+void NetworkReactor::dispatch(NativeSocket socket, uint32_t events) {
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(socket);
+        if (it == m_entries.end()) {
+            return;
+        }
+        entry = it->second;
+    }
+
+    std::lock_guard<std::recursive_mutex> dispatchLock(entry->dispatchMutex);
+    if (!entry->removed) {
+        entry->handler(events);
+    }
+}
+
+void NetworkReactor::run() {
+    m_threadId = std::this_thread::get_id();
+
+#if defined(SHADOW_REACTOR_EPOLL)
+    epoll_event events[MAX_EVENTS];
+
+    while (m_running) {
+        int count = epoll_wait(m_impl->epollFd, events, MAX_EVENTS, -1);
+        m_wakeups++;
+
+        for (int i = 0; i < count; ++i) {
+            NativeSocket socket = events[i].data.u64;
+            if (socket == static_cast<NativeSocket>(m_impl->wakeFd)) {
+                uint64_t value;
+                ssize_t drained = read(m_impl->wakeFd, &value, sizeof(value));
+                (void)drained;
+                continue;
+            }
+
+            uint32_t flags = 0;
+            if (events[i].events & EPOLLIN) flags |= ReadReady;
+            if (events[i].events & EPOLLOUT) flags |= WriteReady;
+            if (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) flags |= Hangup;
+            dispatch(socket, flags);
+        }
+    }
+#elif defined(SHADOW_REACTOR_KQUEUE)
+    struct kevent events[MAX_EVENTS];
+
+    while (m_running) {
+        int count = kevent(m_impl->kqueueFd, nullptr, 0, events, MAX_EVENTS, nullptr);
+        m_wakeups++;
+
+        for (int i = 0; i < count; ++i) {
+            if (events[i].filter == EVFILT_USER) {
+                continue;
+            }
+
+            uint32_t flags = 0;
+            if (events[i].filter == EVFILT_READ) flags |= ReadReady;
+            if (events[i].filter == EVFILT_WRITE) flags |= WriteReady;
+            if (events[i].flags & (EV_EOF | EV_ERROR)) flags |= Hangup;
+            dispatch(static_cast<NativeSocket>(events[i].ident), flags);
+        }
+    }
+#else
+    std::vector<WSAPOLLFD> fds;
+
+    while (m_running) {
+        fds.clear();
+        fds.push_back({m_impl->wakeRecv, POLLRDNORM, 0});
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& [socket, entry] : m_entries) {
+                SHORT events = 0;
+                if (entry->interest & Readable) events |= POLLRDNORM;
+                if (entry->interest & Writable) events |= POLLWRNORM;
+                fds.push_back({static_cast<SOCKET>(socket), events, 0});
+            }
+        }
+
+        int count = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), -1);
+        m_wakeups++;
+        if (count <= 0) {
+            continue;
+        }
+
+        if (fds[0].revents) {
+            char drain[64];
+            while (recv(m_impl->wakeRecv, drain, sizeof(drain), 0) > 0) {}
+        }
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            uint32_t flags = 0;
+            if (fds[i].revents & POLLRDNORM) flags |= ReadReady;
+            if (fds[i].revents & POLLWRNORM) flags |= WriteReady;
+            if (fds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) flags |= Hangup;
+            if (flags) {
+                dispatch(static_cast<NativeSocket>(fds[i].fd), flags);
+            }
+        }
+    }
+#endif
+}
+
+} // namespace framework
+} // namespace shadow
+
+// Global instance
+shadow::framework::NetworkReactor& g_reactor = shadow::framework::NetworkReactor::instance();
@@ -0,0 +1,90 @@
+/**
+ * Shadow OT Client - Network Reactor
+ *
+ * Single I/O thread multiplexing every reactor-backed Connection through
+ * epoll (Linux), kqueue (macOS/BSD) or WSAPoll (Windows).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+namespace shadow {
+namespace framework {
+
+// Native socket handle (int on POSIX, SOCKET on Windows)
+using NativeSocket = uintptr_t;
+
+class NetworkReactor {
+public:
+    static NetworkReactor& instance();
+
+    enum Interest : uint32_t {
+        Readable = 1 << 0,
+        Writable = 1 << 1
+    };
+
+    enum EventFlags : uint32_t {
+        ReadReady = 1 << 0,
+        WriteReady = 1 << 1,
+        Hangup = 1 << 2
+    };
+
+    // Invoked on the reactor thread with a mask of EventFlags
+    using Handler = std::function<void(uint32_t events)>;
+
+    // Registration (thread-safe). remove() guarantees the handler is not
+    // running and will not run again once it returns, unless called from
+    // inside that handler.
+    bool add(NativeSocket socket, uint32_t interest, Handler handler);
+    void modify(NativeSocket socket, uint32_t interest);
+    void remove(NativeSocket socket);
+
+    bool isReactorThread() const { return std::this_thread::get_id() == m_threadId; }
+    size_t getSocketCount() const;
+    uint64_t getWakeups() const { return m_wakeups; }
+
+    void shutdown();
+
+private:
+    NetworkReactor();
+    ~NetworkReactor();
+    NetworkReactor(const NetworkReactor&) = delete;
+    NetworkReactor& operator=(const NetworkReactor&) = delete;
+
+    void start();
+    void run();
+    void wakeup();
+    void dispatch(NativeSocket socket, uint32_t events);
+
+    struct Entry {
+        uint32_t interest{0};
+        Handler handler;
+        bool removed{false};
+        // Held while the handler runs; recursive so a handler may remove itself
+        std::recursive_mutex dispatchMutex;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<NativeSocket, std::shared_ptr<Entry>> m_entries;
+    std::unique_ptr<std::thread> m_thread;
+    std::atomic<std::thread::id> m_threadId;
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_wakeups{0};
+
+    // Backend state (epoll/kqueue descriptor, wakeup channel)
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace framework
+} // namespace shadow
+
+// Global accessor
+extern shadow::framework::NetworkReactor& g_reactor;
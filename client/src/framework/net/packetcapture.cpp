@@ -0,0 +1,186 @@
+/**
+ * Shadow OT Client - Packet Capture Implementation
+ */
+
+#include "packetcapture.h"
+#include <algorithm>
+
+namespace shadow {
+namespace framework {
+
+template<typename T>
+static void writeLE(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+template<typename T>
+static T readLE(const uint8_t* in) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(in[i]) << (i * 8);
+    }
+    return value;
+}
+
+// PacketRecorder
+
+PacketRecorder::~PacketRecorder() {
+    close();
+}
+
+bool PacketRecorder::open(const std::string& path) {
+    close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        return false;
+    }
+
+    auto wallclock = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    uint8_t header[FILE_HEADER_SIZE];
+    writeLE<uint32_t>(header, MAGIC);
+    writeLE<uint16_t>(header + 4, VERSION);
+    writeLE<uint16_t>(header + 6, 0);
+    writeLE<uint64_t>(header + 8, static_cast<uint64_t>(wallclock));
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    m_last = std::chrono::steady_clock::now();
+    m_frames = 0;
+    m_bytes = sizeof(header);
+    return true;
+}
+
+void PacketRecorder::close() {
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+}
+
+void PacketRecorder::record(const NetworkMessage& frame) {
+    if (!m_file.is_open()) return;
+
+    auto now = std::chrono::steady_clock::now();
+    auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - m_last).count();
+    m_last = now;
+
+    size_t length = frame.getRemainingSize();
+    uint8_t header[RECORD_HEADER_SIZE];
+    writeLE<uint32_t>(header, static_cast<uint32_t>(std::min<int64_t>(delta, UINT32_MAX)));
+    writeLE<uint16_t>(header + 4, static_cast<uint16_t>(length));
+
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    m_file.write(reinterpret_cast<const char*>(frame.getBuffer() + frame.getPosition()), length);
+
+    m_frames++;
+    m_bytes += sizeof(header) + length;
+}
+
+// PacketReplayer
+
+bool PacketReplayer::open(const std::string& path) {
+    close();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    auto size = static_cast<size_t>(file.tellg());
+    if (size < PacketRecorder::FILE_HEADER_SIZE) {
+        return false;
+    }
+
+    m_data.resize(size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(m_data.data()), size);
+
+    if (readLE<uint32_t>(m_data.data()) != PacketRecorder::MAGIC ||
+        readLE<uint16_t>(m_data.data() + 4) != PacketRecorder::VERSION) {
+        m_data.clear();
+        return false;
+    }
+
+    // Index pass: validate records and total up the capture
+    m_offset = PacketRecorder::FILE_HEADER_SIZE;
+    uint32_t deltaUs;
+    uint16_t length;
+    while (readRecord(deltaUs, length)) {
+        m_frameCount++;
+        m_durationUs += deltaUs;
+        m_offset += PacketRecorder::RECORD_HEADER_SIZE + length;
+    }
+
+    // Drop a truncated tail (e.g. the client died mid-write)
+    m_data.resize(m_offset);
+    rewind();
+    return true;
+}
+
+void PacketReplayer::close() {
+    m_data.clear();
+    m_offset = 0;
+    m_frameCount = 0;
+    m_durationUs = 0;
+    m_delivered = 0;
+    m_started = false;
+}
+
+void PacketReplayer::rewind() {
+    m_offset = PacketRecorder::FILE_HEADER_SIZE;
+    m_delivered = 0;
+    m_clockUs = 0;
+    m_started = false;
+}
+
+bool PacketReplayer::readRecord(uint32_t& deltaUs, uint16_t& length) const {
+    if (m_offset + PacketRecorder::RECORD_HEADER_SIZE > m_data.size()) {
+        return false;
+    }
+
+    deltaUs = readLE<uint32_t>(m_data.data() + m_offset);
+    length = readLE<uint16_t>(m_data.data() + m_offset + 4);
+    return m_offset + PacketRecorder::RECORD_HEADER_SIZE + length <= m_data.size();
+}
+
+size_t PacketReplayer::poll(const FrameCallback& deliver) {
+    if (!m_started) {
+        m_startTime = std::chrono::steady_clock::now();
+        m_started = true;
+    }
+
+    uint64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_startTime).count();
+
+    size_t count = 0;
+    uint32_t deltaUs;
+    uint16_t length;
+    while (readRecord(deltaUs, length)) {
+        if (m_speed == Speed::Realtime && m_clockUs + deltaUs > elapsedUs) {
+            break;
+        }
+
+        m_clockUs += deltaUs;
+        const uint8_t* body = m_data.data() + m_offset + PacketRecorder::RECORD_HEADER_SIZE;
+        m_offset += PacketRecorder::RECORD_HEADER_SIZE + length;
+
+        NetworkMessage frame(NetworkMessage::HEADER_SIZE + length);
+        frame.writeBytes(body, length);
+        uint8_t* buffer = frame.getBuffer();
+        buffer[0] = length & 0xFF;
+        buffer[1] = (length >> 8) & 0xFF;
+        frame.setPosition(NetworkMessage::HEADER_SIZE);
+
+        deliver(frame);
+        m_delivered++;
+        count++;
+    }
+
+    return count;
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,99 @@
+/**
+ * Shadow OT Client - Packet Capture
+ *
+ * Records plaintext inbound frames with timestamps to a compact binary
+ * file, and replays such a capture at original speed or unthrottled.
+ *
+ * File layout (little-endian):
+ *   header: "SOTC" magic, u16 version, u16 reserved, u64 start time (unix ms)
+ *   record: u32 microseconds since the previous record, u16 body length, body
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "protocol.h"
+
+namespace shadow {
+namespace framework {
+
+class PacketRecorder {
+public:
+    static constexpr uint32_t MAGIC = 0x43544F53; // "SOTC"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t FILE_HEADER_SIZE = 16;
+    static constexpr size_t RECORD_HEADER_SIZE = 6;
+
+    PacketRecorder() = default;
+    ~PacketRecorder();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file.is_open(); }
+
+    // Append the unread part of a frame, i.e. what the parser will see
+    void record(const NetworkMessage& frame);
+
+    uint64_t getFrameCount() const { return m_frames; }
+    uint64_t getBytesWritten() const { return m_bytes; }
+
+private:
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_last;
+    uint64_t m_frames{0};
+    uint64_t m_bytes{0};
+};
+
+class PacketReplayer {
+public:
+    enum class Speed {
+        Realtime,    // Honour recorded inter-frame gaps
+        Unthrottled  // Deliver everything as fast as possible
+    };
+
+    using FrameCallback = std::function<void(NetworkMessage&)>;
+
+    PacketReplayer() = default;
+
+    // Loads the whole capture up front so replay does no file I/O
+    bool open(const std::string& path);
+    void close();
+    void rewind();
+
+    bool isOpen() const { return !m_data.empty(); }
+    bool isFinished() const { return m_offset >= m_data.size(); }
+
+    void setSpeed(Speed speed) { m_speed = speed; }
+    Speed getSpeed() const { return m_speed; }
+
+    // Deliver every frame that is due; returns how many were delivered
+    size_t poll(const FrameCallback& deliver);
+
+    uint64_t getFrameCount() const { return m_frameCount; }
+    uint64_t getFramesDelivered() const { return m_delivered; }
+    uint64_t getDurationUs() const { return m_durationUs; }
+
+private:
+    bool readRecord(uint32_t& deltaUs, uint16_t& length) const;
+
+    std::vector<uint8_t> m_data;
+    size_t m_offset{0};
+    Speed m_speed{Speed::Realtime};
+
+    std::chrono::steady_clock::time_point m_startTime;
+    uint64_t m_clockUs{0};
+    bool m_started{false};
+
+    uint64_t m_frameCount{0};
+    uint64_t m_delivered{0};
+    uint64_t m_durationUs{0};
+};
+
+} // namespace framework
+} // namespace shadow
@@ -3,6 +3,7 @@
  */
 
 #include "protocol.h"
+#include <framework/core/memorytracker.h>
 #include <cstring>
 #include <algorithm>
 
@@ -15,39 +16,256 @@
 namespace shadow {
 namespace framework {
 
-// XTEA implementation
-static constexpr uint32_t XTEA_DELTA = 0x9E3779B9;
-static constexpr uint32_t XTEA_ROUNDS = 32;
+// Message pool
+
+// Never destroyed: messages held by other singletons (protocols, queued
+// sends) may still be released during static destruction
+NetworkMessagePool& NetworkMessagePool::instance() {
+    static NetworkMessagePool* pool = new NetworkMessagePool;
+    return *pool;
+}
+
+MessageBuffer* NetworkMessagePool::acquire(size_t minCapacity) {
+    size_t sizeClass = 0;
+    while (sizeClass + 1 < SIZE_CLASSES.size() && SIZE_CLASSES[sizeClass] < minCapacity) {
+        ++sizeClass;
+    }
+
+    MessageBuffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.acquired++;
+
+        auto& list = m_free[sizeClass];
+        if (!list.empty()) {
+            buffer = list.back();
+            list.pop_back();
+            m_stats.reused++;
+            m_stats.pooledBytes -= buffer->capacity;
+        } else {
+            m_stats.allocated++;
+        }
+    }
+
+    if (!buffer) {
+        buffer = new MessageBuffer;
+        buffer->capacity = SIZE_CLASSES[sizeClass];
+        buffer->data = new uint8_t[buffer->capacity];
+        buffer->sizeClass = static_cast<uint8_t>(sizeClass);
+        g_memory.allocate(MemoryTag::Network, buffer->capacity);
+    }
+
+    buffer->refs.store(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+MessageBuffer* NetworkMessagePool::acquireBlock(size_t capacity) {
+    auto* block = new MessageBuffer;
+    block->capacity = capacity;
+    block->data = new uint8_t[capacity];
+    block->sizeClass = MessageBuffer::UNPOOLED;
+    block->refs.store(1, std::memory_order_relaxed);
+    g_memory.allocate(MemoryTag::Network, capacity);
+    return block;
+}
+
+MessageBuffer* NetworkMessagePool::slice(MessageBuffer* block, size_t offset, size_t size) {
+    MessageBuffer* slice = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_freeSlices.empty()) {
+            slice = m_freeSlices.back();
+            m_freeSlices.pop_back();
+        }
+    }
+    if (!slice) {
+        slice = new MessageBuffer;
+    }
+
+    block->refs.fetch_add(1, std::memory_order_relaxed);
+    slice->data = block->data + offset;
+    slice->capacity = size;
+    slice->parent = block;
+    slice->refs.store(1, std::memory_order_relaxed);
+    return slice;
+}
+
+void NetworkMessagePool::release(MessageBuffer* buffer) {
+    if (!buffer || buffer->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if (MessageBuffer* block = buffer->parent) {
+        buffer->parent = nullptr;
+        buffer->data = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_freeSlices.size() < MAX_FREE_PER_CLASS) {
+                m_freeSlices.push_back(buffer);
+                buffer = nullptr;
+            }
+        }
+        delete buffer;
+        release(block);
+        return;
+    }
+
+    if (buffer->sizeClass == MessageBuffer::UNPOOLED) {
+        g_memory.release(MemoryTag::Network, buffer->capacity);
+        delete[] buffer->data;
+        delete buffer;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& list = m_free[buffer->sizeClass];
+        if (list.size() < MAX_FREE_PER_CLASS) {
+            list.push_back(buffer);
+            m_stats.pooledBytes += buffer->capacity;
+            return;
+        }
+    }
+
+    g_memory.release(MemoryTag::Network, buffer->capacity);
+    delete[] buffer->data;
+    delete buffer;
+}
+
+NetworkMessagePool::Stats NetworkMessagePool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+// Network message
 
 NetworkMessage::NetworkMessage() {
     reset();
 }
 
+NetworkMessage::NetworkMessage(size_t capacity) {
+    m_buffer = NetworkMessagePool::instance().acquire(std::min(capacity, MAX_SIZE));
+    m_size = HEADER_SIZE;
+    m_position = HEADER_SIZE;
+}
+
+NetworkMessage::NetworkMessage(MessageBuffer* buffer, size_t size)
+    : m_buffer(buffer), m_size(size), m_position(HEADER_SIZE) {
+}
+
+NetworkMessage::~NetworkMessage() {
+    releaseBuffer();
+}
+
+NetworkMessage::NetworkMessage(const NetworkMessage& other)
+    : m_buffer(other.m_buffer), m_size(other.m_size), m_position(other.m_position) {
+    if (m_buffer) {
+        m_buffer->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+NetworkMessage::NetworkMessage(NetworkMessage&& other) noexcept
+    : m_buffer(other.m_buffer), m_size(other.m_size), m_position(other.m_position) {
+    other.m_buffer = nullptr;
+    other.m_size = HEADER_SIZE;
+    other.m_position = HEADER_SIZE;
+}
+
+NetworkMessage& NetworkMessage::operator=(const NetworkMessage& other) {
+    if (this != &other) {
+        if (other.m_buffer) {
+            other.m_buffer->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        releaseBuffer();
+        m_buffer = other.m_buffer;
+        m_size = other.m_size;
+        m_position = other.m_position;
+    }
+    return *this;
+}
+
+NetworkMessage& NetworkMessage::operator=(NetworkMessage&& other) noexcept {
+    if (this != &other) {
+        releaseBuffer();
+        m_buffer = other.m_buffer;
+        m_size = other.m_size;
+        m_position = other.m_position;
+        other.m_buffer = nullptr;
+        other.m_size = HEADER_SIZE;
+        other.m_position = HEADER_SIZE;
+    }
+    return *this;
+}
+
 void NetworkMessage::reset() {
+    // A buffer still referenced elsewhere (e.g. queued for send) is left to
+    // its other owners; the next write acquires a fresh one from the pool.
+    if (m_buffer && m_buffer->refs.load(std::memory_order_acquire) > 1) {
+        releaseBuffer();
+    }
     m_size = HEADER_SIZE;
     m_position = HEADER_SIZE;
-    std::fill(m_buffer.begin(), m_buffer.end(), 0);
+    if (m_buffer) {
+        m_buffer->data[0] = 0;
+        m_buffer->data[1] = 0;
+    }
+}
+
+void NetworkMessage::reserve(size_t capacity) {
+    capacity = std::min(capacity, MAX_SIZE);
+    if (m_buffer && m_buffer->capacity >= capacity &&
+        m_buffer->refs.load(std::memory_order_acquire) == 1) {
+        return;
+    }
+
+    MessageBuffer* buffer = NetworkMessagePool::instance().acquire(std::max(capacity, m_size));
+    if (m_buffer) {
+        std::memcpy(buffer->data, m_buffer->data, std::min(m_size, buffer->capacity));
+    } else {
+        std::memset(buffer->data, 0, HEADER_SIZE);
+    }
+    releaseBuffer();
+    m_buffer = buffer;
+}
+
+bool NetworkMessage::ensureWritable(size_t extra) {
+    if (m_size + extra > MAX_SIZE) {
+        return false;
+    }
+    reserve(m_size + extra);
+    return true;
+}
+
+void NetworkMessage::makeUnique() {
+    reserve(m_buffer ? m_buffer->capacity : m_size);
+}
+
+void NetworkMessage::releaseBuffer() {
+    if (m_buffer) {
+        NetworkMessagePool::instance().release(m_buffer);
+        m_buffer = nullptr;
+    }
 }
 
 void NetworkMessage::writeByte(uint8_t value) {
-    if (m_size < MAX_SIZE) {
-        m_buffer[m_size++] = value;
+    if (ensureWritable(1)) {
+        m_buffer->data[m_size++] = value;
     }
 }
 
 void NetworkMessage::writeU16(uint16_t value) {
-    if (m_size + 2 <= MAX_SIZE) {
-        m_buffer[m_size++] = value & 0xFF;
-        m_buffer[m_size++] = (value >> 8) & 0xFF;
+    if (ensureWritable(2)) {
+        m_buffer->data[m_size++] = value & 0xFF;
+        m_buffer->data[m_size++] = (value >> 8) & 0xFF;
     }
 }
 
 void NetworkMessage::writeU32(uint32_t value) {
-    if (m_size + 4 <= MAX_SIZE) {
-        m_buffer[m_size++] = value & 0xFF;
-        m_buffer[m_size++] = (value >> 8) & 0xFF;
-        m_buffer[m_size++] = (value >> 16) & 0xFF;
-        m_buffer[m_size++] = (value >> 24) & 0xFF;
+    if (ensureWritable(4)) {
+        m_buffer->data[m_size++] = value & 0xFF;
+        m_buffer->data[m_size++] = (value >> 8) & 0xFF;
+        m_buffer->data[m_size++] = (value >> 16) & 0xFF;
+        m_buffer->data[m_size++] = (value >> 24) & 0xFF;
     }
 }
 
@@ -63,8 +281,8 @@ void NetworkMessage::writeString(const std::string& value) {
 }
 
 void NetworkMessage::writeBytes(const uint8_t* data, size_t length) {
-    if (m_size + length <= MAX_SIZE) {
-        std::memcpy(&m_buffer[m_size], data, length);
+    if (ensureWritable(length)) {
+        std::memcpy(m_buffer->data + m_size, data, length);
         m_size += length;
     }
 }
@@ -77,14 +295,14 @@ void NetworkMessage::writePosition(uint16_t x, uint16_t y, uint8_t z) {
 
 uint8_t NetworkMessage::readByte() {
     if (m_position < m_size) {
-        return m_buffer[m_position++];
+        return m_buffer->data[m_position++];
     }
     return 0;
 }
 
 uint16_t NetworkMessage::readU16() {
     if (m_position + 2 <= m_size) {
-        uint16_t value = m_buffer[m_position] | (m_buffer[m_position + 1] << 8);
+        uint16_t value = m_buffer->data[m_position] | (m_buffer->data[m_position + 1] << 8);
         m_position += 2;
         return value;
     }
@@ -93,10 +311,10 @@ uint16_t NetworkMessage::readU16() {
 
 uint32_t NetworkMessage::readU32() {
     if (m_position + 4 <= m_size) {
-        uint32_t value = m_buffer[m_position] |
-                        (m_buffer[m_position + 1] << 8) |
-                        (m_buffer[m_position + 2] << 16) |
-                        (m_buffer[m_position + 3] << 24);
+        uint32_t value = m_buffer->data[m_position] |
+                        (m_buffer->data[m_position + 1] << 8) |
+                        (m_buffer->data[m_position + 2] << 16) |
+                        (m_buffer->data[m_position + 3] << 24);
         m_position += 4;
         return value;
     }
@@ -110,18 +328,31 @@ uint64_t NetworkMessage::readU64() {
 }
 
 std::string NetworkMessage::readString() {
+    return std::string(readStringView());
+}
+
+std::string_view NetworkMessage::readStringView() {
     uint16_t len = readU16();
     if (m_position + len <= m_size) {
-        std::string result(reinterpret_cast<char*>(&m_buffer[m_position]), len);
+        std::string_view result(reinterpret_cast<const char*>(m_buffer->data + m_position), len);
         m_position += len;
         return result;
     }
-    return "";
+    return {};
+}
+
+std::span<const uint8_t> NetworkMessage::readSpan(size_t length) {
+    if (m_position + length <= m_size) {
+        std::span<const uint8_t> result(m_buffer->data + m_position, length);
+        m_position += length;
+        return result;
+    }
+    return {};
 }
 
 void NetworkMessage::readBytes(uint8_t* data, size_t length) {
     if (m_position + length <= m_size) {
-        std::memcpy(data, &m_buffer[m_position], length);
+        std::memcpy(data, m_buffer->data + m_position, length);
         m_position += length;
     }
 }
@@ -134,60 +365,49 @@ void NetworkMessage::readPosition(uint16_t& x, uint16_t& y, uint8_t& z) {
 
 uint8_t NetworkMessage::peekByte() const {
     if (m_position < m_size) {
-        return m_buffer[m_position];
+        return m_buffer->data[m_position];
     }
     return 0;
 }
 
 uint16_t NetworkMessage::peekU16() const {
     if (m_position + 2 <= m_size) {
-        return m_buffer[m_position] | (m_buffer[m_position + 1] << 8);
+        return m_buffer->data[m_position] | (m_buffer->data[m_position + 1] << 8);
     }
     return 0;
 }
 
 // XTEA Cipher
 
-XTEACipher::XTEACipher() {
+XTEACipher::XTEACipher() : m_kernel(xtea::getBestKernel()) {
     m_key.fill(0);
+    m_roundKeys = xtea::expandKey(m_key);
 }
 
 void XTEACipher::setKey(const std::array<uint32_t, 4>& key) {
     m_key = key;
+    m_roundKeys = xtea::expandKey(key);
     m_enabled = true;
 }
 
+void XTEACipher::setKernel(xtea::Kernel kernel) {
+    m_kernel = xtea::isKernelSupported(kernel) ? kernel : xtea::Kernel::Scalar;
+}
+
 void XTEACipher::encrypt(NetworkMessage& msg) const {
     if (!m_enabled) return;
 
     // Pad to 8-byte boundary
     size_t msgSize = msg.getBodySize();
     size_t paddedSize = ((msgSize + 7) / 8) * 8;
+    if (NetworkMessage::HEADER_SIZE + paddedSize > NetworkMessage::MAX_SIZE) return;
 
-    // Get data pointer
+    // Get data pointer, zeroing the padding bytes past the payload
+    msg.reserve(NetworkMessage::HEADER_SIZE + paddedSize);
     uint8_t* data = msg.getBodyBuffer();
+    std::memset(data + msgSize, 0, paddedSize - msgSize);
 
-    // Encrypt each 8-byte block
-    for (size_t i = 0; i < paddedSize; i += 8) {
-        uint32_t v0 = data[i] | (data[i+1] << 8) | (data[i+2] << 16) | (data[i+3] << 24);
-        uint32_t v1 = data[i+4] | (data[i+5] << 8) | (data[i+6] << 16) | (data[i+7] << 24);
-
-        uint32_t sum = 0;
-        for (uint32_t j = 0; j < XTEA_ROUNDS; ++j) {
-            v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ (sum + m_key[sum & 3]);
-            sum += XTEA_DELTA;
-            v1 += (((v0 << 4) ^ (v0 >> 5)) + v0) ^ (sum + m_key[(sum >> 11) & 3]);
-        }
-
-        data[i] = v0 & 0xFF;
-        data[i+1] = (v0 >> 8) & 0xFF;
-        data[i+2] = (v0 >> 16) & 0xFF;
-        data[i+3] = (v0 >> 24) & 0xFF;
-        data[i+4] = v1 & 0xFF;
-        data[i+5] = (v1 >> 8) & 0xFF;
-        data[i+6] = (v1 >> 16) & 0xFF;
-        data[i+7] = (v1 >> 24) & 0xFF;
-    }
+    xtea::encryptBlocks(m_kernel, data, paddedSize / xtea::BLOCK_SIZE, m_roundKeys);
 
     msg.setSize(NetworkMessage::HEADER_SIZE + paddedSize);
 }
@@ -198,29 +418,7 @@ void XTEACipher::decrypt(NetworkMessage& msg) const {
     size_t msgSize = msg.getBodySize();
     if (msgSize % 8 != 0) return; // Invalid size
 
-    uint8_t* data = msg.getBodyBuffer();
-
-    // Decrypt each 8-byte block
-    for (size_t i = 0; i < msgSize; i += 8) {
-        uint32_t v0 = data[i] | (data[i+1] << 8) | (data[i+2] << 16) | (data[i+3] << 24);
-        uint32_t v1 = data[i+4] | (data[i+5] << 8) | (data[i+6] << 16) | (data[i+7] << 24);
-
-        uint32_t sum = XTEA_DELTA * XTEA_ROUNDS;
-        for (uint32_t j = 0; j < XTEA_ROUNDS; ++j) {
-            v1 -= (((v0 << 4) ^ (v0 >> 5)) + v0) ^ (sum + m_key[(sum >> 11) & 3]);
-            sum -= XTEA_DELTA;
-            v0 -= (((v1 << 4) ^ (v1 >> 5)) + v1) ^ (sum + m_key[sum & 3]);
-        }
-
-        data[i] = v0 & 0xFF;
-        data[i+1] = (v0 >> 8) & 0xFF;
-        data[i+2] = (v0 >> 16) & 0xFF;
-        data[i+3] = (v0 >> 24) & 0xFF;
-        data[i+4] = v1 & 0xFF;
-        data[i+5] = (v1 >> 8) & 0xFF;
-        data[i+6] = (v1 >> 16) & 0xFF;
-        data[i+7] = (v1 >> 24) & 0xFF;
-    }
+    xtea::decryptBlocks(m_kernel, msg.getBodyBuffer(), msgSize / xtea::BLOCK_SIZE, m_roundKeys);
 }
 
 // RSA Cipher
@@ -6,24 +6,97 @@
 
 #pragma once
 
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <cstdint>
 #include <array>
+#include <atomic>
+#include <mutex>
+
+#include "xtea.h"
 
 namespace shadow {
 namespace framework {
 
+// Pooled storage backing a NetworkMessage. Buffers come from size-classed
+// slabs owned by NetworkMessagePool and are shared between handles by
+// refcount, so passing a message through queues never copies its bytes.
+// A slice borrows a range of a parent block instead, holding a reference
+// on it; received frames are slices of the receive buffer.
+struct MessageBuffer {
+    static constexpr uint8_t UNPOOLED = 0xFF;  // Freed on last release
+
+    uint8_t* data{nullptr};
+    size_t capacity{0};
+    std::atomic<uint32_t> refs{0};
+    uint8_t sizeClass{0};
+    MessageBuffer* parent{nullptr};
+};
+
+class NetworkMessagePool {
+public:
+    static NetworkMessagePool& instance();
+
+    // Size classes, smallest first; the last one fits any frame
+    static constexpr std::array<size_t, 4> SIZE_CLASSES{512, 4096, 16384, 65535};
+    static constexpr size_t MAX_FREE_PER_CLASS = 64;
+
+    MessageBuffer* acquire(size_t minCapacity);
+    void release(MessageBuffer* buffer);
+
+    // Blocks larger than any size class, freed rather than pooled
+    MessageBuffer* acquireBlock(size_t capacity);
+    // size bytes at offset into block, sharing its storage
+    MessageBuffer* slice(MessageBuffer* block, size_t offset, size_t size);
+
+    struct Stats {
+        uint64_t acquired{0};
+        uint64_t reused{0};
+        uint64_t allocated{0};
+        size_t pooledBytes{0};
+    };
+    Stats getStats() const;
+
+private:
+    NetworkMessagePool() = default;
+    ~NetworkMessagePool() = default;
+    NetworkMessagePool(const NetworkMessagePool&) = delete;
+    NetworkMessagePool& operator=(const NetworkMessagePool&) = delete;
+
+    mutable std::mutex m_mutex;
+    std::array<std::vector<MessageBuffer*>, SIZE_CLASSES.size()> m_free;
+    std::vector<MessageBuffer*> m_freeSlices;
+    Stats m_stats;
+};
+
 // Network message for read/write operations
+//
+// A message is a lightweight handle onto a pooled buffer. Copies share the
+// buffer and only clone it on the next write (copy-on-write); moves transfer
+// it outright, which is what the send/recv queues do.
 class NetworkMessage {
 public:
     static constexpr size_t MAX_SIZE = 65535;
     static constexpr size_t HEADER_SIZE = 2;
 
     NetworkMessage();
+    explicit NetworkMessage(size_t capacity);
+    // Adopts the caller's reference on buffer, whose first size bytes are
+    // a whole frame; reading starts after the header
+    NetworkMessage(MessageBuffer* buffer, size_t size);
+    ~NetworkMessage();
+
+    NetworkMessage(const NetworkMessage& other);
+    NetworkMessage(NetworkMessage&& other) noexcept;
+    NetworkMessage& operator=(const NetworkMessage& other);
+    NetworkMessage& operator=(NetworkMessage&& other) noexcept;
+
     void reset();
+    void reserve(size_t capacity);
 
     // Writing
     void writeByte(uint8_t value);
@@ -41,6 +114,12 @@ public:
     uint64_t readU64();
     std::string readString();
     void readBytes(uint8_t* data, size_t length);
+
+    // Zero-copy reads into the message buffer. Views stay valid while this
+    // message is alive and unmodified; copy whatever outlives the parse.
+    // A field running past the end reads as empty, like readString().
+    std::string_view readStringView();
+    std::span<const uint8_t> readSpan(size_t length);
     void readPosition(uint16_t& x, uint16_t& y, uint8_t& z);
 
     // Peek without advancing
@@ -48,22 +127,27 @@ public:
     uint16_t peekU16() const;
 
     // Buffer access
-    uint8_t* getBuffer() { return m_buffer.data(); }
-    const uint8_t* getBuffer() const { return m_buffer.data(); }
-    uint8_t* getBodyBuffer() { return m_buffer.data() + HEADER_SIZE; }
+    uint8_t* getBuffer() { makeUnique(); return m_buffer->data; }
+    const uint8_t* getBuffer() const { return m_buffer ? m_buffer->data : nullptr; }
+    uint8_t* getBodyBuffer() { return getBuffer() + HEADER_SIZE; }
 
     size_t getSize() const { return m_size; }
     size_t getBodySize() const { return m_size > HEADER_SIZE ? m_size - HEADER_SIZE : 0; }
     size_t getPosition() const { return m_position; }
     size_t getRemainingSize() const { return m_size > m_position ? m_size - m_position : 0; }
+    size_t getCapacity() const { return m_buffer ? m_buffer->capacity : 0; }
 
-    void setSize(size_t size) { m_size = size; }
+    void setSize(size_t size) { reserve(size); m_size = size; }
     void setPosition(size_t pos) { m_position = pos; }
 
     bool isEof() const { return m_position >= m_size; }
 
 private:
-    std::array<uint8_t, MAX_SIZE> m_buffer;
+    bool ensureWritable(size_t extra);
+    void makeUnique();
+    void releaseBuffer();
+
+    MessageBuffer* m_buffer{nullptr};
     size_t m_size{0};
     size_t m_position{HEADER_SIZE};
 };
@@ -80,8 +164,14 @@ public:
     bool isEnabled() const { return m_enabled; }
     void setEnabled(bool enabled) { m_enabled = enabled; }
 
+    // Block kernel; defaults to the fastest one the CPU supports
+    void setKernel(xtea::Kernel kernel);
+    xtea::Kernel getKernel() const { return m_kernel; }
+
 private:
     std::array<uint32_t, 4> m_key;
+    xtea::RoundKeys m_roundKeys;
+    xtea::Kernel m_kernel;
     bool m_enabled{false};
 };
 
@@ -105,6 +195,9 @@ namespace ClientOpcode {
     constexpr uint8_t SecondaryLogin = 0x02;
     constexpr uint8_t EnterWorld = 0x0A;
     constexpr uint8_t QuitGame = 0x14;
+    // Asks for a ServerOpcode::PingBack, to measure the round trip
+    constexpr uint8_t PingRequest = 0x1D;
+    // Answers the server's Ping
     constexpr uint8_t Ping = 0x1E;
 
     constexpr uint8_t AutoWalk = 0x64;
@@ -147,6 +240,14 @@ namespace ClientOpcode {
 
     constexpr uint8_t EditText = 0x89;
     constexpr uint8_t EditList = 0x8A;
+
+    constexpr uint8_t MarketLeave = 0xF4;
+    constexpr uint8_t MarketBrowse = 0xF5;
+    constexpr uint8_t MarketCreate = 0xF6;
+    constexpr uint8_t MarketCancel = 0xF7;
+    constexpr uint8_t MarketAccept = 0xF8;
+
+    constexpr uint8_t ExtendedOpcode = 0x32;
 }
 
 namespace ServerOpcode {
@@ -158,6 +259,7 @@ namespace ServerOpcode {
     constexpr uint8_t CharacterList = 0x14;
 
     constexpr uint8_t Ping = 0x1D;
+    constexpr uint8_t PingBack = 0x1E;
     constexpr uint8_t Death = 0x28;
 
     constexpr uint8_t MapDescription = 0x64;
@@ -168,8 +270,8 @@ namespace ServerOpcode {
     constexpr uint8_t UpdateTile = 0x69;
 
     constexpr uint8_t CreatureAppear = 0x6A;
-    constexpr uint8_t CreatureDisappear = 0x6B;
     constexpr uint8_t CreatureTurn = 0x6B;
+    constexpr uint8_t CreatureDisappear = 0x6C;
     constexpr uint8_t CreatureMove = 0x6D;
 
     constexpr uint8_t Container = 0x6E;
@@ -213,6 +315,17 @@ namespace ServerOpcode {
     constexpr uint8_t VipLogin = 0xD2;
     constexpr uint8_t VipLogout = 0xD3;
     constexpr uint8_t VipState = 0xD4;
+
+    constexpr uint8_t MarketEnter = 0xF6;
+    constexpr uint8_t MarketLeave = 0xF7;
+    constexpr uint8_t MarketBrowse = 0xF8;
+
+    constexpr uint8_t ExtendedOpcode = 0x32;
+}
+
+// Sub-opcodes carried inside ExtendedOpcode packets (u8 id + string payload)
+namespace ExtendedOpcode {
+    constexpr uint8_t Compression = 0x01;
 }
 
 } // namespace framework
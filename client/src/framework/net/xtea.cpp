@@ -0,0 +1,310 @@
+/**
+ * Shadow OT Client - XTEA Block Kernels Implementation
+ *
+ * Tibia uses XTEA in ECB mode, so blocks are independent and the SIMD
+ * kernels simply run 4 (SSE2/NEON) or 8 (AVX2) blocks through the rounds
+ * side by side, one 32-bit lane per block half.
+ */
+
+#include "xtea.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SHADOW_XTEA_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SHADOW_TARGET_AVX2
+#else
+#define SHADOW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && \
+      (!defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define SHADOW_XTEA_NEON
+#include <arm_neon.h>
+#endif
+
+namespace shadow {
+namespace framework {
+namespace xtea {
+
+RoundKeys expandKey(const std::array<uint32_t, 4>& key) {
+    RoundKeys keys;
+    uint32_t sum = 0;
+    for (uint32_t r = 0; r < ROUNDS; ++r) {
+        keys.k0[r] = sum + key[sum & 3];
+        sum += DELTA;
+        keys.k1[r] = sum + key[(sum >> 11) & 3];
+    }
+    return keys;
+}
+
+// Scalar
+
+static inline uint32_t load32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline void store32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static void encryptScalar(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    for (size_t i = 0; i < blocks; ++i, data += BLOCK_SIZE) {
+        uint32_t v0 = load32(data);
+        uint32_t v1 = load32(data + 4);
+        for (uint32_t r = 0; r < ROUNDS; ++r) {
+            v0 += (((v1 << 4) ^ (v1 >> 5)) + v1) ^ keys.k0[r];
+            v1 += (((v0 << 4) ^ (v0 >> 5)) + v0) ^ keys.k1[r];
+        }
+        store32(data, v0);
+        store32(data + 4, v1);
+    }
+}
+
+static void decryptScalar(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    for (size_t i = 0; i < blocks; ++i, data += BLOCK_SIZE) {
+        uint32_t v0 = load32(data);
+        uint32_t v1 = load32(data + 4);
+        for (uint32_t r = ROUNDS; r-- > 0;) {
+            v1 -= (((v0 << 4) ^ (v0 >> 5)) + v0) ^ keys.k1[r];
+            v0 -= (((v1 << 4) ^ (v1 >> 5)) + v1) ^ keys.k0[r];
+        }
+        store32(data, v0);
+        store32(data + 4, v1);
+    }
+}
+
+#ifdef SHADOW_XTEA_X86
+
+// SSE2: 4 blocks per iteration
+
+static inline __m128i mix128(__m128i v) {
+    return _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5)), v);
+}
+
+// [v0 v1 v0 v1] x2 -> all v0 lanes and all v1 lanes
+static inline void split128(__m128i a, __m128i b, __m128i& v0, __m128i& v1) {
+    v0 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+    v1 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+static void encryptSSE2(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    size_t i = 0;
+    for (; i + 4 <= blocks; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i * BLOCK_SIZE);
+        __m128i v0, v1;
+        split128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1), v0, v1);
+
+        for (uint32_t r = 0; r < ROUNDS; ++r) {
+            v0 = _mm_add_epi32(v0, _mm_xor_si128(mix128(v1), _mm_set1_epi32(static_cast<int>(keys.k0[r]))));
+            v1 = _mm_add_epi32(v1, _mm_xor_si128(mix128(v0), _mm_set1_epi32(static_cast<int>(keys.k1[r]))));
+        }
+
+        _mm_storeu_si128(p, _mm_unpacklo_epi32(v0, v1));
+        _mm_storeu_si128(p + 1, _mm_unpackhi_epi32(v0, v1));
+    }
+    encryptScalar(data + i * BLOCK_SIZE, blocks - i, keys);
+}
+
+static void decryptSSE2(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    size_t i = 0;
+    for (; i + 4 <= blocks; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i * BLOCK_SIZE);
+        __m128i v0, v1;
+        split128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1), v0, v1);
+
+        for (uint32_t r = ROUNDS; r-- > 0;) {
+            v1 = _mm_sub_epi32(v1, _mm_xor_si128(mix128(v0), _mm_set1_epi32(static_cast<int>(keys.k1[r]))));
+            v0 = _mm_sub_epi32(v0, _mm_xor_si128(mix128(v1), _mm_set1_epi32(static_cast<int>(keys.k0[r]))));
+        }
+
+        _mm_storeu_si128(p, _mm_unpacklo_epi32(v0, v1));
+        _mm_storeu_si128(p + 1, _mm_unpackhi_epi32(v0, v1));
+    }
+    decryptScalar(data + i * BLOCK_SIZE, blocks - i, keys);
+}
+
+// AVX2: 8 blocks per iteration. The shuffles work per 128-bit lane, and
+// the unpacks undo exactly the same permutation, so no cross-lane fixup
+// is needed.
+
+SHADOW_TARGET_AVX2
+static inline __m256i mix256(__m256i v) {
+    return _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v, 4), _mm256_srli_epi32(v, 5)), v);
+}
+
+SHADOW_TARGET_AVX2
+static void encryptAVX2(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    size_t i = 0;
+    for (; i + 8 <= blocks; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i * BLOCK_SIZE);
+        __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256(p));
+        __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256(p + 1));
+        __m256i v0 = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m256i v1 = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (uint32_t r = 0; r < ROUNDS; ++r) {
+            v0 = _mm256_add_epi32(v0, _mm256_xor_si256(mix256(v1), _mm256_set1_epi32(static_cast<int>(keys.k0[r]))));
+            v1 = _mm256_add_epi32(v1, _mm256_xor_si256(mix256(v0), _mm256_set1_epi32(static_cast<int>(keys.k1[r]))));
+        }
+
+        _mm256_storeu_si256(p, _mm256_unpacklo_epi32(v0, v1));
+        _mm256_storeu_si256(p + 1, _mm256_unpackhi_epi32(v0, v1));
+    }
+    encryptSSE2(data + i * BLOCK_SIZE, blocks - i, keys);
+}
+
+SHADOW_TARGET_AVX2
+static void decryptAVX2(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    size_t i = 0;
+    for (; i + 8 <= blocks; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i * BLOCK_SIZE);
+        __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256(p));
+        __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256(p + 1));
+        __m256i v0 = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m256i v1 = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (uint32_t r = ROUNDS; r-- > 0;) {
+            v1 = _mm256_sub_epi32(v1, _mm256_xor_si256(mix256(v0), _mm256_set1_epi32(static_cast<int>(keys.k1[r]))));
+            v0 = _mm256_sub_epi32(v0, _mm256_xor_si256(mix256(v1), _mm256_set1_epi32(static_cast<int>(keys.k0[r]))));
+        }
+
+        _mm256_storeu_si256(p, _mm256_unpacklo_epi32(v0, v1));
+        _mm256_storeu_si256(p + 1, _mm256_unpackhi_epi32(v0, v1));
+    }
+    decryptSSE2(data + i * BLOCK_SIZE, blocks - i, keys);
+}
+
+static bool cpuHasAVX2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // SHADOW_XTEA_X86
+
+#ifdef SHADOW_XTEA_NEON
+
+// NEON: vld2q/vst2q deinterleave 4 blocks into v0/v1 lanes directly
+
+static inline uint32x4_t mixNeon(uint32x4_t v) {
+    return vaddq_u32(veorq_u32(vshlq_n_u32(v, 4), vshrq_n_u32(v, 5)), v);
+}
+
+static void encryptNEON(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    size_t i = 0;
+    for (; i + 4 <= blocks; i += 4) {
+        uint32_t* p = reinterpret_cast<uint32_t*>(data + i * BLOCK_SIZE);
+        uint32x4x2_t v = vld2q_u32(p);
+
+        for (uint32_t r = 0; r < ROUNDS; ++r) {
+            v.val[0] = vaddq_u32(v.val[0], veorq_u32(mixNeon(v.val[1]), vdupq_n_u32(keys.k0[r])));
+            v.val[1] = vaddq_u32(v.val[1], veorq_u32(mixNeon(v.val[0]), vdupq_n_u32(keys.k1[r])));
+        }
+
+        vst2q_u32(p, v);
+    }
+    encryptScalar(data + i * BLOCK_SIZE, blocks - i, keys);
+}
+
+static void decryptNEON(uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    size_t i = 0;
+    for (; i + 4 <= blocks; i += 4) {
+        uint32_t* p = reinterpret_cast<uint32_t*>(data + i * BLOCK_SIZE);
+        uint32x4x2_t v = vld2q_u32(p);
+
+        for (uint32_t r = ROUNDS; r-- > 0;) {
+            v.val[1] = vsubq_u32(v.val[1], veorq_u32(mixNeon(v.val[0]), vdupq_n_u32(keys.k1[r])));
+            v.val[0] = vsubq_u32(v.val[0], veorq_u32(mixNeon(v.val[1]), vdupq_n_u32(keys.k0[r])));
+        }
+
+        vst2q_u32(p, v);
+    }
+    decryptScalar(data + i * BLOCK_SIZE, blocks - i, keys);
+}
+
+#endif // SHADOW_XTEA_NEON
+
+// Dispatch
+
+const char* getKernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar: return "scalar";
+        case Kernel::SSE2: return "sse2";
+        case Kernel::AVX2: return "avx2";
+        case Kernel::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+bool isKernelSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#ifdef SHADOW_XTEA_X86
+        case Kernel::SSE2:
+            return true;
+        case Kernel::AVX2: {
+            static const bool hasAVX2 = cpuHasAVX2();
+            return hasAVX2;
+        }
+#endif
+#ifdef SHADOW_XTEA_NEON
+        case Kernel::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+Kernel getBestKernel() {
+    for (Kernel kernel : {Kernel::AVX2, Kernel::NEON, Kernel::SSE2}) {
+        if (isKernelSupported(kernel)) {
+            return kernel;
+        }
+    }
+    return Kernel::Scalar;
+}
+
+void encryptBlocks(Kernel kernel, uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    switch (kernel) {
+#ifdef SHADOW_XTEA_X86
+        case Kernel::SSE2: encryptSSE2(data, blocks, keys); return;
+        case Kernel::AVX2: encryptAVX2(data, blocks, keys); return;
+#endif
+#ifdef SHADOW_XTEA_NEON
+        case Kernel::NEON: encryptNEON(data, blocks, keys); return;
+#endif
+        default: encryptScalar(data, blocks, keys); return;
+    }
+}
+
+void decryptBlocks(Kernel kernel, uint8_t* data, size_t blocks, const RoundKeys& keys) {
+    switch (kernel) {
+#ifdef SHADOW_XTEA_X86
+        case Kernel::SSE2: decryptSSE2(data, blocks, keys); return;
+        case Kernel::AVX2: decryptAVX2(data, blocks, keys); return;
+#endif
+#ifdef SHADOW_XTEA_NEON
+        case Kernel::NEON: decryptNEON(data, blocks, keys); return;
+#endif
+        default: decryptScalar(data, blocks, keys); return;
+    }
+}
+
+} // namespace xtea
+} // namespace framework
+} // namespace shadow
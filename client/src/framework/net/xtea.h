@@ -0,0 +1,48 @@
+/**
+ * Shadow OT Client - XTEA Block Kernels
+ *
+ * Multi-block XTEA encrypt/decrypt with SSE2, AVX2 and NEON paths,
+ * selected at runtime. All kernels are bit-identical to the scalar one.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace shadow {
+namespace framework {
+namespace xtea {
+
+constexpr uint32_t DELTA = 0x9E3779B9;
+constexpr uint32_t ROUNDS = 32;
+constexpr size_t BLOCK_SIZE = 8;
+
+// Per-round key schedule: k0[r] feeds the v0 half-round, k1[r] the v1 one.
+// Decryption walks the same schedule backwards.
+struct RoundKeys {
+    std::array<uint32_t, ROUNDS> k0{};
+    std::array<uint32_t, ROUNDS> k1{};
+};
+
+RoundKeys expandKey(const std::array<uint32_t, 4>& key);
+
+enum class Kernel {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+const char* getKernelName(Kernel kernel);
+bool isKernelSupported(Kernel kernel);
+Kernel getBestKernel();
+
+// Process `blocks` consecutive 8-byte little-endian blocks in place
+void encryptBlocks(Kernel kernel, uint8_t* data, size_t blocks, const RoundKeys& keys);
+void decryptBlocks(Kernel kernel, uint8_t* data, size_t blocks, const RoundKeys& keys);
+
+} // namespace xtea
+} // namespace framework
+} // namespace shadow
@@ -4,6 +4,7 @@
 
 #include "platform.h"
 #include <chrono>
+#include <iterator>
 #include <thread>
 #include <cstdlib>
 
@@ -54,6 +55,7 @@ static std::function<bool()> s_quitCallback;
 static std::function<void(bool)> s_focusCallback;
 static std::function<void(int, int)> s_resizeCallback;
 static std::function<void(const std::vector<std::string>&)> s_fileDropCallback;
+static Platform::InputCallback s_inputCallback;
 
 static void glfwWindowCloseCallback(GLFWwindow* window) {
     if (s_quitCallback) {
@@ -83,6 +85,105 @@ static void glfwDropCallback(GLFWwindow* window, int count, const char** paths)
     }
 }
 
+// GLFW key to the SDL scancodes KeyCode uses; 0 for keys it has no name for
+static int translateKey(int key) {
+    if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z) return 4 + (key - GLFW_KEY_A);
+    if (key >= GLFW_KEY_1 && key <= GLFW_KEY_9) return 30 + (key - GLFW_KEY_1);
+    if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F12) return 58 + (key - GLFW_KEY_F1);
+    if (key >= GLFW_KEY_KP_1 && key <= GLFW_KEY_KP_9) return 89 + (key - GLFW_KEY_KP_1);
+
+    switch (key) {
+        case GLFW_KEY_0: return 39;
+        case GLFW_KEY_ENTER: return 40;
+        case GLFW_KEY_ESCAPE: return 41;
+        case GLFW_KEY_BACKSPACE: return 42;
+        case GLFW_KEY_TAB: return 43;
+        case GLFW_KEY_SPACE: return 44;
+        case GLFW_KEY_RIGHT: return 79;
+        case GLFW_KEY_LEFT: return 80;
+        case GLFW_KEY_DOWN: return 81;
+        case GLFW_KEY_UP: return 82;
+        case GLFW_KEY_LEFT_CONTROL: return 224;
+        case GLFW_KEY_LEFT_SHIFT: return 225;
+        case GLFW_KEY_LEFT_ALT: return 226;
+        case GLFW_KEY_RIGHT_CONTROL: return 228;
+        case GLFW_KEY_RIGHT_SHIFT: return 229;
+        case GLFW_KEY_RIGHT_ALT: return 230;
+        case GLFW_KEY_KP_0: return 98;
+        case GLFW_KEY_KP_ENTER: return 88;
+        case GLFW_KEY_KP_ADD: return 87;
+        case GLFW_KEY_KP_SUBTRACT: return 86;
+        case GLFW_KEY_INSERT: return 73;
+        case GLFW_KEY_DELETE: return 76;
+        case GLFW_KEY_HOME: return 74;
+        case GLFW_KEY_END: return 77;
+        case GLFW_KEY_PAGE_UP: return 75;
+        case GLFW_KEY_PAGE_DOWN: return 78;
+        default: return 0;
+    }
+}
+
+static uint16_t translateModifiers(int mods) {
+    return static_cast<uint16_t>(((mods & GLFW_MOD_CONTROL) ? 1 : 0) | ((mods & GLFW_MOD_SHIFT) ? 2 : 0) |
+                                 ((mods & GLFW_MOD_ALT) ? 4 : 0));
+}
+
+static void emitInput(Platform::InputRecord& record) {
+    record.timeUs = Platform::getTickMicroseconds();
+    s_inputCallback(record);
+}
+
+static void glfwKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (!s_inputCallback) return;
+    Platform::InputRecord record;
+    record.type = Platform::InputRecord::Type::Key;
+    record.code = translateKey(key);
+    record.pressed = action != GLFW_RELEASE;
+    record.repeat = action == GLFW_REPEAT;
+    record.modifiers = translateModifiers(mods);
+    emitInput(record);
+}
+
+static void glfwCharCallback(GLFWwindow* window, unsigned int codepoint) {
+    if (!s_inputCallback) return;
+    Platform::InputRecord record;
+    record.type = Platform::InputRecord::Type::Char;
+    record.code = static_cast<int>(codepoint);
+    emitInput(record);
+}
+
+static void glfwMouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    if (!s_inputCallback) return;
+    static constexpr int buttons[] = {1, 3, 2, 4, 5};
+    if (button < 0 || button >= static_cast<int>(std::size(buttons))) return;
+
+    Platform::InputRecord record;
+    record.type = Platform::InputRecord::Type::MouseButton;
+    record.code = buttons[button];
+    record.pressed = action == GLFW_PRESS;
+    record.modifiers = translateModifiers(mods);
+    glfwGetCursorPos(window, &record.x, &record.y);
+    emitInput(record);
+}
+
+static void glfwCursorPosCallback(GLFWwindow* window, double x, double y) {
+    if (!s_inputCallback) return;
+    Platform::InputRecord record;
+    record.type = Platform::InputRecord::Type::MouseMove;
+    record.x = x;
+    record.y = y;
+    emitInput(record);
+}
+
+static void glfwScrollCallback(GLFWwindow* window, double x, double y) {
+    if (!s_inputCallback) return;
+    Platform::InputRecord record;
+    record.type = Platform::InputRecord::Type::Scroll;
+    record.x = x;
+    record.y = y;
+    emitInput(record);
+}
+
 Platform& Platform::instance() {
     static Platform instance;
     return instance;
@@ -296,6 +397,11 @@ void* Platform::createWindow(const std::string& title, int width, int height, bo
         glfwSetWindowFocusCallback(window, glfwWindowFocusCallback);
         glfwSetWindowSizeCallback(window, glfwWindowSizeCallback);
         glfwSetDropCallback(window, glfwDropCallback);
+        glfwSetKeyCallback(window, glfwKeyCallback);
+        glfwSetCharCallback(window, glfwCharCallback);
+        glfwSetMouseButtonCallback(window, glfwMouseButtonCallback);
+        glfwSetCursorPosCallback(window, glfwCursorPosCallback);
+        glfwSetScrollCallback(window, glfwScrollCallback);
 
         m_impl->window = window;
     }
@@ -344,6 +450,10 @@ bool Platform::isWindowMinimized(void* window) const {
     return glfwGetWindowAttrib(static_cast<GLFWwindow*>(window), GLFW_ICONIFIED) != 0;
 }
 
+void Platform::setVSync(bool enabled) {
+    glfwSwapInterval(enabled ? 1 : 0);
+}
+
 std::string Platform::getClipboardText() const {
     if (m_impl && m_impl->window) {
         const char* text = glfwGetClipboardString(m_impl->window);
@@ -424,6 +534,12 @@ uint64_t Platform::getMicroseconds() const {
     ).count();
 }
 
+uint64_t Platform::getTickMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
 void Platform::sleep(uint32_t milliseconds) {
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
 }
@@ -482,6 +598,10 @@ void Platform::setFileDropCallback(FileDropCallback callback) {
     s_fileDropCallback = callback;
 }
 
+void Platform::setInputCallback(InputCallback callback) {
+    s_inputCallback = callback;
+}
+
 void Platform::pollEvents() {
     glfwPollEvents();
 }
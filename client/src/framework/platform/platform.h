@@ -10,6 +10,7 @@
 #include <vector>
 #include <cstdint>
 #include <functional>
+#include <memory>
 
 // Use 'shadowot' instead of 'shadow' to avoid macOS MacTypes.h 'shadow' enum conflict
 namespace shadowot {
@@ -44,6 +45,8 @@ public:
     void setWindowFullscreen(void* window, bool fullscreen);
     bool isWindowFocused(void* window) const;
     bool isWindowMinimized(void* window) const;
+    // Swap interval of the current context: 1 waits for vblank, 0 does not
+    void setVSync(bool enabled);
 
     // Clipboard
     std::string getClipboardText() const;
@@ -67,6 +70,8 @@ public:
     double getTime() const; // High-resolution time in seconds
     uint64_t getMilliseconds() const;
     uint64_t getMicroseconds() const;
+    // Monotonic microseconds; input records are stamped with this clock
+    static uint64_t getTickMicroseconds();
     void sleep(uint32_t milliseconds);
 
     // Threading
@@ -106,6 +111,24 @@ public:
     void setResizeCallback(ResizeCallback callback);
     void setFileDropCallback(FileDropCallback callback);
 
+    // Keyboard and mouse input as the window system reports it, stamped
+    // with getTickMicroseconds() on arrival (GLFW has no event times of its
+    // own). Keys are SDL scancodes, modifiers Ctrl = 1, Shift = 2, Alt = 4,
+    // mouse buttons 1 left, 2 middle, 3 right, 4 and 5 extra.
+    struct InputRecord {
+        enum class Type : uint8_t { Key, Char, MouseButton, MouseMove, Scroll };
+        Type type{Type::Key};
+        bool pressed{false};
+        bool repeat{false};
+        uint16_t modifiers{0};
+        int code{0};            // Scancode, codepoint or button; 0 for unmapped keys
+        double x{0.0};          // Cursor position, or scroll offsets
+        double y{0.0};
+        uint64_t timeUs{0};
+    };
+    using InputCallback = std::function<void(const InputRecord&)>;
+    void setInputCallback(InputCallback callback);
+
     // Event processing
     void pollEvents();
 
@@ -0,0 +1,262 @@
+/**
+ * Shadow OT Client - Music Stream Implementation
+ */
+
+#include "musicstream.h"
+#include <framework/core/memorytracker.h>
+#include <algorithm>
+#include <cstring>
+
+#if __has_include(<AL/al.h>)
+#include <AL/al.h>
+#else
+#include <OpenAL/al.h>
+#endif
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+uint32_t readU32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+uint16_t readU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+} // anonymous namespace
+
+// MusicDecoder
+
+std::unique_ptr<MusicDecoder> MusicDecoder::open(const std::string& path) {
+    if (path.ends_with(".wav")) {
+        auto decoder = std::make_unique<WavDecoder>();
+        if (decoder->open(path)) {
+            return decoder;
+        }
+    }
+    return nullptr;
+}
+
+// WavDecoder
+
+bool WavDecoder::open(const std::string& path) {
+    m_file.open(path, std::ios::binary);
+    uint8_t riff[12];
+    if (!m_file.read(reinterpret_cast<char*>(riff), sizeof(riff)) ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    // Chunks in any order; fmt must come before data
+    bool haveFormat = false;
+    uint8_t chunk[8];
+    while (m_file.read(reinterpret_cast<char*>(chunk), sizeof(chunk))) {
+        uint32_t size = readU32(chunk + 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t format[16];
+            m_file.read(reinterpret_cast<char*>(format), sizeof(format));
+            uint16_t tag = readU16(format);
+            m_channels = readU16(format + 2);
+            m_sampleRate = static_cast<int>(readU32(format + 4));
+            int bits = readU16(format + 14);
+
+            // 0xFFFE is WAVE_FORMAT_EXTENSIBLE, PCM for the layouts accepted here
+            if ((tag != 1 && tag != 0xFFFE) || (bits != 8 && bits != 16) ||
+                m_channels < 1 || m_channels > 2 || m_sampleRate <= 0) {
+                return false;
+            }
+            m_bytesPerSample = bits / 8;
+            haveFormat = true;
+            m_file.seekg(size - 16 + (size & 1), std::ios::cur);
+        } else if (std::memcmp(chunk, "data", 4) == 0 && haveFormat) {
+            m_dataStart = m_file.tellg();
+            m_dataFrames = size / (m_bytesPerSample * m_channels);
+            m_duration = static_cast<float>(m_dataFrames) / m_sampleRate;
+            return true;
+        } else {
+            // Chunks are padded to even sizes
+            m_file.seekg(size + (size & 1), std::ios::cur);
+        }
+    }
+    return false;
+}
+
+size_t WavDecoder::read(int16_t* out, size_t frames) {
+    frames = static_cast<size_t>(std::min<uint64_t>(frames, m_dataFrames - m_position));
+    size_t samples = frames * m_channels;
+    if (samples == 0) return 0;
+
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(out);
+    if (m_bytesPerSample == 1) {
+        m_scratch.resize(samples);
+        bytes = m_scratch.data();
+    }
+    if (!m_file.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(samples * m_bytesPerSample))) {
+        frames = static_cast<size_t>(m_file.gcount()) / (m_bytesPerSample * m_channels);
+        samples = frames * m_channels;
+        m_dataFrames = m_position + frames;
+    }
+
+    if (m_bytesPerSample == 1) {
+        for (size_t i = 0; i < samples; ++i) {
+            out[i] = static_cast<int16_t>((m_scratch[i] - 128) << 8);
+        }
+    } else {
+        // Little-endian on disk
+        for (size_t i = 0; i < samples; ++i) {
+            out[i] = static_cast<int16_t>(readU16(bytes + i * 2));
+        }
+    }
+
+    m_position += frames;
+    return frames;
+}
+
+bool WavDecoder::rewind() {
+    m_file.clear();
+    m_file.seekg(m_dataStart);
+    m_position = 0;
+    return static_cast<bool>(m_file);
+}
+
+// MusicStream
+
+MusicStream::MusicStream(std::unique_ptr<MusicDecoder> decoder, bool loop)
+    : m_decoder(std::move(decoder)), m_loop(loop) {
+    for (Block& block : m_ring) {
+        block.samples.resize(BLOCK_FRAMES * m_decoder->getChannels());
+    }
+    m_format = m_decoder->getChannels() == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+    g_memory.allocate(MemoryTag::Sound, getRingBytes());
+}
+
+MusicStream::~MusicStream() {
+    g_memory.release(MemoryTag::Sound, getRingBytes());
+}
+
+bool MusicStream::create(float gain) {
+    alGetError();
+    alGenSources(1, &m_source);
+    alGenBuffers(BUFFER_COUNT, m_buffers.data());
+    if (alGetError() != AL_NO_ERROR) {
+        m_source = 0;
+        return false;
+    }
+
+    // Music plays at the listener
+    alSourcei(m_source, AL_SOURCE_RELATIVE, AL_TRUE);
+    alSource3f(m_source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+    alSourcef(m_source, AL_GAIN, gain);
+    m_freeBuffers.assign(m_buffers.begin(), m_buffers.end());
+    return true;
+}
+
+void MusicStream::release() {
+    if (!m_source) return;
+
+    alSourceStop(m_source);
+    alSourcei(m_source, AL_BUFFER, 0);
+    alDeleteSources(1, &m_source);
+    alDeleteBuffers(BUFFER_COUNT, m_buffers.data());
+    m_source = 0;
+    m_freeBuffers.clear();
+    m_finished = true;
+}
+
+bool MusicStream::update() {
+    if (!m_source) return false;
+
+    ALint processed = 0;
+    alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buffer = 0;
+        alSourceUnqueueBuffers(m_source, 1, &buffer);
+        m_freeBuffers.push_back(buffer);
+    }
+
+    bool consumed = false;
+    while (!m_freeBuffers.empty()) {
+        uint32_t tail = m_ringTail.load(std::memory_order_relaxed);
+        if (tail == m_ringHead.load(std::memory_order_acquire)) break;
+
+        const Block& block = m_ring[tail % RING_BLOCKS];
+        ALuint buffer = m_freeBuffers.back();
+        m_freeBuffers.pop_back();
+        alBufferData(buffer, m_format, block.samples.data(),
+                     static_cast<ALsizei>(block.frames * m_decoder->getChannels() * sizeof(int16_t)),
+                     m_decoder->getSampleRate());
+        alSourceQueueBuffers(m_source, 1, &buffer);
+        m_ringTail.store(tail + 1, std::memory_order_release);
+        consumed = true;
+    }
+
+    ALint queued = 0;
+    ALint state = AL_STOPPED;
+    alGetSourcei(m_source, AL_BUFFERS_QUEUED, &queued);
+    alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+
+    // A source that ran dry stops; start it again once it has data, which
+    // also starts it the first time
+    if (queued > 0 && state != AL_PLAYING && !m_paused) {
+        alSourcePlay(m_source);
+    }
+
+    m_finished = queued == 0 && m_decodeEnded.load(std::memory_order_acquire) &&
+                 m_ringTail.load(std::memory_order_relaxed) == m_ringHead.load(std::memory_order_acquire);
+    return consumed;
+}
+
+void MusicStream::setGain(float gain) {
+    if (m_source) alSourcef(m_source, AL_GAIN, gain);
+}
+
+void MusicStream::pause() {
+    m_paused = true;
+    if (m_source) alSourcePause(m_source);
+}
+
+void MusicStream::resume() {
+    m_paused = false;
+    if (m_source) alSourcePlay(m_source);
+}
+
+bool MusicStream::decodeAhead() {
+    bool filled = false;
+    while (!m_decodeEnded.load(std::memory_order_relaxed)) {
+        uint32_t head = m_ringHead.load(std::memory_order_relaxed);
+        if (head - m_ringTail.load(std::memory_order_acquire) >= RING_BLOCKS) break;
+
+        // Loops continue in the same block; a track that rewinds to
+        // nothing ends instead of spinning
+        Block& block = m_ring[head % RING_BLOCKS];
+        int16_t* out = block.samples.data();
+        int channels = m_decoder->getChannels();
+        size_t frames = 0;
+        bool rewound = false;
+        while (frames < BLOCK_FRAMES) {
+            size_t read = m_decoder->read(out + frames * channels, BLOCK_FRAMES - frames);
+            if (read > 0) {
+                frames += read;
+                rewound = false;
+                continue;
+            }
+            if (!m_loop || rewound || !m_decoder->rewind()) {
+                m_decodeEnded.store(true, std::memory_order_release);
+                break;
+            }
+            rewound = true;
+        }
+
+        if (frames == 0) break;
+        block.frames = frames;
+        m_ringHead.store(head + 1, std::memory_order_release);
+        filled = true;
+    }
+    return filled;
+}
+
+} // namespace framework
+} // namespace shadow
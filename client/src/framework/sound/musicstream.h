@@ -0,0 +1,120 @@
+/**
+ * Shadow OT Client - Music Stream
+ *
+ * Music that plays while it decodes. The sound manager's decoder thread
+ * reads the file in chunks and decodes ahead into a small ring of PCM
+ * blocks; update() on the main thread copies finished blocks into the
+ * OpenAL buffers the source has played and queues them again. A playing
+ * track holds BUFFER_COUNT queued buffers and RING_BLOCKS decoded blocks,
+ * a few hundred KB however long it is.
+ *
+ * Only PCM WAV decodes in this build; other formats need a codec library
+ * behind MusicDecoder.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+class MusicDecoder {
+public:
+    virtual ~MusicDecoder() = default;
+
+    // By extension; nullptr if the format has no decoder or the file does
+    // not open
+    static std::unique_ptr<MusicDecoder> open(const std::string& path);
+
+    // Interleaved 16-bit frames; fewer than asked only at the end
+    virtual size_t read(int16_t* out, size_t frames) = 0;
+    virtual bool rewind() = 0;
+
+    int getSampleRate() const { return m_sampleRate; }
+    int getChannels() const { return m_channels; }
+    float getDuration() const { return m_duration; }
+
+protected:
+    int m_sampleRate{0};
+    int m_channels{0};
+    float m_duration{0.0f};
+};
+
+// RIFF WAVE, 8 or 16-bit PCM, mono or stereo
+class WavDecoder : public MusicDecoder {
+public:
+    bool open(const std::string& path);
+
+    size_t read(int16_t* out, size_t frames) override;
+    bool rewind() override;
+
+private:
+    std::ifstream m_file;
+    std::streamoff m_dataStart{0};
+    uint64_t m_dataFrames{0};
+    uint64_t m_position{0};
+    int m_bytesPerSample{2};
+    std::vector<uint8_t> m_scratch;
+};
+
+class MusicStream {
+public:
+    static constexpr size_t BLOCK_FRAMES = 8192;
+    static constexpr int BUFFER_COUNT = 4;
+    static constexpr uint32_t RING_BLOCKS = 4;
+
+    MusicStream(std::unique_ptr<MusicDecoder> decoder, bool loop);
+    ~MusicStream();
+    MusicStream(const MusicStream&) = delete;
+    MusicStream& operator=(const MusicStream&) = delete;
+
+    // Main thread. Playback begins once the first block is decoded;
+    // release() must run before the last reference goes, since that may
+    // be the decoder thread's.
+    bool create(float gain);
+    void release();
+    // True if blocks were taken from the ring
+    bool update();
+    void setGain(float gain);
+    void pause();
+    void resume();
+    bool isFinished() const { return m_finished; }
+
+    // Decoder thread: fill free ring blocks; true if any was filled
+    bool decodeAhead();
+
+private:
+    struct Block {
+        std::vector<int16_t> samples;
+        size_t frames{0};
+    };
+
+    size_t getRingBytes() const { return RING_BLOCKS * m_ring[0].samples.size() * sizeof(int16_t); }
+
+    std::unique_ptr<MusicDecoder> m_decoder;
+    bool m_loop{false};
+
+    // Single producer (decoder thread), single consumer (main thread)
+    std::array<Block, RING_BLOCKS> m_ring;
+    std::atomic<uint32_t> m_ringHead{0};
+    std::atomic<uint32_t> m_ringTail{0};
+    std::atomic<bool> m_decodeEnded{false};
+
+    uint32_t m_source{0};
+    std::array<uint32_t, BUFFER_COUNT> m_buffers{};
+    std::vector<uint32_t> m_freeBuffers;
+    int m_format{0};
+    bool m_paused{false};
+    bool m_finished{false};
+};
+
+} // namespace framework
+} // namespace shadow
@@ -3,8 +3,23 @@
  */
 
 #include "soundmanager.h"
+#include "musicstream.h"
+#include <framework/core/memorytracker.h>
+#include <framework/core/profiler.h>
+#include <framework/core/resourcemanager.h>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <filesystem>
+#include <utility>
+
+#if __has_include(<AL/alc.h>)
+#include <AL/al.h>
+#include <AL/alc.h>
+#else
+#include <OpenAL/al.h>
+#include <OpenAL/alc.h>
+#endif
 
 namespace shadow {
 namespace framework {
@@ -12,29 +27,47 @@ namespace framework {
 // SoundEffect implementation
 
 bool SoundEffect::load(const std::string& filename) {
+    unload();
     m_filename = filename;
 
-    // In a full implementation, this would:
-    // 1. Load the audio file (WAV, OGG, etc.)
-    // 2. Decode to PCM
-    // 3. Create audio buffer (SDL_mixer chunk, OpenAL buffer, etc.)
+    std::string path = g_resources.resolvePath(filename);
+    auto decoder = path.empty() ? nullptr : MusicDecoder::open(path);
+    if (!decoder) {
+        m_loaded = false;
+        return false;
+    }
 
-    // Determine format from extension
-    SoundFormat format = SoundFormat::Unknown;
-    if (filename.ends_with(".wav")) format = SoundFormat::WAV;
-    else if (filename.ends_with(".ogg")) format = SoundFormat::OGG;
-    else if (filename.ends_with(".mp3")) format = SoundFormat::MP3;
-    else if (filename.ends_with(".flac")) format = SoundFormat::FLAC;
+    // Decoded once; the PCM lives in the OpenAL buffer afterwards
+    std::vector<int16_t> samples;
+    std::vector<int16_t> chunk(MusicStream::BLOCK_FRAMES * decoder->getChannels());
+    while (size_t frames = decoder->read(chunk.data(), MusicStream::BLOCK_FRAMES)) {
+        samples.insert(samples.end(), chunk.begin(), chunk.begin() + frames * decoder->getChannels());
+    }
+    m_duration = decoder->getDuration();
+    m_audioSize = samples.size() * sizeof(int16_t);
+
+    alGetError();
+    alGenBuffers(1, &m_buffer);
+    alBufferData(m_buffer, decoder->getChannels() == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16,
+                 samples.data(), static_cast<ALsizei>(m_audioSize), decoder->getSampleRate());
+    if (alGetError() != AL_NO_ERROR) {
+        alDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+    if (m_buffer) g_memory.allocate(MemoryTag::Sound, m_audioSize);
 
     m_loaded = true;
     return m_loaded;
 }
 
 void SoundEffect::unload() {
-    if (m_audioData) {
-        // Free audio buffer
-        m_audioData = nullptr;
+    // Voices playing this buffer are stopped by the sound manager first
+    if (m_buffer) {
+        alDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        g_memory.release(MemoryTag::Sound, m_audioSize);
     }
+    m_audioSize = 0;
     m_loaded = false;
 }
 
@@ -42,21 +75,22 @@ void SoundEffect::unload() {
 
 bool MusicTrack::load(const std::string& filename) {
     m_filename = filename;
+    m_path = g_resources.resolvePath(filename);
 
-    // In a full implementation, this would:
-    // 1. Open the audio file for streaming
-    // 2. Read metadata (title, duration, etc.)
-    // 3. Create streaming handle
+    // Only the header is read here; playback opens its own decoder
+    auto decoder = m_path.empty() ? nullptr : MusicDecoder::open(m_path);
+    if (!decoder) {
+        m_loaded = false;
+        return false;
+    }
 
+    m_title = std::filesystem::path(filename).stem().string();
+    m_duration = decoder->getDuration();
     m_loaded = true;
     return m_loaded;
 }
 
 void MusicTrack::unload() {
-    if (m_streamHandle) {
-        // Close stream
-        m_streamHandle = nullptr;
-    }
     m_loaded = false;
 }
 
@@ -70,20 +104,41 @@ SoundManager& SoundManager::instance() {
 bool SoundManager::init() {
     if (m_initialized) return true;
 
-    // Initialize audio subsystem
-    // In a full implementation, this would:
-    // 1. Initialize SDL_mixer or OpenAL
-    // 2. Open audio device
-    // 3. Set up channels
+    // Without a device the client runs silent rather than failing
+    m_device = alcOpenDevice(nullptr);
+    if (m_device) {
+        m_context = alcCreateContext(m_device, nullptr);
+    }
+    if (m_context && alcMakeContextCurrent(m_context)) {
+        const char* name = alcGetString(m_device, ALC_DEVICE_SPECIFIER);
+        m_deviceName = name ? name : "Default Audio Device";
+
+        // Positional voices fade linearly between their min and max
+        // distances, as playSound3D computes for culling and stealing
+        alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
+        alGetError();
+        for (int i = 0; i < MAX_VOICES; ++i) {
+            ALuint source = 0;
+            alGenSources(1, &source);
+            if (alGetError() != AL_NO_ERROR) break;
+            m_voices.emplace_back().source = source;
+        }
+    } else {
+        if (m_context) alcDestroyContext(m_context);
+        if (m_device) alcCloseDevice(m_device);
+        m_context = nullptr;
+        m_device = nullptr;
+    }
 
     // Set default channel volumes
     for (int i = 0; i < static_cast<int>(SoundChannel::MaxChannels); ++i) {
         m_channelVolumes[static_cast<SoundChannel>(i)] = 1.0f;
     }
 
-    m_initialized = true;
-    m_deviceName = "Default Audio Device";
+    m_decoderRunning = true;
+    m_decoderThread = std::thread(&SoundManager::decoderLoop, this);
 
+    m_initialized = true;
     return true;
 }
 
@@ -95,37 +150,36 @@ void SoundManager::terminate() {
 
     clearCache();
 
+    for (Voice& voice : m_voices) {
+        alDeleteSources(1, &voice.source);
+    }
+    m_voices.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_decoderMutex);
+        m_decoderRunning = false;
+    }
+    m_decoderCondition.notify_all();
+    if (m_decoderThread.joinable()) {
+        m_decoderThread.join();
+    }
+
     // Close audio subsystem
+    if (m_context) {
+        alcMakeContextCurrent(nullptr);
+        alcDestroyContext(m_context);
+        alcCloseDevice(m_device);
+        m_context = nullptr;
+        m_device = nullptr;
+    }
     m_initialized = false;
 }
 
 void SoundManager::update(float deltaTime) {
     if (!m_initialized) return;
 
-    // Handle music fading
-    if (m_musicFadeTime > 0.0f) {
-        float fadeProgress = deltaTime / m_musicFadeTime;
-        m_musicFadeTime -= deltaTime;
-
-        if (m_musicFadeTime <= 0.0f) {
-            m_musicFadeCurrent = m_musicFadeTarget;
-            m_musicFadeTime = 0.0f;
-
-            // If fading to 0, stop music
-            if (m_musicFadeTarget <= 0.0f) {
-                m_musicPlaying = false;
-            }
-        } else {
-            float diff = m_musicFadeTarget - m_musicFadeCurrent;
-            m_musicFadeCurrent += diff * fadeProgress;
-        }
-
-        // Apply volume change
-        // setMusicVolumeInternal(m_musicFadeCurrent * m_musicVolume * m_masterVolume);
-    }
-
-    // Clean up finished sounds
-    // In a full implementation, check which sounds have finished playing
+    updateMusic(deltaTime);
+    updateVoices();
 }
 
 SoundEffectPtr SoundManager::loadSound(const std::string& filename) {
@@ -148,20 +202,23 @@ SoundEffectPtr SoundManager::loadSound(const std::string& filename) {
 void SoundManager::unloadSound(const std::string& filename) {
     auto it = m_soundCache.find(filename);
     if (it != m_soundCache.end()) {
+        for (Voice& voice : m_voices) {
+            if (voice.sound == it->second) stopVoice(voice);
+        }
         it->second->unload();
         m_soundCache.erase(it);
     }
 }
 
-PlayingSoundHandle SoundManager::playSound(const std::string& filename, SoundChannel channel) {
+PlayingSoundHandle SoundManager::playSound(const std::string& filename, SoundChannel channel, SoundPriority priority) {
     auto sound = loadSound(filename);
     if (!sound) {
         return {0, false};
     }
-    return playSound(sound, channel);
+    return playSound(sound, channel, priority);
 }
 
-PlayingSoundHandle SoundManager::playSound(SoundEffectPtr sound, SoundChannel channel) {
+PlayingSoundHandle SoundManager::playSound(SoundEffectPtr sound, SoundChannel channel, SoundPriority priority) {
     if (!m_initialized || !sound || !sound->isLoaded()) {
         return {0, false};
     }
@@ -170,18 +227,7 @@ PlayingSoundHandle SoundManager::playSound(SoundEffectPtr sound, SoundChannel ch
         return {0, false};
     }
 
-    // Calculate effective volume
-    float volume = getEffectiveVolume(channel);
-
-    // In a full implementation:
-    // 1. Find a free channel
-    // 2. Set volume
-    // 3. Play sound
-
-    uint32_t soundId = m_nextSoundId++;
-    m_playingSounds[soundId] = channel;
-
-    return {soundId, true};
+    return startVoice(sound, channel, priority, 1.0f, nullptr);
 }
 
 PlayingSoundHandle SoundManager::playSound3D(const std::string& filename, const SoundSource3D& source) {
@@ -189,39 +235,151 @@ PlayingSoundHandle SoundManager::playSound3D(const std::string& filename, const
         return {0, false};
     }
 
+    // Culled before the file is even looked up
+    float dx = source.x - m_listenerX;
+    float dy = source.y - m_listenerY;
+    float dz = source.z - m_listenerZ;
+    if (dx * dx + dy * dy + dz * dz > m_cullRadius * m_cullRadius || getAttenuation(source) <= 0.0f) {
+        m_voiceStats.culled++;
+        return {0, false};
+    }
+
     auto sound = loadSound(filename);
     if (!sound) {
         return {0, false};
     }
 
-    // Calculate distance-based volume
+    return startVoice(sound, SoundChannel::Effects, source.priority, source.volume, &source);
+}
+
+SoundManager::VoiceStats SoundManager::getVoiceStats() const {
+    VoiceStats stats = m_voiceStats;
+    stats.poolSize = static_cast<uint32_t>(m_voices.size());
+    stats.active = static_cast<uint32_t>(std::count_if(m_voices.begin(), m_voices.end(),
+                                                       [](const Voice& voice) { return voice.id != 0; }));
+    return stats;
+}
+
+float SoundManager::getAttenuation(const SoundSource3D& source) const {
     float dx = source.x - m_listenerX;
     float dy = source.y - m_listenerY;
     float dz = source.z - m_listenerZ;
     float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
 
-    float attenuation = 1.0f;
-    if (distance > source.minDistance) {
-        if (distance >= source.maxDistance) {
-            attenuation = 0.0f;
-        } else {
-            attenuation = 1.0f - (distance - source.minDistance) /
-                                 (source.maxDistance - source.minDistance);
-        }
+    if (distance <= source.minDistance) return 1.0f;
+    if (distance >= source.maxDistance) return 0.0f;
+    return 1.0f - (distance - source.minDistance) / (source.maxDistance - source.minDistance);
+}
+
+PlayingSoundHandle SoundManager::startVoice(const SoundEffectPtr& sound, SoundChannel channel, SoundPriority priority,
+                                            float volume, const SoundSource3D* position) {
+    float audibility = volume * (position ? getAttenuation(*position) : 1.0f);
+    Voice* voice = sound->getBuffer() ? acquireVoice(priority, audibility) : nullptr;
+    if (!voice) {
+        m_voiceStats.rejected++;
+        return {0, false};
     }
 
-    float volume = source.volume * attenuation * getEffectiveVolume(SoundChannel::Effects);
+    // Serials wrap before reaching the voice index byte
+    uint32_t serial = m_nextSoundId++;
+    if (m_nextSoundId >= (1u << 24)) {
+        m_nextSoundId = 1;
+    }
+    voice->id = (serial << 8) | static_cast<uint32_t>(voice - m_voices.data());
+    voice->sound = sound;
+    voice->channel = channel;
+    voice->priority = priority;
+    voice->volume = volume;
+    voice->audibility = audibility;
+    voice->positional = position != nullptr;
+
+    ALuint source = voice->source;
+    alSourcei(source, AL_BUFFER, static_cast<ALint>(sound->getBuffer()));
+    alSourcef(source, AL_GAIN, volume * getEffectiveVolume(channel));
+    if (position) {
+        voice->position = *position;
+        alSourcei(source, AL_SOURCE_RELATIVE, AL_FALSE);
+        alSource3f(source, AL_POSITION, position->x, position->y, position->z);
+        alSourcef(source, AL_REFERENCE_DISTANCE, position->minDistance);
+        alSourcef(source, AL_MAX_DISTANCE, position->maxDistance);
+        alSourcef(source, AL_ROLLOFF_FACTOR, 1.0f);
+    } else {
+        alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+        alSource3f(source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+        alSourcef(source, AL_ROLLOFF_FACTOR, 0.0f);
+    }
+    alSourcePlay(source);
 
-    if (volume <= 0.0f) {
-        return {0, false};
+    m_voiceStats.played++;
+    return {voice->id, true};
+}
+
+SoundManager::Voice* SoundManager::acquireVoice(SoundPriority priority, float audibility) {
+    // A free voice, else the least important playing one: lowest priority,
+    // then quietest at the listener
+    Voice* victim = nullptr;
+    for (Voice& voice : m_voices) {
+        if (voice.id == 0) return &voice;
+        if (!victim || voice.priority < victim->priority ||
+            (voice.priority == victim->priority && voice.audibility < victim->audibility)) {
+            victim = &voice;
+        }
     }
 
-    // In a full implementation, also calculate pan based on direction
+    if (!victim || victim->priority > priority ||
+        (victim->priority == priority && victim->audibility >= audibility)) {
+        return nullptr;
+    }
+    stopVoice(*victim);
+    m_voiceStats.stolen++;
+    return victim;
+}
+
+SoundManager::Voice* SoundManager::findVoice(PlayingSoundHandle handle) {
+    return const_cast<Voice*>(std::as_const(*this).findVoice(handle));
+}
 
-    uint32_t soundId = m_nextSoundId++;
-    m_playingSounds[soundId] = SoundChannel::Effects;
+const SoundManager::Voice* SoundManager::findVoice(PlayingSoundHandle handle) const {
+    if (!handle.valid) return nullptr;
 
-    return {soundId, true};
+    uint32_t index = handle.id & 0xFF;
+    if (index >= m_voices.size() || m_voices[index].id != handle.id) return nullptr;
+    return &m_voices[index];
+}
+
+void SoundManager::stopVoice(Voice& voice) {
+    if (voice.id == 0) return;
+
+    alSourceStop(voice.source);
+    alSourcei(voice.source, AL_BUFFER, 0);
+    voice.id = 0;
+    voice.sound.reset();
+}
+
+void SoundManager::updateVoices() {
+    // Bounded by the pool, however many sounds were requested
+    uint32_t active = 0;
+    for (Voice& voice : m_voices) {
+        if (voice.id == 0) continue;
+
+        ALint state = AL_STOPPED;
+        alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
+        if (state == AL_STOPPED) {
+            stopVoice(voice);
+            continue;
+        }
+
+        // The listener moves; OpenAL attenuates, this keeps stealing current
+        if (voice.positional) {
+            voice.audibility = voice.volume * getAttenuation(voice.position);
+        }
+        alSourcef(voice.source, AL_GAIN, voice.volume * getEffectiveVolume(voice.channel));
+        active++;
+    }
+
+    g_profiler.setGauge(Profiler::GaugeVoices, static_cast<float>(active));
+    g_profiler.setGauge(Profiler::GaugeVoicesCulled, static_cast<float>(m_voiceStats.culled));
+    g_profiler.setGauge(Profiler::GaugeVoicesStolen, static_cast<float>(m_voiceStats.stolen));
 }
 
 MusicTrackPtr SoundManager::loadMusic(const std::string& filename) {
@@ -249,9 +407,13 @@ void SoundManager::playMusic(const std::string& filename, bool loop, float fadeI
 void SoundManager::playMusic(MusicTrackPtr track, bool loop, float fadeIn) {
     if (!m_initialized || !track || !track->isLoaded()) return;
 
-    // Stop current music if playing
-    if (m_musicPlaying) {
-        stopMusic(0.0f);
+    // With a fade the current track fades out over the same time, so the
+    // two crossfade; without, it stops at once
+    if (m_music.stream && fadeIn > 0.0f) {
+        startFade(m_music, 0.0f, fadeIn);
+        m_outgoingMusic.push_back(std::move(m_music));
+    } else {
+        releaseMusic(m_music);
     }
 
     m_currentMusic = track;
@@ -259,45 +421,151 @@ void SoundManager::playMusic(MusicTrackPtr track, bool loop, float fadeIn) {
     m_musicPlaying = true;
     m_musicPaused = false;
 
+    m_music = MusicPlayback{};
     if (fadeIn > 0.0f) {
-        m_musicFadeCurrent = 0.0f;
-        m_musicFadeTarget = 1.0f;
-        m_musicFadeTime = fadeIn;
-    } else {
-        m_musicFadeCurrent = 1.0f;
-        m_musicFadeTarget = 1.0f;
-        m_musicFadeTime = 0.0f;
+        m_music.fade = 0.0f;
+        startFade(m_music, 1.0f, fadeIn);
     }
 
-    // In a full implementation, start playing the music stream
+    auto decoder = m_context ? MusicDecoder::open(track->getPath()) : nullptr;
+    if (!decoder) return;
+
+    auto stream = std::make_shared<MusicStream>(std::move(decoder), loop);
+    if (!stream->create(m_music.fade * getEffectiveMusicVolume())) return;
+    m_music.stream = stream;
+    {
+        std::lock_guard<std::mutex> lock(m_decoderMutex);
+        m_decoderStreams.push_back(stream);
+    }
+    m_decoderCondition.notify_one();
 }
 
 void SoundManager::stopMusic(float fadeOut) {
     if (!m_musicPlaying) return;
 
-    if (fadeOut > 0.0f) {
-        m_musicFadeTarget = 0.0f;
-        m_musicFadeTime = fadeOut;
+    if (fadeOut > 0.0f && m_music.stream) {
+        startFade(m_music, 0.0f, fadeOut);
     } else {
         m_musicPlaying = false;
         m_musicPaused = false;
         m_currentMusic = nullptr;
 
-        // Actually stop playback
+        releaseMusic(m_music);
+        for (MusicPlayback& playback : m_outgoingMusic) {
+            releaseMusic(playback);
+        }
+        m_outgoingMusic.clear();
     }
 }
 
 void SoundManager::pauseMusic() {
     if (m_musicPlaying && !m_musicPaused) {
         m_musicPaused = true;
-        // Pause playback
+        if (m_music.stream) m_music.stream->pause();
+        for (MusicPlayback& playback : m_outgoingMusic) {
+            playback.stream->pause();
+        }
     }
 }
 
 void SoundManager::resumeMusic() {
     if (m_musicPlaying && m_musicPaused) {
         m_musicPaused = false;
-        // Resume playback
+        if (m_music.stream) m_music.stream->resume();
+        for (MusicPlayback& playback : m_outgoingMusic) {
+            playback.stream->resume();
+        }
+    }
+}
+
+void SoundManager::startFade(MusicPlayback& playback, float target, float seconds) {
+    playback.fadeTarget = target;
+    if (seconds > 0.0f) {
+        playback.fadeRate = std::abs(target - playback.fade) / seconds;
+    } else {
+        playback.fade = target;
+        playback.fadeRate = 0.0f;
+    }
+}
+
+void SoundManager::updateMusic(float deltaTime) {
+    float volume = getEffectiveMusicVolume();
+    bool consumed = false;
+    auto advance = [&](MusicPlayback& playback) {
+        if (playback.fadeRate > 0.0f) {
+            float step = playback.fadeRate * deltaTime;
+            if (std::abs(playback.fadeTarget - playback.fade) <= step) {
+                playback.fade = playback.fadeTarget;
+                playback.fadeRate = 0.0f;
+            } else {
+                playback.fade += playback.fadeTarget > playback.fade ? step : -step;
+            }
+        }
+        playback.stream->setGain(playback.fade * volume);
+        consumed |= playback.stream->update();
+    };
+
+    if (m_music.stream) {
+        advance(m_music);
+        bool fadedOut = m_music.fadeTarget <= 0.0f && m_music.fade <= 0.0f;
+        bool finished = m_music.stream->isFinished();
+        if (fadedOut || finished) {
+            releaseMusic(m_music);
+            m_musicPlaying = false;
+            m_musicPaused = false;
+            m_currentMusic = nullptr;
+            if (finished && !fadedOut && m_musicFinishedCallback) {
+                m_musicFinishedCallback();
+            }
+        }
+    }
+
+    for (auto it = m_outgoingMusic.begin(); it != m_outgoingMusic.end();) {
+        advance(*it);
+        if (it->fade <= 0.0f || it->stream->isFinished()) {
+            releaseMusic(*it);
+            it = m_outgoingMusic.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Blocks were freed in the rings
+    if (consumed) {
+        m_decoderCondition.notify_one();
+    }
+}
+
+void SoundManager::releaseMusic(MusicPlayback& playback) {
+    if (!playback.stream) return;
+
+    playback.stream->release();
+    {
+        std::lock_guard<std::mutex> lock(m_decoderMutex);
+        std::erase(m_decoderStreams, playback.stream);
+    }
+    playback.stream.reset();
+}
+
+void SoundManager::decoderLoop() {
+    std::vector<std::shared_ptr<MusicStream>> streams;
+    std::unique_lock<std::mutex> lock(m_decoderMutex);
+    while (m_decoderRunning) {
+        streams = m_decoderStreams;
+        lock.unlock();
+
+        bool filled = false;
+        for (const auto& stream : streams) {
+            filled |= stream->decodeAhead();
+        }
+        streams.clear();
+
+        lock.lock();
+        if (!filled) {
+            // Woken when update() frees blocks; the timeout covers a
+            // notification sent while this thread was decoding
+            m_decoderCondition.wait_for(lock, std::chrono::milliseconds(50));
+        }
     }
 }
 
@@ -307,34 +575,25 @@ const std::string& SoundManager::getCurrentMusicFilename() const {
 }
 
 void SoundManager::stopSound(PlayingSoundHandle handle) {
-    if (!handle.valid) return;
-
-    auto it = m_playingSounds.find(handle.id);
-    if (it != m_playingSounds.end()) {
-        // Stop the sound
-        m_playingSounds.erase(it);
+    if (Voice* voice = findVoice(handle)) {
+        stopVoice(*voice);
     }
 }
 
 void SoundManager::stopAllSounds(SoundChannel channel) {
-    for (auto it = m_playingSounds.begin(); it != m_playingSounds.end();) {
-        if (it->second == channel) {
-            // Stop sound
-            it = m_playingSounds.erase(it);
-        } else {
-            ++it;
-        }
+    for (Voice& voice : m_voices) {
+        if (voice.channel == channel) stopVoice(voice);
     }
 }
 
 void SoundManager::stopAllSounds() {
-    m_playingSounds.clear();
-    // Stop all sound channels
+    for (Voice& voice : m_voices) {
+        stopVoice(voice);
+    }
 }
 
 bool SoundManager::isPlaying(PlayingSoundHandle handle) const {
-    if (!handle.valid) return false;
-    return m_playingSounds.find(handle.id) != m_playingSounds.end();
+    return findVoice(handle) != nullptr;
 }
 
 void SoundManager::setMasterVolume(float volume) {
@@ -374,11 +633,13 @@ void SoundManager::setListenerPosition(float x, float y, float z) {
     m_listenerX = x;
     m_listenerY = y;
     m_listenerZ = z;
+    if (m_context) alListener3f(AL_POSITION, x, y, z);
 }
 
 void SoundManager::setListenerOrientation(float atX, float atY, float atZ,
                                           float upX, float upY, float upZ) {
-    // Set listener orientation for 3D audio
+    const ALfloat orientation[6] = {atX, atY, atZ, upX, upY, upZ};
+    if (m_context) alListenerfv(AL_ORIENTATION, orientation);
 }
 
 void SoundManager::preloadSounds(const std::vector<std::string>& filenames) {
@@ -388,6 +649,7 @@ void SoundManager::preloadSounds(const std::vector<std::string>& filenames) {
 }
 
 void SoundManager::clearCache() {
+    stopAllSounds();
     for (auto& [filename, sound] : m_soundCache) {
         sound->unload();
     }
@@ -404,6 +666,11 @@ float SoundManager::getEffectiveVolume(SoundChannel channel) const {
     return m_masterVolume * m_soundVolume * getChannelVolume(channel);
 }
 
+float SoundManager::getEffectiveMusicVolume() const {
+    if (m_muted || m_musicMuted) return 0.0f;
+    return m_masterVolume * m_musicVolume * getChannelVolume(SoundChannel::Music);
+}
+
 } // namespace framework
 } // namespace shadow
 
@@ -2,6 +2,14 @@
  * Shadow OT Client - Sound Manager
  *
  * Audio system with support for sound effects, music, and 3D positional audio.
+ * Music streams from disk through a decoder thread (see musicstream.h);
+ * switching tracks with a fade crossfades the outgoing track into the new one.
+ *
+ * Effects play on a fixed pool of voices. Positional sounds beyond the cull
+ * radius are dropped before they take one; when the pool is full a sound
+ * steals the voice of the least important one playing, by priority and
+ * then by how loud it is at the listener. Each effect file is decoded once
+ * into a buffer that every voice playing it shares.
  */
 
 #pragma once
@@ -12,6 +20,12 @@
 #include <memory>
 #include <functional>
 #include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct ALCdevice;
+struct ALCcontext;
 
 namespace shadow {
 namespace framework {
@@ -35,7 +49,15 @@ enum class SoundFormat {
     FLAC
 };
 
-// Sound effect instance
+// Which sound keeps its voice when the pool runs out
+enum class SoundPriority : uint8_t {
+    Low,            // Footsteps, ambient one-shots
+    Normal,
+    High,           // Own spells and hits
+    Critical        // UI feedback, never stolen by lower priorities
+};
+
+// Sound effect instance, decoded whole into one OpenAL buffer
 class SoundEffect {
 public:
     SoundEffect() = default;
@@ -47,20 +69,24 @@ public:
     bool isLoaded() const { return m_loaded; }
     const std::string& getFilename() const { return m_filename; }
     float getDuration() const { return m_duration; }
+    uint32_t getBuffer() const { return m_buffer; }
+    size_t getAudioSize() const { return m_audioSize; }
 
 private:
     std::string m_filename;
     bool m_loaded{false};
     float m_duration{0.0f};
 
-    // Audio data (would be backend-specific)
-    void* m_audioData{nullptr};
+    uint32_t m_buffer{0};           // 0 without an audio device
     size_t m_audioSize{0};
 };
 
 using SoundEffectPtr = std::shared_ptr<SoundEffect>;
 
-// Music track
+class MusicStream;
+
+// Music track: where the file is and what it holds. The audio itself is
+// read while it plays, by a MusicStream per playback.
 class MusicTrack {
 public:
     MusicTrack() = default;
@@ -71,17 +97,16 @@ public:
 
     bool isLoaded() const { return m_loaded; }
     const std::string& getFilename() const { return m_filename; }
+    const std::string& getPath() const { return m_path; }
     const std::string& getTitle() const { return m_title; }
     float getDuration() const { return m_duration; }
 
 private:
     std::string m_filename;
+    std::string m_path;             // Resolved through ResourceManager
     std::string m_title;
     bool m_loaded{false};
     float m_duration{0.0f};
-
-    // Streaming handle
-    void* m_streamHandle{nullptr};
 };
 
 using MusicTrackPtr = std::shared_ptr<MusicTrack>;
@@ -100,6 +125,7 @@ struct SoundSource3D {
     float volume{1.0f};
     float minDistance{1.0f};
     float maxDistance{100.0f};
+    SoundPriority priority{SoundPriority::Normal};
 };
 
 class SoundManager {
@@ -113,10 +139,30 @@ public:
     // Sound effects
     SoundEffectPtr loadSound(const std::string& filename);
     void unloadSound(const std::string& filename);
-    PlayingSoundHandle playSound(const std::string& filename, SoundChannel channel = SoundChannel::Effects);
-    PlayingSoundHandle playSound(SoundEffectPtr sound, SoundChannel channel = SoundChannel::Effects);
+    PlayingSoundHandle playSound(const std::string& filename, SoundChannel channel = SoundChannel::Effects,
+                                 SoundPriority priority = SoundPriority::Normal);
+    PlayingSoundHandle playSound(SoundEffectPtr sound, SoundChannel channel = SoundChannel::Effects,
+                                 SoundPriority priority = SoundPriority::Normal);
     PlayingSoundHandle playSound3D(const std::string& filename, const SoundSource3D& source);
 
+    // Voice pool
+    static constexpr int MAX_VOICES = 32;
+    static constexpr float DEFAULT_CULL_RADIUS = 20.0f;
+
+    // Positional sounds farther than this from the listener never play
+    void setCullRadius(float radius) { m_cullRadius = radius; }
+    float getCullRadius() const { return m_cullRadius; }
+
+    struct VoiceStats {
+        uint32_t poolSize{0};
+        uint32_t active{0};
+        uint64_t played{0};
+        uint64_t culled{0};         // Out of range or inaudible
+        uint64_t stolen{0};         // Voices taken from a playing sound
+        uint64_t rejected{0};       // Pool full of more important sounds
+    };
+    VoiceStats getVoiceStats() const;
+
     // Music
     MusicTrackPtr loadMusic(const std::string& filename);
     void playMusic(const std::string& filename, bool loop = true, float fadeIn = 0.0f);
@@ -172,15 +218,52 @@ public:
     // Audio device info
     std::string getAudioDeviceName() const { return m_deviceName; }
     bool isInitialized() const { return m_initialized; }
+    // False when init() found no audio device and the client runs silent
+    bool hasAudioDevice() const { return m_context != nullptr; }
 
 private:
     SoundManager() = default;
 
+    // A track playing or fading out. Fades are linear in gain.
+    struct MusicPlayback {
+        std::shared_ptr<MusicStream> stream;
+        float fade{1.0f};
+        float fadeTarget{1.0f};
+        float fadeRate{0.0f};       // Gain per second
+    };
+
+    struct Voice {
+        uint32_t source{0};
+        uint32_t id{0};                 // 0 while free
+        SoundEffectPtr sound;
+        SoundChannel channel{SoundChannel::Effects};
+        SoundPriority priority{SoundPriority::Normal};
+        float volume{1.0f};             // Before channel and master volume
+        float audibility{0.0f};         // Volume after distance, for stealing
+        bool positional{false};
+        SoundSource3D position;
+    };
+
     float getEffectiveVolume(SoundChannel channel) const;
+    float getEffectiveMusicVolume() const;
+    float getAttenuation(const SoundSource3D& source) const;
+    PlayingSoundHandle startVoice(const SoundEffectPtr& sound, SoundChannel channel, SoundPriority priority,
+                                  float volume, const SoundSource3D* position);
+    Voice* acquireVoice(SoundPriority priority, float audibility);
+    Voice* findVoice(PlayingSoundHandle handle);
+    const Voice* findVoice(PlayingSoundHandle handle) const;
+    void stopVoice(Voice& voice);
+    void updateVoices();
+    static void startFade(MusicPlayback& playback, float target, float seconds);
+    void updateMusic(float deltaTime);
+    void releaseMusic(MusicPlayback& playback);
+    void decoderLoop();
 
     // State
     bool m_initialized{false};
     std::string m_deviceName;
+    ALCdevice* m_device{nullptr};
+    ALCcontext* m_context{nullptr};
 
     // Volume settings
     float m_masterVolume{1.0f};
@@ -198,17 +281,26 @@ private:
     bool m_musicPaused{false};
     bool m_musicLooping{false};
     MusicTrackPtr m_currentMusic;
-    float m_musicFadeTime{0.0f};
-    float m_musicFadeTarget{0.0f};
-    float m_musicFadeCurrent{1.0f};
+    MusicPlayback m_music;
+    std::vector<MusicPlayback> m_outgoingMusic;
+
+    // Decoder thread, shared by every stream; streams are added and
+    // removed on the main thread
+    std::thread m_decoderThread;
+    bool m_decoderRunning{false};
+    std::mutex m_decoderMutex;
+    std::condition_variable m_decoderCondition;
+    std::vector<std::shared_ptr<MusicStream>> m_decoderStreams;
 
     // Sound cache
     std::map<std::string, SoundEffectPtr> m_soundCache;
     std::map<std::string, MusicTrackPtr> m_musicCache;
 
-    // Playing sounds tracking
+    // Voice pool; a handle's id carries its voice index in the low byte
+    std::vector<Voice> m_voices;
     uint32_t m_nextSoundId{1};
-    std::map<uint32_t, SoundChannel> m_playingSounds;
+    float m_cullRadius{DEFAULT_CULL_RADIUS};
+    VoiceStats m_voiceStats;
 
     // 3D listener
     float m_listenerX{0.0f};
@@ -0,0 +1,187 @@
+/**
+ * Shadow OT Client - UI Animation Implementation
+ */
+
+#include "uianimation.h"
+#include "uiwidget.h"
+#include <algorithm>
+#include <cmath>
+
+namespace shadow {
+namespace framework {
+
+float applyEasing(Easing easing, float t) {
+    switch (easing) {
+        case Easing::Linear:
+            return t;
+        case Easing::OutQuad:
+            return 1.0f - (1.0f - t) * (1.0f - t);
+        case Easing::OutCubic: {
+            float inv = 1.0f - t;
+            return 1.0f - inv * inv * inv;
+        }
+        case Easing::InOutCubic:
+            if (t < 0.5f) {
+                return 4.0f * t * t * t;
+            } else {
+                float inv = -2.0f * t + 2.0f;
+                return 1.0f - inv * inv * inv / 2.0f;
+            }
+        case Easing::OutBack: {
+            constexpr float c1 = 1.70158f;
+            constexpr float c3 = c1 + 1.0f;
+            float u = t - 1.0f;
+            return 1.0f + c3 * u * u * u + c1 * u * u;
+        }
+    }
+    return t;
+}
+
+float UIAnimator::readProperty(const UIWidget& widget, Property property) {
+    switch (property) {
+        case Property::Opacity: return widget.getOpacity();
+        case Property::X: return static_cast<float>(widget.getX());
+        case Property::Y: return static_cast<float>(widget.getY());
+        default: return 0.0f;
+    }
+}
+
+void UIAnimator::animate(const UIWidgetPtr& widget, Property property, float to, float duration,
+                         Easing easing, uint8_t finish) {
+    if (!widget) return;
+    animate(widget, property, readProperty(*widget, property), to, duration, easing, finish);
+}
+
+void UIAnimator::animate(const UIWidgetPtr& widget, Property property, float from, float to, float duration,
+                         Easing easing, uint8_t finish) {
+    if (!widget || property >= Property::Count) return;
+
+    Track& track = m_tracks[static_cast<size_t>(property)];
+    Tween tween{widget.get(), from, to, 0.0f, std::max(duration, 0.0f), easing, finish};
+
+    for (size_t i = 0; i < track.tweens.size(); ++i) {
+        if (track.tweens[i].widget == widget.get() && !track.owners[i].expired()) {
+            track.tweens[i] = tween;
+            return;
+        }
+    }
+
+    track.tweens.push_back(tween);
+    track.owners.push_back(widget);
+    m_stats.active++;
+}
+
+void UIAnimator::stop(const UIWidget* widget) {
+    for (Track& track : m_tracks) {
+        for (size_t i = 0; i < track.tweens.size();) {
+            if (track.tweens[i].widget == widget) {
+                removeAt(track, i);
+            } else {
+                ++i;
+            }
+        }
+    }
+}
+
+void UIAnimator::clear() {
+    for (Track& track : m_tracks) {
+        track.tweens.clear();
+        track.owners.clear();
+    }
+    m_finished.clear();
+    m_stats = Stats{};
+}
+
+void UIAnimator::removeAt(Track& track, size_t index) {
+    // Order within a track does not matter; swap the last one in
+    track.tweens[index] = track.tweens.back();
+    track.tweens.pop_back();
+    track.owners[index] = std::move(track.owners.back());
+    track.owners.pop_back();
+    m_stats.active--;
+}
+
+void UIAnimator::update(float deltaTime) {
+    m_stats.applied = 0;
+    if (m_stats.active == 0) return;
+
+    for (size_t property = 0; property < m_tracks.size(); ++property) {
+        if (!m_tracks[property].tweens.empty()) {
+            updateTrack(static_cast<Property>(property), deltaTime);
+        }
+    }
+
+    // Finish actions run after the pass; destroying a widget may end
+    // tweens on other tracks
+    for (const Finished& finished : m_finished) {
+        auto widget = finished.widget.lock();
+        if (!widget) continue;
+
+        if (finished.finish & FinishHide) {
+            widget->hide();
+        }
+        if (finished.finish & FinishDestroy) {
+            stop(widget.get());
+            widget->destroy();
+        }
+    }
+    m_finished.clear();
+}
+
+void UIAnimator::updateTrack(Property property, float deltaTime) {
+    Track& track = m_tracks[static_cast<size_t>(property)];
+
+    for (size_t i = 0; i < track.tweens.size();) {
+        Tween& tween = track.tweens[i];
+        if (track.owners[i].expired() || tween.widget->isDestroyed()) {
+            removeAt(track, i);
+            continue;
+        }
+
+        tween.elapsed += deltaTime;
+        float t = tween.duration > 0.0f ? std::min(tween.elapsed / tween.duration, 1.0f) : 1.0f;
+        float value = tween.from + (tween.to - tween.from) * applyEasing(tween.easing, t);
+
+        // Only changed values are written, so a still frame leaves the
+        // window's cached layer alone
+        UIWidget& widget = *tween.widget;
+        switch (property) {
+            case Property::Opacity:
+                if (widget.getOpacity() != value) {
+                    widget.setOpacity(value);
+                    m_stats.applied++;
+                }
+                break;
+            case Property::X: {
+                int x = static_cast<int>(std::lround(value));
+                if (widget.getX() != x) {
+                    widget.setX(x);
+                    m_stats.applied++;
+                }
+                break;
+            }
+            case Property::Y: {
+                int y = static_cast<int>(std::lround(value));
+                if (widget.getY() != y) {
+                    widget.setY(y);
+                    m_stats.applied++;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (t >= 1.0f) {
+            if (tween.finish != FinishNone) {
+                m_finished.push_back({track.owners[i], tween.finish});
+            }
+            removeAt(track, i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,97 @@
+/**
+ * Shadow OT Client - UI Animation
+ *
+ * Tweens of widget properties. Each property has its own track, a flat
+ * array of tweens updated in one pass per frame; a widget is only touched
+ * when its rounded value changes, so a tween repaints its window (see
+ * UIWidget::invalidate) only on frames where it moves. With nothing
+ * animating, an update costs nothing.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace shadow {
+namespace framework {
+
+class UIWidget;
+using UIWidgetPtr = std::shared_ptr<UIWidget>;
+
+enum class Easing : uint8_t {
+    Linear,
+    OutQuad,
+    OutCubic,
+    InOutCubic,
+    OutBack         // Overshoots slightly, then settles
+};
+
+// t in [0, 1]
+float applyEasing(Easing easing, float t);
+
+class UIAnimator {
+public:
+    enum class Property : uint8_t { Opacity, X, Y, Count };
+
+    // What happens to the widget when its tween completes
+    enum FinishAction : uint8_t {
+        FinishNone = 0,
+        FinishHide = 1,
+        FinishDestroy = 2
+    };
+
+    struct Stats {
+        uint32_t active{0};
+        uint32_t applied{0};        // Property writes in the last update
+    };
+
+    // Tween a property from its current value. A running tween of the same
+    // widget and property is replaced.
+    void animate(const UIWidgetPtr& widget, Property property, float to, float duration,
+                 Easing easing = Easing::OutCubic, uint8_t finish = FinishNone);
+    void animate(const UIWidgetPtr& widget, Property property, float from, float to, float duration,
+                 Easing easing = Easing::OutCubic, uint8_t finish = FinishNone);
+
+    void stop(const UIWidget* widget);
+    void clear();
+
+    void update(float deltaTime);
+
+    bool isAnimating() const { return m_stats.active > 0; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct Tween {
+        UIWidget* widget;           // Valid while owner has not expired
+        float from;
+        float to;
+        float elapsed;
+        float duration;
+        Easing easing;
+        uint8_t finish;
+    };
+
+    struct Track {
+        std::vector<Tween> tweens;
+        std::vector<std::weak_ptr<UIWidget>> owners;   // Parallel to tweens
+    };
+
+    static float readProperty(const UIWidget& widget, Property property);
+    void updateTrack(Property property, float deltaTime);
+    void removeAt(Track& track, size_t index);
+
+    std::array<Track, static_cast<size_t>(Property::Count)> m_tracks;
+
+    struct Finished {
+        std::weak_ptr<UIWidget> widget;
+        uint8_t finish;
+    };
+    std::vector<Finished> m_finished;
+    Stats m_stats;
+};
+
+} // namespace framework
+} // namespace shadow
@@ -16,6 +16,7 @@ UIButton::UIButton() : UIWidget() {
 void UIButton::setIcon(const std::string& iconPath) {
     extern ResourceManager& g_resources;
     m_icon = g_resources.loadTexture(iconPath);
+    invalidate();
 }
 
 void UIButton::drawSelf() {
@@ -16,21 +16,21 @@ class UIButton : public UIWidget {
 public:
     UIButton();
 
-    void setText(const std::string& text) { m_text = text; }
+    void setText(const std::string& text) { m_text = text; invalidate(); }
     const std::string& getText() const { return m_text; }
 
     void setIcon(const std::string& iconPath);
 
     // States
-    void setNormalColor(const Color& color) { m_normalColor = color; }
-    void setHoverColor(const Color& color) { m_hoverColor = color; }
-    void setPressedColor(const Color& color) { m_pressedColor = color; }
-    void setDisabledColor(const Color& color) { m_disabledColor = color; }
-
-    void setTextColor(const Color& color) { m_textColor = color; }
-    void setTextColorHover(const Color& color) { m_textColorHover = color; }
-    void setTextColorPressed(const Color& color) { m_textColorPressed = color; }
-    void setTextColorDisabled(const Color& color) { m_textColorDisabled = color; }
+    void setNormalColor(const Color& color) { m_normalColor = color; invalidate(); }
+    void setHoverColor(const Color& color) { m_hoverColor = color; invalidate(); }
+    void setPressedColor(const Color& color) { m_pressedColor = color; invalidate(); }
+    void setDisabledColor(const Color& color) { m_disabledColor = color; invalidate(); }
+
+    void setTextColor(const Color& color) { m_textColor = color; invalidate(); }
+    void setTextColorHover(const Color& color) { m_textColorHover = color; invalidate(); }
+    void setTextColorPressed(const Color& color) { m_textColorPressed = color; invalidate(); }
+    void setTextColorDisabled(const Color& color) { m_textColorDisabled = color; invalidate(); }
 
     void drawSelf() override;
 
@@ -26,6 +26,7 @@ void UIComboBox::addOption(const std::string& text, std::any data) {
     if (m_currentIndex < 0) {
         m_currentIndex = 0;
     }
+    invalidate();
 }
 
 void UIComboBox::removeOption(int index) {
@@ -34,18 +35,21 @@ void UIComboBox::removeOption(int index) {
         if (m_currentIndex >= static_cast<int>(m_options.size())) {
             m_currentIndex = static_cast<int>(m_options.size()) - 1;
         }
+        invalidate();
     }
 }
 
 void UIComboBox::clearOptions() {
     m_options.clear();
     m_currentIndex = -1;
+    invalidate();
 }
 
 void UIComboBox::setCurrentIndex(int index) {
     if (index >= -1 && index < static_cast<int>(m_options.size())) {
         if (m_currentIndex != index) {
             m_currentIndex = index;
+            invalidate();
             if (m_onOptionChange && m_currentIndex >= 0) {
                 m_onOptionChange(m_currentIndex, m_options[m_currentIndex]);
             }
@@ -74,11 +78,21 @@ void UIComboBox::openDropdown() {
     if (m_options.empty()) return;
     m_dropdownOpen = true;
     m_hoveredOption = m_currentIndex;
+    invalidate();
 }
 
 void UIComboBox::closeDropdown() {
     m_dropdownOpen = false;
     m_hoveredOption = -1;
+    invalidate();
+}
+
+Rect UIComboBox::getDrawRect() const {
+    Rect rect = getAbsoluteRect();
+    if (m_dropdownOpen && !m_options.empty()) {
+        rect.height += std::min(m_maxVisibleOptions, static_cast<int>(m_options.size())) * 22;
+    }
+    return rect;
 }
 
 void UIComboBox::drawSelf() {
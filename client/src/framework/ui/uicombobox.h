@@ -46,6 +46,7 @@ public:
     void setOnOptionChange(OptionChangeCallback cb) { m_onOptionChange = cb; }
 
     void drawSelf() override;
+    Rect getDrawRect() const override;
 
     bool onMouseDown(int x, int y, int button) override;
     bool onKeyDown(int keyCode, int modifiers) override;
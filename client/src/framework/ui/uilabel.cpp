@@ -13,6 +13,7 @@ UILabel::UILabel() : UIWidget() {
 
 void UILabel::setText(const std::string& text) {
     m_text = text;
+    invalidate();
 
     if (m_autoResize) {
         // Calculate text size and resize widget
@@ -25,6 +26,7 @@ void UILabel::setText(const std::string& text) {
 
 void UILabel::setFont(const std::string& fontName) {
     m_fontName = fontName;
+    invalidate();
 }
 
 void UILabel::drawSelf() {
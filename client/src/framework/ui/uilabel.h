@@ -20,16 +20,16 @@ public:
     const std::string& getText() const { return m_text; }
 
     void setFont(const std::string& fontName);
-    void setFontSize(int size) { m_fontSize = size; }
-    void setColor(const Color& color) { m_textColor = color; }
-    void setColor(const std::string& hex) { m_textColor = Color::fromHex(hex); }
+    void setFontSize(int size) { m_fontSize = size; invalidate(); }
+    void setColor(const Color& color) { m_textColor = color; invalidate(); }
+    void setColor(const std::string& hex) { m_textColor = Color::fromHex(hex); invalidate(); }
 
     enum class Align { Left, Center, Right };
     enum class VAlign { Top, Middle, Bottom };
-    void setTextAlign(Align align) { m_textAlign = align; }
-    void setTextVAlign(VAlign align) { m_textVAlign = align; }
+    void setTextAlign(Align align) { m_textAlign = align; invalidate(); }
+    void setTextVAlign(VAlign align) { m_textVAlign = align; invalidate(); }
 
-    void setTextWrap(bool wrap) { m_textWrap = wrap; }
+    void setTextWrap(bool wrap) { m_textWrap = wrap; invalidate(); }
     bool isTextWrap() const { return m_textWrap; }
 
     void setTextAutoResize(bool autoResize) { m_autoResize = autoResize; }
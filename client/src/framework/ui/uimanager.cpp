@@ -10,15 +10,49 @@
 #include "uiscrollarea.h"
 #include "uiprogressbar.h"
 #include "uicombobox.h"
+#include <framework/core/profiler.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/graphics/graphics.h>
+#include <framework/input/inputmanager.h>
 #include <framework/platform/platform.h>
-#include <sstream>
 #include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+namespace fs = std::filesystem;
 
 namespace shadow {
 namespace framework {
 
+namespace {
+
+// Union of what the visible subtree paints
+void addDrawRects(const UIWidget& widget, int& left, int& top, int& right, int& bottom) {
+    Rect rect = widget.getDrawRect();
+    if (rect.width > 0 && rect.height > 0) {
+        left = std::min(left, rect.x);
+        top = std::min(top, rect.y);
+        right = std::max(right, rect.x + rect.width);
+        bottom = std::max(bottom, rect.y + rect.height);
+    }
+    for (const auto& child : widget.getChildren()) {
+        if (child->isVisible()) {
+            addDrawRects(*child, left, top, right, bottom);
+        }
+    }
+}
+
+// Step past a template node and its subtree
+void skipNode(const std::vector<UITemplate::Node>& nodes, size_t& index) {
+    if (index >= nodes.size()) return;
+    uint32_t children = nodes[index++].childCount;
+    for (uint32_t i = 0; i < children; ++i) {
+        skipNode(nodes, index);
+    }
+}
+
+} // anonymous namespace
+
 UIManager& UIManager::instance() {
     static UIManager instance;
     return instance;
@@ -28,6 +62,7 @@ bool UIManager::init() {
     // Create root widget
     m_rootWidget = std::make_shared<UIWidget>();
     m_rootWidget->setId("root");
+    m_rootWidget->setRoot(true);
 
     // Register built-in widget types
     registerWidgetType("UIWidget", []() { return std::make_shared<UIWidget>(); });
@@ -54,7 +89,9 @@ bool UIManager::init() {
 }
 
 void UIManager::terminate() {
-    m_animations.clear();
+    m_layers.clear();
+    m_layerStats = LayerStats{};
+    m_animator.clear();
     m_modalStack.clear();
     m_focusedWidget = nullptr;
     m_hoveredWidget = nullptr;
@@ -71,28 +108,150 @@ UIWidgetPtr UIManager::displayUI(const std::string& name) {
 }
 
 UIWidgetPtr UIManager::loadUI(const std::string& filename) {
-    extern ResourceManager& g_resources;
-    std::string content = g_resources.readFileText(filename);
-
-    if (content.empty()) {
+    auto tmpl = getTemplate(filename);
+    if (!tmpl) {
         return nullptr;
     }
 
-    return loadUIFromString(content);
+    size_t index = 0;
+    auto widget = instantiate(*tmpl, index, nullptr);
+    if (widget) {
+        m_rootWidget->addChild(widget);
+    }
+    return widget;
 }
 
 UIWidgetPtr UIManager::loadUIFromString(const std::string& otui) {
-    auto container = std::make_shared<UIWidget>();
-    parseOTUI(otui, container);
+    auto tmpl = compileTemplate(otui);
+    if (!tmpl) {
+        return nullptr;
+    }
 
-    if (!container->getChildren().empty()) {
-        auto widget = container->getChildByIndex(0);
-        container->removeChild(widget);
+    size_t index = 0;
+    auto widget = instantiate(*tmpl, index, nullptr);
+    if (widget) {
         m_rootWidget->addChild(widget);
-        return widget;
     }
+    return widget;
+}
+
+void UIManager::clearTemplateCache() {
+    m_templates.clear();
+    m_templateStamp = 0;
+}
 
-    return nullptr;
+std::shared_ptr<const UITemplate> UIManager::compileTemplate(const std::string& otui) const {
+    auto isKnownType = [this](const std::string& type) { return m_widgetFactories.count(type) > 0; };
+    return UITemplate::compile(otui, isKnownType, m_styles);
+}
+
+std::shared_ptr<const UITemplate> UIManager::getTemplate(const std::string& filename) {
+    extern ResourceManager& g_resources;
+    std::string path = g_resources.resolvePath(filename);
+    if (path.empty()) {
+        return nullptr;
+    }
+
+    UITemplate::Source source;
+    bool hasSource = UITemplate::getSource(path, source);
+
+    auto it = m_templates.find(path);
+    if (it != m_templates.end() && hasSource && it->second.source.size == source.size &&
+        it->second.source.mtime == source.mtime) {
+        m_templateStats.hits++;
+        return it->second.tmpl;
+    }
+
+    // The path hash keeps same-named files of different modules apart
+    std::string cachePath;
+    if (!m_templateCacheDirectory.empty() && hasSource) {
+        fs::path otuiPath(path);
+        char suffix[17];
+        std::snprintf(suffix, sizeof(suffix), "%016zx", std::hash<std::string>{}(otuiPath.lexically_normal().string()));
+        cachePath = (fs::path(m_templateCacheDirectory) / (otuiPath.stem().string() + "-" + suffix + ".otuic")).string();
+    }
+
+    std::shared_ptr<const UITemplate> tmpl;
+    if (!cachePath.empty()) {
+        tmpl = UITemplate::load(cachePath, source, getTemplateStamp());
+        if (tmpl) {
+            m_templateStats.loadedFromDisk++;
+        }
+    }
+
+    if (!tmpl) {
+        std::string content = g_resources.readFileText(filename);
+        if (content.empty()) {
+            return nullptr;
+        }
+        tmpl = compileTemplate(content);
+        if (!tmpl) {
+            return nullptr;
+        }
+        m_templateStats.compiled++;
+        if (!cachePath.empty()) {
+            tmpl->save(cachePath, source, getTemplateStamp());
+        }
+    }
+
+    if (hasSource) {
+        m_templates[path] = CachedTemplate{tmpl, source};
+    }
+    return tmpl;
+}
+
+uint64_t UIManager::getTemplateStamp() {
+    if (m_templateStamp != 0) {
+        return m_templateStamp;
+    }
+
+    // Templates bake in the styles and which widget types exist
+    std::string key;
+    for (const auto& [type, factory] : m_widgetFactories) {
+        key += type;
+        key += '\n';
+    }
+    for (const auto& [type, properties] : m_styles) {
+        for (const auto& [property, value] : properties) {
+            key += type + '\0' + property + '\0' + value + '\n';
+        }
+    }
+    m_templateStamp = std::hash<std::string>{}(key) | 1;
+    return m_templateStamp;
+}
+
+UIWidgetPtr UIManager::instantiate(const UITemplate& tmpl, size_t& index, const UIWidgetPtr& parent) {
+    const auto& nodes = tmpl.getNodes();
+    if (index >= nodes.size()) {
+        return nullptr;
+    }
+
+    const UITemplate::Node& node = nodes[index++];
+    UIWidgetPtr widget;
+    auto factory = m_widgetFactories.find(node.type);
+    if (factory != m_widgetFactories.end()) {
+        widget = factory->second();
+    }
+
+    if (widget) {
+        if (parent) {
+            parent->addChild(widget);
+        }
+        const auto& properties = tmpl.getProperties();
+        for (uint32_t i = 0; i < node.propertyCount; ++i) {
+            applyProperty(widget, properties[node.firstProperty + i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < node.childCount; ++i) {
+        if (widget) {
+            instantiate(tmpl, index, widget);
+        } else {
+            // A type unregistered since compiling takes its subtree along
+            skipNode(nodes, index);
+        }
+    }
+    return widget;
 }
 
 UIWidgetPtr UIManager::createWidget(const std::string& type, UIWidgetPtr parent) {
@@ -112,8 +271,62 @@ UIWidgetPtr UIManager::createWidget(const std::string& type, UIWidgetPtr parent)
     return widget;
 }
 
+void UIManager::applyProperty(const UIWidgetPtr& widget, const UITemplate::PropertyValue& property) {
+    using P = UITemplate::Property;
+    switch (property.key) {
+        case P::Id: widget->setId(property.text); break;
+        case P::Visible: widget->setVisible(property.number != 0); break;
+        case P::Enabled: widget->setEnabled(property.number != 0); break;
+        case P::Width: widget->setWidth(property.number); break;
+        case P::Height: widget->setHeight(property.number); break;
+        case P::X: widget->setX(property.number); break;
+        case P::Y: widget->setY(property.number); break;
+        case P::BackgroundColor: widget->setBackgroundColor(property.color); break;
+        case P::BorderColor: widget->setBorderColor(property.color); break;
+        case P::BorderWidth: widget->setBorderWidth(property.number); break;
+        case P::Opacity: widget->setOpacity(property.real); break;
+        case P::Margin:
+            widget->setMargin(property.number, property.number, property.number, property.number);
+            break;
+        case P::Padding:
+            widget->setPadding(property.number, property.number, property.number, property.number);
+            break;
+
+        case P::Text:
+            if (auto label = dynamic_cast<UILabel*>(widget.get())) {
+                label->setText(property.text);
+            } else if (auto button = dynamic_cast<UIButton*>(widget.get())) {
+                button->setText(property.text);
+            }
+            break;
+        case P::Color:
+            if (auto label = dynamic_cast<UILabel*>(widget.get())) {
+                label->setColor(property.color);
+            }
+            break;
+        case P::Font:
+            if (auto label = dynamic_cast<UILabel*>(widget.get())) {
+                label->setFont(property.text);
+            }
+            break;
+
+        case P::Title:
+        case P::Draggable:
+        case P::Resizable:
+        case P::Closeable:
+            if (auto window = dynamic_cast<UIWindow*>(widget.get())) {
+                if (property.key == P::Title) window->setTitle(property.text);
+                else if (property.key == P::Draggable) window->setDraggable(property.number != 0);
+                else if (property.key == P::Resizable) window->setResizable(property.number != 0);
+                else window->setCloseable(property.number != 0);
+            }
+            break;
+    }
+}
+
 void UIManager::registerWidgetType(const std::string& type, std::function<UIWidgetPtr()> factory) {
     m_widgetFactories[type] = factory;
+    clearTemplateCache();
 }
 
 void UIManager::setFocusedWidget(UIWidgetPtr widget) {
@@ -159,16 +372,43 @@ UIWidgetPtr UIManager::getTopModal() const {
 void UIManager::draw() {
     if (!m_rootWidget) return;
 
+    ProfileScope scope(Profiler::StageUI, true);
+
     // Update animations
     static double lastTime = 0;
     double currentTime = g_platform.getTime();
-    float deltaTime = static_cast<float>(currentTime - lastTime);
+    float deltaTime = lastTime > 0 ? static_cast<float>(currentTime - lastTime) : 0.0f;
     lastTime = currentTime;
 
-    processAnimations(deltaTime);
+    m_animator.update(deltaTime);
 
     // Draw all widgets
-    m_rootWidget->draw();
+    if (!m_retainedRendering) {
+        m_rootWidget->draw();
+    } else if (m_rootWidget->isVisible() && m_rootWidget->getOpacity() > 0.0f) {
+        m_layerFrame++;
+        m_layerStats.repainted = 0;
+
+        m_rootWidget->drawSelf();
+        for (const auto& child : m_rootWidget->getChildren()) {
+            drawLayer(child);
+        }
+
+        // Closed and destroyed windows release their targets
+        m_layerStats.textureBytes = 0;
+        for (auto it = m_layers.begin(); it != m_layers.end();) {
+            if (it->second.lastFrame != m_layerFrame) {
+                it = m_layers.erase(it);
+                continue;
+            }
+            if (it->second.target) {
+                m_layerStats.textureBytes += static_cast<uint64_t>(it->second.target->getWidth()) *
+                                             it->second.target->getHeight() * 4;
+            }
+            ++it;
+        }
+        m_layerStats.layers = static_cast<uint32_t>(m_layers.size());
+    }
 
     // Draw tooltip
     if (m_tooltipWidget && m_tooltipWidget->isVisible()) {
@@ -182,30 +422,107 @@ void UIManager::draw() {
     }
 }
 
+void UIManager::setRetainedRendering(bool enabled) {
+    if (m_retainedRendering == enabled) return;
+    m_retainedRendering = enabled;
+    m_layers.clear();
+    m_layerStats = LayerStats{};
+}
+
+void UIManager::drawLayer(const UIWidgetPtr& widget) {
+    if (!widget->isVisible() || widget->getOpacity() <= 0.0f) return;
+
+    Layer& layer = m_layers[widget.get()];
+    if (layer.widget.lock() != widget) {
+        layer = Layer{};
+        layer.widget = widget;
+    }
+    layer.lastFrame = m_layerFrame;
+
+    if (widget->isLayerDirty() || !layer.target) {
+        int left = INT32_MAX, top = INT32_MAX, right = INT32_MIN, bottom = INT32_MIN;
+        addDrawRects(*widget, left, top, right, bottom);
+        widget->clearLayerDirty();
+
+        if (right <= left || bottom <= top) {
+            layer.target.reset();
+            return;
+        }
+
+        int maxSize = g_graphics.getMaxTextureSize();
+        layer.bounds = Rect(left, top, std::min(right - left, maxSize), std::min(bottom - top, maxSize));
+        if (!layer.target || layer.target->getWidth() != layer.bounds.width ||
+            layer.target->getHeight() != layer.bounds.height) {
+            layer.target = g_graphics.createRenderTarget(layer.bounds.width, layer.bounds.height, false);
+            if (!layer.target) {
+                // No offscreen support; draw this window directly
+                widget->draw();
+                return;
+            }
+        }
+
+        g_graphics.beginRenderTarget(layer.target.get(), Point(layer.bounds.x, layer.bounds.y));
+        g_graphics.clear(Color::transparent());
+        widget->draw();
+        g_graphics.endRenderTarget();
+        m_layerStats.repainted++;
+    }
+
+    if (!layer.target) return;
+
+    g_graphics.setBlendMode(BlendPremultiplied);
+    g_graphics.drawRenderTarget(layer.target.get(), Rect(0, 0, layer.bounds.width, layer.bounds.height), layer.bounds);
+    g_graphics.setBlendMode(BlendNormal);
+}
+
+void UIManager::invalidateLayers() {
+    // Input can change any state a widget draws from; repaint the windows
+    // it was routed to
+    for (const UIWidgetPtr* widget : {&m_focusedWidget, &m_hoveredWidget, &m_pressedWidget}) {
+        if (*widget) {
+            (*widget)->invalidate();
+        }
+    }
+}
+
 bool UIManager::onKeyDown(int keyCode, int modifiers) {
+    // Ctrl+F12 toggles the frame profiler overlay from anywhere
+    if (keyCode == static_cast<int>(KeyCode::F12) && (modifiers & static_cast<int>(KeyModifier::Ctrl))) {
+        g_profiler.toggleOverlay();
+        return true;
+    }
+
     if (m_focusedWidget) {
-        return m_focusedWidget->onKeyDown(keyCode, modifiers);
+        bool handled = m_focusedWidget->onKeyDown(keyCode, modifiers);
+        invalidateLayers();
+        return handled;
     }
     return false;
 }
 
 bool UIManager::onKeyUp(int keyCode, int modifiers) {
     if (m_focusedWidget) {
-        return m_focusedWidget->onKeyUp(keyCode, modifiers);
+        bool handled = m_focusedWidget->onKeyUp(keyCode, modifiers);
+        invalidateLayers();
+        return handled;
     }
     return false;
 }
 
 bool UIManager::onKeyPress(int keyCode, int modifiers) {
     if (m_focusedWidget) {
-        return m_focusedWidget->onKeyPress(keyCode, modifiers);
+        bool handled = m_focusedWidget->onKeyPress(keyCode, modifiers);
+        invalidateLayers();
+        return handled;
     }
     return false;
 }
 
 bool UIManager::onTextInput(const std::string& text) {
     if (m_focusedWidget) {
-        return m_focusedWidget->onTextInput(text);
+        bool handled = m_focusedWidget->onTextInput(text);
+        invalidateLayers();
+        return handled;
     }
     return false;
 }
@@ -219,14 +536,18 @@ bool UIManager::onMouseDown(int x, int y, int button) {
             // Click outside modal - ignore or close based on settings
             return true;
         }
-        return modal->onMouseDown(x, y, button);
+        bool handled = modal->onMouseDown(x, y, button);
+        modal->invalidate();
+        return handled;
     }
 
     // Find widget at position
     if (m_rootWidget) {
         if (auto widget = m_rootWidget->getChildByPos(x, y)) {
             m_pressedWidget = widget;
-            return widget->onMouseDown(x, y, button);
+            bool handled = widget->onMouseDown(x, y, button);
+            invalidateLayers();
+            return handled;
         }
     }
 
@@ -237,13 +558,16 @@ bool UIManager::onMouseDown(int x, int y, int button) {
 bool UIManager::onMouseUp(int x, int y, int button) {
     if (m_pressedWidget) {
         bool result = m_pressedWidget->onMouseUp(x, y, button);
+        invalidateLayers();
         m_pressedWidget = nullptr;
         return result;
     }
 
     if (m_rootWidget) {
         if (auto widget = m_rootWidget->getChildByPos(x, y)) {
-            return widget->onMouseUp(x, y, button);
+            bool handled = widget->onMouseUp(x, y, button);
+            widget->invalidate();
+            return handled;
         }
     }
 
@@ -261,10 +585,12 @@ bool UIManager::onMouseMove(int x, int y) {
     if (m_hoveredWidget != newHovered) {
         if (m_hoveredWidget) {
             m_hoveredWidget->onMouseLeave();
+            m_hoveredWidget->invalidate();
         }
         m_hoveredWidget = newHovered;
         if (m_hoveredWidget) {
             m_hoveredWidget->onMouseEnter();
+            m_hoveredWidget->invalidate();
         }
     }
 
@@ -279,7 +605,9 @@ bool UIManager::onMouseMove(int x, int y) {
 bool UIManager::onMouseWheel(int x, int y, int delta) {
     if (m_rootWidget) {
         if (auto widget = m_rootWidget->getChildByPos(x, y)) {
-            return widget->onMouseWheel(x, y, delta);
+            bool handled = widget->onMouseWheel(x, y, delta);
+            widget->invalidate();
+            return handled;
         }
     }
     return false;
@@ -345,10 +673,25 @@ void UIManager::loadStyle(const std::string& filename) {
     }
 }
 
+size_t UIManager::loadStyles(const std::string& directory) {
+    extern ResourceManager& g_resources;
+    std::vector<std::string> files = g_resources.listDirectory(directory);
+    std::sort(files.begin(), files.end());
+
+    size_t loaded = 0;
+    for (const std::string& file : files) {
+        if (fs::path(file).extension() != ".otui") continue;
+        loadStyle(directory + "/" + file);
+        loaded++;
+    }
+    return loaded;
+}
+
 void UIManager::setStyleProperty(const std::string& widgetType,
                                   const std::string& property,
                                   const std::string& value) {
     m_styles[widgetType][property] = value;
+    clearTemplateCache();
 }
 
 void UIManager::setCursor(const std::string& cursor) {
@@ -391,211 +734,21 @@ void UIManager::fadeIn(UIWidgetPtr widget, float duration) {
 
     widget->setOpacity(0.0f);
     widget->show();
-
-    Animation anim;
-    anim.widget = widget;
-    anim.type = Animation::FadeIn;
-    anim.duration = duration;
-    anim.elapsed = 0;
-    anim.startValue = 0.0f;
-    anim.endValue = 1.0f;
-
-    m_animations.push_back(anim);
+    m_animator.animate(widget, UIAnimator::Property::Opacity, 0.0f, 1.0f, duration);
 }
 
 void UIManager::fadeOut(UIWidgetPtr widget, float duration, bool destroyAfter) {
     if (!widget) return;
 
-    Animation anim;
-    anim.widget = widget;
-    anim.type = Animation::FadeOut;
-    anim.duration = duration;
-    anim.elapsed = 0;
-    anim.startValue = widget->getOpacity();
-    anim.endValue = 0.0f;
-    anim.destroyAfter = destroyAfter;
-
-    m_animations.push_back(anim);
+    uint8_t finish = UIAnimator::FinishHide | (destroyAfter ? UIAnimator::FinishDestroy : 0);
+    m_animator.animate(widget, UIAnimator::Property::Opacity, 0.0f, duration, Easing::OutCubic, finish);
 }
 
 void UIManager::moveTo(UIWidgetPtr widget, int x, int y, float duration) {
     if (!widget) return;
 
-    Animation anim;
-    anim.widget = widget;
-    anim.type = Animation::MoveTo;
-    anim.duration = duration;
-    anim.elapsed = 0;
-    anim.startValue = static_cast<float>(widget->getX());
-    anim.endValue = static_cast<float>(widget->getY());
-    anim.targetX = x;
-    anim.targetY = y;
-
-    m_animations.push_back(anim);
-}
-
-void UIManager::processAnimations(float deltaTime) {
-    for (auto it = m_animations.begin(); it != m_animations.end();) {
-        auto& anim = *it;
-        anim.elapsed += deltaTime;
-
-        if (!anim.widget || anim.widget->isDestroyed()) {
-            it = m_animations.erase(it);
-            continue;
-        }
-
-        float t = std::min(anim.elapsed / anim.duration, 1.0f);
-        // Ease out cubic
-        t = 1.0f - (1.0f - t) * (1.0f - t) * (1.0f - t);
-
-        switch (anim.type) {
-            case Animation::FadeIn:
-            case Animation::FadeOut:
-                anim.widget->setOpacity(anim.startValue + (anim.endValue - anim.startValue) * t);
-                break;
-
-            case Animation::MoveTo:
-                {
-                    int startX = static_cast<int>(anim.startValue);
-                    int startY = static_cast<int>(anim.endValue);
-                    int x = startX + static_cast<int>((anim.targetX - startX) * t);
-                    int y = startY + static_cast<int>((anim.targetY - startY) * t);
-                    anim.widget->setPosition(x, y);
-                }
-                break;
-        }
-
-        // Check if animation complete
-        if (anim.elapsed >= anim.duration) {
-            if (anim.type == Animation::FadeOut) {
-                anim.widget->hide();
-                if (anim.destroyAfter) {
-                    anim.widget->destroy();
-                }
-            }
-            it = m_animations.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void UIManager::parseOTUI(const std::string& content, UIWidgetPtr parent) {
-    // Simplified OTUI parser
-    // Real implementation would handle full OTUI syntax
-
-    std::istringstream stream(content);
-    std::string line;
-    UIWidgetPtr currentWidget = parent;
-    std::vector<UIWidgetPtr> widgetStack;
-    widgetStack.push_back(parent);
-
-    int indentLevel = 0;
-
-    while (std::getline(stream, line)) {
-        // Skip empty lines and comments
-        size_t firstNonSpace = line.find_first_not_of(" \t");
-        if (firstNonSpace == std::string::npos) continue;
-        if (line[firstNonSpace] == '/' || line[firstNonSpace] == '#') continue;
-
-        // Calculate indent
-        int currentIndent = static_cast<int>(firstNonSpace) / 2;
-
-        // Trim line
-        line = line.substr(firstNonSpace);
-        size_t lastNonSpace = line.find_last_not_of(" \t\r\n");
-        if (lastNonSpace != std::string::npos) {
-            line = line.substr(0, lastNonSpace + 1);
-        }
-
-        // Handle indent changes
-        while (currentIndent < static_cast<int>(widgetStack.size()) - 1 && widgetStack.size() > 1) {
-            widgetStack.pop_back();
-        }
-
-        // Check for widget type declaration
-        size_t colonPos = line.find(':');
-        if (colonPos == std::string::npos && line.find(' ') == std::string::npos) {
-            // Widget type (e.g., "Button")
-            auto widget = createWidget(line, nullptr);
-            if (widget) {
-                widgetStack.back()->addChild(widget);
-                widgetStack.push_back(widget);
-            }
-        } else if (colonPos != std::string::npos) {
-            // Property assignment
-            std::string property = line.substr(0, colonPos);
-            std::string value = line.substr(colonPos + 1);
-
-            // Trim
-            property.erase(property.find_last_not_of(" \t") + 1);
-            value.erase(0, value.find_first_not_of(" \t"));
-
-            // Apply property to current widget
-            if (!widgetStack.empty() && widgetStack.back()) {
-                auto widget = widgetStack.back();
-
-                // Common properties
-                if (property == "id") {
-                    widget->setId(value);
-                } else if (property == "visible") {
-                    widget->setVisible(value == "true");
-                } else if (property == "enabled") {
-                    widget->setEnabled(value == "true");
-                } else if (property == "width") {
-                    widget->setWidth(std::stoi(value));
-                } else if (property == "height") {
-                    widget->setHeight(std::stoi(value));
-                } else if (property == "x") {
-                    widget->setX(std::stoi(value));
-                } else if (property == "y") {
-                    widget->setY(std::stoi(value));
-                } else if (property == "background-color" || property == "background") {
-                    widget->setBackgroundColor(value);
-                } else if (property == "border-color") {
-                    widget->setBorderColor(Color::fromHex(value));
-                } else if (property == "border-width") {
-                    widget->setBorderWidth(std::stoi(value));
-                } else if (property == "opacity") {
-                    widget->setOpacity(std::stof(value));
-                } else if (property == "margin") {
-                    int m = std::stoi(value);
-                    widget->setMargin(m, m, m, m);
-                } else if (property == "padding") {
-                    int p = std::stoi(value);
-                    widget->setPadding(p, p, p, p);
-                }
-                // Label-specific
-                else if (auto label = std::dynamic_pointer_cast<UILabel>(widget)) {
-                    if (property == "text") {
-                        label->setText(value);
-                    } else if (property == "color" || property == "text-color") {
-                        label->setColor(value);
-                    } else if (property == "font") {
-                        label->setFont(value);
-                    }
-                }
-                // Button-specific
-                else if (auto button = std::dynamic_pointer_cast<UIButton>(widget)) {
-                    if (property == "text") {
-                        button->setText(value);
-                    }
-                }
-                // Window-specific
-                else if (auto window = std::dynamic_pointer_cast<UIWindow>(widget)) {
-                    if (property == "title") {
-                        window->setTitle(value);
-                    } else if (property == "draggable") {
-                        window->setDraggable(value == "true");
-                    } else if (property == "resizable") {
-                        window->setResizable(value == "true");
-                    } else if (property == "closeable") {
-                        window->setCloseable(value == "true");
-                    }
-                }
-            }
-        }
-    }
+    m_animator.animate(widget, UIAnimator::Property::X, static_cast<float>(x), duration);
+    m_animator.animate(widget, UIAnimator::Property::Y, static_cast<float>(y), duration);
 }
 
 } // namespace framework
@@ -11,8 +11,11 @@
 #include <map>
 #include <vector>
 #include <functional>
+#include <unordered_map>
 
 #include "uiwidget.h"
+#include "uianimation.h"
+#include "uitemplate.h"
 
 namespace shadow {
 namespace framework {
@@ -24,11 +27,26 @@ public:
     bool init();
     void terminate();
 
-    // Display UI from file
+    // Display UI from file. Files are compiled into templates once and
+    // recompiled when they change on disk; widgets are instantiated from
+    // the template.
     UIWidgetPtr displayUI(const std::string& name);
     UIWidgetPtr loadUI(const std::string& filename);
     UIWidgetPtr loadUIFromString(const std::string& otui);
 
+    // With a directory set, compiled templates are also kept on disk so
+    // later launches skip the parse
+    void setTemplateCacheDirectory(const std::string& directory) { m_templateCacheDirectory = directory; }
+    const std::string& getTemplateCacheDirectory() const { return m_templateCacheDirectory; }
+    void clearTemplateCache();
+
+    struct TemplateStats {
+        uint32_t hits{0};
+        uint32_t compiled{0};
+        uint32_t loadedFromDisk{0};
+    };
+    const TemplateStats& getTemplateStats() const { return m_templateStats; }
+
     // Widget creation
     UIWidgetPtr createWidget(const std::string& type, UIWidgetPtr parent = nullptr);
     void registerWidgetType(const std::string& type, std::function<UIWidgetPtr()> factory);
@@ -50,8 +68,19 @@ public:
     UIWidgetPtr getTopModal() const;
     bool hasModal() const { return !m_modalStack.empty(); }
 
-    // Rendering
+    // Rendering. Top-level windows are retained: each is painted into its
+    // own render target and recomposited every frame, repainted only after
+    // something inside it calls UIWidget::invalidate.
     void draw();
+    void setRetainedRendering(bool enabled);
+    bool isRetainedRendering() const { return m_retainedRendering; }
+
+    struct LayerStats {
+        uint32_t layers{0};
+        uint32_t repainted{0};      // Last frame
+        uint64_t textureBytes{0};
+    };
+    const LayerStats& getLayerStats() const { return m_layerStats; }
 
     // Input handling
     bool onKeyDown(int keyCode, int modifiers);
@@ -66,6 +95,9 @@ public:
 
     // Style management
     void loadStyle(const std::string& filename);
+    // Every .otui of a directory, in name order, so numbered files such
+    // as 10-buttons.otui come before the styles built on them
+    size_t loadStyles(const std::string& directory);
     void setStyleProperty(const std::string& widgetType,
                          const std::string& property,
                          const std::string& value);
@@ -82,10 +114,11 @@ public:
     void setDebugDraw(bool enabled) { m_debugDraw = enabled; }
     bool isDebugDraw() const { return m_debugDraw; }
 
-    // Animations
+    // Animations, advanced once per frame by draw
     void fadeIn(UIWidgetPtr widget, float duration);
     void fadeOut(UIWidgetPtr widget, float duration, bool destroyAfter = false);
     void moveTo(UIWidgetPtr widget, int x, int y, float duration);
+    UIAnimator& getAnimator() { return m_animator; }
 
 private:
     UIManager() = default;
@@ -93,8 +126,13 @@ private:
     UIManager(const UIManager&) = delete;
     UIManager& operator=(const UIManager&) = delete;
 
-    void parseOTUI(const std::string& content, UIWidgetPtr parent);
-    void processAnimations(float deltaTime);
+    std::shared_ptr<const UITemplate> compileTemplate(const std::string& otui) const;
+    std::shared_ptr<const UITemplate> getTemplate(const std::string& filename);
+    UIWidgetPtr instantiate(const UITemplate& tmpl, size_t& index, const UIWidgetPtr& parent);
+    void applyProperty(const UIWidgetPtr& widget, const UITemplate::PropertyValue& property);
+    uint64_t getTemplateStamp();
+    void drawLayer(const UIWidgetPtr& widget);
+    void invalidateLayers();
 
     UIWidgetPtr m_rootWidget;
     UIWidgetPtr m_focusedWidget;
@@ -106,19 +144,29 @@ private:
     std::map<std::string, std::function<UIWidgetPtr()>> m_widgetFactories;
     std::map<std::string, std::map<std::string, std::string>> m_styles;
 
+    struct CachedTemplate {
+        std::shared_ptr<const UITemplate> tmpl;
+        UITemplate::Source source;
+    };
+    std::unordered_map<std::string, CachedTemplate> m_templates;
+    std::string m_templateCacheDirectory;
+    uint64_t m_templateStamp{0};            // Styles and widget types; 0 = stale
+    TemplateStats m_templateStats;
+
     bool m_debugDraw{false};
 
-    struct Animation {
-        UIWidgetPtr widget;
-        enum Type { FadeIn, FadeOut, MoveTo } type;
-        float duration;
-        float elapsed{0};
-        float startValue;
-        float endValue;
-        int targetX, targetY;
-        bool destroyAfter{false};
+    struct Layer {
+        std::weak_ptr<UIWidget> widget;     // Guards against address reuse
+        std::shared_ptr<RenderTarget> target;
+        Rect bounds;                        // Absolute; the target's extent
+        uint64_t lastFrame{0};
     };
-    std::vector<Animation> m_animations;
+    std::unordered_map<const UIWidget*, Layer> m_layers;
+    uint64_t m_layerFrame{0};
+    bool m_retainedRendering{true};
+    LayerStats m_layerStats;
+
+    UIAnimator m_animator;
 };
 
 } // namespace framework
@@ -18,11 +18,13 @@ UIProgressBar::UIProgressBar() : UIWidget() {
 
 void UIProgressBar::setValue(int value) {
     m_value = std::clamp(value, m_minimum, m_maximum);
+    invalidate();
 }
 
 void UIProgressBar::setPercent(float percent) {
     percent = std::clamp(percent, 0.0f, 100.0f);
     m_value = m_minimum + static_cast<int>((m_maximum - m_minimum) * percent / 100.0f);
+    invalidate();
 }
 
 float UIProgressBar::getPercent() const {
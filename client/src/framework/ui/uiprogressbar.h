@@ -15,9 +15,9 @@ class UIProgressBar : public UIWidget {
 public:
     UIProgressBar();
 
-    void setMinimum(int min) { m_minimum = min; }
-    void setMaximum(int max) { m_maximum = max; }
-    void setRange(int min, int max) { m_minimum = min; m_maximum = max; }
+    void setMinimum(int min) { m_minimum = min; invalidate(); }
+    void setMaximum(int max) { m_maximum = max; invalidate(); }
+    void setRange(int min, int max) { m_minimum = min; m_maximum = max; invalidate(); }
 
     int getMinimum() const { return m_minimum; }
     int getMaximum() const { return m_maximum; }
@@ -29,13 +29,13 @@ public:
     float getPercent() const;
 
     // Appearance
-    void setForegroundColor(const Color& color) { m_foregroundColor = color; }
+    void setForegroundColor(const Color& color) { m_foregroundColor = color; invalidate(); }
     const Color& getForegroundColor() const { return m_foregroundColor; }
 
-    void setShowText(bool show) { m_showText = show; }
+    void setShowText(bool show) { m_showText = show; invalidate(); }
     bool isShowText() const { return m_showText; }
 
-    void setTextFormat(const std::string& format) { m_textFormat = format; }
+    void setTextFormat(const std::string& format) { m_textFormat = format; invalidate(); }
 
     void drawSelf() override;
 
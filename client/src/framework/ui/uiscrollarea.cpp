@@ -5,6 +5,7 @@
 #include "uiscrollarea.h"
 #include <framework/graphics/graphics.h>
 #include <algorithm>
+#include <cstdint>
 
 namespace shadow {
 namespace framework {
@@ -36,6 +37,7 @@ void UIScrollBar::setValue(int value) {
 }
 
 void UIScrollBar::updateSliderRect() {
+    invalidate();
     Rect absRect = getAbsoluteRect();
     int range = m_maximum - m_minimum;
 
@@ -87,6 +89,7 @@ bool UIScrollBar::onMouseDown(int x, int y, int button) {
     if (m_sliderRect.contains(x, y)) {
         // Start dragging slider
         m_dragging = true;
+        invalidate();
         m_dragOffset = (m_orientation == Orientation::Vertical) ?
                        y - m_sliderRect.y : x - m_sliderRect.x;
     } else {
@@ -113,7 +116,10 @@ bool UIScrollBar::onMouseDown(int x, int y, int button) {
 }
 
 bool UIScrollBar::onMouseUp(int x, int y, int button) {
-    m_dragging = false;
+    if (m_dragging) {
+        m_dragging = false;
+        invalidate();
+    }
     return UIWidget::onMouseUp(x, y, button);
 }
 
@@ -167,6 +173,8 @@ void UIScrollablePanel::setVerticalScrollBar(UIScrollBar* scrollBar) {
     if (scrollBar) {
         scrollBar->setOnValueChange([this](int value) {
             m_scrollY = value;
+            layoutRows();
+            invalidate();
         });
     }
 }
@@ -176,19 +184,26 @@ void UIScrollablePanel::setHorizontalScrollBar(UIScrollBar* scrollBar) {
     if (scrollBar) {
         scrollBar->setOnValueChange([this](int value) {
             m_scrollX = value;
+            invalidate();
         });
     }
 }
 
 void UIScrollablePanel::setScrollX(int x) {
     m_scrollX = x;
+    invalidate();
     if (m_horizontalScrollBar) {
         m_horizontalScrollBar->setValue(x);
     }
 }
 
 void UIScrollablePanel::setScrollY(int y) {
+    if (isVirtual()) {
+        y = std::clamp(y, 0, getMaxScrollY());
+    }
     m_scrollY = y;
+    layoutRows();
+    invalidate();
     if (m_verticalScrollBar) {
         m_verticalScrollBar->setValue(y);
     }
@@ -200,7 +215,9 @@ void UIScrollablePanel::scrollToTop() {
 
 void UIScrollablePanel::scrollToBottom() {
     updateScrollBars();
-    if (m_verticalScrollBar) {
+    if (isVirtual()) {
+        setScrollY(getMaxScrollY());
+    } else if (m_verticalScrollBar) {
         setScrollY(m_verticalScrollBar->getMaximum());
     }
 }
@@ -234,6 +251,123 @@ void UIScrollablePanel::ensureChildVisible(UIWidgetPtr child) {
     }
 }
 
+void UIScrollablePanel::setVirtualList(size_t count, int rowHeight, RowFactory factory, RowBinder binder) {
+    clearVirtualList();
+    destroyChildren();
+
+    m_itemCount = count;
+    m_rowHeight = std::max(rowHeight, 1);
+    m_rowFactory = std::move(factory);
+    m_rowBinder = std::move(binder);
+    m_scrollY = 0;
+    updateScrollBars();
+    layoutRows(true);
+}
+
+void UIScrollablePanel::clearVirtualList() {
+    if (!isVirtual()) return;
+
+    for (VirtualRow& row : m_rows) {
+        removeChild(row.widget);
+    }
+    m_rows.clear();
+    m_itemCount = 0;
+    m_rowHeight = 0;
+    m_rowFactory = nullptr;
+    m_rowBinder = nullptr;
+    m_scrollY = 0;
+    updateScrollBars();
+    invalidate();
+}
+
+void UIScrollablePanel::setItemCount(size_t count) {
+    if (!isVirtual()) return;
+
+    m_itemCount = count;
+    updateScrollBars();
+    int maxScroll = getMaxScrollY();
+    if (m_scrollY > maxScroll) {
+        setScrollY(maxScroll);
+    } else {
+        layoutRows();
+    }
+}
+
+void UIScrollablePanel::refreshRows() {
+    layoutRows(true);
+}
+
+void UIScrollablePanel::scrollToIndex(size_t index) {
+    if (!isVirtual()) return;
+    index = std::min(index, m_itemCount);
+    setScrollY(static_cast<int>(std::min<size_t>(index * m_rowHeight, static_cast<size_t>(getMaxScrollY()))));
+}
+
+size_t UIScrollablePanel::getRowIndex(const UIWidget* row) const {
+    for (const VirtualRow& slot : m_rows) {
+        if (slot.widget.get() == row) return slot.index;
+    }
+    return NO_ROW;
+}
+
+int UIScrollablePanel::getMaxScrollY() const {
+    if (!isVirtual()) {
+        return m_verticalScrollBar ? m_verticalScrollBar->getMaximum() : m_scrollY;
+    }
+    int64_t content = static_cast<int64_t>(m_itemCount) * m_rowHeight;
+    return static_cast<int>(std::clamp<int64_t>(content - getViewHeight(), 0, INT32_MAX));
+}
+
+void UIScrollablePanel::layoutRows(bool rebind) {
+    if (!isVirtual()) return;
+
+    int viewHeight = std::max(getViewHeight(), 0);
+    size_t first = static_cast<size_t>(std::max(m_scrollY, 0) / m_rowHeight);
+    size_t end = static_cast<size_t>((std::max(m_scrollY, 0) + viewHeight + m_rowHeight - 1) / m_rowHeight);
+    first = first > static_cast<size_t>(VIRTUAL_MARGIN_ROWS) ? first - VIRTUAL_MARGIN_ROWS : 0;
+    end = std::min(end + VIRTUAL_MARGIN_ROWS, m_itemCount);
+
+    // Enough rows for any scroll position at this view height; growing
+    // the pool moves rows to other slots, so they are all bound again
+    size_t poolSize = std::min(static_cast<size_t>(viewHeight / m_rowHeight + 2 + 2 * VIRTUAL_MARGIN_ROWS), m_itemCount);
+    if (m_rows.size() < poolSize && m_rowFactory) {
+        while (m_rows.size() < poolSize) {
+            UIWidgetPtr widget = m_rowFactory();
+            if (!widget) break;
+            addChild(widget);
+            m_rows.push_back(VirtualRow{widget, NO_ROW});
+        }
+        rebind = true;
+    }
+    if (m_rows.empty()) return;
+
+    int width = getViewWidth();
+    for (size_t index = first; index < end; ++index) {
+        size_t slot = index % m_rows.size();
+        VirtualRow& row = m_rows[slot];
+
+        if (rebind || row.index != index) {
+            row.index = index;
+            if (m_rowBinder) m_rowBinder(row.widget, index);
+        }
+
+        Rect rect(0, static_cast<int>(static_cast<int64_t>(index) * m_rowHeight - m_scrollY), width, m_rowHeight);
+        const Rect& current = row.widget->getRect();
+        if (current.x != rect.x || current.y != rect.y || current.width != rect.width || current.height != rect.height) {
+            row.widget->setRect(rect);
+        }
+        row.widget->setVisible(true);
+    }
+
+    // A row still holding an index in range was bound above
+    for (VirtualRow& row : m_rows) {
+        if (row.index != NO_ROW && row.index >= first && row.index < end) continue;
+        row.index = NO_ROW;
+        row.widget->setVisible(false);
+    }
+    invalidate();
+}
+
 void UIScrollablePanel::draw() {
     if (!m_visible || m_opacity <= 0.0f) return;
 
@@ -249,6 +383,13 @@ void UIScrollablePanel::draw() {
 
     g_graphics.pushClipRect(clipRect);
 
+    // Virtual rows are already placed in view coordinates
+    if (isVirtual()) {
+        drawChildren();
+        g_graphics.popClipRect();
+        return;
+    }
+
     // Draw children with scroll offset
     for (auto& child : m_children) {
         if (!child->isVisible()) continue;
@@ -270,11 +411,11 @@ bool UIScrollablePanel::onMouseWheel(int x, int y, int delta) {
     Rect absRect = getAbsoluteRect();
     if (!absRect.contains(x, y)) return false;
 
-    // Scroll vertically
-    setScrollY(m_scrollY - delta * 20);
+    // Scroll vertically, a row at a time for virtual lists
+    setScrollY(m_scrollY - delta * (isVirtual() ? m_rowHeight : 20));
 
     // Clamp scroll
-    if (m_verticalScrollBar) {
+    if (m_verticalScrollBar && !isVirtual()) {
         m_scrollY = std::clamp(m_scrollY, 0, m_verticalScrollBar->getMaximum());
         m_verticalScrollBar->setValue(m_scrollY);
     }
@@ -285,6 +426,7 @@ bool UIScrollablePanel::onMouseWheel(int x, int y, int delta) {
 void UIScrollablePanel::updateGeometry() {
     UIWidget::updateGeometry();
     updateScrollBars();
+    layoutRows();
 }
 
 void UIScrollablePanel::updateScrollBars() {
@@ -292,12 +434,16 @@ void UIScrollablePanel::updateScrollBars() {
     int maxY = 0;
     int maxX = 0;
 
-    for (auto& child : m_children) {
-        if (!child->isVisible()) continue;
+    if (isVirtual()) {
+        maxY = static_cast<int>(std::min<int64_t>(static_cast<int64_t>(m_itemCount) * m_rowHeight, INT32_MAX));
+    } else {
+        for (auto& child : m_children) {
+            if (!child->isVisible()) continue;
 
-        Rect childRect = child->getRect();
-        maxY = std::max(maxY, childRect.y + childRect.height);
-        maxX = std::max(maxX, childRect.x + childRect.width);
+            Rect childRect = child->getRect();
+            maxY = std::max(maxY, childRect.y + childRect.height);
+            maxX = std::max(maxX, childRect.x + childRect.width);
+        }
     }
 
     int viewHeight = m_rect.height - m_paddingTop - m_paddingBottom;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "uiwidget.h"
+#include <cstddef>
 
 namespace shadow {
 namespace framework {
@@ -16,7 +17,7 @@ public:
     UIScrollBar();
 
     enum class Orientation { Vertical, Horizontal };
-    void setOrientation(Orientation orientation) { m_orientation = orientation; }
+    void setOrientation(Orientation orientation) { m_orientation = orientation; invalidate(); }
     Orientation getOrientation() const { return m_orientation; }
 
     void setRange(int min, int max);
@@ -84,6 +85,32 @@ public:
 
     void ensureChildVisible(UIWidgetPtr child);
 
+    // Virtualized list: rows of one height come from a data source instead
+    // of being added as children. Only the rows in view plus
+    // VIRTUAL_MARGIN_ROWS on either side exist as widgets; they are placed
+    // in view coordinates and rebound to other indices as the list
+    // scrolls, so the row count costs nothing in layout, drawing or hit
+    // testing. The factory creates a row; the binder fills it for an index.
+    static constexpr int VIRTUAL_MARGIN_ROWS = 2;
+    static constexpr size_t NO_ROW = static_cast<size_t>(-1);
+    using RowFactory = std::function<UIWidgetPtr()>;
+    using RowBinder = std::function<void(const UIWidgetPtr& row, size_t index)>;
+    // Replaces the panel's children with recycled rows
+    void setVirtualList(size_t count, int rowHeight, RowFactory factory, RowBinder binder);
+    void clearVirtualList();
+    bool isVirtual() const { return m_rowHeight > 0; }
+
+    // Items appended or dropped; rows showing other indices are rebound
+    void setItemCount(size_t count);
+    size_t getItemCount() const { return m_itemCount; }
+    int getRowHeight() const { return m_rowHeight; }
+    // Items changed in place; every row in view is bound again
+    void refreshRows();
+    // Puts the item at the top of the view, or as near as the end allows
+    void scrollToIndex(size_t index);
+    // Item shown by a row of this panel, or NO_ROW
+    size_t getRowIndex(const UIWidget* row) const;
+
     void draw() override;
     bool onMouseWheel(int x, int y, int delta) override;
 
@@ -92,10 +119,27 @@ protected:
     void updateScrollBars();
 
 private:
+    struct VirtualRow {
+        UIWidgetPtr widget;
+        size_t index{NO_ROW};
+    };
+
+    int getViewHeight() const { return m_rect.height - m_paddingTop - m_paddingBottom; }
+    int getViewWidth() const { return m_rect.width - m_paddingLeft - m_paddingRight; }
+    int getMaxScrollY() const;
+    void layoutRows(bool rebind = false);
+
     UIScrollBar* m_verticalScrollBar{nullptr};
     UIScrollBar* m_horizontalScrollBar{nullptr};
     int m_scrollX{0};
     int m_scrollY{0};
+
+    // Virtual list; rows sit in slot index % m_rows.size()
+    size_t m_itemCount{0};
+    int m_rowHeight{0};
+    RowFactory m_rowFactory;
+    RowBinder m_rowBinder;
+    std::vector<VirtualRow> m_rows;
 };
 
 using ScrollablePanel = UIScrollablePanel;
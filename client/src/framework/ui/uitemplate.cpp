@@ -0,0 +1,354 @@
+/**
+ * Shadow OT Client - UI Templates Implementation
+ */
+
+#include "uitemplate.h"
+#include <framework/core/mappedfile.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace shadow {
+namespace framework {
+
+namespace {
+
+template<typename T>
+void writeLE(uint8_t* out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8));
+    }
+}
+
+template<typename T>
+T readLE(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (i * 8);
+    }
+    return static_cast<T>(value);
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+const std::unordered_map<std::string, UITemplate::Property>& propertyNames() {
+    using P = UITemplate::Property;
+    static const std::unordered_map<std::string, P> names = {
+        {"id", P::Id}, {"visible", P::Visible}, {"enabled", P::Enabled},
+        {"width", P::Width}, {"height", P::Height}, {"x", P::X}, {"y", P::Y},
+        {"background-color", P::BackgroundColor}, {"background", P::BackgroundColor},
+        {"border-color", P::BorderColor}, {"border-width", P::BorderWidth},
+        {"opacity", P::Opacity}, {"margin", P::Margin}, {"padding", P::Padding},
+        {"text", P::Text}, {"color", P::Color}, {"text-color", P::Color}, {"font", P::Font},
+        {"title", P::Title}, {"draggable", P::Draggable}, {"resizable", P::Resizable},
+        {"closeable", P::Closeable}
+    };
+    return names;
+}
+
+bool parseProperty(const std::string& name, const std::string& value, UITemplate::PropertyValue& out) {
+    using P = UITemplate::Property;
+    auto it = propertyNames().find(name);
+    if (it == propertyNames().end()) {
+        return false;
+    }
+
+    out = UITemplate::PropertyValue{};
+    out.key = it->second;
+    try {
+        switch (out.key) {
+            case P::Id: case P::Text: case P::Font: case P::Title:
+                out.text = value;
+                break;
+            case P::Visible: case P::Enabled: case P::Draggable: case P::Resizable: case P::Closeable:
+                out.number = value == "true";
+                break;
+            case P::Width: case P::Height: case P::X: case P::Y:
+            case P::BorderWidth: case P::Margin: case P::Padding:
+                out.number = std::stoi(value);
+                break;
+            case P::Opacity:
+                out.real = std::stof(value);
+                break;
+            case P::BackgroundColor: case P::BorderColor: case P::Color:
+                out.color = Color::fromHex(value);
+                break;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+// Tree built while parsing; properties may follow a widget's children
+struct ParseNode {
+    std::string type;
+    std::vector<UITemplate::PropertyValue> properties;
+    std::vector<size_t> children;
+};
+
+} // anonymous namespace
+
+std::shared_ptr<const UITemplate> UITemplate::compile(const std::string& otui, const TypeFilter& isKnownType,
+                                                      const StyleMap& styles) {
+    // Node 0 stands in for the container the widgets are parsed into
+    std::vector<ParseNode> tree(1);
+    std::vector<size_t> stack{0};
+
+    std::istringstream stream(otui);
+    std::string line;
+    while (std::getline(stream, line)) {
+        // Skip empty lines and comments
+        size_t firstNonSpace = line.find_first_not_of(" \t");
+        if (firstNonSpace == std::string::npos) continue;
+        if (line[firstNonSpace] == '/' || line[firstNonSpace] == '#') continue;
+
+        int indent = static_cast<int>(firstNonSpace) / 2;
+        line = line.substr(firstNonSpace);
+        size_t lastNonSpace = line.find_last_not_of(" \t\r\n");
+        if (lastNonSpace != std::string::npos) {
+            line = line.substr(0, lastNonSpace + 1);
+        }
+
+        while (indent < static_cast<int>(stack.size()) - 1 && stack.size() > 1) {
+            stack.pop_back();
+        }
+
+        size_t colonPos = line.find(':');
+        if (colonPos == std::string::npos && line.find(' ') == std::string::npos) {
+            // Widget type (e.g., "Button")
+            if (!isKnownType(line)) continue;
+
+            size_t index = tree.size();
+            ParseNode node;
+            node.type = line;
+            auto style = styles.find(line);
+            if (style != styles.end()) {
+                for (const auto& [name, value] : style->second) {
+                    PropertyValue property;
+                    if (parseProperty(name, value, property)) {
+                        node.properties.push_back(std::move(property));
+                    }
+                }
+            }
+            tree.push_back(std::move(node));
+            tree[stack.back()].children.push_back(index);
+            stack.push_back(index);
+        } else if (colonPos != std::string::npos && stack.back() != 0) {
+            std::string name = line.substr(0, colonPos);
+            std::string value = line.substr(colonPos + 1);
+            name.erase(name.find_last_not_of(" \t") + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+
+            PropertyValue property;
+            if (parseProperty(name, value, property)) {
+                tree[stack.back()].properties.push_back(std::move(property));
+            }
+        }
+    }
+
+    if (tree[0].children.empty()) {
+        return nullptr;
+    }
+
+    // Flatten the first top-level widget in preorder
+    auto result = std::make_shared<UITemplate>();
+    std::vector<size_t> pending{tree[0].children.front()};
+    while (!pending.empty()) {
+        ParseNode& source = tree[pending.back()];
+        pending.pop_back();
+
+        Node node;
+        node.type = std::move(source.type);
+        node.firstProperty = static_cast<uint32_t>(result->m_properties.size());
+        node.propertyCount = static_cast<uint32_t>(source.properties.size());
+        node.childCount = static_cast<uint32_t>(source.children.size());
+        result->m_nodes.push_back(std::move(node));
+        for (auto& property : source.properties) {
+            result->m_properties.push_back(std::move(property));
+        }
+        pending.insert(pending.end(), source.children.rbegin(), source.children.rend());
+    }
+    return result;
+}
+
+bool UITemplate::getSource(const std::string& path, Source& source) {
+    std::error_code error;
+    uintmax_t size = fs::file_size(path, error);
+    if (error) return false;
+    auto mtime = fs::last_write_time(path, error);
+    if (error) return false;
+
+    source.size = static_cast<uint64_t>(size);
+    source.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+std::shared_ptr<const UITemplate> UITemplate::load(const std::string& cachePath, const Source& source, uint64_t stamp) {
+    MappedFile file;
+    if (!file.open(cachePath, MappedFile::Mode::ReadOnly) || file.size() < HEADER_SIZE) {
+        return nullptr;
+    }
+
+    const uint8_t* header = file.data();
+    uint64_t payloadSize = readLE<uint64_t>(header + 32);
+    if (readLE<uint32_t>(header) != MAGIC ||
+        readLE<uint16_t>(header + 4) != VERSION ||
+        readLE<uint64_t>(header + 8) != source.size ||
+        readLE<int64_t>(header + 16) != source.mtime ||
+        readLE<uint64_t>(header + 24) != stamp ||
+        payloadSize != file.size() - HEADER_SIZE) {
+        return nullptr;
+    }
+
+    const uint8_t* payload = header + HEADER_SIZE;
+    if (fnv1a(payload, payloadSize) != readLE<uint64_t>(header + 40)) {
+        return nullptr;
+    }
+
+    // Once out of data every later read fails
+    size_t pos = 0;
+    bool ok = true;
+    auto take = [&](size_t bytes) -> const uint8_t* {
+        if (!ok || bytes > payloadSize - pos) {
+            ok = false;
+            return nullptr;
+        }
+        pos += bytes;
+        return payload + pos - bytes;
+    };
+    auto readU32 = [&]() {
+        const uint8_t* in = take(4);
+        return in ? readLE<uint32_t>(in) : 0u;
+    };
+    auto readString = [&](std::string& out) {
+        uint32_t size = readU32();
+        if (const uint8_t* in = take(size)) {
+            out.assign(reinterpret_cast<const char*>(in), size);
+        }
+    };
+
+    auto result = std::make_shared<UITemplate>();
+    uint32_t nodeCount = readU32();
+    uint32_t propertyCount = readU32();
+    if (!ok || nodeCount > payloadSize || propertyCount > payloadSize) {
+        return nullptr;
+    }
+
+    result->m_nodes.resize(nodeCount);
+    for (Node& node : result->m_nodes) {
+        readString(node.type);
+        node.firstProperty = readU32();
+        node.propertyCount = readU32();
+        node.childCount = readU32();
+        if (node.firstProperty > propertyCount || node.propertyCount > propertyCount - node.firstProperty) {
+            return nullptr;
+        }
+    }
+
+    result->m_properties.resize(propertyCount);
+    for (PropertyValue& property : result->m_properties) {
+        const uint8_t* in = take(13);
+        if (!in) break;
+        property.key = static_cast<Property>(in[0]);
+        property.number = readLE<int32_t>(in + 1);
+        uint32_t bits = readLE<uint32_t>(in + 5);
+        std::memcpy(&property.real, &bits, sizeof(bits));
+        property.color = Color(in[9], in[10], in[11], in[12]);
+        readString(property.text);
+    }
+
+    if (!ok || pos != payloadSize) {
+        return nullptr;
+    }
+    return result;
+}
+
+bool UITemplate::save(const std::string& cachePath, const Source& source, uint64_t stamp) const {
+    std::vector<uint8_t> data(HEADER_SIZE);
+    auto append = [&](const void* bytes, size_t size) {
+        const uint8_t* in = static_cast<const uint8_t*>(bytes);
+        data.insert(data.end(), in, in + size);
+    };
+    auto writeU32 = [&](uint32_t value) {
+        uint8_t out[4];
+        writeLE(out, value);
+        append(out, sizeof(out));
+    };
+    auto writeString = [&](const std::string& value) {
+        writeU32(static_cast<uint32_t>(value.size()));
+        append(value.data(), value.size());
+    };
+
+    writeU32(static_cast<uint32_t>(m_nodes.size()));
+    writeU32(static_cast<uint32_t>(m_properties.size()));
+    for (const Node& node : m_nodes) {
+        writeString(node.type);
+        writeU32(node.firstProperty);
+        writeU32(node.propertyCount);
+        writeU32(node.childCount);
+    }
+    for (const PropertyValue& property : m_properties) {
+        uint8_t out[13];
+        uint32_t bits;
+        std::memcpy(&bits, &property.real, sizeof(bits));
+        out[0] = static_cast<uint8_t>(property.key);
+        writeLE(out + 1, property.number);
+        writeLE(out + 5, bits);
+        out[9] = property.color.r;
+        out[10] = property.color.g;
+        out[11] = property.color.b;
+        out[12] = property.color.a;
+        append(out, sizeof(out));
+        writeString(property.text);
+    }
+
+    uint8_t* header = data.data();
+    uint64_t payloadSize = data.size() - HEADER_SIZE;
+    writeLE<uint32_t>(header, MAGIC);
+    writeLE<uint16_t>(header + 4, VERSION);
+    writeLE<uint16_t>(header + 6, 0);
+    writeLE<uint64_t>(header + 8, source.size);
+    writeLE<int64_t>(header + 16, source.mtime);
+    writeLE<uint64_t>(header + 24, stamp);
+    writeLE<uint64_t>(header + 32, payloadSize);
+    writeLE<uint64_t>(header + 40, fnv1a(header + HEADER_SIZE, payloadSize));
+
+    std::error_code error;
+    fs::path target(cachePath);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), error);
+    }
+
+    fs::path temporary = target;
+    temporary += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            out.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace framework
+} // namespace shadow
@@ -0,0 +1,91 @@
+/**
+ * Shadow OT Client - UI Templates
+ *
+ * OTUI parsed once into an immutable, flat widget tree: nodes in preorder
+ * with their properties interned and their values converted, styles of
+ * each widget type already merged in. UIManager instantiates windows
+ * straight from a template instead of reparsing the text.
+ *
+ * Templates can be written to disk so later launches skip the parse. The
+ * file is keyed on the size and modification time of the .otui and on a
+ * stamp of the styles and widget types it was compiled against:
+ *
+ *   header:  "STUC" magic, u16 version, u16 reserved, u64 source size,
+ *            i64 source mtime, u64 stamp, u64 payload size, u64 payload
+ *            FNV-1a
+ *   payload: nodes, then properties
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <framework/graphics/graphics.h>
+
+namespace shadow {
+namespace framework {
+
+class UITemplate {
+public:
+    static constexpr uint32_t MAGIC = 0x43555453; // "STUC"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 48;
+
+    enum class Property : uint8_t {
+        Id, Visible, Enabled, Width, Height, X, Y,
+        BackgroundColor, BorderColor, BorderWidth, Opacity, Margin, Padding,
+        Text, Color, Font,                          // Labels; Text also buttons
+        Title, Draggable, Resizable, Closeable      // Windows
+    };
+
+    struct PropertyValue {
+        Property key{Property::Id};
+        int32_t number{0};          // Integers and booleans
+        float real{0.0f};
+        Color color;
+        std::string text;
+    };
+
+    // Preorder: a node's children follow it, each with its own subtree
+    struct Node {
+        std::string type;
+        uint32_t firstProperty{0};
+        uint32_t propertyCount{0};
+        uint32_t childCount{0};
+    };
+
+    using StyleMap = std::map<std::string, std::map<std::string, std::string>>;
+    using TypeFilter = std::function<bool(const std::string&)>;
+
+    // The first top-level widget of the text, or nullptr if there is none.
+    // Lines naming types isKnownType rejects are skipped, so their
+    // properties land on the enclosing widget; unknown properties and
+    // values that do not parse are dropped.
+    static std::shared_ptr<const UITemplate> compile(const std::string& otui, const TypeFilter& isKnownType,
+                                                     const StyleMap& styles);
+
+    const std::vector<Node>& getNodes() const { return m_nodes; }
+    const std::vector<PropertyValue>& getProperties() const { return m_properties; }
+
+    // Identity of the source file; false if it cannot be stat'ed
+    struct Source {
+        uint64_t size{0};
+        int64_t mtime{0};
+    };
+    static bool getSource(const std::string& path, Source& source);
+
+    static std::shared_ptr<const UITemplate> load(const std::string& cachePath, const Source& source, uint64_t stamp);
+    // Written to a temporary file and renamed into place
+    bool save(const std::string& cachePath, const Source& source, uint64_t stamp) const;
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<PropertyValue> m_properties;
+};
+
+} // namespace framework
+} // namespace shadow
@@ -49,10 +49,12 @@ void UITextInput::selectAll() {
     m_selectionStart = 0;
     m_selectionEnd = m_text.length();
     m_cursorPos = m_selectionEnd;
+    invalidate();
 }
 
 void UITextInput::clearSelection() {
     m_selectionStart = m_selectionEnd = m_cursorPos;
+    invalidate();
 }
 
 std::string UITextInput::getSelectedText() const {
@@ -65,6 +67,7 @@ std::string UITextInput::getSelectedText() const {
 
 void UITextInput::setCursorPosition(size_t pos) {
     m_cursorPos = std::min(pos, m_text.length());
+    invalidate();
 }
 
 void UITextInput::insertText(const std::string& text) {
@@ -115,6 +118,7 @@ void UITextInput::updateDisplayText() {
     } else {
         m_displayText = m_text;
     }
+    invalidate();
 }
 
 void UITextInput::drawSelf() {
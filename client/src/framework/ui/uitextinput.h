@@ -19,13 +19,13 @@ public:
     void setText(const std::string& text);
     const std::string& getText() const { return m_text; }
 
-    void setPlaceholder(const std::string& text) { m_placeholder = text; }
+    void setPlaceholder(const std::string& text) { m_placeholder = text; invalidate(); }
     const std::string& getPlaceholder() const { return m_placeholder; }
 
     void setMaxLength(size_t length) { m_maxLength = length; }
     size_t getMaxLength() const { return m_maxLength; }
 
-    void setPassword(bool password) { m_password = password; }
+    void setPassword(bool password) { m_password = password; invalidate(); }
     bool isPassword() const { return m_password; }
 
     void setReadOnly(bool readOnly) { m_readOnly = readOnly; }
@@ -39,9 +39,9 @@ public:
     size_t getCursorPosition() const { return m_cursorPos; }
 
     // Colors
-    void setTextColor(const Color& color) { m_textColor = color; }
-    void setPlaceholderColor(const Color& color) { m_placeholderColor = color; }
-    void setSelectionColor(const Color& color) { m_selectionColor = color; }
+    void setTextColor(const Color& color) { m_textColor = color; invalidate(); }
+    void setPlaceholderColor(const Color& color) { m_placeholderColor = color; invalidate(); }
+    void setSelectionColor(const Color& color) { m_selectionColor = color; invalidate(); }
 
     // Callbacks
     using TextChangeCallback = std::function<void(const std::string&)>;
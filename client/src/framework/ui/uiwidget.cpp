@@ -3,16 +3,21 @@
  */
 
 #include "uiwidget.h"
+#include <framework/core/memorytracker.h>
 #include <framework/core/resourcemanager.h>
 #include <algorithm>
 
 namespace shadow {
 namespace framework {
 
-UIWidget::UIWidget() = default;
+// Counted at the base size; subclasses add little beyond it
+UIWidget::UIWidget() {
+    g_memory.allocate(MemoryTag::UI, sizeof(UIWidget));
+}
 
 UIWidget::~UIWidget() {
     destroy();
+    g_memory.release(MemoryTag::UI, sizeof(UIWidget));
 }
 
 void UIWidget::destroy() {
@@ -38,7 +43,10 @@ void UIWidget::addChild(UIWidgetPtr child) {
 
     child->m_parent = shared_from_this();
     m_children.push_back(child);
+    child->reindex(child.get(), child->getTopLevel());
+    child->invalidateAbsoluteRect();
     child->setup();
+    child->invalidate();
     updateLayout();
 }
 
@@ -57,7 +65,10 @@ void UIWidget::insertChild(int index, UIWidgetPtr child) {
         m_children.insert(m_children.begin() + index, child);
     }
 
+    child->reindex(child.get(), child->getTopLevel());
+    child->invalidateAbsoluteRect();
     child->setup();
+    child->invalidate();
     updateLayout();
 }
 
@@ -66,19 +77,122 @@ void UIWidget::removeChild(UIWidgetPtr child) {
 
     auto it = std::find(m_children.begin(), m_children.end(), child);
     if (it != m_children.end()) {
+        invalidate();
+        UIWidget* owner = child->getTopLevel();
         child->m_parent.reset();
         m_children.erase(it);
+        child->reindex(owner, child.get());
+        child->invalidateAbsoluteRect();
         updateLayout();
     }
 }
 
+void UIWidget::setId(const std::string& id) {
+    if (id == m_id) return;
+
+    UIWidget* owner = getTopLevel();
+    auto range = owner->m_idIndex.equal_range(m_id);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == this) {
+            owner->m_idIndex.erase(it);
+            break;
+        }
+    }
+
+    m_id = id;
+    if (!m_id.empty()) {
+        owner->m_idIndex.emplace(m_id, this);
+    }
+}
+
+UIWidget* UIWidget::getTopLevel() {
+    UIWidget* widget = this;
+    while (auto parent = widget->m_parent.lock()) {
+        if (parent->m_root) break;
+        widget = parent.get();
+    }
+    return widget;
+}
+
+void UIWidget::reindex(UIWidget* from, UIWidget* to) {
+    if (from == to) return;
+    unindexFrom(from);
+    indexInto(to);
+}
+
+void UIWidget::indexInto(UIWidget* owner) {
+    if (!m_id.empty()) {
+        owner->m_idIndex.emplace(m_id, this);
+    }
+    for (auto& child : m_children) {
+        child->indexInto(owner);
+    }
+}
+
+void UIWidget::unindexFrom(UIWidget* owner) {
+    if (!m_id.empty()) {
+        auto range = owner->m_idIndex.equal_range(m_id);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == this) {
+                owner->m_idIndex.erase(it);
+                break;
+            }
+        }
+    }
+    for (auto& child : m_children) {
+        child->unindexFrom(owner);
+    }
+}
+
+bool UIWidget::isDescendantOf(const UIWidget* ancestor) const {
+    for (auto parent = m_parent.lock(); parent; parent = parent->m_parent.lock()) {
+        if (parent.get() == ancestor) return true;
+    }
+    return false;
+}
+
 UIWidgetPtr UIWidget::getChildById(const std::string& id) {
+    if (id.empty()) {
+        return findChildById(id);
+    }
+
+    // The root spans several windows; search them in order
+    if (m_root) {
+        for (auto& child : m_children) {
+            if (child->getId() == id) {
+                return child;
+            }
+            if (auto found = child->getChildById(id)) {
+                return found;
+            }
+        }
+        return nullptr;
+    }
+
+    UIWidget* owner = getTopLevel();
+    UIWidget* match = nullptr;
+    auto range = owner->m_idIndex.equal_range(id);
+    for (auto it = range.first; it != range.second; ++it) {
+        UIWidget* candidate = it->second;
+        if (candidate == this || (owner != this && !candidate->isDescendantOf(this))) {
+            continue;
+        }
+        // Repeated ids resolve to the first in tree order, as a walk would
+        if (match) {
+            return findChildById(id);
+        }
+        match = candidate;
+    }
+    return match ? match->shared_from_this() : nullptr;
+}
+
+UIWidgetPtr UIWidget::findChildById(const std::string& id) {
     for (auto& child : m_children) {
         if (child->getId() == id) {
             return child;
         }
         // Recursive search
-        if (auto found = child->getChildById(id)) {
+        if (auto found = child->findChildById(id)) {
             return found;
         }
     }
@@ -116,6 +230,7 @@ void UIWidget::destroyChildren() {
         child->destroy();
     }
     m_children.clear();
+    invalidate();
 }
 
 void UIWidget::moveChildToTop(UIWidgetPtr child) {
@@ -123,6 +238,7 @@ void UIWidget::moveChildToTop(UIWidgetPtr child) {
     if (it != m_children.end()) {
         m_children.erase(it);
         m_children.push_back(child);
+        invalidate();
     }
 }
 
@@ -131,6 +247,7 @@ void UIWidget::moveChildToBottom(UIWidgetPtr child) {
     if (it != m_children.end()) {
         m_children.erase(it);
         m_children.insert(m_children.begin(), child);
+        invalidate();
     }
 }
 
@@ -152,14 +269,19 @@ void UIWidget::setSize(int width, int height) {
 }
 
 Rect UIWidget::getAbsoluteRect() const {
-    Rect result = m_rect;
+    if (m_absoluteRectValid) {
+        return m_absoluteRect;
+    }
 
+    Rect result = m_rect;
     if (auto parent = m_parent.lock()) {
-        Point parentPos = parent->getAbsolutePosition();
-        result.x += parentPos.x + parent->m_paddingLeft;
-        result.y += parentPos.y + parent->m_paddingTop;
+        Rect parentRect = parent->getAbsoluteRect();
+        result.x += parentRect.x + parent->m_paddingLeft;
+        result.y += parentRect.y + parent->m_paddingTop;
     }
 
+    m_absoluteRect = result;
+    m_absoluteRectValid = true;
     return result;
 }
 
@@ -168,6 +290,17 @@ Point UIWidget::getAbsolutePosition() const {
     return {absRect.x, absRect.y};
 }
 
+void UIWidget::invalidateAbsoluteRect() {
+    // A valid rect is computed from valid ancestors, so below an invalid
+    // widget nothing is cached
+    if (!m_absoluteRectValid) return;
+
+    m_absoluteRectValid = false;
+    for (auto& child : m_children) {
+        child->invalidateAbsoluteRect();
+    }
+}
+
 void UIWidget::setMargin(int top, int right, int bottom, int left) {
     m_marginTop = top;
     m_marginRight = right;
@@ -184,12 +317,14 @@ void UIWidget::setPadding(int top, int right, int bottom, int left) {
     m_paddingRight = right;
     m_paddingBottom = bottom;
     m_paddingLeft = left;
+    invalidateAbsoluteRect();
     updateLayout();
 }
 
 void UIWidget::setVisible(bool visible) {
     if (m_visible == visible) return;
     m_visible = visible;
+    invalidate();
 
     if (!visible && m_focused) {
         clearFocus();
@@ -221,18 +356,21 @@ void UIWidget::focus() {
     }
 
     m_focused = true;
+    invalidate();
     onFocusGain();
 }
 
 void UIWidget::clearFocus() {
     if (!m_focused) return;
     m_focused = false;
+    invalidate();
     onFocusLoss();
 }
 
 void UIWidget::setEnabled(bool enabled) {
     if (m_enabled == enabled) return;
     m_enabled = enabled;
+    invalidate();
 
     if (!enabled && m_focused) {
         clearFocus();
@@ -242,6 +380,18 @@ void UIWidget::setEnabled(bool enabled) {
 void UIWidget::setImageSource(const std::string& path) {
     extern ResourceManager& g_resources;
     m_backgroundImage = g_resources.loadTexture(path);
+    invalidate();
+}
+
+void UIWidget::invalidate() {
+    // Walk up to the top-level window holding the layer; the root itself
+    // is never cached
+    UIWidget* layer = this;
+    while (auto parent = layer->m_parent.lock()) {
+        if (parent->m_parent.expired()) break;
+        layer = parent.get();
+    }
+    layer->m_layerDirty = true;
 }
 
 void UIWidget::draw() {
@@ -339,6 +489,7 @@ bool UIWidget::onMouseDown(int x, int y, int button) {
     Rect absRect = getAbsoluteRect();
     if (absRect.contains(x, y)) {
         m_pressed = true;
+        invalidate();
         focus();
 
         if (m_onMouseDown && m_onMouseDown(shared_from_this(), x, y, button)) {
@@ -355,6 +506,9 @@ bool UIWidget::onMouseUp(int x, int y, int button) {
 
     bool wasPressed = m_pressed;
     m_pressed = false;
+    if (wasPressed) {
+        invalidate();
+    }
 
     // Find child at position
     if (auto child = getChildByPos(x, y)) {
@@ -385,16 +539,24 @@ bool UIWidget::onMouseMove(int x, int y) {
 
     if (isInside && !m_hovered) {
         m_hovered = true;
+        invalidate();
         onMouseEnter();
     } else if (!isInside && m_hovered) {
         m_hovered = false;
+        invalidate();
         onMouseLeave();
     }
 
-    // Propagate to children
+    // Propagate to children under the point, and to those whose subtree
+    // still holds hover so they can leave
+    bool hoverInSubtree = false;
     for (auto& child : m_children) {
-        child->onMouseMove(x, y);
+        if (child->m_hovered || child->m_hoverInSubtree || child->getAbsoluteRect().contains(x, y)) {
+            child->onMouseMove(x, y);
+        }
+        hoverInSubtree = hoverInSubtree || child->m_hovered || child->m_hoverInSubtree;
     }
+    m_hoverInSubtree = hoverInSubtree;
 
     return isInside;
 }
@@ -416,6 +578,7 @@ void UIWidget::onMouseEnter() {
 void UIWidget::onMouseLeave() {
     m_hovered = false;
     m_pressed = false;
+    invalidate();
 }
 
 void UIWidget::onFocusGain() {
@@ -427,6 +590,7 @@ void UIWidget::onFocusLoss() {
 }
 
 void UIWidget::updateLayout() {
+    invalidate();
     if (m_layout == Layout::None || m_children.empty()) return;
 
     int x = m_paddingLeft;
@@ -554,6 +718,8 @@ void UIWidget::updateGeometry() {
         }
     }
 
+    invalidateAbsoluteRect();
+
     // Update children layout
     updateLayout();
 }
@@ -11,6 +11,7 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <unordered_map>
 #include <framework/graphics/graphics.h>
 
 namespace shadow {
@@ -30,16 +31,27 @@ public:
     virtual void destroy();
     bool isDestroyed() const { return m_destroyed; }
 
-    // Identification
-    void setId(const std::string& id) { m_id = id; }
+    // Identification. Ids are indexed per top-level window, so lookups
+    // by id cost a hash probe instead of a walk over the subtree.
+    void setId(const std::string& id);
     const std::string& getId() const { return m_id; }
 
+    // The UI root: its children are the top-level windows
+    void setRoot(bool root) { m_root = root; }
+    bool isRoot() const { return m_root; }
+    // The window this widget belongs to: the ancestor right below the
+    // root, or the top of a tree not attached to it
+    UIWidget* getTopLevel();
+
     // Hierarchy
     void addChild(UIWidgetPtr child);
     void insertChild(int index, UIWidgetPtr child);
     void removeChild(UIWidgetPtr child);
     UIWidgetPtr getChildById(const std::string& id);
     UIWidgetPtr getChildByIndex(int index);
+    // Deepest visible widget under the point. Only children containing it
+    // are descended into, so a hit costs the depth times the siblings
+    // visited on the way.
     UIWidgetPtr getChildByPos(int x, int y);
     UIWidgetPtr getParent() const { return m_parent.lock(); }
     const UIWidgetList& getChildren() const { return m_children; }
@@ -64,7 +76,8 @@ public:
     int getWidth() const { return m_rect.width; }
     int getHeight() const { return m_rect.height; }
 
-    // Absolute position (relative to root)
+    // Absolute position (relative to root); cached until this widget or an
+    // ancestor moves or is reparented
     Rect getAbsoluteRect() const;
     Point getAbsolutePosition() const;
 
@@ -75,10 +88,10 @@ public:
     void setMarginBottom(int m) { m_marginBottom = m; }
     void setMarginLeft(int m) { m_marginLeft = m; }
     void setPadding(int top, int right, int bottom, int left);
-    void setPaddingTop(int p) { m_paddingTop = p; }
-    void setPaddingRight(int p) { m_paddingRight = p; }
-    void setPaddingBottom(int p) { m_paddingBottom = p; }
-    void setPaddingLeft(int p) { m_paddingLeft = p; }
+    void setPaddingTop(int p) { m_paddingTop = p; invalidateAbsoluteRect(); invalidate(); }
+    void setPaddingRight(int p) { m_paddingRight = p; invalidate(); }
+    void setPaddingBottom(int p) { m_paddingBottom = p; invalidate(); }
+    void setPaddingLeft(int p) { m_paddingLeft = p; invalidateAbsoluteRect(); invalidate(); }
 
     // Visibility
     void setVisible(bool visible);
@@ -96,13 +109,13 @@ public:
     bool isEnabled() const { return m_enabled; }
 
     // Appearance
-    void setBackgroundColor(const Color& color) { m_backgroundColor = color; }
-    void setBackgroundColor(const std::string& hex) { m_backgroundColor = Color::fromHex(hex); }
+    void setBackgroundColor(const Color& color) { m_backgroundColor = color; invalidate(); }
+    void setBackgroundColor(const std::string& hex) { m_backgroundColor = Color::fromHex(hex); invalidate(); }
     const Color& getBackgroundColor() const { return m_backgroundColor; }
-    void setBorderColor(const Color& color) { m_borderColor = color; }
-    void setBorderWidth(int width) { m_borderWidth = width; }
-    void setBorderRadius(int radius) { m_borderRadius = radius; }
-    void setOpacity(float opacity) { m_opacity = opacity; }
+    void setBorderColor(const Color& color) { m_borderColor = color; invalidate(); }
+    void setBorderWidth(int width) { m_borderWidth = width; invalidate(); }
+    void setBorderRadius(int radius) { m_borderRadius = radius; invalidate(); }
+    void setOpacity(float opacity) { m_opacity = opacity; invalidate(); }
     float getOpacity() const { return m_opacity; }
 
     // Image background
@@ -113,6 +126,17 @@ public:
     virtual void drawSelf();
     virtual void drawChildren();
 
+    // Extent of what drawSelf paints; widgets drawing past their rect
+    // (open dropdowns) widen it
+    virtual Rect getDrawRect() const { return getAbsoluteRect(); }
+
+    // Retained rendering: each top-level window (a child of the root) is
+    // cached by UIManager and repainted only when something in it calls
+    // invalidate. Setters that change what a widget draws call it.
+    void invalidate();
+    bool isLayerDirty() const { return m_layerDirty; }
+    void clearLayerDirty() { m_layerDirty = false; }
+
     // Input handling
     virtual bool onKeyDown(int keyCode, int modifiers);
     virtual bool onKeyUp(int keyCode, int modifiers);
@@ -164,6 +188,15 @@ public:
 
 protected:
     virtual void updateGeometry();
+    // Drop the cached absolute rects of this subtree
+    void invalidateAbsoluteRect();
+
+    // Move this subtree's ids from one window's index to another's
+    void reindex(UIWidget* from, UIWidget* to);
+    void indexInto(UIWidget* owner);
+    void unindexFrom(UIWidget* owner);
+    bool isDescendantOf(const UIWidget* ancestor) const;
+    UIWidgetPtr findChildById(const std::string& id);
 
     std::string m_id;
     std::weak_ptr<UIWidget> m_parent;
@@ -179,6 +212,15 @@ protected:
     bool m_destroyed{false};
     bool m_hovered{false};
     bool m_pressed{false};
+    bool m_layerDirty{true};
+    bool m_hoverInSubtree{false};       // Some descendant is hovered
+    bool m_root{false};
+
+    mutable Rect m_absoluteRect;
+    mutable bool m_absoluteRectValid{false};
+
+    // Id index, kept by top-level windows over their subtree
+    std::unordered_multimap<std::string, UIWidget*> m_idIndex;
 
     Color m_backgroundColor{0, 0, 0, 0};
     Color m_borderColor{100, 100, 100, 255};
@@ -16,7 +16,7 @@ class UIWindow : public UIWidget {
 public:
     UIWindow();
 
-    void setTitle(const std::string& title) { m_title = title; }
+    void setTitle(const std::string& title) { m_title = title; invalidate(); }
     const std::string& getTitle() const { return m_title; }
 
     void setDraggable(bool draggable) { m_draggable = draggable; }
@@ -25,16 +25,16 @@ public:
     void setResizable(bool resizable) { m_resizable = resizable; }
     bool isResizable() const { return m_resizable; }
 
-    void setCloseable(bool closeable) { m_closeable = closeable; }
+    void setCloseable(bool closeable) { m_closeable = closeable; invalidate(); }
     bool isCloseable() const { return m_closeable; }
 
     void setMinSize(int width, int height) { m_minWidth = width; m_minHeight = height; }
     void setMaxSize(int width, int height) { m_maxWidth = width; m_maxHeight = height; }
 
     // Header appearance
-    void setTitleBarHeight(int height) { m_titleBarHeight = height; }
-    void setTitleBarColor(const Color& color) { m_titleBarColor = color; }
-    void setTitleColor(const Color& color) { m_titleColor = color; }
+    void setTitleBarHeight(int height) { m_titleBarHeight = height; invalidate(); }
+    void setTitleBarColor(const Color& color) { m_titleBarColor = color; invalidate(); }
+    void setTitleColor(const Color& color) { m_titleColor = color; invalidate(); }
 
     // Close callback
     using CloseCallback = std::function<bool()>;
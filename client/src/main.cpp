@@ -7,21 +7,45 @@
 #include <framework/core/application.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/jobsystem.h>
+#include <framework/core/memorytracker.h>
+#include <framework/core/startupgraph.h>
 #include <framework/core/configmanager.h>
+#include <framework/core/profiler.h>
 #include <framework/graphics/graphics.h>
+#include <framework/graphics/font.h>
+#include <framework/graphics/renderbackend.h>
+#include <framework/input/inputmanager.h>
 #include <framework/luaengine/luainterface.h>
+#include <framework/luaengine/luaprofiler.h>
+#include <framework/net/connection.h>
+#include <framework/net/connectionprewarmer.h>
+#include <framework/net/httpclient.h>
 #include <framework/platform/platform.h>
+#include <framework/sound/soundmanager.h>
 #include <framework/ui/uimanager.h>
 
 #include <shadow/realms/realmmanager.h>
 #include <shadow/blockchain/wallet.h>
 #include <client/game.h>
+#include <client/luabindings.h>
+#include <client/minimapview.h>
+#include <client/networktelemetry.h>
+#include <client/thingtype.h>
+#include <client/uiminimap.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
 // Use framework globals
 using shadow::framework::g_graphics;
+using shadow::framework::g_resources;
+using shadow::framework::g_fonts;
+using shadow::framework::g_profiler;
+using shadow::framework::g_luaProfiler;
+using shadow::framework::StartupGraph;
+using shadow::framework::StageThread;
 using shadow::framework::Color;
 using shadow::framework::Rect;
 
@@ -45,34 +69,6 @@ void printBanner() {
 )" << std::endl;
 }
 
-bool initializeFramework() {
-    // Initialize core systems - graphics needs the window from app
-    if (!g_graphics.init()) {
-        std::cerr << "Failed to initialize graphics" << std::endl;
-        return false;
-    }
-
-    // Pass the window to graphics for buffer swapping
-    g_graphics.setWindow(g_app.getWindow());
-
-    // Set up viewport and projection
-    int width = g_app.getWindowWidth();
-    int height = g_app.getWindowHeight();
-    g_graphics.setViewport(0, 0, width, height);
-    g_graphics.setOrtho(width, height);
-
-    if (!g_lua.init()) {
-        std::cerr << "Failed to initialize Lua engine" << std::endl;
-        return false;
-    }
-
-    // Initialize Shadow OT extensions
-    shadow::realms::RealmManager::instance();
-    shadow::blockchain::Wallet::instance();
-
-    return true;
-}
-
 bool loadModules() {
     // Load core modules from the modules directory
     // These will be loaded if they exist
@@ -83,7 +79,17 @@ bool loadModules() {
 #ifdef SHADOW_PLATFORM_WEB
 void webMainLoop() {
     g_app.poll();
+    g_input.update();
+    g_input.dispatchEvents();
     g_dispatcher.poll();
+    g_resources.poll();
+    shadow::realms::RealmManager::instance().poll();
+    g_prewarmer.poll();
+    g_http.poll();
+    g_memory.poll();
+    g_game.poll();
+    g_netTelemetry.update();
+    g_lua.getScheduler().update();
 
     g_graphics.beginFrame();
     g_graphics.clear(shadow::framework::Color(16, 24, 48, 255));
@@ -93,6 +99,7 @@ void webMainLoop() {
     );
     g_graphics.endFrame();
     g_graphics.render();
+    g_input.markFramePresented();
 }
 #endif
 
@@ -110,24 +117,314 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Initialize framework
-    if (!initializeFramework()) {
-        std::cerr << "Failed to initialize framework" << std::endl;
+    // Startup as a dependency graph. Main stages hold GL or state the frame
+    // loop also touches; the rest run on job workers as soon as what they
+    // need is up. Ask for --startup-trace <path> to see how they overlapped.
+    g_jobs.init();
+    StartupGraph startup;
+
+    std::string tracePath = g_app.getArgValue("--profile-trace");
+    std::string luaProfilePath = g_app.getArgValue("--lua-profile-out");
+    std::string startupTracePath = g_app.getArgValue("--startup-trace");
+
+    // Graphics needs the window from app, and the config for its backend:
+    // --graphics-backend or graphics-backend, opengl by default
+    startup.add("graphics", {"config"}, StageThread::Main, [] {
+        using shadow::framework::RenderBackendType;
+        std::string backendName = g_app.getArgValue("--graphics-backend");
+        if (backendName.empty()) {
+            backendName = g_configs.getString("graphics-backend", "opengl");
+        }
+        // Only the backend asked for: an unknown or missing one fails startup
+        RenderBackendType backend = RenderBackendType::OpenGL;
+        if (!shadow::framework::parseRenderBackend(backendName, backend)) {
+            std::cerr << "Unknown graphics backend: " << backendName
+                      << " (expected opengl, vulkan or metal)" << std::endl;
+            return false;
+        }
+        if (!shadow::framework::isRenderBackendBuiltIn(backend)) {
+            std::cerr << "Graphics backend " << shadow::framework::getRenderBackendName(backend)
+                      << " is not built into this client" << std::endl;
+            return false;
+        }
+
+        if (!g_graphics.init(backend)) {
+            std::cerr << "Failed to initialize graphics" << std::endl;
+            return false;
+        }
+
+        // Pass the window to graphics for buffer swapping
+        g_graphics.setWindow(g_app.getWindow());
+
+        // Set up viewport and projection
+        int width = g_app.getWindowWidth();
+        int height = g_app.getWindowHeight();
+        g_graphics.setViewport(0, 0, width, height);
+        g_graphics.setOrtho(width, height);
+        return true;
+    });
+
+    startup.add("resources", {}, StageThread::Main, [] {
+        g_resources.init();
+        g_resources.addSearchPath(g_app.getDataPath());
+        return true;
+    });
+
+    startup.add("config", {}, StageThread::Main, [&tracePath] {
+        g_configs.load("config.lua");
+
+        // Network backend: one shared reactor thread instead of two threads per connection
+        if (g_app.hasArg("--net-reactor") || g_configs.getBool("net-reactor")) {
+            shadow::framework::Connection::setDefaultBackend(shadow::framework::NetworkBackend::Reactor);
+        }
+
+        // Frame pacing, kept live so changing a setting applies it without a
+        // restart; low-latency mode turns vsync off and lets the pacer alone
+        // hold the frame rate
+        g_configs.watch(g_configs.handle<int>("fps", g_app.getTargetFPS()), [](const int& fps) { g_app.setTargetFPS(fps); });
+        g_configs.watch(g_configs.handle<int>("background-fps", 20), [](const int& fps) { g_app.setBackgroundFPS(fps); });
+        g_configs.watch(g_configs.handle<int>("minimized-fps", 5), [](const int& fps) { g_app.setMinimizedFPS(fps); });
+        g_configs.watch(g_configs.handle<bool>("late-latch", true), [](const bool& on) { g_app.setLateLatch(on); });
+        if (g_app.hasArg("--low-latency") || g_configs.getBool("low-latency")) {
+            g_app.setVSync(false);
+        }
+
+        // Steps walked ahead of server confirmation; 1 waits for each one
+        g_configs.watch(g_configs.handle<int>("walk-prediction-steps",
+                                              static_cast<int>(shadow::client::LocalPlayer::DEFAULT_PREDICTED_STEPS)),
+                        [](const int& steps) { g_game.setPredictedWalkSteps(static_cast<size_t>(std::max(1, steps))); });
+
+        // Packet capture/replay for reproducible parser and render benchmarks
+        std::string capturePath = g_app.getArgValue("--net-capture");
+        if (!capturePath.empty()) {
+            g_game.setCapturePath(capturePath);
+        }
+
+        // Deflate for server frames above the threshold, if the server agrees
+        if (g_app.hasArg("--net-compress") || g_configs.getBool("net-compression")) {
+            g_game.setCompressionThreshold(static_cast<uint16_t>(std::clamp(
+                g_configs.getInt("net-compression-threshold", shadow::framework::PacketCompression::DEFAULT_THRESHOLD),
+                1, 65535)));
+        }
+
+        // Frame profiler: --profile shows the overlay (Ctrl+F12 toggles it),
+        // --profile-trace writes the frame history as a trace on exit
+        if (!tracePath.empty()) {
+            g_profiler.setEnabled(true);
+        }
+        if (g_app.hasArg("--profile") || g_configs.getBool("profiler")) {
+            g_profiler.setOverlayVisible(true);
+        }
+
+        // Per-subsystem memory, one CSV row a minute (memory-dump-interval) to
+        // diff over a long session
+        std::string memoryDumpPath = g_app.getArgValue("--memory-dump");
+        if (memoryDumpPath.empty()) {
+            memoryDumpPath = g_configs.getString("memory-dump");
+        }
+        if (!memoryDumpPath.empty() &&
+            !g_memory.setDumpFile(memoryDumpPath, std::chrono::seconds(g_configs.getInt("memory-dump-interval", 60)))) {
+            std::cerr << "Failed to open memory dump: " << memoryDumpPath << std::endl;
+        }
+
+        // Network telemetry: --net-stats shows the overlay, --net-stats-out
+        // appends a CSV row every net-stats-interval seconds
+        if (g_app.hasArg("--net-stats") || g_configs.getBool("net-stats")) {
+            g_netTelemetry.setOverlayVisible(true);
+        }
+        std::string netStatsPath = g_app.getArgValue("--net-stats-out");
+        if (netStatsPath.empty()) {
+            netStatsPath = g_configs.getString("net-stats-out");
+        }
+        if (!netStatsPath.empty() &&
+            !g_netTelemetry.setExportFile(netStatsPath, std::chrono::seconds(g_configs.getInt("net-stats-interval", 10)))) {
+            std::cerr << "Failed to open network stats file: " << netStatsPath << std::endl;
+        }
+        return true;
+    });
+
+#ifndef SHADOW_PLATFORM_WEB
+    // GL on its own thread, drawing snapshots recorded by this one, so a
+    // slow frame of Lua or packets and a slow swap stop holding each other up
+    startup.add("render-thread", {"graphics", "config"}, StageThread::Main, [] {
+        if ((g_app.hasArg("--render-thread") || g_configs.getBool("render-thread")) &&
+            !g_graphics.startRenderThread()) {
+            std::cerr << "Failed to start the render thread; drawing from the main thread" << std::endl;
+        }
+        return true;
+    });
+#endif
+
+    // Assets packed with shadow-pack; files in the pack shadow loose ones.
+    // Mounted before any stage resolves paths on a worker.
+    startup.add("assets", {"resources", "config"}, StageThread::Main, [] {
+        std::string assetPack = g_app.getArgValue("--asset-pack");
+        if (assetPack.empty()) {
+            assetPack = g_configs.getString("asset-pack");
+        }
+        if (!assetPack.empty() && !g_resources.loadAssetPack(assetPack)) {
+            std::cerr << "Failed to mount asset pack: " << assetPack << std::endl;
+        }
+        return true;
+    });
+
+    // Bitmap fonts for all text drawing
+    startup.add("fonts", {"graphics", "assets"}, StageThread::Main, [] {
+        for (const std::string& file : g_fonts.importFonts("fonts")) {
+            std::cerr << "Failed to load font: " << file << std::endl;
+        }
+        return true;
+    });
+
+    startup.add("lua", {}, StageThread::Any, [] {
+        if (!g_lua.init()) {
+            std::cerr << "Failed to initialize Lua engine" << std::endl;
+            return false;
+        }
+        return true;
+    });
+
+    // Web assets (NFT metadata and images) with their own disk cache
+    startup.add("http", {}, StageThread::Any, [] {
+        g_http.init(g_app.getUserPath() + "/cache/http");
+        return true;
+    });
+
+    // Shadow OT extensions; the cached realm list is probed at once so its
+    // latencies are fresh by the time it is shown
+    startup.add("realms", {}, StageThread::Main, [] {
+        auto& realms = shadow::realms::RealmManager::instance();
+        realms.setCacheDirectory(g_app.getUserPath() + "/cache");
+        realms.probeLatency();
+        return true;
+    });
+
+    startup.add("wallet", {}, StageThread::Any, [] {
+        shadow::blockchain::Wallet::instance();
+        return true;
+    });
+
+    // Without a device the client runs silent; that is not a failure
+    startup.add("sound", {}, StageThread::Any, [] {
+        g_sounds.init();
+        if (!g_sounds.hasAudioDevice()) {
+            std::cerr << "Failed to open audio device, sound disabled" << std::endl;
+        }
+        return true;
+    });
+
+    // Widget types and the OTUI styles every window compiles against
+    startup.add("ui", {"assets"}, StageThread::Any, [] {
+        g_ui.init();
+        g_ui.registerWidgetType("UIMinimap", []() { return std::make_shared<shadow::client::UIMinimap>(); });
+        g_ui.setTemplateCacheDirectory(g_app.getUserPath() + "/cache/ui");
+        g_ui.loadStyles("ui");
+        return true;
+    });
+
+    // Game session state, the path service and the sprite decoder; shut
+    // down before the job system their searches and decodes run on
+    startup.add("game", {"config"}, StageThread::Main, [] {
+        g_game.init();
+        return true;
+    });
+
+    // Thing types and sprites, when config.lua names them (things-dat,
+    // things-spr); the server's version may pick other files at login
+    startup.add("things", {"assets", "config", "game"}, StageThread::Any, [] {
+        auto& things = shadow::client::ThingTypeManager::instance();
+        things.setCacheDirectory(g_app.getUserPath() + "/cache/things");
+        std::string dat = g_configs.getString("things-dat");
+        if (!dat.empty() && !things.loadDat(dat)) {
+            std::cerr << "Failed to load thing types: " << dat << std::endl;
+        }
+        std::string spr = g_configs.getString("things-spr");
+        if (!spr.empty() && !things.loadSpr(spr)) {
+            std::cerr << "Failed to load sprites: " << spr << std::endl;
+        }
+        return true;
+    });
+
+    // Scripts run on the main thread, where the game will call them
+    startup.add("modules", {"lua", "ui", "things", "config", "game"}, StageThread::Main, [&luaProfilePath] {
+        // Compiled modules under the user path; --no-lua-cache always parses
+        if (!g_app.hasArg("--no-lua-cache") && g_configs.getBool("lua-bytecode-cache", true)) {
+            g_lua.setBytecodeCacheDirectory(g_app.getUserPath() + "/cache/lua");
+        }
+
+        // Game classes and the engine events tasks wait on
+        shadow::client::registerLuaBindings(g_lua.getState());
+
+        if (!loadModules()) {
+            std::cerr << "Failed to load modules" << std::endl;
+            return false;
+        }
+
+        // Lua collection in the frame's idle time instead of on allocation;
+        // lua-gc = "automatic" in config.lua restores the stock collector
+        using GCMode = shadow::framework::LuaInterface::GCMode;
+        std::string gcMode = g_configs.getString("lua-gc", "generational");
+        g_lua.setGCMode(gcMode == "automatic" ? GCMode::Automatic :
+                        gcMode == "incremental" ? GCMode::Incremental : GCMode::Generational);
+        g_app.setIdleCallback([](double budgetMs) { g_lua.collectGarbage(budgetMs); });
+
+        // Milliseconds of script task resumes per frame; the rest waits a frame
+        g_lua.getScheduler().setFrameBudget(g_configs.getDouble("lua-task-budget-ms",
+                                                                shadow::framework::LuaScheduler::DEFAULT_FRAME_BUDGET_MS));
+
+        // Script profiler: --lua-profile shows per-module CPU next to the frame
+        // overlay, --lua-profile-out writes folded stacks for a flame graph on exit
+        if (g_app.hasArg("--lua-profile") || g_configs.getBool("lua-profiler") || !luaProfilePath.empty()) {
+            g_luaProfiler.start(g_lua.getState());
+            g_luaProfiler.setBudgetCallback([](const std::string& module, double ms, uint32_t framesOver) {
+                std::cerr << "Lua module '" << module << "' took " << ms << " ms in one frame (budget "
+                          << g_luaProfiler.getFrameBudget() << " ms, " << framesOver << " frames over)" << std::endl;
+            });
+            g_luaProfiler.setOverlayVisible(luaProfilePath.empty() || g_app.hasArg("--lua-profile"));
+        }
+        return true;
+    });
+
+    startup.add("replay", {"modules"}, StageThread::Main, [] {
+        std::string replayPath = g_app.getArgValue("--net-replay");
+        if (!replayPath.empty() && !g_game.startReplay(replayPath, g_app.hasArg("--net-replay-fast"))) {
+            std::cerr << "Failed to open packet capture: " << replayPath << std::endl;
+        }
+        return true;
+    });
+
+    // The login screen needs the window and fonts; HTTP and realms are
+    // polled every frame. The rest finishes from the frame loop.
+#ifdef SHADOW_PLATFORM_WEB
+    bool started = startup.runAll();
+#else
+    bool started = startup.runUntil({"graphics", "fonts", "http", "realms"});
+#endif
+    if (!started) {
+        std::cerr << "Failed to initialize " << startup.getFailure() << std::endl;
         return 1;
     }
+    bool startupReported = false;
+    auto reportStartup = [&]() {
+        startupReported = true;
+        startup.printSummary(std::cout);
+        if (!startupTracePath.empty() && !startup.exportTrace(startupTracePath)) {
+            std::cerr << "Failed to write startup trace: " << startupTracePath << std::endl;
+        }
+        if (startup.hasFailed()) {
+            std::cerr << "Failed to initialize " << startup.getFailure() << std::endl;
+            return false;
+        }
+        std::cout << "Shadow OT Client initialized successfully" << std::endl;
+        return true;
+    };
+    int exitCode = 0;
 
-    // Load configuration
-    g_configs.load("config.lua");
-
-    // Load modules
-    if (!loadModules()) {
-        std::cerr << "Failed to load modules" << std::endl;
+#ifdef SHADOW_PLATFORM_WEB
+    if (!reportStartup()) {
         return 1;
     }
 
-    std::cout << "Shadow OT Client initialized successfully" << std::endl;
-
-#ifdef SHADOW_PLATFORM_WEB
     // Web platform uses emscripten main loop
     emscripten_set_main_loop(webMainLoop, 0, 1);
 #else
@@ -136,8 +433,31 @@ int main(int argc, char* argv[]) {
     int windowHeight = g_app.getWindowHeight();
 
     while (!g_app.shouldClose()) {
+        g_profiler.beginFrame();
+        g_luaProfiler.beginFrame();
+
         g_app.poll();
+        g_input.update();
+        g_input.dispatchEvents();
         g_dispatcher.poll();
+        startup.poll();
+        if (!startupReported && startup.isFinished() && !reportStartup()) {
+            exitCode = 1;
+            break;
+        }
+        g_resources.poll();
+        shadow::realms::RealmManager::instance().poll();
+        g_prewarmer.poll();
+        g_http.poll();
+        if (startup.isDone("sound")) {
+            g_sounds.update(static_cast<float>(g_app.getDeltaTime()));
+        }
+        g_memory.poll();
+        g_game.poll();
+        g_netTelemetry.update();
+        // Script tasks whose delay, event or packet came in, after the
+        // game state they wait on has been updated
+        g_lua.getScheduler().update();
 
         // Begin frame rendering
         g_graphics.beginFrame();
@@ -207,16 +527,45 @@ int main(int argc, char* argv[]) {
         // Version info area (bottom right)
         g_graphics.drawFilledRect(Rect(windowWidth - 200, windowHeight - 25, 190, 20), Color(16, 24, 40, 128));
 
+        g_profiler.drawOverlay(8, 68);
+        g_luaProfiler.drawOverlay(276, 68);
+        g_netTelemetry.drawOverlay(584, 68);
+
         // End frame and swap buffers
         g_graphics.endFrame();
         g_graphics.render();
+        g_input.markFramePresented();
+
+        g_luaProfiler.endFrame();
+        g_profiler.endFrame();
     }
 #endif
 
-    // Cleanup
+    if (!tracePath.empty() && !g_profiler.exportTrace(tracePath)) {
+        std::cerr << "Failed to write profiler trace: " << tracePath << std::endl;
+    }
+
+    if (!luaProfilePath.empty() && !g_luaProfiler.exportFlameGraph(luaProfilePath)) {
+        std::cerr << "Failed to write Lua profile: " << luaProfilePath << std::endl;
+    }
+
+    g_memory.dump();
+
+    // Cleanup; queued jobs finish while what they use is still up
+    g_game.terminate();
+    g_prewarmer.clear();
+    // Stops before the job system, so downloads still queued are dropped
+    // rather than run inline
+    g_http.terminate();
+    g_jobs.terminate();
+    g_sounds.terminate();
+    g_ui.terminate();
+    g_minimapView.terminate();
     g_lua.terminate();
+    g_fonts.terminate();
+    g_resources.terminate();
     g_graphics.terminate();
     g_app.terminate();
 
-    return 0;
+    return exitCode;
 }
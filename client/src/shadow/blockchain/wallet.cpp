@@ -1,4 +1,7 @@
 #include "wallet.h"
+#include <framework/graphics/image.h>
+#include <framework/graphics/textureatlas.h>
+#include <framework/net/httpclient.h>
 #include <sstream>
 #include <iomanip>
 
@@ -10,6 +13,9 @@ Wallet& Wallet::instance() {
     return instance;
 }
 
+Wallet::Wallet() = default;
+Wallet::~Wallet() = default;
+
 void Wallet::connect(Network network, const ConnectionCallback& callback) {
     if (m_status == WalletStatus::Connecting) {
         callback(WalletStatus::Error, "Connection already in progress");
@@ -39,6 +45,11 @@ void Wallet::disconnect() {
     m_nfts.clear();
     m_balances.clear();
     m_pendingTransactions.clear();
+
+    // Downloads finish on their own; cached images stay for the next account
+    for (auto& [url, waiters] : m_imageRequests) {
+        waiters.clear();
+    }
 }
 
 void Wallet::processConnectResult(bool success, const std::string& address,
@@ -94,9 +105,66 @@ void Wallet::loadNFTs(const NFTCallback& callback) {
         }
     };
 
+    // Images are fetched ahead of the window that shows them
+    for (const auto& nft : m_nfts) {
+        requestImage(nft.imageUrl);
+    }
+
     callback(m_nfts);
 }
 
+void Wallet::loadNFTImage(const std::string& tokenId, const NFTImageCallback& callback) {
+    const NFTAsset* nft = findNFT(tokenId);
+    if (!nft || nft->imageUrl.empty()) {
+        callback(tokenId, nullptr);
+        return;
+    }
+
+    if (m_imageAtlas) {
+        if (const framework::AtlasRegion* region = m_imageAtlas->find(std::hash<std::string>{}(nft->imageUrl))) {
+            callback(tokenId, region);
+            return;
+        }
+    }
+
+    requestImage(nft->imageUrl);
+    m_imageRequests[nft->imageUrl].emplace_back(tokenId, callback);
+}
+
+void Wallet::requestImage(const std::string& url) {
+    if (url.empty() || m_imageRequests.count(url)) return;
+    if (m_imageAtlas && m_imageAtlas->find(std::hash<std::string>{}(url))) return;
+    m_imageRequests[url];
+
+    auto decode = [](const std::vector<uint8_t>& data) -> std::shared_ptr<const void> {
+        auto image = std::make_shared<framework::Image>();
+        if (!framework::decodePng(data.data(), data.size(), *image)) return nullptr;
+        return image;
+    };
+
+    g_http.get(url, [this, url](const framework::HttpResponse& response) {
+        auto it = m_imageRequests.find(url);
+        if (it == m_imageRequests.end()) return;
+        auto waiters = std::move(it->second);
+        m_imageRequests.erase(it);
+
+        // Textures belong to the main thread, so the atlas is created here
+        const framework::AtlasRegion* region = nullptr;
+        auto image = std::static_pointer_cast<const framework::Image>(response.decoded);
+        if (image) {
+            if (!m_imageAtlas) {
+                m_imageAtlas = std::make_unique<framework::TextureAtlas>(IMAGE_PAGE_SIZE, IMAGE_MEMORY_BUDGET);
+            }
+            region = m_imageAtlas->add(std::hash<std::string>{}(url), image->width, image->height,
+                                       image->pixels.data());
+        }
+
+        for (const auto& [tokenId, callback] : waiters) {
+            callback(tokenId, region);
+        }
+    }, decode);
+}
+
 NFTAsset* Wallet::findNFT(const std::string& tokenId) {
     for (auto& nft : m_nfts) {
         if (nft.tokenId == tokenId) {
@@ -8,6 +8,11 @@
 #include <unordered_map>
 
 namespace shadow {
+namespace framework {
+struct AtlasRegion;
+class TextureAtlas;
+}
+
 namespace blockchain {
 
 /// Supported blockchain networks
@@ -66,6 +71,8 @@ using ConnectionCallback = std::function<void(WalletStatus, const std::string&)>
 using NFTCallback = std::function<void(const std::vector<NFTAsset>&)>;
 using BalanceCallback = std::function<void(const std::vector<Balance>&)>;
 using TransactionCallback = std::function<void(const Transaction&)>;
+/// Region of the NFT image atlas; nullptr if the image could not be loaded
+using NFTImageCallback = std::function<void(const std::string& tokenId, const framework::AtlasRegion*)>;
 
 /**
  * @brief Wallet manager for blockchain integration
@@ -94,6 +101,14 @@ public:
     bool equipNFT(const std::string& tokenId);
     bool unequipNFT(const std::string& tokenId);
 
+    /// NFT images. Fetched through g_http, so they come from the disk cache
+    /// when the server still has the same ETag, and decoded off the main
+    /// thread; only the atlas upload runs here. loadNFTs starts them all, so
+    /// the wallet window usually finds them in the atlas. Regions stay valid
+    /// until the next image is added.
+    void loadNFTImage(const std::string& tokenId, const NFTImageCallback& callback);
+    const framework::TextureAtlas* imageAtlas() const { return m_imageAtlas.get(); }
+
     /// Balance operations
     void loadBalances(const BalanceCallback& callback);
     const std::vector<Balance>& balances() const { return m_balances; }
@@ -116,13 +131,17 @@ public:
                         const std::string& address);
 
 private:
-    Wallet() = default;
-    ~Wallet() = default;
+    Wallet();
+    ~Wallet();
     Wallet(const Wallet&) = delete;
     Wallet& operator=(const Wallet&) = delete;
 
     void processConnectResult(bool success, const std::string& address,
                              const std::string& error);
+    void requestImage(const std::string& url);
+
+    static constexpr int IMAGE_PAGE_SIZE = 2048;
+    static constexpr size_t IMAGE_MEMORY_BUDGET = 32 * 1024 * 1024;
 
     WalletStatus m_status = WalletStatus::Disconnected;
     Network m_network = Network::Starknet;
@@ -131,6 +150,10 @@ private:
     std::vector<Balance> m_balances;
     std::unordered_map<std::string, TransactionCallback> m_pendingTransactions;
     ConnectionCallback m_connectionCallback;
+
+    std::unique_ptr<framework::TextureAtlas> m_imageAtlas;
+    /// Waiters by image URL while it downloads or decodes
+    std::unordered_map<std::string, std::vector<std::pair<std::string, NFTImageCallback>>> m_imageRequests;
 };
 
 /// Network utility functions
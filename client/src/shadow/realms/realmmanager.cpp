@@ -1,5 +1,15 @@
 #include "realmmanager.h"
+#include <framework/net/connectionprewarmer.h>
+#include <framework/net/latencyprobe.h>
 #include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
 
 namespace shadow {
 namespace realms {
@@ -22,12 +32,108 @@ std::string RealmInfo::statusDisplayName() const {
     }
 }
 
+namespace {
+
+template<typename T>
+void writeLE(std::vector<uint8_t>& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+    }
+}
+
+void writeString(std::vector<uint8_t>& out, const std::string& value) {
+    writeLE<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+template<typename T>
+T readLE(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (i * 8);
+    }
+    return static_cast<T>(value);
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Bounds-checked reads; once out of data every later read fails
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    bool ok() const { return m_ok; }
+
+    template<typename T>
+    T read() {
+        if (!m_ok || sizeof(T) > m_size - m_pos) {
+            m_ok = false;
+            return T{};
+        }
+        m_pos += sizeof(T);
+        return readLE<T>(m_data + m_pos - sizeof(T));
+    }
+
+    std::string readString() {
+        uint32_t size = read<uint32_t>();
+        if (!m_ok || size > m_size - m_pos) {
+            m_ok = false;
+            return {};
+        }
+        m_pos += size;
+        return std::string(reinterpret_cast<const char*>(m_data + m_pos - size), size);
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos{0};
+    bool m_ok{true};
+};
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+constexpr size_t CACHE_HEADER_SIZE = 28;
+
+} // anonymous namespace
+
 RealmManager& RealmManager::instance() {
     static RealmManager instance;
     return instance;
 }
 
+RealmManager::~RealmManager() {
+    m_probeCancelled = true;
+    if (!framework::JobSystem::isDone(m_probeJob)) {
+        g_jobs.wait(m_probeJob);
+    }
+}
+
 void RealmManager::refreshRealms(const RealmCallback& callback) {
+    uint32_t currentId = m_currentRealm ? m_currentRealm->id : 0;
+    std::vector<RealmInfo> previous = std::move(m_realms);
+
     // TODO: Fetch from API
     // For now, return hardcoded realms
 
@@ -98,11 +204,33 @@ void RealmManager::refreshRealms(const RealmCallback& callback) {
         }
     };
 
+    // Latencies measured for the previous list still hold for the same
+    // endpoints
+    std::unordered_map<uint32_t, const RealmInfo*> known;
+    for (const auto& realm : previous) {
+        known[realm.id] = &realm;
+    }
+    for (auto& realm : m_realms) {
+        auto it = known.find(realm.id);
+        if (it != known.end() && it->second->ip == realm.ip && it->second->port == realm.port) {
+            realm.latencyMs = it->second->latencyMs;
+            realm.latencyProbedAt = it->second->latencyProbedAt;
+        }
+    }
+    m_currentRealm = getRealm(currentId);
+
+    saveCache();
+    probeLatency();
     callback(m_realms);
 }
 
 void RealmManager::selectRealm(uint32_t realmId) {
     m_currentRealm = getRealm(realmId);
+
+    // Likely the next login; connect while the player decides
+    if (m_currentRealm && m_currentRealm->isAvailable()) {
+        g_prewarmer.warm(m_currentRealm->ip, m_currentRealm->port);
+    }
 }
 
 void RealmManager::connectToRealm(uint32_t realmId, const ConnectCallback& callback) {
@@ -118,6 +246,7 @@ void RealmManager::connectToRealm(uint32_t realmId, const ConnectCallback& callb
     }
 
     m_currentRealm = realm;
+    g_prewarmer.warm(realm->ip, realm->port);
 
     // TODO: Initiate actual connection
     callback(true, "");
@@ -171,6 +300,16 @@ std::vector<RealmInfo> RealmManager::filterAvailable() const {
     return result;
 }
 
+std::vector<RealmInfo> RealmManager::filterByLatency(int maxMs) const {
+    std::vector<RealmInfo> result;
+    for (const auto& realm : m_realms) {
+        if (realm.hasLatency() && realm.latencyMs <= maxMs) {
+            result.push_back(realm);
+        }
+    }
+    return result;
+}
+
 void RealmManager::sortByPlayers(bool descending) {
     std::sort(m_realms.begin(), m_realms.end(),
         [descending](const RealmInfo& a, const RealmInfo& b) {
@@ -193,6 +332,200 @@ void RealmManager::sortByExpRate(bool descending) {
         });
 }
 
+void RealmManager::sortByLatency(bool ascending) {
+    std::stable_sort(m_realms.begin(), m_realms.end(),
+        [ascending](const RealmInfo& a, const RealmInfo& b) {
+            if (a.hasLatency() != b.hasLatency()) return a.hasLatency();
+            return ascending ? a.latencyMs < b.latencyMs : a.latencyMs > b.latencyMs;
+        });
+}
+
+const RealmInfo* RealmManager::lowestLatencyRealm() const {
+    const RealmInfo* best = nullptr;
+    for (const auto& realm : m_realms) {
+        if (realm.isAvailable() && realm.hasLatency() && (!best || realm.latencyMs < best->latencyMs)) {
+            best = &realm;
+        }
+    }
+    return best;
+}
+
+void RealmManager::probeLatency(bool force) {
+    // One round at a time; a refresh during a probe picks up its results
+    // by id, and whatever it missed is probed on the next call
+    if (m_probing) return;
+
+    int64_t now = unixNow();
+    int64_t ttl = std::chrono::duration_cast<std::chrono::seconds>(LATENCY_TTL).count();
+    std::vector<ProbeResult> targets;
+    for (const auto& realm : m_realms) {
+        if (force || !realm.hasLatency() || now - realm.latencyProbedAt >= ttl) {
+            targets.push_back({realm.id, realm.ip, realm.port, -1});
+        }
+    }
+    if (targets.empty()) return;
+
+    m_probing = true;
+    m_probeJob = g_jobs.submitBlocking([this, targets = std::move(targets)]() mutable {
+        std::vector<framework::LatencyProbe::Target> endpoints;
+        endpoints.reserve(targets.size());
+        for (const auto& target : targets) {
+            endpoints.push_back({target.host, target.port});
+        }
+
+        std::vector<int> latencies = framework::LatencyProbe::measure(
+            endpoints, framework::LatencyProbe::DEFAULT_ROUNDS, framework::LatencyProbe::DEFAULT_TIMEOUT,
+            &m_probeCancelled);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            targets[i].latencyMs = latencies[i];
+        }
+
+        std::lock_guard<std::mutex> lock(m_probeMutex);
+        m_probeResults = std::move(targets);
+        m_probeFinished = true;
+    });
+}
+
+void RealmManager::poll() {
+    std::vector<ProbeResult> results;
+    {
+        std::lock_guard<std::mutex> lock(m_probeMutex);
+        if (!m_probeFinished) return;
+        m_probeFinished = false;
+        results = std::move(m_probeResults);
+    }
+    m_probeJob = nullptr;
+    m_probing = false;
+
+    // Matched by id and endpoint, since the list may have been refreshed
+    // while the probe ran
+    int64_t now = unixNow();
+    for (const auto& result : results) {
+        RealmInfo* realm = getRealm(result.realmId);
+        if (realm && realm->ip == result.host && realm->port == result.port) {
+            realm->latencyMs = result.latencyMs;
+            realm->latencyProbedAt = now;
+        }
+    }
+
+    saveCache();
+    if (m_latencyCallback) {
+        m_latencyCallback(m_realms);
+    }
+}
+
+void RealmManager::setCacheDirectory(const std::string& directory) {
+    m_cacheDirectory = directory;
+    if (m_realms.empty()) {
+        loadCache();
+    }
+}
+
+std::string RealmManager::cachePath() const {
+    return (fs::path(m_cacheDirectory) / "realms.bin").string();
+}
+
+bool RealmManager::loadCache() {
+    if (m_cacheDirectory.empty()) return false;
+
+    std::ifstream in(cachePath(), std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < CACHE_HEADER_SIZE) return false;
+
+    const uint8_t* header = data.data();
+    int64_t savedAt = readLE<int64_t>(header + 8);
+    int64_t maxAge = std::chrono::duration_cast<std::chrono::seconds>(CACHE_MAX_AGE).count();
+    if (readLE<uint32_t>(header) != CACHE_MAGIC || readLE<uint16_t>(header + 4) != CACHE_VERSION ||
+        unixNow() - savedAt > maxAge ||
+        readLE<uint64_t>(header + 20) != fnv1a(header + CACHE_HEADER_SIZE, data.size() - CACHE_HEADER_SIZE)) {
+        return false;
+    }
+
+    uint32_t count = readLE<uint32_t>(header + 16);
+    Reader reader(header + CACHE_HEADER_SIZE, data.size() - CACHE_HEADER_SIZE);
+    std::vector<RealmInfo> realms;
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        RealmInfo realm;
+        realm.id = reader.read<uint32_t>();
+        realm.name = reader.readString();
+        realm.description = reader.readString();
+        realm.type = static_cast<RealmType>(reader.read<uint8_t>());
+        realm.pvpType = static_cast<PvPType>(reader.read<uint8_t>());
+        realm.status = static_cast<RealmStatus>(reader.read<uint8_t>());
+        realm.playersOnline = reader.read<uint32_t>();
+        realm.maxPlayers = reader.read<uint32_t>();
+        realm.ip = reader.readString();
+        realm.port = reader.read<uint16_t>();
+        realm.expRate = bitsFloat(reader.read<uint32_t>());
+        realm.lootRate = bitsFloat(reader.read<uint32_t>());
+        realm.isPremium = reader.read<uint8_t>() != 0;
+        realm.version = reader.readString();
+        realm.latencyMs = reader.read<int32_t>();
+        realm.latencyProbedAt = reader.read<int64_t>();
+        realms.push_back(std::move(realm));
+    }
+    if (!reader.ok()) return false;
+
+    m_realms = std::move(realms);
+    m_currentRealm = nullptr;
+    return true;
+}
+
+bool RealmManager::saveCache() const {
+    if (m_cacheDirectory.empty()) return false;
+
+    std::vector<uint8_t> data(CACHE_HEADER_SIZE);
+    for (const auto& realm : m_realms) {
+        writeLE<uint32_t>(data, realm.id);
+        writeString(data, realm.name);
+        writeString(data, realm.description);
+        writeLE<uint8_t>(data, static_cast<uint8_t>(realm.type));
+        writeLE<uint8_t>(data, static_cast<uint8_t>(realm.pvpType));
+        writeLE<uint8_t>(data, static_cast<uint8_t>(realm.status));
+        writeLE<uint32_t>(data, realm.playersOnline);
+        writeLE<uint32_t>(data, realm.maxPlayers);
+        writeString(data, realm.ip);
+        writeLE<uint16_t>(data, realm.port);
+        writeLE<uint32_t>(data, floatBits(realm.expRate));
+        writeLE<uint32_t>(data, floatBits(realm.lootRate));
+        writeLE<uint8_t>(data, realm.isPremium ? 1 : 0);
+        writeString(data, realm.version);
+        writeLE<int32_t>(data, realm.latencyMs);
+        writeLE<int64_t>(data, realm.latencyProbedAt);
+    }
+
+    std::vector<uint8_t> header;
+    writeLE<uint32_t>(header, CACHE_MAGIC);
+    writeLE<uint16_t>(header, CACHE_VERSION);
+    writeLE<uint16_t>(header, 0);
+    writeLE<int64_t>(header, unixNow());
+    writeLE<uint32_t>(header, static_cast<uint32_t>(m_realms.size()));
+    writeLE<uint64_t>(header, fnv1a(data.data() + CACHE_HEADER_SIZE, data.size() - CACHE_HEADER_SIZE));
+    std::copy(header.begin(), header.end(), data.begin());
+
+    // Written aside and renamed, so a crash never leaves a partial cache
+    std::error_code error;
+    fs::create_directories(m_cacheDirectory, error);
+    fs::path target(cachePath());
+    fs::path temporary = target;
+    temporary += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            out.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
 RealmManager::ThemeColors RealmManager::getRealmTheme(RealmType type) const {
     switch (type) {
         case RealmType::Dark:
@@ -5,6 +5,11 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <framework/core/jobsystem.h>
 
 namespace shadow {
 namespace realms {
@@ -50,6 +55,13 @@ struct RealmInfo {
     bool isPremium;
     std::string version;
 
+    /// Round trip to the game endpoint in ms, -1 until it answers a probe
+    int latencyMs = -1;
+    /// Unix time of the probe behind latencyMs, 0 if never probed
+    int64_t latencyProbedAt = 0;
+
+    bool hasLatency() const { return latencyMs >= 0; }
+
     /// Get realm type display name
     std::string typeDisplayName() const;
 
@@ -83,13 +95,20 @@ class RealmManager {
 public:
     static RealmManager& instance();
 
-    /// Realm list management
+    /// Probes older than this are repeated by probeLatency()
+    static constexpr auto LATENCY_TTL = std::chrono::minutes(10);
+    /// Cached lists older than this are not shown at all
+    static constexpr auto CACHE_MAX_AGE = std::chrono::hours(24 * 7);
+
+    /// Realm list management. A refreshed list keeps the latencies already
+    /// known for its realms and probes the rest.
     void refreshRealms(const RealmCallback& callback);
     const std::vector<RealmInfo>& realms() const { return m_realms; }
     RealmInfo* currentRealm() { return m_currentRealm; }
     const RealmInfo* currentRealm() const { return m_currentRealm; }
 
-    /// Realm selection
+    /// Realm selection. Selecting an available realm pre-warms a connection
+    /// to it for the login that usually follows.
     void selectRealm(uint32_t realmId);
     void connectToRealm(uint32_t realmId, const ConnectCallback& callback);
 
@@ -101,11 +120,31 @@ public:
     std::vector<RealmInfo> filterByType(RealmType type) const;
     std::vector<RealmInfo> filterByPvP(PvPType pvpType) const;
     std::vector<RealmInfo> filterAvailable() const;
+    /// Realms that answered within maxMs
+    std::vector<RealmInfo> filterByLatency(int maxMs) const;
 
     /// Sorting
     void sortByPlayers(bool descending = true);
     void sortByName();
     void sortByExpRate(bool descending = true);
+    /// Realms without a measured latency go last
+    void sortByLatency(bool ascending = true);
+
+    /// Available realm with the lowest latency, nullptr if none answered
+    const RealmInfo* lowestLatencyRealm() const;
+
+    /// Latency probing. Probes run on a background thread against every
+    /// realm's game endpoint; poll() applies the results on the main thread
+    /// and calls the latency callback. Realms probed within LATENCY_TTL are
+    /// skipped unless forced.
+    void probeLatency(bool force = false);
+    bool isProbing() const { return m_probing; }
+    void setLatencyCallback(const RealmCallback& callback) { m_latencyCallback = callback; }
+    void poll();
+
+    /// The realm list and latencies are kept in this directory, and the
+    /// cached list is loaded at once so it can be shown before a refresh
+    void setCacheDirectory(const std::string& directory);
 
     /// Get realm theme colors for UI
     struct ThemeColors {
@@ -119,12 +158,36 @@ public:
 
 private:
     RealmManager() = default;
-    ~RealmManager() = default;
+    ~RealmManager();
     RealmManager(const RealmManager&) = delete;
     RealmManager& operator=(const RealmManager&) = delete;
 
+    /// Cache file: "SRLC" magic, u16 version, u16 reserved, u64 saved at,
+    /// u32 realm count, u64 payload FNV-1a, then the realms' fields
+    static constexpr uint32_t CACHE_MAGIC = 0x434C5253; // "SRLC"
+    static constexpr uint16_t CACHE_VERSION = 1;
+    bool loadCache();
+    bool saveCache() const;
+    std::string cachePath() const;
+
+    struct ProbeResult {
+        uint32_t realmId;
+        std::string host;
+        uint16_t port;
+        int latencyMs;
+    };
+
     std::vector<RealmInfo> m_realms;
     RealmInfo* m_currentRealm = nullptr;
+    std::string m_cacheDirectory;
+    RealmCallback m_latencyCallback;
+
+    framework::JobSystem::Handle m_probeJob;
+    std::atomic<bool> m_probing{false};
+    std::atomic<bool> m_probeCancelled{false};
+    std::mutex m_probeMutex;
+    std::vector<ProbeResult> m_probeResults;
+    bool m_probeFinished = false;
 };
 
 /// Utility functions
@@ -0,0 +1,87 @@
+/**
+ * Shadow OT Client - Headless Stand-ins
+ *
+ * The headless load generator builds the parser, map and game units
+ * without the render, window, input and sound ones. What those units
+ * still name from them (thing and creature draw calls, the profiler's
+ * overlay and GPU timers, texture and font loads, the input latency
+ * trace, the user path) is defined here as no-ops. Nothing in the load
+ * generator draws or reads input, so none of these run for real work.
+ */
+
+#include <framework/core/application.h>
+#include <framework/graphics/font.h>
+#include <framework/graphics/graphics.h>
+#include <framework/graphics/textureatlas.h>
+#include <framework/input/inputmanager.h>
+
+namespace shadow {
+namespace framework {
+
+// Graphics
+
+struct Graphics::Impl {};
+
+Graphics& Graphics::instance() {
+    static Graphics instance;
+    return instance;
+}
+
+void Graphics::drawRect(const Rect&, const Color&) {}
+void Graphics::drawFilledRect(const Rect&, const Color&) {}
+void Graphics::drawTexture(const Texture*, const Rect&, const Rect&) {}
+void Graphics::drawSpriteInstance(const Texture*, const SpriteInstance&, const Texture*) {}
+void Graphics::drawText(const std::string&, int, int, const Color&, int) {}
+Size Graphics::measureText(const std::string&, int) const { return Size(); }
+void Graphics::beginGpuTimer(uint32_t) {}
+void Graphics::endGpuTimer() {}
+float Graphics::getGpuTimerMs(uint32_t) const { return -1.0f; }
+std::shared_ptr<Texture> Graphics::loadTexture(const std::string&) { return nullptr; }
+
+Graphics& g_graphics = Graphics::instance();
+
+// Texture atlas: no pages, so every lookup misses and every add fails
+
+TextureAtlas::TextureAtlas(int, size_t) {}
+TextureAtlas::~TextureAtlas() = default;
+const AtlasRegion* TextureAtlas::find(uint64_t) { return nullptr; }
+const AtlasRegion* TextureAtlas::add(uint64_t, int, int, const uint8_t*) { return nullptr; }
+void TextureAtlas::clear() {}
+
+// Fonts
+
+FontManager& FontManager::instance() {
+    static FontManager instance;
+    return instance;
+}
+
+std::shared_ptr<Font> FontManager::importFont(const std::string&) { return nullptr; }
+
+FontManager& g_fonts = FontManager::instance();
+
+// Input: no input is ever active, so sends record no latency
+
+InputManager& InputManager::instance() {
+    static InputManager instance;
+    return instance;
+}
+
+uint32_t InputManager::markInputSent() { return 0; }
+
+// Application: the user path stays empty
+
+struct Application::Impl {};
+
+Application& Application::instance() {
+    static Application instance;
+    return instance;
+}
+
+Application::Application() = default;
+Application::~Application() = default;
+
+} // namespace framework
+} // namespace shadow
+
+shadow::framework::InputManager& g_input = shadow::framework::InputManager::instance();
+shadow::framework::Application& g_app = shadow::framework::Application::instance();
@@ -0,0 +1,449 @@
+/**
+ * Shadow OT Client - Headless Load Generator
+ *
+ * Drives many scripted game sessions from one process, for load-testing a
+ * server with the client's own protocol and network code. Every session
+ * is a client ProtocolGame on the reactor backend: the process runs one
+ * I/O thread however many sessions it holds, and every packet goes
+ * through the parser the game uses. Nothing here touches graphics, sound
+ * or a window.
+ *
+ * Sessions are detached protocols: each parses its packets in full and
+ * keeps only its own view position, and none of them writes g_game or
+ * g_map, so sessions never see each other's world. Item descriptions are
+ * framed by their thing types, so the client's .dat for the server's
+ * version is required.
+ *
+ *   shadow-client-headless --host <host> --dat <Tibia.dat> [--port 7172]
+ *       [--sessions 100] [--ramp 20] [--duration 60] [--script <file>]
+ *       [--account <prefix>] [--password <pw>] [--character <prefix>]
+ *
+ * Session i logs in as <account><i> / <character><i>. The script is played
+ * in a loop by every session, one action per line:
+ *
+ *   walk <n|e|s|w|random> [steps]     turn <n|e|s|w>      say <text>
+ *   attack <creature id>              ping                wait <ms>
+ *
+ * Every few seconds, and at the end, it prints session counts,
+ * throughput, and latency percentiles for connect, login, and reaction
+ * (an action to the next packet back).
+ */
+
+#include <client/protocolgame.h>
+#include <client/thingtype.h>
+#include <framework/net/connection.h>
+#include <framework/net/networkreactor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+
+using namespace shadow::framework;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr auto TICK = std::chrono::milliseconds(10);
+constexpr auto REPORT_INTERVAL = std::chrono::seconds(5);
+constexpr auto LOGIN_TIMEOUT = std::chrono::seconds(15);
+constexpr size_t MAX_SAMPLES = 100000;
+
+volatile std::sig_atomic_t g_stop = 0;
+
+struct Action {
+    enum class Type : uint8_t { Walk, Turn, Say, Attack, Ping, Wait };
+    Type type{Type::Wait};
+    int direction{0};       // 0-3 north, east, south, west; -1 random
+    int count{1};
+    uint32_t value{0};      // Creature id or wait in ms
+    std::string text;
+};
+
+// Latencies are sampled up to MAX_SAMPLES, then replaced at random so a
+// long run still reflects its whole span
+class Samples {
+public:
+    void add(double ms, std::mt19937& random) {
+        m_count++;
+        if (m_values.size() < MAX_SAMPLES) {
+            m_values.push_back(ms);
+        } else {
+            std::uniform_int_distribution<uint64_t> pick(0, m_count - 1);
+            uint64_t slot = pick(random);
+            if (slot < MAX_SAMPLES) m_values[slot] = ms;
+        }
+    }
+
+    std::string summary() const {
+        if (m_values.empty()) return "-";
+        std::vector<double> sorted = m_values;
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&sorted](double q) { return sorted[static_cast<size_t>(q * (sorted.size() - 1))]; };
+        char line[128];
+        std::snprintf(line, sizeof(line), "p50 %.1f  p95 %.1f  p99 %.1f  max %.1f ms (%llu)",
+                      at(0.50), at(0.95), at(0.99), sorted.back(), static_cast<unsigned long long>(m_count));
+        return line;
+    }
+
+private:
+    std::vector<double> m_values;
+    uint64_t m_count{0};
+};
+
+struct Totals {
+    uint64_t started{0};
+    uint64_t failed{0};
+    uint64_t loggedIn{0};
+    uint64_t actions{0};
+    uint64_t packets{0};
+    Samples connect;
+    Samples login;
+    Samples reaction;
+};
+
+struct Session {
+    enum class State : uint8_t { Connecting, Online, Failed };
+
+    explicit Session(uint32_t index) : index(index) {}
+
+    uint32_t index;
+    State state{State::Connecting};
+    shadow::client::ProtocolGame protocol;
+    size_t nextAction{0};
+    int remaining{0};       // Steps left in a multi-step walk
+    Clock::time_point started;
+    Clock::time_point due;
+    Clock::time_point awaiting;     // Action waiting for its reaction; epoch when none
+    bool entered{false};
+    uint64_t packets{0};
+};
+
+int usage() {
+    std::cerr << "usage: shadow-client-headless --host <host> --dat <Tibia.dat> [--port 7172] [--sessions 100]\n"
+                 "           [--ramp 20] [--duration 60] [--script <file>] [--account <prefix>]\n"
+                 "           [--password <pw>] [--character <prefix>]" << std::endl;
+    return 2;
+}
+
+int parseDirection(const std::string& word) {
+    if (word == "n" || word == "north") return 0;
+    if (word == "e" || word == "east") return 1;
+    if (word == "s" || word == "south") return 2;
+    if (word == "w" || word == "west") return 3;
+    return -1;
+}
+
+bool parseScript(std::istream& in, std::vector<Action>& script) {
+    std::string line;
+    int number = 0;
+    while (std::getline(in, line)) {
+        number++;
+        std::istringstream words(line);
+        std::string verb;
+        if (!(words >> verb) || verb[0] == '#') continue;
+
+        Action action;
+        std::string argument;
+        if (verb == "walk") {
+            action.type = Action::Type::Walk;
+            words >> argument >> action.count;
+            action.direction = argument == "random" ? -1 : parseDirection(argument);
+            if (action.direction < 0 && argument != "random") {
+                std::cerr << "line " << number << ": unknown direction '" << argument << "'" << std::endl;
+                return false;
+            }
+            action.count = std::max(action.count, 1);
+        } else if (verb == "turn") {
+            action.type = Action::Type::Turn;
+            words >> argument;
+            action.direction = parseDirection(argument);
+            if (action.direction < 0) {
+                std::cerr << "line " << number << ": unknown direction '" << argument << "'" << std::endl;
+                return false;
+            }
+        } else if (verb == "say") {
+            action.type = Action::Type::Say;
+            std::getline(words >> std::ws, action.text);
+        } else if (verb == "attack") {
+            action.type = Action::Type::Attack;
+            words >> action.value;
+        } else if (verb == "ping") {
+            action.type = Action::Type::Ping;
+        } else if (verb == "wait") {
+            action.type = Action::Type::Wait;
+            words >> action.value;
+        } else {
+            std::cerr << "line " << number << ": unknown action '" << verb << "'" << std::endl;
+            return false;
+        }
+        script.push_back(std::move(action));
+    }
+    return true;
+}
+
+// A walk around the spawn, a line of chat and a pause
+std::vector<Action> defaultScript() {
+    std::istringstream in("walk random 4\nwait 500\nsay hello\nwait 1000\nping\nwait 2000\n");
+    std::vector<Action> script;
+    parseScript(in, script);
+    return script;
+}
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Runs due actions; returns when the session waits
+void step(Session& session, const std::vector<Action>& script, Clock::time_point now, Totals& totals,
+          std::mt19937& random) {
+    for (int guard = 0; guard < 16 && now >= session.due; ++guard) {
+        const Action& action = script[session.nextAction];
+        bool sent = true;
+        switch (action.type) {
+            case Action::Type::Walk: {
+                if (session.remaining == 0) session.remaining = action.count;
+                int direction = action.direction >= 0 ? action.direction
+                                                      : std::uniform_int_distribution<int>(0, 3)(random);
+                session.protocol.sendWalk(static_cast<shadow::client::Position::Direction>(direction));
+                // Steps at walking pace; the next one follows the last
+                session.due = now + std::chrono::milliseconds(200);
+                if (--session.remaining > 0) {
+                    totals.actions++;
+                    if (session.awaiting == Clock::time_point()) session.awaiting = now;
+                    return;
+                }
+                break;
+            }
+            case Action::Type::Turn:
+                session.protocol.sendTurn(static_cast<shadow::client::Position::Direction>(action.direction));
+                break;
+            case Action::Type::Say:
+                session.protocol.sendSay(shadow::client::SpeakType::Say, action.text);
+                break;
+            case Action::Type::Attack:
+                session.protocol.sendAttack(action.value);
+                break;
+            case Action::Type::Ping:
+                session.protocol.sendPing();
+                break;
+            case Action::Type::Wait:
+                session.due = now + std::chrono::milliseconds(action.value);
+                sent = false;
+                break;
+        }
+
+        if (sent) {
+            totals.actions++;
+            if (session.awaiting == Clock::time_point()) session.awaiting = now;
+        }
+        session.nextAction = (session.nextAction + 1) % script.size();
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    std::string host;
+    uint16_t port = 7172;
+    int sessionCount = 100;
+    int ramp = 20;          // Sessions started per second
+    int duration = 60;
+    std::string scriptPath;
+    std::string datPath;
+    std::string accountPrefix = "load";
+    std::string password = "load";
+    std::string characterPrefix = "Load";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--host") host = value;
+        else if (flag == "--port") port = static_cast<uint16_t>(std::stoi(value));
+        else if (flag == "--sessions") sessionCount = std::max(1, std::stoi(value));
+        else if (flag == "--ramp") ramp = std::max(1, std::stoi(value));
+        else if (flag == "--duration") duration = std::max(1, std::stoi(value));
+        else if (flag == "--script") scriptPath = value;
+        else if (flag == "--dat") datPath = value;
+        else if (flag == "--account") accountPrefix = value;
+        else if (flag == "--password") password = value;
+        else if (flag == "--character") characterPrefix = value;
+        else return usage();
+    }
+    if (host.empty() || datPath.empty() || argc % 2 == 0) return usage();
+
+    // Without thing types, stackable counts and animation phases are not
+    // read and every item description after the first desyncs
+    if (!shadow::client::ThingTypeManager::instance().loadDat(std::filesystem::absolute(datPath).string())) {
+        std::cerr << "cannot load thing types from " << datPath << std::endl;
+        return 1;
+    }
+
+    std::vector<Action> script;
+    if (scriptPath.empty()) {
+        script = defaultScript();
+    } else {
+        std::ifstream in(scriptPath);
+        if (!in || !parseScript(in, script)) {
+            std::cerr << "cannot use script " << scriptPath << std::endl;
+            return 1;
+        }
+    }
+    if (script.empty()) {
+        std::cerr << "script has no actions" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, [](int) { g_stop = 1; });
+#ifdef SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    // One I/O thread for every session
+    Connection::setDefaultBackend(NetworkBackend::Reactor);
+
+    Totals totals;
+    std::mt19937 random(std::random_device{}());
+    std::vector<std::unique_ptr<Session>> sessions;
+    sessions.reserve(sessionCount);
+
+    auto begin = Clock::now();
+    auto end = begin + std::chrono::seconds(duration);
+    auto nextReport = begin + REPORT_INTERVAL;
+    uint64_t lastBytesIn = 0, lastBytesOut = 0, lastPackets = 0, lastActions = 0;
+    auto lastReport = begin;
+
+    std::cout << "shadow-client-headless: " << sessionCount << " sessions against " << host << ":" << port
+              << ", " << sizeof(Session) << " bytes of session state each" << std::endl;
+
+    auto report = [&](Clock::time_point now, bool final) {
+        uint64_t bytesIn = 0, bytesOut = 0;
+        size_t online = 0, connecting = 0, failed = 0;
+        for (const auto& session : sessions) {
+            if (const auto& connection = session->protocol.getConnection()) {
+                bytesIn += connection->getBytesReceived();
+                bytesOut += connection->getBytesSent();
+            }
+            online += session->state == Session::State::Online;
+            connecting += session->state == Session::State::Connecting;
+            failed += session->state == Session::State::Failed;
+        }
+
+        double seconds = std::max(elapsedMs(final ? begin : lastReport, now) / 1000.0, 0.001);
+        uint64_t packets = final ? totals.packets : totals.packets - lastPackets;
+        uint64_t actions = final ? totals.actions : totals.actions - lastActions;
+        uint64_t in = final ? bytesIn : bytesIn - lastBytesIn;
+        uint64_t out = final ? bytesOut : bytesOut - lastBytesOut;
+
+        std::printf("%s%6.1fs  online %zu  connecting %zu  failed %zu  |  %.0f actions/s  %.0f packets/s  "
+                    "%.1f KB/s in  %.1f KB/s out\n",
+                    final ? "total " : "", elapsedMs(begin, now) / 1000.0, online, connecting, failed,
+                    actions / seconds, packets / seconds, in / 1024.0 / seconds, out / 1024.0 / seconds);
+        if (final) {
+            std::printf("  connect   %s\n  login     %s\n  reaction  %s\n", totals.connect.summary().c_str(),
+                        totals.login.summary().c_str(), totals.reaction.summary().c_str());
+        }
+        std::fflush(stdout);
+
+        lastReport = now;
+        lastPackets = totals.packets;
+        lastActions = totals.actions;
+        lastBytesIn = bytesIn;
+        lastBytesOut = bytesOut;
+    };
+
+    while (!g_stop) {
+        auto now = Clock::now();
+        if (now >= end) break;
+
+        // Ramp up at a fixed rate so connects do not all land at once
+        size_t target = std::min<size_t>(sessionCount,
+            static_cast<size_t>(elapsedMs(begin, now) / 1000.0 * ramp) + 1);
+        while (sessions.size() < target) {
+            auto session = std::make_unique<Session>(static_cast<uint32_t>(sessions.size()));
+            Session* raw = session.get();
+            raw->started = now;
+            raw->due = now;
+            raw->protocol.setDetached(true);
+
+            // Sees each packet before the client parser applies it
+            raw->protocol.setPacketObserver([raw, &totals, &random](uint8_t opcode, size_t) {
+                if (raw->state == Session::State::Connecting) {
+                    if (opcode == ServerOpcode::LoginSuccess) {
+                        raw->state = Session::State::Online;
+                        totals.loggedIn++;
+                        totals.login.add(elapsedMs(raw->started, Clock::now()), random);
+                    } else if (opcode == ServerOpcode::LoginError) {
+                        raw->state = Session::State::Failed;
+                        totals.failed++;
+                    }
+                }
+                raw->packets++;
+                totals.packets++;
+                if (raw->awaiting != Clock::time_point()) {
+                    totals.reaction.add(elapsedMs(raw->awaiting, Clock::now()), random);
+                    raw->awaiting = Clock::time_point();
+                }
+            });
+
+            std::string suffix = std::to_string(raw->index);
+            raw->protocol.connect(host, port, accountPrefix + suffix, password, characterPrefix + suffix);
+            totals.started++;
+            sessions.push_back(std::move(session));
+        }
+
+        for (auto& session : sessions) {
+            if (session->state == Session::State::Failed) continue;
+
+            // Packets are parsed from here, login included
+            session->protocol.poll();
+
+            const auto& connection = session->protocol.getConnection();
+            ConnectionState state = connection ? connection->getState() : ConnectionState::Disconnected;
+            if (state == ConnectionState::Connected && !session->entered) {
+                session->entered = true;
+                totals.connect.add(connection->getConnectStats().totalUs / 1000.0, random);
+                session->protocol.sendEnterWorld();
+            }
+            if (state == ConnectionState::Error || state == ConnectionState::Disconnected ||
+                (session->state == Session::State::Connecting && now - session->started > LOGIN_TIMEOUT)) {
+                if (session->state != Session::State::Failed) {
+                    session->state = Session::State::Failed;
+                    totals.failed++;
+                }
+                continue;
+            }
+
+            if (session->state == Session::State::Online) {
+                step(*session, script, now, totals, random);
+            }
+        }
+
+        if (now >= nextReport) {
+            report(now, false);
+            nextReport += REPORT_INTERVAL;
+        }
+        std::this_thread::sleep_for(TICK);
+    }
+
+    report(Clock::now(), true);
+
+    for (auto& session : sessions) {
+        if (session->state == Session::State::Online) {
+            session->protocol.sendLogout();
+        }
+    }
+    sessions.clear();
+    g_reactor.shutdown();
+    return totals.loggedIn > 0 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/**
+ * Shadow OT Client - Asset Packer
+ *
+ * Packs a data directory into one asset pack, or lists and checks an
+ * existing one. Every file is deflated unless its extension is on the
+ * store list; .spr and .dat are stored by default so the client can map
+ * them in place, and images and audio that are compressed already gain
+ * nothing from it.
+ *
+ *   shadow-pack create <out.spk> <directory> [--store .ext,...] [--level 0-9]
+ *   shadow-pack list <pack.spk>
+ */
+
+#include <framework/core/assetpack.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace shadow::framework;
+namespace fs = std::filesystem;
+
+namespace {
+
+int usage() {
+    std::cerr << "usage: shadow-pack create <out.spk> <directory> [--store .ext,...] [--level 0-9]\n"
+                 "       shadow-pack list <pack.spk>" << std::endl;
+    return 2;
+}
+
+std::set<std::string> parseExtensions(const std::string& list) {
+    std::set<std::string> extensions;
+    std::stringstream stream(list);
+    std::string extension;
+    while (std::getline(stream, extension, ',')) {
+        if (extension.empty()) continue;
+        if (extension[0] != '.') extension.insert(extension.begin(), '.');
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        extensions.insert(extension);
+    }
+    return extensions;
+}
+
+int create(const std::vector<std::string>& args) {
+    if (args.size() < 2) return usage();
+    const std::string& output = args[0];
+    fs::path root(args[1]);
+
+    std::set<std::string> stored = parseExtensions(".spr,.dat,.png,.jpg,.ogg");
+    int level = 6;
+    for (size_t i = 2; i + 1 < args.size(); i += 2) {
+        if (args[i] == "--store") {
+            stored = parseExtensions(args[i + 1]);
+        } else if (args[i] == "--level") {
+            level = std::clamp(std::stoi(args[i + 1]), 0, 9);
+        } else {
+            return usage();
+        }
+    }
+
+    std::error_code error;
+    if (!fs::is_directory(root, error)) {
+        std::cerr << "not a directory: " << root.string() << std::endl;
+        return 1;
+    }
+
+    AssetPackWriter writer;
+    for (auto it = fs::recursive_directory_iterator(root, error); !error && it != fs::recursive_directory_iterator();
+         it.increment(error)) {
+        if (!it->is_regular_file()) continue;
+
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        std::string name = fs::relative(it->path(), root).generic_string();
+        writer.addFile(name, it->path().string(), !stored.count(extension));
+    }
+    if (error) {
+        std::cerr << "failed to scan " << root.string() << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    if (!writer.write(output, level)) {
+        std::cerr << "failed to write " << output << std::endl;
+        return 1;
+    }
+
+    const auto& stats = writer.getStats();
+    std::cout << output << ": " << stats.entries << " files, " << stats.compressed << " compressed, "
+              << stats.inputBytes / 1024 << " KB in, " << stats.outputBytes / 1024 << " KB out" << std::endl;
+    return 0;
+}
+
+int list(const std::vector<std::string>& args) {
+    if (args.size() != 1) return usage();
+
+    AssetPack pack;
+    if (!pack.open(args[0])) {
+        std::cerr << "not a valid asset pack: " << args[0] << std::endl;
+        return 1;
+    }
+
+    // Reading every entry also checks that compressed ones inflate
+    int failures = 0;
+    std::vector<uint8_t> data;
+    for (const auto& entry : pack.getEntries()) {
+        bool ok = pack.read(entry, data);
+        failures += ok ? 0 : 1;
+        std::cout << std::setw(10) << entry.size << std::setw(10) << entry.storedSize
+                  << (entry.isCompressed() ? "  deflate  " : "  stored   ") << pack.getName(entry)
+                  << (ok ? "" : "  (corrupt)") << '\n';
+    }
+    std::cout << pack.getEntries().size() << " entries" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+
+    std::string command = argv[1];
+    std::vector<std::string> args(argv + 2, argv + argc);
+    if (command == "create") return create(args);
+    if (command == "list") return list(args);
+    return usage();
+}